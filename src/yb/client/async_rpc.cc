@@ -131,6 +131,14 @@ const YBTable* AsyncRpc::table() const {
 void AsyncRpc::Finished(const Status& status) {
   Status new_status = status;
   if (tablet_invoker_.Done(&new_status)) {
+    if (ErrorCode(response_error()) == tserver::TabletServerErrorPB::TABLET_SPLIT) {
+      // Ops could belong to different tablets created by the split, so they are routed again.
+      if (batcher_->RetryOpsAfterTabletSplit(ops_)) {
+        retained_self_.reset();
+        return;
+      }
+      Failed(new_status);
+    }
     ProcessResponseFromTserver(new_status);
     batcher_->RemoveInFlightOpsAfterFlushing(ops_, new_status, PropagatedHybridTime());
     batcher_->CheckForFinishedFlush();
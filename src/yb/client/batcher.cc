@@ -41,6 +41,7 @@
 #include <utility>
 #include <vector>
 
+#include <gflags/gflags.h>
 #include <glog/logging.h>
 
 #include "yb/client/async_rpc.h"
@@ -59,6 +60,7 @@
 #include "yb/gutil/strings/join.h"
 
 #include "yb/util/debug-util.h"
+#include "yb/util/flag_tags.h"
 #include "yb/util/logging.h"
 
 using std::pair;
@@ -70,6 +72,11 @@ using strings::Substitute;
 
 using namespace std::placeholders;
 
+DEFINE_int32(tablet_split_retry_delay_ms, 100,
+             "Delay before operations, rejected because their tablet was split, are looked up and "
+             "sent again.");
+TAG_FLAG(tablet_split_retry_delay_ms, advanced);
+
 namespace yb {
 
 using tserver::WriteResponsePB;
@@ -348,6 +355,39 @@ void Batcher::TabletLookupFinished(InFlightOpPtr op, const Status& s) {
   FlushBuffersIfReady();
 }
 
+bool Batcher::RetryOpsAfterTabletSplit(const InFlightOps& ops) {
+  // The master replaces the split tablet when both new tablets are running, lookups return the
+  // split tablet until then. So lookups are delayed, to avoid sending them in a loop.
+  const auto delay = MonoDelta::FromMilliseconds(FLAGS_tablet_split_retry_delay_ms);
+  {
+    std::lock_guard<simple_spinlock> l(lock_);
+    if (IsAbortedUnlocked() || MonoTime::Now() + delay >= deadline_) {
+      return false;
+    }
+    for (const auto& op : ops) {
+      std::lock_guard<simple_spinlock> l2(op->lock_);
+      op->state = InFlightOpState::kLookingUpTablet;
+    }
+    outstanding_lookups_ += ops.size();
+  }
+
+  VLOG(1) << "Retry " << ops.size() << " operations after split of "
+          << ops.front()->tablet->tablet_id();
+  BatcherPtr self(this);
+  messenger()->ScheduleOnReactor([self, ops](const Status& status) {
+    for (const auto& op : ops) {
+      if (!status.ok()) {
+        self->TabletLookupFinished(op, status);
+        continue;
+      }
+      self->client_->data_->meta_cache_->LookupTabletByKey(
+          op->yb_op->table(), op->partition_key, self->deadline_, &op->tablet,
+          Bind(&Batcher::TabletLookupFinished, self.get(), op));
+    }
+  }, delay);
+  return true;
+}
+
 void Batcher::TransactionReady(const Status& status, const BatcherPtr& self) {
   if (status.ok()) {
     FlushBuffersIfReady();
@@ -158,6 +158,10 @@ class Batcher : public RefCountedThreadSafe<Batcher> {
   void RemoveInFlightOpsAfterFlushing(
       const InFlightOps& ops, const Status& status, HybridTime propagated_hybrid_time);
 
+  // Looks up tablets of ops again after a delay and sends them to the found tablets, when their
+  // tablet was split. Returns false if ops could not be retried before the deadline.
+  bool RetryOpsAfterTabletSplit(const InFlightOps& ops);
+
     // Return true if the batch has been aborted, and any in-flight ops should stop
   // processing wherever they are.
   bool IsAbortedUnlocked() const;
@@ -1335,6 +1335,56 @@ Status YBClient::Data::SetReplicationInfo(
   return Status::OK();
 }
 
+Status YBClient::Data::SetQuota(
+    YBClient* client, const master::QuotaPB& quota, const MonoTime& deadline, bool* retry) {
+  if (!retry) {
+    return RetryFunc(
+        deadline, "Other clients changed the config. Retrying.",
+        "Timed out retrying the config change. Probably too many concurrent attempts.",
+        std::bind(&YBClient::Data::SetQuota, this, client, quota, _1, _2));
+  }
+
+  GetMasterClusterConfigRequestPB get_req;
+  GetMasterClusterConfigResponsePB get_resp;
+  Status s = SyncLeaderMasterRpc<GetMasterClusterConfigRequestPB, GetMasterClusterConfigResponsePB>(
+      deadline, client, get_req, &get_resp, nullptr /* num_attempts */, "GetMasterClusterConfig",
+      &MasterServiceProxy::GetMasterClusterConfig);
+  RETURN_NOT_OK(s);
+  if (get_resp.has_error()) {
+    return StatusFromPB(get_resp.error().status());
+  }
+
+  ChangeMasterClusterConfigRequestPB change_req;
+  ChangeMasterClusterConfigResponsePB change_resp;
+
+  // Replace the quota with the same table or namespace.
+  auto* config = change_req.mutable_cluster_config();
+  config->CopyFrom(get_resp.cluster_config());
+  auto* quotas = config->mutable_quotas();
+  for (auto it = quotas->begin(); it != quotas->end();) {
+    if (it->table_id() == quota.table_id() && it->namespace_id() == quota.namespace_id()) {
+      it = quotas->erase(it);
+    } else {
+      ++it;
+    }
+  }
+  if (quota.ops_per_sec() != 0 || quota.bytes_per_sec() != 0) {
+    *config->add_quotas() = quota;
+  }
+
+  s = SyncLeaderMasterRpc<ChangeMasterClusterConfigRequestPB, ChangeMasterClusterConfigResponsePB>(
+      deadline, client, change_req, &change_resp, nullptr /* num_attempts */,
+      "ChangeMasterClusterConfig", &MasterServiceProxy::ChangeMasterClusterConfig);
+  RETURN_NOT_OK(s);
+  if (change_resp.has_error()) {
+    // Retry on config mismatch.
+    *retry = change_resp.error().code() == MasterErrorPB::CONFIG_VERSION_MISMATCH;
+    return StatusFromPB(change_resp.error().status());
+  }
+  *retry = false;
+  return Status::OK();
+}
+
 HostPort YBClient::Data::leader_master_hostport() const {
   std::lock_guard<simple_spinlock> l(leader_master_lock_);
   return leader_master_hostport_;
@@ -224,6 +224,12 @@ class YBClient::Data {
       YBClient* client, const master::ReplicationInfoPB& replication_info, const MonoTime& deadline,
       bool* retry = nullptr);
 
+  // Replace the quota of the table or namespace in the cluster config, retrying on version
+  // mismatch like SetReplicationInfo.
+  CHECKED_STATUS SetQuota(
+      YBClient* client, const master::QuotaPB& quota, const MonoTime& deadline,
+      bool* retry = nullptr);
+
   // Retry 'func' until either:
   //
   // 1) Methods succeeds on a leader master.
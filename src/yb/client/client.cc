@@ -39,6 +39,8 @@
 #include <iostream>
 #include <limits>
 
+#include <boost/thread/shared_mutex.hpp>
+
 #include "yb/client/batcher.h"
 #include "yb/client/callbacks.h"
 #include "yb/client/client-internal.h"
@@ -897,6 +899,12 @@ Status YBClient::SetReplicationInfo(const ReplicationInfoPB& replication_info) {
   return data_->SetReplicationInfo(this, replication_info, deadline);
 }
 
+Status YBClient::SetQuota(const master::QuotaPB& quota) {
+  MonoTime deadline = MonoTime::Now();
+  deadline.AddDelta(default_admin_operation_timeout());
+  return data_->SetQuota(this, quota, deadline);
+}
+
 Status YBClient::ListTables(vector<YBTableName>* tables,
                             const string& filter) {
   ListTablesRequestPB req;
@@ -1388,18 +1396,43 @@ const PartitionSchema& YBTable::partition_schema() const {
   return data_->info_.partition_schema;
 }
 
-const std::string& YBTable::FindPartitionStart(
+std::string YBTable::FindPartitionStart(
     const std::string& partition_key, size_t group_by) const {
-  auto it = std::lower_bound(data_->partitions_.begin(), data_->partitions_.end(), partition_key);
-  if (it == data_->partitions_.end() || *it > partition_key) {
-    DCHECK(it != data_->partitions_.begin());
+  boost::shared_lock<rw_spinlock> lock(data_->partitions_lock_);
+  const auto& partitions = data_->partitions_;
+  auto it = std::lower_bound(partitions.begin(), partitions.end(), partition_key);
+  if (it == partitions.end() || *it > partition_key) {
+    DCHECK(it != partitions.begin());
     --it;
   }
   if (group_by <= 1) {
     return *it;
   }
-  size_t idx = (it - data_->partitions_.begin()) / group_by * group_by;
-  return data_->partitions_[idx];
+  size_t idx = (it - partitions.begin()) / group_by * group_by;
+  return partitions[idx];
+}
+
+void YBTable::AddPartitionStarts(const std::vector<std::string>& partition_starts) const {
+  {
+    boost::shared_lock<rw_spinlock> lock(data_->partitions_lock_);
+    if (std::all_of(partition_starts.begin(), partition_starts.end(),
+                    [this](const std::string& start) {
+          return std::binary_search(data_->partitions_.begin(), data_->partitions_.end(), start);
+        })) {
+      return;
+    }
+  }
+
+  std::lock_guard<rw_spinlock> lock(data_->partitions_lock_);
+  auto& partitions = data_->partitions_;
+  for (const auto& start : partition_starts) {
+    auto it = std::lower_bound(partitions.begin(), partitions.end(), start);
+    if (it == partitions.end() || *it != start) {
+      VLOG(1) << "Table " << name().ToString() << " has new partition starting at "
+              << Slice(start).ToDebugHexString();
+      partitions.insert(it, start);
+    }
+  }
 }
 
 
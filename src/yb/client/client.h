@@ -77,6 +77,7 @@ class PartitionSchema;
 class MetricEntity;
 
 namespace master {
+class QuotaPB;
 class ReplicationInfoPB;
 class TabletLocationsPB;
 }
@@ -100,6 +101,7 @@ class YBOperation;
 namespace internal {
 class Batcher;
 class GetTableSchemaRpc;
+class LookupByKeyRpc;
 class LookupRpc;
 class MetaCache;
 class RemoteTablet;
@@ -445,6 +447,10 @@ class YBClient : public std::enable_shared_from_this<YBClient> {
 
   CHECKED_STATUS SetReplicationInfo(const master::ReplicationInfoPB& replication_info);
 
+  // Replaces the quota of the table or namespace specified in the quota. The quota with zero
+  // limits is removed.
+  CHECKED_STATUS SetQuota(const master::QuotaPB& quota);
+
   const std::string& client_id() const { return client_id_; }
 
   void LookupTabletByKey(const YBTable* table,
@@ -706,7 +712,7 @@ class YBTable : public std::enable_shared_from_this<YBTable> {
 
   // Finds partition start for specified partition_key.
   // Partitions could be groupped by group_by bunches, in this case start of such bunch is returned.
-  const std::string& FindPartitionStart(
+  std::string FindPartitionStart(
       const std::string& partition_key, size_t group_by = 1) const;
 
  private:
@@ -715,6 +721,10 @@ class YBTable : public std::enable_shared_from_this<YBTable> {
 
   friend class YBClient;
   friend class internal::GetTableSchemaRpc;
+  friend class internal::LookupByKeyRpc;
+
+  // Adds partitions that appeared after the table was opened, i.e. when its tablets were split.
+  void AddPartitionStarts(const std::vector<std::string>& partition_starts) const;
 
   YBTable(const std::shared_ptr<YBClient>& client, const Info& info);
 
@@ -619,8 +619,9 @@ RemoteTabletPtr MetaCache::ProcessTabletLocations(
   VLOG(2) << "Processing master response " << ToString(locations);
 
   RemoteTabletPtr result;
-  bool first = true;
-  std::vector<StatusCallback> to_notify;
+  std::vector<RemoteTabletPtr> remotes;
+  remotes.reserve(locations.size());
+  std::vector<std::pair<StatusCallback, Status>> to_notify;
 
   {
     std::lock_guard<decltype(mutex_)> l(mutex_);
@@ -649,39 +650,67 @@ RemoteTabletPtr MetaCache::ProcessTabletLocations(
         remote = new RemoteTablet(tablet_id, partition);
 
         CHECK(tablets_by_id_.emplace(tablet_id, remote).second);
-        CHECK(tablets_by_key.emplace(partition.partition_key_start(), remote).second);
+        auto emplace_result = tablets_by_key.emplace(partition.partition_key_start(), remote);
+        if (!emplace_result.second) {
+          // The cached tablet was split, and this tablet serves the first part of its partition.
+          auto& old = emplace_result.first->second;
+          VLOG(1) << "Tablet " << old->tablet_id() << " was replaced by " << tablet_id;
+          old->MarkStale();
+          old = remote;
+        }
       }
       remote->Refresh(ts_cache_, loc.replicas());
 
-      if (first) {
+      if (!result) {
         result = remote;
-        first = false;
       }
+      remotes.push_back(remote);
+    }
 
-      if (partition_group_start) {
-        auto lookup_by_group_iter = table_data.tablet_lookups_by_group.find(*partition_group_start);
-        if (lookup_by_group_iter != table_data.tablet_lookups_by_group.end()) {
-          auto& lookups_by_partition_key = lookup_by_group_iter->second;
-          auto lookups_iter = lookups_by_partition_key.find(loc.partition().partition_key_start());
-          if (lookups_iter != lookups_by_partition_key.end()) {
-            for (auto& lookup : lookups_iter->second) {
-              if (lookup.remote_tablet) {
-                *lookup.remote_tablet = remote;
+    // Lookups are grouped by partition starts known to the table when the lookup was started, so
+    // the key of a lookup could belong to another tablet, when the tablet was split after that.
+    for (size_t i = 0; partition_group_start && i != remotes.size(); ++i) {
+      const auto& loc = locations.Get(i);
+      auto& table_data = tables_[loc.table_id()];
+      auto lookup_by_group_iter = table_data.tablet_lookups_by_group.find(*partition_group_start);
+      if (lookup_by_group_iter == table_data.tablet_lookups_by_group.end()) {
+        continue;
+      }
+      auto& lookups_by_partition_key = lookup_by_group_iter->second;
+      auto lookups_iter = lookups_by_partition_key.find(loc.partition().partition_key_start());
+      if (lookups_iter != lookups_by_partition_key.end()) {
+        for (auto& lookup : lookups_iter->second) {
+          RemoteTabletPtr remote = remotes[i];
+          if (!remote->partition().ContainsKey(lookup.partition_key)) {
+            remote = nullptr;
+            for (const auto& candidate : remotes) {
+              if (candidate->partition().ContainsKey(lookup.partition_key)) {
+                remote = candidate;
+                break;
               }
-              to_notify.push_back(std::move(lookup.callback));
             }
-            lookups_by_partition_key.erase(lookups_iter);
           }
-          if (lookups_by_partition_key.empty()) {
-            table_data.tablet_lookups_by_group.erase(lookup_by_group_iter);
+          if (!remote) {
+            to_notify.emplace_back(
+                std::move(lookup.callback),
+                STATUS(TryAgain, "Tablet was split, partition key should be looked up again"));
+            continue;
+          }
+          if (lookup.remote_tablet) {
+            *lookup.remote_tablet = remote;
           }
+          to_notify.emplace_back(std::move(lookup.callback), Status::OK());
         }
+        lookups_by_partition_key.erase(lookups_iter);
+      }
+      if (lookups_by_partition_key.empty()) {
+        table_data.tablet_lookups_by_group.erase(lookup_by_group_iter);
       }
     }
   }
 
-  for (const auto& callback : to_notify) {
-    callback.Run(Status::OK());
+  for (const auto& callback_and_status : to_notify) {
+    callback_and_status.first.Run(callback_and_status.second);
   }
 
   CHECK_NOTNULL(result.get());
@@ -850,6 +879,17 @@ class LookupByKeyRpc : public LookupRpc {
 
  private:
   void Finished(const Status& status) override {
+    if (status.ok() && !resp_.has_error()) {
+      // Tablets of the table could be split after it was opened.
+      std::vector<std::string> partition_starts;
+      partition_starts.reserve(resp_.tablet_locations_size());
+      for (const auto& location : resp_.tablet_locations()) {
+        if (location.table_id() == table_->id()) {
+          partition_starts.push_back(location.partition().partition_key_start());
+        }
+      }
+      table_->AddPartitionStarts(partition_starts);
+    }
     DoFinished(status, resp_, &partition_group_start_);
   }
 
@@ -952,7 +992,7 @@ void MetaCache::LookupTabletByKey(const YBTable* table,
     auto& table_data = tables_[table->id()];
     auto& lookup = table_data.tablet_lookups_by_group[partition_group_start];
     bool was_empty = lookup.empty();
-    lookup[partition_start].push_back({callback, remote_tablet, deadline});
+    lookup[partition_start].push_back({callback, remote_tablet, deadline, partition_key});
     if (!was_empty) {
       return;
     }
@@ -357,10 +357,12 @@ class MetaCache : public RefCountedThreadSafe<MetaCache> {
     StatusCallback callback;
     RemoteTabletPtr* remote_tablet;
     MonoTime deadline;
+    std::string partition_key;
 
     std::string ToString() const {
-      return Format("{ remote_tablet: $0 deadline: $1 }",
-                    static_cast<void*>(remote_tablet), deadline);
+      return Format("{ remote_tablet: $0 deadline: $1 partition_key: $2 }",
+                    static_cast<void*>(remote_tablet), deadline,
+                    Slice(partition_key).ToDebugHexString());
     }
   };
 
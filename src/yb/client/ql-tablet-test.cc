@@ -13,11 +13,13 @@
 //
 //
 
+#include <atomic>
 #include <shared_mutex>
 #include <thread>
 
 #include <boost/optional/optional.hpp>
 
+#include "yb/client/client-test-util.h"
 #include "yb/client/ql-dml-test-base.h"
 #include "yb/client/table_handle.h"
 
@@ -31,6 +33,7 @@
 #include "yb/master/master.h"
 
 #include "yb/tablet/tablet.h"
+#include "yb/tablet/tablet_metrics.h"
 
 #include "yb/server/test_clock.h"
 
@@ -48,6 +51,10 @@ DECLARE_uint64(initial_seqno);
 DECLARE_int32(leader_lease_duration_ms);
 DECLARE_int64(db_write_buffer_size);
 DECLARE_bool(use_test_clock);
+DECLARE_bool(enable_write_group_prepare);
+DECLARE_int32(write_group_delay_after_lock_ms_in_tests);
+DECLARE_int64(tablet_split_size_threshold_bytes);
+DECLARE_int32(tablet_creation_timeout_ms);
 
 namespace yb {
 namespace client {
@@ -119,10 +126,16 @@ class QLTabletTest : public QLDmlTestBase {
     return op;
   }
 
-  void CreateTable(const YBTableName& table_name, TableHandle* table, int num_tablets = 0) {
+  void CreateTable(const YBTableName& table_name, TableHandle* table, int num_tablets = 0,
+                   bool transactional = false) {
     YBSchemaBuilder builder;
     builder.AddColumn(kKey)->Type(INT32)->HashPrimaryKey()->NotNull();
     builder.AddColumn(kValue)->Type(INT32);
+    if (transactional) {
+      TableProperties table_properties;
+      table_properties.SetTransactional(true);
+      builder.SetTableProperties(table_properties);
+    }
 
     if (num_tablets == 0) {
       num_tablets = CalcNumTablets(3);
@@ -606,6 +619,87 @@ TEST_F(QLTabletTest, BoundaryValues) {
   }
 }
 
+// Concurrent non-transactional writes to a single tablet are locked in groups. Checks that writes
+// to distinct keys and conflicting writes to the same key are all applied, that lock latency is
+// recorded for each write, and that writes waiting for a hot key don't delay other writes.
+TEST_F(QLTabletTest, WriteGroups) {
+  google::FlagSaver saver;
+  FLAGS_enable_write_group_prepare = true;
+
+  constexpr int kThreads = 8;
+  constexpr int kKeysPerThread = 200;
+  constexpr int kHotKey = kThreads * kKeysPerThread;
+
+  TableHandle table;
+  CreateTable(kTable1Name, &table, 1);
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t != kThreads; ++t) {
+    threads.emplace_back([this, t, &table] {
+      auto session = CreateSession();
+      for (int i = t * kKeysPerThread; i != (t + 1) * kKeysPerThread; ++i) {
+        SetValue(session, i, ValueForKey(i), &table);
+        SetValue(session, kHotKey, ValueForKey(kHotKey), &table);
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  VerifyTable(0, kHotKey + 1, &table);
+
+  uint64_t locked_writes = 0;
+  for (int i = 0; i != cluster_->num_tablet_servers(); ++i) {
+    std::vector<tablet::TabletPeerPtr> peers;
+    cluster_->mini_tablet_server(i)->server()->tablet_manager()->GetTabletPeers(&peers);
+    for (const auto& peer : peers) {
+      locked_writes += peer->tablet()->metrics()->write_lock_latency->TotalCount();
+    }
+  }
+  ASSERT_GE(locked_writes, 2 * kHotKey);
+
+  // Writes to the hot key hold its lock for a long time now. Writes to distinct keys should not
+  // wait for them, i.e. their latency should stay close to the delay.
+  constexpr int kDelayMs = 500;
+  constexpr int kDistinctWrites = 5;
+  FLAGS_write_group_delay_after_lock_ms_in_tests = kDelayMs;
+  std::atomic<bool> stop(false);
+  threads.clear();
+  for (int t = 0; t != kThreads / 2; ++t) {
+    threads.emplace_back([this, &stop, &table] {
+      auto session = CreateSession();
+      while (!stop.load()) {
+        SetValue(session, kHotKey, ValueForKey(kHotKey), &table);
+      }
+    });
+  }
+  std::atomic<int64_t> max_latency_ms(0);
+  std::vector<std::thread> distinct_threads;
+  for (int t = 0; t != kThreads / 2; ++t) {
+    distinct_threads.emplace_back([this, t, &max_latency_ms, &table] {
+      auto session = CreateSession();
+      for (int i = t * kKeysPerThread; i != t * kKeysPerThread + kDistinctWrites; ++i) {
+        auto start = MonoTime::Now();
+        SetValue(session, i, ValueForKey(i), &table);
+        auto latency_ms = MonoTime::Now().GetDeltaSince(start).ToMilliseconds();
+        auto old_value = max_latency_ms.load();
+        while (latency_ms > old_value &&
+               !max_latency_ms.compare_exchange_weak(old_value, latency_ms)) {}
+      }
+    });
+  }
+  for (auto& thread : distinct_threads) {
+    thread.join();
+  }
+  stop = true;
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  LOG(INFO) << "Max latency of writes to distinct keys: " << max_latency_ms.load() << "ms";
+  ASSERT_LT(max_latency_ms.load(), kDelayMs * 2);
+}
+
 // There was bug with MvccManager when clocks were skewed.
 // Client tries to read from follower and max safe time is requested w/o any limits,
 // so new operations could be added with HT lower than returned.
@@ -654,5 +748,85 @@ TEST_F(QLTabletTest, SkewedClocks) {
   cluster_.reset();
 }
 
+// Intents of transactions are not moved to the new tablets yet, so tablets of transactional tables
+// should not be split.
+TEST_F(QLTabletTest, DontSplitTransactionalTablet) {
+  TableHandle table;
+  CreateTable(kTable1Name, &table, 1, true /* transactional */);
+
+  size_t num_peers = 0;
+  for (int i = 0; i != cluster_->num_tablet_servers(); ++i) {
+    std::vector<tablet::TabletPeerPtr> peers;
+    cluster_->mini_tablet_server(i)->server()->tablet_manager()->GetTabletPeers(&peers);
+    for (const auto& peer : peers) {
+      if (peer->tablet_metadata()->table_id() != table->id()) {
+        continue;
+      }
+      ++num_peers;
+      auto* tablet = peer->tablet();
+      ASSERT_TRUE(tablet->CheckSplitSupported().IsNotSupported());
+      auto split_key = tablet->GetEncodedMiddleSplitKey();
+      ASSERT_NOK(split_key);
+      ASSERT_TRUE(split_key.status().IsNotSupported()) << split_key.status();
+    }
+  }
+  ASSERT_GT(num_peers, 0);
+
+  std::vector<std::string> tablet_ids;
+  std::vector<std::string> ranges;
+  ASSERT_OK(client_->GetTablets(table.name(), 0, &tablet_ids, &ranges));
+  ASSERT_EQ(1, tablet_ids.size());
+
+  master::TabletSplitCandidatePB candidate;
+  candidate.set_tablet_id(tablet_ids[0]);
+  candidate.set_split_partition_key(PartitionSchema::EncodeMultiColumnHashValue(0x8000));
+  auto status = cluster_->mini_master()->master()->catalog_manager()->ProcessTabletSplitCandidate(
+      candidate);
+  ASSERT_TRUE(status.IsNotSupported()) << status;
+
+  tablet_ids.clear();
+  ranges.clear();
+  ASSERT_OK(client_->GetTablets(table.name(), 0, &tablet_ids, &ranges));
+  ASSERT_EQ(1, tablet_ids.size());
+}
+
+// Splits a tablet by size and checks that rows written before the split are read from both
+// children, that scans do not return rows of a sibling, and that the children are not replaced by
+// the master after tablet_creation_timeout_ms.
+TEST_F(QLTabletTest, SplitTablet) {
+  google::FlagSaver saver;
+  FLAGS_tablet_creation_timeout_ms = 3000;
+
+  TableHandle table;
+  CreateTable(kTable1Name, &table, 1);
+  FillTable(0, kTotalKeys, &table);
+  ASSERT_OK(cluster_->FlushTablets());
+
+  auto num_tablets = [this, &table]() -> Result<size_t> {
+    std::vector<std::string> tablet_ids;
+    std::vector<std::string> ranges;
+    RETURN_NOT_OK(client_->GetTablets(table.name(), 0, &tablet_ids, &ranges));
+    return tablet_ids.size();
+  };
+
+  // Children share SST files of the parent, so the threshold is reset after the first split to
+  // keep them from being split again.
+  FLAGS_tablet_split_size_threshold_bytes = 1;
+  ASSERT_OK(WaitFor([&num_tablets]() -> Result<bool> {
+    return VERIFY_RESULT(num_tablets()) >= 2;
+  }, 60s, "Wait for tablet split"));
+  FLAGS_tablet_split_size_threshold_bytes = 0;
+
+  VerifyTable(0, kTotalKeys, &table);
+  ASSERT_EQ(kTotalKeys, CountTableRows(table));
+
+  std::this_thread::sleep_for(FLAGS_tablet_creation_timeout_ms * 2ms);
+
+  VerifyTable(0, kTotalKeys, &table);
+  FillTable(kTotalKeys, 2 * kTotalKeys, &table);
+  ASSERT_EQ(2 * kTotalKeys, CountTableRows(table));
+  ASSERT_GE(ASSERT_RESULT(num_tablets()), 2);
+}
+
 } // namespace client
 } // namespace yb
@@ -54,6 +54,8 @@ DECLARE_uint64(max_clock_skew_usec);
 DECLARE_bool(transaction_allow_rerequest_status_in_tests);
 DECLARE_bool(use_test_clock);
 DECLARE_uint64(transaction_delay_status_reply_usec_in_tests);
+DECLARE_uint64(txn_max_apply_batch_records);
+DECLARE_bool(transaction_pause_background_apply_in_tests);
 
 namespace yb {
 namespace client {
@@ -658,6 +660,29 @@ TEST_F(QLTransactionTest, ResendApplying) {
   ASSERT_OK(cluster_->RestartSync());
 }
 
+// Intents are applied in several batches, so reads should resolve not yet applied intents.
+// Coordinator should be notified when background apply completes, also after restart.
+TEST_F(QLTransactionTest, ApplyInBackground) {
+  google::FlagSaver flag_saver;
+
+  FLAGS_txn_max_apply_batch_records = 1;
+  SetAtomicFlag(true, &FLAGS_transaction_pause_background_apply_in_tests);
+  WriteData();
+  VerifyData();
+  ASSERT_NE(0, CountTransactions());
+
+  ASSERT_OK(cluster_->RestartSync());
+  VerifyData();
+  ASSERT_NE(0, CountTransactions());
+
+  SetAtomicFlag(false, &FLAGS_transaction_pause_background_apply_in_tests);
+  ASSERT_OK(WaitFor(
+      [this] { return CountTransactions() == 0; }, kTransactionApplyTime, "Transactions cleaned"));
+  VerifyData();
+  ASSERT_OK(cluster_->RestartSync());
+  VerifyData();
+}
+
 TEST_F(QLTransactionTest, ConflictResolution) {
   google::FlagSaver flag_saver;
 
@@ -22,6 +22,8 @@
 
 #include "yb/tserver/tserver_service.proxy.h"
 
+#include "yb/util/random_util.h"
+
 namespace yb {
 namespace client {
 namespace internal {
@@ -210,6 +212,27 @@ bool TabletInvoker::Done(Status* status) {
     *status = resp_error_status;
   }
 
+  // The table or its namespace is over its quota, so retry the same server after the delay it
+  // suggested. Jitter is added, so clients throttled at the same time do not retry together.
+  if (ErrorCode(rpc_->response_error()) == tserver::TabletServerErrorPB::OPERATION_THROTTLED) {
+    const int retry_after_ms = rpc_->response_error()->retry_after_ms();
+    auto delay = MonoDelta::FromMilliseconds(
+        retry_after_ms + RandomUniformInt(0, std::max(retry_after_ms / 2, 1)));
+    auto retry_status = retrier_->DelayedRetry(command_, *status, delay);
+    LOG_IF(DFATAL, !retry_status.ok()) << "Retry failed: " << retry_status;
+    return false;
+  }
+
+  // Operations of this RPC could belong to different tablets created by the split, so it is not
+  // retried here. The tablet is invalidated in the meta cache, and the owner of the RPC looks up
+  // tablets of its operations again, see AsyncRpc::Finished.
+  if (ErrorCode(rpc_->response_error()) == tserver::TabletServerErrorPB::TABLET_SPLIT) {
+    if (tablet_ != nullptr) {
+      tablet_->MarkStale();
+    }
+    return true;
+  }
+
   // Oops, we failed over to a replica that wasn't a LEADER. Unlikely as
   // we're using consensus configuration information from the master, but still possible
   // (e.g. leader restarted and became a FOLLOWER). Try again.
@@ -113,6 +113,10 @@ class DocHybridTime {
   // key in *encoded_ht_size, and verifies that it is within the allowed limits.
   static CHECKED_STATUS CheckAndGetEncodedSize(const Slice& encoded_key, int* encoded_ht_size);
 
+  // Retrieves the size of the encode DocHybridTime from the end of the given DocDB-encoded
+  // RocksDB key. There is no error checking here. This returns 0 if the slice is empty.
+  static int GetEncodedSize(const Slice& encoded_key);
+
   bool is_valid() const { return hybrid_time_.is_valid(); }
 
  private:
@@ -125,10 +129,6 @@ class DocHybridTime {
   // inequality is because we must also leave room for a ValueType::kHybridTime. In practice,
   // the preceding DocKey will also take a non-zero number of bytes.
   static CHECKED_STATUS CheckEncodedSize(int encoded_ht_size, size_t encoded_key_size);
-
-  // Retrieves the size of the encode DocHybridTime from the end of the given DocDB-encoded
-  // RocksDB key. There is no error checking here. This returns 0 if the slice is empty.
-  static int GetEncodedSize(const Slice& encoded_key);
 };
 
 inline std::ostream& operator<<(std::ostream& os, const DocHybridTime& ht) {
@@ -420,7 +420,8 @@ YB_DEFINE_ENUM(StateChangeReason,
     (NEW_LEADER_ELECTED)
     (FOLLOWER_NO_OP_COMPLETE)
     (LEADER_CONFIG_CHANGE_COMPLETE)
-    (FOLLOWER_CONFIG_CHANGE_COMPLETE));
+    (FOLLOWER_CONFIG_CHANGE_COMPLETE)
+    (TABLET_PEER_FAILED));
 
 // Context provided for callback on master/tablet-server peer state change for post processing
 // e.g., update in-memory contents.
@@ -472,6 +473,8 @@ struct StateChangeContext {
       case StateChangeReason::FOLLOWER_CONFIG_CHANGE_COMPLETE:
         return strings::Substitute("Config change $0 complete on follower",
           change_record.ShortDebugString());
+      case StateChangeReason::TABLET_PEER_FAILED:
+        return "TabletPeer failed";
       case StateChangeReason::INVALID_REASON: FALLTHROUGH_INTENDED;
       default:
         return "INVALID REASON";
@@ -516,6 +519,12 @@ class ReplicaOperationFactory {//DHQ: TabletPeer继承此类，实现了方法
       const ConsensusRoundPtr& context, HybridTime propagated_safe_time) = 0;
   virtual void SetPropagatedSafeTime(HybridTime ht) = 0;
 
+  // Invoked by follower around a run of consecutive committed write operations it applies, so
+  // their changes could be written together. Operations applied while the batch is active could
+  // complete only in FinishApplyBatch.
+  virtual void StartApplyBatch() {}
+  virtual void FinishApplyBatch() {}
+
   virtual ~ReplicaOperationFactory() {}
 };
 //DHQ: LEADER side的 context
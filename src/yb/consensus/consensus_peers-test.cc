@@ -31,6 +31,7 @@
 //
 
 #include <chrono>
+#include <mutex>
 
 #include <gtest/gtest.h>
 
@@ -56,6 +57,9 @@ using namespace std::chrono_literals;
 
 METRIC_DECLARE_entity(tablet);
 
+DECLARE_int32(consensus_max_batch_size_bytes);
+DECLARE_int32(raft_pipelining_min_rtt_us);
+
 namespace yb {
 namespace consensus {
 
@@ -289,6 +293,101 @@ TEST_F(ConsensusPeersTest, TestRemotePeers) {
   WaitForMajorityReplicatedIndex(2);
 }
 
+// Emulates a follower that processes a pipelined request after the request that was sent next,
+// like requests reordered by the follower's RPC threads.
+class ReorderingPeerProxy : public NoOpTestPeerProxy {
+ public:
+  ReorderingPeerProxy(ThreadPool* pool, const RaftPeerPB& peer_pb)
+      : NoOpTestPeerProxy(pool, peer_pb) {}
+
+  // The next request with operations is processed after the following one.
+  void HoldNextRequest() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    hold_next_ = true;
+  }
+
+  int num_rejected() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return num_rejected_;
+  }
+
+  void UpdateAsync(const ConsensusRequestPB* request,
+                   ConsensusResponsePB* response,
+                   rpc::RpcController* controller,
+                   const rpc::ResponseCallback& callback) override {
+    HeldRequest held;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (hold_next_ && request->ops_size() > 0) {
+        hold_next_ = false;
+        held_ = HeldRequest{request, response, controller, callback};
+        return;
+      }
+      std::swap(held, held_);
+      if (OpIdLessThan(last_received(), request->preceding_id())) {
+        ++num_rejected_;
+      }
+    }
+    NoOpTestPeerProxy::UpdateAsync(request, response, controller, callback);
+    if (held.request) {
+      NoOpTestPeerProxy::UpdateAsync(held.request, held.response, held.controller, held.callback);
+    }
+  }
+
+ private:
+  struct HeldRequest {
+    const ConsensusRequestPB* request = nullptr;
+    ConsensusResponsePB* response = nullptr;
+    rpc::RpcController* controller = nullptr;
+    rpc::ResponseCallback callback;
+  };
+
+  std::mutex mutex_;
+  bool hold_next_ = false;
+  HeldRequest held_;
+  int num_rejected_ = 0;
+};
+
+// Tests that a pipelined request received by the follower before the preceding one is resent
+// without shrinking the pipelining window.
+TEST_F(ConsensusPeersTest, TestReorderedPipelinedRequests) {
+  google::FlagSaver flag_saver;
+  FLAGS_consensus_max_batch_size_bytes = 1024;
+  FLAGS_raft_pipelining_min_rtt_us = 0;
+  constexpr int kNumOps = 100;
+  constexpr int kPayloadSize = 100;
+
+  auto proxy = new ReorderingPeerProxy(raft_pool_.get(), FakeRaftPeerPB(kFollowerUuid));
+  std::unique_ptr<Peer> peer;
+  ASSERT_OK(Peer::NewRemotePeer(FakeRaftPeerPB(kFollowerUuid),
+                                kTabletId,
+                                kLeaderUuid,
+                                message_queue_.get(),
+                                raft_pool_token_.get(),
+                                gscoped_ptr<PeerProxy>(proxy),
+                                nullptr,
+                                &peer));
+  peer->SetTermForTest(kNumOps / 7);
+
+  // Replicate operations in several requests, so the window grows.
+  AppendReplicateMessagesToQueue(message_queue_.get(), clock_, 1, kNumOps / 2, kPayloadSize);
+  ASSERT_OK(peer->SignalRequest(RequestTriggerMode::NON_EMPTY_ONLY));
+  WaitForMajorityReplicatedIndex(kNumOps / 2);
+  ASSERT_GT(peer->GetWindowForTests(), 1);
+
+  // The first request with the following operations is pipelined with the next one, that overtakes
+  // it and is rejected by the follower.
+  proxy->HoldNextRequest();
+  AppendReplicateMessagesToQueue(
+      message_queue_.get(), clock_, kNumOps / 2 + 1, kNumOps / 2, kPayloadSize);
+  ASSERT_OK(peer->SignalRequest(RequestTriggerMode::NON_EMPTY_ONLY));
+  WaitForMajorityReplicatedIndex(kNumOps);
+
+  ASSERT_GE(proxy->num_rejected(), 1);
+  ASSERT_EQ(yb::OpId::FromPB(proxy->last_received()), yb::OpId(kNumOps / 7, kNumOps));
+  ASSERT_GT(peer->GetWindowForTests(), 1);
+}
+
 // Regression test for KUDU-699: even if a peer isn't making progress,
 // and thus always has data pending, we should be able to close the peer.
 TEST_F(ConsensusPeersTest, TestCloseWhenRemotePeerDoesntMakeProgress) {
@@ -47,6 +47,7 @@
 #include "yb/consensus/consensus.proxy.h"
 #include "yb/consensus/consensus_queue.h"
 #include "yb/consensus/log.h"
+#include "yb/consensus/multi_raft_batcher.h"
 #include "yb/gutil/map-util.h"
 #include "yb/gutil/stl_util.h"
 #include "yb/gutil/strings/substitute.h"
@@ -63,6 +64,27 @@ DEFINE_int32(consensus_rpc_timeout_ms, 2000,
              "Timeout used for all consensus internal RPC communications.");
 TAG_FLAG(consensus_rpc_timeout_ms, advanced);
 
+DEFINE_int32(raft_max_inflight_requests_per_peer, 4,
+             "Max number of UpdateConsensus requests that the leader could have in flight to a "
+             "single peer. The actual number is adapted to the round trip time and follower lag. "
+             "1 disables pipelining.");
+TAG_FLAG(raft_max_inflight_requests_per_peer, advanced);
+
+DEFINE_int32(raft_pipelining_min_rtt_us, 500,
+             "Requests to a peer are pipelined only when the average round trip time to it is "
+             "at least this many microseconds.");
+TAG_FLAG(raft_pipelining_min_rtt_us, advanced);
+
+DEFINE_int32(raft_pipelining_max_follower_lag_ops, 1000,
+             "Shrink the window of pipelined requests to a peer when it lags behind the leader's "
+             "committed index by more than this number of operations.");
+TAG_FLAG(raft_pipelining_max_follower_lag_ops, advanced);
+
+DEFINE_bool(enable_multi_raft_heartbeat_batcher, true,
+            "Batch heartbeats of idle tablets to the same server into a single RPC.");
+TAG_FLAG(enable_multi_raft_heartbeat_batcher, advanced);
+TAG_FLAG(enable_multi_raft_heartbeat_batcher, runtime);
+
 DECLARE_int32(raft_heartbeat_interval_ms);
 
 DEFINE_test_flag(double, fault_crash_on_leader_request_fraction, 0.0,
@@ -116,16 +138,31 @@ Peer::Peer(
       proxy_(proxy.Pass()),
       queue_(queue),
       failed_attempts_(0),
-      sem_(1),
+      max_in_flight_requests_(std::max(FLAGS_raft_max_inflight_requests_per_peer, 1)),
+      sem_(max_in_flight_requests_),
       heartbeater_(
           peer_pb.permanent_uuid(), MonoDelta::FromMilliseconds(FLAGS_raft_heartbeat_interval_ms),
           std::bind(&Peer::SignalRequest, this, RequestTriggerMode::ALWAYS_SEND)),
       raft_pool_token_(raft_pool_token),
       state_(kPeerCreated),
-      consensus_(consensus) {}
+      consensus_(consensus) {
+  requests_.reserve(max_in_flight_requests_);
+  free_requests_.reserve(max_in_flight_requests_);
+  for (int i = 0; i != max_in_flight_requests_; ++i) {
+    requests_.push_back(std::make_unique<InFlightRequest>());
+    free_requests_.push_back(requests_.back().get());
+  }
+}
 
 void Peer::SetTermForTest(int term) {
-  response_.set_responder_term(term);
+  for (const auto& request : requests_) {
+    request->response.set_responder_term(term);
+  }
+}
+
+int Peer::GetWindowForTests() {
+  std::lock_guard<simple_spinlock> l(peer_lock_);
+  return window_;
 }
 
 Status Peer::Init() {
@@ -137,8 +174,14 @@ Status Peer::Init() {
 }
 
 Status Peer::SignalRequest(RequestTriggerMode trigger_mode) {
-  // If the peer is currently sending, return Status::OK().
-  // If there are new requests in the queue we'll get them on ProcessResponse().
+  {
+    std::lock_guard<simple_spinlock> l(peer_lock_);
+    // If the peer is currently sending as many requests as allowed, return Status::OK().
+    // If there are new requests in the queue we'll get them on ProcessResponse().
+    if (in_flight_ >= window_) {
+      return Status::OK();
+    }
+  }
   if (!sem_.TryAcquire()) {
     return Status::OK();
   }
@@ -180,28 +223,56 @@ Status Peer::SignalRequest(RequestTriggerMode trigger_mode) {
   return status;
 }
 
-void Peer::SendNextRequest(RequestTriggerMode trigger_mode) {//DHQ: 这个是Peer的方法，不是整个consensus_的方法
-  DCHECK_LE(sem_.GetValue(), 0) << "Cannot send request";
+void Peer::SendNextRequest(RequestTriggerMode trigger_mode) {
+  std::lock_guard<std::mutex> lock(send_mutex_);
+  DoSendNextRequest(trigger_mode);
+}
+
+void Peer::DoSendNextRequest(RequestTriggerMode trigger_mode) {//DHQ: 这个是Peer的方法，不是整个consensus_的方法
+  DCHECK_LT(sem_.GetValue(), max_in_flight_requests_) << "Cannot send request";
+
+  InFlightRequest* in_flight_request;
+  bool pipelined;
+  {
+    std::lock_guard<simple_spinlock> l(peer_lock_);
+    if (in_flight_ >= window_) {
+      // The window was filled or shrunk since this request was signaled.
+      sem_.Release();
+      return;
+    }
+    CHECK(!free_requests_.empty());
+    in_flight_request = free_requests_.back();
+    free_requests_.pop_back();
+    // Heartbeats are not needed while other requests are in flight, we only send more operations.
+    pipelined = in_flight_ > 0;
+  }
+  in_flight_request->info.pipelined = pipelined;
+  auto& request = in_flight_request->request;
 
   // The peer has no pending request nor is sending: send the request.
   bool needs_remote_bootstrap = false;
   bool last_exchange_successful = false;
   RaftPeerPB::MemberType member_type = RaftPeerPB::UNKNOWN_MEMBER_TYPE;
-  int64_t commit_index_before = request_.has_committed_index() ?
-      request_.committed_index().index() : kMinimumOpIdIndex; //DHQ: 实际上可以指定个committed_index?
-  Status s = queue_->RequestForPeer(peer_pb_.permanent_uuid(), &request_,
-      &replicate_msg_refs_, &needs_remote_bootstrap, &member_type, &last_exchange_successful);//DHQ: 获得该peer的下一个request
-  int64_t commit_index_after = request_.has_committed_index() ?
-      request_.committed_index().index() : kMinimumOpIdIndex;
+  int64_t commit_index_before = last_sent_committed_index_; //DHQ: 实际上可以指定个committed_index?
+  Status s = queue_->RequestForPeer(peer_pb_.permanent_uuid(), &request,
+      &in_flight_request->replicate_msg_refs, &needs_remote_bootstrap, &member_type,
+      &last_exchange_successful, &in_flight_request->info);//DHQ: 获得该peer的下一个request
+  int64_t commit_index_after = request.has_committed_index() ?
+      request.committed_index().index() : kMinimumOpIdIndex;
 
   if (PREDICT_FALSE(!s.ok())) {
     LOG_WITH_PREFIX_UNLOCKED(INFO) << "Could not obtain request from queue for peer: "
         << peer_pb_.permanent_uuid() << ". Status: " << s.ToString();
-    sem_.Release();
+    FinishRequest(in_flight_request);
     return;
   }
 
   if (PREDICT_FALSE(needs_remote_bootstrap)) {
+    {
+      // The unit of sem_ is kept until the remote bootstrap response is received.
+      std::lock_guard<simple_spinlock> l(peer_lock_);
+      free_requests_.push_back(in_flight_request);
+    }
     Status s = SendRemoteBootstrapRequest();
     if (!s.ok()) {
       LOG_WITH_PREFIX_UNLOCKED(WARNING) << "Unable to generate remote bootstrap request for peer: "
@@ -216,7 +287,8 @@ void Peer::SendNextRequest(RequestTriggerMode trigger_mode) {//DHQ: 这个是Pee
   if (last_exchange_successful &&
       (member_type == RaftPeerPB::PRE_VOTER || member_type == RaftPeerPB::PRE_OBSERVER)) {//DHQ: 可以发消息是，premote对方
     if (PREDICT_TRUE(consensus_)) {
-      sem_.Release();
+      queue_->RequestNotSent(peer_pb_.permanent_uuid(), request);
+      FinishRequest(in_flight_request);
       consensus::ChangeConfigRequestPB req;
       consensus::ChangeConfigResponsePB resp;
 
@@ -244,16 +316,25 @@ void Peer::SendNextRequest(RequestTriggerMode trigger_mode) {//DHQ: 这个是Pee
     }
   }
 
-  request_.set_tablet_id(tablet_id_);
-  request_.set_caller_uuid(leader_uuid_);
-  request_.set_dest_uuid(peer_pb_.permanent_uuid());
+  // Don't pipeline requests until the peer has successfully accepted the previous ones, the
+  // outstanding requests would be rejected anyway.
+  if (pipelined && !last_exchange_successful) {
+    queue_->RequestNotSent(peer_pb_.permanent_uuid(), request);
+    FinishRequest(in_flight_request);
+    return;
+  }
+
+  request.set_tablet_id(tablet_id_);
+  request.set_caller_uuid(leader_uuid_);
+  request.set_dest_uuid(peer_pb_.permanent_uuid());
 
-  const bool req_has_ops = (request_.ops_size() > 0) || (commit_index_after > commit_index_before);
+  const bool req_has_ops = (request.ops_size() > 0) || (commit_index_after > commit_index_before);
 
   // If the queue is empty, check if we were told to send a status-only message (which is what
   // happens during heartbeats). If not, just return.
-  if (PREDICT_FALSE(!req_has_ops && trigger_mode == RequestTriggerMode::NON_EMPTY_ONLY)) {
-    sem_.Release();
+  if (PREDICT_FALSE(!req_has_ops &&
+                    (trigger_mode == RequestTriggerMode::NON_EMPTY_ONLY || pipelined))) {
+    FinishRequest(in_flight_request);
     return;
   }
 
@@ -261,20 +342,46 @@ void Peer::SendNextRequest(RequestTriggerMode trigger_mode) {//DHQ: 这个是Pee
   if (req_has_ops) {
     heartbeater_.Reset();
   }
+  last_sent_committed_index_ = commit_index_after;
 
   MAYBE_FAULT(FLAGS_fault_crash_on_leader_request_fraction);
-  controller_.Reset();
+  in_flight_request->controller.Reset();
+  in_flight_request->send_time = MonoTime::Now();
+
+  bool send_more;
+  {
+    std::lock_guard<simple_spinlock> l(peer_lock_);
+    ++in_flight_;
+    send_more = request.ops_size() > 0 && in_flight_ < window_;
+  }
 
-  proxy_->UpdateAsync(&request_, &response_, &controller_, std::bind(&Peer::ProcessResponse, this));
+  auto callback = std::bind(&Peer::ProcessResponse, this, in_flight_request);
+  if (!req_has_ops && last_exchange_successful) {
+    // Nothing changed since the last exchange, so it is just a heartbeat that extends the leader
+    // lease, it could be batched with heartbeats of other idle tablets.
+    proxy_->HeartbeatAsync(&request, &in_flight_request->response, &in_flight_request->controller,
+                           callback);
+  } else {
+    proxy_->UpdateAsync(&request, &in_flight_request->response, &in_flight_request->controller,
+                        callback);
+  }
+
+  // There could be more operations to send, pipeline them without waiting for the response.
+  if (send_more) {
+    WARN_NOT_OK(SignalRequest(RequestTriggerMode::NON_EMPTY_ONLY),
+                "Failed to pipeline request");
+  }
 }
 
-void Peer::ProcessResponse() {
+void Peer::ProcessResponse(InFlightRequest* request) {
   // Note: This method runs on the reactor thread.
 
-  DCHECK_LE(sem_.GetValue(), 0) << "Got a response when nothing was pending";
+  DCHECK_LT(sem_.GetValue(), max_in_flight_requests_) << "Got a response when nothing was pending";
 
-  if (!controller_.status().ok()) {
-    if (controller_.status().IsRemoteError()) {
+  const auto& controller = request->controller;
+  const auto& response = request->response;
+  if (!controller.status().ok()) {
+    if (controller.status().IsRemoteError()) {
       // Most controller errors are caused by network issues or corner cases like shutdown and
       // failure to serialize a protobuf. Therefore, we generally consider these errors to indicate
       // an unreachable peer.  However, a RemoteError wraps some other error propagated from the
@@ -282,62 +389,144 @@ void Peer::ProcessResponse() {
       // remote is responsive.
       queue_->NotifyPeerIsResponsiveDespiteError(peer_pb_.permanent_uuid());
     }
-    ProcessResponseError(controller_.status());
+    ProcessResponseError(request, controller.status());
     return;
   }
 
   // We should try to evict a follower which returns a WRONG UUID error.
-  if (response_.has_error() &&
-      response_.error().code() == tserver::TabletServerErrorPB::WRONG_SERVER_UUID) {//DHQ: wrong UUID，直接evict掉。
+  if (response.has_error() &&
+      response.error().code() == tserver::TabletServerErrorPB::WRONG_SERVER_UUID) {//DHQ: wrong UUID，直接evict掉。
     queue_->NotifyObserversOfFailedFollower(
         peer_pb_.permanent_uuid(),
         Substitute("Leader communication with peer $0 received error $1, will try to "
                    "evict peer", peer_pb_.permanent_uuid(),
-                   response_.error().ShortDebugString()));
-    ProcessResponseError(StatusFromPB(response_.error().status()));
+                   response.error().ShortDebugString()));
+    ProcessResponseError(request, StatusFromPB(response.error().status()));
+    return;
+  }
+
+  // A replica that failed, e.g. because the data scrubber found its data corrupted, does not
+  // recover by itself. It is evicted, so the load balancer replaces it via remote bootstrap.
+  if (response.has_error() &&
+      response.error().code() == tserver::TabletServerErrorPB::TABLET_FAILED) {
+    queue_->NotifyPeerIsResponsiveDespiteError(peer_pb_.permanent_uuid());
+    queue_->NotifyObserversOfFailedReplica(
+        peer_pb_.permanent_uuid(),
+        Substitute("Peer $0 failed: $1, will try to evict peer", peer_pb_.permanent_uuid(),
+                   response.error().ShortDebugString()));
+    ProcessResponseError(request, StatusFromPB(response.error().status()));
     return;
   }
 
   // Pass through errors we can respond to, like not found, since in that case
   // we will need to remotely bootstrap. TODO: Handle DELETED response once implemented.
-  if ((response_.has_error() &&
-      response_.error().code() != tserver::TabletServerErrorPB::TABLET_NOT_FOUND) ||
-      (response_.status().has_error() &&
-          response_.status().error().code() == consensus::ConsensusErrorPB::CANNOT_PREPARE)) {
+  if ((response.has_error() &&
+      response.error().code() != tserver::TabletServerErrorPB::TABLET_NOT_FOUND) ||
+      (response.status().has_error() &&
+          response.status().error().code() == consensus::ConsensusErrorPB::CANNOT_PREPARE)) {
     // Again, let the queue know that the remote is still responsive, since we will not be sending
     // this error response through to the queue.
     queue_->NotifyPeerIsResponsiveDespiteError(peer_pb_.permanent_uuid());
-    ProcessResponseError(StatusFromPB(response_.error().status()));
+    ProcessResponseError(request, StatusFromPB(response.error().status()));
     return;
   }
 
   // The queue's handling of the peer response may generate IO (reads against the WAL) and
   // SendNextRequest() may do the same thing. So we run the rest of the response handling logic on
   // our thread pool and not on the reactor thread.
-  Status s = raft_pool_token_->SubmitClosure(Bind(&Peer::DoProcessResponse, Unretained(this))); //DHQ: 调用新函数
+  Status s = raft_pool_token_->SubmitClosure(
+      Bind(&Peer::DoProcessResponse, Unretained(this), request)); //DHQ: 调用新函数
   if (PREDICT_FALSE(!s.ok())) {
     LOG_WITH_PREFIX_UNLOCKED(WARNING) << "Unable to process peer response: " << s.ToString()
-        << ": " << response_.ShortDebugString();
-    sem_.Release();
+        << ": " << response.ShortDebugString();
+    {
+      std::lock_guard<simple_spinlock> l(peer_lock_);
+      --in_flight_;
+    }
+    FinishRequest(request);
   }
 }
 
-void Peer::DoProcessResponse() {
+void Peer::DoProcessResponse(InFlightRequest* request) {
+  std::lock_guard<std::mutex> lock(send_mutex_);
   failed_attempts_ = 0;
 
   bool more_pending;//DHQ: 我理解，more_pending大部分时候表示，对方式落后的，需要继续发消息
-  queue_->ResponseFromPeer(peer_pb_.permanent_uuid(), response_, &more_pending);//DHQ: 这个ResponseFromPeer，本地append完成也会调用
+  queue_->ResponseFromPeer(
+      peer_pb_.permanent_uuid(), request->response, &more_pending, &request->info);//DHQ: 这个ResponseFromPeer，本地append完成也会调用
+
+  UpdateWindow(*request, more_pending);
+
+  // The unit of sem_ acquired for this request is reused to send the next one.
+  bool has_in_flight;
+  {
+    std::lock_guard<simple_spinlock> l(peer_lock_);
+    request->request.mutable_ops()->ExtractSubrange(0, request->request.ops_size(), nullptr);
+    request->replicate_msg_refs.clear();
+    free_requests_.push_back(request);
+    --in_flight_;
+    has_in_flight = in_flight_ > 0;
+  }
 
   // We're OK to read the state_ without a lock here -- if we get a race,
   // the worst thing that could happen is that we'll make one more request before
   // noticing a close.
   if (more_pending && ANNOTATE_UNPROTECTED_READ(state_) != kPeerClosed) {
-    SendNextRequest(RequestTriggerMode::ALWAYS_SEND);//DHQ: 对应Peer还落后着，继续发。
+    // When other requests are in flight, their responses will trigger the following requests,
+    // so only send new operations here.
+    DoSendNextRequest(has_in_flight ? RequestTriggerMode::NON_EMPTY_ONLY
+                                    : RequestTriggerMode::ALWAYS_SEND);//DHQ: 对应Peer还落后着，继续发。
   } else {
     sem_.Release();
   }
 }
 
+void Peer::UpdateWindow(const InFlightRequest& request, bool more_pending) {
+  const auto rtt_us = MonoTime::Now().GetDeltaSince(request.send_time).ToMicroseconds();
+  const auto& status = request.response.status();
+  const int64_t commit_lag = request.request.has_committed_index()
+      ? request.request.committed_index().index() - status.last_committed_idx() : 0;
+
+  std::lock_guard<simple_spinlock> l(peer_lock_);
+  // Heartbeats could be delayed by batching, so only requests with operations are used to
+  // measure the round trip time.
+  if (request.request.ops_size() > 0) {
+    rtt_us_ = rtt_us_ == 0 ? rtt_us : (rtt_us_ * 7 + rtt_us) / 8;
+  }
+  int new_window;
+  if (rtt_us_ < FLAGS_raft_pipelining_min_rtt_us ||
+      (status.has_error() && !request.info.reordered)) {
+    // On low latency links pipelining does not help, and after an error the peer should be
+    // resynchronized before sending more. The peer could receive pipelined requests out of order,
+    // such a rejection is not an error, its operations are just resent.
+    new_window = 1;
+  } else if (commit_lag > FLAGS_raft_pipelining_max_follower_lag_ops) {
+    // The follower does not keep up with applying what we send, don't push it any further.
+    new_window = std::max(window_ / 2, 1);
+  } else if (more_pending) {
+    new_window = std::min(window_ + 1, max_in_flight_requests_);
+  } else {
+    new_window = window_;
+  }
+  if (new_window != window_) {
+    VLOG_WITH_PREFIX_UNLOCKED(2) << "Pipelining window changed from " << window_ << " to "
+                                 << new_window << ", rtt: " << rtt_us_ << "us, commit lag: "
+                                 << commit_lag;
+    window_ = new_window;
+  }
+}
+
+void Peer::FinishRequest(InFlightRequest* request) {
+  {
+    std::lock_guard<simple_spinlock> l(peer_lock_);
+    // We don't own the ops (the queue does).
+    request->request.mutable_ops()->ExtractSubrange(0, request->request.ops_size(), nullptr);
+    request->replicate_msg_refs.clear();
+    free_requests_.push_back(request);
+  }
+  sem_.Release();
+}
+
 Status Peer::SendRemoteBootstrapRequest() {
   if (!FLAGS_enable_remote_bootstrap) {
     failed_attempts_++;
@@ -346,9 +535,9 @@ Status Peer::SendRemoteBootstrapRequest() {
 
   LOG_WITH_PREFIX_UNLOCKED(INFO) << "Sending request to remotely bootstrap";
   RETURN_NOT_OK(queue_->GetRemoteBootstrapRequestForPeer(peer_pb_.permanent_uuid(), &rb_request_));
-  controller_.Reset();
+  rb_controller_.Reset();
   proxy_->StartRemoteBootstrap(
-      &rb_request_, &rb_response_, &controller_,
+      &rb_request_, &rb_response_, &rb_controller_,
       std::bind(&Peer::ProcessRemoteBootstrapResponse, this));
   return Status::OK();
 }
@@ -362,13 +551,18 @@ void Peer::ProcessRemoteBootstrapResponse() {
   sem_.Release();
 }
 
-void Peer::ProcessResponseError(const Status& status) {
+void Peer::ProcessResponseError(InFlightRequest* request, const Status& status) {
   failed_attempts_++;
   LOG_WITH_PREFIX_UNLOCKED(WARNING) << "Couldn't send request to peer " << peer_pb_.permanent_uuid()
       << " for tablet " << tablet_id_
       << " Status: " << status.ToString() << ". Retrying in the next heartbeat period."
       << " Already tried " << failed_attempts_ << " times.";
-  sem_.Release();
+  {
+    std::lock_guard<simple_spinlock> l(peer_lock_);
+    --in_flight_;
+    window_ = 1;
+  }
+  FinishRequest(request);
 }
 
 string Peer::LogPrefixUnlocked() const {
@@ -389,14 +583,21 @@ void Peer::Close() {
   }
   LOG_WITH_PREFIX_UNLOCKED(INFO) << "Closing peer: " << peer_pb_.permanent_uuid();
 
-  // Acquire the semaphore to wait for any concurrent request to finish.  They will see the state_
-  // == kPeerClosed and not start any new requests, but we can't currently cancel the already-sent
-  // ones. (see KUDU-699)
-  std::lock_guard<Semaphore> l(sem_);
+  // Acquire all units of the semaphore to wait for any concurrent requests to finish.  They will
+  // see the state_ == kPeerClosed and not start any new requests, but we can't currently cancel
+  // the already-sent ones. (see KUDU-699)
+  for (int i = 0; i != max_in_flight_requests_; ++i) {
+    sem_.Acquire();
+  }
   queue_->UntrackPeer(peer_pb_.permanent_uuid());
-  // We don't own the ops (the queue does).
-  request_.mutable_ops()->ExtractSubrange(0, request_.ops_size(), nullptr);
-  replicate_msg_refs_.clear();
+  for (const auto& request : requests_) {
+    // We don't own the ops (the queue does).
+    request->request.mutable_ops()->ExtractSubrange(0, request->request.ops_size(), nullptr);
+    request->replicate_msg_refs.clear();
+  }
+  for (int i = 0; i != max_in_flight_requests_; ++i) {
+    sem_.Release();
+  }
 }
 
 Peer::~Peer() {
@@ -404,9 +605,11 @@ Peer::~Peer() {
 }
 
 RpcPeerProxy::RpcPeerProxy(gscoped_ptr<HostPort> hostport,
-                           gscoped_ptr<ConsensusServiceProxy> consensus_proxy)
+                           gscoped_ptr<ConsensusServiceProxy> consensus_proxy,
+                           std::shared_ptr<MultiRaftHeartbeatBatcher> multi_raft_batcher)
     : hostport_(hostport.Pass()),
-      consensus_proxy_(consensus_proxy.Pass()) {
+      consensus_proxy_(consensus_proxy.Pass()),
+      multi_raft_batcher_(std::move(multi_raft_batcher)) {
 }
 
 void RpcPeerProxy::UpdateAsync(const ConsensusRequestPB* request,
@@ -417,6 +620,17 @@ void RpcPeerProxy::UpdateAsync(const ConsensusRequestPB* request,
   consensus_proxy_->UpdateConsensusAsync(*request, response, controller, callback);
 }
 
+void RpcPeerProxy::HeartbeatAsync(const ConsensusRequestPB* request,
+                                  ConsensusResponsePB* response,
+                                  rpc::RpcController* controller,
+                                  const rpc::ResponseCallback& callback) {
+  if (multi_raft_batcher_ && FLAGS_enable_multi_raft_heartbeat_batcher) {
+    multi_raft_batcher_->AddRequestToBatch(request, response, controller, callback);
+  } else {
+    UpdateAsync(request, response, controller, callback);
+  }
+}
+
 void RpcPeerProxy::RequestConsensusVoteAsync(const VoteRequestPB* request,
                                              VoteResponsePB* response,
                                              rpc::RpcController* controller,
@@ -466,8 +680,9 @@ Status CreateConsensusServiceProxyForHost(const shared_ptr<Messenger>& messenger
 
 } // anonymous namespace
 
-RpcPeerProxyFactory::RpcPeerProxyFactory(shared_ptr<Messenger> messenger)
-    : messenger_(std::move(messenger)) {}
+RpcPeerProxyFactory::RpcPeerProxyFactory(shared_ptr<Messenger> messenger,
+                                         MultiRaftManager* multi_raft_manager)
+    : messenger_(std::move(messenger)), multi_raft_manager_(multi_raft_manager) {}
 
 Status RpcPeerProxyFactory::NewProxy(const RaftPeerPB& peer_pb,
                                      gscoped_ptr<PeerProxy>* proxy) {
@@ -475,7 +690,12 @@ Status RpcPeerProxyFactory::NewProxy(const RaftPeerPB& peer_pb,
   RETURN_NOT_OK(HostPortFromPB(peer_pb.last_known_addr(), hostport.get()));
   gscoped_ptr<ConsensusServiceProxy> new_proxy;
   RETURN_NOT_OK(CreateConsensusServiceProxyForHost(messenger_, *hostport, &new_proxy));
-  proxy->reset(new RpcPeerProxy(hostport.Pass(), new_proxy.Pass()));
+  std::shared_ptr<MultiRaftHeartbeatBatcher> multi_raft_batcher;
+  if (multi_raft_manager_) {
+    multi_raft_batcher = VERIFY_RESULT(multi_raft_manager_->AddOrGetBatcher(
+        peer_pb.permanent_uuid(), *hostport));
+  }
+  proxy->reset(new RpcPeerProxy(hostport.Pass(), new_proxy.Pass(), std::move(multi_raft_batcher)));
   return Status::OK();
 }
 
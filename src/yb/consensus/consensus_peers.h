@@ -33,12 +33,15 @@
 #ifndef YB_CONSENSUS_CONSENSUS_PEERS_H_
 #define YB_CONSENSUS_CONSENSUS_PEERS_H_
 
+#include <atomic>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <vector>
 
 #include "yb/consensus/consensus.h"
 #include "yb/consensus/consensus.pb.h"
+#include "yb/consensus/consensus_queue.h"
 #include "yb/consensus/metadata.pb.h"
 #include "yb/consensus/ref_counted_replicate.h"
 #include "yb/consensus/consensus_util.h"
@@ -61,6 +64,8 @@ class Log;
 namespace consensus {
 class ConsensusServiceProxy;
 class PeerProxy;
+class MultiRaftHeartbeatBatcher;
+class MultiRaftManager;
 class PeerProxyFactory;
 class PeerMessageQueue;
 class VoteRequestPB;
@@ -116,6 +121,11 @@ class VoteResponsePB;
 //        v                               v
 //  SignalRequest()                    return
 //
+// Several requests could be in flight at the same time (pipelining), up to the current window
+// size. The window is adapted to the measured round trip time and to the follower lag: it stays 1
+// on low latency links, grows while the peer has more operations pending and shrinks when the
+// follower falls behind in committing operations. Responses could be processed out of order,
+// PeerMessageQueue takes care of stale responses and rewinds the peer on errors.
 class Peer {
  public:
   // Initializes a peer and get its status.
@@ -144,6 +154,9 @@ class Peer {
 
   void SetTermForTest(int term);
 
+  // Returns the number of requests that could be in flight to this peer.
+  int GetWindowForTests();
+
   ~Peer();
 
   // Creates a new remote peer and makes the queue track it.'
@@ -166,15 +179,41 @@ class Peer {
        gscoped_ptr<PeerProxy> proxy, PeerMessageQueue* queue,
        ThreadPoolToken* raft_pool_token, Consensus* consensus);
 
+  // State of the UpdateConsensus request that is being sent to the peer.
+  struct InFlightRequest {
+    ConsensusRequestPB request;
+    ConsensusResponsePB response;
+    rpc::RpcController controller;
+
+    // Reference-counted pointers to any ReplicateMsgs which are in-flight to the peer. We may have
+    // loaded these messages from the LogCache, in which case we are potentially sharing the same
+    // object as other peers. Since the PB request itself can't hold reference counts, this holds
+    // them.
+    ReplicateMsgs replicate_msg_refs;
+
+    PeerMessageQueue::RequestInfo info;
+    MonoTime send_time;
+  };
+
   void SendNextRequest(RequestTriggerMode trigger_mode);
 
+  // Assembles and sends the next request. Should be invoked with send_mutex_ held and one unit of
+  // sem_ acquired, that is released unless the request was sent.
+  void DoSendNextRequest(RequestTriggerMode trigger_mode);
+
   // Signals that a response was received from the peer.  This method is called from the reactor
   // thread and calls DoProcessResponse() on raft_pool_token_ to do any work that requires IO or
   // lock-taking.
-  void ProcessResponse();
+  void ProcessResponse(InFlightRequest* request);
 
   // Run on 'raft_pool_token'. Does response handling that requires IO or may block.
-  void DoProcessResponse();
+  void DoProcessResponse(InFlightRequest* request);
+
+  // Returns the request to the free list and releases the unit of sem_ acquired for it.
+  void FinishRequest(InFlightRequest* request);
+
+  // Adjusts the window of in-flight requests after receiving response to the request.
+  void UpdateWindow(const InFlightRequest& request, bool more_pending);
 
   // Fetch the desired remote bootstrap request from the queue and send it to the peer. The callback
   // goes to ProcessRemoteBootstrapResponse().
@@ -187,7 +226,7 @@ class Peer {
   void ProcessRemoteBootstrapResponse();
 
   // Signals there was an error sending the request to the peer.
-  void ProcessResponseError(const Status& status);
+  void ProcessResponseError(InFlightRequest* request, const Status& status);
 
   std::string LogPrefixUnlocked() const;
 
@@ -201,27 +240,29 @@ class Peer {
   gscoped_ptr<PeerProxy> proxy_;
 
   PeerMessageQueue* queue_;
-  uint64_t failed_attempts_;
+  std::atomic<uint64_t> failed_attempts_;
+
+  // Max number of UpdateConsensus requests in flight, captured at construction.
+  const int max_in_flight_requests_;
 
-  // The latest consensus update request and response.
-  ConsensusRequestPB request_;
-  ConsensusResponsePB response_;
+  // Preallocated in-flight requests, there is one for each unit of sem_.
+  std::vector<std::unique_ptr<InFlightRequest>> requests_;
 
   // The latest remote bootstrap request and response.
   StartRemoteBootstrapRequestPB rb_request_;
   StartRemoteBootstrapResponsePB rb_response_;
+  rpc::RpcController rb_controller_;
 
-  // Reference-counted pointers to any ReplicateMsgs which are in-flight to the peer. We may have
-  // loaded these messages from the LogCache, in which case we are potentially sharing the same
-  // object as other peers. Since the PB request_ itself can't hold reference counts, this holds
-  // them.
-  ReplicateMsgs replicate_msg_refs_;
+  // One unit is held for each outstanding request.  This is used in order to limit the number of
+  // requests outstanding at a time, and to wait for the outstanding requests at Close().
+  Semaphore sem_;
 
-  rpc::RpcController controller_;
+  // Serializes assembling of requests and processing of responses. Never held while waiting for
+  // the response.
+  std::mutex send_mutex_;
 
-  // Held if there is an outstanding request.  This is used in order to ensure that we only have a
-  // single request oustanding at a time, and to wait for the outstanding requests at Close().
-  Semaphore sem_;
+  // Committed index sent in the latest request, protected by send_mutex_.
+  int64_t last_sent_committed_index_ = kMinimumOpIdIndex;
 
   // Heartbeater for remote peer implementations.  This will send status only requests to the remote
   // peers whenever we go more than 'FLAGS_raft_heartbeat_interval_ms' without sending actual data.
@@ -242,6 +283,19 @@ class Peer {
   mutable simple_spinlock peer_lock_;
   State state_;
   Consensus* consensus_ = nullptr;
+
+  // Requests that are not in flight, protected by peer_lock_.
+  std::vector<InFlightRequest*> free_requests_;
+
+  // Number of UpdateConsensus requests sent and not yet processed, protected by peer_lock_.
+  int in_flight_ = 0;
+
+  // Current max number of requests in flight, protected by peer_lock_.
+  int window_ = 1;
+
+  // Exponentially weighted moving average of UpdateConsensus round trip time in microseconds,
+  // protected by peer_lock_.
+  int64_t rtt_us_ = 0;
 };
 
 // A proxy to another peer. Usually a thin wrapper around an rpc proxy but can be replaced for
@@ -255,6 +309,15 @@ class PeerProxy {
                            rpc::RpcController* controller,
                            const rpc::ResponseCallback& callback) = 0;
 
+  // Sends a status-only request of the idle tablet. It could be batched with heartbeats of other
+  // tablets to the same server.
+  virtual void HeartbeatAsync(const ConsensusRequestPB* request,
+                              ConsensusResponsePB* response,
+                              rpc::RpcController* controller,
+                              const rpc::ResponseCallback& callback) {
+    UpdateAsync(request, response, controller, callback);
+  }
+
   // Sends a RequestConsensusVote to a remote peer.
   virtual void RequestConsensusVoteAsync(const VoteRequestPB* request,
                                          VoteResponsePB* response,
@@ -302,13 +365,19 @@ class PeerProxyFactory {
 class RpcPeerProxy : public PeerProxy {//DHQ: 这个是实现RPC的proxy
  public:
   RpcPeerProxy(gscoped_ptr<HostPort> hostport,
-               gscoped_ptr<ConsensusServiceProxy> consensus_proxy);
+               gscoped_ptr<ConsensusServiceProxy> consensus_proxy,
+               std::shared_ptr<MultiRaftHeartbeatBatcher> multi_raft_batcher = nullptr);
 
   virtual void UpdateAsync(const ConsensusRequestPB* request,
                            ConsensusResponsePB* response,
                            rpc::RpcController* controller,
                            const rpc::ResponseCallback& callback) override;
 
+  virtual void HeartbeatAsync(const ConsensusRequestPB* request,
+                              ConsensusResponsePB* response,
+                              rpc::RpcController* controller,
+                              const rpc::ResponseCallback& callback) override;
+
   virtual void RequestConsensusVoteAsync(const VoteRequestPB* request,
                                          VoteResponsePB* response,
                                          rpc::RpcController* controller,
@@ -334,12 +403,15 @@ class RpcPeerProxy : public PeerProxy {//DHQ: 这个是实现RPC的proxy
  private:
   gscoped_ptr<HostPort> hostport_;
   gscoped_ptr<ConsensusServiceProxy> consensus_proxy_;
+  std::shared_ptr<MultiRaftHeartbeatBatcher> multi_raft_batcher_;
 };
 
 // PeerProxyFactory implementation that generates RPCPeerProxies
 class RpcPeerProxyFactory : public PeerProxyFactory {
  public:
-  explicit RpcPeerProxyFactory(std::shared_ptr<rpc::Messenger> messenger);
+  // multi_raft_manager could be null, in this case heartbeats are not batched.
+  explicit RpcPeerProxyFactory(std::shared_ptr<rpc::Messenger> messenger,
+                               MultiRaftManager* multi_raft_manager = nullptr);
 
   virtual CHECKED_STATUS NewProxy(const RaftPeerPB& peer_pb,
                           gscoped_ptr<PeerProxy>* proxy) override;
@@ -347,6 +419,7 @@ class RpcPeerProxyFactory : public PeerProxyFactory {
   virtual ~RpcPeerProxyFactory();
  private:
   std::shared_ptr<rpc::Messenger> messenger_;
+  MultiRaftManager* const multi_raft_manager_;
 };
 
 // Query the consensus service at last known host/port that is specified in 'remote_peer' and set
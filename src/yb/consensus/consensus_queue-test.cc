@@ -820,6 +820,88 @@ TEST_F(ConsensusQueueTest, TestOnlyAdvancesWatermarkWhenPeerHasAPrefixOfOurLog)
   request.mutable_ops()->ExtractSubrange(0, request.ops().size(), nullptr);
 }
 
+// Tests that pipelined requests continue after operations sent in outstanding requests, that stale
+// responses do not move the peer backwards, and that an error rewinds the pipeline.
+TEST_F(ConsensusQueueTest, TestPipelinedRequests) {
+  google::FlagSaver saver;
+  FLAGS_consensus_max_batch_size_bytes = 1024 * 10;
+
+  queue_->Init(MinimumOpId());
+  queue_->SetLeaderMode(MinimumOpId(), MinimumOpId().term(), BuildRaftConfigPBForTests(2));
+
+  ConsensusRequestPB request;
+  ConsensusResponsePB response;
+  bool more_pending = false;
+  UpdatePeerWatermarkToOp(&request, &response, MinimumOpId(), MinimumOpId(), &more_pending);
+  ASSERT_TRUE(more_pending);
+
+  for (int i = 1; i <= 100; i++) {
+    ASSERT_OK(AppendReplicateMsg(1, i, 1024));
+  }
+  WaitForLocalPeerToAckIndex(100);
+
+  constexpr int kNumRequests = 3;
+  ConsensusRequestPB requests[kNumRequests];
+  ReplicateMsgs refs[kNumRequests];
+  PeerMessageQueue::RequestInfo infos[kNumRequests];
+  BOOST_SCOPE_EXIT(&requests) {
+    // Extract the ops from the requests to avoid double free.
+    for (auto& request : requests) {
+      request.mutable_ops()->ExtractSubrange(0, request.ops_size(), /* elements */ nullptr);
+    }
+  } BOOST_SCOPE_EXIT_END;
+
+  bool needs_remote_bootstrap;
+  int64_t expected_first_index = 1;
+  for (int i = 0; i != kNumRequests; ++i) {
+    infos[i].pipelined = i != 0;
+    ASSERT_OK(queue_->RequestForPeer(kPeerUuid, &requests[i], &refs[i], &needs_remote_bootstrap,
+                                     nullptr /* member_type */,
+                                     nullptr /* last_exchange_successful */, &infos[i]));
+    ASSERT_FALSE(needs_remote_bootstrap);
+    ASSERT_GT(requests[i].ops_size(), 0);
+    ASSERT_EQ(expected_first_index, requests[i].ops(0).id().index());
+    expected_first_index = requests[i].ops(requests[i].ops_size() - 1).id().index() + 1;
+    if (i != 0) {
+      ASSERT_GT(infos[i].sequence_number, infos[i - 1].sequence_number);
+    }
+  }
+
+  // The response to the second request arrives before the response to the first one.
+  const OpId last_of_second = requests[1].ops(requests[1].ops_size() - 1).id();
+  SetLastReceivedAndLastCommitted(&response, last_of_second);
+  queue_->ResponseFromPeer(kPeerUuid, response, &more_pending, &infos[1]);
+  ASSERT_TRUE(more_pending);
+
+  const OpId last_of_first = requests[0].ops(requests[0].ops_size() - 1).id();
+  SetLastReceivedAndLastCommitted(&response, last_of_first);
+  queue_->ResponseFromPeer(kPeerUuid, response, &more_pending, &infos[0]);
+  ASSERT_TRUE(more_pending);
+
+  auto peer = queue_->GetTrackedPeerForTests(kPeerUuid);
+  ASSERT_OPID_EQ(last_of_second, peer.last_received);
+  ASSERT_EQ(expected_first_index, peer.pipelined_next_index);
+
+  // The third request was rejected, so the next request should resend its operations.
+  RefuseWithLogPropertyMismatch(&response, last_of_second, last_of_second);
+  queue_->ResponseFromPeer(kPeerUuid, response, &more_pending, &infos[2]);
+  ASSERT_TRUE(more_pending);
+  response.mutable_status()->Clear();
+
+  ConsensusRequestPB next_request;
+  ReplicateMsgs next_refs;
+  PeerMessageQueue::RequestInfo next_info;
+  next_info.pipelined = true;
+  ASSERT_OK(queue_->RequestForPeer(kPeerUuid, &next_request, &next_refs, &needs_remote_bootstrap,
+                                   nullptr /* member_type */,
+                                   nullptr /* last_exchange_successful */, &next_info));
+  BOOST_SCOPE_EXIT(&next_request) {
+    next_request.mutable_ops()->ExtractSubrange(0, next_request.ops_size(), nullptr);
+  } BOOST_SCOPE_EXIT_END;
+  ASSERT_GT(next_request.ops_size(), 0);
+  ASSERT_EQ(last_of_second.index() + 1, next_request.ops(0).id().index());
+}
+
 // Test that remote bootstrap is triggered when a "tablet not found" error occurs.
 TEST_F(ConsensusQueueTest, TestTriggerRemoteBootstrapIfTabletNotFound) {
   queue_->Init(MinimumOpId());
@@ -117,10 +117,10 @@ METRIC_DEFINE_gauge_int64(tablet, in_progress_ops, "Leader Operations in Progres
 
 std::string PeerMessageQueue::TrackedPeer::ToString() const {
   return Substitute("Peer: $0, Is new: $1, Last received: $2, Next index: $3, "
-                    "Last known committed idx: $4, Last exchange result: $5, "
-                    "Needs remote bootstrap: $6",
+                    "Pipelined next index: $4, Last known committed idx: $5, "
+                    "Last exchange result: $6, Needs remote bootstrap: $7",
                     uuid, is_new, OpIdToString(last_received), next_index,
-                    last_known_committed_idx,
+                    pipelined_next_index, last_known_committed_idx,
                     is_last_exchange_successful ? "SUCCESS" : "ERROR",
                     needs_remote_bootstrap);
 }
@@ -138,13 +138,15 @@ PeerMessageQueue::PeerMessageQueue(const scoped_refptr<MetricEntity>& metric_ent
                                    const RaftPeerPB& local_peer_pb,
                                    const string& tablet_id,
                                    const server::ClockPtr& clock,
-                                   unique_ptr<ThreadPoolToken> raft_pool_token)
+                                   unique_ptr<ThreadPoolToken> raft_pool_token,
+                                   LogCacheRegistry* log_cache_registry)
     : raft_pool_observers_token_(std::move(raft_pool_token)),
       local_peer_pb_(local_peer_pb),
       local_peer_uuid_(local_peer_pb_.has_permanent_uuid() ? local_peer_pb_.permanent_uuid()
                                                            : string()),
       tablet_id_(tablet_id),
-      log_cache_(metric_entity, log, local_peer_pb.permanent_uuid(), tablet_id),
+      log_cache_(metric_entity, log, local_peer_pb.permanent_uuid(), tablet_id,
+                 log_cache_registry),
       metrics_(metric_entity),
       clock_(clock) {
   DCHECK(local_peer_pb_.has_permanent_uuid());
@@ -215,6 +217,7 @@ PeerMessageQueue::TrackedPeer* PeerMessageQueue::TrackPeerUnlocked(const string&
   // does not have a log that matches ours, the normal queue negotiation
   // process will eventually find the right point to resume from.
   tracked_peer->next_index = queue_state_.last_appended.index() + 1;
+  tracked_peer->pipelined_next_index = tracked_peer->next_index;
   InsertOrDie(&peers_map_, uuid, tracked_peer);
 
   CheckPeersInActiveConfigIfLeaderUnlocked();
@@ -311,15 +314,34 @@ Status PeerMessageQueue::AppendOperations(const ReplicateMsgs& msgs,
   return Status::OK();
 }
 //DHQ: SendNextRequest调用
+void PeerMessageQueue::RequestNotSent(const std::string& uuid,
+                                      const ConsensusRequestPB& request) {
+  if (request.ops_size() == 0) {
+    return;
+  }
+  LockGuard lock(queue_lock_);
+  TrackedPeer* peer = FindPtrOrNull(peers_map_, uuid);
+  if (peer == nullptr) {
+    return;
+  }
+  // Requests of a peer are prepared one at a time, so if the pipelined index still points after
+  // this request, it was advanced by it. Otherwise a response has already rewound it.
+  if (peer->pipelined_next_index == request.ops(request.ops_size() - 1).id().index() + 1) {
+    peer->pipelined_next_index = request.ops(0).id().index();
+  }
+}
+
 Status PeerMessageQueue::RequestForPeer(const string& uuid,
                                         ConsensusRequestPB* request,
                                         ReplicateMsgs* msg_refs,
                                         bool* needs_remote_bootstrap,
                                         RaftPeerPB::MemberType* member_type,
-                                        bool* last_exchange_successful) {
+                                        bool* last_exchange_successful,
+                                        RequestInfo* request_info) {
   TrackedPeer* peer = nullptr;
   OpId preceding_id;
   MonoDelta unreachable_time = MonoDelta::kMin;
+  int64_t next_index;
   {
     LockGuard lock(queue_lock_);
     DCHECK_EQ(queue_state_.state, State::kQueueOpen);
@@ -340,6 +362,23 @@ Status PeerMessageQueue::RequestForPeer(const string& uuid,
         MonoTime::Now() + MonoDelta::FromMilliseconds(leader_lease_duration_ms);
     peer->last_ht_lease_expiration_sent_to_follower = ht_lease_expiration_micros;
 
+    if (request_info) {
+      if (request_info->pipelined) {
+        // Continue after the operations that were already sent in outstanding requests.
+        next_index = std::max(peer->next_index, peer->pipelined_next_index);
+      } else {
+        // Operations sent in requests that failed were not received by the peer.
+        next_index = peer->next_index;
+        peer->pipelined_next_index = next_index;
+      }
+      request_info->sequence_number = peer->next_request_sequence_number++;
+      request_info->reordered = false;
+      request_info->leader_lease_expiration = peer->last_leader_lease_expiration_sent_to_follower;
+      request_info->ht_lease_expiration = ht_lease_expiration_micros;
+    } else {
+      next_index = peer->next_index;
+    }
+
     if (propagated_safe_time_provider_ && FLAGS_propagate_safe_time) {
       auto propagated_safe_time = propagated_safe_time_provider_();
       if (propagated_safe_time) {
@@ -398,7 +437,7 @@ Status PeerMessageQueue::RequestForPeer(const string& uuid,
     int max_batch_size = FLAGS_consensus_max_batch_size_bytes - request->ByteSize();
 
     // We try to get the follower's next_index from our log.
-    Status s = log_cache_.ReadOps(peer->next_index - 1,
+    Status s = log_cache_.ReadOps(next_index - 1,
                                   max_batch_size,
                                   &messages,
                                   &preceding_id);//DHQ: 从本地log_cache_里面获取要发送的下一个request。实际上本地log就是先写的(AppendOperations)，不是平等对待各个Peer
@@ -435,10 +474,22 @@ Status PeerMessageQueue::RequestForPeer(const string& uuid,
     }
     msg_refs->swap(messages);//DHQ: 应该是msg_refs增加计数，防止被释放了
     DCHECK_LE(request->ByteSize(), FLAGS_consensus_max_batch_size_bytes);
+
+    if (request_info && request->ops_size() > 0) {
+      LockGuard lock(queue_lock_);
+      // The peer could have been rewound by a response received while we were reading the log,
+      // in this case the next request should start from the rewound index.
+      if (peer->pipelined_next_index == next_index) {
+        peer->pipelined_next_index = request->ops(request->ops_size() - 1).id().index() + 1;
+      }
+    }
   }
 
   DCHECK(preceding_id.IsInitialized());
   request->mutable_preceding_id()->CopyFrom(preceding_id);
+  if (request_info) {
+    request_info->preceding_index = preceding_id.index();
+  }
 
   if (PREDICT_FALSE(VLOG_IS_ON(2))) {
     if (request->ops_size() > 0) {
@@ -679,9 +730,73 @@ void PeerMessageQueue::NotifyPeerIsResponsiveDespiteError(const std::string& pee
   peer->last_successful_communication_time = MonoTime::Now();
 }
 //DHQ: 这里面也会处理error
+void PeerMessageQueue::UpdateLeasesReceivedByFollower(const RequestInfo& request_info,
+                                                      TrackedPeer* peer) {
+  // Responses to pipelined requests could arrive out of order, so the lease should never move
+  // backwards.
+  peer->last_leader_lease_expiration_received_by_follower.MakeAtLeast(
+      request_info.leader_lease_expiration);
+  peer->last_ht_lease_expiration_received_by_follower = std::max(
+      peer->last_ht_lease_expiration_received_by_follower, request_info.ht_lease_expiration);
+}
+
+void PeerMessageQueue::HandleStaleResponse(TrackedPeer* peer,
+                                           const ConsensusResponsePB& response,
+                                           const RequestInfo& request_info,
+                                           bool* more_pending) {
+  // A response to the pipelined request, that was sent before the request whose response was
+  // already processed. Indexes it reports are outdated, so we only take into account that the
+  // peer is alive and has accepted the leader lease.
+  const ConsensusStatusPB& status = response.status();
+  VLOG_WITH_PREFIX_UNLOCKED(2) << "Stale response from peer, request sequence number: "
+                               << request_info.sequence_number << ", last processed: "
+                               << peer->last_response_sequence_number << ". Response: "
+                               << response.ShortDebugString();
+  peer->last_successful_communication_time = MonoTime::Now();
+  if (!status.has_error()) {
+    if (queue_state_.mode == Mode::LEADER) {
+      UpdateLeasesReceivedByFollower(request_info, peer);
+    }
+  } else if (status.error().code() == ConsensusErrorPB::INVALID_TERM) {
+    CHECK(response.has_responder_term());
+    NotifyObserversOfTermChange(response.responder_term());
+    *more_pending = false;
+    return;
+  }
+  *more_pending = log_cache_.HasOpBeenWritten(peer->pipelined_next_index) ||
+      (peer->last_known_committed_idx < queue_state_.committed_index.index());
+}
+
+bool PeerMessageQueue::IsReorderedResponse(const ConsensusStatusPB& status,
+                                           const RequestInfo& request_info) {
+  // Only a pipelined request could overtake the preceding ones. If the peer has a prefix of our log
+  // that ends before the operation preceding this request, then the missing operations were sent
+  // in the preceding requests, and responses to them will tell whether the peer is out of sync.
+  return request_info.pipelined && status.has_error() &&
+         status.error().code() == ConsensusErrorPB::PRECEDING_ENTRY_DIDNT_MATCH &&
+         status.last_received().index() < request_info.preceding_index &&
+         IsOpInLog(status.last_received());
+}
+
+void PeerMessageQueue::HandleReorderedResponse(TrackedPeer* peer,
+                                               const ConsensusResponsePB& response,
+                                               const RequestInfo& request_info,
+                                               bool* more_pending) {
+  VLOG_WITH_PREFIX_UNLOCKED(2) << "Peer received pipelined request before the preceding ones, "
+                               << "request sequence number: " << request_info.sequence_number
+                               << ". Response: " << response.ShortDebugString();
+  peer->last_successful_communication_time = MonoTime::Now();
+  // Indexes of the peer are left as is, so responses to the preceding requests are still
+  // processed. Only operations of this request are sent again.
+  peer->pipelined_next_index = std::min(peer->pipelined_next_index,
+                                        request_info.preceding_index + 1);
+  *more_pending = true;
+}
+
 void PeerMessageQueue::ResponseFromPeer(const std::string& peer_uuid,
                                         const ConsensusResponsePB& response,
-                                        bool* more_pending) {
+                                        bool* more_pending,
+                                        RequestInfo* request_info) {
   DCHECK(response.IsInitialized()) << "Error: Uninitialized: "
       << response.InitializationErrorString() << ". Response: " << response.ShortDebugString();
 
@@ -741,6 +856,19 @@ void PeerMessageQueue::ResponseFromPeer(const std::string& peer_uuid,
 
     const ConsensusStatusPB& status = response.status();
 
+    if (request_info) {
+      if (request_info->sequence_number < peer->last_response_sequence_number) {
+        HandleStaleResponse(peer, response, *request_info, more_pending);
+        return;
+      }
+      if (IsReorderedResponse(status, *request_info)) {
+        request_info->reordered = true;
+        HandleReorderedResponse(peer, response, *request_info, more_pending);
+        return;
+      }
+      peer->last_response_sequence_number = request_info->sequence_number;
+    }
+
     // Take a snapshot of the current peer status.
     TrackedPeer previous = *peer;
 
@@ -792,7 +920,7 @@ void PeerMessageQueue::ResponseFromPeer(const std::string& peer_uuid,
                                            << peer->ToString();
           }
           *more_pending = true;
-          return;
+          break;
         }
         case ConsensusErrorPB::INVALID_TERM: {
           CHECK(response.has_responder_term());
@@ -800,7 +928,7 @@ void PeerMessageQueue::ResponseFromPeer(const std::string& peer_uuid,
                                          << ". Peer's new term: " << response.responder_term();
           NotifyObserversOfTermChange(response.responder_term());
           *more_pending = false;
-          return;
+          break;
         }
         default: {
           LOG_WITH_PREFIX_UNLOCKED(FATAL) << "Unexpected consensus error. Code: "
@@ -808,9 +936,14 @@ void PeerMessageQueue::ResponseFromPeer(const std::string& peer_uuid,
               << response.ShortDebugString();
         }
       }
+      // Operations sent in outstanding requests will be rejected by the peer, so resend them
+      // starting from next_index, after the error handling has adjusted it.
+      peer->pipelined_next_index = peer->next_index;
+      return;
     }
 
     peer->is_last_exchange_successful = true;
+    peer->pipelined_next_index = std::max(peer->pipelined_next_index, peer->next_index);
 
     if (response.has_responder_term()) {
       // The peer must have responded with a term that is greater than or equal to
@@ -829,7 +962,8 @@ void PeerMessageQueue::ResponseFromPeer(const std::string& peer_uuid,
 
     // If our log has the next request for the peer or if the peer's committed index is
     // lower than our own, set 'more_pending' to true.
-    *more_pending = log_cache_.HasOpBeenWritten(peer->next_index) ||
+    *more_pending = log_cache_.HasOpBeenWritten(
+                        request_info ? peer->pipelined_next_index : peer->next_index) ||
         (peer->last_known_committed_idx < queue_state_.committed_index.index());
 
     mode_copy = queue_state_.mode;
@@ -844,11 +978,15 @@ void PeerMessageQueue::ResponseFromPeer(const std::string& peer_uuid,
       }
       majority_replicated.op_id = queue_state_.majority_replicated_opid;
 
-      peer->last_leader_lease_expiration_received_by_follower =
-          peer->last_leader_lease_expiration_sent_to_follower;
+      if (request_info) {
+        UpdateLeasesReceivedByFollower(*request_info, peer);
+      } else {
+        peer->last_leader_lease_expiration_received_by_follower =
+            peer->last_leader_lease_expiration_sent_to_follower;
 
-      peer->last_ht_lease_expiration_received_by_follower =
-          peer->last_ht_lease_expiration_sent_to_follower;
+        peer->last_ht_lease_expiration_received_by_follower =
+            peer->last_ht_lease_expiration_sent_to_follower;
+      }
 
       majority_replicated.leader_lease_expiration = LeaderLeaseExpirationWatermark();
 
@@ -1056,6 +1194,39 @@ void PeerMessageQueue::NotifyObserversOfFailedFollower(const string& uuid,
   NotifyObserversOfFailedFollower(uuid, current_term, reason);
 }
 
+void PeerMessageQueue::NotifyObserversOfFailedReplica(const string& uuid,
+                                                      const string& reason) {
+  int64_t current_term;
+  {
+    LockGuard lock(queue_lock_);
+    if (queue_state_.mode != Mode::LEADER || !queue_state_.active_config) {
+      return;
+    }
+    const auto& config = *queue_state_.active_config;
+    // Same as for unreachable followers, we never drop from 2 voters to 1 automatically.
+    if (CountVoters(config) <= 2) {
+      YB_LOG_EVERY_N(WARNING, 100) << LogPrefixUnlocked() << "Not evicting failed peer " << uuid
+                                   << " from config with " << CountVoters(config) << " voters";
+      return;
+    }
+    for (const auto& peer_pb : config.peers()) {
+      const auto& peer_uuid = peer_pb.permanent_uuid();
+      if (peer_pb.member_type() != RaftPeerPB::VOTER || peer_uuid == uuid ||
+          peer_uuid == local_peer_uuid_) {
+        continue;
+      }
+      TrackedPeer* peer = FindPtrOrNull(peers_map_, peer_uuid);
+      if (peer == nullptr || !peer->is_last_exchange_successful) {
+        YB_LOG_EVERY_N(WARNING, 100) << LogPrefixUnlocked() << "Not evicting failed peer " << uuid
+                                     << ", because peer " << peer_uuid << " is not healthy";
+        return;
+      }
+    }
+    current_term = queue_state_.current_term;
+  }
+  NotifyObserversOfFailedFollower(uuid, current_term, reason);
+}
+
 void PeerMessageQueue::NotifyObserversOfFailedFollower(const string& uuid,
                                                        int64_t term,
                                                        const string& reason) {
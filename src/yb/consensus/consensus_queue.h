@@ -84,10 +84,37 @@ extern const char kConsensusQueueParentTrackerId[];
 //
 // This class is used only on the LEADER side.
 //
-// TODO Currently this class is able to track one outstanding operation per peer. If we want to have
-// more than one outstanding RPC we need to modify it.
+// Several requests to the same peer could be outstanding at the same time, when the caller passes
+// RequestInfo to RequestForPeer() and then to ResponseFromPeer(). See RequestInfo for details.
 class PeerMessageQueue {
  public:
+  // Information about a request assembled by RequestForPeer(), that should be passed back to
+  // ResponseFromPeer() with the response to this request. It allows the caller to pipeline
+  // requests to the peer, i.e. send the next request before receiving response to the previous
+  // one, and to process responses out of order.
+  struct RequestInfo {
+    // Input: whether other requests to this peer are in flight. If so, the request continues after
+    // operations sent in those requests, otherwise it starts from the peer's next index.
+    bool pipelined = false;
+
+    // Requests to the same peer are numbered sequentially. A response to a request that was sent
+    // before the request whose response was already processed is stale, it does not move the
+    // peer's indexes.
+    int64_t sequence_number = 0;
+
+    // Index of the operation preceding operations sent in this request.
+    int64_t preceding_index = kInvalidOpIdIndex;
+
+    // Output: whether the peer rejected this request only because it was received before the
+    // pipelined requests preceding it. Such a rejection does not mean that the peer is out of sync,
+    // operations of the request are sent again after the preceding ones.
+    bool reordered = false;
+
+    // Leader lease expirations sent in this request.
+    MonoTime leader_lease_expiration;
+    MicrosTime ht_lease_expiration = 0;
+  };
+
   struct TrackedPeer {
     explicit TrackedPeer(std::string uuid)
         : uuid(std::move(uuid)),
@@ -112,6 +139,17 @@ class PeerMessageQueue {
     // Next index to send to the peer.  This corresponds to "nextIndex" as specified in Raft.
     int64_t next_index = kInvalidOpIdIndex;
 
+    // Next index to send to the peer when requests are pipelined, i.e. the index following the
+    // last operation in outstanding requests. It is not less than next_index, and is reset to
+    // next_index when a response makes us resend operations from an earlier index.
+    int64_t pipelined_next_index = kInvalidOpIdIndex;
+
+    // Sequence number assigned to the next pipelined request.
+    int64_t next_request_sequence_number = 1;
+
+    // Sequence number of the latest request whose response was processed.
+    int64_t last_response_sequence_number = 0;
+
     // The last operation that we've sent to this peer and that it acked. Used for watermark
     // movement.
     OpId last_received;
@@ -163,7 +201,8 @@ class PeerMessageQueue {
                    const RaftPeerPB& local_peer_pb,
                    const std::string& tablet_id,
                    const server::ClockPtr& clock,
-                   std::unique_ptr<ThreadPoolToken> raft_pool_observers_token);
+                   std::unique_ptr<ThreadPoolToken> raft_pool_observers_token,
+                   LogCacheRegistry* log_cache_registry = nullptr);
 
   // Initialize the queue.
   virtual void Init(const OpId& last_locally_replicated);
@@ -236,7 +275,12 @@ class PeerMessageQueue {
       ReplicateMsgs* msg_refs,
       bool* needs_remote_bootstrap,
       RaftPeerPB::MemberType* member_type = nullptr,
-      bool* last_exchange_successful = nullptr);
+      bool* last_exchange_successful = nullptr,
+      RequestInfo* request_info = nullptr);
+
+  // Should be called when a request prepared by RequestForPeer() was dropped without being sent,
+  // so operations it carries are sent again by the next pipelined request.
+  void RequestNotSent(const std::string& uuid, const ConsensusRequestPB& request);
 
   // Fill in a StartRemoteBootstrapRequest for the specified peer.  If that peer should not remotely
   // bootstrap, returns a non-OK status.  On success, also internally resets
@@ -252,9 +296,12 @@ class PeerMessageQueue {
 
   // Updates the request queue with the latest response of a peer, returns whether this peer has
   // more requests pending.
+  //
+  // request_info should be specified iff it was specified in RequestForPeer() for this request.
   virtual void ResponseFromPeer(const std::string& peer_uuid,
                                 const ConsensusResponsePB& response,
-                                bool* more_pending);
+                                bool* more_pending,
+                                RequestInfo* request_info = nullptr);
 
   // Closes the queue, peers are still allowed to call UntrackPeer() and ResponseFromPeer() but no
   // additional peers can be tracked or messages queued.
@@ -296,6 +343,12 @@ class PeerMessageQueue {
   void NotifyObserversOfFailedFollower(const std::string& uuid,
                                        const std::string& reason);
 
+  // Notifies observers about a follower that failed and does not recover by itself, e.g. because
+  // its data was found corrupted, only if the rest of the config stays healthy without it: there
+  // are more than two voters, and all other followers responded to their last request.
+  void NotifyObserversOfFailedReplica(const std::string& uuid,
+                                      const std::string& reason);
+
   void SetPropagatedSafeTimeProvider(std::function<HybridTime()> provider) {
     propagated_safe_time_provider_ = std::move(provider);
   }
@@ -374,6 +427,29 @@ class PeerMessageQueue {
   void NotifyObserversOfMajorityReplOpChangeTask(const MajorityReplicatedData& data);
 
   void NotifyObserversOfTermChange(int64_t term);
+
+  // Updates lease expirations received by the follower from the lease expirations sent in the
+  // request described by request_info.
+  void UpdateLeasesReceivedByFollower(const RequestInfo& request_info, TrackedPeer* peer);
+
+  // Handles response to the request that was sent before the request whose response was already
+  // processed. Should be invoked under queue_lock_.
+  void HandleStaleResponse(TrackedPeer* peer,
+                           const ConsensusResponsePB& response,
+                           const RequestInfo& request_info,
+                           bool* more_pending);
+
+  // Whether the peer rejected the pipelined request only because it received the request before
+  // the preceding ones, i.e. operations it is missing were sent in the preceding requests.
+  // Should be invoked under queue_lock_.
+  bool IsReorderedResponse(const ConsensusStatusPB& status, const RequestInfo& request_info);
+
+  // Handles such response, see IsReorderedResponse(). Should be invoked under queue_lock_.
+  void HandleReorderedResponse(TrackedPeer* peer,
+                               const ConsensusResponsePB& response,
+                               const RequestInfo& request_info,
+                               bool* more_pending);
+
   void NotifyObserversOfTermChangeTask(int64_t term);
 
   void NotifyObserversOfFailedFollower(const std::string& uuid,
@@ -299,6 +299,41 @@ TEST_F(LogTest, TestFsyncDataSize) {
   LOG(INFO)<< "Wrote " << size << " batches to log";
 }
 
+namespace {
+
+class CountingSyncHooks : public Log::LogFaultHooks {
+ public:
+  CHECKED_STATUS PostSyncIfFsyncEnabled() override {
+    ++num_syncs;
+    return Status::OK();
+  }
+
+  std::atomic<int> num_syncs{0};
+};
+
+} // namespace
+
+// Tests that the log is synced when the sync interval expires, even if no more entries are
+// appended after the last group commit.
+TEST_F(LogTest, TestPeriodicSyncWithoutAppends) {
+  options_.durable_wal_write = false;
+  options_.interval_durable_wal_write = MonoDelta::FromMilliseconds(500);
+  BuildLog();
+  auto hooks = std::make_shared<CountingSyncHooks>();
+  log_->SetLogFaultHooksForTests(hooks);
+
+  OpId opid;
+  opid.set_term(0);
+  opid.set_index(1);
+  ASSERT_OK(AppendNoOp(&opid));
+  // The interval did not expire yet, so the group commit did not sync the file.
+  ASSERT_EQ(0, hooks->num_syncs.load());
+
+  ASSERT_OK(WaitFor([&hooks] { return hooks->num_syncs.load() > 0; },
+                    MonoDelta::FromSeconds(10), "Periodic sync"));
+  ASSERT_OK(log_->Close());
+}
+
 // Regression test for part of KUDU-735:
 // if a log is not preallocated, we should properly track its on-disk size as we append to
 // it.
@@ -323,6 +358,67 @@ TEST_F(LogTest, TestSizeIsMaintained) {
   ASSERT_OK(log_->Close());
 }
 
+TEST_F(LogTest, TestCompressLogEntryBatch) {
+  std::string data;
+  for (int i = 0; i != 1000; ++i) {
+    data += Substitute("row $0 with some repeated text;", i % 10);
+  }
+  for (auto compression : {LogEntryCompression::kLz4, LogEntryCompression::kSnappy}) {
+    faststring compressed;
+    ASSERT_OK(CompressLogEntryBatch(compression, data, &compressed));
+    ASSERT_LT(compressed.size(), data.size()) << compression;
+
+    faststring uncompressed;
+    ASSERT_OK(UncompressLogEntryBatch(compression, Slice(compressed), &uncompressed));
+    ASSERT_EQ(data, uncompressed.ToString()) << compression;
+
+    // Truncated data should be detected.
+    Slice truncated(compressed.data(), compressed.size() / 2);
+    ASSERT_NOK(UncompressLogEntryBatch(compression, truncated, &uncompressed)) << compression;
+  }
+}
+
+// Test that compressed batches take less space in the segment and are read back correctly.
+TEST_F(LogTest, TestCompressedEntries) {
+  const int kNumBatches = 20;
+  const int kOpsPerBatch = 10;
+
+  options_.preallocate_segments = false;
+  options_.entry_compression = LogEntryCompression::kLz4;
+  BuildLog();
+
+  SegmentSequence segments;
+  ASSERT_OK(log_->GetLogReader()->GetSegmentsSnapshot(&segments));
+  const int64_t orig_size = segments[0]->file_size();
+
+  OpId opid = MakeOpId(1, 1);
+  int uncompressed_size = 0;
+  for (int i = 0; i != kNumBatches; ++i) {
+    ASSERT_OK(AppendNoOpsToLogSync(clock_, log_.get(), &opid, kOpsPerBatch, &uncompressed_size));
+  }
+
+  ASSERT_OK(log_->GetLogReader()->GetSegmentsSnapshot(&segments));
+  ASSERT_LT(segments[0]->file_size() - orig_size, uncompressed_size);
+
+  ASSERT_OK(log_->AllocateSegmentAndRollOver());
+  ASSERT_OK(log_->GetLogReader()->GetSegmentsSnapshot(&segments));
+  LogEntries entries;
+  ASSERT_OK(segments[0]->ReadEntries(&entries));
+  ASSERT_EQ(kNumBatches * kOpsPerBatch, entries.size());
+  for (size_t i = 0; i != entries.size(); ++i) {
+    ASSERT_EQ(i + 1, entries[i]->replicate().id().index());
+  }
+
+  // Reading through the index decompresses individual batches.
+  ReplicateMsgs replicates;
+  ASSERT_OK(log_->GetLogReader()->ReadReplicatesInRange(
+      kOpsPerBatch + 1, 2 * kOpsPerBatch, LogReader::kNoSizeLimit, &replicates));
+  ASSERT_EQ(kOpsPerBatch, replicates.size());
+  ASSERT_EQ(kOpsPerBatch + 1, replicates.front()->id().index());
+
+  ASSERT_OK(log_->Close());
+}
+
 // Test that the reader can read from the log even if it hasn't been
 // properly closed.
 TEST_F(LogTest, TestLogNotTrimmed) {
@@ -33,6 +33,8 @@
 #include "yb/consensus/log.h"
 
 #include <algorithm>
+#include <condition_variable>
+#include <map>
 #include <mutex>
 #include <thread>
 
@@ -96,6 +98,11 @@ DEFINE_int32(group_commit_queue_size_bytes, 4_MB,
              "Maximum size of the group commit queue in bytes");
 TAG_FLAG(group_commit_queue_size_bytes, advanced);
 
+DEFINE_int32(log_append_pool_max_threads, 16,
+             "Maximum number of threads in the pool shared by logs of all tablets, that appends "
+             "entry batches to WAL files and syncs them");
+TAG_FLAG(log_append_pool_max_threads, advanced);
+
 // Fault/latency injection flags.
 // -----------------------------
 DEFINE_bool(log_inject_latency, false,
@@ -137,135 +144,265 @@ using env_util::OpenFileForRandom;
 using std::shared_ptr;
 using strings::Substitute;
 
-// This class is responsible for managing the thread that appends to the log file.
-class Log::AppendThread {//DHQ: 没有在头文件中定义class，不希望被其他看到？
+namespace {
+
+// Thread pool shared by logs of all tablets, used to append and sync entry batches. Also has a
+// timer thread used to wake up logs that need periodic sync while no new entries are appended.
+class LogAppendPool {
  public:
-  explicit AppendThread(Log* log);//DHQ: 不允许出现copy/implicit方式的construct，所以必须调用constructor
+  static LogAppendPool& Instance() {
+    // Intentionally leaked, so logs closed during static destruction could still use it.
+    static LogAppendPool* instance = new LogAppendPool();
+    return *instance;
+  }
+
+  CHECKED_STATUS Submit(std::function<void()> task) {
+    return pool_->SubmitFunc(std::move(task));
+  }
+
+  // Invokes task on the timer thread at deadline. The task should be short and not block.
+  void ScheduleAt(MonoTime deadline, std::function<void()> task) {
+    {
+      std::lock_guard<std::mutex> lock(timer_mutex_);
+      timer_tasks_.emplace(deadline, std::move(task));
+    }
+    timer_cond_.notify_one();
+  }
+
+ private:
+  LogAppendPool() {
+    CHECK_OK(ThreadPoolBuilder("log-append")
+                 .set_max_threads(FLAGS_log_append_pool_max_threads)
+                 .Build(&pool_));
+    CHECK_OK(Thread::Create("log", "sync-timer", &LogAppendPool::RunTimer, this, &timer_thread_));
+  }
 
-  // Initializes the objects and starts the thread.
-  Status Init();
+  void RunTimer() {
+    std::unique_lock<std::mutex> lock(timer_mutex_);
+    for (;;) {
+      if (timer_tasks_.empty()) {
+        timer_cond_.wait(lock);
+        continue;
+      }
+      auto it = timer_tasks_.begin();
+      if (it->first > MonoTime::Now()) {
+        timer_cond_.wait_for(
+            lock, std::chrono::microseconds((it->first - MonoTime::Now()).ToMicroseconds()));
+        continue;
+      }
+      auto task = std::move(it->second);
+      timer_tasks_.erase(it);
+      lock.unlock();
+      task();
+      lock.lock();
+    }
+  }
+
+  gscoped_ptr<ThreadPool> pool_;
+  scoped_refptr<Thread> timer_thread_;
+  std::mutex timer_mutex_;
+  std::condition_variable timer_cond_;
+  std::multimap<MonoTime, std::function<void()>> timer_tasks_;
+};
+
+} // namespace
+
+// This class is responsible for appending and syncing entry batches of the log. Instead of owning a
+// thread, it runs its work as tasks on the LogAppendPool shared by all logs. At most one task per
+// log is scheduled at any time, so entry batches of the log are still written in order, and idle
+// logs don't hold any threads.
+class Log::Appender : public std::enable_shared_from_this<Log::Appender> {
+ public:
+  explicit Appender(Log* log);
 
-  // Waits until the last enqueued elements are processed, sets the Appender thread to closing
-  // state. If any entries are added to the queue during the process, invoke their callbacks'
+  // Schedules processing of entry batches queued in the log.
+  void Schedule();
+
+  // Waits until the last enqueued elements are processed, after that no more tasks will be
+  // scheduled. If any entries are added to the queue during the process, invoke their callbacks'
   // 'OnFailure()' method.
   void Shutdown();
 
  private:
-  void RunThread();
+  // Processes entry batches available in the queue, and schedules itself again if more batches
+  // were added meanwhile.
+  void ProcessBatches();
+
+  void ProcessEntryBatches(std::vector<LogEntryBatch*>* entry_batches);
+
+  // Makes sure that the log will be synced when periodic sync interval expires, even if no more
+  // entries are appended to the log.
+  void SchedulePeriodicSync();
+
+  // Schedules ProcessBatches, lock should hold mutex_. If the task could not be submitted, the lock
+  // is released while the batches are processed in the current thread, and acquired again after.
+  void ScheduleUnlocked(std::unique_lock<std::mutex>* lock);
 
   Log* const log_;
 
-  // Lock to protect access to thread_ during shutdown.
-  mutable std::mutex lock_;
-  scoped_refptr<Thread> thread_;
+  std::mutex mutex_;
+  std::condition_variable cond_;
+  // Whether ProcessBatches task is submitted to the pool and not yet completed.
+  bool scheduled_ = false;
+  // Set after Shutdown, no tasks are scheduled after that.
+  bool closed_ = false;
+  // Deadline of the periodic sync registered in the timer.
+  MonoTime periodic_sync_deadline_ = MonoTime::kMax;
 };
 
-Log::AppendThread::AppendThread(Log *log)
+Log::Appender::Appender(Log *log)
   : log_(log) {
   DCHECK(dummy);
 }
 
-Status Log::AppendThread::Init() {
-  DCHECK(!thread_) << "Already initialized";
-  VLOG(1) << "Starting log append thread for tablet " << log_->tablet_id();
-  RETURN_NOT_OK(yb::Thread::Create("log", "appender",
-      &AppendThread::RunThread, this, &thread_));
-  return Status::OK();
+void Log::Appender::Schedule() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  if (!scheduled_ && !closed_) {
+    ScheduleUnlocked(&lock);
+  }
 }
-//DHQ: 是个循环，定期下刷queue中已有batch并sync，然后再调用注册的callback
-void Log::AppendThread::RunThread() {
-  bool shutting_down = false;
-
-  while (PREDICT_TRUE(!shutting_down)) {
-    std::vector<LogEntryBatch*> entry_batches;
-    ElementDeleter d(&entry_batches);
-
-    MonoTime wait_timeout_deadline = MonoTime::kMax;
-    if ((log_->interval_durable_wal_write_)//DHQ: 两次写之间的间隔，因为每个Tablet分别有log，可以做了等待
-        && log_->periodic_sync_needed_.load()) {
-      wait_timeout_deadline = log_->periodic_sync_earliest_unsync_entry_time_
-          + log_->interval_durable_wal_write_;
-    }
 
-    // We shut down the entry_queue when it's time to shut down the append thread, which causes this
-    // call to return false, while still populating the entry_batches vector with the final set of
-    // log entry batches that were enqueued. We finish processing this last bunch of log entry
-    // batches before exiting the main RunThread() loop.
-    if (PREDICT_FALSE(!log_->entry_queue()->BlockingDrainTo(&entry_batches,
-                                                            wait_timeout_deadline))) {
-      shutting_down = true;//DHQ: BlockingDrainTo,获取entry batches
-    }
+void Log::Appender::ScheduleUnlocked(std::unique_lock<std::mutex>* lock) {
+  scheduled_ = true;
+  auto self = shared_from_this();
+  Status s = LogAppendPool::Instance().Submit([self] { self->ProcessBatches(); });
+  if (PREDICT_FALSE(!s.ok())) {
+    // Pool is never shut down, so it could fail only in case of thread creation failure. We
+    // don't want to lose appended batches, so process them in the current thread.
+    LOG(DFATAL) << "Failed to submit log append task for tablet " << log_->tablet_id() << ": "
+                << s;
+    // ProcessBatches acquires mutex_ itself.
+    lock->unlock();
+    ProcessBatches();
+    lock->lock();
+  }
+}
 
-    auto sleep_duration = log_->sleep_duration_.load(std::memory_order_acquire);
-    if (sleep_duration.count() > 0) {
-      std::this_thread::sleep_for(sleep_duration);
-    }
+void Log::Appender::ProcessBatches() {
+  std::vector<LogEntryBatch*> entry_batches;
+  ElementDeleter d(&entry_batches);
 
-    if (log_->metrics_) {
-      log_->metrics_->entry_batches_per_group->Increment(entry_batches.size());
+  // We shut down the entry_queue when it's time to shut down the appender, which causes this call
+  // to return false, after the final set of log entry batches was processed.
+  if (log_->entry_queue()->DrainTo(&entry_batches)) {
+    ProcessEntryBatches(&entry_batches);
+  }
+
+  std::unique_lock<std::mutex> lock(mutex_);
+  scheduled_ = false;
+  if (!log_->entry_queue()->empty()) {
+    // Don't process new batches in the same task, so other logs get a chance to use the pool.
+    ScheduleUnlocked(&lock);
+    return;
+  }
+  if (!closed_) {
+    SchedulePeriodicSync();
+  }
+  cond_.notify_all();
+}
+
+void Log::Appender::SchedulePeriodicSync() {
+  if (!log_->interval_durable_wal_write_ || !log_->periodic_sync_needed_.load()) {
+    return;
+  }
+  const auto deadline =
+      log_->periodic_sync_earliest_unsync_entry_time_ + log_->interval_durable_wal_write_;
+  if (periodic_sync_deadline_ <= deadline && periodic_sync_deadline_ != MonoTime::kMax) {
+    // Earlier wake up is already registered, it will register the next one when fired.
+    return;
+  }
+  periodic_sync_deadline_ = deadline;
+  std::weak_ptr<Appender> weak_self = shared_from_this();
+  LogAppendPool::Instance().ScheduleAt(deadline, [weak_self] {
+    auto self = weak_self.lock();
+    if (!self) {
+      return;
     }
-    TRACE_EVENT1("log", "batch", "batch_size", entry_batches.size());
-
-    SCOPED_LATENCY_METRIC(log_->metrics_, group_commit_latency);//DHQ: SCOPED，应为到函数结束
-
-    for (LogEntryBatch* entry_batch : entry_batches) {//DHQ: 每个batch分别append，DoAppend会为每个batch会产生crc
-      TRACE_EVENT_FLOW_END0("log", "Batch", entry_batch);
-      Status s = log_->DoAppend(entry_batch); //DHQ: 这么多次append，只有后面一次Sync，到底哪些能成功？会不会乱序？
-
-      if (PREDICT_FALSE(!s.ok())) {
-        LOG(ERROR) << "Error appending to the log: " << s.ToString();
-        DLOG(FATAL) << "Aborting: " << s.ToString();
-        entry_batch->set_failed_to_append();
-        // TODO If a single operation fails to append, should we abort all subsequent operations
-        // in this batch or allow them to be appended? What about operations in future batches?
-        if (!entry_batch->callback().is_null()) {
-          entry_batch->callback().Run(s);
-        }
-      } else if (!log_->sync_disabled_) {
-        if (!log_->periodic_sync_needed_.load()) {
-          log_->periodic_sync_needed_.store(true);
-          log_->periodic_sync_earliest_unsync_entry_time_ = MonoTime::Now();
-        }
-        log_->periodic_sync_unsynced_bytes_ += entry_batch->total_size_bytes();
-      }
+    std::unique_lock<std::mutex> lock(self->mutex_);
+    self->periodic_sync_deadline_ = MonoTime::kMax;
+    if (!self->scheduled_ && !self->closed_) {
+      self->ScheduleUnlocked(&lock);
     }
+  });
+}
+
+//DHQ: 定期下刷queue中已有batch并sync，然后再调用注册的callback
+void Log::Appender::ProcessEntryBatches(std::vector<LogEntryBatch*>* entry_batches_ptr) {
+  auto& entry_batches = *entry_batches_ptr;
+
+  auto sleep_duration = log_->sleep_duration_.load(std::memory_order_acquire);
+  if (sleep_duration.count() > 0) {
+    std::this_thread::sleep_for(sleep_duration);
+  }
+
+  if (log_->metrics_) {
+    log_->metrics_->entry_batches_per_group->Increment(entry_batches.size());
+  }
+  TRACE_EVENT1("log", "batch", "batch_size", entry_batches.size());
+
+  SCOPED_LATENCY_METRIC(log_->metrics_, group_commit_latency);//DHQ: SCOPED，应为到函数结束
+
+  for (LogEntryBatch* entry_batch : entry_batches) {//DHQ: 每个batch分别append，DoAppend会为每个batch会产生crc
+    TRACE_EVENT_FLOW_END0("log", "Batch", entry_batch);
+    Status s = log_->DoAppend(entry_batch); //DHQ: 这么多次append，只有后面一次Sync，到底哪些能成功？会不会乱序？
 
-    Status s = log_->Sync(); //DHQ: 貌似没有sync index chunk?
     if (PREDICT_FALSE(!s.ok())) {
-      LOG(ERROR) << "Error syncing log" << s.ToString();
+      LOG(ERROR) << "Error appending to the log: " << s.ToString();
       DLOG(FATAL) << "Aborting: " << s.ToString();
-      for (LogEntryBatch* entry_batch : entry_batches) {
-        if (!entry_batch->callback().is_null()) {
-          entry_batch->callback().Run(s);
-        }
+      entry_batch->set_failed_to_append();
+      // TODO If a single operation fails to append, should we abort all subsequent operations
+      // in this batch or allow them to be appended? What about operations in future batches?
+      if (!entry_batch->callback().is_null()) {
+        entry_batch->callback().Run(s);
       }
-    } else {
-      TRACE_EVENT0("log", "Callbacks");
-      VLOG(2) << "Synchronized " << entry_batches.size() << " entry batches";
-      SCOPED_WATCH_STACK(100);
-      for (LogEntryBatch* entry_batch : entry_batches) {
-        if (PREDICT_TRUE(!entry_batch->failed_to_append() && !entry_batch->callback().is_null())) {
-          entry_batch->callback().Run(Status::OK());
-        }
-        // It's important to delete each batch as we see it, because deleting it may free up memory
-        // from memory trackers, and the callback of a later batch may want to use that memory.
-        delete entry_batch;
+    } else if (!log_->sync_disabled_) {
+      if (!log_->periodic_sync_needed_.load()) {
+        log_->periodic_sync_needed_.store(true);
+        log_->periodic_sync_earliest_unsync_entry_time_ = MonoTime::Now();
+      }
+      log_->periodic_sync_unsynced_bytes_ += entry_batch->total_size_bytes();
+    }
+  }
+
+  Status s = log_->Sync(); //DHQ: 貌似没有sync index chunk?
+  if (PREDICT_FALSE(!s.ok())) {
+    LOG(ERROR) << "Error syncing log" << s.ToString();
+    DLOG(FATAL) << "Aborting: " << s.ToString();
+    for (LogEntryBatch* entry_batch : entry_batches) {
+      if (!entry_batch->callback().is_null()) {
+        entry_batch->callback().Run(s);
+      }
+    }
+  } else {
+    TRACE_EVENT0("log", "Callbacks");
+    VLOG(2) << "Synchronized " << entry_batches.size() << " entry batches";
+    SCOPED_WATCH_STACK(100);
+    for (LogEntryBatch* entry_batch : entry_batches) {
+      if (PREDICT_TRUE(!entry_batch->failed_to_append() && !entry_batch->callback().is_null())) {
+        entry_batch->callback().Run(Status::OK());
       }
-      entry_batches.clear();
+      // It's important to delete each batch as we see it, because deleting it may free up memory
+      // from memory trackers, and the callback of a later batch may want to use that memory.
+      delete entry_batch;
     }
+    entry_batches.clear();
   }
-  VLOG(1) << "Exiting AppendThread for tablet " << log_->tablet_id();
 }
 
-void Log::AppendThread::Shutdown() {
+void Log::Appender::Shutdown() {
   log_->entry_queue()->Shutdown();
-  std::lock_guard<std::mutex> lock_guard(lock_);
-  if (thread_) {
-    VLOG(1) << "Shutting down log append thread for tablet " << log_->tablet_id();
-    CHECK_OK(ThreadJoiner(thread_.get()).Join());
-    VLOG(1) << "Log append thread for tablet " << log_->tablet_id() << " is shut down";
-    thread_.reset();
+  std::unique_lock<std::mutex> lock(mutex_);
+  if (closed_) {
+    return;
+  }
+  VLOG(1) << "Shutting down log appender for tablet " << log_->tablet_id();
+  // Make sure that batches enqueued before shutdown are processed.
+  if (!scheduled_) {
+    ScheduleUnlocked(&lock);
   }
+  cond_.wait(lock, [this] { return !scheduled_; });
+  closed_ = true;
+  VLOG(1) << "Log appender for tablet " << log_->tablet_id() << " is shut down";
 }
 
 // This task is submitted to allocation_pool_ in order to asynchronously pre-allocate new log
@@ -319,7 +456,7 @@ Log::Log(LogOptions options, FsManager* fs_manager, string log_path,
       log_state_(kLogInitialized),
       max_segment_size_(options_.segment_size_bytes),
       entry_batch_queue_(FLAGS_group_commit_queue_size_bytes),
-      append_thread_(new AppendThread(this)),
+      appender_(std::make_shared<Appender>(this)),
       durable_wal_write_(options_.durable_wal_write),
       interval_durable_wal_write_(options_.interval_durable_wal_write),
       bytes_durable_wal_write_mb_(options_.bytes_durable_wal_write_mb),
@@ -374,7 +511,6 @@ Status Log::Init() {
   RETURN_NOT_OK(allocation_status_.Get());
   RETURN_NOT_OK(SwitchToAllocatedSegment());
 
-  RETURN_NOT_OK(append_thread_->Init());
   log_state_ = kLogWriting;
   return Status::OK();
 }
@@ -460,6 +596,7 @@ Status Log::AsyncAppend(LogEntryBatch* entry_batch, const StatusCallback& callba
     delete entry_batch;
     return kLogShutdownStatus;
   }
+  appender_->Schedule();
 
   return Status::OK();
 }
@@ -481,16 +618,16 @@ Status Log::AsyncAppendReplicates(const ReplicateMsgs& msgs,
 }
 
 Status Log::DoAppend(LogEntryBatch* entry_batch, bool caller_owns_operation) {
-  RETURN_NOT_OK(entry_batch->Serialize()); //DHQ: 将PB转成string形式，写到segment的buffer
+  RETURN_NOT_OK(entry_batch->Serialize(options_.entry_compression)); //DHQ: 将PB转成string形式，写到segment的buffer
   size_t num_entries = entry_batch->count();
   DCHECK_GT(num_entries, 0) << "Cannot call DoAppend() with zero entries reserved";
 
-  Slice entry_batch_data = entry_batch->data();
-  uint32_t entry_batch_bytes = entry_batch->total_size_bytes();
   // If there is no data to write return OK.
-  if (PREDICT_FALSE(entry_batch_bytes == 0)) {
+  if (PREDICT_FALSE(entry_batch->total_size_bytes() == 0)) {
     return Status::OK();
   }
+  Slice entry_batch_data = entry_batch->data();
+  uint32_t entry_batch_bytes = entry_batch_data.size();
 
   // if the size of this entry overflows the current segment, get a new one
   if (allocation_state() == kAllocationNotStarted) {
@@ -518,7 +655,7 @@ Status Log::DoAppend(LogEntryBatch* entry_batch, bool caller_owns_operation) {
     SCOPED_LATENCY_METRIC(metrics_, append_latency);
     SCOPED_WATCH_STACK(500);
 
-    RETURN_NOT_OK(active_segment_->WriteEntryBatch(entry_batch_data));//DHQ: 这个里面真的去append file.注意调用的是active_segment_的函数。只写一个segment
+    RETURN_NOT_OK(active_segment_->WriteEntryBatch(entry_batch_data, entry_batch->compression()));//DHQ: 这个里面真的去append file.注意调用的是active_segment_的函数。只写一个segment
 
     // We keep track of the last-written OpId here. This is needed to initialize Consensus on
     // startup.
@@ -571,6 +708,36 @@ Status Log::UpdateIndexForBatch(const LogEntryBatch& batch,
   return Status::OK();
 }
 
+Status Log::RegisterReplayedBatch(int64_t segment_sequence_number, int64_t offset,
+                                  const LogEntryBatchPB& batch) {
+  const LogEntryPB* last_replicate = nullptr;
+  for (const LogEntryPB& entry_pb : batch.entry()) {
+    if (entry_pb.type() != REPLICATE) {
+      continue;
+    }
+    RETURN_NOT_OK(RegisterIndexEntry(
+        segment_sequence_number, offset, entry_pb.replicate().id()));
+    last_replicate = &entry_pb;
+  }
+
+  if (last_replicate) {
+    std::lock_guard<std::mutex> write_lock(last_entry_op_id_mutex_);
+    last_entry_op_id_.store(
+        yb::OpId::FromPB(last_replicate->replicate().id()), std::memory_order_release);
+    last_entry_op_id_cond_.notify_all();
+  }
+  return Status::OK();
+}
+
+Status Log::RegisterIndexEntry(int64_t segment_sequence_number, int64_t offset,
+                               const OpIdPB& op_id) {
+  LogIndexEntry index_entry;
+  index_entry.op_id = op_id;
+  index_entry.segment_sequence_number = segment_sequence_number;
+  index_entry.offset_in_segment = offset;
+  return log_index_->AddEntry(index_entry);
+}
+
 void Log::UpdateFooterForBatch(LogEntryBatch* batch) {
   footer_builder_.set_num_entries(footer_builder_.num_entries() + batch->count());
 
@@ -855,6 +1022,14 @@ uint64_t Log::OnDiskSize() {
   return ret;
 }
 
+Status Log::GetSegmentsSnapshot(SegmentSequence* segments) const {
+  shared_lock<rw_spinlock> l(state_lock_.get_lock());
+  if (log_state_ == kLogClosed) {
+    return STATUS_FORMAT(IllegalState, "Log of tablet $0 is closed", tablet_id_);
+  }
+  return reader_->GetSegmentsSnapshot(segments);
+}
+
 void Log::SetSchemaForNextLogSegment(const Schema& schema,
                                      uint32_t version) {
   std::lock_guard<rw_spinlock> l(schema_lock_);
@@ -864,7 +1039,7 @@ void Log::SetSchemaForNextLogSegment(const Schema& schema,
 
 Status Log::Close() {
   allocation_pool_->Shutdown();
-  append_thread_->Shutdown();
+  appender_->Shutdown();
 
   std::lock_guard<percpu_rwlock> l(state_lock_);
   switch (log_state_) {
@@ -1057,9 +1232,10 @@ void LogEntryBatch::MarkReserved() {
   state_ = kEntryReserved;
 }
 
-Status LogEntryBatch::Serialize() {
+Status LogEntryBatch::Serialize(LogEntryCompression compression) {
   DCHECK_EQ(state_, kEntryReady);
   buffer_.clear();
+  compression_ = LogEntryCompression::kNone;
   // FLUSH_MARKER LogEntries are markers and are not serialized.
   if (PREDICT_FALSE(count() == 1 && entry_batch_pb_.entry(0).type() == FLUSH_MARKER)) {
     total_size_bytes_ = 0;
@@ -1074,6 +1250,17 @@ Status LogEntryBatch::Serialize() {
                                       entry_batch_pb_.DebugString()));
   }
 
+  if (compression != LogEntryCompression::kNone) {
+    faststring compressed;
+    RETURN_NOT_OK(CompressLogEntryBatch(compression, Slice(buffer_), &compressed));
+    // Keep the batch uncompressed when compression does not help, e.g. for already compressed
+    // values, so the reader does not waste time on decompression.
+    if (compressed.size() < buffer_.size()) {
+      buffer_.assign_copy(compressed.data(), compressed.size());
+      compression_ = compression;
+    }
+  }
+
   state_ = kEntrySerialized;
   return Status::OK();
 }
@@ -181,6 +181,18 @@ class Log : public RefCountedThreadSafe<Log> {
     return Sync();
   }
 
+  // Registers an entry batch read from one of the existing segments, when tablet bootstrap reuses
+  // them instead of rewriting their entries into the new segment. Updates the log index, that is
+  // not durable, and the last entry op id, as if the batch was appended to this log.
+  CHECKED_STATUS RegisterReplayedBatch(int64_t segment_sequence_number, int64_t offset,
+                                       const LogEntryBatchPB& batch);
+
+  // Registers a REPLICATE entry from one of the existing segments in the log index only. Used for
+  // segments that tablet bootstrap skips, because all their entries were flushed, so those entries
+  // could still be read to serve lagging followers.
+  CHECKED_STATUS RegisterIndexEntry(int64_t segment_sequence_number, int64_t offset,
+                                    const OpIdPB& op_id);
+
   // Get ID of tablet.
   const std::string& tablet_id() const {
     return tablet_id_;
@@ -223,6 +235,10 @@ class Log : public RefCountedThreadSafe<Log> {
   // Returns 0 if the log is shut down.
   uint64_t OnDiskSize();
 
+  // Returns the current segments. Unlike GetLogReader()->GetSegmentsSnapshot(), could be called
+  // concurrently with Close(), in this case IllegalState is returned.
+  CHECKED_STATUS GetSegmentsSnapshot(SegmentSequence* segments) const;
+
   // Returns this Log's FsManager.
   FsManager* GetFsManager();
 
@@ -255,7 +271,7 @@ class Log : public RefCountedThreadSafe<Log> {
   FRIEND_TEST(LogTest, TestReadLogWithReplacedReplicates);
   FRIEND_TEST(LogTest, TestWriteAndReadToAndFromInProgressSegment);
 
-  class AppendThread;
+  class Appender;
 
   // Log state.
   enum LogState {
@@ -301,7 +317,7 @@ class Log : public RefCountedThreadSafe<Log> {
   // Returns the desired size for the next log segment to be created.
   uint64_t NextSegmentDesiredSize();
 
-  // Writes serialized contents of 'entry' to the log. Called inside AppenderThread. If
+  // Writes serialized contents of 'entry' to the log. Called by the Appender. If
   // 'caller_owns_operation' is true, then the 'operation' field of the entry will be released after
   // the entry is appended.
   //
@@ -396,11 +412,12 @@ class Log : public RefCountedThreadSafe<Log> {
   // Note: The first WAL segment will start off as twice of this value.
   uint64_t cur_max_segment_size_ = 512 * 1024;
 
-  // The queue used to communicate between the thread calling Reserve() and the Log Appender thread.
+  // The queue used to communicate between the thread calling Reserve() and the Log Appender.
   LogEntryBatchQueue entry_batch_queue_;
 
-  // Thread writing to the log.
-  gscoped_ptr<AppendThread> append_thread_;
+  // Appends and syncs entry batches from entry_batch_queue_ using the append pool shared by all
+  // logs.
+  std::shared_ptr<Appender> appender_;
 
   // A thread pool for asynchronously pre-allocating new log segments.
   gscoped_ptr<ThreadPool> allocation_pool_;
@@ -464,8 +481,9 @@ class LogEntryBatch {
 
   LogEntryBatch(LogEntryTypePB type, LogEntryBatchPB* entry_batch_pb, size_t count);
 
-  // Serializes contents of the entry to an internal buffer.
-  CHECKED_STATUS Serialize();
+  // Serializes contents of the entry to an internal buffer, compressing it with the specified
+  // compression when it makes the entry smaller.
+  CHECKED_STATUS Serialize(LogEntryCompression compression);
 
   // Sets the callback that will be invoked after the entry is
   // appended and synced to disk
@@ -499,6 +517,12 @@ class LogEntryBatch {
     return Slice(buffer_);
   }
 
+  // Compression of data().
+  LogEntryCompression compression() const {
+    DCHECK_EQ(state_, kEntrySerialized);
+    return compression_;
+  }
+
   size_t count() const { return count_; }
 
   // Returns the total size in bytes of the object.
@@ -540,6 +564,9 @@ class LogEntryBatch {
   // Buffer to which 'phys_entries_' are serialized by call to 'Serialize()'
   faststring buffer_;
 
+  // Compression of 'buffer_'.
+  LogEntryCompression compression_ = LogEntryCompression::kNone;
+
   enum LogEntryState {
     kEntryInitialized,
     kEntryReserved,
@@ -51,6 +51,8 @@ using std::shared_ptr;
 
 DECLARE_int32(log_cache_size_limit_mb);
 DECLARE_int32(global_log_cache_size_limit_mb);
+DECLARE_bool(log_cache_compress_evicted_entries);
+DECLARE_int32(log_cache_readahead_bytes);
 
 METRIC_DECLARE_entity(tablet);
 
@@ -303,6 +305,64 @@ TEST_F(LogCacheTest, TestGlobalMemoryLimit) {
   ASSERT_LE(cache_->BytesUsed(), 1024 * 1024);
 }
 
+// Test that operations evicted because of memory pressure are compressed and could still be read
+// from the cache.
+TEST_F(LogCacheTest, TestCompressEvictedEntries) {
+  FLAGS_log_cache_size_limit_mb = 1;
+  FLAGS_log_cache_compress_evicted_entries = true;
+  CloseAndReopenCache(MinimumOpId());
+
+  const int kPayloadSize = 400 * 1024;
+  for (int i = 1; i <= 4; ++i) {
+    ASSERT_OK(AppendReplicateMessagesToCache(i, 1, kPayloadSize));
+    ASSERT_OK(log_->WaitUntilAllFlushed());
+  }
+
+  // Nothing is dropped, the oldest ops are compressed to fit under the limit.
+  ASSERT_EQ(4, cache_->num_cached_ops());
+  ASSERT_GT(cache_->metrics_.log_cache_num_compressed_ops->value(), 0);
+  ASSERT_LE(cache_->BytesUsed(), 1024 * 1024);
+
+  ReplicateMsgs messages;
+  OpId preceding;
+  ASSERT_OK(cache_->ReadOps(0, 8 * 1024 * 1024, &messages, &preceding));
+  ASSERT_EQ(4, messages.size());
+  for (int i = 0; i != messages.size(); ++i) {
+    ASSERT_EQ(i + 1, messages[i]->id().index());
+    ASSERT_EQ(kPayloadSize, messages[i]->noop_request().payload_for_tests().size());
+  }
+
+  // Explicit eviction drops compressed ops as well.
+  cache_->EvictThroughOp(4);
+  ASSERT_EQ(0, cache_->num_cached_ops());
+  ASSERT_EQ(0, cache_->metrics_.log_cache_num_compressed_ops->value());
+  ASSERT_EQ(0, cache_->BytesUsed());
+}
+
+// Test that operations read from disk ahead of the requested ones are kept in the cache.
+TEST_F(LogCacheTest, TestReadAhead) {
+  FLAGS_log_cache_readahead_bytes = 1024 * 1024;
+  const int kPayloadSize = 1024;
+  ASSERT_OK(AppendReplicateMessagesToCache(1, 100, kPayloadSize));
+  ASSERT_OK(log_->WaitUntilAllFlushed());
+  cache_->EvictThroughOp(100);
+  ASSERT_EQ(0, cache_->num_cached_ops());
+
+  ReplicateMsgs messages;
+  OpId preceding;
+  ASSERT_OK(cache_->ReadOps(0, 10 * kPayloadSize, &messages, &preceding));
+  ASSERT_GT(messages.size(), 0);
+  ASSERT_LT(messages.size(), 10);
+  ASSERT_EQ(100 - messages.size(), cache_->num_cached_ops());
+
+  // The rest is served from the cache.
+  const int64_t after_index = messages.back()->id().index();
+  messages.clear();
+  ASSERT_OK(cache_->ReadOps(after_index, 8 * 1024 * 1024, &messages, &preceding));
+  ASSERT_EQ(100 - after_index, messages.size());
+  ASSERT_EQ(100 - after_index, cache_->num_cached_ops());
+}
+
 // Test that the log cache properly replaces messages when an index
 // is reused. This is a regression test for a bug where the memtracker's
 // consumption wasn't properly managed when messages were replaced.
@@ -43,8 +43,10 @@
 
 #include "yb/consensus/log.h"
 #include "yb/consensus/log_reader.h"
+#include "yb/consensus/log_util.h"
 #include "yb/consensus/ref_counted_replicate.h"
 #include "yb/gutil/bind.h"
+#include "yb/gutil/casts.h"
 #include "yb/gutil/map-util.h"
 #include "yb/gutil/stl_util.h"
 #include "yb/gutil/strings/human_readable.h"
@@ -55,6 +57,10 @@
 #include "yb/util/metrics.h"
 #include "yb/util/locks.h"
 #include "yb/util/logging.h"
+#include "yb/util/pb_util.h"
+#include "yb/util/size_literals.h"
+
+using namespace yb::size_literals;
 
 DEFINE_int32(log_cache_size_limit_mb, 128,
              "The total per-tablet size of consensus entries which may be kept in memory. "
@@ -68,6 +74,20 @@ DEFINE_int32(global_log_cache_size_limit_mb, 1024,
              "caching log entries across all tablets is kept under this threshold.");
 TAG_FLAG(global_log_cache_size_limit_mb, advanced);
 
+DEFINE_bool(log_cache_compress_evicted_entries, false,
+            "Whether operations evicted from the log cache because of memory pressure are "
+            "compressed and kept in the cache, instead of being reread from disk when a lagging "
+            "follower needs them.");
+TAG_FLAG(log_cache_compress_evicted_entries, advanced);
+TAG_FLAG(log_cache_compress_evicted_entries, runtime);
+
+DEFINE_int32(log_cache_readahead_bytes, 4_MB,
+             "When operations needed by a lagging follower are read from disk, read at least "
+             "this many bytes and keep the operations that were not requested in the log cache, "
+             "if it has spare capacity. 0 disables read ahead.");
+TAG_FLAG(log_cache_readahead_bytes, advanced);
+TAG_FLAG(log_cache_readahead_bytes, runtime);
+
 using strings::Substitute;
 
 namespace yb {
@@ -79,18 +99,87 @@ METRIC_DEFINE_gauge_int64(tablet, log_cache_num_ops, "Log Cache Operation Count"
 METRIC_DEFINE_gauge_int64(tablet, log_cache_size, "Log Cache Memory Usage",
                           MetricUnit::kBytes,
                           "Amount of memory in use for caching the local log.");
+METRIC_DEFINE_gauge_int64(tablet, log_cache_num_compressed_ops,
+                          "Log Cache Compressed Operation Count",
+                          MetricUnit::kOperations,
+                          "Number of compressed operations in the log cache.");
 
 static const char kParentMemTrackerId[] = "log_cache";
 
 typedef vector<const ReplicateMsg*>::const_iterator MsgIter;
 
+void LogCacheRegistry::Register(LogCache* cache) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  caches_.push_back(cache);
+}
+
+void LogCacheRegistry::Unregister(LogCache* cache) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  caches_.erase(std::find(caches_.begin(), caches_.end(), cache));
+}
+
+int64_t LogCacheRegistry::EvictFromLargestCaches(int64_t global_limit, int64_t bytes_to_evict) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (caches_.empty()) {
+    return 0;
+  }
+  std::vector<std::pair<int64_t, LogCache*>> caches_by_usage;
+  caches_by_usage.reserve(caches_.size());
+  for (auto* cache : caches_) {
+    caches_by_usage.emplace_back(cache->BytesUsed(), cache);
+  }
+  std::sort(caches_by_usage.begin(), caches_by_usage.end(),
+            [](const auto& lhs, const auto& rhs) { return lhs.first > rhs.first; });
+
+  const int64_t fair_share = global_limit / caches_.size();
+  int64_t bytes_evicted = 0;
+  for (const auto& usage_and_cache : caches_by_usage) {
+    if (bytes_evicted >= bytes_to_evict || usage_and_cache.first <= fair_share) {
+      break;
+    }
+    bytes_evicted += usage_and_cache.second->EvictOldest(
+        std::min(bytes_to_evict - bytes_evicted, usage_and_cache.first - fair_share));
+  }
+  return bytes_evicted;
+}
+
+namespace {
+
+std::shared_ptr<faststring> CompressMessage(const ReplicateMsg& msg) {
+  faststring serialized;
+  if (!pb_util::AppendToString(msg, &serialized)) {
+    return nullptr;
+  }
+  auto result = std::make_shared<faststring>();
+  auto status = log::CompressLogEntryBatch(
+      log::LogEntryCompression::kLz4, Slice(serialized), result.get());
+  if (!status.ok()) {
+    LOG(WARNING) << "Failed to compress " << msg.id() << ": " << status;
+    return nullptr;
+  }
+  return result;
+}
+
+Result<ReplicateMsgPtr> UncompressMessage(const faststring& compressed_msg) {
+  faststring serialized;
+  RETURN_NOT_OK(log::UncompressLogEntryBatch(
+      log::LogEntryCompression::kLz4, Slice(compressed_msg), &serialized));
+  auto result = std::make_shared<ReplicateMsg>();
+  RETURN_NOT_OK(pb_util::ParseFromArray(result.get(), serialized.data(), serialized.size()));
+  return result;
+}
+
+} // namespace
+
 LogCache::LogCache(const scoped_refptr<MetricEntity>& metric_entity,
                    const scoped_refptr<log::Log>& log,
                    const string& local_uuid,
-                   const string& tablet_id)
+                   const string& tablet_id,
+                   LogCacheRegistry* registry)
   : log_(log),
     local_uuid_(local_uuid),
     tablet_id_(tablet_id),
+    registry_(registry),
     next_sequential_op_index_(0),
     min_pinned_op_index_(0),
     metrics_(metric_entity) {
@@ -114,10 +203,18 @@ LogCache::LogCache(const scoped_refptr<MetricEntity>& metric_entity,
   // code paths elsewhere.
   auto zero_op = std::make_shared<ReplicateMsg>();
   *zero_op->mutable_id() = MinimumOpId();
-  InsertOrDie(&cache_, 0, zero_op);
+  InsertOrDie(&cache_, 0, CacheEntry{zero_op, nullptr, 0, zero_op->ByteSize(), 0});
+
+  if (registry_) {
+    registry_->Register(this);
+  }
 }
 
 LogCache::~LogCache() {
+  if (registry_) {
+    registry_->Unregister(this);
+  }
+
   tracker_->Release(tracker_->consumption());
   cache_.clear();
 
@@ -136,11 +233,25 @@ void LogCache::Init(const OpId& preceding_op) {
 
 Status LogCache::AppendOperations(const ReplicateMsgs& msgs,
                                   const StatusCallback& callback) {
-  std::unique_lock<simple_spinlock> l(lock_);
-
   int size = msgs.size();
   CHECK_GT(size, 0);
 
+  int64_t mem_required = 0;
+  for (const auto& msg : msgs) {
+    mem_required += msg->SpaceUsed();
+  }
+
+  // Compression is too expensive to be done under lock_, so memory is freed by compression before
+  // it is taken. Operations are dropped under the lock below, if that was not enough.
+  if (FLAGS_log_cache_compress_evicted_entries) {
+    const int64_t need_to_free = mem_required - tracker_->SpareCapacity();
+    if (need_to_free > 0) {
+      CompressSome(need_to_free);
+    }
+  }
+
+  std::unique_lock<simple_spinlock> l(lock_);
+
   // If we're not appending a consecutive op we're likely overwriting and
   // need to replace operations in the cache.
   int64_t first_idx_in_batch = msgs.front()->id().index();
@@ -155,17 +266,11 @@ Status LogCache::AppendOperations(const ReplicateMsgs& msgs,
     for (int64_t i = first_idx_in_batch; i < next_sequential_op_index_; ++i) {
       auto it = cache_.find(i);
       if (it != cache_.end()) {
-        ReplicateMsgPtr msg = it->second;
+        AccountForMessageRemovalUnlocked(it->second);
         cache_.erase(it);
-        AccountForMessageRemovalUnlocked(msg);
       }
     }
-  }
-
-
-  int64_t mem_required = 0;
-  for (const auto& msg : msgs) {
-    mem_required += msg->SpaceUsed();
+    ++num_overwrites_;
   }
 
   // Try to consume the memory. If it can't be consumed, we may need to evict.
@@ -193,7 +298,8 @@ Status LogCache::AppendOperations(const ReplicateMsgs& msgs,
   }
 
   for (const auto& msg : msgs) {
-    InsertOrDie(&cache_,  msg->id().index(), msg);
+    InsertOrDie(&cache_, msg->id().index(),
+                CacheEntry{msg, nullptr, msg->id().term(), msg->ByteSize(), msg->SpaceUsed()});
   }
   //DHQ: 这段是对潜在死锁的分析。因为这个函数可能因为IO阻塞，而且其会调也需要锁。
   // We drop the lock during the AsyncAppendReplicates call, since it may block
@@ -227,18 +333,25 @@ void LogCache::LogCallback(int64_t last_idx_in_batch,
                            const StatusCallback& user_callback,
                            const Status& log_status) {
   if (log_status.ok()) {
-    std::lock_guard<simple_spinlock> l(lock_);
-    if (min_pinned_op_index_ <= last_idx_in_batch) {
-      VLOG_WITH_PREFIX_UNLOCKED(1) << "Updating pinned index to " << (last_idx_in_batch + 1);
-      min_pinned_op_index_ = last_idx_in_batch + 1;
+    {
+      std::lock_guard<simple_spinlock> l(lock_);
+      if (min_pinned_op_index_ <= last_idx_in_batch) {
+        VLOG_WITH_PREFIX_UNLOCKED(1) << "Updating pinned index to " << (last_idx_in_batch + 1);
+        min_pinned_op_index_ = last_idx_in_batch + 1;
+      }
     }
 
     // If we went over the global limit in order to log this batch, evict some to
-    // get back down under the limit.
+    // get back down under the limit. Tablets that use more than their fair share of the limit
+    // are evicted from first, and only then this tablet.
     if (borrowed_memory) {
       int64_t spare_capacity = parent_tracker_->SpareCapacity();
+      if (spare_capacity < 0 && registry_) {
+        registry_->EvictFromLargestCaches(parent_tracker_->limit(), -spare_capacity);
+        spare_capacity = parent_tracker_->SpareCapacity();
+      }
       if (spare_capacity < 0) {
-        EvictSomeUnlocked(min_pinned_op_index_, -spare_capacity);
+        EvictOldest(-spare_capacity);
       }
     }
   }
@@ -266,7 +379,8 @@ Status LogCache::LookupOpId(int64_t op_index, OpId* op_id) const {
     }
     auto iter = cache_.find(op_index);
     if (iter != cache_.end()) {
-      *op_id = iter->second->id();
+      op_id->set_term(iter->second.term);
+      op_id->set_index(op_index);
       return Status::OK();
     }
   }
@@ -279,9 +393,8 @@ namespace {
 // Calculate the total byte size that will be used on the wire to replicate
 // this message as part of a consensus update request. This accounts for the
 // length delimiting and tagging of the message.
-int64_t TotalByteSizeForMessage(const ReplicateMsg& msg) {
-  int msg_size = google::protobuf::internal::WireFormatLite::LengthDelimitedSize(
-    msg.ByteSize());
+int64_t TotalByteSizeForMessage(int64_t msg_byte_size) {
+  int msg_size = google::protobuf::internal::WireFormatLite::LengthDelimitedSize(msg_byte_size);
   msg_size += 1; // for the type tag
   return msg_size;
 }
@@ -294,6 +407,10 @@ Status LogCache::ReadOps(int64_t after_op_index,
   DCHECK_GE(after_op_index, 0);
   RETURN_NOT_OK(LookupOpId(after_op_index, preceding_op));
 
+  // Compressed operations are uncompressed after the lock is released. Maps position in messages
+  // to the compressed operation.
+  std::vector<std::pair<size_t, std::shared_ptr<faststring>>> compressed_msgs;
+
   std::unique_lock<simple_spinlock> l(lock_);
   int64_t next_index = after_op_index + 1;
 
@@ -313,50 +430,98 @@ Status LogCache::ReadOps(int64_t after_op_index,
         // Read up to the next entry that's in the cache
         up_to = iter->first - 1;
       }
+      const int64_t num_overwrites = num_overwrites_;
 
       l.unlock();
 
+      // Read ahead, so the following requests of a lagging peer are served from the cache.
+      const int64_t bytes_to_read = std::max<int64_t>(
+          remaining_space, FLAGS_log_cache_readahead_bytes);
       ReplicateMsgs raw_replicate_ptrs;
       RETURN_NOT_OK_PREPEND(
         log_->GetLogReader()->ReadReplicatesInRange( //DHQ: 调用reader的读盘函数
-          next_index, up_to, remaining_space, &raw_replicate_ptrs),
+          next_index, up_to, bytes_to_read, &raw_replicate_ptrs),
         Substitute("Failed to read ops $0..$1", next_index, up_to));
       l.lock();
       LOG_WITH_PREFIX_UNLOCKED(INFO) << "Successfully read " << raw_replicate_ptrs.size() << " ops "
                             << "from disk.";
 
-      for (auto& msg : raw_replicate_ptrs) {
+      auto msg_it = raw_replicate_ptrs.cbegin();
+      for (; msg_it != raw_replicate_ptrs.cend(); ++msg_it) {
+        const auto& msg = *msg_it;
         CHECK_EQ(next_index, msg->id().index());
 
-        remaining_space -= TotalByteSizeForMessage(*msg);
-        if (remaining_space > 0 || messages->empty()) {
-          messages->push_back(msg);
-          next_index++;
+        remaining_space -= TotalByteSizeForMessage(msg->ByteSize());
+        if (remaining_space <= 0 && !messages->empty()) {
+          break;
         }
+        messages->push_back(msg);
+        next_index++;
       }
 
+      if (num_overwrites == num_overwrites_) {
+        AddReadAheadOpsUnlocked(msg_it, raw_replicate_ptrs.cend());
+      }
     } else {
       // Pull contiguous messages from the cache until the size limit is achieved.
       for (; iter != cache_.end(); ++iter) {
-        const ReplicateMsgPtr& msg = iter->second;
-        int64_t index = msg->id().index();
-        if (index != next_index) {
-          continue;
+        const CacheEntry& entry = iter->second;
+        if (static_cast<int64_t>(iter->first) != next_index) {
+          break;
         }
 
-        remaining_space -= TotalByteSizeForMessage(*msg);
+        remaining_space -= TotalByteSizeForMessage(entry.msg_size);
         if (remaining_space < 0 && !messages->empty()) {
           break;
         }
 
-        messages->push_back(msg);
+        if (entry.msg) {
+          messages->push_back(entry.msg);
+        } else {
+          compressed_msgs.emplace_back(messages->size(), entry.compressed_msg);
+          messages->emplace_back();
+        }
         next_index++;
       }
     }
   }
+  l.unlock();
+
+  for (const auto& position_and_compressed_msg : compressed_msgs) {
+    (*messages)[position_and_compressed_msg.first] = VERIFY_RESULT(
+        UncompressMessage(*position_and_compressed_msg.second));
+  }
   return Status::OK();
 }
 
+void LogCache::AddReadAheadOpsUnlocked(ReplicateMsgs::const_iterator begin,
+                                       ReplicateMsgs::const_iterator end) {
+  DCHECK(lock_.is_locked());
+  int64_t num_added = 0;
+  int64_t bytes_added = 0;
+  for (auto it = begin; it != end; ++it) {
+    const auto& msg = *it;
+    const int64_t index = msg->id().index();
+    // Read ahead operations are never pinned, and should not replace what is already cached.
+    if (index >= min_pinned_op_index_ || cache_.count(index)) {
+      break;
+    }
+    const int64_t mem_usage = msg->SpaceUsed();
+    // Do not evict anything to make room for them.
+    if (!tracker_->TryConsume(mem_usage)) {
+      break;
+    }
+    cache_.emplace(index, CacheEntry{msg, nullptr, msg->id().term(), msg->ByteSize(), mem_usage});
+    ++num_added;
+    bytes_added += mem_usage;
+  }
+  if (num_added) {
+    metrics_.log_cache_size->IncrementBy(bytes_added);
+    metrics_.log_cache_num_ops->IncrementBy(num_added);
+    VLOG_WITH_PREFIX_UNLOCKED(1) << "Read ahead " << num_added << " ops, "
+                                 << HumanReadableNumBytes::ToString(bytes_added);
+  }
+}
 
 void LogCache::EvictThroughOp(int64_t index) {
   std::lock_guard<simple_spinlock> lock(lock_);
@@ -364,7 +529,23 @@ void LogCache::EvictThroughOp(int64_t index) {
   EvictSomeUnlocked(index, MathLimits<int64_t>::kMax);
 }
 
-void LogCache::EvictSomeUnlocked(int64_t stop_after_index, int64_t bytes_to_evict) {
+int64_t LogCache::EvictOldest(int64_t bytes_to_evict) {
+  int64_t bytes_evicted = 0;
+  if (FLAGS_log_cache_compress_evicted_entries) {
+    // Compressing is preferred over dropping, so operations are dropped only when compression
+    // of all evictable operations did not free enough memory.
+    bytes_evicted = CompressSome(bytes_to_evict);
+    if (bytes_evicted >= bytes_to_evict) {
+      return bytes_evicted;
+    }
+  }
+
+  std::lock_guard<simple_spinlock> lock(lock_);
+  return bytes_evicted +
+         EvictSomeUnlocked(min_pinned_op_index_, bytes_to_evict - bytes_evicted);
+}
+
+int64_t LogCache::EvictSomeUnlocked(int64_t stop_after_index, int64_t bytes_to_evict) {
   DCHECK(lock_.is_locked());
   VLOG_WITH_PREFIX_UNLOCKED(2) << "Evicting log cache index <= "
                       << stop_after_index
@@ -373,9 +554,9 @@ void LogCache::EvictSomeUnlocked(int64_t stop_after_index, int64_t bytes_to_evic
 
   int64_t bytes_evicted = 0;
   for (auto iter = cache_.begin(); iter != cache_.end();) {
-    const ReplicateMsgPtr& msg = iter->second;
-    VLOG_WITH_PREFIX_UNLOCKED(2) << "considering for eviction: " << msg->id();
-    int64_t msg_index = msg->id().index();
+    const CacheEntry& entry = iter->second;
+    int64_t msg_index = iter->first;
+    VLOG_WITH_PREFIX_UNLOCKED(2) << "considering for eviction: " << msg_index;
     if (msg_index == 0) {
       // Always keep our special '0' op.
       ++iter;
@@ -386,16 +567,16 @@ void LogCache::EvictSomeUnlocked(int64_t stop_after_index, int64_t bytes_to_evic
       break;
     }
 
-    if (!msg.unique()) {
-      VLOG_WITH_PREFIX_UNLOCKED(2) << "Evicting cache: cannot remove " << msg->id()
+    if (entry.msg && !entry.msg.unique()) {
+      VLOG_WITH_PREFIX_UNLOCKED(2) << "Evicting cache: cannot remove " << entry.msg->id()
                                    << " because it is in-use by a peer.";
       ++iter;
       continue;
     }
 
-    VLOG_WITH_PREFIX_UNLOCKED(2) << "Evicting cache. Removing: " << msg->id();
-    AccountForMessageRemovalUnlocked(msg);
-    bytes_evicted += msg->SpaceUsed();
+    VLOG_WITH_PREFIX_UNLOCKED(2) << "Evicting cache. Removing: " << msg_index;
+    AccountForMessageRemovalUnlocked(entry);
+    bytes_evicted += entry.mem_usage;
     cache_.erase(iter++);
 
     if (bytes_evicted >= bytes_to_evict) {
@@ -403,12 +584,83 @@ void LogCache::EvictSomeUnlocked(int64_t stop_after_index, int64_t bytes_to_evic
     }
   }
   VLOG_WITH_PREFIX_UNLOCKED(1) << "Evicting log cache: after state: " << ToStringUnlocked();
+  return bytes_evicted;
 }
 
-void LogCache::AccountForMessageRemovalUnlocked(const ReplicateMsgPtr& msg) {
-  tracker_->Release(msg->SpaceUsed());
-  metrics_.log_cache_size->DecrementBy(msg->SpaceUsed());
+int64_t LogCache::CompressSome(int64_t bytes_to_free) {
+  int64_t bytes_freed = 0;
+  std::vector<std::pair<int64_t, ReplicateMsgPtr>> candidates;
+  std::vector<std::shared_ptr<faststring>> compressed_msgs;
+  int64_t next_index = 1;
+  while (bytes_freed < bytes_to_free) {
+    // Pick the oldest operations not tried yet, that would free enough memory if they were
+    // compressed to nothing.
+    {
+      std::lock_guard<simple_spinlock> lock(lock_);
+      int64_t candidates_usage = 0;
+      for (auto it = cache_.lower_bound(next_index); it != cache_.end(); ++it) {
+        const int64_t msg_index = it->first;
+        const CacheEntry& entry = it->second;
+        if (msg_index >= min_pinned_op_index_ ||
+            candidates_usage >= bytes_to_free - bytes_freed) {
+          break;
+        }
+        if (!entry.msg || !entry.msg.unique()) {
+          continue;
+        }
+        candidates.emplace_back(msg_index, entry.msg);
+        candidates_usage += entry.mem_usage;
+      }
+    }
+    if (candidates.empty()) {
+      break;
+    }
+    next_index = candidates.back().first + 1;
+
+    compressed_msgs.clear();
+    for (const auto& candidate : candidates) {
+      compressed_msgs.push_back(CompressMessage(*candidate.second));
+    }
+
+    {
+      std::lock_guard<simple_spinlock> lock(lock_);
+      for (size_t i = 0; i != candidates.size(); ++i) {
+        auto& compressed_msg = compressed_msgs[i];
+        auto it = cache_.find(candidates[i].first);
+        // While the lock was released the operation could be overwritten, evicted, compressed
+        // by another thread, or taken by a peer. Besides the cache only candidates refer to it.
+        if (it == cache_.end() || it->second.msg != candidates[i].second ||
+            it->second.msg.use_count() != 2 || !compressed_msg) {
+          continue;
+        }
+        CacheEntry& entry = it->second;
+        if (implicit_cast<int64_t>(compressed_msg->capacity()) >= entry.mem_usage) {
+          continue;
+        }
+        VLOG_WITH_PREFIX_UNLOCKED(2) << "Evicting cache. Compressing: " << entry.msg->id();
+        const int64_t freed = entry.mem_usage - compressed_msg->capacity();
+        tracker_->Release(freed);
+        metrics_.log_cache_size->DecrementBy(freed);
+        metrics_.log_cache_num_compressed_ops->Increment();
+        entry.msg = nullptr;
+        entry.compressed_msg = std::move(compressed_msg);
+        entry.mem_usage -= freed;
+        bytes_freed += freed;
+      }
+    }
+    // Operations are released outside of the lock as well.
+    candidates.clear();
+  }
+  return bytes_freed;
+}
+
+void LogCache::AccountForMessageRemovalUnlocked(const CacheEntry& entry) {
+  tracker_->Release(entry.mem_usage);
+  metrics_.log_cache_size->DecrementBy(entry.mem_usage);
   metrics_.log_cache_num_ops->Decrement();
+  if (!entry.msg) {
+    metrics_.log_cache_num_compressed_ops->Decrement();
+  }
 }
 
 int64_t LogCache::BytesUsed() const {
@@ -457,12 +709,12 @@ void LogCache::DumpToStrings(vector<string>* lines) const {
   lines->push_back(ToStringUnlocked());
   lines->push_back("Messages:");
   for (const MessageCache::value_type& entry : cache_) {
-    const ReplicateMsg* msg = entry.second.get();
+    const ReplicateMsg* msg = entry.second.msg.get();
     lines->push_back(
       Substitute("Message[$0] $1.$2 : REPLICATE. Type: $3, Size: $4",
-                 counter++, msg->id().term(), msg->id().index(),
-                 OperationType_Name(msg->op_type()),
-                 msg->ByteSize()));
+                 counter++, entry.second.term, entry.first,
+                 msg ? OperationType_Name(msg->op_type()) : "COMPRESSED",
+                 entry.second.msg_size));
   }
 }
 
@@ -476,12 +728,13 @@ void LogCache::DumpToHtml(std::ostream& out) const {
 
   int counter = 0;
   for (const MessageCache::value_type& entry : cache_) {
-    const ReplicateMsg* msg = entry.second.get();
+    const ReplicateMsg* msg = entry.second.msg.get();
     out << Substitute("<tr><th>$0</th><th>$1.$2</th><td>REPLICATE $3</td>"
                       "<td>$4</td><td>$5</td></tr>",
-                      counter++, msg->id().term(), msg->id().index(),
-                      OperationType_Name(msg->op_type()),
-                      msg->ByteSize(), msg->id().ShortDebugString()) << endl;
+                      counter++, entry.second.term, entry.first,
+                      msg ? OperationType_Name(msg->op_type()) : "COMPRESSED",
+                      entry.second.msg_size,
+                      msg ? msg->id().ShortDebugString() : "compressed") << endl;
   }
   out << "</table>";
 }
@@ -490,7 +743,8 @@ void LogCache::DumpToHtml(std::ostream& out) const {
   x.Instantiate(metric_entity, 0)
 LogCache::Metrics::Metrics(const scoped_refptr<MetricEntity>& metric_entity)
   : log_cache_num_ops(INSTANTIATE_METRIC(METRIC_log_cache_num_ops)),
-    log_cache_size(INSTANTIATE_METRIC(METRIC_log_cache_size)) {
+    log_cache_size(INSTANTIATE_METRIC(METRIC_log_cache_size)),
+    log_cache_num_compressed_ops(INSTANTIATE_METRIC(METRIC_log_cache_num_compressed_ops)) {
 }
 #undef INSTANTIATE_METRIC
 
@@ -34,6 +34,7 @@
 
 #include <map>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <vector>
 
@@ -43,6 +44,7 @@
 #include "yb/gutil/gscoped_ptr.h"
 #include "yb/gutil/macros.h"
 #include "yb/util/async_util.h"
+#include "yb/util/faststring.h"
 #include "yb/util/locks.h"
 #include "yb/util/metrics.h"
 #include "yb/util/status.h"
@@ -59,20 +61,49 @@ class LogReader;
 
 namespace consensus {
 
+class LogCache;
 class ReplicateMsg;
 
+// Keeps all log caches of the server, so memory could be reclaimed from the caches that use the
+// most of it when the server-wide limit is exceeded. Owned by the tablet server, and should
+// outlive all log caches registered in it.
+class LogCacheRegistry {
+ public:
+  void Register(LogCache* cache);
+  void Unregister(LogCache* cache);
+
+  // Evicts operations from the caches that use more than their fair share of global_limit,
+  // largest first. Returns the number of bytes evicted.
+  // Should not be invoked with the lock of any cache held.
+  int64_t EvictFromLargestCaches(int64_t global_limit, int64_t bytes_to_evict);
+
+ private:
+  std::mutex mutex_;
+  std::vector<LogCache*> caches_;
+};
+
 // Write-through cache for the log.
 //
 // This stores a set of log messages by their index. New operations
 // can be appended to the end as they are written to the log. Readers
 // fetch entries that were explicitly appended, or they can fetch older
 // entries which are asynchronously fetched from the disk.
+//
+// Memory is tracked per tablet and server-wide. When the server-wide limit is exceeded, operations
+// are evicted from the caches that use more than their fair share of the limit first. When
+// log_cache_compress_evicted_entries is set, operations evicted because of memory pressure are
+// compressed and kept in the cache, and dropped only when they have to be evicted again.
+// Operations that are read from disk for a lagging peer are read ahead, so following requests
+// of this peer are served from the cache.
 class LogCache {
  public:
+  // registry could be null, in this case memory is reclaimed only from this cache, when the
+  // server-wide limit is exceeded.
   LogCache(const scoped_refptr<MetricEntity>& metric_entity,
            const scoped_refptr<log::Log>& log,
            const std::string& local_uuid,
-           const std::string& tablet_id);
+           const std::string& tablet_id,
+           LogCacheRegistry* registry = nullptr);
   ~LogCache();
 
   // Initialize the cache.
@@ -153,15 +184,48 @@ class LogCache {
   FRIEND_TEST(LogCacheTest, TestGlobalMemoryLimit);
   FRIEND_TEST(LogCacheTest, TestReplaceMessages);
   friend class LogCacheTest;
+  friend class LogCacheRegistry;
+
+  struct CacheEntry {
+    // The operation, null when the entry is compressed.
+    ReplicateMsgPtr msg;
+
+    // The serialized and compressed operation, set only when msg is null.
+    std::shared_ptr<faststring> compressed_msg;
+
+    // The term of the operation.
+    int64_t term;
+
+    // The serialized size of the operation.
+    int64_t msg_size;
+
+    // The memory tracked for this entry.
+    int64_t mem_usage;
+  };
 
   // Try to evict the oldest operations from the queue, stopping either when
   // 'bytes_to_evict' bytes have been evicted, or the op with index
   // 'stop_after_index' has been evicted, whichever comes first.
-  void EvictSomeUnlocked(int64_t stop_after_index, int64_t bytes_to_evict);
+  // Returns the number of bytes evicted.
+  int64_t EvictSomeUnlocked(int64_t stop_after_index, int64_t bytes_to_evict);
+
+  // Compresses the oldest unpinned uncompressed operations, until 'bytes_to_free' bytes have been
+  // freed. Operations are compressed without holding lock_. Returns the number of bytes freed.
+  int64_t CompressSome(int64_t bytes_to_free);
+
+  // Evicts the oldest unpinned operations to free bytes_to_evict bytes. When
+  // log_cache_compress_evicted_entries is set, operations are compressed first, and dropped only
+  // when that was not enough. Returns the number of bytes evicted.
+  int64_t EvictOldest(int64_t bytes_to_evict);
+
+  // Inserts operations read from disk ahead of the requested ones, as long as the memory limit
+  // allows.
+  void AddReadAheadOpsUnlocked(ReplicateMsgs::const_iterator begin,
+                               ReplicateMsgs::const_iterator end);
 
   // Update metrics and MemTracker to account for the removal of the
-  // given message.
-  void AccountForMessageRemovalUnlocked(const ReplicateMsgPtr& msg);
+  // given entry.
+  void AccountForMessageRemovalUnlocked(const CacheEntry& entry);
 
   // Return a string with stats
   std::string StatsStringUnlocked() const;
@@ -183,13 +247,20 @@ class LogCache {
   // The id of the tablet.
   const std::string tablet_id_;
 
+  LogCacheRegistry* const registry_;
+
   mutable simple_spinlock lock_;
 
   // An ordered map that serves as the buffer for the cached messages.
-  // Maps from log index -> ReplicateMsg
-  typedef std::map<uint64_t, ReplicateMsgPtr> MessageCache;
+  // Maps from log index -> CacheEntry
+  typedef std::map<uint64_t, CacheEntry> MessageCache;
   MessageCache cache_;
 
+  // Incremented each time operations are overwritten, so operations read from disk without
+  // holding lock_ are not added to the cache when they could be stale.
+  // Protected by lock_.
+  int64_t num_overwrites_ = 0;
+
   // The next log index to append. Each append operation must either
   // start with this log index, or go backward (but never skip forward).
   int64_t next_sequential_op_index_;//DHQ: 解释很明白，下一个，或者是覆盖前面的(catchup等场合)
@@ -221,6 +292,9 @@ class LogCache {
 
     // Keeps track of the memory consumed by the cache, in bytes.
     scoped_refptr<AtomicGauge<int64_t> > log_cache_size;
+
+    // Keeps track of the number of compressed operations in the cache.
+    scoped_refptr<AtomicGauge<int64_t> > log_cache_num_compressed_ops;
   };
   Metrics metrics_;
 
@@ -57,9 +57,13 @@
 #include "yb/gutil/map-util.h"
 #include "yb/gutil/stringprintf.h"
 #include "yb/gutil/strings/substitute.h"
+#include "yb/gutil/strings/util.h"
+#include "yb/util/env.h"
 #include "yb/util/locks.h"
+#include "yb/util/path_util.h"
 
 using std::string;
+using std::vector;
 using strings::Substitute;
 
 #define RETRY_ON_EINTR(ret, expr) do { \
@@ -102,6 +106,8 @@ static const int64_t kEntriesPerIndexChunk = 1000000;
 //DHQ: 每个chunk单独一个文件？否则何来ChunkFileSize? 跟mmap啥关系？
 static const int64_t kChunkFileSize = kEntriesPerIndexChunk * sizeof(PhysicalEntry);
 
+static const char* const kChunkFilePrefix = "index.";
+
 ////////////////////////////////////////////////////////////
 // LogIndex::IndexChunk implementation
 ////////////////////////////////////////////////////////////
@@ -189,7 +195,21 @@ LogIndex::~LogIndex() {
 }
 //DHQ: ChunkPath的后缀，是chunk_idx,所以实际上每个index chunk，一个文件
 string LogIndex::GetChunkPath(int64_t chunk_idx) {
-  return StringPrintf("%s/index.%09" PRId64, base_dir_.c_str(), chunk_idx);
+  return StringPrintf("%s/%s%09" PRId64, base_dir_.c_str(), kChunkFilePrefix, chunk_idx);
+}
+
+Status LogIndex::DeleteChunks(Env* env, const std::string& base_dir) {
+  vector<string> children;
+  RETURN_NOT_OK(env->GetChildren(base_dir, ExcludeDots::kTrue, &children));
+  for (const auto& child : children) {
+    if (!HasPrefixString(child, kChunkFilePrefix)) {
+      continue;
+    }
+    const auto path = JoinPathSegments(base_dir, child);
+    RETURN_NOT_OK_PREPEND(env->DeleteFile(path), "Unable to delete index chunk " + path);
+    LOG(INFO) << "Deleted log index chunk " << path;
+  }
+  return Status::OK();
 }
 
 Status LogIndex::OpenChunk(int64_t chunk_idx, scoped_refptr<IndexChunk>* chunk) {
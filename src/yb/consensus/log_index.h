@@ -44,6 +44,9 @@
 #include "yb/util/status.h"
 
 namespace yb {
+
+class Env;
+
 namespace log {
 
 // An entry in the index.
@@ -89,6 +92,10 @@ class LogIndex : public RefCountedThreadSafe<LogIndex> {
   // earlier entries.
   void GC(int64_t min_index_to_retain);
 
+  // Deletes all index chunks in the given directory. Chunks are not durable, so they could be
+  // incomplete after a crash, and should not be used by a log that reuses existing segments.
+  static CHECKED_STATUS DeleteChunks(Env* env, const std::string& base_dir);
+
  private:
   friend class RefCountedThreadSafe<LogIndex>;
   ~LogIndex();
@@ -37,12 +37,18 @@
 #include <limits>
 #include <utility>
 
+#include <boost/algorithm/string/predicate.hpp>
 #include <gflags/gflags.h>
 #include <glog/logging.h>
+#include <google/protobuf/io/coded_stream.h>
+#include <google/protobuf/wire_format_lite.h>
+#include <lz4.h>
+#include <snappy.h>
 
 #include "yb/consensus/opid_util.h"
 #include "yb/consensus/ref_counted_replicate.h"
 #include "yb/fs/fs_manager.h"
+#include "yb/gutil/casts.h"
 #include "yb/gutil/map-util.h"
 #include "yb/gutil/stl_util.h"
 #include "yb/gutil/strings/split.h"
@@ -88,6 +94,23 @@ DEFINE_bool(log_async_preallocate_segments, true,
             "Whether the WAL segments preallocation should happen asynchronously");
 TAG_FLAG(log_async_preallocate_segments, advanced);
 
+DEFINE_string(log_compression_type, "none",
+              "Compression of WAL entry batches: none, lz4 or snappy. A batch is stored "
+              "uncompressed when compression does not reduce its size. Segments written with "
+              "compression could not be read by versions that do not support it.");
+TAG_FLAG(log_compression_type, advanced);
+
+static bool ValidateLogCompressionType(const char* flagname, const std::string& value) {
+  auto compression = yb::log::ParseLogEntryCompression(value);
+  if (compression.ok()) {
+    return true;
+  }
+  LOG(ERROR) << flagname << ": " << compression.status();
+  return false;
+}
+static bool log_compression_type_dummy __attribute__((unused)) = google::RegisterFlagValidator(
+    &FLAGS_log_compression_type, &ValidateLogCompressionType);
+
 namespace yb {
 namespace log {
 
@@ -114,12 +137,26 @@ const size_t kLogSegmentFooterMagicAndFooterLength  = 12;
 
 const size_t kEntryHeaderSize = 12;
 
+// The two high bits of the length field of the entry header contain the compression of the entry.
+const int kEntryCompressionShift = 30;
+const uint32_t kEntryLengthMask = (1U << kEntryCompressionShift) - 1;
+
 const int kLogMajorVersion = 1;
 const int kLogMinorVersion = 0;
 
 // Maximum log segment header/footer size, in bytes (8 MB).
 const uint32_t kLogSegmentMaxHeaderOrFooterSize = 8 * 1024 * 1024;
 
+namespace {
+
+LogEntryCompression EntryCompressionFromFlags() {
+  // The flag value is checked by its validator.
+  auto result = ParseLogEntryCompression(FLAGS_log_compression_type);
+  return result.ok() ? *result : LogEntryCompression::kNone;
+}
+
+} // namespace
+
 LogOptions::LogOptions()
     : segment_size_bytes(FLAGS_log_segment_size_bytes == 0 ? FLAGS_log_segment_size_mb * 1_MB
                                                            : FLAGS_log_segment_size_bytes),
@@ -129,7 +166,83 @@ LogOptions::LogOptions()
                                          FLAGS_interval_durable_wal_write_ms) : MonoDelta()),
       bytes_durable_wal_write_mb(FLAGS_bytes_durable_wal_write_mb),
       preallocate_segments(FLAGS_log_preallocate_segments),
-      async_preallocate_segments(FLAGS_log_async_preallocate_segments) {
+      async_preallocate_segments(FLAGS_log_async_preallocate_segments),
+      entry_compression(EntryCompressionFromFlags()) {
+}
+
+Result<LogEntryCompression> ParseLogEntryCompression(const std::string& name) {
+  for (auto compression : kLogEntryCompressionList) {
+    // Skip the 'k' prefix of the enum value name.
+    if (boost::iequals(name, ToCString(compression) + 1)) {
+      return compression;
+    }
+  }
+  return STATUS_FORMAT(InvalidArgument, "Unknown log compression type: $0", name);
+}
+
+Status CompressLogEntryBatch(LogEntryCompression compression, const Slice& data,
+                             faststring* out) {
+  out->clear();
+  PutFixed32(out, data.size());
+  const size_t header_size = out->size();
+  switch (compression) {
+    case LogEntryCompression::kLz4: {
+      const int max_size = LZ4_compressBound(data.size());
+      out->resize(header_size + max_size);
+      const int size = LZ4_compress_default(
+          data.cdata(), pointer_cast<char*>(out->data() + header_size), data.size(), max_size);
+      if (size <= 0) {
+        return STATUS_FORMAT(RuntimeError, "LZ4 compression of $0 bytes failed", data.size());
+      }
+      out->resize(header_size + size);
+      return Status::OK();
+    }
+    case LogEntryCompression::kSnappy: {
+      out->resize(header_size + snappy::MaxCompressedLength(data.size()));
+      size_t size = 0;
+      snappy::RawCompress(
+          data.cdata(), data.size(), pointer_cast<char*>(out->data() + header_size), &size);
+      out->resize(header_size + size);
+      return Status::OK();
+    }
+    case LogEntryCompression::kNone:
+      break;
+  }
+  return STATUS_FORMAT(InvalidArgument, "Unexpected log entry compression: $0", compression);
+}
+
+Status UncompressLogEntryBatch(LogEntryCompression compression, const Slice& data,
+                               faststring* out) {
+  if (data.size() < sizeof(uint32_t)) {
+    return STATUS_FORMAT(Corruption, "Too short compressed log entry batch: $0", data.size());
+  }
+  const uint32_t uncompressed_size = DecodeFixed32(data.data());
+  const char* input = data.cdata() + sizeof(uint32_t);
+  const size_t input_size = data.size() - sizeof(uint32_t);
+  out->clear();
+  out->resize(uncompressed_size);
+  char* output = pointer_cast<char*>(out->data());
+  switch (compression) {
+    case LogEntryCompression::kLz4: {
+      const int size = LZ4_decompress_safe(input, output, input_size, uncompressed_size);
+      if (size < 0 || implicit_cast<uint32_t>(size) != uncompressed_size) {
+        return STATUS_FORMAT(Corruption, "LZ4 decompression failed, expected $0 bytes, got $1",
+                             uncompressed_size, size);
+      }
+      return Status::OK();
+    }
+    case LogEntryCompression::kSnappy: {
+      size_t size = 0;
+      if (!snappy::GetUncompressedLength(input, input_size, &size) || size != uncompressed_size ||
+          !snappy::RawUncompress(input, input_size, output)) {
+        return STATUS_FORMAT(Corruption, "Snappy decompression of $0 bytes failed", input_size);
+      }
+      return Status::OK();
+    }
+    case LogEntryCompression::kNone:
+      break;
+  }
+  return STATUS_FORMAT(Corruption, "Unexpected log entry compression: $0", compression);
 }
 
 Status ReadableLogSegment::Open(Env* env,
@@ -442,12 +555,28 @@ Status ReadableLogSegment::ParseFooterMagicAndFooterLength(const Slice &data,
 }
 
 Status ReadableLogSegment::ReadEntries(LogEntries* entries, int64_t* end_offset) {
-  TRACE_EVENT1("log", "ReadableLogSegment::ReadEntries",
+  return ReadEntryBatches([entries](int64_t batch_offset, LogEntryBatchPB* batch) {
+    for (size_t i = 0; i < batch->entry_size(); ++i) {
+      entries->emplace_back(batch->mutable_entry(i));
+    }
+    batch->mutable_entry()->ExtractSubrange(0, batch->entry_size(), nullptr);
+    return Status::OK();
+  }, end_offset);
+}
+
+Status ReadableLogSegment::ReadEntryBatches(const BatchVisitor& visitor, int64_t* end_offset) {
+  TRACE_EVENT1("log", "ReadableLogSegment::ReadEntryBatches",
                "path", path_);
 
   std::vector<int64_t> recent_offsets(4, -1);
   int batches_read = 0;
 
+  // Types and op ids of the last entries, used to report corruption.
+  constexpr size_t kNumRecentEntries = 4;
+  std::vector<std::pair<LogEntryTypePB, OpIdPB>> recent_entries;
+  recent_entries.reserve(kNumRecentEntries);
+  size_t next_recent_entry = 0;
+
   int64_t offset = first_entry_offset();
   int64_t readable_to_offset = readable_to_offset_.Load();
   VLOG(1) << "Reading segment entries from "
@@ -486,9 +615,12 @@ Status ReadableLogSegment::ReadEntries(LogEntries* entries, int64_t* end_offset)
         return s.CloneAndPrepend(Substitute("Error reading from log $0", path_));
       }
 
+      // Restore the order of recent entries, so the oldest one goes first.
+      std::rotate(recent_entries.begin(), recent_entries.begin() + next_recent_entry,
+                  recent_entries.end());
       Status corruption_status = MakeCorruptionStatus(
           batches_read, this_batch_offset, &recent_offsets,
-          *entries, s);
+          recent_entries, s);
 
       // If we have a valid footer in the segment, then the segment was correctly
       // closed, and we shouldn't see any corruption anywhere (including the last
@@ -523,13 +655,21 @@ Status ReadableLogSegment::ReadEntries(LogEntries* entries, int64_t* end_offset)
     if (VLOG_IS_ON(3)) {
       VLOG(3) << "Read Log entry batch: " << current_batch.DebugString();
     }
-    for (size_t i = 0; i < current_batch.entry_size(); ++i) {
-      entries->emplace_back(current_batch.mutable_entry(i));
-      num_entries_read++;
+    for (const auto& entry : current_batch.entry()) {
+      // Op id is left uninitialized for entries without replicate.
+      std::pair<LogEntryTypePB, OpIdPB> recent_entry(entry.type(), OpIdPB());
+      if (entry.type() == log::REPLICATE && entry.has_replicate()) {
+        recent_entry.second = entry.replicate().id();
+      }
+      if (recent_entries.size() < kNumRecentEntries) {
+        recent_entries.push_back(std::move(recent_entry));
+      } else {
+        recent_entries[next_recent_entry] = std::move(recent_entry);
+        next_recent_entry = (next_recent_entry + 1) % kNumRecentEntries;
+      }
     }
-    current_batch.mutable_entry()->ExtractSubrange(0,
-                                                   current_batch.entry_size(),
-                                                   nullptr);
+    num_entries_read += current_batch.entry_size();
+    RETURN_NOT_OK(visitor(this_batch_offset, &current_batch));
     if (end_offset != nullptr) {
       *end_offset = offset;
     }
@@ -544,6 +684,131 @@ Status ReadableLogSegment::ReadEntries(LogEntries* entries, int64_t* end_offset)
   return Status::OK();
 }
 
+namespace {
+
+using google::protobuf::internal::WireFormatLite;
+using google::protobuf::io::CodedInputStream;
+
+// Reads an embedded message, limiting the stream to it while the parser reads its fields.
+template <class Parser>
+bool ReadEmbeddedMessage(CodedInputStream* input, const Parser& parser) {
+  uint32_t length;
+  if (!input->ReadVarint32(&length)) {
+    return false;
+  }
+  auto limit = input->PushLimit(length);
+  if (!parser() || input->BytesUntilLimit() != 0) {
+    return false;
+  }
+  input->PopLimit(limit);
+  return true;
+}
+
+// Reads id of the ReplicateMsg, skipping its other fields.
+bool ReadReplicateMsgId(CodedInputStream* input, OpIdPB* op_id) {
+  const auto id_tag = WireFormatLite::MakeTag(
+      consensus::ReplicateMsg::kIdFieldNumber, WireFormatLite::WIRETYPE_LENGTH_DELIMITED);
+  while (auto tag = input->ReadTag()) {
+    if (tag == id_tag) {
+      if (!ReadEmbeddedMessage(input, [input, op_id] {
+            return op_id->MergePartialFromCodedStream(input);
+          })) {
+        return false;
+      }
+    } else if (!WireFormatLite::SkipField(input, tag)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Reads LogEntryPB and appends its op id to op_ids, if it is a REPLICATE entry.
+bool ReadLogEntryId(CodedInputStream* input, std::vector<OpIdPB>* op_ids) {
+  const auto type_tag = WireFormatLite::MakeTag(
+      LogEntryPB::kTypeFieldNumber, WireFormatLite::WIRETYPE_VARINT);
+  const auto replicate_tag = WireFormatLite::MakeTag(
+      LogEntryPB::kReplicateFieldNumber, WireFormatLite::WIRETYPE_LENGTH_DELIMITED);
+  uint32_t type = 0;
+  OpIdPB op_id;
+  while (auto tag = input->ReadTag()) {
+    if (tag == type_tag) {
+      if (!input->ReadVarint32(&type)) {
+        return false;
+      }
+    } else if (tag == replicate_tag) {
+      if (!ReadEmbeddedMessage(input, [input, &op_id] {
+            return ReadReplicateMsgId(input, &op_id);
+          })) {
+        return false;
+      }
+    } else if (!WireFormatLite::SkipField(input, tag)) {
+      return false;
+    }
+  }
+  if (type == REPLICATE && op_id.IsInitialized()) {
+    op_ids->push_back(std::move(op_id));
+  }
+  return true;
+}
+
+// Reads op ids of REPLICATE entries from the serialized LogEntryBatchPB. Other fields, including
+// payloads of the replicate messages, are skipped without being parsed.
+Status ReadBatchReplicateIds(const Slice& data, std::vector<OpIdPB>* op_ids) {
+  const auto entry_tag = WireFormatLite::MakeTag(
+      LogEntryBatchPB::kEntryFieldNumber, WireFormatLite::WIRETYPE_LENGTH_DELIMITED);
+  CodedInputStream input(data.data(), data.size());
+  input.SetTotalBytesLimit(std::numeric_limits<int>::max(), -1);
+  while (auto tag = input.ReadTag()) {
+    bool ok;
+    if (tag == entry_tag) {
+      ok = ReadEmbeddedMessage(&input, [&input, op_ids] {
+        return ReadLogEntryId(&input, op_ids);
+      });
+    } else {
+      ok = WireFormatLite::SkipField(&input, tag);
+    }
+    if (!ok) {
+      return STATUS(Corruption, "Could not read op ids of log entry batch");
+    }
+  }
+  if (!input.ConsumedEntireMessage()) {
+    return STATUS(Corruption, "Could not read op ids of log entry batch");
+  }
+  return Status::OK();
+}
+
+} // namespace
+
+Status ReadableLogSegment::ReadReplicateIds(const ReplicateIdVisitor& visitor) {
+  TRACE_EVENT1("log", "ReadableLogSegment::ReadReplicateIds",
+               "path", path_);
+
+  if (!HasFooter() || footer_was_rebuilt_) {
+    return STATUS_FORMAT(IllegalState, "Log segment $0 was not properly closed", path_);
+  }
+
+  const int64_t read_up_to =
+      file_size() - footer_.ByteSize() - kLogSegmentFooterMagicAndFooterLength;
+  int64_t offset = first_entry_offset();
+  faststring tmp_buf;
+  faststring uncompressed;
+  std::vector<OpIdPB> op_ids;
+  while (offset < read_up_to) {
+    const int64_t batch_offset = offset;
+    EntryHeader header;
+    RETURN_NOT_OK(ReadEntryHeader(&offset, &header));
+    Slice data;
+    RETURN_NOT_OK(ReadEntryBatchData(&offset, header, &tmp_buf, &uncompressed, &data));
+    op_ids.clear();
+    RETURN_NOT_OK_PREPEND(ReadBatchReplicateIds(data, &op_ids),
+                          Format("Batch at offset $0 of $1", batch_offset, path_));
+    for (const auto& op_id : op_ids) {
+      RETURN_NOT_OK(visitor(batch_offset, op_id));
+    }
+  }
+  return Status::OK();
+}
+
 Status ReadableLogSegment::ScanForValidEntryHeaders(int64_t offset, bool* has_valid_entries) {
   TRACE_EVENT1("log", "ReadableLogSegment::ScanForValidEntryHeaders",
                "path", path_);
@@ -592,7 +857,7 @@ Status ReadableLogSegment::MakeCorruptionStatus(
     int batch_number,
     int64_t batch_offset,
     std::vector<int64_t>* recent_offsets,
-    const std::vector<std::unique_ptr<LogEntryPB>>& entries,
+    const std::vector<std::pair<LogEntryTypePB, OpIdPB>>& recent_entries,
     const Status& status) const {
 
   string err = "Log file corruption detected. ";
@@ -605,20 +870,16 @@ Status ReadableLogSegment::MakeCorruptionStatus(
       SubstituteAndAppend(&err, " $0", offset);
     }
   }
-  if (!entries.empty()) {
+  if (!recent_entries.empty()) {
     err.append("; Last log entries read:");
-    const int kNumEntries = 4; // Include up to the last 4 entries in the segment.
-    for (int i = std::max(0, static_cast<int>(entries.size()) - kNumEntries);
-        i < entries.size(); i++) {
-      LogEntryPB* entry = entries[i].get();
-      LogEntryTypePB type = entry->type();
+    for (const auto& entry : recent_entries) {
       string opid_str;
-      if (type == log::REPLICATE && entry->has_replicate()) {
-        opid_str = consensus::OpIdToString(entry->replicate().id());
+      if (entry.second.IsInitialized()) {
+        opid_str = consensus::OpIdToString(entry.second);
       } else {
         opid_str = "<unknown>";
       }
-      SubstituteAndAppend(&err, " [$0 ($1)]", LogEntryTypePB_Name(type), opid_str);
+      SubstituteAndAppend(&err, " [$0 ($1)]", LogEntryTypePB_Name(entry.first), opid_str);
     }
   }
 
@@ -650,13 +911,17 @@ Status ReadableLogSegment::ReadEntryHeader(int64_t *offset, EntryHeader* header)
 
 bool ReadableLogSegment::DecodeEntryHeader(const Slice& data, EntryHeader* header) {
   DCHECK_EQ(kEntryHeaderSize, data.size());
-  header->msg_length = DecodeFixed32(&data[0]);
+  const uint32_t length_and_compression = DecodeFixed32(&data[0]);
+  header->msg_length = length_and_compression & kEntryLengthMask;
+  header->compression = static_cast<LogEntryCompression>(
+      length_and_compression >> kEntryCompressionShift);
   header->msg_crc    = DecodeFixed32(&data[4]);
   header->header_crc = DecodeFixed32(&data[8]);
 
   // Verify the header.
   uint32_t computed_crc = crc::Crc32c(&data[0], 8);
-  return computed_crc == header->header_crc;
+  return computed_crc == header->header_crc &&
+         PREDICT_TRUE(header->compression <= LogEntryCompression::kSnappy);
 }
 
 
@@ -669,6 +934,30 @@ Status ReadableLogSegment::ReadEntryBatch(int64_t *offset,
                "range", Substitute("offset=$0 entry_len=$1",
                                    *offset, header.msg_length));
 
+  faststring uncompressed;
+  Slice serialized_entry_batch;
+  int64_t end_offset = *offset;
+  RETURN_NOT_OK(ReadEntryBatchData(
+      &end_offset, header, tmp_buf, &uncompressed, &serialized_entry_batch));
+
+  LogEntryBatchPB read_entry_batch;
+  Status s = pb_util::ParseFromArray(&read_entry_batch,
+                                     serialized_entry_batch.data(),
+                                     serialized_entry_batch.size());
+
+  if (!s.ok()) return STATUS(Corruption, Substitute("Could parse PB. Cause: $0",
+                                                    s.ToString()));
+
+  *offset = end_offset;
+  entry_batch->Swap(&read_entry_batch);
+  return Status::OK();
+}
+
+Status ReadableLogSegment::ReadEntryBatchData(int64_t *offset,
+                                              const EntryHeader& header,
+                                              faststring *tmp_buf,
+                                              faststring* uncompressed,
+                                              Slice* data) {
   if (header.msg_length == 0) {
     return STATUS(Corruption, "Invalid 0 entry length");
   }
@@ -702,17 +991,17 @@ Status ReadableLogSegment::ReadEntryBatch(int64_t *offset,
                                          header.msg_crc, read_crc));
   }
 
-
-  LogEntryBatchPB read_entry_batch;
-  s = pb_util::ParseFromArray(&read_entry_batch,
-                              entry_batch_slice.data(),
-                              header.msg_length);
-
-  if (!s.ok()) return STATUS(Corruption, Substitute("Could parse PB. Cause: $0",
-                                                    s.ToString()));
+  *data = entry_batch_slice;
+  if (header.compression != LogEntryCompression::kNone) {
+    s = UncompressLogEntryBatch(header.compression, entry_batch_slice, uncompressed);
+    if (!s.ok()) {
+      return s.CloneAndPrepend(Substitute("Could not uncompress entry in byte range $0-$1",
+                                          *offset, *offset + header.msg_length));
+    }
+    *data = Slice(*uncompressed);
+  }
 
   *offset += entry_batch_slice.size();
-  entry_batch->Swap(&read_entry_batch);
   return Status::OK();
 }
 
@@ -777,13 +1066,17 @@ Status WritableLogSegment::WriteFooterAndClose(const LogSegmentFooterPB& footer)
 }
 
 
-Status WritableLogSegment::WriteEntryBatch(const Slice& data) {
+Status WritableLogSegment::WriteEntryBatch(const Slice& data, LogEntryCompression compression) {
   DCHECK(is_header_written_);
   DCHECK(!is_footer_written_);
+  if (PREDICT_FALSE(data.size() > kEntryLengthMask)) {
+    return STATUS_FORMAT(InvalidArgument, "Too big log entry batch: $0 bytes", data.size());
+  }
   uint8_t header_buf[kEntryHeaderSize];
 
-  // First encode the length of the message.
-  uint32_t len = data.size();
+  // First encode the length of the message, together with its compression.
+  uint32_t len = data.size() |
+                 (static_cast<uint32_t>(compression) << kEntryCompressionShift);
   InlineEncodeFixed32(&header_buf[0], len);
 
   // Then the CRC of the message.
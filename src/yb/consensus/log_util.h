@@ -33,6 +33,7 @@
 #ifndef YB_CONSENSUS_LOG_UTIL_H_
 #define YB_CONSENSUS_LOG_UTIL_H_
 
+#include <functional>
 #include <iosfwd>
 #include <map>
 #include <memory>
@@ -47,8 +48,11 @@
 #include "yb/gutil/macros.h"
 #include "yb/gutil/ref_counted.h"
 #include "yb/util/atomic.h"
+#include "yb/util/enums.h"
 #include "yb/util/env.h"
+#include "yb/util/faststring.h"
 #include "yb/util/monotime.h"
+#include "yb/util/result.h"
 
 // Used by other classes, now part of the API.
 DECLARE_bool(durable_wal_write);
@@ -69,6 +73,23 @@ extern const char kTmpSuffix[];
 // and checksum of the other two fields (see EntryHeader struct below).
 extern const size_t kEntryHeaderSize;
 
+// Compression of a log entry batch. It is stored in the high bits of the length field of the entry
+// header, that are always zero in segments written without compression, so such segments are read
+// as is.
+YB_DEFINE_ENUM(LogEntryCompression, (kNone)(kLz4)(kSnappy));
+
+// Parses compression name, i.e. "none", "lz4" or "snappy", case insensitive.
+Result<LogEntryCompression> ParseLogEntryCompression(const std::string& name);
+
+// Compresses serialized log entry batch. The uncompressed size is stored in front of the
+// compressed data.
+CHECKED_STATUS CompressLogEntryBatch(LogEntryCompression compression, const Slice& data,
+                                     faststring* out);
+
+// Reverts CompressLogEntryBatch.
+CHECKED_STATUS UncompressLogEntryBatch(LogEntryCompression compression, const Slice& data,
+                                       faststring* out);
+
 extern const int kLogMajorVersion;
 extern const int kLogMinorVersion;
 
@@ -96,6 +117,9 @@ struct LogOptions {
   // Whether the allocation should happen asynchronously.
   bool async_preallocate_segments;
 
+  // Compression of entry batches written to the log.
+  LogEntryCompression entry_compression;
+
   LogOptions();
 };
 
@@ -153,6 +177,26 @@ class ReadableLogSegment : public RefCountedThreadSafe<ReadableLogSegment> {
   CHECKED_STATUS ReadEntries(LogEntries* entries,
                              int64_t* end_offset = nullptr);
 
+  // Invoked for each entry batch read by ReadEntryBatches, with the offset of the batch in the
+  // segment. The visitor could take ownership of the batch entries. Returning non OK status stops
+  // reading, and this status is returned by ReadEntryBatches.
+  typedef std::function<Status(int64_t batch_offset, LogEntryBatchPB* batch)> BatchVisitor;
+
+  // Reads entry batches of the segment one by one and passes them to the visitor, so the whole
+  // segment does not have to be kept in memory. Handles corruption in the same way as ReadEntries,
+  // i.e. batches read before the corrupted one are passed to the visitor.
+  CHECKED_STATUS ReadEntryBatches(const BatchVisitor& visitor,
+                                  int64_t* end_offset = nullptr);
+
+  // Invoked for each REPLICATE entry read by ReadReplicateIds, with the offset of its batch in the
+  // segment.
+  typedef std::function<Status(int64_t batch_offset, const OpIdPB& op_id)> ReplicateIdVisitor;
+
+  // Reads op ids of REPLICATE entries of a properly closed segment. Batches are checked against
+  // their CRC, but only op ids are decoded from them, so it is much cheaper than ReadEntryBatches.
+  // Used to rebuild the log index for segments that are not replayed.
+  CHECKED_STATUS ReadReplicateIds(const ReplicateIdVisitor& visitor);
+
   // Rebuilds this segment's footer by scanning its entries.
   // This is an expensive operation as it reads and parses the whole segment
   // so it should be only used in the case of a crash, where the footer is
@@ -183,6 +227,12 @@ class ReadableLogSegment : public RefCountedThreadSafe<ReadableLogSegment> {
     return footer_.IsInitialized();
   }
 
+  // Whether the footer was rebuilt by scanning the segment, because the segment was not closed
+  // properly.
+  bool footer_was_rebuilt() const {
+    return footer_was_rebuilt_;
+  }
+
   // Returns this log segment's footer.
   //
   // If HasFooter() returns false this cannot be called.
@@ -215,9 +265,12 @@ class ReadableLogSegment : public RefCountedThreadSafe<ReadableLogSegment> {
   FRIEND_TEST(LogTest, TestWriteAndReadToAndFromInProgressSegment);
 
   struct EntryHeader {
-    // The length of the batch data.
+    // The length of the batch data, as stored in the segment.
     uint32_t msg_length;
 
+    // The compression of the batch data.
+    LogEntryCompression compression;
+
     // The CRC32C of the batch data.
     uint32_t msg_crc;
 
@@ -251,10 +304,11 @@ class ReadableLogSegment : public RefCountedThreadSafe<ReadableLogSegment> {
   CHECKED_STATUS ScanForValidEntryHeaders(int64_t offset, bool* has_valid_entries);
 
   // Format a nice error message to report on a corruption in a log file.
-  CHECKED_STATUS MakeCorruptionStatus(int batch_number, int64_t batch_offset,
-                              std::vector<int64_t>* recent_offsets,
-                              const std::vector<std::unique_ptr<LogEntryPB>>& entries,
-                              const Status& status) const;
+  // recent_entries contains types and op ids of the last entries read before the corruption.
+  CHECKED_STATUS MakeCorruptionStatus(
+      int batch_number, int64_t batch_offset, std::vector<int64_t>* recent_offsets,
+      const std::vector<std::pair<LogEntryTypePB, OpIdPB>>& recent_entries,
+      const Status& status) const;
 
   CHECKED_STATUS ReadEntryHeaderAndBatch(int64_t* offset,
                                          faststring* tmp_buf,
@@ -279,6 +333,14 @@ class ReadableLogSegment : public RefCountedThreadSafe<ReadableLogSegment> {
                                 faststring* tmp_buf,
                                 LogEntryBatchPB* entry_batch);
 
+  // Reads serialized log entry batch, verifies its CRC and uncompresses it if necessary.
+  // 'data' points either to 'tmp_buf' or to 'uncompressed'.
+  CHECKED_STATUS ReadEntryBatchData(int64_t *offset,
+                                    const EntryHeader& header,
+                                    faststring* tmp_buf,
+                                    faststring* uncompressed,
+                                    Slice* data);
+
   void UpdateReadableToOffset(int64_t readable_to_offset);
 
   const std::string path_;
@@ -337,9 +399,10 @@ class WritableLogSegment {
   }
 
   // Appends the provided batch of data, including a header
-  // and checksum.
+  // and checksum. entry_batch_data should be already compressed with the specified compression.
   // Makes sure that the log segment has not been closed.
-  CHECKED_STATUS WriteEntryBatch(const Slice& entry_batch_data);
+  CHECKED_STATUS WriteEntryBatch(const Slice& entry_batch_data,
+                                 LogEntryCompression compression = LogEntryCompression::kNone);
 
   // Makes sure the I/O buffers in the underlying writable file are flushed.
   CHECKED_STATUS Sync() {
@@ -0,0 +1,274 @@
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+
+#include "yb/consensus/multi_raft_batcher.h"
+
+#include <gflags/gflags.h>
+#include <glog/logging.h>
+
+#include "yb/common/wire_protocol.h"
+
+#include "yb/rpc/messenger.h"
+#include "yb/rpc/rpc_header.pb.h"
+
+#include "yb/util/flag_tags.h"
+#include "yb/util/monotime.h"
+
+DEFINE_int32(multi_raft_heartbeat_batch_window_ms, 50,
+             "Max time in milliseconds that a heartbeat of an idle tablet waits to be batched "
+             "with heartbeats of other tablets to the same server.");
+TAG_FLAG(multi_raft_heartbeat_batch_window_ms, advanced);
+
+DEFINE_int32(multi_raft_batch_size, 1000,
+             "Max number of tablet heartbeats sent in a single MultiRaftHeartbeat RPC.");
+TAG_FLAG(multi_raft_batch_size, advanced);
+
+DECLARE_int32(consensus_rpc_timeout_ms);
+
+namespace yb {
+namespace consensus {
+
+MultiRaftHeartbeatBatcher::MultiRaftHeartbeatBatcher(
+    std::string local_peer_uuid, std::string peer_uuid, std::shared_ptr<rpc::Messenger> messenger)
+    : local_peer_uuid_(std::move(local_peer_uuid)),
+      peer_uuid_(std::move(peer_uuid)),
+      messenger_(std::move(messenger)) {
+}
+
+MultiRaftHeartbeatBatcher::~MultiRaftHeartbeatBatcher() {
+  // Every heartbeat keeps the proxy of its tablet, and so the batcher, alive until its callback
+  // is invoked.
+  DCHECK(!current_batch_ || current_batch_->heartbeats.empty());
+}
+
+Status MultiRaftHeartbeatBatcher::SetHostPort(const HostPort& hostport) {
+  std::vector<Endpoint> addrs;
+  RETURN_NOT_OK(hostport.ResolveAddresses(&addrs));
+  if (addrs.empty()) {
+    return STATUS_FORMAT(NetworkError, "Unable to resolve address: $0", hostport);
+  }
+  auto proxy = std::make_shared<ConsensusServiceProxy>(messenger_, addrs[0]);
+  std::lock_guard<std::mutex> lock(mutex_);
+  hostport_ = hostport;
+  proxy_ = std::move(proxy);
+  return Status::OK();
+}
+
+HostPort MultiRaftHeartbeatBatcher::hostport() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return hostport_;
+}
+
+std::shared_ptr<ConsensusServiceProxy> MultiRaftHeartbeatBatcher::proxy() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return proxy_;
+}
+
+void MultiRaftHeartbeatBatcher::AddRequestToBatch(const ConsensusRequestPB* request,
+                                                  ConsensusResponsePB* response,
+                                                  rpc::RpcController* controller,
+                                                  rpc::ResponseCallback callback) {
+  DCHECK_EQ(request->ops_size(), 0);
+  PendingHeartbeat heartbeat = { request, response, controller, std::move(callback) };
+  std::shared_ptr<Batch> full_batch;
+  bool batched = false;
+  bool schedule_flush = false;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!batching_unsupported_) {
+      batched = true;
+      if (!current_batch_) {
+        current_batch_ = std::make_shared<Batch>();
+        current_batch_->request.set_caller_uuid(local_peer_uuid_);
+        current_batch_->request.set_dest_uuid(peer_uuid_);
+      }
+      auto& batch_request = current_batch_->request;
+      auto* pb = batch_request.add_heartbeats();
+      pb->set_tablet_id(request->tablet_id());
+      pb->set_caller_term(request->caller_term());
+      if (request->has_preceding_id()) {
+        *pb->mutable_preceding_id() = request->preceding_id();
+      }
+      *pb->mutable_committed_index() = request->committed_index();
+      if (request->has_leader_lease_duration_ms()) {
+        pb->set_leader_lease_duration_ms(request->leader_lease_duration_ms());
+      }
+      if (request->has_ht_lease_expiration()) {
+        pb->set_ht_lease_expiration(request->ht_lease_expiration());
+      }
+      if (request->has_propagated_safe_time()) {
+        pb->set_propagated_safe_time(request->propagated_safe_time());
+      }
+      // It is enough to propagate the latest hybrid time.
+      if (request->propagated_hybrid_time() > batch_request.propagated_hybrid_time()) {
+        batch_request.set_propagated_hybrid_time(request->propagated_hybrid_time());
+      }
+      current_batch_->heartbeats.push_back(std::move(heartbeat));
+
+      if (current_batch_->heartbeats.size() >= FLAGS_multi_raft_batch_size) {
+        full_batch = std::move(current_batch_);
+        current_batch_.reset();
+      } else if (!flush_scheduled_) {
+        flush_scheduled_ = true;
+        schedule_flush = true;
+      }
+    }
+  }
+
+  if (!batched) {
+    SendHeartbeat(heartbeat);
+  } else if (full_batch) {
+    SendBatch(std::move(full_batch));
+  } else if (schedule_flush) {
+    std::weak_ptr<MultiRaftHeartbeatBatcher> weak_self = shared_from_this();
+    // The flush is done even when the task was aborted during messenger shutdown, heartbeats
+    // would fail in this case, but we should invoke their callbacks.
+    messenger_->ScheduleOnReactor(
+        [weak_self](const Status& status) {
+          auto self = weak_self.lock();
+          if (self) {
+            self->FlushBatch();
+          }
+        },
+        MonoDelta::FromMilliseconds(FLAGS_multi_raft_heartbeat_batch_window_ms));
+  }
+}
+
+void MultiRaftHeartbeatBatcher::FlushBatch() {
+  std::shared_ptr<Batch> batch;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    flush_scheduled_ = false;
+    batch = std::move(current_batch_);
+    current_batch_.reset();
+  }
+  if (batch) {
+    SendBatch(std::move(batch));
+  }
+}
+
+void MultiRaftHeartbeatBatcher::SendBatch(std::shared_ptr<Batch> batch) {
+  VLOG(3) << "Sending " << batch->heartbeats.size() << " heartbeats to "
+          << batch->request.dest_uuid();
+  batch->controller.set_timeout(MonoDelta::FromMilliseconds(FLAGS_consensus_rpc_timeout_ms));
+  auto* batch_ptr = batch.get();
+  proxy()->MultiRaftHeartbeatAsync(
+      batch_ptr->request, &batch_ptr->response, &batch_ptr->controller,
+      [self = shared_from_this(), batch = std::move(batch)] {
+        self->ProcessBatchResponse(batch);
+      });
+}
+
+void MultiRaftHeartbeatBatcher::ProcessBatchResponse(const std::shared_ptr<Batch>& batch) {
+  const auto& status = batch->controller.status();
+  if (status.IsRemoteError()) {
+    const auto* error = batch->controller.error_response();
+    if (error && (error->code() == rpc::ErrorStatusPB::ERROR_NO_SUCH_METHOD ||
+                  error->code() == rpc::ErrorStatusPB::ERROR_NO_SUCH_SERVICE)) {
+      LOG(INFO) << "Server " << batch->request.dest_uuid()
+                << " does not support batched heartbeats: " << status;
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        batching_unsupported_ = true;
+      }
+      // Resend heartbeats one by one, since it is the only way to deliver them to this server.
+      for (const auto& heartbeat : batch->heartbeats) {
+        SendHeartbeat(heartbeat);
+      }
+      return;
+    }
+  }
+
+  // Resending heartbeats of a failed batch would multiply RPCs to a server that is already in
+  // trouble, so every heartbeat gets the outcome of the batch, as if it was sent by itself.
+  Status response_status;
+  if (!status.ok()) {
+    VLOG(1) << "Failed to send batched heartbeats to " << batch->request.dest_uuid() << ": "
+            << status;
+  } else if (!batch->response.has_error() &&
+             batch->response.responses_size() != batch->heartbeats.size()) {
+    response_status = STATUS_FORMAT(
+        IllegalState, "Got $0 responses to $1 batched heartbeats",
+        batch->response.responses_size(), batch->heartbeats.size());
+    LOG(WARNING) << "Bad response to batched heartbeats from " << batch->request.dest_uuid()
+                 << ": " << response_status;
+  }
+  for (size_t i = 0; i != batch->heartbeats.size(); ++i) {
+    auto& heartbeat = batch->heartbeats[i];
+    heartbeat.controller->ShareFinishedCall(batch->controller);
+    if (!status.ok()) {
+      heartbeat.response->Clear();
+    } else if (batch->response.has_error()) {
+      heartbeat.response->Clear();
+      *heartbeat.response->mutable_error() = batch->response.error();
+    } else if (!response_status.ok()) {
+      heartbeat.response->Clear();
+      auto* error = heartbeat.response->mutable_error();
+      error->set_code(tserver::TabletServerErrorPB::UNKNOWN_ERROR);
+      StatusToPB(response_status, error->mutable_status());
+    } else {
+      heartbeat.response->Swap(batch->response.mutable_responses(i));
+    }
+    heartbeat.callback();
+  }
+}
+
+void MultiRaftHeartbeatBatcher::SendHeartbeat(const PendingHeartbeat& heartbeat) {
+  heartbeat.controller->Reset();
+  heartbeat.controller->set_timeout(MonoDelta::FromMilliseconds(FLAGS_consensus_rpc_timeout_ms));
+  proxy()->UpdateConsensusAsync(
+      *heartbeat.request, heartbeat.response, heartbeat.controller, heartbeat.callback);
+}
+
+MultiRaftManager::MultiRaftManager(std::shared_ptr<rpc::Messenger> messenger,
+                                   std::string local_peer_uuid)
+    : messenger_(std::move(messenger)), local_peer_uuid_(std::move(local_peer_uuid)) {
+}
+
+MultiRaftManager::~MultiRaftManager() {
+}
+
+Result<std::shared_ptr<MultiRaftHeartbeatBatcher>> MultiRaftManager::AddOrGetBatcher(
+    const std::string& peer_uuid, const HostPort& hostport) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto& weak_batcher = batchers_[peer_uuid];
+  auto batcher = weak_batcher.lock();
+  if (batcher) {
+    // Proxies of tablets are created with the last known address of the peer, so a different
+    // address means that the peer has moved.
+    auto old_hostport = batcher->hostport();
+    if (!(old_hostport == hostport)) {
+      LOG(INFO) << "Peer " << peer_uuid << " moved from " << old_hostport.ToString() << " to "
+                << hostport.ToString();
+      RETURN_NOT_OK(batcher->SetHostPort(hostport));
+    }
+    return batcher;
+  }
+
+  batcher = std::make_shared<MultiRaftHeartbeatBatcher>(local_peer_uuid_, peer_uuid, messenger_);
+  RETURN_NOT_OK(batcher->SetHostPort(hostport));
+  weak_batcher = batcher;
+
+  // Forget batchers of peers that are not used anymore.
+  for (auto it = batchers_.begin(); it != batchers_.end();) {
+    if (it->second.expired()) {
+      it = batchers_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+  return batcher;
+}
+
+} // namespace consensus
+} // namespace yb
@@ -0,0 +1,139 @@
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+
+#ifndef YB_CONSENSUS_MULTI_RAFT_BATCHER_H
+#define YB_CONSENSUS_MULTI_RAFT_BATCHER_H
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "yb/consensus/consensus.pb.h"
+#include "yb/consensus/consensus.proxy.h"
+
+#include "yb/rpc/response_callback.h"
+#include "yb/rpc/rpc_controller.h"
+
+#include "yb/util/net/net_util.h"
+#include "yb/util/result.h"
+
+namespace yb {
+
+namespace rpc {
+class Messenger;
+}
+
+namespace consensus {
+
+// Batches heartbeats of all tablets that have their leader on this server and a follower on the
+// specified peer server, and sends them in a single MultiRaftHeartbeat RPC.
+//
+// A heartbeat waits in the batch for at most multi_raft_heartbeat_batch_window_ms. If the batch
+// RPC fails, every heartbeat's controller reports the batch RPC status. Heartbeats are resent as
+// regular UpdateConsensus RPCs only if the peer server does not support batching.
+class MultiRaftHeartbeatBatcher : public std::enable_shared_from_this<MultiRaftHeartbeatBatcher> {
+ public:
+  MultiRaftHeartbeatBatcher(std::string local_peer_uuid,
+                            std::string peer_uuid,
+                            std::shared_ptr<rpc::Messenger> messenger);
+
+  ~MultiRaftHeartbeatBatcher();
+
+  // Resolves the address of the peer, heartbeats are sent to it after this call.
+  CHECKED_STATUS SetHostPort(const HostPort& hostport);
+
+  // Returns the address of the peer, that was last set by SetHostPort.
+  HostPort hostport();
+
+  // Adds status-only request to the batch. request, response and controller should stay valid
+  // until callback is invoked. When the response is received, it is stored into response and
+  // callback is invoked, like it would be done by ConsensusServiceProxy::UpdateConsensusAsync.
+  void AddRequestToBatch(const ConsensusRequestPB* request,
+                         ConsensusResponsePB* response,
+                         rpc::RpcController* controller,
+                         rpc::ResponseCallback callback);
+
+ private:
+  struct PendingHeartbeat {
+    const ConsensusRequestPB* request;
+    ConsensusResponsePB* response;
+    rpc::RpcController* controller;
+    rpc::ResponseCallback callback;
+  };
+
+  struct Batch {
+    MultiRaftHeartbeatRequestPB request;
+    MultiRaftHeartbeatResponsePB response;
+    rpc::RpcController controller;
+    std::vector<PendingHeartbeat> heartbeats;
+  };
+
+  // Sends the current batch, if it is not empty.
+  void FlushBatch();
+
+  void SendBatch(std::shared_ptr<Batch> batch);
+
+  void ProcessBatchResponse(const std::shared_ptr<Batch>& batch);
+
+  // Sends the heartbeat as a regular UpdateConsensus RPC.
+  void SendHeartbeat(const PendingHeartbeat& heartbeat);
+
+  std::shared_ptr<ConsensusServiceProxy> proxy();
+
+  const std::string local_peer_uuid_;
+  const std::string peer_uuid_;
+  std::shared_ptr<rpc::Messenger> messenger_;
+
+  std::mutex mutex_;
+
+  // Address of the peer and the proxy to it, protected by mutex_.
+  HostPort hostport_;
+  std::shared_ptr<ConsensusServiceProxy> proxy_;
+
+  // Heartbeats that are waiting to be sent, protected by mutex_.
+  std::shared_ptr<Batch> current_batch_;
+
+  // Whether the flush of the current batch is scheduled, protected by mutex_.
+  bool flush_scheduled_ = false;
+
+  // Set when the peer does not support MultiRaftHeartbeat RPC, protected by mutex_.
+  bool batching_unsupported_ = false;
+};
+
+// Keeps heartbeat batchers for all peer servers of tablets hosted by this server.
+class MultiRaftManager {
+ public:
+  MultiRaftManager(std::shared_ptr<rpc::Messenger> messenger, std::string local_peer_uuid);
+
+  ~MultiRaftManager();
+
+  // Returns the batcher for heartbeats to the peer with specified uuid, creating it when
+  // necessary. The batcher is destroyed when all tablets that use it release it.
+  // If the peer moved to another address, the batcher is switched to hostport.
+  Result<std::shared_ptr<MultiRaftHeartbeatBatcher>> AddOrGetBatcher(
+      const std::string& peer_uuid, const HostPort& hostport);
+
+ private:
+  std::shared_ptr<rpc::Messenger> messenger_;
+  const std::string local_peer_uuid_;
+
+  std::mutex mutex_;
+  std::unordered_map<std::string, std::weak_ptr<MultiRaftHeartbeatBatcher>> batchers_;
+};
+
+} // namespace consensus
+} // namespace yb
+
+#endif // YB_CONSENSUS_MULTI_RAFT_BATCHER_H
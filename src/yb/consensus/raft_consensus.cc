@@ -229,8 +229,11 @@ scoped_refptr<RaftConsensus> RaftConsensus::Create(
     const Callback<void(std::shared_ptr<StateChangeContext> context)> mark_dirty_clbk,
     TableType table_type,
     LostLeadershipListener lost_leadership_listener,
-    ThreadPool* raft_pool) {
-  gscoped_ptr<PeerProxyFactory> rpc_factory(new RpcPeerProxyFactory(messenger));
+    ThreadPool* raft_pool,
+    MultiRaftManager* multi_raft_manager,
+    LogCacheRegistry* log_cache_registry) {
+  gscoped_ptr<PeerProxyFactory> rpc_factory(
+      new RpcPeerProxyFactory(messenger, multi_raft_manager));
 
   // The message queue that keeps track of which operations need to be replicated
   // where.
@@ -240,7 +243,8 @@ scoped_refptr<RaftConsensus> RaftConsensus::Create(
                            local_peer_pb,
                            options.tablet_id,
                            clock,
-                           raft_pool->NewToken(ThreadPool::ExecutionMode::SERIAL)));//DHQ: 从thread_pool创建一个新的token
+                           raft_pool->NewToken(ThreadPool::ExecutionMode::SERIAL),
+                           log_cache_registry));//DHQ: 从thread_pool创建一个新的token
 
   DCHECK(local_peer_pb.has_permanent_uuid());
   const string& peer_uuid = local_peer_pb.permanent_uuid();
@@ -38,6 +38,8 @@
 #include "yb/consensus/consensus_meta.h"
 #include "yb/consensus/consensus-test-util.h"
 #include "yb/fs/fs_manager.h"
+#include "yb/gutil/bind.h"
+#include "yb/util/format.h"
 #include "yb/util/test_macros.h"
 #include "yb/util/test_util.h"
 
@@ -49,11 +51,34 @@ using std::vector;
 // TODO: Share a test harness with ConsensusMetadataTest?
 const char* kTabletId = "TestTablet";
 
+// Records apply batch boundaries and applied operations in the order they happen.
+class ApplyBatchRecordingFactory : public MockOperationFactory {
+ public:
+  void StartApplyBatch() override {
+    events_.push_back("start batch");
+  }
+
+  void FinishApplyBatch() override {
+    events_.push_back("finish batch");
+  }
+
+  void Applied(int index, const Status& status) {
+    events_.push_back(Format("apply $0", index));
+  }
+
+  const vector<std::string>& events() const {
+    return events_;
+  }
+
+ private:
+  vector<std::string> events_;
+};
+
 class RaftConsensusStateTest : public YBTest {
  public:
   RaftConsensusStateTest()
     : fs_manager_(env_.get(), GetTestPath("fs_root"), "tserver_test"),
-      operation_factory_(new MockOperationFactory()) {
+      operation_factory_(new ApplyBatchRecordingFactory()) {
   }
 
   void SetUp() override {
@@ -82,7 +107,7 @@ class RaftConsensusStateTest : public YBTest {
  protected:
   FsManager fs_manager_;
   RaftConfigPB config_;
-  gscoped_ptr<MockOperationFactory> operation_factory_;
+  gscoped_ptr<ApplyBatchRecordingFactory> operation_factory_;
   gscoped_ptr<ReplicaState> state_;
 };
 
@@ -127,5 +152,33 @@ TEST_F(RaftConsensusStateTest, TestPersistentWrites) {
   ASSERT_EQ(2, state_->GetCommittedConfigUnlocked().opid_index());
 }
 
+// Test that a follower applies runs of consecutive write operations inside apply batches, and
+// finishes the batch before applying an operation of another type.
+TEST_F(RaftConsensusStateTest, ApplyBatches) {
+  const vector<OperationType> types = { WRITE_OP, WRITE_OP, NO_OP, WRITE_OP, WRITE_OP };
+
+  ReplicaState::UniqueLock lock;
+  ASSERT_OK(state_->LockForUpdate(&lock));
+  for (size_t i = 0; i != types.size(); ++i) {
+    const int index = static_cast<int>(i) + 1;
+    auto msg = CreateDummyReplicate(kMinimumTerm, index, HybridTime::FromMicros(index), 0);
+    msg->set_op_type(types[i]);
+    scoped_refptr<ConsensusRound> round(new ConsensusRound(nullptr, msg));
+    round->SetConsensusReplicatedCallback(Bind(
+        &ApplyBatchRecordingFactory::Applied, Unretained(operation_factory_.get()), index));
+    ASSERT_OK(state_->AddPendingOperation(round));
+    state_->UpdateLastReceivedOpIdUnlocked(msg->id());
+  }
+
+  const int last_index = static_cast<int>(types.size());
+  ASSERT_OK(state_->AdvanceCommittedIndexUnlocked(MakeOpId(kMinimumTerm, last_index)));
+
+  const vector<std::string> expected = {
+      "start batch", "apply 1", "apply 2", "finish batch",
+      "apply 3",
+      "start batch", "apply 4", "apply 5", "finish batch" };
+  ASSERT_EQ(expected, operation_factory_->events());
+}
+
 }  // namespace consensus
 }  // namespace yb
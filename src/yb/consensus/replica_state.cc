@@ -783,6 +783,10 @@ Status ReplicaState::ApplyPendingOperationsUnlocked(IndexToRoundMap::iterator it
     max_allowed_op_id.index = std::numeric_limits<int64_t>::max();
   }
 
+  // Follower merges applies of consecutive write operations.
+  const bool batch_applies = GetActiveRoleUnlocked() != RaftPeerPB::LEADER;
+  bool apply_batch_started = false;
+
   while (iter != end_iter) {
     scoped_refptr<ConsensusRound> round = (*iter).second; // Make a copy.
     DCHECK(round);
@@ -794,6 +798,15 @@ Status ReplicaState::ApplyPendingOperationsUnlocked(IndexToRoundMap::iterator it
 
     auto type = round->replicate_msg()->op_type();
 
+    if (batch_applies && (type == OperationType::WRITE_OP) != apply_batch_started) {
+      if (apply_batch_started) {
+        operation_factory_->FinishApplyBatch();
+      } else {
+        operation_factory_->StartApplyBatch();
+      }
+      apply_batch_started = !apply_batch_started;
+    }
+
     // For write operations we block rocksdb flush, until appropriate records are written to the
     // log file. So we could apply them before adding to log.
     if (type != OperationType::WRITE_OP &&
@@ -814,6 +827,10 @@ Status ReplicaState::ApplyPendingOperationsUnlocked(IndexToRoundMap::iterator it
     round->NotifyReplicationFinished(Status::OK());//DHQ: Apply时调用这个，最后会调用上层注册的callback
   }
 
+  if (apply_batch_started) {
+    operation_factory_->FinishApplyBatch();
+  }
+
   SetLastCommittedIndexUnlocked(committed_index);
 
   return Status::OK();
@@ -157,9 +157,10 @@ class DocBoundaryValuesExtractor : public rocksdb::BoundaryValuesExtractor {
   Status Extract(Slice user_key, Slice value, rocksdb::UserBoundaryValues* values) override {
     if (user_key.size() >= 2 &&
         static_cast<ValueType>(user_key[0]) == ValueType::kIntentPrefix &&
-        static_cast<ValueType>(user_key[1]) == ValueType::kTransactionId) {
+        (static_cast<ValueType>(user_key[1]) == ValueType::kTransactionId ||
+         static_cast<ValueType>(user_key[1]) == ValueType::kTransactionApplyState)) {
       // Skipping reverse index from transaction id to keys of write intents belonging to that
-      // transaction.
+      // transaction, and states of transactions being applied.
       return Status::OK();
     }
 
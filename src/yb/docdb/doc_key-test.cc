@@ -13,6 +13,7 @@
 
 #include "yb/docdb/doc_key.h"
 
+#include <algorithm>
 #include <memory>
 
 #include "yb/rocksdb/table.h"
@@ -373,6 +374,112 @@ TEST(DocKeyTest, TestKeyMatching) {
   ASSERT_FALSE(may_match(EncodeSimpleSubDocKey(absent_key))) << "Key: " << absent_key;
 }
 
+TEST(DocKeyTest, TestRangePrefixKeyMatching) {
+  DocDbAwareFilterPolicy policy(rocksdb::FilterPolicy::kDefaultFixedSizeFilterBits, nullptr,
+                                1 /* num_range_components */);
+  ASSERT_STRNE("DocKeyHashedComponentsFilter", policy.Name());
+  const auto* transformer = policy.GetKeyTransformer();
+
+  auto encode = [](const std::string& hash_key, std::vector<PrimitiveValue> range_key) {
+    return SubDocKey(DocKey(0, PrimitiveValues(hash_key), range_key), PrimitiveValue("sub_key"),
+                     HybridTime::FromMicros(1000)).Encode().AsStringRef();
+  };
+
+  std::unique_ptr<FilterBitsBuilder> builder(policy.GetFilterBitsBuilder());
+  std::string last_filter_key;
+  for (const auto& key : { encode("h1", PrimitiveValues("r1", "x")),
+                           encode("h1", PrimitiveValues("r1", "y")),
+                           encode("h1", PrimitiveValues("r2", "x")),
+                           encode("h2", PrimitiveValues("r1", "z")) }) {
+    // Same as BlockBasedTableBuilder, don't add duplicate filter keys.
+    const auto filter_key = transformer->Transform(key);
+    if (filter_key != last_filter_key) {
+      builder->AddKey(filter_key);
+      last_filter_key = filter_key.ToBuffer();
+    }
+  }
+  std::unique_ptr<const char[]> buf;
+  rocksdb::Slice filter = builder->Finish(&buf);
+  std::unique_ptr<FilterBitsReader> reader(policy.GetFilterBitsReader(filter));
+
+  auto may_match = [&](const std::string& key) {
+    return reader->MayMatch(transformer->Transform(key));
+  };
+
+  // Keys pinning only hashed components.
+  ASSERT_TRUE(may_match(encode("h1", {})));
+  ASSERT_TRUE(may_match(encode("h2", {})));
+  ASSERT_FALSE(may_match(encode("h3", {})));
+
+  // Keys pinning hashed components and range prefix.
+  ASSERT_TRUE(may_match(encode("h1", PrimitiveValues("r1"))));
+  ASSERT_TRUE(may_match(encode("h1", PrimitiveValues("r2", "z"))));
+  ASSERT_TRUE(may_match(encode("h2", PrimitiveValues("r1", "x"))));
+  ASSERT_FALSE(may_match(encode("h1", PrimitiveValues("r3"))));
+  ASSERT_FALSE(may_match(encode("h2", PrimitiveValues("r2", "x"))));
+
+  ASSERT_FALSE(transformer->IsRangePrefixKey(transformer->Transform(encode("h1", {}))));
+  ASSERT_TRUE(transformer->IsRangePrefixKey(
+      transformer->Transform(encode("h1", PrimitiveValues("r1", "x")))));
+}
+
+TEST(DocKeyTest, TestRangePrefixNonDocKeys) {
+  DocDbAwareFilterPolicy policy(rocksdb::FilterPolicy::kDefaultFixedSizeFilterBits, nullptr,
+                                2 /* num_range_components */);
+  const auto* transformer = policy.GetKeyTransformer();
+  const std::string transaction_id = "0123456789abcdef";
+
+  std::vector<std::string> keys;
+  // Transaction reverse index key.
+  KeyBytes key;
+  key.AppendValueType(ValueType::kIntentPrefix);
+  key.AppendValueType(ValueType::kTransactionId);
+  key.AppendRawBytes(transaction_id);
+  key.AppendValueType(ValueType::kHybridTime);
+  key.AppendHybridTime(DocHybridTime(HybridTime::FromMicros(1000)));
+  keys.push_back(key.AsStringRef());
+
+  // Transaction apply state key.
+  key.Clear();
+  key.AppendValueType(ValueType::kIntentPrefix);
+  key.AppendValueType(ValueType::kTransactionApplyState);
+  key.AppendRawBytes(transaction_id);
+  keys.push_back(key.AsStringRef());
+
+  // Intent key without range group, only its hashed part could be decoded.
+  KeyBytes hashed_part = DocKey(0, PrimitiveValues("h1"), {}).Encode();
+  hashed_part.RemoveValueTypeSuffix(ValueType::kGroupEnd);
+  key.Clear();
+  key.AppendValueType(ValueType::kIntentPrefix);
+  key.AppendRawBytes(hashed_part.AsSlice());
+  key.AppendValueType(ValueType::kIntentType);
+  key.AppendIntentType(IntentType::kWeakSnapshotWrite);
+  keys.push_back(key.AsStringRef());
+
+  // Intent of the whole doc key.
+  key.Clear();
+  key.AppendValueType(ValueType::kIntentPrefix);
+  key.AppendRawBytes(DocKey(0, PrimitiveValues("h2"), PrimitiveValues("r1", "r2")).Encode()
+                         .AsSlice());
+  key.AppendValueType(ValueType::kIntentType);
+  key.AppendIntentType(IntentType::kStrongSnapshotWrite);
+  keys.push_back(key.AsStringRef());
+
+  std::sort(keys.begin(), keys.end());
+  std::unique_ptr<FilterBitsBuilder> builder(policy.GetFilterBitsBuilder());
+  for (const auto& encoded_key : keys) {
+    builder->AddKey(transformer->Transform(encoded_key));
+  }
+  std::unique_ptr<const char[]> buf;
+  rocksdb::Slice filter = builder->Finish(&buf);
+  std::unique_ptr<FilterBitsReader> reader(policy.GetFilterBitsReader(filter));
+
+  for (const auto& encoded_key : keys) {
+    ASSERT_TRUE(reader->MayMatch(transformer->Transform(encoded_key)))
+        << FormatBytesAsStr(encoded_key);
+  }
+}
+
 TEST(DocKeyTest, TestWriteId) {
   SubDocKey subdoc_key(DocKey({PrimitiveValue("a"), PrimitiveValue(135)}),
                        DocHybridTime(1000000, 4091, 135));
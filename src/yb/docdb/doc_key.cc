@@ -665,8 +665,120 @@ class HashedComponentsExtractor : public rocksdb::FilterPolicy::KeyTransformer {
   }
 };
 
+typedef boost::container::small_vector<size_t, 4> PrefixSizes;
+
+// Fills sizes with the encoded size of the hashed part of the given key, followed by the encoded
+// sizes of its prefixes ending with each of the first max_range_components range components.
+// Not every key in RocksDB is a DocKey, e.g. transaction reverse index and apply state keys, or
+// intents of a hashed key prefix. When the key could not be decoded, sizes of already decoded
+// prefixes are left in sizes, that is empty if the hashed part could not be decoded.
+Status GetRangePrefixSizes(Slice key, size_t max_range_components, PrefixSizes* sizes) {
+  const auto begin = key.cdata();
+  sizes->clear();
+  key.remove_prefix(VERIFY_RESULT(DocKey::EncodedSize(key, DocKeyPart::HASHED_PART_ONLY)));
+  sizes->push_back(key.cdata() - begin);
+  while (sizes->size() <= max_range_components && !key.empty() &&
+         static_cast<ValueType>(*key.data()) != ValueType::kGroupEnd) {
+    RETURN_NOT_OK(PrimitiveValue::DecodeKey(&key, nullptr /* out */));
+    sizes->push_back(key.cdata() - begin);
+  }
+  return Status::OK();
+}
+
+// Extracts hashed components and up to num_range_components range components of the key.
+class RangePrefixExtractor : public rocksdb::FilterPolicy::KeyTransformer {
+ public:
+  explicit RangePrefixExtractor(size_t num_range_components)
+      : num_range_components_(num_range_components) {}
+
+  // Keys that could not be decoded fall back to their longest decoded prefix, or to the whole key
+  // when even the hashed part could not be decoded. RangePrefixBitsBuilder adds the same keys.
+  Slice Transform(Slice key) const override {
+    PrefixSizes sizes;
+    auto status = GetRangePrefixSizes(key, num_range_components_, &sizes);
+    if (!status.ok()) {
+      VLOG(4) << "Failed to extract range prefix of " << key.ToDebugHexString() << ": " << status;
+      if (sizes.empty()) {
+        return key;
+      }
+    }
+    return Slice(key.data(), sizes.back());
+  }
+
+  bool IsRangePrefixKey(Slice filter_key) const override {
+    auto size = DocKey::EncodedSize(filter_key, DocKeyPart::HASHED_PART_ONLY);
+    return size.ok() && *size < filter_key.size();
+  }
+
+ private:
+  const size_t num_range_components_;
+};
+
+// Adds every shorter prefix of the transformed key down to the hashed part to the filter as well,
+// so scans pinning only hashed components or fewer range components still could be filtered.
+// Prefixes are only added when they differ from the ones of the previous key, which is enough
+// since keys come in sorted order and a new bits builder is used for each filter block.
+class RangePrefixBitsBuilder : public rocksdb::FilterBitsBuilder {
+ public:
+  RangePrefixBitsBuilder(rocksdb::FilterBitsBuilder* base, size_t num_range_components)
+      : base_(base), num_range_components_(num_range_components) {}
+
+  void AddKey(const Slice& key) override {
+    PrefixSizes sizes;
+    auto status = GetRangePrefixSizes(key, num_range_components_, &sizes);
+    if (!status.ok() && sizes.empty()) {
+      // Same as RangePrefixExtractor, the whole key is used when it is not a DocKey.
+      VLOG(4) << "Failed to extract range prefix of " << key.ToDebugHexString() << ": " << status;
+      base_->AddKey(key);
+      last_key_.clear();
+      last_sizes_.clear();
+      return;
+    }
+    bool same_as_last = true;
+    for (size_t i = 0; i != sizes.size(); ++i) {
+      same_as_last = same_as_last && i < last_sizes_.size() && sizes[i] == last_sizes_[i] &&
+                     Slice(key.data(), sizes[i]) == Slice(last_key_.data(), sizes[i]);
+      if (!same_as_last) {
+        base_->AddKey(Slice(key.data(), sizes[i]));
+      }
+    }
+    last_key_.assign(key.cdata(), key.size());
+    last_sizes_ = std::move(sizes);
+  }
+
+  Slice Finish(std::unique_ptr<const char[]>* buf) override {
+    return base_->Finish(buf);
+  }
+
+  bool IsFull() const override {
+    return base_->IsFull();
+  }
+
+ private:
+  std::unique_ptr<rocksdb::FilterBitsBuilder> base_;
+  const size_t num_range_components_;
+  std::string last_key_;
+  PrefixSizes last_sizes_;
+};
+
 } // namespace
 
+DocDbAwareFilterPolicy::DocDbAwareFilterPolicy(
+    size_t filter_block_size_bits, rocksdb::Logger* logger, size_t num_range_components)
+    : builtin_policy_(rocksdb::NewFixedSizeFilterPolicy(
+          filter_block_size_bits, rocksdb::FilterPolicy::kDefaultFixedSizeFilterErrorRate, logger)),
+      num_range_components_(num_range_components),
+      // Filters with different number of range components are not compatible, so policy name
+      // includes it and SST files written with other setting are read without filter.
+      name_(num_range_components == 0 ? "DocKeyHashedComponentsFilter"
+                                      : Format("DocKeyRangePrefixFilter$0", num_range_components)) {
+  if (num_range_components_ != 0) {
+    range_prefix_extractor_.reset(new RangePrefixExtractor(num_range_components_));
+  }
+}
+
+DocDbAwareFilterPolicy::~DocDbAwareFilterPolicy() {
+}
 
 void DocDbAwareFilterPolicy::CreateFilter(
     const rocksdb::Slice* keys, int n, std::string* dst) const {
@@ -680,6 +792,10 @@ bool DocDbAwareFilterPolicy::KeyMayMatch(
 }
 
 rocksdb::FilterBitsBuilder* DocDbAwareFilterPolicy::GetFilterBitsBuilder() const {
+  if (num_range_components_ != 0) {
+    return new RangePrefixBitsBuilder(
+        builtin_policy_->GetFilterBitsBuilder(), num_range_components_);
+  }
   return builtin_policy_->GetFilterBitsBuilder();
 }
 
@@ -693,6 +809,9 @@ rocksdb::FilterPolicy::FilterType DocDbAwareFilterPolicy::GetFilterType() const
 }
 
 const rocksdb::FilterPolicy::KeyTransformer* DocDbAwareFilterPolicy::GetKeyTransformer() const {
+  if (range_prefix_extractor_) {
+    return range_prefix_extractor_.get();
+  }
   return &HashedComponentsExtractor::GetInstance();
 }
 
@@ -497,14 +497,17 @@ std::string BestEffortDocDBKeyToStr(const KeyBytes &key_bytes);
 std::string BestEffortDocDBKeyToStr(const rocksdb::Slice &slice);
 
 // This filter policy only takes into account hashed components of keys for filtering.
+// If num_range_components is positive, keys are also added to the filter together with each of
+// their first num_range_components range components, so that scans which pin a range prefix in
+// addition to hashed components are able to skip SST files not containing that prefix.
 class DocDbAwareFilterPolicy : public rocksdb::FilterPolicy {
  public:
-  explicit DocDbAwareFilterPolicy(size_t filter_block_size_bits, rocksdb::Logger* logger) {
-    builtin_policy_.reset(rocksdb::NewFixedSizeFilterPolicy(
-        filter_block_size_bits, rocksdb::FilterPolicy::kDefaultFixedSizeFilterErrorRate, logger));
-  }
+  DocDbAwareFilterPolicy(size_t filter_block_size_bits, rocksdb::Logger* logger,
+                         size_t num_range_components = 0);
+
+  ~DocDbAwareFilterPolicy();
 
-  const char* Name() const override { return "DocKeyHashedComponentsFilter"; }
+  const char* Name() const override { return name_.c_str(); }
 
   void CreateFilter(const rocksdb::Slice* keys, int n, std::string* dst) const override;
 
@@ -520,6 +523,9 @@ class DocDbAwareFilterPolicy : public rocksdb::FilterPolicy {
 
  private:
   std::unique_ptr<const rocksdb::FilterPolicy> builtin_policy_;
+  const size_t num_range_components_;
+  const std::string name_;
+  std::unique_ptr<const KeyTransformer> range_prefix_extractor_;
 };
 
 }  // namespace docdb
@@ -23,6 +23,7 @@
 #include "yb/docdb/doc_ql_scanspec.h"
 #include "yb/docdb/intent_aware_iterator.h"
 #include "yb/docdb/subdocument.h"
+#include "yb/gutil/endian.h"
 #include "yb/gutil/strings/substitute.h"
 #include "yb/rocksdb/db/compaction.h"
 #include "yb/rocksutil/yb_rocksdb.h"
@@ -40,13 +41,15 @@ DocRowwiseIterator::DocRowwiseIterator(
     const TransactionOperationContextOpt& txn_op_context,
     rocksdb::DB *db,
     const ReadHybridTime& read_time,
-    yb::util::PendingOperationCounter* pending_op_counter)
+    yb::util::PendingOperationCounter* pending_op_counter,
+    const KeyBounds* key_bounds)
     : projection_(projection),
       schema_(schema),
       txn_op_context_(txn_op_context),
       read_time_(read_time),
       db_(db),
       has_bound_key_(false),
+      key_bounds_(key_bounds),
       pending_op_(pending_op_counter),
       done_(false) {
   projection_subkeys_.reserve(projection.num_columns() + 1);
@@ -93,11 +96,27 @@ Status DocRowwiseIterator::Init(const common::QLScanSpec& spec) {
   const auto mode = is_fixed_point_get ? BloomFilterMode::USE_BLOOM_FILTER :
       BloomFilterMode::DONT_USE_BLOOM_FILTER;
 
+  // Key for bloom filter consists of hashed components and leading range components that are
+  // pinned by the scan, i.e. equal in both bounds. Filter policy takes the part of it the filter
+  // was built on (see DocDbAwareFilterPolicy).
+  DocKey filter_doc_key(lower_doc_key);
+  filter_doc_key.ClearRangeComponents();
+  if (is_fixed_point_get) {
+    const auto& lower_range = lower_doc_key.range_group();
+    const auto& upper_range = upper_doc_key.range_group();
+    for (size_t i = 0; i < lower_range.size() && i < upper_range.size(); ++i) {
+      if (lower_range[i] != upper_range[i]) {
+        break;
+      }
+      filter_doc_key.AddRangeComponent(lower_range[i]);
+    }
+  }
+  const KeyBytes filter_key_encoded = filter_doc_key.Encode();
+
   const KeyBytes row_key_encoded = lower_doc_key.Encode();
-  const Slice row_key_encoded_as_slice = row_key_encoded.AsSlice();
 
   db_iter_ = CreateIntentAwareIterator(
-      db_, mode, row_key_encoded_as_slice, doc_spec.QueryId(), txn_op_context_, read_time_,
+      db_, mode, filter_key_encoded.AsSlice(), doc_spec.QueryId(), txn_op_context_, read_time_,
       doc_spec.CreateFileFilter());
 
   db_iter_->SeekWithoutHt(row_key_encoded);
@@ -130,6 +149,12 @@ Status DocRowwiseIterator::Init(const common::QLScanSpec& spec) {
   return Status::OK();
 }
 
+bool DocRowwiseIterator::IsWithinKeyBounds(const Slice& key) const {
+  // Bounds are hash partition keys, so only keys of hash partitioned documents are checked.
+  return key.empty() || key[0] != static_cast<char>(ValueType::kUInt16Hash) ||
+         key_bounds_->IsWithinBounds(key);
+}
+
 Status DocRowwiseIterator::EnsureIteratorPositionCorrect() const {
   if (!is_forward_scan_) {
     db_iter_->PrevDocKey(row_key_);
@@ -158,6 +183,22 @@ bool DocRowwiseIterator::HasNext() const {
       status_ = fetched_key.status();
       return true;
     }
+    if (key_bounds_ && !IsWithinKeyBounds(*fetched_key)) {
+      // Tablet created by a split shares data with its sibling until it is compacted. Move to the
+      // bound of the tablet, or stop if the scan already passed it.
+      const bool before_lower = !key_bounds_->lower.empty() &&
+                                fetched_key->compare(key_bounds_->lower) < 0;
+      if (is_forward_scan_ != before_lower) {
+        done_ = true;
+        return false;
+      }
+      if (is_forward_scan_) {
+        db_iter_->SeekWithoutHt(key_bounds_->lower);
+      } else {
+        db_iter_->PrevDocKey(DocKey(BigEndian::Load16(key_bounds_->upper.data() + 1), {}));
+      }
+      continue;
+    }
     {
       Slice key_copy = *fetched_key;
       status_ = row_key_.DecodeFrom(&key_copy);
@@ -26,6 +26,7 @@
 #include "yb/docdb/doc_key.h"
 #include "yb/docdb/subdocument.h"
 #include "yb/docdb/doc_ql_scanspec.h"
+#include "yb/docdb/key_bounds.h"
 #include "yb/docdb/value.h"
 #include "yb/util/status.h"
 #include "yb/util/pending_op_counter.h"
@@ -43,15 +44,18 @@ class DocRowwiseIterator : public common::QLRowwiseIteratorIf {
                      const TransactionOperationContextOpt& txn_op_context,
                      rocksdb::DB *db,
                      const ReadHybridTime& read_time,
-                     yb::util::PendingOperationCounter* pending_op_counter = nullptr);
+                     yb::util::PendingOperationCounter* pending_op_counter = nullptr,
+                     const KeyBounds* key_bounds = nullptr);
 
   DocRowwiseIterator(std::unique_ptr<Schema> projection,
                      const Schema &schema,
                      const TransactionOperationContextOpt& txn_op_context,
                      rocksdb::DB *db,
                      const ReadHybridTime& read_time,
-                     yb::util::PendingOperationCounter* pending_op_counter = nullptr)
-      : DocRowwiseIterator(*projection, schema, txn_op_context, db, read_time, pending_op_counter) {
+                     yb::util::PendingOperationCounter* pending_op_counter = nullptr,
+                     const KeyBounds* key_bounds = nullptr)
+      : DocRowwiseIterator(
+            *projection, schema, txn_op_context, db, read_time, pending_op_counter, key_bounds) {
     projection_owner_ = std::move(projection);
   }
 
@@ -127,6 +131,9 @@ class DocRowwiseIterator : public common::QLRowwiseIteratorIf {
   // ensures that the iterator will be positioned on the first kv-pair of the next row.
   CHECKED_STATUS EnsureIteratorPositionCorrect() const;
 
+  // Whether the encoded key belongs to this tablet according to key_bounds_.
+  bool IsWithinKeyBounds(const Slice& key) const;
+
   // Read next row into a value map using the specified projection.
   CHECKED_STATUS DoNextRow(const Schema& projection, QLTableRow* table_row) override;
 
@@ -152,6 +159,9 @@ class DocRowwiseIterator : public common::QLRowwiseIteratorIf {
   bool has_bound_key_;
   DocKey bound_key_;
 
+  // Bounds of the tablet, documents outside of them are skipped. Could be null.
+  const KeyBounds* key_bounds_;
+
   std::unique_ptr<IntentAwareIterator> db_iter_;
 
   // We keep the "pending operation" counter incremented for the lifetime of this iterator so that
@@ -27,6 +27,9 @@ KeyType GetKeyType(const Slice& slice) {
       } else {
         return KeyType::kReverseTxnKey;
       }
+    } else if (slice.size() > 1 &&
+               slice[1] == static_cast<char>(ValueType::kTransactionApplyState)) {
+      return KeyType::kTransactionApplyState;
     } else {
       return KeyType::kIntentKey;
     }
@@ -18,6 +18,7 @@
 
 #include "yb/rocksdb/db.h"
 #include "yb/rocksdb/status.h"
+#include "yb/rocksdb/table/block_based_table_factory.h"
 #include "yb/rocksdb/util/statistics.h"
 
 #include "yb/common/hybrid_time.h"
@@ -31,6 +32,7 @@
 #include "yb/rocksutil/yb_rocksdb.h"
 #include "yb/server/hybrid_clock.h"
 
+#include "yb/util/format.h"
 #include "yb/util/minmax.h"
 #include "yb/util/path_util.h"
 #include "yb/util/size_literals.h"
@@ -54,6 +56,7 @@ using rocksdb::WriteOptions;
 
 using namespace std::chrono_literals;
 
+DECLARE_bool(db_use_data_block_hash_index);
 DECLARE_bool(use_docdb_aware_bloom_filter);
 DECLARE_int32(max_nexts_to_avoid_seek);
 
@@ -1497,6 +1500,77 @@ TEST_F(DocDBTest, BloomFilterTest) {
   ASSERT_NO_FATALS(CheckBloom(2, &total_bloom_useful, 2, &total_table_iterators));
 }
 
+TEST_F(DocDBTest, DataBlockHashIndex) {
+  google::FlagSaver flag_saver;
+  // Turn off "next instead of seek" optimization, so every lookup seeks.
+  FLAGS_max_nexts_to_avoid_seek = 0;
+  FLAGS_db_use_data_block_hash_index = true;
+  ASSERT_OK(ReinitDBOptions());
+
+  // A stored key and a seek target for the same key at a read time share the hash index key.
+  const auto* table_factory =
+      down_cast<rocksdb::BlockBasedTableFactory*>(options().table_factory.get());
+  const auto* key_transformer =
+      table_factory->table_options().data_block_hash_index_key_transformer;
+  ASSERT_NE(key_transformer, nullptr);
+  SubDocKey subdoc_key(DocKey(PrimitiveValues("key")), PrimitiveValue("subkey"));
+  const KeyBytes key_without_ht = subdoc_key.Encode(false /* include_hybrid_time */);
+  subdoc_key.set_hybrid_time(DocHybridTime(HybridTime::FromMicros(1000), 1));
+  const KeyBytes stored_key = subdoc_key.Encode();
+  KeyBytes seek_target = key_without_ht;
+  AppendDocHybridTime(DocHybridTime(HybridTime::FromMicros(2000), kMaxWriteId), &seek_target);
+  ASSERT_EQ(key_without_ht.AsSlice(), key_transformer->Transform(stored_key.AsSlice()));
+  ASSERT_EQ(key_without_ht.AsSlice(), key_transformer->Transform(seek_target.AsSlice()));
+  // Keys without hybrid time are left as is.
+  ASSERT_EQ(key_without_ht.AsSlice(), key_transformer->Transform(key_without_ht.AsSlice()));
+
+  // Several versions of each key, so data blocks contain several entries per hash index key.
+  constexpr int kNumKeys = 1000;
+  constexpr int kNumVersions = 3;
+  auto make_key = [](int i) {
+    return DocKey(PrimitiveValues(Format("key_$0", i)));
+  };
+  auto make_value = [](int i, int version) {
+    return PrimitiveValue(Format("value_$0_$1", i, version));
+  };
+  for (int version = 1; version <= kNumVersions; ++version) {
+    auto dwb = MakeDocWriteBatch();
+    for (int i = 0; i < kNumKeys; ++i) {
+      if ((i + version) % 4 == 0) {
+        // Skip some versions, so keys have different number of versions.
+        continue;
+      }
+      ASSERT_OK(dwb.SetPrimitive(DocPath(make_key(i).Encode()), make_value(i, version)));
+    }
+    ASSERT_OK(WriteToRocksDB(dwb, HybridTime::FromMicros(1000 * version)));
+  }
+  ASSERT_OK(FlushRocksDB());
+
+  for (int i = 0; i < kNumKeys; ++i) {
+    for (int read_version = 0; read_version <= kNumVersions; ++read_version) {
+      const auto read_ht = HybridTime::FromMicros(1000 * read_version + 500);
+      int expected_version = read_version;
+      while (expected_version > 0 && (i + expected_version) % 4 == 0) {
+        --expected_version;
+      }
+      SubDocKey lookup_key(make_key(i));
+      SubDocument doc_from_rocksdb;
+      bool subdoc_found_in_rocksdb = false;
+      GetSubDocumentData data = { &lookup_key, &doc_from_rocksdb, &subdoc_found_in_rocksdb };
+      ASSERT_OK(GetSubDocument(
+          rocksdb(), data, rocksdb::kDefaultQueryId, kNonTransactionalOperationContext,
+          ReadHybridTime::SingleTime(read_ht)));
+      ASSERT_EQ(expected_version > 0, subdoc_found_in_rocksdb)
+          << "Key: " << i << ", read time: " << read_ht;
+      if (expected_version > 0) {
+        ASSERT_EQ(SubDocument(make_value(i, expected_version)).ToString(),
+                  doc_from_rocksdb.ToString())
+            << "Key: " << i << ", read time: " << read_ht;
+      }
+    }
+  }
+}
+
 TEST_F(DocDBTest, MergingIterator) {
   // Test for the case described in https://yugabyte.atlassian.net/browse/ENG-1677.
 
@@ -2037,5 +2111,52 @@ TEST_F(DocDBTest, TestCompactionForCollectionsWithTTL) {
   }
 }
 
+TEST_F(DocDBTest, ApplyIntentsInBatches) {
+  SetTransactionIsolationLevel(IsolationLevel::SNAPSHOT_ISOLATION);
+  Result<TransactionId> txn = FullyDecodeTransactionId("0000000000000001");
+  ASSERT_OK(txn);
+
+  SetCurrentTransactionId(*txn);
+  for (int i = 0; i < 5; ++i) {
+    ASSERT_OK(SetPrimitive(
+        DocPath(kEncodedDocKey1, PrimitiveValue(ColumnId(10 + i))),
+        PrimitiveValue(i), HybridTime::FromMicros(1000)));
+  }
+  ResetCurrentTransactionId();
+
+  // Apply intents two records at a time, persisting the state between batches like the
+  // transaction participant does.
+  ApplyTransactionStatePB apply_state;
+  int num_batches = 0;
+  do {
+    rocksdb::WriteBatch write_batch;
+    auto result = PrepareApplyIntentsBatch(
+        *txn, HybridTime::FromMicros(2000), apply_state, 2 /* max_records */, rocksdb(),
+        &write_batch);
+    ASSERT_OK(result);
+    apply_state = *result;
+    ASSERT_OK(rocksdb()->Write(rocksdb::WriteOptions(), &write_batch));
+    ++num_batches;
+
+    size_t num_pending = 0;
+    ASSERT_OK(EnumerateApplyTransactionStates(
+        rocksdb(), [&num_pending, &txn](const TransactionId& id, const ApplyTransactionStatePB&) {
+          ASSERT_EQ(*txn, id);
+          ++num_pending;
+        }));
+    ASSERT_EQ(apply_state.has_key() ? 1 : 0, num_pending);
+  } while (apply_state.has_key());
+  ASSERT_GT(num_batches, 1);
+
+  // All intents, reverse index records and the apply state are gone, all values are applied.
+  const string dump = DocDBDebugDumpToStr();
+  ASSERT_EQ(string::npos, dump.find("TransactionId")) << dump;
+  ASSERT_EQ(string::npos, dump.find("TXN")) << dump;
+  for (int i = 0; i < 5; ++i) {
+    ASSERT_NE(string::npos, dump.find(Format("[ColumnId($0); HT{ physical: 2000", 10 + i)))
+        << dump;
+  }
+}
+
 }  // namespace docdb
 }  // namespace yb
@@ -125,13 +125,10 @@ const IndexBound& IndexBound::Empty() {
   return result;
 }
 
-void PrepareDocWriteOperation(const vector<unique_ptr<DocOperation>>& doc_write_ops,
-                              const scoped_refptr<Histogram>& write_lock_latency,
-                              IsolationLevel isolation_level,
-                              SharedLockManager *lock_manager,
-                              LockBatch *keys_locked,
-                              bool *need_read_snapshot) {
-  KeyToIntentTypeMap key_to_lock_type;
+void DetermineKeysToLock(const vector<unique_ptr<DocOperation>>& doc_write_ops,
+                         IsolationLevel isolation_level,
+                         KeyToIntentTypeMap* keys_to_lock,
+                         bool* need_read_snapshot) {
   *need_read_snapshot = false;
   for (const unique_ptr<DocOperation>& doc_op : doc_write_ops) {
     list<DocPath> doc_paths;
@@ -145,15 +142,25 @@ void PrepareDocWriteOperation(const vector<unique_ptr<DocOperation>>& doc_write_
     for (const auto& doc_path : doc_paths) {
       KeyBytes current_prefix = doc_path.encoded_doc_key();
       for (int i = 0; i < doc_path.num_subkeys(); i++) {
-        ApplyIntent(current_prefix.AsStringRef(), intent_types.weak, &key_to_lock_type);
+        ApplyIntent(current_prefix.AsStringRef(), intent_types.weak, keys_to_lock);
         doc_path.subkey(i).AppendToKey(&current_prefix);
       }
-      ApplyIntent(current_prefix.AsStringRef(), intent_types.strong, &key_to_lock_type);
+      ApplyIntent(current_prefix.AsStringRef(), intent_types.strong, keys_to_lock);
     }
     if (doc_op->RequireReadSnapshot()) {
       *need_read_snapshot = true;
     }
   }
+}
+
+void PrepareDocWriteOperation(const vector<unique_ptr<DocOperation>>& doc_write_ops,
+                              const scoped_refptr<Histogram>& write_lock_latency,
+                              IsolationLevel isolation_level,
+                              SharedLockManager *lock_manager,
+                              LockBatch *keys_locked,
+                              bool *need_read_snapshot) {
+  KeyToIntentTypeMap key_to_lock_type;
+  DetermineKeysToLock(doc_write_ops, isolation_level, &key_to_lock_type, need_read_snapshot);
   const MonoTime start_time = (write_lock_latency != nullptr) ? MonoTime::Now() : MonoTime();
   *keys_locked = LockBatch(lock_manager, std::move(key_to_lock_type));
   if (write_lock_latency != nullptr) {
@@ -748,6 +755,12 @@ Result<std::string> DocDBKeyToDebugStr(Slice key_slice, KeyType* key_type) {
       RETURN_NOT_OK(transaction_id);
       return Format("TXN META $0", *transaction_id);
     }
+    case KeyType::kTransactionApplyState:
+    {
+      key_slice.remove_prefix(2); // kIntentPrefix + kTransactionApplyState
+      auto transaction_id = VERIFY_RESULT(DecodeTransactionId(&key_slice));
+      return Format("TXN APPLY STATE $0", transaction_id);
+    }
     case KeyType::kEmpty: FALLTHROUGH_INTENDED;
     case KeyType::kValueKey:
       RETURN_NOT_OK_PREPEND(
@@ -793,6 +806,13 @@ Result<std::string> DocDBValueToDebugStr(
       KeyType ignore_key_type;
       return DocDBKeyToDebugStr(value, &ignore_key_type);
     }
+    case KeyType::kTransactionApplyState: {
+      ApplyTransactionStatePB apply_state;
+      if (!apply_state.ParseFromArray(value.cdata(), value.size())) {
+        return STATUS_FORMAT(Corruption, "Bad apply state: $0", value.ToDebugHexString());
+      }
+      return apply_state.ShortDebugString();
+    }
     case KeyType::kEmpty: FALLTHROUGH_INTENDED;
     case KeyType::kIntentKey: FALLTHROUGH_INTENDED;
     case KeyType::kValueKey:
@@ -870,8 +890,15 @@ Slice DocHybridTimeBuffer::EncodeWithValueType(const DocHybridTime& doc_ht) {
                                    intent_iter->value().ToDebugHexString(), \
                                    transaction_id_slice.ToDebugHexString()))
 
-Status PrepareApplyIntentsBatch(
+void AppendTransactionApplyStateKey(const TransactionId& transaction_id, KeyBytes* out) {
+  out->AppendValueType(ValueType::kIntentPrefix);
+  out->AppendValueType(ValueType::kTransactionApplyState);
+  out->AppendRawBytes(Slice(transaction_id.data, transaction_id.size()));
+}
+
+Result<ApplyTransactionStatePB> PrepareApplyIntentsBatch(
     const TransactionId& transaction_id, HybridTime commit_ht,
+    const ApplyTransactionStatePB& apply_state, size_t max_records,
     rocksdb::DB* db, rocksdb::WriteBatch* write_batch) {
   Slice reverse_index_upperbound;
   auto reverse_index_iter = CreateRocksDBIterator(
@@ -889,11 +916,17 @@ Status PrepareApplyIntentsBatch(
   txn_reverse_index_upperbound.AppendValueType(ValueType::kMaxByte);
   reverse_index_upperbound = txn_reverse_index_upperbound.AsSlice();
 
-  reverse_index_iter->Seek(txn_reverse_index_prefix.data());
+  // Continue from the record where previous batch stopped. It also allows us to skip tombstones
+  // of already applied records.
+  const bool continuation = apply_state.has_key();
+  reverse_index_iter->Seek(continuation ? Slice(apply_state.key())
+                                        : txn_reverse_index_prefix.AsSlice());
 
   DocHybridTimeBuffer doc_ht_buffer;
 
-  IntraTxnWriteId write_id = 0;
+  IntraTxnWriteId write_id = continuation ? apply_state.write_id() : 0;
+  size_t num_records = 0;
+  ApplyTransactionStatePB result;
   while (reverse_index_iter->Valid()) {
     rocksdb::Slice key_slice(reverse_index_iter->key());
 
@@ -901,18 +934,29 @@ Status PrepareApplyIntentsBatch(
       break;
     }
 
+    // If the key ends at the transaction id then it is transaction metadata (status tablet,
+    // isolation level etc.). It is deleted after all intents are applied, because it is required
+    // to load transaction until then.
+    if (key_slice.size() == txn_reverse_index_prefix.size()) {
+      reverse_index_iter->Next();
+      continue;
+    }
+
+    if (max_records != 0 && num_records == max_records) {
+      // Keep the APPLYING operation of the passed state.
+      result = apply_state;
+      result.set_key(key_slice.cdata(), key_slice.size());
+      result.set_write_id(write_id);
+      result.set_commit_ht(commit_ht.ToUint64());
+      break;
+    }
+    ++num_records;
+
     VLOG(4) << "Apply reverse index record: " << EntryToString(*reverse_index_iter);
 
-    // If the key ends at the transaction id then it is transaction metadata (status tablet,
-    // isolation level etc.).
-    if (key_slice.size() > txn_reverse_index_prefix.size()) {
-      // Value of reverse index is a key of original intent record, so seek it and check match.
-      intent_iter->Seek(reverse_index_iter->value());
-      if (!intent_iter->Valid() || intent_iter->key() != reverse_index_iter->value()) {
-        LOG(DFATAL) << "Unable to find intent: " << reverse_index_iter->value().ToDebugString()
-                    << " for " << reverse_index_iter->key().ToDebugString();
-        continue;
-      }
+    // Value of reverse index is a key of original intent record, so seek it and check match.
+    intent_iter->Seek(reverse_index_iter->value());
+    if (intent_iter->Valid() && intent_iter->key() == reverse_index_iter->value()) {
       auto intent = VERIFY_RESULT(ParseIntentKey(intent_iter->key(), transaction_id_slice));
 
       if (IsStrongIntent(intent.type)) {
@@ -939,6 +983,9 @@ Status PrepareApplyIntentsBatch(
       }
 
       write_batch->Delete(intent_iter->key());
+    } else {
+      LOG(DFATAL) << "Unable to find intent: " << reverse_index_iter->value().ToDebugString()
+                  << " for " << reverse_index_iter->key().ToDebugString();
     }
 
     write_batch->Delete(reverse_index_iter->key());
@@ -946,6 +993,42 @@ Status PrepareApplyIntentsBatch(
     reverse_index_iter->Next();
   }
 
+  KeyBytes apply_state_key;
+  AppendTransactionApplyStateKey(transaction_id, &apply_state_key);
+  if (result.has_key()) {
+    write_batch->Put(apply_state_key.AsSlice(), result.SerializeAsString());
+  } else {
+    write_batch->Delete(txn_reverse_index_prefix.AsSlice());
+    if (continuation) {
+      write_batch->Delete(apply_state_key.AsSlice());
+    }
+  }
+
+  return result;
+}
+
+Status EnumerateApplyTransactionStates(
+    rocksdb::DB* db,
+    const std::function<void(const TransactionId&, const ApplyTransactionStatePB&)>& callback) {
+  KeyBytes prefix;
+  prefix.AppendValueType(ValueType::kIntentPrefix);
+  prefix.AppendValueType(ValueType::kTransactionApplyState);
+
+  auto iter = CreateRocksDBIterator(
+      db, BloomFilterMode::DONT_USE_BLOOM_FILTER, boost::none, rocksdb::kDefaultQueryId);
+  for (iter->Seek(prefix.AsSlice()); iter->Valid() && iter->key().starts_with(prefix.AsSlice());
+       iter->Next()) {
+    Slice key = iter->key();
+    key.remove_prefix(prefix.size());
+    auto transaction_id = VERIFY_RESULT(FullyDecodeTransactionId(key));
+    ApplyTransactionStatePB apply_state;
+    if (!apply_state.ParseFromArray(iter->value().cdata(), iter->value().size())) {
+      return STATUS_FORMAT(
+          Corruption, "Bad apply state of $0: $1", transaction_id,
+          iter->value().ToDebugHexString());
+    }
+    callback(transaction_id, apply_state);
+  }
   return Status::OK();
 }
 
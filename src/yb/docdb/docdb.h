@@ -15,6 +15,7 @@
 #define YB_DOCDB_DOCDB_H_
 
 #include <cstdint>
+#include <functional>
 #include <ostream>
 #include <string>
 #include <vector>
@@ -36,6 +37,7 @@
 #include "yb/docdb/docdb.pb.h"
 #include "yb/docdb/intent.h"
 #include "yb/docdb/internal_doc_iterator.h"
+#include "yb/docdb/lock_batch.h"
 #include "yb/docdb/primitive_value.h"
 #include "yb/docdb/shared_lock_manager_fwd.h"
 #include "yb/docdb/value.h"
@@ -109,6 +111,13 @@ void PrepareDocWriteOperation(const std::vector<std::unique_ptr<DocOperation>>&
                               LockBatch *keys_locked,
                               bool *need_read_snapshot);
 
+// Determines keys that should be locked by doc_write_ops, without locking them. Used when locks of
+// several write requests are taken at once.
+void DetermineKeysToLock(const std::vector<std::unique_ptr<DocOperation>>& doc_write_ops,
+                         IsolationLevel isolation_level,
+                         KeyToIntentTypeMap* keys_to_lock,
+                         bool* need_read_snapshot);
+
 // This constructs a DocWriteBatch using the given list of DocOperations, reading the previous
 // state of data from RocksDB when necessary.
 //
@@ -156,10 +165,24 @@ void PrepareTransactionWriteBatch(
     const TransactionId& transaction_id,
     IsolationLevel isolation_level);
 
-CHECKED_STATUS PrepareApplyIntentsBatch(
+// Prepares batch that applies intents of the transaction, i.e. writes regular records for them
+// and deletes intents with reverse index records.
+// When apply_state has key, applying continues from the state returned for the previous batch.
+// At most max_records reverse index records are processed, 0 means no limit.
+// Returns state to continue from, that has no key when all intents have been applied. This state
+// is also stored in the batch, so apply could be resumed after restart. Op id and log hybrid time
+// of apply_state are kept in the returned state.
+Result<ApplyTransactionStatePB> PrepareApplyIntentsBatch(
     const TransactionId& transaction_id, HybridTime commit_ht,
+    const ApplyTransactionStatePB& apply_state, size_t max_records,
     rocksdb::DB* db, rocksdb::WriteBatch* write_batch);
 
+// Invokes callback for each transaction, whose intents were partially applied, with state to
+// continue applying from.
+CHECKED_STATUS EnumerateApplyTransactionStates(
+    rocksdb::DB* db,
+    const std::function<void(const TransactionId&, const ApplyTransactionStatePB&)>& callback);
+
 // A visitor class that could be overridden to consume results of scanning SubDocuments.
 // See e.g. SubDocumentBuildingVisitor (used in implementing GetSubDocument) as example usage.
 // We can scan any SubDocument from a node in the document tree.
@@ -39,13 +39,15 @@ namespace docdb {
 DocDBCompactionFilter::DocDBCompactionFilter(HybridTime history_cutoff,
                                              ColumnIdsPtr deleted_cols,
                                              bool is_full_compaction,
-                                             MonoDelta table_ttl)
+                                             MonoDelta table_ttl,
+                                             const KeyBounds* key_bounds)
     : history_cutoff_(history_cutoff),
       is_full_compaction_(is_full_compaction),
       is_first_key_value_(true),
       filter_usage_logged_(false),
       table_ttl_(table_ttl),
-      deleted_cols_(deleted_cols) {
+      deleted_cols_(deleted_cols),
+      key_bounds_(key_bounds) {
 }
 
 DocDBCompactionFilter::~DocDBCompactionFilter() {
@@ -56,6 +58,13 @@ bool DocDBCompactionFilter::Filter(int level,
                                    const rocksdb::Slice& existing_value,
                                    std::string* new_value,
                                    bool* value_changed) const {
+  // Documents that belong to another tablet could be removed by any compaction, since they could
+  // not be read from this tablet.
+  if (key_bounds_ && !key.empty() && key[0] == static_cast<char>(ValueType::kUInt16Hash) &&
+      !key_bounds_->IsWithinBounds(key)) {
+    return true;
+  }
+
   if (!is_full_compaction_) {
     // By default, we only perform history garbage collection on full compactions
     // (or major compactions, in the HBase terminology).
@@ -214,9 +223,10 @@ const char* DocDBCompactionFilter::Name() const {
 // ------------------------------------------------------------------------------------------------
 
 DocDBCompactionFilterFactory::DocDBCompactionFilterFactory(
-    shared_ptr<HistoryRetentionPolicy> retention_policy)
+    shared_ptr<HistoryRetentionPolicy> retention_policy, const KeyBounds* key_bounds)
     :
-    retention_policy_(retention_policy) {
+    retention_policy_(retention_policy),
+    key_bounds_(key_bounds) {
 }
 
 DocDBCompactionFilterFactory::~DocDBCompactionFilterFactory() {
@@ -227,7 +237,8 @@ unique_ptr<CompactionFilter> DocDBCompactionFilterFactory::CreateCompactionFilte
   return unique_ptr<DocDBCompactionFilter>(
       new DocDBCompactionFilter(retention_policy_->GetHistoryCutoff(),
                                 retention_policy_->GetDeletedColumns(),
-                                context.is_full_compaction, retention_policy_->GetTableTTL()));
+                                context.is_full_compaction, retention_policy_->GetTableTTL(),
+                                key_bounds_));
 }
 
 const char* DocDBCompactionFilterFactory::Name() const {
@@ -16,6 +16,7 @@
 
 #include <atomic>
 #include <memory>
+#include <string>
 #include <vector>
 
 #include "yb/rocksdb/compaction_filter.h"
@@ -23,6 +24,7 @@
 #include "yb/common/schema.h"
 #include "yb/common/hybrid_time.h"
 #include "yb/docdb/doc_key.h"
+#include "yb/docdb/key_bounds.h"
 
 namespace yb {
 namespace docdb {
@@ -32,7 +34,8 @@ class DocDBCompactionFilter : public rocksdb::CompactionFilter {
   DocDBCompactionFilter(HybridTime history_cutoff,
                         ColumnIdsPtr deleted_cols,
                         bool is_full_compaction,
-                        MonoDelta table_ttl);
+                        MonoDelta table_ttl,
+                        const KeyBounds* key_bounds = nullptr);
 
   ~DocDBCompactionFilter() override;
   bool Filter(int level,
@@ -100,6 +103,9 @@ class DocDBCompactionFilter : public rocksdb::CompactionFilter {
   MonoDelta table_ttl_;
 
   ColumnIdsPtr deleted_cols_;
+
+  // Documents outside of these bounds are removed, could be null.
+  const KeyBounds* key_bounds_;
 };
 
 // A strategy for deciding the history cutoff. We may implement this differently in production and
@@ -139,7 +145,9 @@ class FixedHybridTimeRetentionPolicy : public HistoryRetentionPolicy {
 
 class DocDBCompactionFilterFactory : public rocksdb::CompactionFilterFactory {
  public:
-  explicit DocDBCompactionFilterFactory(std::shared_ptr<HistoryRetentionPolicy> retention_policy);
+  // key_bounds should outlive the factory, could be null.
+  explicit DocDBCompactionFilterFactory(std::shared_ptr<HistoryRetentionPolicy> retention_policy,
+                                        const KeyBounds* key_bounds = nullptr);
   ~DocDBCompactionFilterFactory() override;
   std::unique_ptr<rocksdb::CompactionFilter> CreateCompactionFilter(
       const rocksdb::CompactionFilter::Context& context) override;
@@ -147,6 +155,7 @@ class DocDBCompactionFilterFactory : public rocksdb::CompactionFilterFactory {
 
  private:
   std::shared_ptr<HistoryRetentionPolicy> retention_policy_;
+  const KeyBounds* key_bounds_;
 };
 
 }  // namespace docdb
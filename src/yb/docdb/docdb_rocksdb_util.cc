@@ -15,12 +15,14 @@
 
 #include <memory>
 
+#include "yb/common/doc_hybrid_time.h"
 #include "yb/common/transaction.h"
 
 #include "yb/rocksdb/rate_limiter.h"
 #include "yb/rocksdb/table.h"
 
 #include "yb/docdb/intent_aware_iterator.h"
+#include "yb/docdb/value_type.h"
 #include "yb/rocksutil/yb_rocksdb.h"
 #include "yb/rocksutil/yb_rocksdb_logger.h"
 #include "yb/server/hybrid_clock.h"
@@ -67,11 +69,32 @@ DEFINE_int64(db_index_block_size_bytes, 32_KB,
 DEFINE_int64(db_min_keys_per_index_block, 100,
              "Minimum number of keys per index block.");
 
+DEFINE_int64(db_initial_auto_readahead_size_bytes, 8_KB,
+             "Initial size of adaptive readahead window for RocksDB iterators doing sequential "
+             "scans (in bytes).");
+
+DEFINE_int64(db_max_auto_readahead_size_bytes, 256_KB,
+             "Maximal size of adaptive readahead window for RocksDB iterators doing sequential "
+             "scans (in bytes). 0 to disable adaptive readahead.");
+
+DEFINE_int64(db_single_hash_key_read_max_readahead_size_bytes, 32_KB,
+             "Maximal size of adaptive readahead window for reads restricted to a single hash key "
+             "(in bytes), so that point reads and short scans do not prefetch data they will "
+             "not use.");
+
 DEFINE_int64(db_write_buffer_size, -1,
              "Size of RocksDB write buffer (in bytes). -1 to use default.");
 
+DEFINE_uint64(db_memtable_insert_chunk_size, 4096,
+              "Number of write batch entries inserted into the memtable by one thread, when a "
+              "large write batch is inserted concurrently. See db_memtable_insert_threads.");
+
 DEFINE_bool(use_docdb_aware_bloom_filter, true,
             "Whether to use the DocDbAwareFilterPolicy for both bloom storage and seeks.");
+DEFINE_int32(docdb_bloom_filter_range_components, 0,
+             "Number of leading range components added to DocDB bloom filters in addition to "
+             "hashed components, so that scans pinning them skip SST files without such prefix. "
+             "0 builds bloom filters on hashed components only.");
 DEFINE_int32(max_nexts_to_avoid_seek, 1,
              "The number of next calls to try before doing resorting to do a rocksdb seek.");
 DEFINE_bool(trace_docdb_calls, false, "Whether we should trace calls into the docdb.");
@@ -79,9 +102,24 @@ DEFINE_bool(trace_docdb_calls, false, "Whether we should trace calls into the do
 // supports multi-level index). Also update other places in tests where it is set to true
 // explicitly.
 DEFINE_bool(use_multi_level_index, false, "Whether to use multi-level data index.");
+// TODO - switch to true once necessary installations are upgraded to a build which is able to read
+// data blocks with hash index.
+DEFINE_bool(db_use_data_block_hash_index, false,
+            "Whether to append a hash index to SST data blocks. The index is keyed by DocDB keys "
+            "without hybrid time, so point lookups of a key at a read time skip the binary search "
+            "in the data block.");
 
 DEFINE_uint64(initial_seqno, 1ULL << 50, "Initial seqno for new RocksDB instances.");
 
+DEFINE_bool(rocksdb_check_sst_file_sizes_on_open, false,
+            "Whether RocksDB should stat all SST files when a tablet is opened, to check that "
+            "their sizes match the MANIFEST. Slows down tablet server restart when there are "
+            "many SST files.");
+
+DEFINE_bool(rocksdb_update_stats_on_open, false,
+            "Whether RocksDB should read table properties of SST files when a tablet is opened, "
+            "to update statistics used by compactions.");
+
 using std::shared_ptr;
 using std::string;
 using std::unique_ptr;
@@ -308,11 +346,38 @@ rocksdb::ReadOptions PrepareReadOptions(
     read_opts.table_aware_file_filter = rocksdb->GetOptions().table_factory->
         NewTableAwareReadFileFilter(read_opts, user_key_for_filter.get());
   }
+  if (bloom_filter_mode == BloomFilterMode::USE_BLOOM_FILTER) {
+    read_opts.max_auto_readahead_size = FLAGS_db_single_hash_key_read_max_readahead_size_bytes;
+  }
   read_opts.file_filter = std::move(file_filter);
   read_opts.iterate_upper_bound = iterate_upper_bound;
   return read_opts;
 }
 
+// Strips the hybrid time from DocDB keys, so that all versions of a key and seek targets for this
+// key at any read time have the same data block hash index key. Other keys are left as is.
+class HybridTimeSuffixStripper : public rocksdb::FilterPolicy::KeyTransformer {
+ public:
+  static const HybridTimeSuffixStripper& GetInstance() {
+    static HybridTimeSuffixStripper instance;
+    return instance;
+  }
+
+  // Called for each seek, so sizes are checked here instead of building a status on mismatch.
+  Slice Transform(Slice key) const override {
+    const size_t encoded_ht_size = DocHybridTime::GetEncodedSize(key);
+    if (encoded_ht_size == 0 || encoded_ht_size > kMaxBytesPerEncodedHybridTime ||
+        encoded_ht_size >= key.size()) {
+      return key;
+    }
+    const size_t prefix_size = key.size() - encoded_ht_size - 1;
+    if (key[prefix_size] != static_cast<uint8_t>(ValueType::kHybridTime)) {
+      return key;
+    }
+    return Slice(key.data(), prefix_size);
+  }
+};
+
 } // namespace
 
 unique_ptr<rocksdb::Iterator> CreateRocksDBIterator(
@@ -353,9 +418,20 @@ void InitRocksDBOptions(
   options->initial_seqno = FLAGS_initial_seqno;
   options->boundary_extractor = DocBoundaryValuesExtractorInstance();
   options->memory_monitor = tablet_options.memory_monitor;
+  // File list and frontiers are read from the MANIFEST, while table readers are opened lazily on
+  // first access, because max_open_files is limited. So opening RocksDB does not touch SST files
+  // unless it was asked to.
+  options->skip_checking_sst_file_sizes_on_db_open = !FLAGS_rocksdb_check_sst_file_sizes_on_open;
+  options->skip_stats_update_on_db_open = !FLAGS_rocksdb_update_stats_on_open;
   if (FLAGS_db_write_buffer_size != -1) {
     options->write_buffer_size = FLAGS_db_write_buffer_size;
   }
+  if (tablet_options.memtable_insert_pool) {
+    options->allow_concurrent_memtable_write = true;
+    options->enable_write_thread_adaptive_yield = true;
+    options->memtable_insert_pool = tablet_options.memtable_insert_pool;
+    options->memtable_insert_chunk_size = FLAGS_db_memtable_insert_chunk_size;
+  }
   options->listeners.insert(
       options->listeners.end(), tablet_options.listeners.begin(),
       tablet_options.listeners.end()); // Append listeners
@@ -364,6 +440,7 @@ void InitRocksDBOptions(
   rocksdb::BlockBasedTableOptions table_options;
   if (tablet_options.block_cache) {
     table_options.block_cache = tablet_options.block_cache;
+    table_options.block_cache_compressed = tablet_options.block_cache_compressed;
     // Cache the bloom filters in the block cache.
     table_options.cache_index_and_filter_blocks = true;
   } else {
@@ -374,11 +451,19 @@ void InitRocksDBOptions(
   table_options.filter_block_size = FLAGS_db_filter_block_size_bytes;
   table_options.index_block_size = FLAGS_db_index_block_size_bytes;
   table_options.min_keys_per_index_block = FLAGS_db_min_keys_per_index_block;
+  table_options.initial_auto_readahead_size = FLAGS_db_initial_auto_readahead_size_bytes;
+  table_options.max_auto_readahead_size = FLAGS_db_max_auto_readahead_size_bytes;
+
+  if (FLAGS_db_use_data_block_hash_index) {
+    table_options.use_data_block_hash_index = true;
+    table_options.data_block_hash_index_key_transformer = &HybridTimeSuffixStripper::GetInstance();
+  }
 
   // Set our custom bloom filter that is docdb aware.
   if (FLAGS_use_docdb_aware_bloom_filter) {
     table_options.filter_policy.reset(new DocDbAwareFilterPolicy(
-        table_options.filter_block_size * 8, options->info_log.get()));
+        table_options.filter_block_size * 8, options->info_log.get(),
+        std::max(FLAGS_docdb_bloom_filter_range_components, 0)));
   }
 
   if (FLAGS_use_multi_level_index) {
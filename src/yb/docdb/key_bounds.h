@@ -0,0 +1,50 @@
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+
+#ifndef YB_DOCDB_KEY_BOUNDS_H
+#define YB_DOCDB_KEY_BOUNDS_H
+
+#include <string>
+
+#include "yb/util/slice.h"
+
+namespace yb {
+namespace docdb {
+
+// Range of encoded hash-partitioned DocDB keys that belong to a tablet. Empty bound means that
+// the range is not limited from this side.
+//
+// After a tablet is split, both children start with all data of the parent. Reads of a child skip
+// documents that belong to its sibling, and compactions of the child remove them.
+struct KeyBounds {
+  std::string lower;
+  std::string upper;
+
+  KeyBounds() = default;
+  KeyBounds(std::string lower_, std::string upper_)
+      : lower(std::move(lower_)), upper(std::move(upper_)) {}
+
+  bool IsWithinBounds(const Slice& key) const {
+    return (lower.empty() || key.compare(lower) >= 0) &&
+           (upper.empty() || key.compare(upper) < 0);
+  }
+
+  bool IsInitialized() const {
+    return !lower.empty() || !upper.empty();
+  }
+};
+
+}  // namespace docdb
+}  // namespace yb
+
+#endif // YB_DOCDB_KEY_BOUNDS_H
@@ -28,6 +28,24 @@ LockBatch::LockBatch(SharedLockManager* lock_manager, KeyToIntentTypeMap&& key_t
   }
 }
 
+LockBatch::LockBatch(SharedLockManager* lock_manager, KeyToIntentTypeMap&& key_to_intent_type,
+                     bool already_locked)
+    : key_to_type_(std::move(key_to_intent_type)),
+      shared_lock_manager_(lock_manager) {
+  DCHECK(already_locked);
+}
+
+boost::optional<LockBatch> LockBatch::TryLock(
+    SharedLockManager* lock_manager, KeyToIntentTypeMap* key_to_intent_type) {
+  if (key_to_intent_type->empty()) {
+    return LockBatch();
+  }
+  if (!lock_manager->TryLock(*key_to_intent_type)) {
+    return boost::none;
+  }
+  return LockBatch(lock_manager, std::move(*key_to_intent_type), true);
+}
+
 LockBatch::~LockBatch() {
   Reset();
 }
@@ -16,6 +16,8 @@
 
 #include <string>
 
+#include <boost/optional/optional.hpp>
+
 #include <glog/logging.h>
 
 #include "yb/docdb/value_type.h"
@@ -51,7 +53,16 @@ class LockBatch {
   // Unlocks this batch if it is non-empty.
   void Reset();
 
+  // Locks keys only if none of them is locked with a conflicting intent, see
+  // SharedLockManager::TryLock. Otherwise returns boost::none and leaves key_to_intent_type as is.
+  static boost::optional<LockBatch> TryLock(SharedLockManager* lock_manager,
+                                            KeyToIntentTypeMap* key_to_intent_type);
+
  private:
+  // Creates a batch for keys that are already locked.
+  LockBatch(SharedLockManager* lock_manager, KeyToIntentTypeMap&& key_to_intent_type,
+            bool already_locked);
+
   void MoveFrom(LockBatch* other);
 
   KeyToIntentTypeMap key_to_type_;
@@ -47,6 +47,7 @@ using yb::util::FastDecodeSignedVarInt;
     case ValueType::kGroupEnd: FALLTHROUGH_INTENDED; \
     case ValueType::kGroupEndDescending: FALLTHROUGH_INTENDED; \
     case ValueType::kIntentPrefix: FALLTHROUGH_INTENDED; \
+    case ValueType::kTransactionApplyState: FALLTHROUGH_INTENDED; \
     case ValueType::kInvalidValueType: FALLTHROUGH_INTENDED; \
     case ValueType::kObject: FALLTHROUGH_INTENDED; \
     case ValueType::kRedisSet: FALLTHROUGH_INTENDED; \
@@ -191,7 +192,8 @@ string PrimitiveValue::ToString() const {
     case ValueType::kGroupEndDescending: FALLTHROUGH_INTENDED;
     case ValueType::kTtl: FALLTHROUGH_INTENDED;
     case ValueType::kUserTimestamp: FALLTHROUGH_INTENDED;
-    case ValueType::kIntentPrefix:
+    case ValueType::kIntentPrefix: FALLTHROUGH_INTENDED;
+    case ValueType::kTransactionApplyState:
       break;
     case ValueType::kLowest:
       return "-Inf";
@@ -459,6 +461,7 @@ string PrimitiveValue::ToValue() const {
     case ValueType::kGroupEnd: FALLTHROUGH_INTENDED;
     case ValueType::kGroupEndDescending: FALLTHROUGH_INTENDED;
     case ValueType::kIntentPrefix: FALLTHROUGH_INTENDED;
+    case ValueType::kTransactionApplyState: FALLTHROUGH_INTENDED;
     case ValueType::kTtl: FALLTHROUGH_INTENDED;
     case ValueType::kUserTimestamp: FALLTHROUGH_INTENDED;
     case ValueType::kColumnId: FALLTHROUGH_INTENDED;
@@ -959,6 +962,7 @@ Status PrimitiveValue::DecodeFromValue(const rocksdb::Slice& rocksdb_slice) {
     case ValueType::kGroupEnd: FALLTHROUGH_INTENDED;
     case ValueType::kGroupEndDescending: FALLTHROUGH_INTENDED;
     case ValueType::kIntentPrefix: FALLTHROUGH_INTENDED;
+    case ValueType::kTransactionApplyState: FALLTHROUGH_INTENDED;
     case ValueType::kUInt16Hash: FALLTHROUGH_INTENDED;
     case ValueType::kInvalidValueType: FALLTHROUGH_INTENDED;
     case ValueType::kTtl: FALLTHROUGH_INTENDED;
@@ -19,6 +19,7 @@
 #include "yb/rocksdb/db.h"
 #include "yb/common/ql_rowwise_iterator_interface.h"
 #include "yb/common/ql_storage_interface.h"
+#include "yb/docdb/key_bounds.h"
 
 namespace yb {
 namespace docdb {
@@ -26,7 +27,8 @@ namespace docdb {
 // Implementation of QLStorageIf with rocksdb as a backend. This is what all of our QL tables use.
 class QLRocksDBStorage : public common::QLStorageIf {
  public:
-  explicit QLRocksDBStorage(rocksdb::DB *rocksdb);
+  // Iterators skip documents outside of key_bounds, that should outlive the storage. Could be null.
+  explicit QLRocksDBStorage(rocksdb::DB *rocksdb, const KeyBounds* key_bounds = nullptr);
 
   CHECKED_STATUS GetIterator(const QLReadRequestPB& request,
                              const Schema& projection,
@@ -45,6 +47,7 @@ class QLRocksDBStorage : public common::QLStorageIf {
                                  ReadHybridTime* req_read_time) const override;
  private:
   rocksdb::DB *const rocksdb_;
+  const KeyBounds* const key_bounds_;
 };
 
 }  // namespace docdb
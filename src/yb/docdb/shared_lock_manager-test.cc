@@ -262,6 +262,41 @@ TEST_F(SharedLockManagerTest, RandomLockUnlockManyThreadsTest) {
   Run(2, 8);
 }
 
+TEST_F(SharedLockManagerTest, TryLock) {
+  KeyToIntentTypeMap first = {
+      {"a", IntentType::kWeakSnapshotWrite}, {"a.b", IntentType::kStrongSnapshotWrite}};
+  KeyToIntentTypeMap second = {
+      {"a", IntentType::kWeakSnapshotWrite}, {"a.c", IntentType::kStrongSnapshotWrite}};
+  KeyToIntentTypeMap third = {
+      {"0", IntentType::kStrongSnapshotWrite}, {"a", IntentType::kStrongSnapshotWrite}};
+  KeyToIntentTypeMap fourth = {{"0", IntentType::kStrongSnapshotWrite}};
+
+  ASSERT_FALSE(SharedLockManager::Conflict(first, second));
+  ASSERT_TRUE(SharedLockManager::Conflict(first, third));
+  ASSERT_TRUE(SharedLockManager::Conflict(third, second));
+
+  auto first_lock = LockBatch::TryLock(&lm_, &first);
+  ASSERT_TRUE(first_lock);
+  ASSERT_EQ(2, first_lock->size());
+  auto second_lock = LockBatch::TryLock(&lm_, &second);
+  ASSERT_TRUE(second_lock);
+
+  // The third batch conflicts on "a", so "0" that was locked before it is unlocked back.
+  ASSERT_FALSE(LockBatch::TryLock(&lm_, &third));
+  ASSERT_EQ(2, third.size());
+  {
+    auto fourth_lock = LockBatch::TryLock(&lm_, &fourth);
+    ASSERT_TRUE(fourth_lock);
+  }
+
+  first_lock->Reset();
+  ASSERT_FALSE(LockBatch::TryLock(&lm_, &third));
+  second_lock->Reset();
+  auto third_lock = LockBatch::TryLock(&lm_, &third);
+  ASSERT_TRUE(third_lock);
+  ASSERT_EQ(2, third_lock->size());
+}
+
 namespace {
 
 // Returns true if c1 covers (is superset of) c2.
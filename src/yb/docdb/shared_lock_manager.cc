@@ -208,6 +208,17 @@ void SharedLockManager::LockEntry::Lock(IntentType lock_type) {
   state.set(type_idx);
 }
 
+bool SharedLockManager::LockEntry::TryLock(IntentType lock_type) {
+  int type_idx = static_cast<size_t>(lock_type);
+  std::lock_guard<std::mutex> lock(mutex);
+  if ((state & kIntentConflicts[type_idx]).any()) {
+    return false;
+  }
+  ++num_holding[type_idx];
+  state.set(type_idx);
+  return true;
+}
+
 void SharedLockManager::LockEntry::Unlock(IntentType lock_type) {
   int type_idx = static_cast<int>(lock_type);
   bool should_notify = false;
@@ -241,6 +252,40 @@ void SharedLockManager::Lock(const KeyToIntentTypeMap& key_to_intent_type) {
   }
 }
 
+bool SharedLockManager::TryLock(const KeyToIntentTypeMap& key_to_intent_type) {
+  std::vector<SharedLockManager::LockEntry*> reserved = Reserve(key_to_intent_type);
+  size_t idx = 0;
+  for (const auto& key_and_intent_type : key_to_intent_type) {
+    if (!reserved[idx]->TryLock(key_and_intent_type.second)) {
+      VLOG(4) << "Failed to lock " << docdb::ToString(key_and_intent_type.second) << ": "
+              << util::FormatBytesAsStr(key_and_intent_type.first);
+      std::lock_guard<std::mutex> lock(global_mutex_);
+      auto it = key_to_intent_type.begin();
+      for (size_t i = 0; i != idx; ++i, ++it) {
+        reserved[i]->Unlock(it->second);
+      }
+      Cleanup(key_to_intent_type);
+      return false;
+    }
+    idx++;
+  }
+  TRACE("Locked a batch of $0 keys without waiting", key_to_intent_type.size());
+  return true;
+}
+
+bool SharedLockManager::Conflict(const KeyToIntentTypeMap& lhs, const KeyToIntentTypeMap& rhs) {
+  const auto& smaller = lhs.size() <= rhs.size() ? lhs : rhs;
+  const auto& larger = lhs.size() <= rhs.size() ? rhs : lhs;
+  for (const auto& key_and_intent_type : smaller) {
+    auto it = larger.find(key_and_intent_type.first);
+    if (it != larger.end() &&
+        kIntentConflicts[to_underlying(key_and_intent_type.second)][to_underlying(it->second)]) {
+      return true;
+    }
+  }
+  return false;
+}
+
 std::vector<SharedLockManager::LockEntry*> SharedLockManager::Reserve(
     const KeyToIntentTypeMap& key_to_intent_type) {
   std::vector<SharedLockManager::LockEntry*> reserved;
@@ -42,9 +42,17 @@ class SharedLockManager {
   // this lock manager, which makes it auto-unlock on destruction.
   void Lock(const KeyToIntentTypeMap& key_to_intent_type);
 
+  // Attempt to lock a batch of keys without waiting. Returns false and leaves all keys unlocked
+  // if some key is locked with a conflicting intent.
+  bool TryLock(const KeyToIntentTypeMap& key_to_intent_type);
+
   // Release the batch of locks. Requires that the locks are held.
   void Unlock(const KeyToIntentTypeMap& key_to_intent_type);
 
+  // Whether some key is present in both batches with conflicting intents, so they could not be
+  // held at the same time.
+  static bool Conflict(const KeyToIntentTypeMap& lhs, const KeyToIntentTypeMap& rhs);
+
   void LockInTest(const std::string& key, IntentType intent_type);
   void UnlockInTest(const std::string& key, IntentType intent_type);
 
@@ -72,6 +80,8 @@ class SharedLockManager {
 
     void Lock(IntentType lock_type);
 
+    bool TryLock(IntentType lock_type);
+
     void Unlock(IntentType lock_type);
 
     LockEntry() {
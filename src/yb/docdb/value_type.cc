@@ -67,6 +67,7 @@ string ToString(ValueType value_type) {
     case ValueType::kTtl: return "Ttl";
     case ValueType::kUserTimestamp: return "UserTimestamp";
     case ValueType::kTransactionId: return "TransactionId";
+    case ValueType::kTransactionApplyState: return "TransactionApplyState";
     case ValueType::kIntentType: return "IntentType";
     case ValueType::kColumnId: return "ColumnId";
     case ValueType::kSystemColumnId: return "SystemColumnId";
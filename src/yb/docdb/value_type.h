@@ -110,6 +110,8 @@ enum class ValueType : char {
   kTtl = 't',  // ASCII code 116
   kUserTimestamp = 'u',  // ASCII code 117
   kTransactionId = 'x', // ASCII code 120
+  // Prefix of records storing progress of applying intents of big transactions.
+  kTransactionApplyState = 'y', // ASCII code 121
 
   kObject = '{',  // ASCII code 123
 
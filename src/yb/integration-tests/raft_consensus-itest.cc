@@ -81,9 +81,12 @@ DECLARE_int32(leader_lease_duration_ms);
 DECLARE_int32(ht_lease_duration_ms);
 DECLARE_int32(rpc_timeout);
 
+METRIC_DECLARE_entity(server);
 METRIC_DECLARE_entity(tablet);
 METRIC_DECLARE_counter(operation_memory_pressure_rejections);
 METRIC_DECLARE_gauge_int64(raft_term);
+METRIC_DECLARE_histogram(handler_latency_yb_consensus_ConsensusService_UpdateConsensus);
+METRIC_DECLARE_histogram(handler_latency_yb_consensus_ConsensusService_MultiRaftHeartbeat);
 
 namespace yb {
 namespace tserver {
@@ -147,17 +150,11 @@ class RaftConsensusITest : public TabletServerIntegrationTestBase {
     FLAGS_consensus_rpc_timeout_ms = kConsensusRpcTimeoutForTests;
   }
 
-  void ScanReplica(TabletServerServiceProxy* replica_proxy,
-                   vector<string>* results) {
-
-    ReadRequestPB req;
-    ReadResponsePB resp;
-    RpcController rpc;
-    rpc.set_timeout(MonoDelta::FromSeconds(10));  // Squelch warnings.
-
-    req.set_tablet_id(tablet_id_);
-    req.set_consistency_level(YBConsistencyLevel::CONSISTENT_PREFIX);
-    auto batch = req.add_ql_batch();
+  // Fills request to scan all rows of the tablet, that could be served by any replica.
+  void PrepareScanRequest(ReadRequestPB* req) {
+    req->set_tablet_id(tablet_id_);
+    req->set_consistency_level(YBConsistencyLevel::CONSISTENT_PREFIX);
+    auto batch = req->add_ql_batch();
     batch->set_schema_version(0);
     int id = kFirstColumnId;
     auto rsrow = batch->mutable_rsrow_desc();
@@ -169,6 +166,18 @@ class RaftConsensusITest : public TabletServerIntegrationTestBase {
       col.type()->ToQLTypePB(coldesc->mutable_ql_type());
       ++id;
     }
+  }
+
+  void ScanReplica(TabletServerServiceProxy* replica_proxy,
+                   vector<string>* results) {
+
+    ReadRequestPB req;
+    ReadResponsePB resp;
+    RpcController rpc;
+    rpc.set_timeout(MonoDelta::FromSeconds(10));  // Squelch warnings.
+
+    PrepareScanRequest(&req);
+    auto rsrow = req.mutable_ql_batch(0)->mutable_rsrow_desc();
 
     // Send the call
     {
@@ -684,6 +693,53 @@ TEST_F(RaftConsensusITest, TestRunLeaderElection) {
   ASSERT_ALL_REPLICAS_AGREE(FLAGS_client_inserts_per_thread * num_iters * 2);
 }
 
+// Test that heartbeats of an idle tablet are sent in batched MultiRaftHeartbeat RPCs, and that
+// the leader keeps its leadership while the tablet is idle.
+TEST_F(RaftConsensusITest, TestIdleTabletHeartbeatsAreBatched) {
+  ASSERT_NO_FATALS(BuildAndStart(vector<string>()));
+
+  TServerDetails* leader = nullptr;
+  ASSERT_OK(GetLeaderReplicaWithRetries(tablet_id_, &leader));
+  ASSERT_OK(WaitForServersToAgree(MonoDelta::FromSeconds(10), tablet_servers_, tablet_id_, 1));
+
+  auto get_counts = [this, leader](int64_t* num_updates, int64_t* num_heartbeats) {
+    *num_updates = 0;
+    *num_heartbeats = 0;
+    for (int i = 0; i < cluster_->num_tablet_servers(); i++) {
+      auto* ets = cluster_->tablet_server(i);
+      if (ets->uuid() == leader->uuid()) {
+        continue;
+      }
+      int64_t count;
+      RETURN_NOT_OK(ets->GetInt64Metric(
+          &METRIC_ENTITY_server, "yb.tabletserver",
+          &METRIC_handler_latency_yb_consensus_ConsensusService_UpdateConsensus, "total_count",
+          &count));
+      *num_updates += count;
+      RETURN_NOT_OK(ets->GetInt64Metric(
+          &METRIC_ENTITY_server, "yb.tabletserver",
+          &METRIC_handler_latency_yb_consensus_ConsensusService_MultiRaftHeartbeat, "total_count",
+          &count));
+      *num_heartbeats += count;
+    }
+    return Status::OK();
+  };
+
+  int64_t updates_before, heartbeats_before;
+  ASSERT_OK(get_counts(&updates_before, &heartbeats_before));
+  SleepFor(MonoDelta::FromSeconds(5));
+  int64_t updates_after, heartbeats_after;
+  ASSERT_OK(get_counts(&updates_after, &heartbeats_after));
+
+  LOG(INFO) << "UpdateConsensus calls: " << updates_after - updates_before
+            << ", MultiRaftHeartbeat calls: " << heartbeats_after - heartbeats_before;
+  ASSERT_GT(heartbeats_after - heartbeats_before, updates_after - updates_before);
+
+  TServerDetails* new_leader = nullptr;
+  ASSERT_OK(GetLeaderReplicaWithRetries(tablet_id_, &new_leader));
+  ASSERT_EQ(leader->uuid(), new_leader->uuid());
+}
+
 void RaftConsensusITest::Write128KOpsToLeader(int num_writes) {
   TServerDetails* leader = nullptr;
   ASSERT_OK(GetLeaderReplicaWithRetries(tablet_id_, &leader));
@@ -2759,6 +2815,55 @@ TEST_F(RaftConsensusITest, TestRemovePreObserverServerSucceeds) {
   TestRemoveTserverInTransitionSucceeds(RaftPeerPB::PRE_VOTER);
 }
 
+// Checks that a follower rejects non-strong reads, when its safe time lags behind the clock by more
+// than max_stale_read_bound_time_ms, because it does not hear from the leader.
+TEST_F(RaftConsensusITest, TestStaleFollowerRead) {
+  const MonoDelta kTimeout = MonoDelta::FromSeconds(30);
+  FLAGS_num_tablet_servers = 3;
+  FLAGS_num_replicas = 3;
+  vector<string> ts_flags = {
+      "--enable_leader_failure_detection=false"s,
+      "--max_stale_read_bound_time_ms=2000"s,
+  };
+  vector<string> master_flags = {
+      "--catalog_manager_wait_for_new_tablets_to_elect_leader=false"s,
+  };
+  ASSERT_NO_FATALS(BuildAndStart(ts_flags, master_flags));
+
+  vector<TServerDetails*> tservers = TServerDetailsVector(tablet_servers_);
+  TServerDetails* leader = tservers[0];
+  TServerDetails* follower = tservers[1];
+  ASSERT_OK(StartElection(leader, tablet_id_, kTimeout));
+  ASSERT_OK(WaitUntilCommittedOpIdIndexIs(1, leader, tablet_id_, kTimeout));
+  ASSERT_OK(WriteSimpleTestRow(
+      leader, tablet_id_, kTestRowKey, kTestRowIntVal, "initial insert", kTimeout));
+
+  // Follower serves reads while it hears from the leader.
+  vector<string> results;
+  ASSERT_NO_FATALS(WaitForRowCount(follower->tserver_proxy.get(), 1, &results));
+
+  auto read_error_code = [this, follower]() -> Result<TabletServerErrorPB::Code> {
+    ReadRequestPB req;
+    ReadResponsePB resp;
+    RpcController rpc;
+    rpc.set_timeout(MonoDelta::FromSeconds(10));
+    PrepareScanRequest(&req);
+    RETURN_NOT_OK(follower->tserver_proxy->Read(req, &resp, &rpc));
+    return resp.has_error() ? resp.error().code() : TabletServerErrorPB::UNKNOWN_ERROR;
+  };
+
+  // Leader failure detection is disabled, so the follower stays without a leader while it is
+  // paused, and its safe time does not move.
+  ExternalTabletServer* leader_ets = cluster_->tablet_server_by_uuid(leader->uuid());
+  ASSERT_OK(leader_ets->Pause());
+  ASSERT_OK(WaitFor([&read_error_code]() -> Result<bool> {
+    return VERIFY_RESULT(read_error_code()) == TabletServerErrorPB::STALE_FOLLOWER;
+  }, kTimeout, "Follower rejects stale reads"));
+
+  ASSERT_OK(leader_ets->Resume());
+  ASSERT_NO_FATALS(WaitForRowCount(follower->tserver_proxy.get(), 1, &results));
+}
+
 TEST_F(RaftConsensusITest, TestRemovePreVoterServerSucceeds) {
   TestRemoveTserverInTransitionSucceeds(RaftPeerPB::PRE_OBSERVER);
 }
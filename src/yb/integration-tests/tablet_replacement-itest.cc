@@ -42,10 +42,13 @@
 
 #include "yb/common/wire_protocol.h"
 #include "yb/common/wire_protocol-test-util.h"
+#include "yb/consensus/quorum_util.h"
 #include "yb/gutil/strings/substitute.h"
+#include "yb/gutil/strings/util.h"
 #include "yb/integration-tests/external_mini_cluster-itest-base.h"
 #include "yb/integration-tests/cluster_verifier.h"
 #include "yb/integration-tests/test_workload.h"
+#include "yb/util/path_util.h"
 
 using yb::consensus::RaftPeerPB;
 using yb::itest::TServerDetails;
@@ -238,6 +241,95 @@ TEST_F(TabletReplacementITest, TestEvictAndReplaceDeadFollower) {
   ASSERT_OK(cluster_->tablet_server(kFollowerIndex)->Restart());
 }
 
+// Test that a follower, whose SST file was found corrupted by the data scrubber, is evicted and
+// replaced.
+TEST_F(TabletReplacementITest, TestEvictAndReplaceCorruptedFollower) {
+  if (!AllowSlowTests()) {
+    LOG(INFO) << "Skipping test in fast-test mode.";
+    return;
+  }
+
+  MonoDelta timeout = MonoDelta::FromSeconds(60);
+  vector<string> ts_flags = { "--enable_leader_failure_detection=false",
+                              "--enable_data_scrubber=false",
+                              "--data_scrubber_pass_interval_secs=1",
+                              "--memstore_size_mb=1",
+                              "--rocksdb_disable_compactions=true" };
+  vector<string> master_flags = { "--catalog_manager_wait_for_new_tablets_to_elect_leader=false" };
+  ASSERT_NO_FATALS(StartCluster(ts_flags, master_flags));
+
+  TestWorkload workload(cluster_.get());
+  workload.set_payload_bytes(1024);
+  workload.Setup();
+
+  const int kLeaderIndex = 0;
+  TServerDetails* leader_ts = ts_map_[cluster_->tablet_server(kLeaderIndex)->uuid()].get();
+  const int kFollowerIndex = 2;
+
+  // Figure out the tablet id of the created tablet.
+  vector<ListTabletsResponsePB::StatusAndSchemaPB> tablets;
+  ASSERT_OK(itest::WaitForNumTabletsOnTS(leader_ts, 1, timeout, &tablets));
+  string tablet_id = tablets[0].tablet_status().tablet_id();
+
+  // Wait until all replicas are up and running.
+  for (int i = 0; i < cluster_->num_tablet_servers(); i++) {
+    ASSERT_OK(itest::WaitUntilTabletRunning(ts_map_[cluster_->tablet_server(i)->uuid()].get(),
+                                            tablet_id, timeout));
+  }
+
+  // Elect a leader (TS 0)
+  ASSERT_OK(itest::StartElection(leader_ts, tablet_id, timeout));
+  ASSERT_OK(itest::WaitForServersToAgree(timeout, ts_map_, tablet_id, 1)); // Wait for NO_OP.
+
+  // Write until the follower flushes an SST file.
+  tablet::TabletSuperBlockPB superblock;
+  ASSERT_OK(inspect_->ReadTabletSuperBlockOnTS(kFollowerIndex, tablet_id, &superblock));
+  const string rocksdb_dir = superblock.rocksdb_dir();
+  string sst_path;
+  workload.Start();
+  ASSERT_OK(WaitFor([this, &rocksdb_dir, &sst_path]() -> Result<bool> {
+    vector<string> files;
+    RETURN_NOT_OK(inspect_->ListFilesInDir(rocksdb_dir, &files));
+    for (const auto& file : files) {
+      // Data blocks are stored in the data file of the SST.
+      if (HasSuffixString(file, ".sblock.0")) {
+        sst_path = JoinPathSegments(rocksdb_dir, file);
+        return true;
+      }
+    }
+    return false;
+  }, timeout, "Follower flushed SST file"));
+  workload.StopAndJoin();
+  ASSERT_OK(itest::WaitForServersToAgree(timeout, ts_map_, tablet_id, 1));
+
+  consensus::ConsensusStatePB cstate;
+  ASSERT_OK(itest::GetConsensusState(leader_ts, tablet_id, consensus::CONSENSUS_CONFIG_COMMITTED,
+                                     timeout, &cstate));
+  const int64_t initial_config_index = cstate.config().opid_index();
+
+  // Corrupt a data block of the SST file, and let the data scrubber of the follower find it.
+  faststring data;
+  ASSERT_OK(ReadFileToString(env_.get(), sst_path, &data));
+  ASSERT_GT(data.size(), 0);
+  data[data.size() / 2] ^= 0xff;
+  ASSERT_OK(WriteStringToFile(env_.get(), Slice(data), sst_path));
+  ASSERT_OK(cluster_->SetFlag(cluster_->tablet_server(kFollowerIndex),
+                              "enable_data_scrubber", "true"));
+
+  // The failed follower is evicted by the leader, then the load balancer adds a new replica.
+  ASSERT_OK(WaitFor([&]() -> Result<bool> {
+    RETURN_NOT_OK(itest::GetConsensusState(
+        leader_ts, tablet_id, consensus::CONSENSUS_CONFIG_COMMITTED, timeout, &cstate));
+    return cstate.config().opid_index() > initial_config_index &&
+           consensus::CountVoters(cstate.config()) == 3;
+  }, timeout, "Corrupted follower replaced"));
+
+  ClusterVerifier cluster_verifier(cluster_.get());
+  ASSERT_NO_FATALS(cluster_verifier.CheckCluster());
+  ASSERT_NO_FATALS(cluster_verifier.CheckRowCount(workload.table_name(),
+                            ClusterVerifier::AT_LEAST, workload.rows_inserted()));
+}
+
 // Regression test for KUDU-1233. This test creates a situation in which tablet
 // bootstrap will attempt to replay committed (and applied) config change
 // operations. This is achieved by delaying application of a write at the
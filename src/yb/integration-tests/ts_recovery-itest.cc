@@ -35,6 +35,7 @@
 #include "yb/integration-tests/cluster_verifier.h"
 #include "yb/integration-tests/external_mini_cluster.h"
 #include "yb/integration-tests/test_workload.h"
+#include "yb/util/format.h"
 #include "yb/util/test_util.h"
 
 using std::string;
@@ -52,6 +53,8 @@ class TsRecoveryITest : public YBTest {
   void StartCluster(const vector<string>& extra_tserver_flags = vector<string>(),
                     int num_tablet_servers = 1);
 
+  void TestCrashDuringLogReplay(bool reuse_log_segments);
+
   gscoped_ptr<ExternalMiniCluster> cluster_;
 };
 
@@ -64,9 +67,10 @@ void TsRecoveryITest::StartCluster(const vector<string>& extra_tserver_flags,
   ASSERT_OK(cluster_->Start());
 }
 
-// Test that we replay from the recovery directory, if it exists.
-TEST_F(TsRecoveryITest, TestCrashDuringLogReplay) {
-  ASSERT_NO_FATALS(StartCluster({ "--fault_crash_during_log_replay=0.05" }));
+void TsRecoveryITest::TestCrashDuringLogReplay(bool reuse_log_segments) {
+  ASSERT_NO_FATALS(StartCluster({
+      "--fault_crash_during_log_replay=0.05",
+      Format("--tablet_bootstrap_reuse_log_segments=$0", reuse_log_segments) }));
 
   TestWorkload work(cluster_.get());
   work.set_num_replicas(1);
@@ -110,4 +114,14 @@ TEST_F(TsRecoveryITest, TestCrashDuringLogReplay) {
                                        MonoDelta::FromSeconds(30)));
 }
 
+// Test that we replay from the recovery directory, if it exists.
+TEST_F(TsRecoveryITest, TestCrashDuringLogReplay) {
+  TestCrashDuringLogReplay(/* reuse_log_segments */ false);
+}
+
+// Test that replay of log segments in place could be restarted after crash.
+TEST_F(TsRecoveryITest, TestCrashDuringInPlaceLogReplay) {
+  TestCrashDuringLogReplay(/* reuse_log_segments */ true);
+}
+
 }  // namespace yb
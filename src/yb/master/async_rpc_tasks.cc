@@ -627,6 +627,72 @@ bool AsyncTruncate::SendRequest(int attempt) {
   return true;
 }
 
+// ============================================================================
+//  Class AsyncSplitTablet.
+// ============================================================================
+AsyncSplitTablet::AsyncSplitTablet(Master* master,
+                                   ThreadPool* callback_pool,
+                                   const scoped_refptr<TabletInfo>& tablet,
+                                   const std::string& new_tablet1_id,
+                                   const std::string& new_tablet2_id,
+                                   const std::string& split_partition_key)
+    : RetryingTSRpcTask(master,
+                        callback_pool,
+                        gscoped_ptr<TSPicker>(new PickLeaderReplica(tablet)),
+                        tablet->table().get()),
+      tablet_(tablet),
+      new_tablet1_id_(new_tablet1_id),
+      new_tablet2_id_(new_tablet2_id),
+      split_partition_key_(split_partition_key) {
+}
+
+string AsyncSplitTablet::description() const {
+  return tablet_->ToString() + " Split Tablet RPC";
+}
+
+TabletId AsyncSplitTablet::tablet_id() const {
+  return tablet_->tablet_id();
+}
+
+TabletServerId AsyncSplitTablet::permanent_uuid() const {
+  return target_ts_desc_ != nullptr ? target_ts_desc_->permanent_uuid() : "";
+}
+
+void AsyncSplitTablet::HandleResponse(int attempt) {
+  if (resp_.has_error()) {
+    const Status s = StatusFromPB(resp_.error().status());
+    const TabletServerErrorPB::Code code = resp_.error().code();
+    LOG(WARNING) << "TS " << permanent_uuid() << ": split failed for tablet " << tablet_id()
+                 << " with error code " << TabletServerErrorPB::Code_Name(code)
+                 << ": " << s.ToString();
+    // The tablet was already split into other tablets, so there is no reason to retry.
+    if (code == TabletServerErrorPB::TABLET_SPLIT ||
+        code == TabletServerErrorPB::TABLET_NOT_FOUND) {
+      PerformStateTransition(kStateRunning, kStateComplete);
+    }
+  } else {
+    VLOG(1) << "TS " << permanent_uuid() << ": split complete on tablet " << tablet_id();
+    PerformStateTransition(kStateRunning, kStateComplete);
+  }
+
+  server::UpdateClock(resp_, master_->clock());
+}
+
+bool AsyncSplitTablet::SendRequest(int attempt) {
+  tserver::SplitTabletRequestPB req;
+  req.set_dest_uuid(permanent_uuid());
+  req.set_tablet_id(tablet_id());
+  req.set_new_tablet1_id(new_tablet1_id_);
+  req.set_new_tablet2_id(new_tablet2_id_);
+  req.set_split_partition_key(split_partition_key_);
+  req.set_propagated_hybrid_time(master_->clock()->Now().ToUint64());
+  ts_admin_proxy_->SplitTabletAsync(req, &resp_, &rpc_, BindRpcCallback());
+  VLOG(1) << "Send split tablet request to " << permanent_uuid()
+          << " (attempt " << attempt << "):\n"
+          << req.DebugString();
+  return true;
+}
+
 // ============================================================================
 //  Class CommonInfoForRaftTask.
 // ============================================================================
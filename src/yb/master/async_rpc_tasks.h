@@ -379,6 +379,37 @@ class AsyncTruncate : public RetryingTSRpcTask {
   tserver::TruncateResponsePB resp_;
 };
 
+// Asks the leader of the tablet to split it into the specified new tablets.
+class AsyncSplitTablet : public RetryingTSRpcTask {
+ public:
+  AsyncSplitTablet(Master* master,
+                   ThreadPool* callback_pool,
+                   const scoped_refptr<TabletInfo>& tablet,
+                   const std::string& new_tablet1_id,
+                   const std::string& new_tablet2_id,
+                   const std::string& split_partition_key);
+
+  Type type() const override { return ASYNC_SPLIT_TABLET; }
+
+  std::string type_name() const override { return "Split Tablet"; }
+
+  std::string description() const override;
+
+ private:
+  TabletId tablet_id() const override;
+
+  TabletServerId permanent_uuid() const;
+
+  void HandleResponse(int attempt) override;
+  bool SendRequest(int attempt) override;
+
+  scoped_refptr<TabletInfo> tablet_;
+  const std::string new_tablet1_id_;
+  const std::string new_tablet2_id_;
+  const std::string split_partition_key_;
+  tserver::SplitTabletResponsePB resp_;
+};
+
 class CommonInfoForRaftTask : public RetryingTSRpcTask {
  public:
   CommonInfoForRaftTask(
@@ -135,6 +135,9 @@ class TestLoadBalancerBase {
 
     PrepareTestState(ts_descs);
     TestLeaderOverReplication();
+
+    PrepareTestState(ts_descs);
+    TestReadOnlyLoadBalancing();
   }
 
  protected:
@@ -331,6 +334,49 @@ class TestLoadBalancerBase {
     TestRemoveLoad(tablets_[0]->tablet_id(), "");
   }
 
+  void TestReadOnlyLoadBalancing() {
+    LOG(INFO) << "Testing observers in read replica cluster";
+    SetupClusterConfig(/* multi_az = */ true);
+    auto* read_replicas = replication_info_.add_read_replicas();
+    read_replicas->set_placement_uuid("read");
+    read_replicas->set_num_replicas(1);
+    auto* pb = read_replicas->add_placement_blocks();
+    pb->mutable_cloud_info()->set_placement_cloud(default_cloud);
+    pb->mutable_cloud_info()->set_placement_region(default_region);
+    pb->mutable_cloud_info()->set_placement_zone("a");
+    pb->set_min_num_replicas(1);
+
+    // Read replica tablet servers in the same zone as ts0.
+    ts_descs_.push_back(SetupTS("3333", "a", "read"));
+    ts_descs_.push_back(SetupTS("4444", "a", "read"));
+
+    // Live cluster is fully replicated, tablet servers of read replica cluster don't receive
+    // voters.
+    ResetState();
+    AnalyzeTablets();
+    string placeholder;
+    ASSERT_FALSE(HandleAddReplicas(&placeholder, &placeholder, &placeholder));
+
+    // Every tablet gets an observer in the read replica cluster.
+    auto* options = cb_->state_->options_;
+    options->type = READ_ONLY;
+    options->placement_uuid = "read";
+    ResetState();
+    AnalyzeTablets();
+    std::set<TabletId> tablets_with_observers;
+    for (int i = 0; i < tablets_.size(); ++i) {
+      string tablet_id, to_ts;
+      ASSERT_TRUE(HandleAddReplicas(&tablet_id, &placeholder, &to_ts));
+      ASSERT_TRUE(to_ts == "3333" || to_ts == "4444") << to_ts;
+      ASSERT_TRUE(tablets_with_observers.insert(tablet_id).second) << tablet_id;
+    }
+    ASSERT_FALSE(HandleAddReplicas(&placeholder, &placeholder, &placeholder));
+    ASSERT_EQ(consensus::RaftPeerPB::PRE_OBSERVER, cb_->GetDefaultMemberType());
+
+    options->type = LIVE;
+    options->placement_uuid.clear();
+  }
+
   void TestWithMissingPlacement() {
     LOG(INFO) << "Testing with tablet servers missing placement information";
     // Setup cluster level placement to multiple AZs.
@@ -730,11 +776,13 @@ class TestLoadBalancerBase {
     }
   }
 
-  std::shared_ptr<TSDescriptor> SetupTS(const string& uuid, const string& az) {
+  std::shared_ptr<TSDescriptor> SetupTS(const string& uuid, const string& az,
+                                        const string& placement_uuid = "") {
     NodeInstancePB node;
     node.set_permanent_uuid(uuid);
 
     TSRegistrationPB reg;
+    reg.mutable_common()->set_placement_uuid(placement_uuid);
     // Fake host:port combo, with uuid as host, for ease of testing.
     auto hp = reg.mutable_common()->add_rpc_addresses();
     hp->set_host(uuid);
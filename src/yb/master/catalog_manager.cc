@@ -347,8 +347,9 @@ class TabletLoader : public Visitor<PersistentTabletInfo> {
         return STATUS(Corruption, "Missing table for tablet: ", tablet_id);
       }
 
-      // Add the tablet to the Table
-      if (!l->mutable_data()->is_deleted()) {
+      // Add the tablet to the Table. Tablets created by a split that is not completed yet do not
+      // serve their partitions.
+      if (!l->mutable_data()->is_deleted() && !metadata.has_split_parent_tablet_id()) {
         table->AddTablet(tablet);
       }
     }
@@ -612,9 +613,15 @@ void CatalogManagerBgTasks::Run() {
 
       TabletInfos to_delete;
       TabletInfos to_process;
+      TabletInfos splits_to_process;
 
       // Get list of tablets not yet running or already replaced.
-      catalog_manager_->ExtractTabletsToProcess(&to_delete, &to_process);
+      catalog_manager_->ExtractTabletsToProcess(&to_delete, &to_process, &splits_to_process);
+
+      for (const auto& tablet : splits_to_process) {
+        WARN_NOT_OK(catalog_manager_->ProcessPendingSplit(tablet),
+                    Format("Failed to process pending split of $0", tablet->tablet_id()));
+      }
 
       if (!to_process.empty()) {
         // Transition tablet assignment state from preparing to creating, send
@@ -2887,6 +2894,9 @@ Status CatalogManager::HandleReportedTablet(TSDescriptor* ts_desc,
   auto table_lock = tablet->table()->LockForRead();
   auto tablet_lock = tablet->LockForWrite();
 
+  // Set when the tablet created by a split becomes running.
+  TabletId split_parent_id;
+
   // If the TS is reporting a tablet which has been deleted, or a tablet from
   // a table which has been deleted, send it an RPC to delete it.
   // NOTE: when a table is deleted, we don't currently iterate over all of the
@@ -2943,6 +2953,18 @@ Status CatalogManager::HandleReportedTablet(TSDescriptor* ts_desc,
     DCHECK_EQ(report.state(), tablet::FAILED);
     LOG(WARNING) << "Tablet " << tablet->ToString() << " has failed on TS "
                  << ts_desc->permanent_uuid() << ": " << s.ToString();
+    // A failed replica does not report its config. Once the leader has evicted it, tombstone it,
+    // so the tablet server could get a new replica of this tablet via remote bootstrap.
+    // The CAS check is not used, since consensus of the failed replica is shut down.
+    const auto& committed_config = tablet_lock->data().pb.committed_consensus_state().config();
+    if (FLAGS_master_tombstone_evicted_tablet_replicas &&
+        tablet_lock->data().pb.has_committed_consensus_state() &&
+        !IsRaftConfigMember(ts_desc->permanent_uuid(), committed_config)) {
+      SendDeleteTabletRequest(report.tablet_id(), TABLET_DATA_TOMBSTONED, boost::none,
+                              tablet->table(), ts_desc,
+                              Substitute("Failed replica evicted from config with index $0",
+                                         committed_config.opid_index()));
+    }
     return Status::OK();
   }
 
@@ -2986,6 +3008,9 @@ Status CatalogManager::HandleReportedTablet(TSDescriptor* ts_desc,
       VLOG(1) << "Tablet " << tablet->ToString() << " is now online";
       tablet_lock->mutable_data()->set_state(SysTabletsEntryPB::RUNNING,
                                              "Tablet reported with an active leader");
+      if (tablet_lock->data().pb.has_split_parent_tablet_id()) {
+        split_parent_id = tablet_lock->data().pb.split_parent_tablet_id();
+      }
     }
 
     // The Master only accepts committed consensus configurations since it needs the committed index
@@ -3087,6 +3112,187 @@ Status CatalogManager::HandleReportedTablet(TSDescriptor* ts_desc,
     RETURN_NOT_OK(HandleTabletSchemaVersionReport(tablet.get(), report.schema_version()));
   }
 
+  if (!split_parent_id.empty()) {
+    RETURN_NOT_OK(MaybeCompleteTabletSplit(split_parent_id));
+  }
+
+  return Status::OK();
+}
+
+Status CatalogManager::ProcessTabletSplitCandidate(const TabletSplitCandidatePB& candidate) {
+  scoped_refptr<TabletInfo> tablet;
+  {
+    boost::shared_lock<LockType> l(lock_);
+    tablet = FindPtrOrNull(tablet_map_, candidate.tablet_id());
+  }
+  if (!tablet || !tablet->table()) {
+    return STATUS(NotFound, "Split candidate tablet not found", candidate.tablet_id());
+  }
+
+  auto table_lock = tablet->table()->LockForRead();
+  if (!table_lock->data().is_running()) {
+    return Status::OK();
+  }
+  auto tablet_lock = tablet->LockForWrite();
+  if (!tablet_lock->data().is_running()) {
+    return Status::OK();
+  }
+
+  const auto& pb = tablet_lock->data().pb;
+  if (pb.split_tablet_ids_size() != 0) {
+    // The split was already started, but the leader did not apply it yet, e.g. because the split
+    // request was lost during master failover. So resend it with the same new tablets.
+    return ResendSplitTabletRequest(tablet, pb);
+  }
+
+  // Intents of transactions are not moved to the new tablets, so tablets of transactional tables
+  // are not split.
+  if (table_lock->data().pb.schema().table_properties().is_transactional()) {
+    return STATUS_FORMAT(NotSupported, "Split of tablet $0 of transactional table $1 is not "
+                         "supported", tablet->tablet_id(), tablet->table()->name());
+  }
+
+  const auto& split_partition_key = candidate.split_partition_key();
+  const auto& partition = pb.partition();
+  if (split_partition_key <= partition.partition_key_start() ||
+      (!partition.partition_key_end().empty() &&
+       split_partition_key >= partition.partition_key_end())) {
+    return STATUS_FORMAT(InvalidArgument, "Split key $0 is not inside partition of tablet $1",
+                         Slice(split_partition_key).ToDebugHexString(), tablet->tablet_id());
+  }
+
+  PartitionPB partition1 = partition;
+  partition1.set_partition_key_end(split_partition_key);
+  PartitionPB partition2 = partition;
+  partition2.set_partition_key_start(split_partition_key);
+  vector<TabletInfo*> children = {
+      CreateTabletInfo(tablet->table().get(), partition1),
+      CreateTabletInfo(tablet->table().get(), partition2) };
+  for (auto* child : children) {
+    auto* child_pb = &child->mutable_metadata()->mutable_dirty()->pb;
+    child_pb->set_split_parent_tablet_id(tablet->tablet_id());
+    child->mutable_metadata()->mutable_dirty()->set_state(
+        SysTabletsEntryPB::CREATING, Substitute("Split from $0", tablet->tablet_id()));
+    tablet_lock->mutable_data()->pb.add_split_tablet_ids(child->tablet_id());
+  }
+
+  Status s = sys_catalog_->AddAndUpdateItems(children, vector<TabletInfo*>{tablet.get()});
+  if (!s.ok()) {
+    for (auto* child : children) {
+      child->mutable_metadata()->AbortMutation();
+      // The tablet is not referenced by anything else, so it is destroyed here.
+      scoped_refptr<TabletInfo> holder(child);
+    }
+    return s.CloneAndPrepend("An error occurred while inserting split tablets to sys-tablets");
+  }
+
+  {
+    std::lock_guard<LockType> l(lock_);
+    for (auto* child : children) {
+      tablet_map_[child->tablet_id()] = child;
+    }
+  }
+  for (auto* child : children) {
+    child->mutable_metadata()->CommitMutation();
+  }
+  tablet_lock->Commit();
+  table_lock->Unlock();
+
+  LOG(INFO) << "Splitting tablet " << tablet->ToString() << " into " << children[0]->tablet_id()
+            << " and " << children[1]->tablet_id() << " at "
+            << Slice(split_partition_key).ToDebugHexString() << ", SST files size: "
+            << candidate.sst_file_size() << ", ops/sec: " << candidate.ops_per_sec();
+  SendSplitTabletRequest(
+      tablet, children[0]->tablet_id(), children[1]->tablet_id(), split_partition_key);
+  return Status::OK();
+}
+
+Status CatalogManager::ResendSplitTabletRequest(const scoped_refptr<TabletInfo>& tablet,
+                                                const SysTabletsEntryPB& pb) {
+  scoped_refptr<TabletInfo> child;
+  {
+    boost::shared_lock<LockType> l(lock_);
+    child = FindPtrOrNull(tablet_map_, pb.split_tablet_ids(0));
+  }
+  if (!child || pb.split_tablet_ids_size() != 2) {
+    return STATUS_FORMAT(IllegalState, "Tablet $0 has unexpected split state: $1",
+                         tablet->tablet_id(), pb.ShortDebugString());
+  }
+  const auto split_partition_key =
+      child->LockForRead()->data().pb.partition().partition_key_end();
+  SendSplitTabletRequest(
+      tablet, pb.split_tablet_ids(0), pb.split_tablet_ids(1), split_partition_key);
+  return Status::OK();
+}
+
+Status CatalogManager::ProcessPendingSplit(const scoped_refptr<TabletInfo>& tablet) {
+  auto tablet_lock = tablet->LockForRead();
+  const auto& pb = tablet_lock->data().pb;
+  if (!tablet_lock->data().is_running() || pb.split_tablet_ids_size() == 0) {
+    return Status::OK();
+  }
+  LOG(INFO) << "Tablets split from " << tablet->ToString() << " were not created within "
+            << FLAGS_tablet_creation_timeout_ms << "ms, resending split request";
+  return ResendSplitTabletRequest(tablet, pb);
+}
+
+Status CatalogManager::MaybeCompleteTabletSplit(const TabletId& parent_id) {
+  scoped_refptr<TabletInfo> parent;
+  {
+    boost::shared_lock<LockType> l(lock_);
+    parent = FindPtrOrNull(tablet_map_, parent_id);
+  }
+  if (!parent || !parent->table()) {
+    return Status::OK();
+  }
+
+  auto parent_lock = parent->LockForWrite();
+  if (parent_lock->data().is_deleted()) {
+    return Status::OK();
+  }
+  vector<scoped_refptr<TabletInfo>> children;
+  {
+    boost::shared_lock<LockType> l(lock_);
+    for (const auto& child_id : parent_lock->data().pb.split_tablet_ids()) {
+      auto child = FindPtrOrNull(tablet_map_, child_id);
+      if (!child) {
+        return STATUS(IllegalState, "Split tablet not found", child_id);
+      }
+      children.push_back(child);
+    }
+  }
+
+  vector<std::unique_ptr<TabletInfo::lock_type>> child_locks;
+  for (const auto& child : children) {
+    child_locks.push_back(child->LockForWrite());
+    if (!child_locks.back()->data().is_running()) {
+      return Status::OK();
+    }
+  }
+
+  const string msg = Substitute("Split into $0 at $1",
+                                JoinStrings(parent_lock->data().pb.split_tablet_ids(), ", "),
+                                LocalTimeAsString());
+  parent_lock->mutable_data()->set_state(SysTabletsEntryPB::DELETED, msg);
+  vector<TabletInfo*> to_update = { parent.get() };
+  for (size_t i = 0; i != children.size(); ++i) {
+    child_locks[i]->mutable_data()->pb.clear_split_parent_tablet_id();
+    to_update.push_back(children[i].get());
+  }
+  RETURN_NOT_OK_PREPEND(sys_catalog_->UpdateItems(to_update),
+                        "An error occurred while updating split tablets in sys-tablets");
+
+  // The first new tablet has the same partition start, so replaces the split tablet.
+  for (const auto& child : children) {
+    parent->table()->AddTablet(child.get());
+  }
+  for (auto& lock : child_locks) {
+    lock->Commit();
+  }
+  parent_lock->Commit();
+
+  LOG(INFO) << "Completed split of tablet " << parent->ToString() << ": " << msg;
+  DeleteTabletReplicas(parent.get(), msg);
   return Status::OK();
 }
 
@@ -4088,6 +4294,16 @@ void CatalogManager::SendCopartitionTabletRequest(const scoped_refptr<TabletInfo
   WARN_NOT_OK(call->Run(), "Failed to send copartition table request");
 }
 
+void CatalogManager::SendSplitTabletRequest(const scoped_refptr<TabletInfo>& tablet,
+                                            const TabletId& new_tablet1_id,
+                                            const TabletId& new_tablet2_id,
+                                            const std::string& split_partition_key) {
+  auto call = std::make_shared<AsyncSplitTablet>(
+      master_, worker_pool_.get(), tablet, new_tablet1_id, new_tablet2_id, split_partition_key);
+  tablet->table()->AddTask(call);
+  WARN_NOT_OK(call->Run(), "Failed to send split tablet request");
+}
+
 void CatalogManager::DeleteTabletReplicas(
     const TabletInfo* tablet,
     const std::string& msg) {
@@ -4221,7 +4437,8 @@ void CatalogManager::GetPendingServerTasksUnlocked(const TableId &table_uuid,
 
 void CatalogManager::ExtractTabletsToProcess(
     TabletInfos *tablets_to_delete,
-    TabletInfos *tablets_to_process) {
+    TabletInfos *tablets_to_process,
+    TabletInfos *splits_to_process) {
   boost::shared_lock<LockType> l(lock_);
 
   // TODO: At the moment we loop through all the tablets
@@ -4252,6 +4469,26 @@ void CatalogManager::ExtractTabletsToProcess(
       continue;
     }
 
+    // Tablets created by a split are created by replicas of the split tablet, so they are not
+    // replaced on timeout. The split request is sent again instead.
+    const auto& split_parent_id = tablet_lock->data().pb.split_parent_tablet_id();
+    if (!split_parent_id.empty()) {
+      auto time_since_updated = MonoTime::Now().GetDeltaSince(tablet->last_update_time());
+      if (time_since_updated.ToMilliseconds() < FLAGS_tablet_creation_timeout_ms) {
+        continue;
+      }
+      tablet->set_last_update_time(MonoTime::Now());
+      auto parent = FindPtrOrNull(tablet_map_, split_parent_id);
+      auto same_parent = [&parent](const scoped_refptr<TabletInfo>& split) {
+        return split.get() == parent.get();
+      };
+      if (parent && std::none_of(
+              splits_to_process->begin(), splits_to_process->end(), same_parent)) {
+        splits_to_process->push_back(parent);
+      }
+      continue;
+    }
+
     // Tablets not yet assigned or with a report just received
     tablets_to_process->push_back(tablet);
   }
@@ -4518,12 +4755,19 @@ Status CatalogManager::SelectReplicasForTablet(const TSDescriptorVector& ts_desc
   }
 
   ReplicationInfoPB replication_info;
-  if (table_guard->data().pb.has_replication_info()) {
-    replication_info = table_guard->data().pb.replication_info();
-  } else {
+  {
     auto l = cluster_config_->LockForRead();
     replication_info = l->data().pb.replication_info();
   }
+  if (table_guard->data().pb.has_replication_info()) {
+    auto live_placement_uuid = replication_info.live_replicas().placement_uuid();
+    replication_info = table_guard->data().pb.replication_info();
+    // Table placement could be set without placement uuid, its voters still belong to the live
+    // cluster.
+    if (replication_info.live_replicas().placement_uuid().empty()) {
+      replication_info.mutable_live_replicas()->set_placement_uuid(live_placement_uuid);
+    }
+  }
 
   // Select the set of replicas for the tablet.
   ConsensusStatePB* cstate = tablet->mutable_metadata()->mutable_dirty()
@@ -4559,8 +4803,17 @@ Status CatalogManager::HandlePlacementUsingReplicationInfo(
     const ReplicationInfoPB& replication_info,
     const TSDescriptorVector& all_ts_descs,
     consensus::RaftConfigPB* config) {
+  // Voters are placed only on tablet servers of the live cluster. Observers on tablet servers of
+  // read replica clusters are added later by the load balancer.
+  const auto& live_placement_uuid = replication_info.live_replicas().placement_uuid();
+  TSDescriptorVector live_ts_descs;
+  for (const auto& ts_desc : all_ts_descs) {
+    if (ts_desc->placement_uuid() == live_placement_uuid) {
+      live_ts_descs.push_back(ts_desc);
+    }
+  }
   return HandlePlacementUsingPlacementInfo(replication_info.live_replicas(),
-                                           all_ts_descs, RaftPeerPB::VOTER, config);
+                                           live_ts_descs, RaftPeerPB::VOTER, config);
 }
 
 Status CatalogManager::HandlePlacementUsingPlacementInfo(const PlacementInfoPB& placement_info,
@@ -5155,6 +5408,34 @@ Status CatalogManager::GetClusterConfig(SysClusterConfigEntryPB* config) {
   return Status::OK();
 }
 
+void CatalogManager::GetTableQuotas(TableQuotasPB* quotas) {
+  DCHECK(cluster_config_) << "Missing cluster config for master!";
+  std::unordered_set<NamespaceId> namespaces;
+  {
+    auto l = cluster_config_->LockForRead();
+    for (const auto& quota : l->data().pb.quotas()) {
+      *quotas->add_quotas() = quota;
+      if (quota.has_namespace_id()) {
+        namespaces.insert(quota.namespace_id());
+      }
+    }
+  }
+  if (namespaces.empty()) {
+    return;
+  }
+
+  std::vector<scoped_refptr<TableInfo>> tables;
+  GetAllTables(&tables, true /* includeOnlyRunningTables */);
+  for (const auto& table : tables) {
+    auto namespace_id = table->namespace_id();
+    if (namespaces.count(namespace_id)) {
+      auto* table_namespace = quotas->add_table_namespaces();
+      table_namespace->set_table_id(table->id());
+      table_namespace->set_namespace_id(namespace_id);
+    }
+  }
+}
+
 Status CatalogManager::SetBlackList(const BlacklistPB& blacklist) {
   if (!blacklistState.tservers_.empty()) {
     LOG(WARNING) << Substitute("Overwriting $0 with new size $1 and initial load $2.",
@@ -5211,6 +5492,14 @@ Status CatalogManager::SetClusterConfig(
     }
   }
 
+  for (const auto& quota : config.quotas()) {
+    if (quota.has_table_id() == quota.has_namespace_id() ||
+        quota.ops_per_sec() < 0 || quota.bytes_per_sec() < 0) {
+      Status s = STATUS_FORMAT(InvalidArgument, "Invalid quota: $0", quota.ShortDebugString());
+      return SetupError(resp->mutable_error(), MasterErrorPB::INVALID_CLUSTER_CONFIG, s);
+    }
+  }
+
   l->mutable_data()->pb.CopyFrom(config);
   // Bump the config version, to indicate an update.
   l->mutable_data()->pb.set_version(config.version() + 1);
@@ -812,6 +812,10 @@ class CatalogManager : public tserver::TabletPeerLookupIf {
                                      TabletReportUpdatesPB *report_update,
                                      rpc::RpcContext* rpc);
 
+  // Starts the split of the tablet reported as a split candidate by its leader. The new tablets
+  // are added to the table when both of them are running.
+  CHECKED_STATUS ProcessTabletSplitCandidate(const TabletSplitCandidatePB& candidate);
+
   // Create a new Namespace with the specified attributes.
   //
   // The RPC context is provided for logging/tracing purposes,
@@ -1003,6 +1007,10 @@ class CatalogManager : public tserver::TabletPeerLookupIf {
   // must have updated the config in the meantime.
   CHECKED_STATUS GetClusterConfig(GetMasterClusterConfigResponsePB* resp);
   CHECKED_STATUS GetClusterConfig(SysClusterConfigEntryPB* config);
+
+  // Fills quotas of the cluster config, with namespaces of tables that belong to namespaces with
+  // quotas, to be sent to tablet servers.
+  void GetTableQuotas(TableQuotasPB* quotas);
   CHECKED_STATUS SetClusterConfig(
       const ChangeMasterClusterConfigRequestPB* req, ChangeMasterClusterConfigResponsePB* resp);
 
@@ -1192,8 +1200,15 @@ class CatalogManager : public tserver::TabletPeerLookupIf {
 
   // Extract the set of tablets that can be deleted and the set of tablets
   // that must be processed because not running yet.
+  // Also extracts the set of split tablets, whose new tablets were not created within
+  // tablet_creation_timeout_ms.
   void ExtractTabletsToProcess(TabletInfos *tablets_to_delete,
-                               TabletInfos *tablets_to_process);
+                               TabletInfos *tablets_to_process,
+                               TabletInfos *splits_to_process);
+
+  // Sends the split request of the tablet again, so its replicas create the new tablets that are
+  // still missing.
+  CHECKED_STATUS ProcessPendingSplit(const scoped_refptr<TabletInfo>& tablet);
 
   // Task that takes care of the tablet assignments/creations.
   // Loops through the "not created" tablets and sends a CreateTablet() request.
@@ -1265,6 +1280,19 @@ class CatalogManager : public tserver::TabletPeerLookupIf {
   void SendCopartitionTabletRequest(const scoped_refptr<TabletInfo>& tablet,
                                     const scoped_refptr<TableInfo>& table);
 
+  // Start the background task to send the SplitTablet() RPC to the leader for this tablet.
+  void SendSplitTabletRequest(const scoped_refptr<TabletInfo>& tablet,
+                              const TabletId& new_tablet1_id,
+                              const TabletId& new_tablet2_id,
+                              const std::string& split_partition_key);
+
+  // Sends the split request of the tablet with the new tablets recorded in its metadata pb.
+  CHECKED_STATUS ResendSplitTabletRequest(const scoped_refptr<TabletInfo>& tablet,
+                                          const SysTabletsEntryPB& pb);
+
+  // Replaces the split tablet with the tablets it was split into, when both of them are running.
+  CHECKED_STATUS MaybeCompleteTabletSplit(const TabletId& parent_id);
+
   // Send the "truncate table request" to all tablets of the specified table.
   void SendTruncateTableRequest(const scoped_refptr<TableInfo>& table);
 
@@ -72,6 +72,22 @@ using std::set;
 using std::vector;
 using strings::Substitute;
 
+namespace {
+
+// Returns placement of the read replica cluster with specified placement uuid, or nullptr if
+// there is no such read replica cluster.
+const PlacementInfoPB* FindReadReplicaPlacement(const ReplicationInfoPB& replication_info,
+                                                const std::string& placement_uuid) {
+  for (const auto& read_replica : replication_info.read_replicas()) {
+    if (read_replica.placement_uuid() == placement_uuid) {
+      return &read_replica;
+    }
+  }
+  return nullptr;
+}
+
+} // namespace
+
 bool ClusterLoadBalancer::UpdateTabletInfo(TabletInfo* tablet) {
   const auto& table_id = tablet->table()->id();
   // Set the placement information on a per-table basis, only once.
@@ -79,9 +95,24 @@ bool ClusterLoadBalancer::UpdateTabletInfo(TabletInfo* tablet) {
     PlacementInfoPB pb;
     {
       auto l = tablet->table()->LockForRead();
-      // If we have a custom per-table placement policy, use that.
-      if (l->data().pb.replication_info().has_live_replicas()) {
-        pb.CopyFrom(l->data().pb.replication_info().live_replicas());
+      const auto& replication_info = l->data().pb.replication_info();
+      if (state_->options_->type == READ_ONLY) {
+        // Observers are placed according to the read replica placement of the cluster being
+        // balanced, table could override it with its own read replica placement.
+        const auto* table_placement = FindReadReplicaPlacement(
+            replication_info, state_->options_->placement_uuid);
+        if (table_placement) {
+          pb.CopyFrom(*table_placement);
+        } else {
+          table_placement = FindReadReplicaPlacement(
+              GetClusterReplicationInfo(), state_->options_->placement_uuid);
+          if (table_placement) {
+            pb.CopyFrom(*table_placement);
+          }
+        }
+      } else if (replication_info.has_live_replicas()) {
+        // If we have a custom per-table placement policy, use that.
+        pb.CopyFrom(replication_info.live_replicas());
       } else {
         // Otherwise, default to cluster policy.
         pb.CopyFrom(GetClusterPlacementInfo());
@@ -176,8 +207,27 @@ void ClusterLoadBalancer::RunLoadBalancer(Options* options) {
   set_remaining(pending_remove_replica_tasks, &remaining_removals);
   set_remaining(pending_stepdown_leader_tasks, &remaining_leader_moves);
 
+  // Live replicas are balanced first, then observers of each read replica cluster are balanced
+  // among tablet servers of that cluster.
+  options->type = LIVE;
+  options->placement_uuid = GetClusterPlacementInfo().placement_uuid();
+  BalanceTables(options, &remaining_adds, &remaining_removals, &remaining_leader_moves);
+
+  const auto read_replicas = GetClusterReplicationInfo().read_replicas();
+  for (const auto& read_replica : read_replicas) {
+    options->type = READ_ONLY;
+    options->placement_uuid = read_replica.placement_uuid();
+    BalanceTables(options, &remaining_adds, &remaining_removals, &remaining_leader_moves);
+  }
+}
+
+void ClusterLoadBalancer::BalanceTables(Options* options, int* remaining_adds,
+                                        int* remaining_removals, int* remaining_leader_moves) {
   // Loop over all tables.
   for (const auto& table : GetTableMap()) {
+    if (*remaining_adds == 0 && *remaining_removals == 0 && *remaining_leader_moves == 0) {
+      break;
+    }
 
     if (SkipLoadBalancing(*table.second)) {
       continue;
@@ -198,31 +248,32 @@ void ClusterLoadBalancer::RunLoadBalancer(Options* options) {
     TabletServerId out_to_ts;
 
     // Handle adding and moving replicas.
-    for (int i = 0; i < remaining_adds; ++i) {
+    for (int i = 0; i < *remaining_adds; ++i) {
       if (!HandleAddReplicas(&out_tablet_id, &out_from_ts, &out_to_ts)) {
         break;
       }
-      --remaining_adds;
+      --*remaining_adds;
     }
 
     // Handle cleanup after over-replication.
-    for (int i = 0; i < remaining_removals; ++i) {
+    for (int i = 0; i < *remaining_removals; ++i) {
       if (!HandleRemoveReplicas(&out_tablet_id, &out_from_ts)) {
         break;
       }
-      --remaining_removals;
+      --*remaining_removals;
+    }
+
+    // Observers never become leaders.
+    if (options->type == READ_ONLY) {
+      continue;
     }
 
     // Handle tablet servers with too many leaders.
-    for (int i = 0; i < remaining_leader_moves; ++i) {
+    for (int i = 0; i < *remaining_leader_moves; ++i) {
       if (!HandleLeaderMoves(&out_tablet_id, &out_from_ts, &out_to_ts)) {
         break;
       }
-      --remaining_leader_moves;
-    }
-
-    if (remaining_adds == 0 && remaining_removals == 0 && remaining_leader_moves == 0) {
-      break;
+      --*remaining_leader_moves;
     }
   }
 }
@@ -241,7 +292,9 @@ bool ClusterLoadBalancer::AnalyzeTablets(const TableId& table_uuid) {
   TSDescriptorVector ts_descs;
   GetAllReportedDescriptors(&ts_descs);
   for (const auto ts_desc : ts_descs) {
-    state_->UpdateTabletServer(ts_desc);
+    if (state_->IsInBalancedCluster(*ts_desc)) {
+      state_->UpdateTabletServer(ts_desc);
+    }
   }
 
   vector<scoped_refptr<TabletInfo>> tablets;
@@ -811,6 +864,11 @@ const PlacementInfoPB& ClusterLoadBalancer::GetClusterPlacementInfo() const {
   return l->data().pb.replication_info().live_replicas();
 }
 
+const ReplicationInfoPB& ClusterLoadBalancer::GetClusterReplicationInfo() const {
+  auto l = catalog_manager_->cluster_config_->LockForRead();
+  return l->data().pb.replication_info();
+}
+
 const BlacklistPB& ClusterLoadBalancer::GetServerBlacklist() const {
   auto l = catalog_manager_->cluster_config_->LockForRead();
   return l->data().pb.server_blacklist();
@@ -877,6 +935,9 @@ void ClusterLoadBalancer::SendReplicaChanges(
 }
 
 consensus::RaftPeerPB::MemberType ClusterLoadBalancer::GetDefaultMemberType() {
+  if (state_->options_ && state_->options_->type == READ_ONLY) {
+    return consensus::RaftPeerPB::PRE_OBSERVER;
+  }
   return consensus::RaftPeerPB::PRE_VOTER;
 }
 
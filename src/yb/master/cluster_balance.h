@@ -106,6 +106,10 @@ class ClusterLoadBalancer {
   // Get the placement information from the cluster configuration.
   virtual const PlacementInfoPB& GetClusterPlacementInfo() const;
 
+  // Get the replication information, including read replica placements, from the cluster
+  // configuration.
+  virtual const ReplicationInfoPB& GetClusterReplicationInfo() const;
+
   // Get the blacklist information.
   virtual const BlacklistPB& GetServerBlacklist() const;
 
@@ -134,7 +138,8 @@ class ClusterLoadBalancer {
       scoped_refptr<TabletInfo> tablet, const TabletServerId& ts_uuid, const bool is_add,
       const bool should_remove_leader, const TabletServerId& new_leader_ts_uuid = "");
 
-  // Returns default member type for newly created replicas (PRE_VOTER).
+  // Returns default member type for newly created replicas: PRE_VOTER for live replicas and
+  // PRE_OBSERVER for read replicas.
   virtual consensus::RaftPeerPB::MemberType GetDefaultMemberType();
 
   //
@@ -144,6 +149,11 @@ class ClusterLoadBalancer {
   // Recreates the ClusterLoadState object.
   virtual void ResetState();
 
+  // Runs the load balancing algorithm for each table, for the replicas of type and cluster
+  // specified in options. Decrements remaining counters by the number of issued changes.
+  void BalanceTables(Options* options, int* remaining_adds, int* remaining_removals,
+                     int* remaining_leader_moves);
+
   // Goes over the tablet_map_ and the set of live TSDescriptors to compute the load distribution
   // across the tablets for the given table. Returns false if we encounter transient errors that
   // should stop the load balancing.
@@ -132,6 +132,14 @@ struct CBTabletServerMetadata {
   std::set<TabletId> leaders;
 };
 
+// Type of the replicas balanced by the current run of the load balancer.
+enum ReplicaType {
+  // Voting members of tablet Raft groups, placed on tablet servers of the live cluster.
+  LIVE,
+  // Observers, that don't vote, placed on tablet servers of a read replica cluster.
+  READ_ONLY,
+};
+
 struct Options {
   Options() {}
   virtual ~Options() {}
@@ -164,6 +172,13 @@ struct Options {
   // Max number of tablet leaders on tablet servers to move in any one run of the load balancer.
   int kMaxConcurrentLeaderMoves = FLAGS_load_balancer_max_concurrent_moves;
 
+  // Type of replicas to balance.
+  ReplicaType type = LIVE;
+
+  // Placement uuid of the cluster, whose tablet servers are balanced. Tablet servers and replicas
+  // of other clusters are ignored.
+  std::string placement_uuid;
+
   // TODO(bogdan): add state for leaders starting remote bootstraps, to limit on that end too.
 };
 
@@ -238,6 +253,15 @@ class ClusterLoadState {
     // Get replicas for this tablet.
     TabletInfo::ReplicaMap replica_map;
     GetReplicaLocations(tablet, &replica_map);
+    // Replicas in other clusters are balanced separately, so live replicas and observers don't
+    // affect each other.
+    for (auto it = replica_map.begin(); it != replica_map.end();) {
+      if (!IsInBalancedCluster(*it->second.ts_desc)) {
+        it = replica_map.erase(it);
+      } else {
+        ++it;
+      }
+    }
     // Set state information for both the tablet and the tablet server replicas.
     for (const auto& replica : replica_map) {
       const auto& ts_uuid = replica.first;
@@ -357,6 +381,11 @@ class ClusterLoadState {
     return true;
   }
 
+  // Whether the tablet server belongs to the cluster balanced by the current run.
+  bool IsInBalancedCluster(const TSDescriptor& ts_desc) const {
+    return !options_ || ts_desc.placement_uuid() == options_->placement_uuid;
+  }
+
   virtual void UpdateTabletServer(std::shared_ptr<TSDescriptor> ts_desc) {
     const auto& ts_uuid = ts_desc->permanent_uuid();
     // Set and get, so we can use this for both tablet servers we've added data to, as well as
@@ -644,7 +673,7 @@ class ClusterLoadState {
   MonoTime current_time_;
 
   // The knobs we use for tweaking the flow of the algorithm.
-  Options* options_;
+  Options* options_ = nullptr;
 
  private:
   DISALLOW_COPY_AND_ASSIGN(ClusterLoadState);
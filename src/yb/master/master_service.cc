@@ -168,6 +168,11 @@ void MasterServiceImpl::TSHeartbeat(const TSHeartbeatRequestPB* req,
     ts_desc->set_read_ops_per_sec(req->metrics().read_ops_per_sec());
   }
 
+  for (const auto& candidate : req->split_candidates()) {
+    WARN_NOT_OK(server_->catalog_manager()->ProcessTabletSplitCandidate(candidate),
+                Format("Failed to process split candidate $0", candidate.tablet_id()));
+  }
+
   if (req->has_tablet_report()) {
     s = server_->catalog_manager()->ProcessTabletReport(
       ts_desc.get(), req->tablet_report(), resp->mutable_tablet_report(), &rpc);
@@ -188,6 +193,14 @@ void MasterServiceImpl::TSHeartbeat(const TSHeartbeatRequestPB* req,
     desc->GetTSInformationPB(resp->add_tservers());
   }
 
+  // Quotas are sent in every heartbeat while there are any, so the server learns about new tables
+  // in namespaces with quotas. The empty list is sent to clear quotas the server still has.
+  TableQuotasPB quotas;
+  server_->catalog_manager()->GetTableQuotas(&quotas);
+  if (quotas.quotas_size() != 0 || req->has_quotas()) {
+    resp->mutable_table_quotas()->Swap(&quotas);
+  }
+
   rpc.RespondSuccess();
 }
 
@@ -24,6 +24,10 @@ tserver::TSTabletManager* MasterTabletServer::tablet_manager() {
   return nullptr;
 }
 
+tserver::QuotaManager* MasterTabletServer::quota_manager() {
+  return nullptr;
+}
+
 server::Clock* MasterTabletServer::Clock() {
   return nullptr;
 }
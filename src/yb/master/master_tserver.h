@@ -27,6 +27,7 @@ class MasterTabletServer : public tserver::TabletServerIf {
  public:
   explicit MasterTabletServer(scoped_refptr<MetricEntity> metric_entity);
   tserver::TSTabletManager* tablet_manager() override;
+  tserver::QuotaManager* quota_manager() override;
 
   server::Clock* Clock() override;
   const scoped_refptr<MetricEntity>& MetricEnt() const override;
@@ -110,6 +110,11 @@ std::string TSDescriptor::placement_id() const {
   return placement_id_;
 }
 
+std::string TSDescriptor::placement_uuid() const {
+  std::lock_guard<simple_spinlock> l(lock_);
+  return registration_.get() ? registration_->common().placement_uuid() : std::string();
+}
+
 void TSDescriptor::UpdateHeartbeatTime() {
   std::lock_guard<simple_spinlock> l(lock_);
   last_heartbeat_ = MonoTime::Now();
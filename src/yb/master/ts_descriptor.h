@@ -113,6 +113,10 @@ class TSDescriptor {
   // Return the pre-computed placement_id, comprised of the cloud_info data.
   std::string placement_id() const;
 
+  // Return the placement uuid of the cluster this tablet server belongs to. Tablet servers of
+  // read replica clusters host only observer replicas.
+  std::string placement_uuid() const;
+
   bool IsRunningOn(const HostPortPB& hp) const;
 
   void GetNodeInstancePB(NodeInstancePB* instance_pb) const;
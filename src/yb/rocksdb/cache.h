@@ -66,6 +66,15 @@ extern shared_ptr<Cache> NewLRUCache(size_t capacity, int num_shard_bits);
 extern shared_ptr<Cache> NewLRUCache(size_t capacity, int num_shard_bits,
                                      bool strict_capacity_limit);
 
+// Create a new cache with a fixed size capacity, that uses CLOCK eviction instead of LRU. Lookups
+// and releases do not take any locks, so this cache scales better than the LRU cache with the
+// number of concurrent readers. Each shard preallocates its hash table based on
+// estimated_entry_charge, the expected average charge of an entry. When entries turn out to be
+// smaller, the cache holds fewer entries than its capacity allows.
+extern shared_ptr<Cache> NewClockCache(size_t capacity, int num_shard_bits,
+                                       bool strict_capacity_limit,
+                                       size_t estimated_entry_charge);
+
 using QueryId = int64_t;
 // Query ids to represent values for the default query id.
 constexpr QueryId kDefaultQueryId = 0;
@@ -188,7 +197,8 @@ class Cache {
   virtual void ApplyToAllCacheEntries(void (*callback)(void*, size_t),
                                       bool thread_safe) = 0;
 
-  virtual void SetMetrics(const scoped_refptr<yb::MetricEntity>& entity) = 0;
+  // Registers the metrics of this cache in entity, with the prefix of the given tier.
+  virtual void SetMetrics(const scoped_refptr<yb::MetricEntity>& entity, yb::CacheTier tier) = 0;
 
  private:
   void LRU_Remove(Handle* e);
@@ -26,6 +26,7 @@
 
 #include <stdint.h>
 #include <stdio.h>
+#include <functional>
 #include <memory>
 #include <vector>
 #include <string>
@@ -41,6 +42,8 @@
 #include "yb/rocksdb/types.h"
 #include "yb/rocksdb/version.h"
 
+#include "yb/util/result.h"
+
 #ifdef _WIN32
 // Windows API macro interference
 #undef DeleteFile
@@ -97,6 +100,15 @@ class ColumnFamilyHandle {
 static const int kMajorVersion = __ROCKSDB_MAJOR__;
 static const int kMinorVersion = __ROCKSDB_MINOR__;
 
+// Options of DB::VerifyChecksum.
+struct VerifyChecksumOptions {
+  // Bytes read by verification are charged to this rate limiter, when it is specified.
+  RateLimiter* rate_limiter = nullptr;
+
+  // Verification is aborted, when this function is specified and returns true.
+  std::function<bool()> should_abort;
+};
+
 // A range of keys
 struct Range {
   Slice start;          // Included in the range
@@ -793,12 +805,33 @@ class DB {
     return result;
   }
 
+  // Returns approximate middle user key of the default column family, that could be used to split
+  // the DB into two parts of about the same size. Memtables are not taken into account.
+  virtual yb::Result<std::string> GetMiddleKey() {
+    return STATUS(NotSupported, "GetMiddleKey() not supported");
+  }
+
+  // Reads all blocks of live SST files of the default column family, verifying their checksums.
+  // Returns the error of the first file that failed verification, e.g. Corruption, prefixed by its
+  // name. bytes_verified, when specified, is increased by the number of verified bytes.
+  virtual CHECKED_STATUS VerifyChecksum(const VerifyChecksumOptions& options,
+                                        uint64_t* bytes_verified = nullptr) {
+    return STATUS(NotSupported, "VerifyChecksum() not supported");
+  }
+
   virtual UserFrontierPtr GetFlushedFrontier() { return nullptr; }
 
   virtual CHECKED_STATUS SetFlushedFrontier(UserFrontierPtr values) {
     return Status::OK();
   }
 
+  // Same as SetFlushedFrontier, but the new frontier could be lower than the current one. Used when
+  // files of this DB are reused by a DB with a different operation history, e.g. by a tablet
+  // created by splitting.
+  virtual CHECKED_STATUS ResetFlushedFrontier(UserFrontierPtr values) {
+    return Status::OK();
+  }
+
   // Obtains the meta data of the specified column family of the DB.
   // STATUS(NotFound, "") will be returned if the current DB does not have
   // any column family match the specified name.
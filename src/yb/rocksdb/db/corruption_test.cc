@@ -33,6 +33,7 @@
 
 #include "yb/rocksdb/cache.h"
 #include "yb/rocksdb/env.h"
+#include "yb/rocksdb/rate_limiter.h"
 #include "yb/rocksdb/table.h"
 #include "yb/rocksdb/write_batch.h"
 #include "yb/rocksdb/db/db_impl.h"
@@ -352,6 +353,30 @@ TEST_F(CorruptionTest, TableFile) {
   Check(99, 99);
 }
 
+TEST_F(CorruptionTest, VerifyChecksum) {
+  Build(100);
+  DBImpl* dbi = reinterpret_cast<DBImpl*>(db_);
+  dbi->TEST_FlushMemTable();
+
+  uint64_t bytes_verified = 0;
+  ASSERT_OK(db_->VerifyChecksum(VerifyChecksumOptions(), &bytes_verified));
+  ASSERT_GE(bytes_verified, 100U * kValueSize);
+
+  std::unique_ptr<RateLimiter> rate_limiter(NewGenericRateLimiter(10 * 1024 * 1024));
+  VerifyChecksumOptions options;
+  options.rate_limiter = rate_limiter.get();
+  ASSERT_OK(db_->VerifyChecksum(options));
+  ASSERT_EQ(bytes_verified, static_cast<uint64_t>(rate_limiter->GetTotalBytesThrough()));
+
+  options.should_abort = [] { return true; };
+  auto status = db_->VerifyChecksum(options);
+  ASSERT_TRUE(status.IsAborted()) << status;
+
+  Corrupt(kTableFile, 100, 1);
+  status = db_->VerifyChecksum(VerifyChecksumOptions());
+  ASSERT_TRUE(status.IsCorruption()) << status;
+}
+
 TEST_F(CorruptionTest, TableFileIndexData) {
   Options options;
   // very big, we'll trigger flushes manually
@@ -24,9 +24,14 @@
 #include <gflags/gflags.h>
 #include "yb/rocksdb/db/db_test_util.h"
 #include "yb/rocksdb/port/stack_trace.h"
+#include "yb/util/metrics.h"
 
 DECLARE_double(cache_single_touch_ratio);
 
+METRIC_DECLARE_entity(server);
+METRIC_DECLARE_counter(block_cache_hits);
+METRIC_DECLARE_counter(block_cache_compressed_hits);
+
 namespace rocksdb {
 
 class DBBlockCacheTest : public DBTestBase {
@@ -248,6 +253,54 @@ TEST_F(DBBlockCacheTest, TestWithCompressedBlockCache) {
   delete iter;
   iter = nullptr;
 }
+
+// Blocks evicted from the uncompressed block cache are still served from the compressed tier, and
+// each tier reports its hits under its own metrics.
+TEST_F(DBBlockCacheTest, TestCompressedBlockCacheHitAfterEviction) {
+  ReadOptions read_options;
+  auto table_options = GetTableOptions();
+  auto options = GetOptions(table_options);
+  options.compression = CompressionType::kSnappyCompression;
+  InitTable(options);
+
+  yb::MetricRegistry metric_registry;
+  auto entity = METRIC_ENTITY_server.Instantiate(&metric_registry, "test");
+  std::shared_ptr<Cache> cache = NewLRUCache(1 << 20, 0, false);
+  std::shared_ptr<Cache> compressed_cache = NewLRUCache(1 << 20, 0, false);
+  cache->SetMetrics(entity, yb::CacheTier::kUncompressed);
+  compressed_cache->SetMetrics(entity, yb::CacheTier::kCompressed);
+  table_options.block_cache = cache;
+  table_options.block_cache_compressed = compressed_cache;
+  options.table_factory.reset(new BlockBasedTableFactory(table_options));
+  Reopen(options);
+  RecordCacheCounters(options);
+
+  // Blocks are inserted into both tiers when they are read from disk.
+  for (size_t i = 0; i < kNumBlocks; i++) {
+    std::unique_ptr<Iterator> iter(db_->NewIterator(read_options));
+    iter->Seek(ToString(i));
+    ASSERT_OK(iter->status());
+    CheckCacheCounters(options, 1, 0, 1, 0);
+    CheckCompressedCacheCounters(options, 1, 0, 1, 0);
+  }
+
+  // Evict all blocks from the uncompressed tier.
+  cache->SetCapacity(0);
+  ASSERT_EQ(0, cache->GetUsage());
+  cache->SetCapacity(1 << 20);
+
+  for (size_t i = 0; i < kNumBlocks; i++) {
+    std::unique_ptr<Iterator> iter(db_->NewIterator(read_options));
+    iter->Seek(ToString(i));
+    ASSERT_OK(iter->status());
+    CheckCacheCounters(options, 1, 0, 1, 0);
+    CheckCompressedCacheCounters(options, 0, 1, 0, 0);
+  }
+
+  ASSERT_EQ(0, METRIC_block_cache_hits.Instantiate(entity)->value());
+  ASSERT_EQ(static_cast<int64_t>(kNumBlocks),
+            METRIC_block_cache_compressed_hits.Instantiate(entity)->value());
+}
 #endif
 
 }  // namespace rocksdb
@@ -35,8 +35,10 @@
 
 #include <algorithm>
 #include <climits>
+#include <condition_variable>
 #include <cstdio>
 #include <map>
+#include <mutex>
 #include <set>
 #include <stdexcept>
 #include <string>
@@ -83,6 +85,7 @@
 #include "yb/rocksdb/db.h"
 #include "yb/rocksdb/env.h"
 #include "yb/rocksdb/merge_operator.h"
+#include "yb/rocksdb/rate_limiter.h"
 #include "yb/rocksdb/sst_file_writer.h"
 #include "yb/rocksdb/statistics.h"
 #include "yb/rocksdb/status.h"
@@ -115,8 +118,11 @@
 #include "yb/rocksdb/util/thread_status_util.h"
 #include "yb/rocksdb/util/xfunc.h"
 
+#include "yb/gutil/sysinfo.h"
+
 #include "yb/util/debug-util.h"
 #include "yb/util/fault_injection.h"
+#include "yb/util/threadpool.h"
 
 DEFINE_bool(dump_dbimpl_info, false, "Dump RocksDB info during constructor.");
 DEFINE_bool(flush_rocksdb_on_shutdown, true,
@@ -1053,7 +1059,8 @@ Status DBImpl::Recover(
   }
 
   Status s = versions_->Recover(column_families, read_only);
-  if (db_options_.paranoid_checks && s.ok()) {
+  if (db_options_.paranoid_checks && !db_options_.skip_checking_sst_file_sizes_on_db_open &&
+      s.ok()) {
     s = CheckConsistency();
   }
   if (s.ok()) {
@@ -4373,6 +4380,109 @@ Status DBImpl::WriteWithCallback(const WriteOptions& write_options,
 }
 #endif  // ROCKSDB_LITE
 
+namespace {
+
+// State shared by the writing thread and memtable_insert_pool tasks while a write batch is
+// inserted in chunks. Pool tasks may start after the write has completed, so the state is
+// reference counted and a task touches the DB only after it has claimed a chunk.
+struct ChunkedInsertState {
+  std::vector<WriteBatch> chunks;
+  std::atomic<size_t> next_chunk{0};
+  std::atomic<size_t> pending_chunks{0};
+  std::mutex mutex;
+  std::condition_variable finished;
+  Status status;
+
+  // Claims and inserts chunks until none are left.
+  void Run(ColumnFamilySet* column_family_set, FlushScheduler* flush_scheduler,
+           bool ignore_missing_column_families) {
+    std::unique_ptr<ColumnFamilyMemTablesImpl> column_family_memtables;
+    for (;;) {
+      size_t index = next_chunk.fetch_add(1, std::memory_order_acq_rel);
+      if (index >= chunks.size()) {
+        return;
+      }
+      if (!column_family_memtables) {
+        column_family_memtables = std::make_unique<ColumnFamilyMemTablesImpl>(column_family_set);
+      }
+      Status s = WriteBatchInternal::InsertInto(
+          &chunks[index], column_family_memtables.get(), flush_scheduler,
+          ignore_missing_column_families, 0 /*log_number*/, nullptr /*db*/,
+          true /*dont_filter_deletes*/, true /*concurrent_memtable_writes*/);
+      std::lock_guard<std::mutex> lock(mutex);
+      if (!s.ok() && status.ok()) {
+        status = std::move(s);
+      }
+      if (--pending_chunks == 0) {
+        finished.notify_all();
+      }
+    }
+  }
+};
+
+} // namespace
+
+bool DBImpl::ShouldInsertInChunks(const autovector<WriteThread::Writer*>& write_group) const {
+  if (db_options_.memtable_insert_pool == nullptr ||
+      !db_options_.allow_concurrent_memtable_write) {
+    return false;
+  }
+  size_t total_count = 0;
+  for (auto* writer : write_group) {
+    if (writer->CallbackFailed()) {
+      continue;
+    }
+    if (writer->batch->HasMerge()) {
+      return false;
+    }
+    total_count += WriteBatchInternal::Count(writer->batch);
+  }
+  return total_count >= 2 * db_options_.memtable_insert_chunk_size;
+}
+
+Status DBImpl::InsertInChunks(const autovector<WriteThread::Writer*>& write_group,
+                              SequenceNumber sequence, bool ignore_missing_column_families) {
+  auto state = std::make_shared<ChunkedInsertState>();
+  // Sequence numbers of the whole group are already reserved, so each batch gets the same numbers
+  // it would get from a sequential insert, and the chunks of all batches are inserted together.
+  for (auto* writer : write_group) {
+    if (writer->CallbackFailed()) {
+      continue;
+    }
+    WriteBatchInternal::SetSequence(writer->batch, sequence);
+    sequence += WriteBatchInternal::Count(writer->batch);
+    RETURN_NOT_OK(WriteBatchInternal::Split(
+        writer->batch, db_options_.memtable_insert_chunk_size, &state->chunks));
+  }
+  if (state->chunks.empty()) {
+    return Status::OK();
+  }
+  state->pending_chunks = state->chunks.size();
+
+  // The memtable is switched only by the write group leader before insertion starts, so all chunks
+  // land in the same memtable.
+  auto* column_family_set = versions_->GetColumnFamilySet();
+  auto* flush_scheduler = &flush_scheduler_;
+  size_t helpers = std::min<size_t>(state->chunks.size() - 1, base::NumCPUs());
+  for (size_t i = 0; i != helpers; ++i) {
+    auto submit_status = db_options_.memtable_insert_pool->SubmitFunc(
+        [state, column_family_set, flush_scheduler, ignore_missing_column_families] {
+      state->Run(column_family_set, flush_scheduler, ignore_missing_column_families);
+    });
+    if (!submit_status.ok()) {
+      // Remaining chunks will be inserted by this thread.
+      break;
+    }
+  }
+  RecordTick(stats_, MEMTABLE_CHUNKED_INSERTS);
+
+  state->Run(column_family_set, flush_scheduler, ignore_missing_column_families);
+
+  std::unique_lock<std::mutex> lock(state->mutex);
+  state->finished.wait(lock, [&state] { return state->pending_chunks == 0; });
+  return state->status;
+}
+
 Status DBImpl::WriteImpl(const WriteOptions& write_options,
                          WriteBatch* my_batch, WriteCallback* callback) {
 
@@ -4717,7 +4827,16 @@ Status DBImpl::WriteImpl(const WriteOptions& write_options,
         }
       }
 
-      if (!parallel) {
+      if (ShouldInsertInChunks(write_group)) {
+        status = InsertInChunks(
+            write_group, current_sequence, write_options.ignore_missing_column_families);
+        if (!status.ok()) {
+          w.status = status;
+        } else {
+          // Set leader's status in case the write callback returned a non-ok status.
+          status = w.FinalStatus();
+        }
+      } else if (!parallel) {
         status = WriteBatchInternal::InsertInto(
             write_group, current_sequence, column_family_memtables_.get(),
             &flush_scheduler_, write_options.ignore_missing_column_families,
@@ -5216,6 +5335,13 @@ Status DBImpl::Import(const std::string& source_dir) {
   return ApplyVersionEdit(&edit);
 }
 
+Status DBImpl::ResetFlushedFrontier(UserFrontierPtr frontier) {
+  VersionEdit edit;
+  edit.SetFlushedFrontier(std::move(frontier));
+  edit.set_force_flushed_frontier(true);
+  return ApplyVersionEdit(&edit);
+}
+
 void DBImpl::TEST_SwitchMemtable() {
   std::lock_guard<InstrumentedMutex> lock(mutex_);
   WriteContext context;
@@ -5454,6 +5580,103 @@ void DBImpl::GetLiveFilesMetaData(std::vector<LiveFileMetaData>* metadata) {
   InstrumentedMutexLock l(&mutex_);
   versions_->GetLiveFilesMetaData(metadata);
 }
+
+yb::Result<std::string> DBImpl::GetMiddleKey() {
+  auto cfd = default_cf_handle_->cfd();
+  SuperVersion* sv = GetAndRefSuperVersion(cfd);
+  auto result = sv->current->GetMiddleKey();
+  ReturnAndCleanupSuperVersion(cfd, sv);
+  return result;
+}
+
+Status DBImpl::VerifyChecksum(const VerifyChecksumOptions& options, uint64_t* bytes_verified) {
+  auto cfd = default_cf_handle_->cfd();
+  std::vector<uint64_t> file_numbers;
+  {
+    SuperVersion* sv = GetAndRefSuperVersion(cfd);
+    auto* vstorage = sv->current->storage_info();
+    for (int level = 0; level < vstorage->num_non_empty_levels(); ++level) {
+      for (const auto* file : vstorage->LevelFiles(level)) {
+        file_numbers.push_back(file->fd.GetNumber());
+      }
+    }
+    ReturnAndCleanupSuperVersion(cfd, sv);
+  }
+
+  ReadOptions read_options;
+  read_options.verify_checksums = true;
+  read_options.fill_cache = false;
+  const int64_t burst =
+      options.rate_limiter ? std::max<int64_t>(options.rate_limiter->GetSingleBurstBytes(), 1) : 0;
+  int64_t unpaid_bytes = 0;
+  auto should_abort = [this, &options] {
+    return shutting_down_.load(std::memory_order_acquire) ||
+           (options.should_abort && options.should_abort());
+  };
+
+  // Files are verified one by one, each of them under its own super version, so the verification
+  // does not keep files removed by compactions for its whole duration.
+  for (auto file_number : file_numbers) {
+    if (should_abort()) {
+      return STATUS(Aborted, "Checksum verification aborted");
+    }
+
+    SuperVersion* sv = GetAndRefSuperVersion(cfd);
+    auto* vstorage = sv->current->storage_info();
+    const FileMetaData* meta = nullptr;
+    for (int level = 0; level < vstorage->num_non_empty_levels() && !meta; ++level) {
+      for (const auto* file : vstorage->LevelFiles(level)) {
+        if (file->fd.GetNumber() == file_number) {
+          meta = file;
+          break;
+        }
+      }
+    }
+    if (!meta) {
+      // File was removed by compaction after we collected the list.
+      ReturnAndCleanupSuperVersion(cfd, sv);
+      continue;
+    }
+
+    std::unique_ptr<InternalIterator> iter(cfd->table_cache()->NewIterator(
+        read_options, env_options_, cfd->internal_comparator(), meta->fd));
+    bool aborted = false;
+    for (iter->SeekToFirst(); iter->Valid() && !aborted; iter->Next()) {
+      const int64_t entry_bytes = iter->key().size() + iter->value().size();
+      if (bytes_verified) {
+        *bytes_verified += entry_bytes;
+      }
+      if (!options.rate_limiter) {
+        continue;
+      }
+      unpaid_bytes += entry_bytes;
+      while (unpaid_bytes >= burst) {
+        options.rate_limiter->Request(burst, Env::IO_LOW);
+        unpaid_bytes -= burst;
+        // Large file could take minutes to verify under the rate limit, so abort is also checked
+        // within the file.
+        aborted = should_abort();
+      }
+    }
+    auto status = iter->status();
+    const auto path_id = meta->fd.GetPathId();
+    iter.reset();
+    ReturnAndCleanupSuperVersion(cfd, sv);
+    if (aborted) {
+      return STATUS(Aborted, "Checksum verification aborted");
+    }
+    if (!status.ok()) {
+      return status.CloneAndPrepend(
+          "Checksum verification of " + TableFileName(db_options_.db_paths, file_number, path_id) +
+          " failed");
+    }
+  }
+  if (unpaid_bytes > 0) {
+    options.rate_limiter->Request(unpaid_bytes, Env::IO_LOW);
+  }
+  return Status::OK();
+}
+
 //DHQ: Tablet层的MaxPersistentOpId有调用
 UserFrontierPtr DBImpl::GetFlushedFrontier() { //DHQ: 获取已经Flush的，这个可能是外部调用需要的
   InstrumentedMutexLock l(&mutex_);
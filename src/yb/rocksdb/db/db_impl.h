@@ -211,10 +211,17 @@ class DBImpl : public DB {
 
   void GetLiveFilesMetaData(std::vector<LiveFileMetaData>* metadata) override;
 
+  yb::Result<std::string> GetMiddleKey() override;
+
+  CHECKED_STATUS VerifyChecksum(const VerifyChecksumOptions& options,
+                                uint64_t* bytes_verified) override;
+
   UserFrontierPtr GetFlushedFrontier() override;
 
   CHECKED_STATUS SetFlushedFrontier(UserFrontierPtr frontier) override;
 
+  CHECKED_STATUS ResetFlushedFrontier(UserFrontierPtr frontier) override;
+
   // Obtains the meta data of the specified column family of the DB.
   // STATUS(NotFound, "") will be returned if the current DB does not have
   // any column family match the specified name.
@@ -499,6 +506,16 @@ class DBImpl : public DB {
   Status WriteImpl(const WriteOptions& options, WriteBatch* updates,
                    WriteCallback* callback);
 
+  // Returns true if the batches of write_group should be inserted into the memtable by
+  // InsertInChunks, see DBOptions::memtable_insert_pool.
+  bool ShouldInsertInChunks(const autovector<WriteThread::Writer*>& write_group) const;
+
+  // Splits the batches of write_group into chunks that are inserted into the memtable concurrently
+  // by this thread and memtable_insert_pool. The first batch gets the given sequence number, and
+  // the following batches get the numbers after it.
+  Status InsertInChunks(const autovector<WriteThread::Writer*>& write_group,
+                        SequenceNumber sequence, bool ignore_missing_column_families);
+
  private:
   friend class DB;
   friend class InternalStats;
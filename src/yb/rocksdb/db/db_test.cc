@@ -88,6 +88,7 @@
 #include "yb/util/string_util.h"
 #include "yb/rocksdb/util/thread_status_util.h"
 #include "yb/rocksdb/util/xfunc.h"
+#include "yb/util/threadpool.h"
 #include "yb/util/tsan_util.h"
 
 namespace rocksdb {
@@ -5319,6 +5320,70 @@ TEST_F(DBTest, ConcurrentMemtableNotSupported) {
 
 #endif  // ROCKSDB_LITE
 
+// Writes large batches from several threads, so that write groups are inserted into the memtable in
+// chunks by memtable_insert_pool. Checks that every entry gets the sequence number it would get
+// from a sequential insert, and that a snapshot taken before the writes does not see them.
+TEST_F(DBTest, ChunkedMemtableInsert) {
+  std::unique_ptr<yb::ThreadPool> pool;
+  ASSERT_OK(yb::ThreadPoolBuilder("memtable-insert").set_max_threads(4).Build(&pool));
+
+  Options options = CurrentOptions();
+  options.create_if_missing = true;
+  options.allow_concurrent_memtable_write = true;
+  options.memtable_factory.reset(new SkipListFactory);
+  options.memtable_insert_pool = pool.get();
+  options.memtable_insert_chunk_size = 16;
+  options.statistics = rocksdb::CreateDBStatistics();
+  DestroyAndReopen(options);
+
+  ASSERT_OK(Put("shared", "old"));
+  const Snapshot* snapshot = db_->GetSnapshot();
+
+  constexpr int kThreads = 8;
+  constexpr int kBatches = 20;
+  constexpr int kBatchSize = 40;
+  std::vector<std::thread> threads;
+  for (int t = 0; t != kThreads; ++t) {
+    threads.emplace_back([this, t] {
+      const std::string thread_key = "thread" + ToString(t);
+      for (int b = 0; b != kBatches; ++b) {
+        // The same key is written at the start and at the end of the batch, so its entries land
+        // in different chunks, and the last one should win.
+        WriteBatch batch;
+        batch.Put(thread_key, "first");
+        for (int i = 0; i != kBatchSize; ++i) {
+          batch.Put(Key((t * kBatches + b) * kBatchSize + i), ToString(b));
+        }
+        batch.Put("shared", "new");
+        batch.Put(thread_key, ToString(b));
+        ASSERT_OK(db_->Write(WriteOptions(), &batch));
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  ASSERT_GT(TestGetTickerCount(options, MEMTABLE_CHUNKED_INSERTS), 0);
+  for (int t = 0; t != kThreads; ++t) {
+    ASSERT_EQ(ToString(kBatches - 1), Get("thread" + ToString(t)));
+    ASSERT_EQ("NOT_FOUND", Get("thread" + ToString(t), snapshot));
+    for (int b = 0; b != kBatches; ++b) {
+      for (int i = 0; i != kBatchSize; ++i) {
+        const auto key = Key((t * kBatches + b) * kBatchSize + i);
+        ASSERT_EQ(ToString(b), Get(key));
+        ASSERT_EQ("NOT_FOUND", Get(key, snapshot));
+      }
+    }
+  }
+  ASSERT_EQ("new", Get("shared"));
+  ASSERT_EQ("old", Get("shared", snapshot));
+
+  db_->ReleaseSnapshot(snapshot);
+  // The pool should outlive the DB.
+  Close();
+}
+
 TEST_F(DBTest, SanitizeNumThreads) {
   for (int attempt = 0; attempt < 2; attempt++) {
     const size_t kTotalTasks = 8;
@@ -72,6 +72,28 @@ TEST_F(DBTest2, IteratorPropertyVersionNumber) {
   delete iter2;
   delete iter3;
 }
+
+TEST_F(DBTest2, GetMiddleKey) {
+  Options options = CurrentOptions();
+  BlockBasedTableOptions table_options;
+  table_options.block_size = 256;
+  options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+  DestroyAndReopen(options);
+
+  // There are no SST files yet.
+  ASSERT_NOK(db_->GetMiddleKey());
+
+  constexpr int kNumKeys = 1000;
+  for (int i = 0; i != kNumKeys; ++i) {
+    ASSERT_OK(Put(Key(i), std::string(100, 'v')));
+  }
+  ASSERT_OK(Flush());
+
+  auto middle_key = db_->GetMiddleKey();
+  ASSERT_TRUE(middle_key.ok()) << middle_key.status();
+  ASSERT_GT(*middle_key, Key(kNumKeys * 2 / 5));
+  ASSERT_LT(*middle_key, Key(kNumKeys * 3 / 5));
+}
 }  // namespace rocksdb
 
 int main(int argc, char** argv) {
@@ -45,6 +45,7 @@
 #include "yb/rocksdb/util/dynamic_bloom.h"
 #include "yb/rocksdb/util/instrumented_mutex.h"
 #include "yb/rocksdb/util/mutable_cf_options.h"
+#include "yb/rocksdb/util/mutexlock.h"
 
 namespace rocksdb {
 
@@ -325,7 +326,9 @@ class MemTable {
 
   const MemTableOptions* GetMemTableOptions() const { return &moptions_; }
 
+  // Safe to call from concurrent inserters, see allow_concurrent_memtable_write.
   void UpdateFrontiers(const UserFrontiers& value) {//DHQ: 也有个frontiers
+    std::lock_guard<SpinMutex> lock(frontiers_mutex_);
     if (frontiers_) {
       frontiers_->Merge(value);
     } else {
@@ -384,6 +387,7 @@ class MemTable {
 
   Env* env_;
 
+  SpinMutex frontiers_mutex_;
   std::unique_ptr<UserFrontiers> frontiers_;
 
   // Returns a heuristic flush decision
@@ -460,6 +460,21 @@ size_t TableCache::GetMemoryUsageByTableReader(
   return ret;
 }
 
+yb::Result<std::string> TableCache::GetMiddleKey(
+    const EnvOptions& env_options,
+    const InternalKeyComparatorPtr& internal_comparator,
+    const FileDescriptor& fd) {
+  if (fd.table_reader) {
+    return fd.table_reader->GetMiddleKey();
+  }
+
+  Cache::Handle* table_handle = nullptr;
+  RETURN_NOT_OK(FindTable(env_options, internal_comparator, fd, &table_handle, kDefaultQueryId));
+  auto result = GetTableReaderFromHandle(table_handle)->GetMiddleKey();
+  ReleaseHandle(table_handle);
+  return result;
+}
+
 void TableCache::Evict(Cache* cache, uint64_t file_number) {
   cache->Erase(GetSliceForFileNumber(&file_number));
 }
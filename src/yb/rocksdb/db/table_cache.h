@@ -104,6 +104,11 @@ class TableCache {
              GetContext* get_context, HistogramImpl* file_read_hist = nullptr,
              bool skip_filters = false);
 
+  // Returns approximate middle key of the specified table.
+  yb::Result<std::string> GetMiddleKey(const EnvOptions& env_options,
+                                       const InternalKeyComparatorPtr& internal_comparator,
+                                       const FileDescriptor& fd);
+
   // Evict any entry for the specified file number
   static void Evict(Cache* cache, uint64_t file_number);
 
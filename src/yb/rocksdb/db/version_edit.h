@@ -159,6 +159,11 @@ class VersionEdit {
   void SetFlushedFrontier(UserFrontierPtr value) {
     flushed_frontier_ = std::move(value);
   }
+  // Allows flushed frontier of this edit to be lower than the current one. Not persisted, since
+  // recovery always takes the last flushed frontier from the manifest.
+  void set_force_flushed_frontier(bool value) {
+    force_flushed_frontier_ = value;
+  }
   void SetMaxColumnFamily(uint32_t max_column_family) {
     max_column_family_ = max_column_family;
   }
@@ -263,6 +268,7 @@ class VersionEdit {
   boost::optional<uint32_t> max_column_family_;
   boost::optional<SequenceNumber> last_sequence_;
   UserFrontierPtr flushed_frontier_;
+  bool force_flushed_frontier_ = false;
 
   DeletedFileSet deleted_files_;
   std::vector<std::pair<int, FileMetaData>> new_files_;
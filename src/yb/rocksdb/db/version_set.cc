@@ -717,6 +717,25 @@ size_t Version::GetMemoryUsageByTableReaders() {
   return total_usage;
 }
 
+yb::Result<std::string> Version::GetMiddleKey() {
+  // Largest file contains most of the data, so its middle key is a good approximation of the
+  // middle key of the whole version.
+  const FdWithBoundaries* largest = nullptr;
+  for (auto& file_level : storage_info_.level_files_brief_) {
+    for (size_t i = 0; i < file_level.num_files; i++) {
+      const auto& file = file_level.files[i];
+      if (!largest || file.fd.GetTotalFileSize() > largest->fd.GetTotalFileSize()) {
+        largest = &file;
+      }
+    }
+  }
+  if (!largest) {
+    return STATUS(Incomplete, "No SST files");
+  }
+  return cfd_->table_cache()->GetMiddleKey(
+      vset_->env_options_, cfd_->internal_comparator(), largest->fd);
+}
+
 void Version::GetColumnFamilyMetaData(ColumnFamilyMetaData* cf_meta) {
   assert(cf_meta);
   assert(cfd_);
@@ -2344,7 +2363,11 @@ Status VersionSet::LogAndApply(ColumnFamilyData* column_family_data,
     manifest_file_size_ = new_manifest_file_size;
     prev_log_number_ = edit->prev_log_number_.get_value_or(0);
     if (edit->flushed_frontier_) {
-      SetFlushedFrontier(edit->flushed_frontier_);
+      if (edit->force_flushed_frontier_) {
+        SetFlushedFrontierNoSanityChecking(edit->flushed_frontier_);
+      } else {
+        SetFlushedFrontier(edit->flushed_frontier_);
+      }
     }
   } else {
     RLOG(InfoLogLevel::ERROR_LEVEL, db_options_->info_log,
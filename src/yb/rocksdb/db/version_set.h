@@ -514,6 +514,9 @@ class Version {
 
   size_t GetMemoryUsageByTableReaders();
 
+  // Returns approximate middle key of the largest SST file of this version.
+  yb::Result<std::string> GetMiddleKey();
+
   ColumnFamilyData* cfd() const { return cfd_; }
 
   // Return the next Version in the linked list. Used for debug only
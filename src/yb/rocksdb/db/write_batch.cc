@@ -893,6 +893,55 @@ void WriteBatchInternal::SetContents(WriteBatch* b, const Slice& contents) {
   b->content_flags_.store(ContentFlags::DEFERRED, std::memory_order_relaxed);
 }
 
+Status WriteBatchInternal::Split(
+    const WriteBatch* batch, size_t max_entries, std::vector<WriteBatch>* out) {
+  DCHECK_GT(max_entries, 0);
+  Slice input(batch->rep_);
+  if (input.size() < kHeader) {
+    return STATUS(Corruption, "malformed WriteBatch (too small)");
+  }
+  input.remove_prefix(kHeader);
+
+  const uint32_t total_entries = Count(batch);
+  out->reserve(out->size() + (total_entries + max_entries - 1) / max_entries);
+
+  SequenceNumber sequence = Sequence(batch);
+  const char* chunk_start = input.cdata();
+  size_t chunk_entries = 0;
+  auto flush_chunk = [&]() {
+    out->emplace_back();
+    WriteBatch& chunk = out->back();
+    chunk.rep_.append(chunk_start, input.cdata() - chunk_start);
+    chunk.content_flags_.store(ContentFlags::DEFERRED, std::memory_order_relaxed);
+    SetCount(&chunk, static_cast<uint32_t>(chunk_entries));
+    SetSequence(&chunk, sequence);
+    if (out->size() == 1) {
+      chunk.SetFrontiers(batch->Frontiers());
+    }
+    sequence += chunk_entries;
+    chunk_start = input.cdata();
+    chunk_entries = 0;
+  };
+
+  Slice key, value, blob;
+  while (!input.empty()) {
+    char tag = 0;
+    uint32_t column_family = 0;
+    RETURN_NOT_OK(ReadRecordFromWriteBatch(
+        &input, &tag, &column_family, &key, &value, &blob));
+    if (tag != kTypeLogData) {
+      ++chunk_entries;
+    }
+    if (chunk_entries == max_entries) {
+      flush_chunk();
+    }
+  }
+  if (chunk_entries != 0 || input.cdata() != chunk_start) {
+    flush_chunk();
+  }
+  return Status::OK();
+}
+
 void WriteBatchInternal::Append(WriteBatch* dst, const WriteBatch* src) {
   SetCount(dst, Count(dst) + Count(src));
   DCHECK_GE(src->rep_.size(), kHeader);
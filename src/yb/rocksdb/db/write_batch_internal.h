@@ -132,6 +132,13 @@ class WriteBatchInternal {
 
   static void SetContents(WriteBatch* batch, const Slice& contents);
 
+  // Splits entries of batch into consecutive batches of at most max_entries entries each.
+  // Every resulting batch gets the sequence number that its first entry has in the source batch,
+  // so inserting all of them yields the same memtable contents as inserting the source batch.
+  // Frontiers of the source batch are attached to the first resulting batch.
+  static CHECKED_STATUS Split(
+      const WriteBatch* batch, size_t max_entries, std::vector<WriteBatch>* out);
+
   // Inserts batches[i] into memtable, for i in 0..num_batches-1 inclusive.
   //
   // If dont_filter_deletes is false AND options.filter_deletes is true
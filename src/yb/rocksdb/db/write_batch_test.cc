@@ -184,6 +184,34 @@ TEST_F(WriteBatchTest, Append) {
   ASSERT_EQ(4, b1.Count());
 }
 
+TEST_F(WriteBatchTest, Split) {
+  WriteBatch batch;
+  WriteBatchInternal::SetSequence(&batch, 100);
+  batch.Put("a", "va");
+  batch.Delete("b");
+  batch.PutLogData("blob");
+  batch.Put("c", "vc");
+  batch.SingleDelete("d");
+  batch.Put("e", "ve");
+
+  std::vector<WriteBatch> chunks;
+  ASSERT_OK(WriteBatchInternal::Split(&batch, 2, &chunks));
+  ASSERT_EQ(3U, chunks.size());
+  ASSERT_EQ("Put(a, va)@100"
+            "Delete(b)@101",
+            PrintContents(&chunks[0]));
+  ASSERT_EQ("Put(c, vc)@102"
+            "SingleDelete(d)@103",
+            PrintContents(&chunks[1]));
+  ASSERT_EQ("Put(e, ve)@104",
+            PrintContents(&chunks[2]));
+
+  chunks.clear();
+  ASSERT_OK(WriteBatchInternal::Split(&batch, 5, &chunks));
+  ASSERT_EQ(1U, chunks.size());
+  ASSERT_EQ(PrintContents(&batch), PrintContents(&chunks[0]));
+}
+
 TEST_F(WriteBatchTest, SingleDeletion) {
   WriteBatch batch;
   WriteBatchInternal::SetSequence(&batch, 100);
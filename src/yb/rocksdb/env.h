@@ -487,6 +487,13 @@ class RandomAccessFile : public File {
 
   virtual void Hint(AccessPattern pattern) {}
 
+  // Asks the system to asynchronously load the range [offset, offset + n) of this file, so that
+  // subsequent reads of this range do not block on disk. Does not wait for the data to be read.
+  // If the system does not support it, then this is a noop.
+  virtual Status Readahead(uint64_t offset, size_t n) {
+    return Status::OK();
+  }
+
   // Remove any kind of caching of data from the offset to offset+length
   // of this file. If the length is 0, then it refers to the end of file.
   // If the system is not caching the file contents, then this is a noop.
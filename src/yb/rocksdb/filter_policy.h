@@ -148,6 +148,10 @@ class FilterPolicy {
 
     // Transform a key.
     virtual Slice Transform(Slice key) const = 0;
+
+    // Returns true if the transformed key also covers range key components (see
+    // DocDbAwareFilterPolicy), used to break down bloom filter statistics per filter key type.
+    virtual bool IsRangePrefixKey(Slice filter_key) const { return false; }
   };
 
   // Filter policy can optionally return key transformer to be used before writing key to filter or
@@ -43,6 +43,12 @@
 #undef max
 #endif
 
+namespace yb {
+
+class ThreadPool;
+
+} // namespace yb
+
 namespace rocksdb {
 
 class BoundaryValuesExtractor;
@@ -1278,6 +1284,14 @@ struct DBOptions {
   // Default: false
   bool skip_stats_update_on_db_open;
 
+  // If true, then DB::Open() will not check that sizes of SST files match the sizes recorded in
+  // the MANIFEST, even when paranoid_checks is set. This check stats every SST file, so skipping
+  // it improves DBOpen time for DBs with many files. Missing or truncated files are still
+  // detected when they are opened.
+  //
+  // Default: false
+  bool skip_checking_sst_file_sizes_on_db_open;
+
   // Recovery mode to control the consistency while replaying WAL
   // Default: kTolerateCorruptedTailRecords
   WALRecoveryMode wal_recovery_mode;
@@ -1316,6 +1330,18 @@ struct DBOptions {
 
   // Invoked after memtable switched.
   std::shared_ptr<std::function<MemTableFilter()>> mem_table_flush_filter_factory;
+
+  // Pool used to insert large write groups into the memtable from several threads. When set
+  // together with allow_concurrent_memtable_write, and the batches of a write group have no merges
+  // and at least 2 * memtable_insert_chunk_size entries in total, each batch is split into chunks
+  // of consecutive entries, and the chunks are inserted concurrently by the group leader and the
+  // pool threads. The writes return only after all chunks are inserted, so readers never observe a
+  // partially applied batch.
+  // The pool is not owned by the DB and must outlive it.
+  yb::ThreadPool* memtable_insert_pool = nullptr;
+
+  // Number of write batch entries inserted by one task of memtable_insert_pool.
+  uint64_t memtable_insert_chunk_size = 4096;
 };
 
 // Options to control the behavior of a database (passed to DB::Open)
@@ -1475,6 +1501,11 @@ struct ReadOptions {
   // Query id designated for the read.
   QueryId query_id = kDefaultQueryId;
 
+  // Upper bound on the adaptive readahead window of iterators created with these options. The
+  // effective bound is the minimum of this value and
+  // BlockBasedTableOptions::max_auto_readahead_size. 0 disables adaptive readahead for the read.
+  size_t max_auto_readahead_size = std::numeric_limits<size_t>::max();
+
   // Filter for pruning SST files. RocksDB user can provide its own implementation to exclude SST
   // files from being added to MergeIterator. By default doesn't filter files.
   std::shared_ptr<TableAwareReadFileFilter> table_aware_file_filter;
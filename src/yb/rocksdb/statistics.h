@@ -205,6 +205,18 @@ enum Tickers : uint32_t {
   BLOCK_CACHE_MULTI_TOUCH_BYTES_READ,
   BLOCK_CACHE_MULTI_TOUCH_BYTES_WRITE,
 
+  // Number of adaptive readahead requests issued by table iterators and total bytes requested.
+  BLOCK_READAHEAD_REQUESTS,
+  BLOCK_READAHEAD_BYTES,
+
+  // Number of write batches inserted into the memtable in chunks by several threads.
+  MEMTABLE_CHUNKED_INSERTS,
+
+  // Subsets of BLOOM_FILTER_CHECKED and BLOOM_FILTER_USEFUL for filter keys covering range
+  // components in addition to hashed components.
+  BLOOM_FILTER_RANGE_PREFIX_CHECKED,
+  BLOOM_FILTER_RANGE_PREFIX_USEFUL,
+
   // End of ticker enum.
   TICKER_ENUM_MAX,
 };
@@ -298,7 +310,12 @@ const std::vector<std::pair<Tickers, std::string>> TickersNameMap = {
     {BLOCK_CACHE_MULTI_TOUCH_HIT, "rocksdb_block_cache_multi_touch_hit"},
     {BLOCK_CACHE_MULTI_TOUCH_ADD, "rocksdb_block_cache_multi_touch_add"},
     {BLOCK_CACHE_MULTI_TOUCH_BYTES_READ, "rocksdb_block_cache_multi_touch_bytes_read"},
-    {BLOCK_CACHE_MULTI_TOUCH_BYTES_WRITE, "rocksdb_block_cache_multi_touch_bytes_write"}
+    {BLOCK_CACHE_MULTI_TOUCH_BYTES_WRITE, "rocksdb_block_cache_multi_touch_bytes_write"},
+    {BLOCK_READAHEAD_REQUESTS, "rocksdb_block_readahead_requests"},
+    {BLOCK_READAHEAD_BYTES, "rocksdb_block_readahead_bytes"},
+    {MEMTABLE_CHUNKED_INSERTS, "rocksdb_memtable_chunked_inserts"},
+    {BLOOM_FILTER_RANGE_PREFIX_CHECKED, "rocksdb_bloom_filter_range_prefix_checked"},
+    {BLOOM_FILTER_RANGE_PREFIX_USEFUL, "rocksdb_bloom_filter_range_prefix_useful"}
 };
 
 /**
@@ -37,6 +37,7 @@
 #include <unordered_map>
 
 #include "yb/rocksdb/env.h"
+#include "yb/rocksdb/filter_policy.h"
 #include "yb/rocksdb/iterator.h"
 #include "yb/rocksdb/options.h"
 #include "yb/rocksdb/immutable_options.h"
@@ -157,6 +158,29 @@ struct BlockBasedTableOptions {
   // used to avoid too many index levels in case we have large keys.
   size_t min_keys_per_index_block = 64;
 
+  // Adaptive readahead for table iterators. Once an iterator has read a couple of consecutive data
+  // blocks, the table reader asks the file to prefetch the next initial_auto_readahead_size bytes
+  // in background. Each time the iterator reaches the end of the prefetched range, the window is
+  // doubled, up to max_auto_readahead_size. Any non-sequential block access resets the window.
+  // Set max_auto_readahead_size to 0 to disable adaptive readahead.
+  size_t initial_auto_readahead_size = 8_KB;
+  size_t max_auto_readahead_size = 256_KB;
+
+  // Append a hash index to data blocks, that maps user keys to restart intervals. Seeks that hit
+  // a user key present in the block then skip the binary search over restart points.
+  // Blocks with more than 253 restart intervals are written without hash index.
+  bool use_data_block_hash_index = false;
+
+  // Ratio of indexed user keys to hash buckets in data block hash index. Lower values use more
+  // space and produce fewer collisions.
+  double data_block_hash_table_util_ratio = 0.75;
+
+  // Transformation applied to user keys before they are hashed by data block hash index, e.g. to
+  // strip a version suffix, so that seek targets with a different suffix also hit the index. The
+  // transformed key should be a prefix of the user key. It only affects how often the index is
+  // hit, seek results are the same with any transformation. Should outlive the table factory.
+  const FilterPolicy::KeyTransformer* data_block_hash_index_key_transformer = nullptr;
+
   // Use delta encoding to compress keys in blocks.
   // Iterator::PinData() requires this option to be disabled.
   //
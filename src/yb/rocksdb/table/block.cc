@@ -96,9 +96,11 @@ void BlockIter::Prev() {
   } while (ParseNextKey() && NextEntryOffset() < original);
 }
 
-void BlockIter::Initialize(const Comparator* comparator, const char* data,
-                           uint32_t restarts, uint32_t num_restarts, BlockHashIndex* hash_index,
-                           BlockPrefixIndex* prefix_index) {
+void BlockIter::Initialize(
+    const Comparator* comparator, const char* data, uint32_t restarts, uint32_t num_restarts,
+    BlockHashIndex* hash_index, BlockPrefixIndex* prefix_index,
+    const DataBlockHashIndex* data_block_hash_index,
+    const FilterPolicy::KeyTransformer* data_block_hash_index_key_transformer) {
   DCHECK(data_ == nullptr); // Ensure it is called only once
   DCHECK_GT(num_restarts, 0); // Ensure the param is valid
 
@@ -110,6 +112,8 @@ void BlockIter::Initialize(const Comparator* comparator, const char* data,
   restart_index_ = num_restarts_;
   hash_index_ = hash_index;
   prefix_index_ = prefix_index;
+  data_block_hash_index_ = data_block_hash_index;
+  data_block_hash_index_key_transformer_ = data_block_hash_index_key_transformer;
 }
 
 
@@ -118,6 +122,9 @@ void BlockIter::Seek(const Slice& target) {
   if (data_ == nullptr) {  // Not init yet
     return;
   }
+  if (data_block_hash_index_ && DataBlockHashSeek(target)) {
+    return;
+  }
   uint32_t index = 0;
   bool ok = false;
   if (prefix_index_) {
@@ -319,6 +326,52 @@ bool BlockIter::HashSeek(const Slice& target, uint32_t* index) {
   return BinarySeek(target, left, right, index);
 }
 
+bool BlockIter::DataBlockHashSeek(const Slice& target) {
+  if (target.size() < 8) {
+    return false;
+  }
+  const Slice target_hash_key = DataBlockHashKey(target, data_block_hash_index_key_transformer_);
+  const uint8_t bucket = data_block_hash_index_->Lookup(target_hash_key);
+  if (bucket == kNoEntry || bucket == kCollision || bucket >= num_restarts_) {
+    return false;
+  }
+
+  // The bucket points to the restart interval with the first entry of some user key with the same
+  // hash. The entry found by linear search is only trusted when the search passed an entry less
+  // than target before it, so it is the same entry as binary search would find, whatever entries
+  // the bucket actually points to.
+  uint32_t restart_index = bucket;
+  SeekToRestartPoint(restart_index);
+  if (!ParseNextKey()) {
+    return false;
+  }
+  if (Compare(key_.GetKey(), target) >= 0) {
+    if (restart_index == 0) {
+      return true;
+    }
+    // Target is before the first indexed entry, e.g. it is a newer version of the same user key,
+    // so it could belong to the previous restart interval.
+    SeekToRestartPoint(--restart_index);
+    if (!ParseNextKey() || Compare(key_.GetKey(), target) >= 0) {
+      return false;
+    }
+  }
+
+  const uint32_t limit = bucket + 1 < num_restarts_ ? GetRestartPoint(bucket + 1) : restarts_;
+  while (ParseNextKey()) {
+    if (Compare(key_.GetKey(), target) >= 0) {
+      return true;
+    }
+    // Don't scan past the indexed interval, unless still inside the entries of target user key.
+    if (current_ >= limit &&
+        DataBlockHashKey(key_.GetKey(), data_block_hash_index_key_transformer_) !=
+            target_hash_key) {
+      return false;
+    }
+  }
+  return false;
+}
+
 bool BlockIter::PrefixSeek(const Slice& target, uint32_t* index) {
   assert(prefix_index_);
   uint32_t* block_ids = nullptr;
@@ -333,29 +386,41 @@ bool BlockIter::PrefixSeek(const Slice& target, uint32_t* index) {
 }
 
 uint32_t Block::NumRestarts() const {
-  assert(size_ >= 2*sizeof(uint32_t));
-  return DecodeFixed32(data_ + size_ - sizeof(uint32_t));
+  return num_restarts_;
 }
 
 Block::Block(BlockContents&& contents)
     : contents_(std::move(contents)),
       data_(contents_.data.cdata()),
-      size_(contents_.data.size()) {
+      size_(contents_.data.size()),
+      restart_offset_(0),
+      num_restarts_(0) {
   if (size_ < sizeof(uint32_t)) {
     size_ = 0;  // Error marker
-  } else {
-    restart_offset_ =
-        static_cast<uint32_t>(size_) - (1 + NumRestarts()) * sizeof(uint32_t);
-    if (restart_offset_ > size_ - sizeof(uint32_t)) {
-      // The size is too small for NumRestarts() and therefore
-      // restart_offset_ wrapped around.
+    return;
+  }
+  const uint32_t packed_num_restarts = DecodeFixed32(data_ + size_ - sizeof(uint32_t));
+  size_t restarts_end = size_ - sizeof(uint32_t);
+  if (packed_num_restarts & kDataBlockHashIndexFlag) {
+    const size_t hash_index_size = data_block_hash_index_.Initialize(data_, restarts_end);
+    if (hash_index_size == 0) {
       size_ = 0;
+      return;
     }
+    restarts_end -= hash_index_size;
   }
+  num_restarts_ = packed_num_restarts & ~kDataBlockHashIndexFlag;
+  if (num_restarts_ > restarts_end / sizeof(uint32_t)) {
+    // The size is too small for NumRestarts().
+    size_ = 0;
+    return;
+  }
+  restart_offset_ = static_cast<uint32_t>(restarts_end - num_restarts_ * sizeof(uint32_t));
 }
 
-InternalIterator* Block::NewIterator(const Comparator* cmp, BlockIter* iter,
-                                     bool total_order_seek) {
+InternalIterator* Block::NewIterator(
+    const Comparator* cmp, BlockIter* iter, bool total_order_seek,
+    const FilterPolicy::KeyTransformer* data_block_hash_index_key_transformer) {
   if (size_ < 2*sizeof(uint32_t)) {
     if (iter != nullptr) {
       iter->SetStatus(STATUS(Corruption, "bad block contents"));
@@ -378,12 +443,17 @@ InternalIterator* Block::NewIterator(const Comparator* cmp, BlockIter* iter,
     BlockPrefixIndex* prefix_index_ptr =
         total_order_seek ? nullptr : prefix_index_.get();
 
+    const DataBlockHashIndex* data_block_hash_index_ptr =
+        data_block_hash_index_.Valid() ? &data_block_hash_index_ : nullptr;
+
     if (iter != nullptr) {
       iter->Initialize(cmp, data_, restart_offset_, num_restarts,
-                    hash_index_ptr, prefix_index_ptr);
+                    hash_index_ptr, prefix_index_ptr, data_block_hash_index_ptr,
+                    data_block_hash_index_key_transformer);
     } else {
       iter = new BlockIter(cmp, data_, restart_offset_, num_restarts,
-                           hash_index_ptr, prefix_index_ptr);
+                           hash_index_ptr, prefix_index_ptr, data_block_hash_index_ptr,
+                           data_block_hash_index_key_transformer);
     }
   }
 
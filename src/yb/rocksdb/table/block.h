@@ -35,6 +35,7 @@
 #include "yb/rocksdb/db/dbformat.h"
 #include "yb/rocksdb/table/block_prefix_index.h"
 #include "yb/rocksdb/table/block_hash_index.h"
+#include "yb/rocksdb/table/data_block_hash_index.h"
 #include "yb/rocksdb/table/format.h"
 #include "yb/rocksdb/table/internal_iterator.h"
 
@@ -82,9 +83,14 @@ class Block {
   // If total_order_seek is true, hash_index_ and prefix_index_ are ignored.
   // This option only applies for index block. For data block, hash_index_
   // and prefix_index_ are null, so this option does not matter.
-  InternalIterator* NewIterator(const Comparator* comparator,
-                                BlockIter* iter = nullptr,
-                                bool total_order_seek = true);
+  //
+  // data_block_hash_index_key_transformer is used to look up keys in data block hash index,
+  // when the block has one.
+  InternalIterator* NewIterator(
+      const Comparator* comparator,
+      BlockIter* iter = nullptr,
+      bool total_order_seek = true,
+      const FilterPolicy::KeyTransformer* data_block_hash_index_key_transformer = nullptr);
   void SetBlockHashIndex(BlockHashIndex* hash_index);
   void SetBlockPrefixIndex(BlockPrefixIndex* prefix_index);
 
@@ -96,6 +102,8 @@ class Block {
   const char* data_;            // contents_.data.data()
   size_t size_;                 // contents_.data.size()
   uint32_t restart_offset_;     // Offset in data_ of restart array
+  uint32_t num_restarts_;
+  DataBlockHashIndex data_block_hash_index_;
   std::unique_ptr<BlockHashIndex> hash_index_;
   std::unique_ptr<BlockPrefixIndex> prefix_index_;
 
@@ -115,19 +123,25 @@ class BlockIter : public InternalIterator {
         restart_index_(0),
         status_(Status::OK()),
         hash_index_(nullptr),
-        prefix_index_(nullptr) {}
+        prefix_index_(nullptr),
+        data_block_hash_index_(nullptr),
+        data_block_hash_index_key_transformer_(nullptr) {}
 
   BlockIter(const Comparator* comparator, const char* data, uint32_t restarts,
        uint32_t num_restarts, BlockHashIndex* hash_index,
-       BlockPrefixIndex* prefix_index)
+       BlockPrefixIndex* prefix_index,
+       const DataBlockHashIndex* data_block_hash_index = nullptr,
+       const FilterPolicy::KeyTransformer* data_block_hash_index_key_transformer = nullptr)
       : BlockIter() {
     Initialize(comparator, data, restarts, num_restarts,
-        hash_index, prefix_index);
+        hash_index, prefix_index, data_block_hash_index, data_block_hash_index_key_transformer);
   }
 
   void Initialize(const Comparator* comparator, const char* data,
       uint32_t restarts, uint32_t num_restarts, BlockHashIndex* hash_index,
-      BlockPrefixIndex* prefix_index);
+      BlockPrefixIndex* prefix_index,
+      const DataBlockHashIndex* data_block_hash_index = nullptr,
+      const FilterPolicy::KeyTransformer* data_block_hash_index_key_transformer = nullptr);
 
   void SetStatus(Status s) {
     status_ = s;
@@ -180,6 +194,8 @@ class BlockIter : public InternalIterator {
   Status status_;
   BlockHashIndex* hash_index_;
   BlockPrefixIndex* prefix_index_;
+  const DataBlockHashIndex* data_block_hash_index_;
+  const FilterPolicy::KeyTransformer* data_block_hash_index_key_transformer_;
 
   inline int Compare(const Slice& a, const Slice& b) const {
     return comparator_->Compare(a, b);
@@ -223,6 +239,10 @@ class BlockIter : public InternalIterator {
 
   bool PrefixSeek(const Slice& target, uint32_t* index);
 
+  // Tries to position the iterator using the data block hash index. Returns false if the index
+  // could not resolve target, so the caller should fall back to binary search.
+  bool DataBlockHashSeek(const Slice& target);
+
 };
 
 }  // namespace rocksdb
@@ -348,7 +348,10 @@ BlockBasedTableBuilder::Rep::Rep(
       filter_block_builder(skip_filters ? nullptr : CreateFilterBlockBuilder(
           _ioptions, table_options, filter_type)),
       data_block_builder(table_options.block_restart_interval,
-                 table_options.use_delta_encoding),
+                 table_options.use_delta_encoding,
+                 table_options.use_data_block_hash_index,
+                 table_options.data_block_hash_table_util_ratio,
+                 table_options.data_block_hash_index_key_transformer),
       internal_prefix_transform(_ioptions.prefix_extractor),
       filter_key_transformer(table_opt.filter_policy ?
           table_opt.filter_policy->GetKeyTransformer() : nullptr),
@@ -23,6 +23,8 @@
 
 #include "yb/rocksdb/table/block_based_table_reader.h"
 
+#include <algorithm>
+#include <limits>
 #include <string>
 #include <utility>
 #include <cinttypes>
@@ -289,7 +291,8 @@ bool BloomFilterAwareFileFilter::Filter(TableReader* reader) const {
     const bool use_file = table->NonBlockBasedFilterKeyMayMatch(filter, filter_key);
     if (!use_file) {
       // Record that the bloom filter was useful.
-      RecordTick(table->rep_->ioptions.statistics, BLOOM_FILTER_USEFUL);
+      table->RecordBloomFilterTick(
+          BLOOM_FILTER_USEFUL, BLOOM_FILTER_RANGE_PREFIX_USEFUL, filter_key);
     }
     filter_entry.Release(table->rep_->table_options.block_cache.get());
     return use_file;
@@ -1124,7 +1127,9 @@ InternalIterator* BlockBasedTable::NewDataBlockIterator(const ReadOptions& ro,
 
   InternalIterator* iter;
   if (s.ok() && block.value != nullptr) {
-    iter = block.value->NewIterator(rep_->comparator.get(), input_iter);
+    iter = block.value->NewIterator(
+        rep_->comparator.get(), input_iter, true /* total_order_seek */,
+        rep_->table_options.data_block_hash_index_key_transformer);
     if (block.cache_handle != nullptr) {
       iter->RegisterCleanup(&ReleaseCachedEntry, block_cache,
           block.cache_handle);
@@ -1151,9 +1156,20 @@ class BlockBasedTable::BlockEntryIteratorState : public TwoLevelIteratorState {
         table_(table),
         read_options_(read_options),
         skip_filters_(skip_filters),
-        block_type_(block_type) {}
+        block_type_(block_type),
+        max_readahead_size_(
+            block_type == BlockType::kData && read_options.read_tier != kBlockCacheTier
+                ? std::min(table->rep_->table_options.max_auto_readahead_size,
+                           read_options.max_auto_readahead_size)
+                : 0),
+        initial_readahead_size_(
+            std::min(table->rep_->table_options.initial_auto_readahead_size, max_readahead_size_)),
+        readahead_size_(initial_readahead_size_) {}
 
   InternalIterator* NewSecondaryIterator(const Slice& index_value) override {
+    if (initial_readahead_size_ > 0) {
+      MaybeReadahead(index_value);
+    }
     return table_->NewDataBlockIterator(read_options_, index_value, block_type_);
   }
 
@@ -1165,11 +1181,63 @@ class BlockBasedTable::BlockEntryIteratorState : public TwoLevelIteratorState {
   }
 
  private:
+  // Number of consecutive data blocks the iterator should read before we start readahead.
+  static constexpr size_t kMinSequentialReadsForReadahead = 2;
+
+  // Tracks whether data blocks are accessed sequentially and, if so, asks the data file to
+  // prefetch blocks ahead of the iterator. The readahead window is doubled on every prefetch, so
+  // long scans end up issuing large reads while short scans and point lookups do not cause any
+  // readahead.
+  void MaybeReadahead(const Slice& index_value) {
+    BlockHandle handle;
+    Slice input = index_value;
+    if (!handle.DecodeFrom(&input).ok()) {
+      // NewDataBlockIterator will report the error.
+      return;
+    }
+
+    if (handle.offset() == prev_block_end_) {
+      ++num_sequential_reads_;
+    } else {
+      num_sequential_reads_ = 0;
+      readahead_size_ = initial_readahead_size_;
+      readahead_limit_ = 0;
+    }
+    const uint64_t block_end = handle.offset() + handle.size() + kBlockTrailerSize;
+    prev_block_end_ = block_end;
+
+    // Keep at least half of the current window prefetched ahead of the iterator.
+    if (num_sequential_reads_ < kMinSequentialReadsForReadahead ||
+        readahead_limit_ >= block_end + readahead_size_ / 2) {
+      return;
+    }
+
+    const uint64_t readahead_offset = std::max(block_end, readahead_limit_);
+    auto* file = table_->GetBlockReader(BlockType::kData)->reader->file();
+    // Readahead is only a hint, so failure is not an error for the iterator.
+    if (file->Readahead(readahead_offset, readahead_size_).ok()) {
+      Statistics* statistics = table_->rep_->ioptions.statistics;
+      RecordTick(statistics, BLOCK_READAHEAD_REQUESTS);
+      RecordTick(statistics, BLOCK_READAHEAD_BYTES, readahead_size_);
+    }
+    readahead_limit_ = readahead_offset + readahead_size_;
+    readahead_size_ = std::min(readahead_size_ * 2, max_readahead_size_);
+  }
+
   // Don't own table_
   BlockBasedTable* const table_;
   const ReadOptions read_options_;
   const bool skip_filters_;
   const BlockType block_type_;
+
+  // Adaptive readahead state, only used for data block iterators.
+  const size_t max_readahead_size_;
+  const size_t initial_readahead_size_;
+  size_t readahead_size_;
+  size_t num_sequential_reads_ = 0;
+  uint64_t prev_block_end_ = std::numeric_limits<uint64_t>::max();
+  // End of the file range already requested by readahead.
+  uint64_t readahead_limit_ = 0;
 };
 
 // This will be broken if the user specifies an unusual implementation
@@ -1290,7 +1358,7 @@ bool BlockBasedTable::NonBlockBasedFilterKeyMayMatch(FilterBlockReader* filter,
   if (filter == nullptr) {
     return true;
   }
-  RecordTick(rep_->ioptions.statistics, BLOOM_FILTER_CHECKED);
+  RecordBloomFilterTick(BLOOM_FILTER_CHECKED, BLOOM_FILTER_RANGE_PREFIX_CHECKED, filter_key);
   if (!filter->KeyMayMatch(filter_key)) {
     return false;
   }
@@ -1303,6 +1371,19 @@ bool BlockBasedTable::NonBlockBasedFilterKeyMayMatch(FilterBlockReader* filter,
   return true;
 }
 
+void BlockBasedTable::RecordBloomFilterTick(
+    Tickers ticker, Tickers range_prefix_ticker, const Slice& filter_key) const {
+  Statistics* statistics = rep_->ioptions.statistics;
+  if (statistics == nullptr) {
+    return;
+  }
+  RecordTick(statistics, ticker);
+  if (rep_->filter_key_transformer &&
+      rep_->filter_key_transformer->IsRangePrefixKey(filter_key)) {
+    RecordTick(statistics, range_prefix_ticker);
+  }
+}
+
 Status BlockBasedTable::Get(const ReadOptions& read_options, const Slice& internal_key,
                             GetContext* get_context, bool skip_filters) {
   Status s;
@@ -1320,7 +1401,7 @@ Status BlockBasedTable::Get(const ReadOptions& read_options, const Slice& intern
 
   // First check non block-based filter.
   if (!is_block_based_filter && !NonBlockBasedFilterKeyMayMatch(filter, filter_key)) {
-    RecordTick(rep_->ioptions.statistics, BLOOM_FILTER_USEFUL);
+    RecordBloomFilterTick(BLOOM_FILTER_USEFUL, BLOOM_FILTER_RANGE_PREFIX_USEFUL, filter_key);
   } else {
 
     // Either filter is block-based or key may match.
@@ -1588,6 +1669,31 @@ uint64_t BlockBasedTable::ApproximateOffsetOf(const Slice& key) {
   return result;
 }
 
+yb::Result<std::string> BlockBasedTable::GetMiddleKey() {
+  unique_ptr<InternalIterator> index_iter(NewIndexIterator(ReadOptions::kDefault));
+
+  // Data blocks have about the same size, so the middle index entry points to the middle of the
+  // table.
+  size_t num_entries = 0;
+  for (index_iter->SeekToFirst(); index_iter->Valid(); index_iter->Next()) {
+    ++num_entries;
+  }
+  RETURN_NOT_OK(index_iter->status());
+  if (num_entries == 0) {
+    return STATUS(Incomplete, "Empty table");
+  }
+
+  index_iter->SeekToFirst();
+  for (size_t i = 0; i != num_entries / 2; ++i) {
+    index_iter->Next();
+  }
+  RETURN_NOT_OK(index_iter->status());
+  if (!index_iter->Valid()) {
+    return STATUS(Incomplete, "Table index changed while reading");
+  }
+  return ExtractUserKey(index_iter->key()).ToBuffer();
+}
+
 bool BlockBasedTable::TEST_filter_block_preloaded() const {
   return rep_->filter != nullptr;
 }
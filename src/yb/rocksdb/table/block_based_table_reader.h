@@ -164,6 +164,9 @@ class BlockBasedTable : public TableReader {
   // be close to the file length.
   uint64_t ApproximateOffsetOf(const Slice& key) override;
 
+  // Returns user key of the middle data index entry.
+  yb::Result<std::string> GetMiddleKey() override;
+
   // Returns true if the block for the specified key is in cache.
   // REQUIRES: key is in this table && block cache enabled
   bool TEST_KeyInCache(const ReadOptions& options, const Slice& key);
@@ -282,6 +285,11 @@ class BlockBasedTable : public TableReader {
 
   bool NonBlockBasedFilterKeyMayMatch(FilterBlockReader* filter, const Slice& filter_key) const;
 
+  // Records bloom filter ticker, and also range_prefix_ticker if filter_key covers range
+  // components (see FilterPolicy::KeyTransformer::IsRangePrefixKey).
+  void RecordBloomFilterTick(
+      Tickers ticker, Tickers range_prefix_ticker, const Slice& filter_key) const;
+
   // Read the meta block from sst.
   static Status ReadMetaBlock(Rep* rep, std::unique_ptr<Block>* meta_block,
                               std::unique_ptr<InternalIterator>* iter);
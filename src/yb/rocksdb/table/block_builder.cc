@@ -44,6 +44,9 @@
 //     restarts: uint32[num_restarts]
 //     num_restarts: uint32
 // restarts[i] contains the offset within the block of the ith restart point.
+//
+// Data blocks could optionally have a hash index between the restart array and num_restarts,
+// see data_block_hash_index.h.
 
 #include "yb/rocksdb/table/block_builder.h"
 
@@ -57,7 +60,9 @@
 
 namespace rocksdb {
 
-BlockBuilder::BlockBuilder(int block_restart_interval, bool use_delta_encoding)
+BlockBuilder::BlockBuilder(int block_restart_interval, bool use_delta_encoding,
+                           bool use_hash_index, double hash_table_util_ratio,
+                           const FilterPolicy::KeyTransformer* hash_index_key_transformer)
     : block_restart_interval_(block_restart_interval),
       use_delta_encoding_(use_delta_encoding),
       restarts_(),
@@ -65,6 +70,9 @@ BlockBuilder::BlockBuilder(int block_restart_interval, bool use_delta_encoding)
       finished_(false) {
   assert(block_restart_interval_ >= 1);
   restarts_.push_back(0);       // First restart point is at offset 0
+  if (use_hash_index) {
+    hash_index_builder_.Initialize(hash_table_util_ratio, hash_index_key_transformer);
+  }
 }
 
 void BlockBuilder::Reset() {
@@ -74,6 +82,7 @@ void BlockBuilder::Reset() {
   counter_ = 0;
   finished_ = false;
   last_key_.clear();
+  hash_index_builder_.Reset();
 }
 
 size_t BlockBuilder::CurrentSizeEstimate() const {
@@ -82,6 +91,9 @@ size_t BlockBuilder::CurrentSizeEstimate() const {
     // Restarts haven't been flushed to buffer yet.
     size += restarts_.size() * sizeof(uint32_t) +    // Restart array.
             sizeof(uint32_t);                        // Restart array length.
+    if (hash_index_builder_.Valid()) {
+      size += hash_index_builder_.EstimateSize();
+    }
   }
   return size;
 }
@@ -110,7 +122,12 @@ Slice BlockBuilder::Finish() {
   for (size_t i = 0; i < restarts_.size(); i++) {
     PutFixed32(&buffer_, restarts_[i]);
   }
-  PutFixed32(&buffer_, static_cast<uint32_t>(restarts_.size()));
+  uint32_t num_restarts = static_cast<uint32_t>(restarts_.size());
+  if (hash_index_builder_.Valid()) {
+    hash_index_builder_.Finish(&buffer_);
+    num_restarts |= kDataBlockHashIndexFlag;
+  }
+  PutFixed32(&buffer_, num_restarts);
   finished_ = true;
   return Slice(buffer_);
 }
@@ -133,6 +150,15 @@ void BlockBuilder::Add(const Slice& key, const Slice& value) {
   }
   const size_t non_shared = key.size() - shared;
 
+  if (hash_index_builder_.Valid()) {
+    // Only the first entry of each user key is indexed, so the lookup lands on the restart interval
+    // where entries with this user key start.
+    Slice hash_key = hash_index_builder_.HashKey(key);
+    if (last_key_piece.empty() || hash_index_builder_.HashKey(last_key_piece) != hash_key) {
+      hash_index_builder_.Add(hash_key, restarts_.size() - 1);
+    }
+  }
+
   // Add "<shared><non_shared><value_size>" to buffer_
   PutVarint32(&buffer_, static_cast<uint32_t>(shared));
   PutVarint32(&buffer_, static_cast<uint32_t>(non_shared));
@@ -27,6 +27,7 @@
 #include <stdint.h>
 #include <vector>
 #include "yb/util/slice.h"
+#include "yb/rocksdb/table/data_block_hash_index.h"
 
 namespace rocksdb {
 
@@ -35,8 +36,14 @@ class BlockBuilder {
   BlockBuilder(const BlockBuilder&) = delete;
   void operator=(const BlockBuilder&) = delete;
 
+  // If use_hash_index is true, keys should be internal keys, and the block gets a hash index
+  // mapping user keys, transformed by hash_index_key_transformer if specified, to restart
+  // intervals, see data_block_hash_index.h.
   explicit BlockBuilder(int block_restart_interval,
-                        bool use_delta_encoding = true);
+                        bool use_delta_encoding = true,
+                        bool use_hash_index = false,
+                        double hash_table_util_ratio = 0.75,
+                        const FilterPolicy::KeyTransformer* hash_index_key_transformer = nullptr);
 
   // Reset the contents as if the BlockBuilder was just constructed.
   void Reset();
@@ -73,6 +80,7 @@ class BlockBuilder {
   int                   counter_;   // Number of entries emitted since restart
   bool                  finished_;  // Has Finish() been called?
   std::string           last_key_;
+  DataBlockHashIndexBuilder hash_index_builder_;
 };
 
 }  // namespace rocksdb
@@ -243,6 +243,163 @@ TEST_F(BlockTest, IndexHashWithSharedPrefix) {
   CheckBlockContents(std::move(contents), kMaxKey, keys, values);
 }
 
+namespace {
+
+std::unique_ptr<Block> BuildInternalKeyBlock(
+    const std::vector<std::string>& keys, int restart_interval, bool use_hash_index,
+    std::string* buffer, const FilterPolicy::KeyTransformer* key_transformer = nullptr) {
+  BlockBuilder builder(
+      restart_interval, true /* use_delta_encoding */, use_hash_index, 0.75, key_transformer);
+  for (const auto& key : keys) {
+    builder.Add(key, "value_" + key);
+  }
+  *buffer = builder.Finish().ToBuffer();
+  BlockContents contents;
+  contents.data = *buffer;
+  contents.cachable = false;
+  return std::make_unique<Block>(std::move(contents));
+}
+
+// Strips the version suffix starting with '@' from user keys.
+class VersionSuffixStripper : public FilterPolicy::KeyTransformer {
+ public:
+  Slice Transform(Slice key) const override {
+    const auto* pos = static_cast<const char*>(memchr(key.cdata(), '@', key.size()));
+    return pos ? Slice(key.cdata(), pos) : key;
+  }
+};
+
+} // namespace
+
+TEST_F(BlockTest, DataBlockHashIndex) {
+  InternalKeyComparator comparator(BytewiseComparator());
+  Random rnd(301);
+
+  // Several versions of each user key, so that entries of some user keys span restart intervals.
+  std::vector<std::string> keys;
+  for (int i = 0; i < 200; i += 2) {
+    const std::string user_key = GenerateKey(i, 0, 0, nullptr);
+    const int num_versions = 1 + rnd.Uniform(4);
+    for (int version = num_versions; version > 0; --version) {
+      keys.push_back(InternalKey(user_key, version * 10, kTypeValue).Encode().ToString());
+    }
+  }
+
+  std::string hash_buffer, binary_buffer;
+  auto hash_block = BuildInternalKeyBlock(keys, 4, true /* use_hash_index */, &hash_buffer);
+  auto binary_block = BuildInternalKeyBlock(keys, 4, false /* use_hash_index */, &binary_buffer);
+  ASSERT_GT(hash_buffer.size(), binary_buffer.size());
+  ASSERT_EQ(hash_block->NumRestarts(), binary_block->NumRestarts());
+
+  std::unique_ptr<InternalIterator> hash_iter(hash_block->NewIterator(&comparator));
+  std::unique_ptr<InternalIterator> binary_iter(binary_block->NewIterator(&comparator));
+
+  size_t count = 0;
+  for (hash_iter->SeekToFirst(); hash_iter->Valid(); hash_iter->Next(), ++count) {
+    ASSERT_EQ(keys[count], hash_iter->key().ToString());
+  }
+  ASSERT_EQ(keys.size(), count);
+
+  // Both existing and missing user keys, with sequence numbers above, between and below versions.
+  for (int i = -1; i <= 201; ++i) {
+    const std::string user_key = GenerateKey(i, 0, 0, nullptr);
+    for (SequenceNumber seq : std::vector<SequenceNumber>{kMaxSequenceNumber, 35, 30, 20, 5}) {
+      const std::string target = InternalKey(user_key, seq, kTypeValue).Encode().ToString();
+      hash_iter->Seek(target);
+      binary_iter->Seek(target);
+      ASSERT_OK(hash_iter->status());
+      ASSERT_EQ(binary_iter->Valid(), hash_iter->Valid()) << "Target: " << user_key << "@" << seq;
+      if (binary_iter->Valid()) {
+        ASSERT_EQ(binary_iter->key().ToString(), hash_iter->key().ToString());
+        ASSERT_EQ(binary_iter->value().ToString(), hash_iter->value().ToString());
+      }
+    }
+  }
+}
+
+// Versions are part of user keys, so seek targets are usually not equal to any stored user key.
+// With the key transformer they still use the hash index, and results match binary search.
+TEST_F(BlockTest, DataBlockHashIndexKeyTransformer) {
+  InternalKeyComparator comparator(BytewiseComparator());
+  VersionSuffixStripper key_transformer;
+  Random rnd(301);
+
+  auto make_key = [](int i, int version) {
+    // Versions are sorted in descending order.
+    char suffix[8];
+    snprintf(suffix, sizeof(suffix), "@%03d", 999 - version);
+    return GenerateKey(i, 0, 0, nullptr) + suffix;
+  };
+
+  std::vector<std::string> keys;
+  for (int i = 0; i < 200; i += 2) {
+    const int num_versions = 1 + rnd.Uniform(6);
+    for (int version = num_versions; version > 0; --version) {
+      keys.push_back(InternalKey(make_key(i, version * 10), 1, kTypeValue).Encode().ToString());
+    }
+  }
+
+  for (int restart_interval : {1, 2, 4, 16}) {
+    std::string hash_buffer, binary_buffer;
+    auto hash_block = BuildInternalKeyBlock(
+        keys, restart_interval, true /* use_hash_index */, &hash_buffer, &key_transformer);
+    auto binary_block = BuildInternalKeyBlock(
+        keys, restart_interval, false /* use_hash_index */, &binary_buffer);
+    ASSERT_GT(hash_buffer.size(), binary_buffer.size());
+
+    std::unique_ptr<InternalIterator> hash_iter(hash_block->NewIterator(
+        &comparator, nullptr /* iter */, true /* total_order_seek */, &key_transformer));
+    std::unique_ptr<InternalIterator> binary_iter(binary_block->NewIterator(&comparator));
+
+    // Versions above, between and below stored ones, including the newest possible one.
+    for (int i = -1; i <= 201; ++i) {
+      for (int version : {990, 65, 60, 55, 30, 20, 5}) {
+        const std::string target =
+            InternalKey(make_key(i, version), kMaxSequenceNumber, kTypeValue).Encode().ToString();
+        hash_iter->Seek(target);
+        binary_iter->Seek(target);
+        ASSERT_OK(hash_iter->status());
+        ASSERT_EQ(binary_iter->Valid(), hash_iter->Valid())
+            << "Target: " << i << "@" << version << ", restart interval: " << restart_interval;
+        if (binary_iter->Valid()) {
+          ASSERT_EQ(binary_iter->key().ToString(), hash_iter->key().ToString());
+          ASSERT_EQ(binary_iter->value().ToString(), hash_iter->value().ToString());
+          // Iterator position is consistent for further iteration in both directions.
+          hash_iter->Prev();
+          binary_iter->Prev();
+          ASSERT_EQ(binary_iter->Valid(), hash_iter->Valid());
+          if (binary_iter->Valid()) {
+            ASSERT_EQ(binary_iter->key().ToString(), hash_iter->key().ToString());
+          }
+        }
+      }
+    }
+  }
+}
+
+TEST_F(BlockTest, DataBlockHashIndexTooManyRestarts) {
+  InternalKeyComparator comparator(BytewiseComparator());
+  std::vector<std::string> keys;
+  for (int i = 0; i < 1000; ++i) {
+    keys.push_back(
+        InternalKey(GenerateKey(i, 0, 0, nullptr), 1, kTypeValue).Encode().ToString());
+  }
+
+  // The hash index can't address more than kMaxRestartSupportedByHashIndex restart intervals, so
+  // the block is written in the regular format.
+  std::string hash_buffer, binary_buffer;
+  auto hash_block = BuildInternalKeyBlock(keys, 1, true /* use_hash_index */, &hash_buffer);
+  BuildInternalKeyBlock(keys, 1, false /* use_hash_index */, &binary_buffer);
+  ASSERT_EQ(binary_buffer, hash_buffer);
+
+  std::unique_ptr<InternalIterator> iter(hash_block->NewIterator(&comparator));
+  for (const auto& key : keys) {
+    iter->Seek(key);
+    ASSERT_TRUE(iter->Valid());
+    ASSERT_EQ(key, iter->key().ToString());
+  }
+}
+
 }  // namespace rocksdb
 
 int main(int argc, char **argv) {
@@ -0,0 +1,94 @@
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+
+#include "yb/rocksdb/table/data_block_hash_index.h"
+
+#include "yb/rocksdb/util/coding.h"
+#include "yb/rocksdb/util/hash.h"
+
+namespace rocksdb {
+
+namespace {
+
+inline uint32_t DataBlockHashIndexHash(const Slice& hash_key) {
+  return GetSliceHash(hash_key);
+}
+
+} // namespace
+
+void DataBlockHashIndexBuilder::Initialize(
+    double util_ratio, const FilterPolicy::KeyTransformer* key_transformer) {
+  util_ratio_ = util_ratio;
+  key_transformer_ = key_transformer;
+  valid_ = util_ratio > 0;
+}
+
+void DataBlockHashIndexBuilder::Add(const Slice& hash_key, size_t restart_index) {
+  if (restart_index > kMaxRestartSupportedByHashIndex) {
+    valid_ = false;
+    return;
+  }
+  hash_and_restart_pairs_.emplace_back(
+      DataBlockHashIndexHash(hash_key), static_cast<uint8_t>(restart_index));
+}
+
+size_t DataBlockHashIndexBuilder::EstimateSize() const {
+  auto estimated_num_buckets =
+      static_cast<uint32_t>(static_cast<double>(hash_and_restart_pairs_.size()) / util_ratio_);
+  // Make sure the number of buckets is odd, so hashes are spread better.
+  estimated_num_buckets |= 1;
+  return sizeof(uint32_t) + estimated_num_buckets;
+}
+
+void DataBlockHashIndexBuilder::Finish(std::string* buffer) {
+  DCHECK(Valid());
+  const size_t size_before = buffer->size();
+  const uint32_t num_buckets = static_cast<uint32_t>(EstimateSize() - sizeof(uint32_t));
+
+  buffer->append(num_buckets, static_cast<char>(kNoEntry));
+  auto* buckets = reinterpret_cast<uint8_t*>(&(*buffer)[size_before]);
+  for (const auto& entry : hash_and_restart_pairs_) {
+    uint8_t& bucket = buckets[entry.first % num_buckets];
+    if (bucket == kNoEntry) {
+      bucket = entry.second;
+    } else if (bucket != entry.second) {
+      bucket = kCollision;
+    }
+  }
+
+  PutFixed32(buffer, num_buckets);
+}
+
+void DataBlockHashIndexBuilder::Reset() {
+  valid_ = util_ratio_ > 0;
+  hash_and_restart_pairs_.clear();
+}
+
+size_t DataBlockHashIndex::Initialize(const char* data, size_t size) {
+  if (size < sizeof(uint32_t)) {
+    return 0;
+  }
+  num_buckets_ = DecodeFixed32(data + size - sizeof(uint32_t));
+  const size_t index_size = sizeof(uint32_t) + num_buckets_;
+  if (num_buckets_ == 0 || index_size > size) {
+    return 0;
+  }
+  buckets_ = reinterpret_cast<const uint8_t*>(data + size - index_size);
+  return index_size;
+}
+
+uint8_t DataBlockHashIndex::Lookup(const Slice& hash_key) const {
+  return buckets_[DataBlockHashIndexHash(hash_key) % num_buckets_];
+}
+
+}  // namespace rocksdb
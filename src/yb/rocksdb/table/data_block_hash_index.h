@@ -0,0 +1,106 @@
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+
+#ifndef YB_ROCKSDB_TABLE_DATA_BLOCK_HASH_INDEX_H
+#define YB_ROCKSDB_TABLE_DATA_BLOCK_HASH_INDEX_H
+
+#include <stdint.h>
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "yb/rocksdb/db/dbformat.h"
+#include "yb/rocksdb/filter_policy.h"
+#include "yb/util/slice.h"
+
+namespace rocksdb {
+
+// Optional hash index appended to data blocks to speed up point lookups.
+//
+// The index maps hash of a user key to the index of the restart interval that contains the first
+// entry with this user key. User keys could be transformed before hashing, see
+// BlockBasedTableOptions::data_block_hash_index_key_transformer, then "user key" below means the
+// transformed user key. Each bucket is a single byte, so the index is only built for blocks
+// with at most kMaxRestartSupportedByHashIndex restart intervals. Bucket value kNoEntry means that
+// no user key in the block has this hash, kCollision means that several user keys share the
+// bucket and the reader should fall back to binary search.
+//
+// Block layout with hash index:
+//     entries...
+//     restarts: uint32[num_restarts]
+//     buckets: uint8[num_buckets]
+//     num_buckets: uint32
+//     num_restarts | kDataBlockHashIndexFlag: uint32
+//
+// Blocks without hash index keep the original layout, so the flag in the high bit of the
+// num_restarts field tells readers which layout is used.
+constexpr uint8_t kNoEntry = 255;
+constexpr uint8_t kCollision = 254;
+constexpr uint8_t kMaxRestartSupportedByHashIndex = 253;
+constexpr uint32_t kDataBlockHashIndexFlag = 1u << 31;
+
+// Returns the part of internal_key hashed by the index.
+inline Slice DataBlockHashKey(
+    const Slice& internal_key, const FilterPolicy::KeyTransformer* key_transformer) {
+  const Slice user_key = ExtractUserKey(internal_key);
+  return key_transformer ? key_transformer->Transform(user_key) : user_key;
+}
+
+class DataBlockHashIndexBuilder {
+ public:
+  void Initialize(double util_ratio, const FilterPolicy::KeyTransformer* key_transformer);
+
+  bool Valid() const { return valid_; }
+
+  Slice HashKey(const Slice& internal_key) const {
+    return DataBlockHashKey(internal_key, key_transformer_);
+  }
+
+  // Records that the first entry with hash_key is in restart interval restart_index.
+  void Add(const Slice& hash_key, size_t restart_index);
+
+  // Appends buckets and number of buckets to buffer.
+  void Finish(std::string* buffer);
+
+  // Returns size of the data that Finish would append to the block.
+  size_t EstimateSize() const;
+
+  void Reset();
+
+ private:
+  double util_ratio_ = 0;
+  const FilterPolicy::KeyTransformer* key_transformer_ = nullptr;
+  bool valid_ = false;
+  std::vector<std::pair<uint32_t, uint8_t>> hash_and_restart_pairs_;
+};
+
+class DataBlockHashIndex {
+ public:
+  // Initializes index from block data. size is the size of block data preceding the
+  // num_restarts field. Returns size of the hash index, or 0 if it is corrupted.
+  size_t Initialize(const char* data, size_t size);
+
+  // Returns restart index for hash_key, kNoEntry or kCollision.
+  uint8_t Lookup(const Slice& hash_key) const;
+
+  bool Valid() const { return buckets_ != nullptr; }
+
+ private:
+  const uint8_t* buckets_ = nullptr;
+  uint32_t num_buckets_ = 0;
+};
+
+}  // namespace rocksdb
+
+#endif // YB_ROCKSDB_TABLE_DATA_BLOCK_HASH_INDEX_H
@@ -26,6 +26,7 @@
 
 #include <memory>
 
+#include "yb/util/result.h"
 #include "yb/util/slice.h"
 
 namespace rocksdb {
@@ -72,6 +73,12 @@ class TableReader {
   // be close to the file length.
   virtual uint64_t ApproximateOffsetOf(const Slice& key) = 0;
 
+  // Returns approximate middle user key of the table, that splits it into two parts of about the
+  // same size.
+  virtual yb::Result<std::string> GetMiddleKey() {
+    return STATUS(NotSupported, "GetMiddleKey() not supported");
+  }
+
   // Set up the table for Compaction. Might change some parameters with
   // posix_fadvise
   virtual void SetupForCompaction() = 0;
@@ -1570,6 +1570,63 @@ TEST_F(BlockBasedTableTest, NumBlockStat) {
             c.GetTableReader()->GetTableProperties()->num_data_blocks);
 }
 
+TEST_F(BlockBasedTableTest, AdaptiveReadahead) {
+  TableConstructor c(BytewiseComparator());
+  Options options;
+  options.compression = kNoCompression;
+  options.statistics = CreateDBStatistics();
+  BlockBasedTableOptions table_options;
+  table_options.block_restart_interval = 1;
+  table_options.block_size = 1000;
+  table_options.initial_auto_readahead_size = 4_KB;
+  table_options.max_auto_readahead_size = 16_KB;
+  options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+
+  Random rnd(test::RandomSeed());
+  constexpr int kNumBlocks = 100;
+  for (int i = 0; i < kNumBlocks; ++i) {
+    // Each block holds roughly one key/value pair.
+    c.Add(RandomString(&rnd, 900), "val");
+  }
+
+  std::vector<std::string> ks;
+  stl_wrappers::KVMap kvmap;
+  const ImmutableCFOptions ioptions(options);
+  c.Finish(options, ioptions, table_options,
+           GetPlainInternalComparator(options.comparator), &ks, &kvmap);
+  Statistics* statistics = options.statistics.get();
+
+  auto scan = [&c](const ReadOptions& read_options, int num_keys) {
+    std::unique_ptr<InternalIterator> iter(c.GetTableReader()->NewIterator(read_options));
+    int count = 0;
+    for (iter->SeekToFirst(); iter->Valid() && count < num_keys; iter->Next()) {
+      ++count;
+    }
+    ASSERT_OK(iter->status());
+    ASSERT_EQ(num_keys, count);
+  };
+
+  // Short scan does not trigger readahead.
+  scan(ReadOptions(), 2);
+  ASSERT_EQ(0U, statistics->getTickerCount(BLOCK_READAHEAD_REQUESTS));
+
+  // Readahead disabled by read options.
+  ReadOptions no_readahead_options;
+  no_readahead_options.max_auto_readahead_size = 0;
+  scan(no_readahead_options, kNumBlocks);
+  ASSERT_EQ(0U, statistics->getTickerCount(BLOCK_READAHEAD_REQUESTS));
+
+  // Full scan issues readahead requests with growing window, so there are much fewer requests
+  // than blocks.
+  scan(ReadOptions(), kNumBlocks);
+  const auto requests = statistics->getTickerCount(BLOCK_READAHEAD_REQUESTS);
+  const auto bytes = statistics->getTickerCount(BLOCK_READAHEAD_BYTES);
+  ASSERT_GT(requests, 0U);
+  ASSERT_LT(requests, kNumBlocks / 4U);
+  ASSERT_LE(bytes, requests * table_options.max_auto_readahead_size);
+  ASSERT_GE(bytes, (kNumBlocks / 2) * table_options.block_size);
+}
+
 // A simple tool that takes the snapshot of block cache statistics.
 class BlockCachePropertiesSnapshot {
  public:
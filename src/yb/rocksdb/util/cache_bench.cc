@@ -32,6 +32,10 @@ int main() {
 #include <inttypes.h>
 #include <sys/types.h>
 #include <stdio.h>
+
+#include <atomic>
+#include <string>
+
 #include <gflags/gflags.h>
 
 #include "yb/rocksdb/db.h"
@@ -49,6 +53,9 @@ DEFINE_int32(threads, 16, "Number of concurrent threads to run.");
 DEFINE_int64(cache_size, 8 * KB * KB,
              "Number of bytes to use as a cache of uncompressed data.");
 DEFINE_int32(num_shard_bits, 4, "shard_bits.");
+DEFINE_string(cache_type, "lru", "Cache implementation to benchmark: lru or clock.");
+DEFINE_int64(estimated_entry_charge, 1,
+             "Expected charge of an entry, used by the clock cache to size its table.");
 
 DEFINE_int64(max_key, 1 * KB * KB * KB, "Max number of key to place in cache");
 DEFINE_uint64(ops_per_thread, 1200000, "Number of operations per thread.");
@@ -60,13 +67,31 @@ DEFINE_int32(lookup_percent, 50,
              "Ratio of lookup to total workload (expressed as a percentage)");
 DEFINE_int32(erase_percent, 10,
              "Ratio of erase to total workload (expressed as a percentage)");
+DEFINE_bool(skewed, false,
+            "Pick keys with exponential bias towards smaller keys instead of uniformly, so that "
+            "a small set of hot keys gets most of the operations.");
+DEFINE_bool(shared_query_id, false,
+            "Use the same query id in all threads. Otherwise each thread uses its own query id, "
+            "so entries touched by several threads move to the multi-touch part of the cache.");
 
 namespace rocksdb {
 
 class CacheBench;
 namespace {
 void deleter(const Slice& key, void* value) {
-    delete reinterpret_cast<char *>(value);
+  delete[] reinterpret_cast<char *>(value);
+}
+
+std::shared_ptr<Cache> NewCache() {
+  if (FLAGS_cache_type == "clock") {
+    return NewClockCache(FLAGS_cache_size, FLAGS_num_shard_bits, false /* strict_capacity_limit */,
+                         FLAGS_estimated_entry_charge);
+  }
+  if (FLAGS_cache_type != "lru") {
+    fprintf(stderr, "Unknown cache type: %s\n", FLAGS_cache_type.c_str());
+    exit(1);
+  }
+  return NewLRUCache(FLAGS_cache_size, FLAGS_num_shard_bits);
 }
 
 // State shared by all concurrent executions of the same benchmark.
@@ -145,8 +170,15 @@ struct ThreadState {
 class CacheBench {
  public:
   CacheBench() :
-      cache_(NewLRUCache(FLAGS_cache_size, FLAGS_num_shard_bits)),
-      num_threads_(FLAGS_threads) {}
+      cache_(NewCache()),
+      num_threads_(FLAGS_threads),
+      max_key_log_(0),
+      lookups_(0),
+      hits_(0) {
+    while (max_key_log_ < 30 && (1LL << (max_key_log_ + 1)) <= FLAGS_max_key) {
+      ++max_key_log_;
+    }
+  }
 
   ~CacheBench() {}
 
@@ -157,7 +189,7 @@ class CacheBench {
       // Cast uint64* to be char*, data would be copied to cache
       Slice key(reinterpret_cast<char*>(&rand_key), 8);
       // do insert
-      cache_->Insert(key, new char[10], 1, &deleter);
+      cache_->Insert(key, kDefaultQueryId, new char[10], 1, &deleter);
     }
   }
 
@@ -194,6 +226,10 @@ class CacheBench {
       uint32_t qps = static_cast<uint32_t>(
           static_cast<double>(FLAGS_threads * FLAGS_ops_per_thread) / elapsed);
       fprintf(stdout, "Complete in %.3f s; QPS = %u\n", elapsed, qps);
+      const uint64_t lookups = lookups_.load();
+      if (lookups > 0) {
+        fprintf(stdout, "Lookup hit ratio: %.2f%%\n", 100.0 * hits_.load() / lookups);
+      }
     }
     return true;
   }
@@ -201,6 +237,9 @@ class CacheBench {
  private:
   std::shared_ptr<Cache> cache_;
   uint32_t num_threads_;
+  int max_key_log_;
+  std::atomic<uint64_t> lookups_;
+  std::atomic<uint64_t> hits_;
 
   static void ThreadBody(void* v) {
     ThreadState* thread = reinterpret_cast<ThreadState*>(v);
@@ -228,31 +267,38 @@ class CacheBench {
   }
 
   void OperateCache(ThreadState* thread) {
+    const QueryId query_id = FLAGS_shared_query_id ? kDefaultQueryId : thread->tid + 1;
+    uint64_t lookups = 0;
+    uint64_t hits = 0;
     for (uint64_t i = 0; i < FLAGS_ops_per_thread; i++) {
-      uint64_t rand_key = thread->rnd.Next() % FLAGS_max_key;
+      uint64_t rand_key = FLAGS_skewed ? thread->rnd.Skewed(max_key_log_)
+                                       : thread->rnd.Next() % FLAGS_max_key;
       // Cast uint64* to be char*, data would be copied to cache
       Slice key(reinterpret_cast<char*>(&rand_key), 8);
       int32_t prob_op = thread->rnd.Uniform(100);
-      if (prob_op >= 0 && prob_op < FLAGS_insert_percent) {
+      if (prob_op < FLAGS_insert_percent) {
         // do insert
-        cache_->Insert(key, new char[10], 1, &deleter);
-      } else if (prob_op -= FLAGS_insert_percent &&
-                 prob_op < FLAGS_lookup_percent) {
+        cache_->Insert(key, query_id, new char[10], 1, &deleter);
+      } else if ((prob_op -= FLAGS_insert_percent) < FLAGS_lookup_percent) {
         // do lookup
-        auto handle = cache_->Lookup(key);
+        ++lookups;
+        auto handle = cache_->Lookup(key, query_id);
         if (handle) {
+          ++hits;
           cache_->Release(handle);
         }
-      } else if (prob_op -= FLAGS_lookup_percent &&
-                 prob_op < FLAGS_erase_percent) {
+      } else if ((prob_op -= FLAGS_lookup_percent) < FLAGS_erase_percent) {
         // do erase
         cache_->Erase(key);
       }
     }
+    lookups_ += lookups;
+    hits_ += hits;
   }
 
   void PrintEnv() const {
     printf("RocksDB version     : %d.%d\n", kMajorVersion, kMinorVersion);
+    printf("Cache type          : %s\n", FLAGS_cache_type.c_str());
     printf("Number of threads   : %d\n", FLAGS_threads);
     printf("Ops per thread      : %" PRIu64 "\n", FLAGS_ops_per_thread);
     printf("Cache size          : %" PRIu64 "\n", FLAGS_cache_size);
@@ -262,6 +308,8 @@ class CacheBench {
     printf("Insert percentage   : %d%%\n", FLAGS_insert_percent);
     printf("Lookup percentage   : %d%%\n", FLAGS_lookup_percent);
     printf("Erase percentage    : %d%%\n", FLAGS_erase_percent);
+    printf("Skewed keys         : %d\n", FLAGS_skewed);
+    printf("Shared query id     : %d\n", FLAGS_shared_query_id);
     printf("----------------------------\n");
   }
 };
@@ -27,8 +27,10 @@
 #include <vector>
 #include <string>
 #include <iostream>
+#include <thread>
 #include <gflags/gflags.h>
 #include "yb/rocksdb/util/coding.h"
+#include "yb/rocksdb/util/random.h"
 #include "yb/util/string_util.h"
 #include "yb/rocksdb/util/testharness.h"
 
@@ -675,6 +677,143 @@ TEST_F(CacheTest, ApplyToAllCacheEntiresTest) {
   ASSERT_TRUE(inserted == callback_state);
 }
 
+TEST_F(CacheTest, ClockHitAndMiss) {
+  auto cache = NewClockCache(kCacheSize, kNumShardBits, false, 1);
+  ASSERT_EQ(-1, Lookup(cache, 100));
+
+  Insert(cache, 100, 101);
+  ASSERT_EQ(101, Lookup(cache, 100));
+  ASSERT_EQ(-1,  Lookup(cache, 200));
+
+  Insert(cache, 200, 201);
+  Insert(cache, 100, 102);
+  ASSERT_EQ(102, Lookup(cache, 100));
+  ASSERT_EQ(201, Lookup(cache, 200));
+
+  ASSERT_EQ(1U, deleted_keys_.size());
+  ASSERT_EQ(100, deleted_keys_[0]);
+  ASSERT_EQ(101, deleted_values_[0]);
+
+  Erase(cache, 100);
+  ASSERT_EQ(-1, Lookup(cache, 100));
+  ASSERT_EQ(2U, deleted_keys_.size());
+  ASSERT_EQ(1U, cache->GetUsage());
+}
+
+TEST_F(CacheTest, ClockEntriesArePinned) {
+  auto cache = NewClockCache(kCacheSize, 0, false, 1);
+  Insert(cache, 100, 101);
+  Cache::Handle* h1 = cache->Lookup(EncodeKey(100), kTestQueryId);
+  ASSERT_EQ(101, DecodeValue(cache->Value(h1)));
+
+  Insert(cache, 100, 102);
+  Cache::Handle* h2 = cache->Lookup(EncodeKey(100), kTestQueryId);
+  ASSERT_EQ(102, DecodeValue(cache->Value(h2)));
+  ASSERT_EQ(0U, deleted_keys_.size());
+  ASSERT_EQ(2U, cache->GetUsage());
+  ASSERT_EQ(2U, cache->GetPinnedUsage());
+
+  cache->Release(h1);
+  ASSERT_EQ(1U, deleted_keys_.size());
+  ASSERT_EQ(101, deleted_values_[0]);
+  ASSERT_EQ(1U, cache->GetUsage());
+
+  // Pinned entries survive eviction.
+  for (int i = 0; i < kCacheSize + 100; i++) {
+    Insert(cache, 1000 + i, 2000 + i);
+  }
+  ASSERT_EQ(102, DecodeValue(cache->Value(h2)));
+  ASSERT_EQ(102, Lookup(cache, 100));
+  cache->Release(h2);
+  ASSERT_LE(cache->GetUsage(), static_cast<size_t>(kCacheSize));
+}
+
+TEST_F(CacheTest, ClockEvictionPolicyMultiTouch) {
+  auto cache = NewClockCache(kCacheSize, 0, false, 1);
+  QueryId qid1 = 1000;
+  QueryId qid2 = 1001;
+  QueryId qid3 = 1002;
+  Insert(cache, 100, 101, 1, qid1);
+  ASSERT_FALSE(LookupAndCheckInMultiTouch(cache, 100, 101, qid1));
+  ASSERT_TRUE(LookupAndCheckInMultiTouch(cache, 100, 101, qid2));
+  Insert(cache, 200, 201, 1, qid3);
+  ASSERT_FALSE(LookupAndCheckInMultiTouch(cache, 200, 201, qid3));
+
+  // A scan that touches each of its entries many times must not push out the multi-touch entry,
+  // which is touched by other queries from time to time.
+  for (int i = 0; i < 3 * kCacheSize; i++) {
+    Insert(cache, 1000 + i, 2000 + i);
+    ASSERT_EQ(2000 + i, Lookup(cache, 1000 + i));
+    ASSERT_EQ(2000 + i, Lookup(cache, 1000 + i));
+    if (i % (kCacheSize / 2) == 0) {
+      ASSERT_TRUE(LookupAndCheckInMultiTouch(cache, 100, 101, qid2));
+    }
+  }
+  ASSERT_TRUE(LookupAndCheckInMultiTouch(cache, 100, 101, qid2));
+  ASSERT_EQ(-1, Lookup(cache, 200));
+  ASSERT_LE(cache->GetUsage(), static_cast<size_t>(kCacheSize));
+}
+
+TEST_F(CacheTest, ClockStrictCapacityLimit) {
+  auto cache = NewClockCache(5, 0, true, 1);
+  std::vector<Cache::Handle*> handles;
+  for (int i = 0; i < 5; i++) {
+    Cache::Handle* handle;
+    ASSERT_OK(cache->Insert(EncodeKey(i), kTestQueryId, EncodeValue(i), 1, &CacheTest::Deleter,
+                            &handle));
+    handles.push_back(handle);
+  }
+  Cache::Handle* handle = nullptr;
+  Status s = cache->Insert(EncodeKey(5), kTestQueryId, EncodeValue(5), 1, &CacheTest::Deleter,
+                           &handle);
+  ASSERT_TRUE(s.IsIncomplete());
+  ASSERT_EQ(nullptr, handle);
+  ASSERT_EQ(5U, cache->GetUsage());
+
+  for (auto h : handles) {
+    cache->Release(h);
+  }
+  ASSERT_OK(Insert(cache, 5, 5));
+  ASSERT_EQ(5, Lookup(cache, 5));
+  ASSERT_EQ(5U, cache->GetUsage());
+}
+
+TEST_F(CacheTest, ClockConcurrent) {
+  constexpr int kNumThreads = 8;
+  constexpr int kNumKeys = kCacheSize * 2;
+  constexpr int kOpsPerThread = 20000;
+  auto cache = NewClockCache(kCacheSize, 0, false, 1);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kNumThreads; t++) {
+    threads.emplace_back([&cache, t] {
+      Random rnd(t + 1);
+      for (int i = 0; i < kOpsPerThread; i++) {
+        const int key = rnd.Uniform(kNumKeys);
+        switch (rnd.Uniform(3)) {
+          case 0:
+            cache->Insert(EncodeKey(key), t, EncodeValue(key), 1, &dumbDeleter);
+            break;
+          case 1: {
+            Cache::Handle* handle = cache->Lookup(EncodeKey(key), t);
+            if (handle != nullptr) {
+              ASSERT_EQ(key, DecodeValue(cache->Value(handle)));
+              cache->Release(handle);
+            }
+            break;
+          }
+          default:
+            cache->Erase(EncodeKey(key));
+        }
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  ASSERT_LE(cache->GetUsage(), static_cast<size_t>(kCacheSize));
+  ASSERT_EQ(0U, cache->GetPinnedUsage());
+}
+
 }  // namespace rocksdb
 
 int main(int argc, char** argv) {
@@ -0,0 +1,680 @@
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+
+#include <string.h>
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+
+#include <gflags/gflags.h>
+
+#include "yb/util/metrics.h"
+#include "yb/rocksdb/cache.h"
+#include "yb/rocksdb/statistics.h"
+#include "yb/rocksdb/util/hash.h"
+#include "yb/rocksdb/util/statistics.h"
+
+DECLARE_double(cache_single_touch_ratio);
+
+namespace rocksdb {
+
+namespace {
+
+// CLOCK cache implementation.
+//
+// Each shard keeps its entries in a fixed size open addressing table with linear probing. Slots
+// are never deallocated, only reused, so Lookup could walk the table without taking any lock: the
+// slot state and the number of external references are packed into a single atomic word, and a
+// reader pins a slot by incrementing its reference count before looking at the key.
+//
+// Slot states:
+// Empty        - slot is free.
+// Construction - slot is exclusively owned by a thread that fills or frees it. Reference counter
+//                is meaningless in this state, readers that speculatively increment it don't undo
+//                the increment.
+// Visible      - slot holds an entry that could be found by Lookup.
+// Invisible    - slot holds an entry that was erased or replaced, but is still referenced.
+//
+// Eviction is done by a clock hand that is shared by all threads of the shard. Each entry has a
+// small countdown that is decremented when the hand passes over it, and the entry is evicted when
+// the hand finds it unreferenced with a zero countdown. Lookup resets the countdown, instead of
+// moving the entry in a list as the LRU cache does.
+//
+// Scan resistance follows the LRU cache: an entry is single-touch until it is looked up by a
+// query other than the one that added it (or it was added with kInMultiTouchId). Single-touch
+// entries get a countdown of 1, so a scan can only hold them for one turn of the clock hand, while
+// multi-touch entries get kMaxCountdown.
+//
+// Two concurrent inserts of the same key could both become visible. Lookup returns one of them and
+// the other one is evicted in due course.
+
+constexpr uint64_t kOneRef = 1;
+constexpr int kRefsBits = 30;
+constexpr uint64_t kRefsMask = (1ULL << kRefsBits) - 1;
+
+constexpr int kCountdownShift = kRefsBits;
+constexpr uint64_t kMaxCountdown = 3;
+constexpr uint64_t kCountdownMask = kMaxCountdown << kCountdownShift;
+
+constexpr int kStateShift = 61;
+constexpr uint64_t kStateOccupiedBit = 0b100;
+constexpr uint64_t kStateShareableBit = 0b010;
+constexpr uint64_t kStateVisibleBit = 0b001;
+
+constexpr uint64_t kStateEmpty = 0;
+constexpr uint64_t kStateConstruction = kStateOccupiedBit;
+constexpr uint64_t kStateInvisible = kStateOccupiedBit | kStateShareableBit;
+constexpr uint64_t kStateVisible = kStateOccupiedBit | kStateShareableBit | kStateVisibleBit;
+
+// Slots are allocated for this fraction of the expected number of entries.
+constexpr double kLoadFactor = 0.7;
+// Inserts start to evict entries when this fraction of slots is occupied, regardless of charge.
+constexpr double kMaxLoadFactor = 0.9;
+
+inline uint64_t GetState(uint64_t meta) {
+  return meta >> kStateShift;
+}
+
+inline uint64_t GetRefs(uint64_t meta) {
+  return meta & kRefsMask;
+}
+
+inline uint64_t GetCountdown(uint64_t meta) {
+  return (meta & kCountdownMask) >> kCountdownShift;
+}
+
+inline uint64_t MakeMeta(uint64_t state, uint64_t countdown, uint64_t refs) {
+  return (state << kStateShift) | (countdown << kCountdownShift) | refs;
+}
+
+struct ClockHandle {
+  std::atomic<uint64_t> meta{0};
+  // Number of entries that are placed after this slot in the probe sequence starting at their
+  // home slot. Lookup could stop at a slot that does not match and has no displacements.
+  std::atomic<uint32_t> displacements{0};
+  uint32_t hash = 0;
+  // The following fields are only written in the Construction state, and only read by threads that
+  // hold a reference. charge and query_id are atomic because statistics and promotion to the
+  // multi-touch state access them concurrently.
+  std::atomic<size_t> charge{0};
+  std::atomic<QueryId> query_id{kDefaultQueryId};
+  void* value = nullptr;
+  void (*deleter)(const Slice&, void* value) = nullptr;
+  std::unique_ptr<char[]> key_data;
+  size_t key_length = 0;
+
+  Slice key() const {
+    return Slice(key_data.get(), key_length);
+  }
+
+  SubCacheType GetSubCacheType() const {
+    return query_id.load(std::memory_order_relaxed) == kInMultiTouchId ? MULTI_TOUCH
+                                                                        : SINGLE_TOUCH;
+  }
+};
+
+// A single shard of sharded cache.
+class ClockCacheShard {
+ public:
+  ClockCacheShard() {}
+  ~ClockCacheShard();
+
+  // Separate from constructor so caller can easily make an array of ClockCacheShard.
+  void Init(size_t capacity, size_t estimated_entry_charge, bool strict_capacity_limit);
+
+  void SetCapacity(size_t capacity);
+
+  void SetStrictCapacityLimit(bool strict_capacity_limit) {
+    strict_capacity_limit_.store(strict_capacity_limit, std::memory_order_relaxed);
+  }
+
+  void SetMetrics(shared_ptr<yb::CacheMetrics> metrics) {
+    metrics_ = metrics;
+  }
+
+  // Like Cache methods, but with an extra "hash" parameter.
+  Status Insert(const Slice& key, uint32_t hash, const QueryId query_id,
+                void* value, size_t charge, void (*deleter)(const Slice& key, void* value),
+                Cache::Handle** handle, Statistics* statistics);
+  Cache::Handle* Lookup(const Slice& key, uint32_t hash, const QueryId query_id,
+                        Statistics* statistics);
+  void Release(Cache::Handle* handle);
+  void Erase(const Slice& key, uint32_t hash);
+
+  size_t GetUsage() const {
+    return usage_.load(std::memory_order_relaxed);
+  }
+
+  // This is an estimate, since entries are pinned and unpinned without any synchronization.
+  size_t GetPinnedUsage() const;
+
+  void ApplyToAllCacheEntries(void (*callback)(void*, size_t));
+
+ private:
+  // Returns visible entry with the specified key and takes a reference to it, or nullptr when
+  // there is no such entry.
+  ClockHandle* FindVisible(const Slice& key, uint32_t hash);
+
+  // Drops a reference, freeing the entry when it was the last reference to an erased entry.
+  void Unref(ClockHandle* h);
+
+  // Hides the entry from lookups and drops the reference acquired by FindVisible.
+  void EraseVisible(ClockHandle* h);
+
+  // Frees the entry if its meta is still equal to expected_meta. Returns true on success.
+  bool TryFree(ClockHandle* h, uint64_t expected_meta, size_t* charge);
+
+  // Runs the clock hand until at least bytes_needed bytes and slots_needed slots are freed, or
+  // until the hand passed over each slot enough times to drop all countdowns to zero.
+  void Evict(size_t bytes_needed, size_t slots_needed);
+
+  void UpdateUsageMetrics(SubCacheType subcache_type, int64_t delta);
+
+  std::unique_ptr<ClockHandle[]> table_;
+  size_t length_ = 0;
+  size_t occupancy_limit_ = 0;
+
+  std::atomic<size_t> capacity_{0};
+  std::atomic<bool> strict_capacity_limit_{false};
+  std::atomic<size_t> usage_{0};
+  std::atomic<size_t> occupancy_{0};
+  std::atomic<size_t> clock_hand_{0};
+
+  shared_ptr<yb::CacheMetrics> metrics_;
+};
+
+ClockCacheShard::~ClockCacheShard() {
+  for (size_t i = 0; i < length_; ++i) {
+    ClockHandle* h = &table_[i];
+    if (GetState(h->meta.load(std::memory_order_relaxed)) & kStateShareableBit) {
+      (*h->deleter)(h->key(), h->value);
+      UpdateUsageMetrics(h->GetSubCacheType(), -static_cast<int64_t>(h->charge.load()));
+    }
+  }
+}
+
+void ClockCacheShard::Init(
+    size_t capacity, size_t estimated_entry_charge, bool strict_capacity_limit) {
+  const double expected_entries = static_cast<double>(capacity) / estimated_entry_charge;
+  length_ = 16;
+  while (length_ * kLoadFactor < expected_entries) {
+    length_ *= 2;
+  }
+  occupancy_limit_ = static_cast<size_t>(length_ * kMaxLoadFactor);
+  table_.reset(new ClockHandle[length_]);
+  capacity_.store(capacity, std::memory_order_relaxed);
+  strict_capacity_limit_.store(strict_capacity_limit, std::memory_order_relaxed);
+}
+
+void ClockCacheShard::SetCapacity(size_t capacity) {
+  capacity_.store(capacity, std::memory_order_relaxed);
+  const size_t usage = usage_.load(std::memory_order_relaxed);
+  if (usage > capacity) {
+    Evict(usage - capacity, 0);
+  }
+}
+
+void ClockCacheShard::UpdateUsageMetrics(SubCacheType subcache_type, int64_t delta) {
+  if (metrics_ == nullptr) {
+    return;
+  }
+  if (subcache_type == MULTI_TOUCH) {
+    metrics_->multi_touch_cache_usage->IncrementBy(delta);
+  } else {
+    metrics_->single_touch_cache_usage->IncrementBy(delta);
+  }
+  metrics_->cache_usage->IncrementBy(delta);
+}
+
+ClockHandle* ClockCacheShard::FindVisible(const Slice& key, uint32_t hash) {
+  const size_t mask = length_ - 1;
+  for (size_t probe = 0; probe < length_; ++probe) {
+    ClockHandle* h = &table_[(hash + probe) & mask];
+    if (GetState(h->meta.load(std::memory_order_relaxed)) == kStateVisible) {
+      const uint64_t old_meta = h->meta.fetch_add(kOneRef, std::memory_order_acquire);
+      const uint64_t state = GetState(old_meta);
+      if (state == kStateVisible) {
+        if (h->hash == hash && h->key() == key) {
+          return h;
+        }
+        Unref(h);
+      } else if (state == kStateInvisible) {
+        Unref(h);
+      }
+      // In other states the reference counter is ignored, so there is nothing to undo.
+    }
+    if (h->displacements.load(std::memory_order_relaxed) == 0) {
+      break;
+    }
+  }
+  return nullptr;
+}
+
+void ClockCacheShard::Unref(ClockHandle* h) {
+  const uint64_t old_meta = h->meta.fetch_sub(kOneRef, std::memory_order_release);
+  DCHECK_GT(GetRefs(old_meta), 0);
+  if (GetRefs(old_meta) == 1 && GetState(old_meta) == kStateInvisible) {
+    size_t charge;
+    TryFree(h, old_meta - kOneRef, &charge);
+  }
+}
+
+bool ClockCacheShard::TryFree(ClockHandle* h, uint64_t expected_meta, size_t* charge) {
+  DCHECK_EQ(GetRefs(expected_meta), 0);
+  if (!h->meta.compare_exchange_strong(
+          expected_meta, MakeMeta(kStateConstruction, 0, 0), std::memory_order_acq_rel)) {
+    return false;
+  }
+  *charge = h->charge.load(std::memory_order_relaxed);
+  const SubCacheType subcache_type = h->GetSubCacheType();
+  (*h->deleter)(h->key(), h->value);
+  h->key_data.reset();
+  h->value = nullptr;
+
+  // This entry does not displace anything anymore.
+  const size_t mask = length_ - 1;
+  for (size_t i = h->hash & mask; &table_[i] != h; i = (i + 1) & mask) {
+    table_[i].displacements.fetch_sub(1, std::memory_order_relaxed);
+  }
+
+  usage_.fetch_sub(*charge, std::memory_order_relaxed);
+  UpdateUsageMetrics(subcache_type, -static_cast<int64_t>(*charge));
+  h->meta.store(MakeMeta(kStateEmpty, 0, 0), std::memory_order_release);
+  occupancy_.fetch_sub(1, std::memory_order_relaxed);
+  return true;
+}
+
+void ClockCacheShard::Evict(size_t bytes_needed, size_t slots_needed) {
+  const size_t mask = length_ - 1;
+  const size_t max_steps = (kMaxCountdown + 1) * length_;
+  size_t freed_bytes = 0;
+  size_t freed_slots = 0;
+  for (size_t step = 0;
+       step < max_steps && (freed_bytes < bytes_needed || freed_slots < slots_needed);
+       ++step) {
+    ClockHandle* h = &table_[clock_hand_.fetch_add(1, std::memory_order_relaxed) & mask];
+    uint64_t meta = h->meta.load(std::memory_order_acquire);
+    if (!(GetState(meta) & kStateShareableBit) || GetRefs(meta) > 0) {
+      continue;
+    }
+    if (GetState(meta) == kStateVisible && GetCountdown(meta) > 0) {
+      // When this fails, the entry was just touched, so it is not a candidate anyway.
+      h->meta.compare_exchange_strong(
+          meta, meta - (1ULL << kCountdownShift), std::memory_order_relaxed);
+      continue;
+    }
+    size_t charge;
+    if (TryFree(h, meta, &charge)) {
+      freed_bytes += charge;
+      ++freed_slots;
+    }
+  }
+}
+
+Status ClockCacheShard::Insert(const Slice& key, uint32_t hash, const QueryId query_id,
+                               void* value, size_t charge,
+                               void (*deleter)(const Slice& key, void* value),
+                               Cache::Handle** handle, Statistics* statistics) {
+  SubCacheType subcache_type = SINGLE_TOUCH;
+  QueryId effective_query_id = query_id;
+  if (FLAGS_cache_single_touch_ratio == 0 ||
+      (query_id == kInMultiTouchId && FLAGS_cache_single_touch_ratio != 1)) {
+    subcache_type = MULTI_TOUCH;
+  }
+
+  // Hide the entry being replaced, it is freed when its last reference is released. As in the LRU
+  // cache, replacing an entry added by another query counts as a second touch.
+  ClockHandle* old = FindVisible(key, hash);
+  if (old != nullptr) {
+    const QueryId old_query_id = old->query_id.load(std::memory_order_relaxed);
+    if (FLAGS_cache_single_touch_ratio != 1 &&
+        (old_query_id == kInMultiTouchId || old_query_id != query_id)) {
+      subcache_type = MULTI_TOUCH;
+    }
+    EraseVisible(old);
+  }
+  if (subcache_type == MULTI_TOUCH) {
+    effective_query_id = kInMultiTouchId;
+  }
+
+  const size_t capacity = capacity_.load(std::memory_order_relaxed);
+  const size_t new_usage = usage_.fetch_add(charge, std::memory_order_relaxed) + charge;
+  const size_t new_occupancy = occupancy_.fetch_add(1, std::memory_order_relaxed) + 1;
+  if (new_usage > capacity || new_occupancy > occupancy_limit_) {
+    Evict(new_usage > capacity ? new_usage - capacity : 0,
+          new_occupancy > occupancy_limit_ ? 1 : 0);
+  }
+
+  ClockHandle* h = nullptr;
+  const size_t mask = length_ - 1;
+  size_t probe = 0;
+  // Even without strict capacity limit we cannot fill the table completely, since Lookup relies on
+  // empty slots to stop probing.
+  if (occupancy_.load(std::memory_order_relaxed) <= occupancy_limit_ &&
+      (!strict_capacity_limit_.load(std::memory_order_relaxed) ||
+       usage_.load(std::memory_order_relaxed) <= capacity)) {
+    for (; probe < length_; ++probe) {
+      ClockHandle* candidate = &table_[(hash + probe) & mask];
+      const uint64_t old_meta = candidate->meta.fetch_or(
+          kStateOccupiedBit << kStateShift, std::memory_order_acq_rel);
+      if (GetState(old_meta) == kStateEmpty) {
+        h = candidate;
+        break;
+      }
+      candidate->displacements.fetch_add(1, std::memory_order_relaxed);
+    }
+  }
+
+  if (h == nullptr) {
+    for (size_t i = 0; i < probe; ++i) {
+      table_[(hash + i) & mask].displacements.fetch_sub(1, std::memory_order_relaxed);
+    }
+    usage_.fetch_sub(charge, std::memory_order_relaxed);
+    occupancy_.fetch_sub(1, std::memory_order_relaxed);
+    if (handle == nullptr) {
+      (*deleter)(key, value);
+    } else {
+      *handle = nullptr;
+    }
+    RecordTick(statistics, BLOCK_CACHE_ADD_FAILURES);
+    return STATUS(Incomplete, "Insert failed due to CLOCK cache being full.");
+  }
+
+  h->hash = hash;
+  h->key_data.reset(new char[key.size()]);
+  memcpy(h->key_data.get(), key.data(), key.size());
+  h->key_length = key.size();
+  h->value = value;
+  h->deleter = deleter;
+  h->charge.store(charge, std::memory_order_relaxed);
+  h->query_id.store(effective_query_id, std::memory_order_relaxed);
+  h->meta.store(
+      MakeMeta(kStateVisible, subcache_type == MULTI_TOUCH ? kMaxCountdown : 1,
+               handle == nullptr ? 0 : 1),
+      std::memory_order_release);
+  if (handle != nullptr) {
+    *handle = reinterpret_cast<Cache::Handle*>(h);
+  }
+
+  if (statistics != nullptr) {
+    RecordTick(statistics, BLOCK_CACHE_ADD);
+    RecordTick(statistics, BLOCK_CACHE_BYTES_WRITE, charge);
+    if (subcache_type == SubCacheType::SINGLE_TOUCH) {
+      RecordTick(statistics, BLOCK_CACHE_SINGLE_TOUCH_ADD);
+      RecordTick(statistics, BLOCK_CACHE_SINGLE_TOUCH_BYTES_WRITE, charge);
+    } else {
+      RecordTick(statistics, BLOCK_CACHE_MULTI_TOUCH_ADD);
+      RecordTick(statistics, BLOCK_CACHE_MULTI_TOUCH_BYTES_WRITE, charge);
+    }
+  }
+  UpdateUsageMetrics(subcache_type, charge);
+  return Status::OK();
+}
+
+Cache::Handle* ClockCacheShard::Lookup(const Slice& key, uint32_t hash, const QueryId query_id,
+                                       Statistics* statistics) {
+  ClockHandle* h = FindVisible(key, hash);
+  if (h != nullptr) {
+    const size_t charge = h->charge.load(std::memory_order_relaxed);
+    // Touch from a different query moves the entry to the multi-touch state.
+    QueryId old_query_id = h->query_id.load(std::memory_order_relaxed);
+    if (FLAGS_cache_single_touch_ratio < 1 && old_query_id != kInMultiTouchId &&
+        old_query_id != query_id &&
+        h->query_id.compare_exchange_strong(old_query_id, kInMultiTouchId)) {
+      if (metrics_) {
+        metrics_->multi_touch_cache_usage->IncrementBy(charge);
+        metrics_->single_touch_cache_usage->DecrementBy(charge);
+      }
+    }
+    const SubCacheType subcache_type = h->GetSubCacheType();
+    const uint64_t countdown = subcache_type == MULTI_TOUCH ? kMaxCountdown : 1;
+    if (GetCountdown(h->meta.load(std::memory_order_relaxed)) < countdown) {
+      h->meta.fetch_or(countdown << kCountdownShift, std::memory_order_relaxed);
+    }
+
+    if (statistics != nullptr) {
+      RecordTick(statistics, BLOCK_CACHE_HIT);
+      RecordTick(statistics, BLOCK_CACHE_BYTES_READ, charge);
+      if (subcache_type == SubCacheType::SINGLE_TOUCH) {
+        RecordTick(statistics, BLOCK_CACHE_SINGLE_TOUCH_HIT);
+        RecordTick(statistics, BLOCK_CACHE_SINGLE_TOUCH_BYTES_READ, charge);
+      } else {
+        RecordTick(statistics, BLOCK_CACHE_MULTI_TOUCH_HIT);
+        RecordTick(statistics, BLOCK_CACHE_MULTI_TOUCH_BYTES_READ, charge);
+      }
+    }
+  } else {
+    RecordTick(statistics, BLOCK_CACHE_MISS);
+  }
+
+  if (metrics_ != nullptr) {
+    metrics_->lookups->Increment();
+    if (h != nullptr) {
+      metrics_->cache_hits->Increment();
+    } else {
+      metrics_->cache_misses->Increment();
+    }
+  }
+  return reinterpret_cast<Cache::Handle*>(h);
+}
+
+void ClockCacheShard::Release(Cache::Handle* handle) {
+  if (handle == nullptr) {
+    return;
+  }
+  Unref(reinterpret_cast<ClockHandle*>(handle));
+}
+
+void ClockCacheShard::Erase(const Slice& key, uint32_t hash) {
+  ClockHandle* h = FindVisible(key, hash);
+  if (h != nullptr) {
+    EraseVisible(h);
+  }
+}
+
+void ClockCacheShard::EraseVisible(ClockHandle* h) {
+  uint64_t meta = h->meta.load(std::memory_order_relaxed);
+  while (GetState(meta) == kStateVisible &&
+         !h->meta.compare_exchange_weak(
+             meta, meta & ~(kStateVisibleBit << kStateShift), std::memory_order_acq_rel)) {
+  }
+  Unref(h);
+}
+
+size_t ClockCacheShard::GetPinnedUsage() const {
+  size_t usage = 0;
+  for (size_t i = 0; i < length_; ++i) {
+    const uint64_t meta = table_[i].meta.load(std::memory_order_relaxed);
+    if ((GetState(meta) & kStateShareableBit) && GetRefs(meta) > 0) {
+      usage += table_[i].charge.load(std::memory_order_relaxed);
+    }
+  }
+  return usage;
+}
+
+void ClockCacheShard::ApplyToAllCacheEntries(void (*callback)(void*, size_t)) {
+  for (size_t i = 0; i < length_; ++i) {
+    ClockHandle* h = &table_[i];
+    if (!(GetState(h->meta.load(std::memory_order_relaxed)) & kStateShareableBit)) {
+      continue;
+    }
+    const uint64_t old_meta = h->meta.fetch_add(kOneRef, std::memory_order_acquire);
+    if (GetState(old_meta) & kStateShareableBit) {
+      callback(h->value, h->charge.load(std::memory_order_relaxed));
+      Unref(h);
+    }
+  }
+}
+
+class ShardedClockCache : public Cache {
+ private:
+  ClockCacheShard* shards_;
+  std::atomic<uint64_t> last_id_;
+  int num_shard_bits_;
+  std::atomic<size_t> capacity_;
+  std::atomic<bool> strict_capacity_limit_;
+  shared_ptr<yb::CacheMetrics> metrics_;
+
+  static inline uint32_t HashSlice(const Slice& s) {
+    return Hash(s.data(), s.size(), 0);
+  }
+
+  uint32_t Shard(uint32_t hash) const {
+    // Note, hash >> 32 yields hash in gcc, not the zero we expect!
+    return (num_shard_bits_ > 0) ? (hash >> (32 - num_shard_bits_)) : 0;
+  }
+
+  int NumShards() const {
+    return 1 << num_shard_bits_;
+  }
+
+  bool IsValidQueryId(const QueryId query_id) {
+    return query_id >= 0 || query_id == kInMultiTouchId || query_id == kNoCacheQueryId;
+  }
+
+ public:
+  ShardedClockCache(size_t capacity, int num_shard_bits, bool strict_capacity_limit,
+                    size_t estimated_entry_charge)
+      : last_id_(0),
+        num_shard_bits_(num_shard_bits),
+        capacity_(capacity),
+        strict_capacity_limit_(strict_capacity_limit) {
+    shards_ = new ClockCacheShard[NumShards()];
+    const size_t per_shard = (capacity + (NumShards() - 1)) / NumShards();
+    for (int s = 0; s < NumShards(); s++) {
+      shards_[s].Init(per_shard, estimated_entry_charge, strict_capacity_limit);
+    }
+  }
+
+  virtual ~ShardedClockCache() {
+    delete[] shards_;
+  }
+
+  void SetCapacity(size_t capacity) override {
+    const size_t per_shard = (capacity + (NumShards() - 1)) / NumShards();
+    for (int s = 0; s < NumShards(); s++) {
+      shards_[s].SetCapacity(per_shard);
+    }
+    capacity_ = capacity;
+  }
+
+  void SetStrictCapacityLimit(bool strict_capacity_limit) override {
+    for (int s = 0; s < NumShards(); s++) {
+      shards_[s].SetStrictCapacityLimit(strict_capacity_limit);
+    }
+    strict_capacity_limit_ = strict_capacity_limit;
+  }
+
+  Status Insert(const Slice& key, const QueryId query_id, void* value, size_t charge,
+                void (*deleter)(const Slice& key, void* value),
+                Handle** handle, Statistics* statistics) override {
+    DCHECK(IsValidQueryId(query_id));
+    // Queries with no cache query ids are not cached.
+    if (query_id == kNoCacheQueryId) {
+      return Status::OK();
+    }
+    const uint32_t hash = HashSlice(key);
+    return shards_[Shard(hash)].Insert(key, hash, query_id, value, charge, deleter,
+                                       handle, statistics);
+  }
+
+  Handle* Lookup(const Slice& key, const QueryId query_id, Statistics* statistics) override {
+    DCHECK(IsValidQueryId(query_id));
+    if (query_id == kNoCacheQueryId) {
+      return nullptr;
+    }
+    const uint32_t hash = HashSlice(key);
+    return shards_[Shard(hash)].Lookup(key, hash, query_id, statistics);
+  }
+
+  void Release(Handle* handle) override {
+    ClockHandle* h = reinterpret_cast<ClockHandle*>(handle);
+    shards_[Shard(h->hash)].Release(handle);
+  }
+
+  void Erase(const Slice& key) override {
+    const uint32_t hash = HashSlice(key);
+    shards_[Shard(hash)].Erase(key, hash);
+  }
+
+  void* Value(Handle* handle) override {
+    return reinterpret_cast<ClockHandle*>(handle)->value;
+  }
+
+  uint64_t NewId() override {
+    return last_id_.fetch_add(1, std::memory_order_relaxed) + 1;
+  }
+
+  size_t GetCapacity() const override { return capacity_; }
+
+  bool HasStrictCapacityLimit() const override {
+    return strict_capacity_limit_;
+  }
+
+  size_t GetUsage() const override {
+    size_t usage = 0;
+    for (int s = 0; s < NumShards(); s++) {
+      usage += shards_[s].GetUsage();
+    }
+    return usage;
+  }
+
+  size_t GetUsage(Handle* handle) const override {
+    return reinterpret_cast<ClockHandle*>(handle)->charge.load(std::memory_order_relaxed);
+  }
+
+  size_t GetPinnedUsage() const override {
+    size_t usage = 0;
+    for (int s = 0; s < NumShards(); s++) {
+      usage += shards_[s].GetPinnedUsage();
+    }
+    return usage;
+  }
+
+  SubCacheType GetSubCacheType(Handle* e) const override {
+    return reinterpret_cast<ClockHandle*>(e)->GetSubCacheType();
+  }
+
+  void DisownData() override {
+    shards_ = nullptr;
+  }
+
+  // Entries are always visited safely, so thread_safe is ignored.
+  void ApplyToAllCacheEntries(void (*callback)(void*, size_t), bool thread_safe) override {
+    for (int s = 0; s < NumShards(); s++) {
+      shards_[s].ApplyToAllCacheEntries(callback);
+    }
+  }
+
+  void SetMetrics(const scoped_refptr<yb::MetricEntity>& entity,
+                  yb::CacheTier tier) override {
+    metrics_ = std::make_shared<yb::CacheMetrics>(entity, tier);
+    for (int s = 0; s < NumShards(); s++) {
+      shards_[s].SetMetrics(metrics_);
+    }
+  }
+};
+
+}  // end anonymous namespace
+
+shared_ptr<Cache> NewClockCache(size_t capacity, int num_shard_bits, bool strict_capacity_limit,
+                                size_t estimated_entry_charge) {
+  if (num_shard_bits >= 20 || estimated_entry_charge == 0) {
+    return nullptr;
+  }
+  return std::make_shared<ShardedClockCache>(capacity, num_shard_bits, strict_capacity_limit,
+                                             estimated_entry_charge);
+}
+
+}  // namespace rocksdb
@@ -464,6 +464,10 @@ class ReadaheadRandomAccessFile : public RandomAccessFile {
 
   void Hint(AccessPattern pattern) override { file_->Hint(pattern); }
 
+  Status Readahead(uint64_t offset, size_t n) override {
+    return file_->Readahead(offset, n);
+  }
+
   Status InvalidateCache(size_t offset, size_t length) override {
     return file_->InvalidateCache(offset, length);
   }
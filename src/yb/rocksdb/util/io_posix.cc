@@ -223,6 +223,24 @@ void PosixRandomAccessFile::Hint(AccessPattern pattern) {
   }
 }
 
+Status PosixRandomAccessFile::Readahead(uint64_t offset, size_t n) {
+#ifndef OS_LINUX
+  return Status::OK();
+#else
+  if (!use_os_buffer_) {
+    // Pages would be dropped right after the read anyway.
+    return Status::OK();
+  }
+  // POSIX_FADV_WILLNEED only schedules reads into the page cache and returns without waiting
+  // for them to complete.
+  int ret = Fadvise(fd_, offset, n, POSIX_FADV_WILLNEED);
+  if (ret == 0) {
+    return Status::OK();
+  }
+  return IOError(filename_, ret);
+#endif
+}
+
 Status PosixRandomAccessFile::InvalidateCache(size_t offset, size_t length) {
 #ifndef OS_LINUX
   return Status::OK();
@@ -77,6 +77,7 @@ class PosixRandomAccessFile : public RandomAccessFile {
   virtual size_t GetUniqueId(char* id, size_t max_size) const override;
 #endif
   virtual void Hint(AccessPattern pattern) override;
+  virtual Status Readahead(uint64_t offset, size_t n) override;
   virtual Status InvalidateCache(size_t offset, size_t length) override;
 };
 
@@ -288,6 +288,7 @@ DBOptions::DBOptions()
       write_thread_max_yield_usec(100),
       write_thread_slow_yield_usec(3),
       skip_stats_update_on_db_open(false),
+      skip_checking_sst_file_sizes_on_db_open(false),
       wal_recovery_mode(WALRecoveryMode::kTolerateCorruptedTailRecords),
       row_cache(nullptr),
 #ifndef ROCKSDB_LITE
@@ -408,6 +409,8 @@ void DBOptions::Dump(Logger* log) const {
       write_thread_max_yield_usec);
   RHEADER(log, "            Options.write_thread_slow_yield_usec: %" PRIu64,
       write_thread_slow_yield_usec);
+  RHEADER(log, "              Options.memtable_insert_chunk_size: %" PRIu64,
+      memtable_insert_chunk_size);
     if (row_cache) {
       RHEADER(log, "                               Options.row_cache: %" PRIu64,
           row_cache->GetCapacity());
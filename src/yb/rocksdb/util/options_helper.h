@@ -218,6 +218,9 @@ static std::unordered_map<std::string, OptionTypeInfo> db_options_type_info = {
     {"skip_stats_update_on_db_open",
      {offsetof(struct DBOptions, skip_stats_update_on_db_open),
       OptionType::kBoolean, OptionVerificationType::kNormal}},
+    {"skip_checking_sst_file_sizes_on_db_open",
+     {offsetof(struct DBOptions, skip_checking_sst_file_sizes_on_db_open),
+      OptionType::kBoolean, OptionVerificationType::kNormal}},
     {"new_table_reader_for_compaction_inputs",
      {offsetof(struct DBOptions, new_table_reader_for_compaction_inputs),
       OptionType::kBoolean, OptionVerificationType::kNormal}},
@@ -344,6 +347,9 @@ static std::unordered_map<std::string, OptionTypeInfo> db_options_type_info = {
     {"max_file_size_for_compaction",
      {offsetof(struct DBOptions, max_file_size_for_compaction),
       OptionType::kUInt64T, OptionVerificationType::kNormal}},
+    {"memtable_insert_chunk_size",
+     {offsetof(struct DBOptions, memtable_insert_chunk_size),
+      OptionType::kUInt64T, OptionVerificationType::kNormal}},
 };
 
 static std::unordered_map<std::string, OptionTypeInfo> cf_options_type_info = {
@@ -555,6 +561,18 @@ static std::unordered_map<std::string,
     {"min_keys_per_index_block",
      {offsetof(struct BlockBasedTableOptions, min_keys_per_index_block), OptionType::kSizeT,
       OptionVerificationType::kNormal}},
+    {"initial_auto_readahead_size",
+     {offsetof(struct BlockBasedTableOptions, initial_auto_readahead_size), OptionType::kSizeT,
+      OptionVerificationType::kNormal}},
+    {"max_auto_readahead_size",
+     {offsetof(struct BlockBasedTableOptions, max_auto_readahead_size), OptionType::kSizeT,
+      OptionVerificationType::kNormal}},
+    {"use_data_block_hash_index",
+     {offsetof(struct BlockBasedTableOptions, use_data_block_hash_index), OptionType::kBoolean,
+      OptionVerificationType::kNormal}},
+    {"data_block_hash_table_util_ratio",
+     {offsetof(struct BlockBasedTableOptions, data_block_hash_table_util_ratio),
+      OptionType::kDouble, OptionVerificationType::kNormal}},
     {"filter_policy",
      {offsetof(struct BlockBasedTableOptions, filter_policy),
       OptionType::kFilterPolicy, OptionVerificationType::kByName}},
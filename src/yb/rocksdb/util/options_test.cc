@@ -1622,6 +1622,8 @@ Status GetFromString(BlockBasedTableOptions* source, BlockBasedTableOptions* des
       "block_cache=1M;block_cache_compressed=1k;block_size=1024;filter_block_size=16384;"
       "block_size_deviation=8;block_restart_interval=4; "
       "index_block_restart_interval=4;index_block_size=16384;min_keys_per_index_block=16;"
+      "initial_auto_readahead_size=4096;max_auto_readahead_size=65536;"
+      "use_data_block_hash_index=1;data_block_hash_table_util_ratio=0.5;"
       "filter_policy=bloomfilter:4:true;whole_key_filtering=1;"
       "skip_table_builder_flush=1;format_version=1;"
       "hash_index_allow_collision=false;";
@@ -1661,6 +1663,7 @@ Status GetFromString(DBOptions* source, DBOptions* destination) {
       "new_table_reader_for_compaction_inputs=true;"
       "keep_log_file_num=4890;"
       "skip_stats_update_on_db_open=true;"
+      "skip_checking_sst_file_sizes_on_db_open=true;"
       "max_manifest_file_size=4295009941;"
       "db_log_dir=path/to/db_log_dir;"
       "skip_log_error_on_recovery=true;"
@@ -1696,6 +1699,7 @@ Status GetFromString(DBOptions* source, DBOptions* destination) {
       "access_hint_on_compaction_start=NONE;"
       "max_file_size_for_compaction=123;"
       "initial_seqno=432;"
+      "memtable_insert_chunk_size=2048;"
       "num_reserved_small_compaction_threads=-1;"
       "compaction_size_threshold_bytes=18446744073709551615;"
       "info_log_level=DEBUG_LEVEL;";
@@ -1924,6 +1928,7 @@ TEST_F(OptionsParserTest, DBOptionsAllFieldsSettable) {
       BLACKLIST_ENTRY(DBOptions, wal_filter),
       BLACKLIST_ENTRY(DBOptions, boundary_extractor),
       BLACKLIST_ENTRY(DBOptions, mem_table_flush_filter_factory),
+      BLACKLIST_ENTRY(DBOptions, memtable_insert_pool),
   };
 
   TestAllFieldsSettable<DBOptions>(kDBOptionsBlacklist);
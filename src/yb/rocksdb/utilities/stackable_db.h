@@ -265,6 +265,10 @@ class StackableDB : public DB {
     db_->GetLiveFilesMetaData(metadata);
   }
 
+  yb::Result<std::string> GetMiddleKey() override {
+    return db_->GetMiddleKey();
+  }
+
   UserFrontierPtr GetFlushedFrontier() override {
     return db_->GetFlushedFrontier();
   }
@@ -273,6 +277,10 @@ class StackableDB : public DB {
     return db_->SetFlushedFrontier(std::move(values));
   }
 
+  CHECKED_STATUS ResetFlushedFrontier(UserFrontierPtr values) override {
+    return db_->ResetFlushedFrontier(std::move(values));
+  }
+
   virtual void GetColumnFamilyMetaData(
       ColumnFamilyHandle *column_family,
       ColumnFamilyMetaData* cf_meta) override {
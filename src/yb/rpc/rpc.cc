@@ -32,6 +32,7 @@
 
 #include "yb/rpc/rpc.h"
 
+#include <algorithm>
 #include <functional>
 #include <string>
 #include <thread>
@@ -42,6 +43,7 @@
 #include "yb/rpc/messenger.h"
 #include "yb/rpc/rpc_header.pb.h"
 
+#include "yb/util/flag_tags.h"
 #include "yb/util/random_util.h"
 #include "yb/util/tsan_util.h"
 
@@ -54,6 +56,11 @@ DEFINE_int64(rpcs_shutdown_extra_delay_ms, 5000 * yb::kTimeMultiplier,
              "Extra allowed time for a single RPC command to complete after its deadline.");
 DEFINE_int64(retryable_rpc_single_call_timeout_ms, 5000 * yb::kTimeMultiplier,
              "Timeout of single RPC call in retryable RPC command.");
+DEFINE_int32(retryable_rpc_max_busy_backoff_ms, 1000,
+             "Max delay before retrying RPC command rejected by busy server. The delay doubles "
+             "with each attempt until it reaches this value.");
+TAG_FLAG(retryable_rpc_max_busy_backoff_ms, advanced);
+TAG_FLAG(retryable_rpc_max_busy_backoff_ms, runtime);
 
 namespace yb {
 
@@ -74,7 +81,7 @@ bool RpcRetrier::HandleResponse(RpcCommand* rpc, Status* out_status) {
     if (err &&
         err->has_code() &&
         err->code() == ErrorStatusPB::ERROR_SERVER_TOO_BUSY) {
-      auto status = DelayedRetry(rpc, controller_status);
+      auto status = DelayedRetry(rpc, controller_status, BackoffStrategy::kExponential);
       if (!status.ok()) {
         *out_status = status;
         return false;
@@ -87,15 +94,30 @@ bool RpcRetrier::HandleResponse(RpcCommand* rpc, Status* out_status) {
   return false;
 }
 
-Status RpcRetrier::DelayedRetry(RpcCommand* rpc, const Status& why_status) {
-  if (!why_status.ok() && (last_error_.ok() || last_error_.IsTimedOut())) {
-    last_error_ = why_status;
-  }
+Status RpcRetrier::DelayedRetry(
+    RpcCommand* rpc, const Status& why_status, BackoffStrategy strategy) {
   // Add some jitter to the retry delay.
   //
   // If the delay causes us to miss our deadline, RetryCb will fail the
   // RPC on our behalf.
-  int num_ms = attempt_num_++ + RandomUniformInt(0, 4);
+  int num_ms;
+  if (strategy == BackoffStrategy::kExponential) {
+    // Randomize the second half of the delay, so clients rejected at the same time do not
+    // retry at the same time.
+    int max_delay_ms = std::max(FLAGS_retryable_rpc_max_busy_backoff_ms, 1);
+    int delay_ms = std::min(1 << std::min(attempt_num_, 20), max_delay_ms);
+    num_ms = delay_ms / 2 + RandomUniformInt(0, delay_ms - delay_ms / 2);
+  } else {
+    num_ms = attempt_num_ + RandomUniformInt(0, 4);
+  }
+  return DelayedRetry(rpc, why_status, MonoDelta::FromMilliseconds(num_ms));
+}
+
+Status RpcRetrier::DelayedRetry(RpcCommand* rpc, const Status& why_status, MonoDelta delay) {
+  if (!why_status.ok() && (last_error_.ok() || last_error_.IsTimedOut())) {
+    last_error_ = why_status;
+  }
+  ++attempt_num_;
 
   RpcRetrierState expected_state = RpcRetrierState::kIdle;
   while (!state_.compare_exchange_strong(expected_state, RpcRetrierState::kWaiting)) {
@@ -111,7 +133,7 @@ Status RpcRetrier::DelayedRetry(RpcCommand* rpc, const Status& why_status) {
     }
   }
   task_id_ = messenger_->ScheduleOnReactor(
-      std::bind(&RpcRetrier::DoRetry, this, rpc, _1), MonoDelta::FromMilliseconds(num_ms));
+      std::bind(&RpcRetrier::DoRetry, this, rpc, _1), delay);
   return Status::OK();
 }
 
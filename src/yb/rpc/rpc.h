@@ -80,6 +80,11 @@ class RpcCommand : public std::enable_shared_from_this<RpcCommand> {
 
 YB_DEFINE_ENUM(RpcRetrierState, (kIdle)(kRunning)(kWaiting)(kFinished));
 
+// How the delay before the next retry grows with the attempt number.
+// kLinear is used for transient failures like leader changes, kExponential for overloaded
+// servers, so retries do not add more load to them.
+YB_DEFINE_ENUM(BackoffStrategy, (kLinear)(kExponential));
+
 // Provides utilities for retrying failed RPCs.
 //
 // All RPCs should use HandleResponse() to retry certain generic errors.
@@ -111,7 +116,11 @@ class RpcRetrier {
   // deadline has already expired at the time that Retry() was called.
   //
   // Callers should ensure that 'rpc' remains alive.
-  CHECKED_STATUS DelayedRetry(RpcCommand* rpc, const Status& why_status);
+  CHECKED_STATUS DelayedRetry(RpcCommand* rpc, const Status& why_status,
+                              BackoffStrategy strategy = BackoffStrategy::kLinear);
+
+  // Retries an RPC after the specified delay, e.g. the one suggested by the server.
+  CHECKED_STATUS DelayedRetry(RpcCommand* rpc, const Status& why_status, MonoDelta delay);
 
   RpcController* mutable_controller() { return &controller_; }
   const RpcController& controller() const { return controller_; }
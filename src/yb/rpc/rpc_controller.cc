@@ -79,6 +79,20 @@ void RpcController::Reset() {
   call_.reset();
 }
 
+void RpcController::ShareFinishedCall(const RpcController& other) {
+  OutboundCallPtr call;
+  {
+    std::lock_guard<simple_spinlock> l(other.lock_);
+    call = other.call_;
+  }
+  CHECK(call && call->IsFinished());
+  std::lock_guard<simple_spinlock> l(lock_);
+  if (call_) {
+    CHECK(finished());
+  }
+  call_ = std::move(call);
+}
+
 bool RpcController::finished() const {
   if (call_) {
     return call_->IsFinished();
@@ -72,6 +72,10 @@ class RpcController {
   // Reset this controller so it may be used with another call.
   void Reset();
 
+  // Makes this controller report the outcome of the finished call made with 'other'. Used when
+  // a single call is made on behalf of several requests, e.g. batched ones.
+  void ShareFinishedCall(const RpcController& other);
+
   // Return true if the call has finished.
   // A call is finished if the server has responded, or if the call
   // has timed out.
@@ -89,6 +89,7 @@ class MonitoredTask : public std::enable_shared_from_this<MonitoredTask> {
     ASYNC_TRY_STEP_DOWN,
     ASYNC_SNAPSHOT_OP,
     ASYNC_COPARTITION_TABLE,
+    ASYNC_SPLIT_TABLET,
   };
 
   virtual Type type() const = 0;
@@ -0,0 +1,80 @@
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+
+#include <gtest/gtest.h>
+
+#include "yb/tablet/key_access_stats.h"
+#include "yb/tablet/tablet.pb.h"
+
+#include "yb/util/format.h"
+#include "yb/util/test_util.h"
+
+DECLARE_int32(key_access_sampling_rate);
+
+namespace yb {
+namespace tablet {
+
+class KeyAccessStatsTest : public YBTest {
+};
+
+TEST_F(KeyAccessStatsTest, SpaceSaving) {
+  SpaceSavingSketch sketch(3);
+  for (int i = 0; i != 100; ++i) {
+    sketch.Add("hot", 1);
+    if (i % 10 == 0) {
+      sketch.Add("warm", 1);
+    }
+    // Cold keys are never seen twice, so they keep replacing each other.
+    sketch.Add(Format("cold$0", i), 1);
+  }
+  ASSERT_EQ(3, sketch.size());
+
+  auto top = sketch.Top(2);
+  ASSERT_EQ(2, top.size());
+  ASSERT_EQ("hot", top[0].key);
+  ASSERT_EQ(100, top[0].count);
+  ASSERT_EQ(0, top[0].error);
+  // Estimated count minus error is a lower bound of the real count, that is at most 10 for any
+  // key except the hot one.
+  ASSERT_GE(top[1].count, 10);
+  ASSERT_LE(top[1].count - top[1].error, 10);
+
+  sketch.Decay();
+  top = sketch.Top(1);
+  ASSERT_EQ("hot", top[0].key);
+  ASSERT_EQ(50, top[0].count);
+}
+
+TEST_F(KeyAccessStatsTest, Sampling) {
+  FLAGS_key_access_sampling_rate = 4;
+  KeyAccessStats stats;
+  for (int i = 0; i != 100; ++i) {
+    if (stats.ShouldSample(KeyAccessType::kWrite)) {
+      stats.Record(KeyAccessType::kWrite, "key");
+    }
+  }
+  ASSERT_EQ(0, stats.num_accesses(KeyAccessType::kRead));
+  ASSERT_EQ(100, stats.num_accesses(KeyAccessType::kWrite));
+
+  KeyAccessStatsPB pb;
+  stats.ToPB(10, &pb);
+  ASSERT_EQ(100, pb.num_writes());
+  ASSERT_EQ(0, pb.top_read_keys_size());
+  ASSERT_EQ(1, pb.top_write_keys_size());
+  ASSERT_EQ("key", pb.top_write_keys(0).key());
+  // 25 sampled writes, each of them estimates 4 writes.
+  ASSERT_EQ(100, pb.top_write_keys(0).count());
+}
+
+} // namespace tablet
+} // namespace yb
@@ -0,0 +1,164 @@
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+
+#include "yb/tablet/key_access_stats.h"
+
+#include <algorithm>
+
+#include <gflags/gflags.h>
+
+#include "yb/tablet/tablet.pb.h"
+
+#include "yb/util/flag_tags.h"
+
+DEFINE_int32(key_access_sampling_rate, 64,
+             "Key of one of this number of tablet reads and writes is recorded to find hot keys. "
+             "0 to disable key sampling.");
+TAG_FLAG(key_access_sampling_rate, advanced);
+TAG_FLAG(key_access_sampling_rate, runtime);
+
+DEFINE_int32(key_access_top_keys_capacity, 32,
+             "Number of keys tracked per tablet and access type to find hot keys.");
+TAG_FLAG(key_access_top_keys_capacity, advanced);
+
+DEFINE_int32(key_access_stats_half_life_secs, 300,
+             "How often counts of hot keys are halved, so keys that are not accessed anymore are "
+             "forgotten. 0 to never decay counts.");
+TAG_FLAG(key_access_stats_half_life_secs, advanced);
+TAG_FLAG(key_access_stats_half_life_secs, runtime);
+
+namespace yb {
+namespace tablet {
+
+namespace {
+
+// Keys longer than this are truncated, so a few huge keys do not bloat the summary.
+constexpr size_t kMaxRecordedKeySize = 256;
+
+MonoTime NextDecay(MonoTime now) {
+  if (FLAGS_key_access_stats_half_life_secs <= 0) {
+    return MonoTime::Max();
+  }
+  return now + MonoDelta::FromSeconds(FLAGS_key_access_stats_half_life_secs);
+}
+
+void EntriesToPB(
+    const std::vector<SpaceSavingSketch::Entry>& entries,
+    google::protobuf::RepeatedPtrField<KeyAccessStatsPB::KeyPB>* out) {
+  for (const auto& entry : entries) {
+    auto* key_pb = out->Add();
+    key_pb->set_key(entry.key);
+    key_pb->set_count(entry.count);
+    key_pb->set_error(entry.error);
+  }
+}
+
+} // namespace
+
+void SpaceSavingSketch::Add(const Slice& key, uint64_t weight) {
+  if (capacity_ == 0) {
+    return;
+  }
+  std::string key_str(key.cdata(), std::min(key.size(), kMaxRecordedKeySize));
+  auto it = index_.find(key_str);
+  if (it != index_.end()) {
+    entries_[it->second].count += weight;
+    return;
+  }
+  if (entries_.size() < capacity_) {
+    index_.emplace(key_str, entries_.size());
+    entries_.push_back(Entry{std::move(key_str), weight, 0});
+    return;
+  }
+  auto min_it = std::min_element(
+      entries_.begin(), entries_.end(),
+      [](const Entry& lhs, const Entry& rhs) { return lhs.count < rhs.count; });
+  index_.erase(min_it->key);
+  index_.emplace(key_str, min_it - entries_.begin());
+  min_it->key = std::move(key_str);
+  min_it->error = min_it->count;
+  min_it->count += weight;
+}
+
+void SpaceSavingSketch::Decay() {
+  for (auto& entry : entries_) {
+    entry.count /= 2;
+    entry.error /= 2;
+  }
+  entries_.erase(
+      std::remove_if(entries_.begin(), entries_.end(),
+                     [](const Entry& entry) { return entry.count == 0; }),
+      entries_.end());
+  RebuildIndex();
+}
+
+void SpaceSavingSketch::RebuildIndex() {
+  index_.clear();
+  for (size_t i = 0; i != entries_.size(); ++i) {
+    index_.emplace(entries_[i].key, i);
+  }
+}
+
+std::vector<SpaceSavingSketch::Entry> SpaceSavingSketch::Top(size_t limit) const {
+  std::vector<Entry> result(entries_);
+  auto middle = result.begin() + std::min(limit, result.size());
+  std::partial_sort(
+      result.begin(), middle, result.end(),
+      [](const Entry& lhs, const Entry& rhs) { return lhs.count > rhs.count; });
+  result.erase(middle, result.end());
+  return result;
+}
+
+KeyAccessStats::KeyAccessStats()
+    : sketches_{{SpaceSavingSketch(FLAGS_key_access_top_keys_capacity),
+                 SpaceSavingSketch(FLAGS_key_access_top_keys_capacity)}},
+      next_decay_(NextDecay(MonoTime::Now())) {
+  for (auto& counter : num_accesses_) {
+    counter.store(0, std::memory_order_relaxed);
+  }
+}
+
+bool KeyAccessStats::ShouldSample(KeyAccessType type) {
+  auto count = num_accesses_[util::to_underlying(type)].fetch_add(1, std::memory_order_relaxed);
+  const int rate = FLAGS_key_access_sampling_rate;
+  return rate > 0 && (count + 1) % rate == 0;
+}
+
+void KeyAccessStats::Record(KeyAccessType type, const Slice& key) {
+  const int rate = FLAGS_key_access_sampling_rate;
+  if (rate <= 0) {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto now = MonoTime::Now();
+  if (now >= next_decay_) {
+    for (auto& sketch : sketches_) {
+      sketch.Decay();
+    }
+    next_decay_ = NextDecay(now);
+  }
+  sketches_[util::to_underlying(type)].Add(key, rate);
+}
+
+void KeyAccessStats::ToPB(size_t limit, KeyAccessStatsPB* out) const {
+  out->set_num_reads(num_accesses(KeyAccessType::kRead));
+  out->set_num_writes(num_accesses(KeyAccessType::kWrite));
+  std::lock_guard<std::mutex> lock(mutex_);
+  EntriesToPB(sketches_[util::to_underlying(KeyAccessType::kRead)].Top(limit),
+              out->mutable_top_read_keys());
+  EntriesToPB(sketches_[util::to_underlying(KeyAccessType::kWrite)].Top(limit),
+              out->mutable_top_write_keys());
+}
+
+}  // namespace tablet
+}  // namespace yb
@@ -0,0 +1,101 @@
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+
+#ifndef YB_TABLET_KEY_ACCESS_STATS_H
+#define YB_TABLET_KEY_ACCESS_STATS_H
+
+#include <array>
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "yb/util/enums.h"
+#include "yb/util/monotime.h"
+#include "yb/util/slice.h"
+
+namespace yb {
+namespace tablet {
+
+class KeyAccessStatsPB;
+
+YB_DEFINE_ENUM(KeyAccessType, (kRead)(kWrite));
+
+// Space-saving summary of the most frequent keys. Keeps at most capacity keys, when a new key
+// does not fit, it replaces the key with the smallest count, and inherits its count as error.
+// So the count of each key is overestimated by at most its error, and any key with the real count
+// above total / capacity is present in the summary.
+class SpaceSavingSketch {
+ public:
+  struct Entry {
+    std::string key;
+    uint64_t count;
+    uint64_t error;
+  };
+
+  explicit SpaceSavingSketch(size_t capacity) : capacity_(capacity) {}
+
+  void Add(const Slice& key, uint64_t weight);
+
+  // Halves all counts, so old accesses are gradually forgotten.
+  void Decay();
+
+  // Returns at most limit entries with the highest counts, in descending order.
+  std::vector<Entry> Top(size_t limit) const;
+
+  size_t size() const { return entries_.size(); }
+
+ private:
+  void RebuildIndex();
+
+  const size_t capacity_;
+  std::vector<Entry> entries_;
+  std::unordered_map<std::string, size_t> index_;
+};
+
+// Sampled access statistics of a tablet, used to find hot tablets and hot keys.
+//
+// All accesses are counted, but the key is recorded only for one of key_access_sampling_rate
+// accesses. Sampled keys are added to the space-saving summary with weight equal to the sampling
+// rate, so counts in the summary estimate the real number of accesses.
+class KeyAccessStats {
+ public:
+  KeyAccessStats();
+
+  // Counts the access and returns true if its key should be recorded. Cheap enough to be called
+  // on every read and write.
+  bool ShouldSample(KeyAccessType type);
+
+  // Records the sampled access of the encoded DocKey.
+  void Record(KeyAccessType type, const Slice& key);
+
+  uint64_t num_accesses(KeyAccessType type) const {
+    return num_accesses_[util::to_underlying(type)].load(std::memory_order_relaxed);
+  }
+
+  // Fills the access counters and at most limit hottest keys of each access type.
+  void ToPB(size_t limit, KeyAccessStatsPB* out) const;
+
+ private:
+  std::array<std::atomic<uint64_t>, kKeyAccessTypeMapSize> num_accesses_;
+
+  mutable std::mutex mutex_;
+  std::array<SpaceSavingSketch, kKeyAccessTypeMapSize> sketches_;
+  MonoTime next_decay_;
+};
+
+}  // namespace tablet
+}  // namespace yb
+
+#endif  // YB_TABLET_KEY_ACCESS_STATS_H
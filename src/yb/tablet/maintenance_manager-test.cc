@@ -41,10 +41,13 @@
 #include "yb/tablet/tablet.pb.h"
 #include "yb/util/mem_tracker.h"
 #include "yb/util/metrics.h"
+#include "yb/util/size_literals.h"
 #include "yb/util/test_macros.h"
 #include "yb/util/test_util.h"
 #include "yb/util/thread.h"
 
+DECLARE_int32(maintenance_manager_io_budget_mb_per_sec);
+
 using yb::tablet::MaintenanceManagerStatusPB;
 using std::shared_ptr;
 using std::vector;
@@ -108,6 +111,7 @@ class TestMaintenanceOp : public MaintenanceOp {
       consumption_(tracker, 500),
       logs_retained_bytes_(0),
       perf_improvement_(0),
+      io_cost_bytes_(0),
       metric_entity_(METRIC_ENTITY_test.Instantiate(&metric_registry_, "test")),
       maintenance_op_duration_(METRIC_maintenance_op_duration.Instantiate(metric_entity_)),
       maintenance_ops_running_(METRIC_maintenance_ops_running.Instantiate(metric_entity_, 0)) {
@@ -140,6 +144,7 @@ class TestMaintenanceOp : public MaintenanceOp {
     stats->set_ram_anchored(consumption_.consumption());
     stats->set_logs_retained_bytes(logs_retained_bytes_);
     stats->set_perf_improvement(perf_improvement_);
+    stats->set_io_cost_bytes(io_cost_bytes_);
   }
 
   void Enable() {
@@ -187,6 +192,11 @@ class TestMaintenanceOp : public MaintenanceOp {
     perf_improvement_ = perf_improvement;
   }
 
+  void set_io_cost_bytes(uint64_t io_cost_bytes) {
+    std::lock_guard<Mutex> guard(lock_);
+    io_cost_bytes_ = io_cost_bytes;
+  }
+
   scoped_refptr<Histogram> DurationHistogram() const override {
     return maintenance_op_duration_;
   }
@@ -202,6 +212,7 @@ class TestMaintenanceOp : public MaintenanceOp {
   ScopedTrackedConsumption consumption_;
   uint64_t logs_retained_bytes_;
   uint64_t perf_improvement_;
+  uint64_t io_cost_bytes_;
   MetricRegistry metric_registry_;
   scoped_refptr<MetricEntity> metric_entity_;
   scoped_refptr<Histogram> maintenance_op_duration_;
@@ -279,6 +290,67 @@ TEST_F(MaintenanceManagerTest, TestLogRetentionPrioritization) {
   manager_->UnregisterOp(&op2);
 }
 
+// Test that ops are ranked by performance improvement per MB of IO, and that high IO ops are not
+// started while the IO budget is exhausted.
+TEST_F(MaintenanceManagerTest, TestIOBudget) {
+  manager_->Shutdown();
+  FLAGS_maintenance_manager_io_budget_mb_per_sec = 1;
+
+  TestMaintenanceOp op1("op1", MaintenanceOp::HIGH_IO_USAGE, OP_RUNNABLE, test_tracker_);
+  op1.set_perf_improvement(10);
+  op1.set_io_cost_bytes(100_MB);
+
+  TestMaintenanceOp op2("op2", MaintenanceOp::HIGH_IO_USAGE, OP_RUNNABLE, test_tracker_);
+  op2.set_perf_improvement(2);
+  op2.set_io_cost_bytes(1_MB);
+
+  manager_->RegisterOp(&op1);
+  manager_->RegisterOp(&op2);
+
+  // op2 has lower perf improvement, but it is much cheaper.
+  ASSERT_EQ(&op2, manager_->FindBestOp());
+
+  manager_->io_budget_bytes_ = -static_cast<int64_t>(1_GB);
+  ASSERT_EQ(nullptr, manager_->FindBestOp());
+  ASSERT_STR_CONTAINS(manager_->last_decision_, "IO budget is exhausted");
+
+  // Low IO ops are not limited by the budget.
+  TestMaintenanceOp op3("op3", MaintenanceOp::LOW_IO_USAGE, OP_RUNNABLE, test_tracker_);
+  op3.set_perf_improvement(1);
+  manager_->RegisterOp(&op3);
+  ASSERT_EQ(&op3, manager_->FindBestOp());
+  manager_->UnregisterOp(&op3);
+
+  FLAGS_maintenance_manager_io_budget_mb_per_sec = 0;
+  ASSERT_EQ(&op2, manager_->FindBestOp());
+
+  manager_->UnregisterOp(&op1);
+  manager_->UnregisterOp(&op2);
+}
+
+// Test that the last free thread runs low IO ops that free log retention, but not high IO ops
+// that only improve performance.
+TEST_F(MaintenanceManagerTest, TestLastThreadRunsLowIOOps) {
+  manager_->Shutdown();
+  manager_->running_ops_ = 1;
+
+  TestMaintenanceOp op1("op1", MaintenanceOp::HIGH_IO_USAGE, OP_RUNNABLE, test_tracker_);
+  op1.set_ram_anchored(0);
+  op1.set_perf_improvement(10);
+  manager_->RegisterOp(&op1);
+  ASSERT_EQ(nullptr, manager_->FindBestOp());
+
+  TestMaintenanceOp op2("op2", MaintenanceOp::LOW_IO_USAGE, OP_RUNNABLE, test_tracker_);
+  op2.set_ram_anchored(0);
+  op2.set_logs_retained_bytes(100);
+  manager_->RegisterOp(&op2);
+  ASSERT_EQ(&op2, manager_->FindBestOp());
+
+  manager_->running_ops_ = 0;
+  manager_->UnregisterOp(&op1);
+  manager_->UnregisterOp(&op2);
+}
+
 // Test adding operations and make sure that the history of recently completed operations
 // is correct in that it wraps around and doesn't grow.
 TEST_F(MaintenanceManagerTest, TestCompletedOpsHistory) {
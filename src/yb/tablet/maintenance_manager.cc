@@ -34,6 +34,7 @@
 
 #include <stdint.h>
 
+#include <algorithm>
 #include <memory>
 #include <string>
 #include <utility>
@@ -54,10 +55,10 @@ using std::pair;
 using std::shared_ptr;
 using strings::Substitute;
 
-DEFINE_int32(maintenance_manager_num_threads, 1,
+DEFINE_int32(maintenance_manager_num_threads, 2,
        "Size of the maintenance manager thread pool. Beyond a value of '1', one thread is "
-       "reserved for emergency flushes. For spinning disks, the number of threads should "
-       "not be above the number of devices.");
+       "reserved for emergency flushes and low IO operations like log GC. For spinning disks, "
+       "the number of threads should not be above the number of devices.");
 TAG_FLAG(maintenance_manager_num_threads, stable);
 
 DEFINE_int32(maintenance_manager_polling_interval_ms, 250,
@@ -69,6 +70,13 @@ DEFINE_int32(maintenance_manager_history_size, 8,
        "Number of completed operations the manager is keeping track of.");
 TAG_FLAG(maintenance_manager_history_size, hidden);
 
+DEFINE_int32(maintenance_manager_io_budget_mb_per_sec, 128,
+       "IO budget of maintenance operations with high IO usage, like flushes and compactions. "
+       "Such operations are not started while the budget is exhausted, unless they are needed "
+       "to free memory. 0 means no limit.");
+TAG_FLAG(maintenance_manager_io_budget_mb_per_sec, advanced);
+TAG_FLAG(maintenance_manager_io_budget_mb_per_sec, runtime);
+
 DEFINE_bool(enable_maintenance_manager, true,
        "Enable the maintenance manager, runs compaction and tablet cleaning tasks.");
 TAG_FLAG(enable_maintenance_manager, unsafe);
@@ -89,6 +97,12 @@ void MaintenanceOpStats::Clear() {
   ram_anchored_ = 0;
   logs_retained_bytes_ = 0;
   perf_improvement_ = 0;
+  io_cost_bytes_ = 0;
+}
+
+double MaintenanceOpStats::score() const {
+  constexpr double kBytesPerMB = 1024.0 * 1024.0;
+  return perf_improvement() / std::max(io_cost_bytes() / kBytesPerMB, 1.0);
 }
 
 MaintenanceOp::MaintenanceOp(std::string name, IOUsage io_usage)
@@ -122,7 +136,10 @@ MaintenanceManager::MaintenanceManager(const Options& options)
           options.polling_interval_ms),
     completed_ops_count_(0),
     parent_mem_tracker_(!options.parent_mem_tracker ?
-        MemTracker::GetRootTracker() : options.parent_mem_tracker) {
+        MemTracker::GetRootTracker() : options.parent_mem_tracker),
+    io_budget_bytes_(
+        static_cast<int64_t>(FLAGS_maintenance_manager_io_budget_mb_per_sec) * 1024 * 1024),
+    io_budget_refill_time_(MonoTime::Now()) {
   CHECK_OK(ThreadPoolBuilder("MaintenanceMgr").set_min_threads(num_threads_)
                .set_max_threads(num_threads_).Build(&thread_pool_));
   uint32_t history_size = options.history_size == 0 ?
@@ -204,9 +221,14 @@ void MaintenanceManager::RunSchedulerThread() {
   MonoDelta polling_interval = MonoDelta::FromMilliseconds(polling_interval_ms_);
 
   std::unique_lock<Mutex> guard(lock_);
+  bool launched = false;
   while (true) {
-    // Loop until we are shutting down or it is time to run another op.
-    cond_.TimedWait(polling_interval);
+    // Loop until we are shutting down or it is time to run another op. After an op was launched,
+    // look for the next one without waiting, so all threads could be used.
+    if (!launched) {
+      cond_.TimedWait(polling_interval);
+    }
+    launched = false;
     if (shutdown_) {
       VLOG_AND_TRACE("maintenance", 1) << "Shutting down maintenance manager.";
       return;
@@ -233,27 +255,53 @@ void MaintenanceManager::RunSchedulerThread() {
       continue;
     }
 
+    if (op->io_usage() == MaintenanceOp::HIGH_IO_USAGE) {
+      auto it = ops_.find(op);
+      if (it != ops_.end() && it->second.valid()) {
+        io_budget_bytes_ -= it->second.io_cost_bytes();
+      }
+    }
+
     // Run the maintenance operation.
     Status s = thread_pool_->SubmitFunc(std::bind(&MaintenanceManager::LaunchOp, this, op));
     CHECK(s.ok());
+    launched = true;
   }
 }
 
+void MaintenanceManager::RefillIOBudget() {
+  const int64_t budget_per_sec =
+      static_cast<int64_t>(FLAGS_maintenance_manager_io_budget_mb_per_sec) * 1024 * 1024;
+  const auto now = MonoTime::Now();
+  const auto elapsed = now.GetDeltaSince(io_budget_refill_time_);
+  io_budget_refill_time_ = now;
+  if (budget_per_sec <= 0) {
+    io_budget_bytes_ = 0;
+    return;
+  }
+  // Budget is not accumulated for more than a second, so an idle period is not followed by a
+  // burst of IO.
+  io_budget_bytes_ = std::min<int64_t>(
+      io_budget_bytes_ + budget_per_sec * elapsed.ToSeconds(), budget_per_sec);
+}
+
 // Finding the best operation goes through four filters:
 // - If there's an Op that we can run quickly that frees log retention, we run it.
 // - If we've hit the overall process memory limit (note: this includes memory that the Ops cannot
 //   free), we run the Op with the highest RAM usage.
 // - If there are Ops that retain logs, we run the one that has the highest retention (and if many
 //   qualify, then we run the one that also frees up the most RAM).
-// - Finally, if there's nothing else that we really need to do, we run the Op that will improve
-//   performance the most.
+// - Finally, if there's nothing else that we really need to do, we run the Op with the best score,
+//   that is the performance improvement per MB of IO it costs.
 //
 // The reason it's done this way is that we want to prioritize limiting the amount of resources we
 // hold on to. Low IO Ops go first since we can quickly run them, then we can look at memory usage.
 // Reversing those can starve the low IO Ops when the system is under intense memory pressure.
 //
-// In the third priority we're at a point where nothing's urgent and there's nothing we can run
-// quickly.
+// High IO Ops are only started by the last two filters while there is IO budget left. When there
+// is more than one thread, the last thread is reserved for Ops that free memory and for low IO Ops
+// that free log retention, so log GC is not blocked by a long flush.
+//
 // TODO We currently optimize for freeing log retention but we could consider having some sort of
 // sliding priority between log retention and RAM usage. For example, is an Op that frees
 // 128MB of log retention and 12MB of RAM always better than an op that frees 12MB of log retention
@@ -261,14 +309,21 @@ void MaintenanceManager::RunSchedulerThread() {
 MaintenanceOp* MaintenanceManager::FindBestOp() {
   TRACE_EVENT0("maintenance", "MaintenanceManager::FindBestOp");
   if (!FLAGS_enable_maintenance_manager) {
-    VLOG_AND_TRACE("maintenance", 1) << "Maintenance manager is disabled. Doing nothing";
+    last_decision_ = "Maintenance manager is disabled";
+    VLOG_AND_TRACE("maintenance", 1) << last_decision_;
     return nullptr;
   }
   size_t free_threads = num_threads_ - running_ops_;
   if (free_threads == 0) {
-    VLOG_AND_TRACE("maintenance", 1) << "there are no free threads, so we can't run anything.";
+    last_decision_ = "There are no free threads";
+    VLOG_AND_TRACE("maintenance", 1) << last_decision_;
     return nullptr;
   }
+  const bool only_free_memory = num_threads_ > 1 && free_threads == 1;
+
+  RefillIOBudget();
+  const bool io_budget_exhausted =
+      FLAGS_maintenance_manager_io_budget_mb_per_sec > 0 && io_budget_bytes_ <= 0;
 
   int64_t low_io_most_logs_retained_bytes = 0;
   MaintenanceOp* low_io_most_logs_retained_bytes_op = nullptr;
@@ -280,6 +335,7 @@ MaintenanceOp* MaintenanceManager::FindBestOp() {
   int64_t most_logs_retained_bytes_ram_anchored = 0;
   MaintenanceOp* most_logs_retained_bytes_op = nullptr;
 
+  double best_score = 0;
   double best_perf_improvement = 0;
   MaintenanceOp* best_perf_improvement_op = nullptr;
   for (OpMapTy::value_type &val : ops_) {
@@ -301,6 +357,10 @@ MaintenanceOp* MaintenanceManager::FindBestOp() {
       most_mem_anchored_op = op;
       most_mem_anchored = stats.ram_anchored();
     }
+
+    if (op->io_usage_ == MaintenanceOp::HIGH_IO_USAGE && io_budget_exhausted) {
+      continue;
+    }
     // We prioritize ops that can free more logs, but when it's the same we pick the one that
     // also frees up the most memory.
     if (stats.logs_retained_bytes() > 0 &&
@@ -311,21 +371,20 @@ MaintenanceOp* MaintenanceManager::FindBestOp() {
       most_logs_retained_bytes = stats.logs_retained_bytes();
       most_logs_retained_bytes_ram_anchored = stats.ram_anchored();
     }
-    if ((!best_perf_improvement_op) ||
-        (stats.perf_improvement() > best_perf_improvement)) {
+    if ((!best_perf_improvement_op) || (stats.score() > best_score)) {
       best_perf_improvement_op = op;
       best_perf_improvement = stats.perf_improvement();
+      best_score = stats.score();
     }
   }
 
   // Look at ops that we can run quickly that free up log retention.
   if (low_io_most_logs_retained_bytes_op) {
     if (low_io_most_logs_retained_bytes > 0) {
-      VLOG_AND_TRACE("maintenance", 1)
-                    << "Performing " << low_io_most_logs_retained_bytes_op->name() << ", "
-                    << "because it can free up more logs "
-                    << "at " << low_io_most_logs_retained_bytes
-                    << " bytes with a low IO cost";
+      last_decision_ = Substitute(
+          "Performing $0, because it can free up more logs at $1 bytes with a low IO cost",
+          low_io_most_logs_retained_bytes_op->name(), low_io_most_logs_retained_bytes);
+      VLOG_AND_TRACE("maintenance", 1) << last_decision_;
       return low_io_most_logs_retained_bytes_op;
     }
   }
@@ -335,34 +394,46 @@ MaintenanceOp* MaintenanceManager::FindBestOp() {
   double capacity_pct;
   if (parent_mem_tracker_->AnySoftLimitExceeded(&capacity_pct)) {
     if (!most_mem_anchored_op) {
-      string msg = StringPrintf("we have exceeded our soft memory limit "
+      last_decision_ = StringPrintf("we have exceeded our soft memory limit "
           "(current capacity is %.2f%%).  However, there are no ops currently "
           "runnable which would free memory.", capacity_pct);
-      LOG(INFO) << msg;
+      LOG(INFO) << last_decision_;
       return nullptr;
     }
-    VLOG_AND_TRACE("maintenance", 1) << "we have exceeded our soft memory limit "
-            << "(current capacity is " << capacity_pct << "%).  Running the op "
-            << "which anchors the most memory: " << most_mem_anchored_op->name();
+    last_decision_ = StringPrintf(
+        "we have exceeded our soft memory limit (current capacity is %.2f%%).  Running the op "
+        "which anchors the most memory: %s", capacity_pct, most_mem_anchored_op->name().c_str());
+    VLOG_AND_TRACE("maintenance", 1) << last_decision_;
     return most_mem_anchored_op;
   }
 
+  if (only_free_memory) {
+    last_decision_ = "The last free thread is reserved for ops that free memory or logs cheaply";
+    VLOG_AND_TRACE("maintenance", 2) << last_decision_;
+    return nullptr;
+  }
+
   if (most_logs_retained_bytes_op) {
-    VLOG_AND_TRACE("maintenance", 1)
-            << "Performing " << most_logs_retained_bytes_op->name() << ", "
-            << "because it can free up more logs " << "at " << most_logs_retained_bytes
-            << " bytes";
+    last_decision_ = Substitute(
+        "Performing $0, because it can free up more logs at $1 bytes",
+        most_logs_retained_bytes_op->name(), most_logs_retained_bytes);
+    VLOG_AND_TRACE("maintenance", 1) << last_decision_;
     return most_logs_retained_bytes_op;
   }
 
   if (best_perf_improvement_op) {
     if (best_perf_improvement > 0) {
-      VLOG_AND_TRACE("maintenance", 1) << "Performing " << best_perf_improvement_op->name() << ", "
-                 << "because it had the best perf_improvement score, "
-                 << "at " << best_perf_improvement;
+      last_decision_ = Substitute(
+          "Performing $0, because it had the best score, at $1, with perf_improvement $2",
+          best_perf_improvement_op->name(), best_score, best_perf_improvement);
+      VLOG_AND_TRACE("maintenance", 1) << last_decision_;
       return best_perf_improvement_op;
     }
   }
+
+  last_decision_ = io_budget_exhausted
+      ? Substitute("IO budget is exhausted, $0 bytes", io_budget_bytes_)
+      : "No maintenance operations look worth doing";
   return nullptr;
 }
 
@@ -407,6 +478,8 @@ void MaintenanceManager::GetMaintenanceManagerStatusDump(MaintenanceManagerStatu
       op_pb->set_ram_anchored_bytes(stat.ram_anchored());
       op_pb->set_logs_retained_bytes(stat.logs_retained_bytes());
       op_pb->set_perf_improvement(stat.perf_improvement());
+      op_pb->set_io_cost_bytes(stat.io_cost_bytes());
+      op_pb->set_score(stat.score());
     } else {
       op_pb->set_runnable(false);
       op_pb->set_ram_anchored_bytes(0);
@@ -419,6 +492,11 @@ void MaintenanceManager::GetMaintenanceManagerStatusDump(MaintenanceManagerStatu
     }
   }
 
+  out_pb->set_last_decision(last_decision_);
+  out_pb->set_io_budget_bytes(io_budget_bytes_);
+  out_pb->set_num_threads(num_threads_);
+  out_pb->set_running_ops(running_ops_);
+
   for (const CompletedOp& completed_op : completed_ops_) {
     if (!completed_op.name.empty()) {
       MaintenanceManagerStatusPB_CompletedOpPB* completed_pb = out_pb->add_completed_operations();
@@ -104,6 +104,19 @@ class MaintenanceOpStats {
     perf_improvement_ = perf_improvement;
   }
 
+  uint64_t io_cost_bytes() const {
+    DCHECK(valid_);
+    return io_cost_bytes_;
+  }
+
+  void set_io_cost_bytes(uint64_t io_cost_bytes) {
+    UpdateLastModified();
+    io_cost_bytes_ = io_cost_bytes;
+  }
+
+  // Perf improvement per MB of I/O, used to rank ops that improve performance.
+  double score() const;
+
   const MonoTime& last_modified() const {
     DCHECK(valid_);
     return last_modified_;
@@ -138,6 +151,10 @@ class MaintenanceOpStats {
   // absolute scale (yet TBD).
   double perf_improvement_;
 
+  // The approximate number of bytes that the op would read and write. Ops with high IO usage
+  // are charged this amount against the IO budget of the maintenance manager.
+  uint64_t io_cost_bytes_;
+
   // The last time that the stats were modified.
   MonoTime last_modified_;
 };
@@ -261,14 +278,20 @@ class MaintenanceManager : public std::enable_shared_from_this<MaintenanceManage
 
  private:
   FRIEND_TEST(MaintenanceManagerTest, TestLogRetentionPrioritization);
+  FRIEND_TEST(MaintenanceManagerTest, TestIOBudget);
+  FRIEND_TEST(MaintenanceManagerTest, TestLastThreadRunsLowIOOps);
   typedef std::map<MaintenanceOp*, MaintenanceOpStats,
           MaintenanceOpComparator> OpMapTy;
 
   void RunSchedulerThread();
 
-  // find the best op, or null if there is nothing we want to run
+  // find the best op, or null if there is nothing we want to run. The reason of the decision is
+  // stored to last_decision_.
   MaintenanceOp* FindBestOp();
 
+  // Adds IO budget accumulated since the last refill.
+  void RefillIOBudget();
+
   void LaunchOp(MaintenanceOp* op);
 
   const int32_t num_threads_;
@@ -286,6 +309,14 @@ class MaintenanceManager : public std::enable_shared_from_this<MaintenanceManage
   int64_t completed_ops_count_;
   std::shared_ptr<MemTracker> parent_mem_tracker_;
 
+  // Bytes of IO that high IO ops could use, refilled at maintenance_manager_io_budget_mb_per_sec.
+  // Could be negative after an op, that costs more than the available budget, was started.
+  int64_t io_budget_bytes_ = 0;
+  MonoTime io_budget_refill_time_;
+
+  // Why FindBestOp picked its last op, or why it did not pick any.
+  std::string last_decision_;
+
   DISALLOW_COPY_AND_ASSIGN(MaintenanceManager);
 };
 
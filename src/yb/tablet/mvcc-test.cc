@@ -30,10 +30,12 @@
 // under the License.
 //
 
+#include <thread>
 #include <vector>
 
 #include <boost/scope_exit.hpp>
 
+#include <gflags/gflags.h>
 #include <gtest/gtest.h>
 #include <glog/logging.h>
 
@@ -49,6 +51,13 @@ using std::vector;
 using yb::util::to_underlying;
 using yb::server::LogicalClock;
 
+DECLARE_int32(mvcc_queue_capacity);
+
+DEFINE_int32(mvcc_benchmark_num_readers, 8,
+             "Number of threads reading safe time in MvccTest.BenchmarkConcurrent.");
+DEFINE_int32(mvcc_benchmark_duration_ms, 2000,
+             "Duration of MvccTest.BenchmarkConcurrent in milliseconds.");
+
 namespace yb {
 namespace tablet {
 
@@ -321,5 +330,181 @@ TEST_F(MvccTest, WaitForSafeTime) {
   ASSERT_FALSE(manager_.SafeTime(ht3, MonoTime::Now() + 100ms, HybridTime::kMax));
 }
 
+// Adds more operations than the queue capacity, so they are kept in the overflow queue, and checks
+// that AddPending does not block and safe time respects all of them.
+TEST_F(MvccTest, QueueOverflow) {
+  constexpr int kCapacity = 4;
+  constexpr size_t kTotalEntries = 5 * kCapacity;
+  FLAGS_mvcc_queue_capacity = kCapacity;
+  MvccManager manager(std::string(), clock_.get());
+
+  vector<HybridTime> hts(kTotalEntries);
+  for (auto& ht : hts) {
+    manager.AddPending(&ht);
+    ASSERT_EQ(hts[0].Decremented(), manager.SafeTime());
+  }
+
+  // Abort operations from both the ring buffer and the overflow queue.
+  for (size_t i = 1; i < hts.size(); i += 3) {
+    manager.Aborted(hts[i]);
+  }
+  for (size_t i = 0; i < hts.size(); ++i) {
+    if (i % 3 == 1) {
+      continue;
+    }
+    ASSERT_EQ(hts[i].Decremented(), manager.SafeTime());
+    manager.Replicated(hts[i]);
+    ASSERT_EQ(hts[i], manager.LastReplicatedHybridTime());
+    // Add operations while the overflow queue is being drained, so they are moved back to the
+    // ring buffer.
+    if (i == kCapacity + 1) {
+      HybridTime ht;
+      manager.AddPending(&ht);
+      hts.push_back(ht);
+    }
+  }
+
+  auto now = clock_->Now();
+  ASSERT_EQ(now, manager.SafeTime(now));
+}
+
+// Aborts and replicates operations from different threads, while a third thread keeps adding them
+// to a small queue, so slots of popped operations are reused while other threads scan the queue.
+TEST_F(MvccTest, ConcurrentAbortAndReplicate) {
+  google::FlagSaver flag_saver;
+  FLAGS_mvcc_queue_capacity = 4;
+  MvccManager manager(std::string(), clock_.get());
+
+  constexpr uint64_t kTotalOperations = 200000;
+  constexpr uint64_t kMaxInFlight = 16;
+  struct Entry {
+    std::atomic<HybridTime> ht;
+    std::atomic<bool> abort;
+  };
+  Entry entries[kMaxInFlight];
+  std::atomic<uint64_t> num_added{0};
+  std::atomic<uint64_t> num_abort_processed{0};
+  std::atomic<uint64_t> num_replicate_processed{0};
+
+  std::vector<std::thread> threads;
+  threads.emplace_back([&] {
+    for (uint64_t i = 0; i != kTotalOperations; ++i) {
+      while (i - std::min(num_abort_processed.load(), num_replicate_processed.load()) >=
+                 kMaxInFlight) {
+        std::this_thread::yield();
+      }
+      HybridTime ht;
+      manager.AddPending(&ht);
+      auto& entry = entries[i % kMaxInFlight];
+      entry.ht.store(ht, std::memory_order_relaxed);
+      entry.abort.store(RandomUniformInt(0, 2) == 0, std::memory_order_relaxed);
+      num_added.store(i + 1, std::memory_order_release);
+    }
+  });
+  // Aborts operations as soon as they are added.
+  threads.emplace_back([&] {
+    for (uint64_t i = 0; i != kTotalOperations; ++i) {
+      while (i >= num_added.load(std::memory_order_acquire)) {
+        std::this_thread::yield();
+      }
+      const auto& entry = entries[i % kMaxInFlight];
+      if (entry.abort.load(std::memory_order_relaxed)) {
+        manager.Aborted(entry.ht.load(std::memory_order_relaxed));
+      }
+      num_abort_processed.store(i + 1, std::memory_order_release);
+    }
+  });
+  // Replicates operations in order, after all preceding operations were aborted or replicated.
+  threads.emplace_back([&] {
+    for (uint64_t i = 0; i != kTotalOperations; ++i) {
+      while (i >= num_abort_processed.load(std::memory_order_acquire)) {
+        std::this_thread::yield();
+      }
+      const auto& entry = entries[i % kMaxInFlight];
+      if (!entry.abort.load(std::memory_order_relaxed)) {
+        manager.Replicated(entry.ht.load(std::memory_order_relaxed));
+      }
+      num_replicate_processed.store(i + 1, std::memory_order_release);
+    }
+  });
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  auto now = clock_->Now();
+  ASSERT_EQ(now, manager.SafeTime(now));
+}
+
+// Measures throughput of MVCC manager under load that is typical for a tablet: one thread adds
+// operations, another one replicates them in order, and several threads read safe time.
+TEST_F(MvccTest, BenchmarkConcurrent) {
+  constexpr uint64_t kMaxInFlight = 256;
+  std::atomic<HybridTime> in_flight[kMaxInFlight];
+  std::atomic<uint64_t> num_added{0};
+  std::atomic<uint64_t> num_replicated{0};
+  std::atomic<uint64_t> num_reads{0};
+  std::atomic<bool> stopped{false};
+  std::atomic<bool> writer_done{false};
+
+  std::vector<std::thread> threads;
+  threads.emplace_back([this, &in_flight, &num_added, &num_replicated, &stopped, &writer_done] {
+    while (!stopped.load(std::memory_order_acquire)) {
+      auto added = num_added.load(std::memory_order_relaxed);
+      if (added - num_replicated.load(std::memory_order_acquire) >= kMaxInFlight) {
+        std::this_thread::yield();
+        continue;
+      }
+      HybridTime ht;
+      manager_.AddPending(&ht);
+      in_flight[added % kMaxInFlight].store(ht, std::memory_order_relaxed);
+      num_added.store(added + 1, std::memory_order_release);
+    }
+    writer_done.store(true, std::memory_order_release);
+  });
+  threads.emplace_back([this, &in_flight, &num_added, &num_replicated, &writer_done] {
+    for (;;) {
+      auto replicated = num_replicated.load(std::memory_order_relaxed);
+      if (replicated == num_added.load(std::memory_order_acquire)) {
+        // All added operations should be replicated before exit.
+        if (writer_done.load(std::memory_order_acquire) &&
+            replicated == num_added.load(std::memory_order_acquire)) {
+          break;
+        }
+        std::this_thread::yield();
+        continue;
+      }
+      manager_.Replicated(in_flight[replicated % kMaxInFlight].load(std::memory_order_relaxed));
+      num_replicated.store(replicated + 1, std::memory_order_release);
+    }
+  });
+  for (int i = 0; i != FLAGS_mvcc_benchmark_num_readers; ++i) {
+    threads.emplace_back([this, &num_reads, &stopped] {
+      HybridTime last_safe_time = HybridTime::kMin;
+      uint64_t reads = 0;
+      while (!stopped.load(std::memory_order_acquire)) {
+        auto safe_time = manager_.SafeTime();
+        ASSERT_GE(safe_time, last_safe_time);
+        last_safe_time = safe_time;
+        ++reads;
+      }
+      num_reads.fetch_add(reads, std::memory_order_relaxed);
+    });
+  }
+
+  std::this_thread::sleep_for(FLAGS_mvcc_benchmark_duration_ms * 1ms);
+  stopped.store(true, std::memory_order_release);
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  ASSERT_EQ(num_added.load(), num_replicated.load());
+  const double seconds = FLAGS_mvcc_benchmark_duration_ms / 1000.0;
+  LOG(INFO) << "Readers: " << FLAGS_mvcc_benchmark_num_readers
+            << ", writes/s: " << num_added.load() / seconds
+            << ", reads/s: " << num_reads.load() / seconds;
+  ASSERT_GT(num_added.load(), 0);
+  ASSERT_GT(num_reads.load(), 0);
+}
+
 } // namespace tablet
 } // namespace yb
@@ -32,59 +32,202 @@
 
 #include "yb/tablet/mvcc.h"
 
+#include <algorithm>
+#include <thread>
+
+#include <gflags/gflags.h>
+
+#include "yb/util/atomic.h"
+#include "yb/util/flag_tags.h"
 #include "yb/util/logging.h"
 
+DEFINE_int32(mvcc_queue_capacity, 1024,
+             "Number of operations tracked by MVCC manager of a tablet without locking, rounded "
+             "up to a power of two. Operations added to the full queue are kept in a locked "
+             "overflow queue, until there is room for them.");
+TAG_FLAG(mvcc_queue_capacity, advanced);
+
 namespace yb {
 namespace tablet {
 
+namespace {
+
+uint64_t QueueCapacity() {
+  uint64_t result = 2;
+  while (result < static_cast<uint64_t>(std::max(FLAGS_mvcc_queue_capacity, 0))) {
+    result <<= 1;
+  }
+  return result;
+}
+
+} // namespace
+
 MvccManager::MvccManager(std::string prefix, server::ClockPtr clock)
     : prefix_(std::move(prefix)),
-      clock_(std::move(clock)) {}
+      clock_(std::move(clock)),
+      mask_(QueueCapacity() - 1),
+      slots_(new Slot[mask_ + 1]) {}
 
-void MvccManager::Replicated(HybridTime ht) {
-  VLOG_WITH_PREFIX(1) << __func__ << "(" << ht << ")";
+template <class Predicate>
+bool MvccManager::WaitFor(MonoTime deadline, const Predicate& predicate) const {
+  if (predicate()) {
+    return true;
+  }
+  std::unique_lock<std::mutex> lock(mutex_);
+  // Waiter is registered before the predicate is checked again under the lock, so a thread that
+  // changes the state after this check sees the waiter and notifies it.
+  ++num_waiters_;
+  bool result = true;
+  if (deadline == MonoTime::kMax) {
+    cond_.wait(lock, predicate);
+  } else {
+    result = cond_.wait_until(lock, deadline.ToSteadyTimePoint(), predicate);
+  }
+  --num_waiters_;
+  return result;
+}
 
+void MvccManager::NotifyWaiters() {
+  if (num_waiters_.load() == 0) {
+    return;
+  }
   {
+    // Waiter could be between the predicate check and the wait, so the mutex should be acquired
+    // before notification.
     std::lock_guard<std::mutex> lock(mutex_);
-    CHECK(!queue_.empty()) << LogPrefix();
-    CHECK_EQ(queue_.front(), ht) << LogPrefix();
-    PopFront(&lock);
-    last_replicated_ = ht;
   }
   cond_.notify_all();
 }
 
+void MvccManager::Replicated(HybridTime ht) {
+  VLOG_WITH_PREFIX(1) << __func__ << "(" << ht << ")";
+
+  last_replicated_.store(ht, std::memory_order_release);
+  Done(ht, /* replicated= */ true);
+}
+
 void MvccManager::Aborted(HybridTime ht) {
   VLOG_WITH_PREFIX(1) << __func__ << "(" << ht << ")";
 
-  {
-    std::lock_guard<std::mutex> lock(mutex_);
-    CHECK(!queue_.empty()) << LogPrefix();
-    if (queue_.front() == ht) {
-      PopFront(&lock);
-    } else {
-      aborted_.push(ht);
-      return;
+  Done(ht, /* replicated= */ false);
+}
+
+void MvccManager::Done(HybridTime ht, bool replicated) {
+  if (!MarkDoneInQueue(ht, replicated)) {
+    std::lock_guard<std::mutex> lock(overflow_mutex_);
+    // Operation could be moved from the overflow queue to the ring buffer after we looked there.
+    if (!MarkDoneInQueue(ht, replicated)) {
+      MarkDoneInOverflowUnlocked(ht, replicated);
     }
   }
-  cond_.notify_all();
-}
 
-void MvccManager::PopFront(std::lock_guard<std::mutex>* lock) {
-  queue_.pop_front();
-  CHECK_GE(queue_.size(), aborted_.size()) << LogPrefix();
-  while (!aborted_.empty()) {
-    if (queue_.front() != aborted_.top()) {
-      CHECK_LT(queue_.front(), aborted_.top()) << LogPrefix();
+  // Pop done operations from the front of the queue. Concurrent calls could mark operations done
+  // while we are popping, so the operation at the front is always rechecked after it was marked.
+  for (;;) {
+    auto head = head_.load();
+    if (head == tail_.load() || !slot(head).done.load()) {
       break;
     }
-    queue_.pop_front();
-    aborted_.pop();
+    head_.compare_exchange_strong(head, head + 1);
+  }
+  NotifyWaiters();
+}
+
+bool MvccManager::MarkDoneInQueue(HybridTime ht, bool replicated) {
+  auto index = head_.load();
+  for (;;) {
+    if (index >= tail_.load()) {
+      return false;
+    }
+    auto& current = slot(index);
+    const auto current_ht = current.ht.load(std::memory_order_acquire);
+    if (current_ht == ht) {
+      CHECK(!current.done.exchange(true)) << LogPrefix() << "Operation already done: " << ht;
+      return true;
+    }
+    const bool current_done = current.done.load();
+    // Operations before the head could be popped concurrently and their slots reused by
+    // AddPending, so values read from the slot are used only when it was not popped before the
+    // head was read.
+    auto head = head_.load();
+    if (index < head) {
+      index = head;
+      continue;
+    }
+    if (replicated) {
+      CHECK(current_done) << LogPrefix() << "Replicated " << ht << " before " << current_ht;
+    }
+    ++index;
+  }
+}
+
+void MvccManager::MarkDoneInOverflowUnlocked(HybridTime ht, bool replicated) {
+  auto it = std::find_if(overflow_.begin(), overflow_.end(),
+                         [ht](const OverflowEntry& entry) { return entry.ht == ht; });
+  CHECK(it != overflow_.end()) << LogPrefix() << "Unknown operation: " << ht;
+  CHECK(!it->done) << LogPrefix() << "Operation already done: " << ht;
+  if (replicated) {
+    CHECK(std::all_of(overflow_.begin(), it, [](const OverflowEntry& entry) { return entry.done; }))
+        << LogPrefix() << "Replicated " << ht << " before " << overflow_.front().ht;
+  }
+  it->done = true;
+  while (!overflow_.empty() && overflow_.front().done) {
+    overflow_.pop_front();
+  }
+  has_overflow_.store(!overflow_.empty());
+}
+
+void MvccManager::MoveOverflowToQueueUnlocked() {
+  auto index = tail_.load(std::memory_order_relaxed);
+  while (!overflow_.empty() && index - head_.load() <= mask_) {
+    const auto& entry = overflow_.front();
+    if (!entry.done) {
+      auto& current = slot(index);
+      current.ht.store(entry.ht, std::memory_order_relaxed);
+      current.done.store(false, std::memory_order_relaxed);
+      tail_.store(++index);
+    }
+    overflow_.pop_front();
   }
+  has_overflow_.store(!overflow_.empty());
 }
 
 void MvccManager::AddPending(HybridTime* ht) {
-  std::lock_guard<std::mutex> lock(mutex_);
+  if (!has_overflow_.load()) {
+    const auto index = tail_.load(std::memory_order_relaxed);
+    if (index - head_.load() <= mask_) {
+      AddToQueue(index, ht);
+      return;
+    }
+  }
+
+  // AddPending is invoked under the ReplicaState lock, so it should never wait for operations to
+  // be replicated. When the ring buffer is full, the operation is added to the overflow queue, and
+  // all following operations are added there too, until it is moved to the ring buffer.
+  std::lock_guard<std::mutex> lock(overflow_mutex_);
+  MoveOverflowToQueueUnlocked();
+  const auto index = tail_.load(std::memory_order_relaxed);
+  if (overflow_.empty() && index - head_.load() <= mask_) {
+    AddToQueue(index, ht);
+    return;
+  }
+
+  // Readers that see the empty ring buffer check the overflow queue under the lock, so the flag is
+  // set before the clock is read.
+  has_overflow_.store(true);
+  AssignTime(ht);
+  if (!overflow_.empty()) {
+    CHECK_GT(*ht, overflow_.back().ht) << LogPrefix();
+  } else if (index != head_.load()) {
+    CHECK_GT(*ht, slot(index - 1).ht.load()) << LogPrefix();
+  }
+  overflow_.push_back(OverflowEntry{*ht, false});
+  if (overflow_.size() == 1) {
+    LOG_WITH_PREFIX(WARNING) << "MVCC queue of " << mask_ + 1 << " operations is full";
+  }
+}
+
+void MvccManager::AssignTime(HybridTime* ht) {
   if (ht->is_valid()) {
     // This must be a follower-side transaction with already known hybrid time.
     VLOG_WITH_PREFIX(1) << "AddPending(" << *ht << ")";
@@ -94,151 +237,178 @@ void MvccManager::AddPending(HybridTime* ht) {
     *ht = clock_->Now();
     VLOG_WITH_PREFIX(1) << "AddPending(<invalid>), time from clock: " << *ht;
   }
-  CHECK_GT(*ht, max_safe_time_returned_with_lease_) << LogPrefix();
-  CHECK_GT(*ht, max_safe_time_returned_without_lease_) << LogPrefix();
-  CHECK_GT(*ht, max_safe_time_returned_for_follower_) << LogPrefix();
-  if (!queue_.empty()) {
-    CHECK_GT(*ht, queue_.back()) << LogPrefix();
+  CHECK_GT(*ht, max_safe_time_returned_with_lease_.load()) << LogPrefix();
+  CHECK_GT(*ht, max_safe_time_returned_without_lease_.load()) << LogPrefix();
+  CHECK_GT(*ht, max_safe_time_returned_for_follower_.load()) << LogPrefix();
+  CHECK_GT(*ht, last_replicated_.load()) << LogPrefix();
+}
+
+void MvccManager::AddToQueue(uint64_t index, HybridTime* ht) {
+  auto& current = slot(index);
+  current.ht.store(HybridTime::kInvalid, std::memory_order_relaxed);
+  current.done.store(false, std::memory_order_relaxed);
+  // The operation is reserved before the clock is read, so concurrent SafeTime either sees it in
+  // the queue, or reads the clock before us and gets the lower time.
+  tail_.store(index + 1);
+
+  AssignTime(ht);
+  if (index != head_.load()) {
+    // Only AddPending writes slots, so previous slot was not reused.
+    CHECK_GT(*ht, slot(index - 1).ht.load()) << LogPrefix();
   }
-  CHECK_GT(*ht, last_replicated_) << LogPrefix();
-  queue_.push_back(*ht);
+  current.ht.store(*ht, std::memory_order_release);
 }
 
 void MvccManager::SetLastReplicated(HybridTime ht) {
   VLOG_WITH_PREFIX(1) << __func__ << "(" << ht << ")";
 
-  {
-    std::lock_guard<std::mutex> lock(mutex_);
-    last_replicated_ = ht;
-  }
-  cond_.notify_all();
+  last_replicated_.store(ht, std::memory_order_release);
+  NotifyWaiters();
 }
 
 void MvccManager::SetPropagatedSafeTimeOnFollower(HybridTime ht) {
   VLOG_WITH_PREFIX(1) << __func__ << "(" << ht << ")";
 
-  {
-    std::lock_guard<std::mutex> lock(mutex_);
-    if (ht >= propagated_safe_time_) {
-      propagated_safe_time_ = ht;
-    } else {
-      LOG(WARNING) << "Received propagated safe time " << ht << " less than the old value: "
-                   << propagated_safe_time_ << ". This could happen on followers when a new leader "
-                   << "is elected.";
-    }
+  auto current = propagated_safe_time_.load(std::memory_order_acquire);
+  while (ht >= current && !propagated_safe_time_.compare_exchange_weak(current, ht)) {}
+  if (ht < current) {
+    LOG(WARNING) << "Received propagated safe time " << ht << " less than the old value: "
+                 << current << ". This could happen on followers when a new leader "
+                 << "is elected.";
+    return;
   }
-  cond_.notify_all();
+  NotifyWaiters();
 }
 
 void MvccManager::UpdatePropagatedSafeTimeOnLeader(HybridTime ht_lease) {
   VLOG_WITH_PREFIX(1) << __func__ << "(" << ht_lease << ")";
 
-  {
-    std::unique_lock<std::mutex> lock(mutex_);
-    auto ht = DoGetSafeTime(HybridTime::kMin,  // min_allowed
-                            MonoTime::kMax,    // deadline
-                            ht_lease,
-                            &lock);
-    CHECK_GE(ht, propagated_safe_time_) << LogPrefix();
-    propagated_safe_time_ = ht;
-  }
-  cond_.notify_all();
+  auto ht = DoGetSafeTime(HybridTime::kMin,  // min_allowed
+                          MonoTime::kMax,    // deadline
+                          ht_lease);
+  UpdateAtomicMax(&propagated_safe_time_, ht);
+  NotifyWaiters();
 }
 
 HybridTime MvccManager::SafeTimeForFollower(
     HybridTime min_allowed, MonoTime deadline) const {
-  std::unique_lock<std::mutex> lock(mutex_);
   HybridTime result;
   auto predicate = [this, &result, min_allowed] {
     // last_replicated_ is updated earlier than propagated_safe_time_, so because of concurrency it
     // could be greater than propagated_safe_time_.
-    result = std::max(propagated_safe_time_, last_replicated_);
+    result = std::max(propagated_safe_time_.load(std::memory_order_acquire),
+                      last_replicated_.load(std::memory_order_acquire));
+    result = std::max(result, max_safe_time_returned_for_follower_.load());
     return result >= min_allowed;
   };
-  if (deadline == MonoTime::kMax) {
-    cond_.wait(lock, predicate);
-  } else if (!cond_.wait_until(lock, deadline.ToSteadyTimePoint(), predicate)) {
+  if (!WaitFor(deadline, predicate)) {
     return HybridTime::kInvalid;
   }
   VLOG_WITH_PREFIX(1) << "SafeTimeForFollower(" << min_allowed
                       << "), result = " << result;
-  CHECK_GE(result, max_safe_time_returned_for_follower_) << LogPrefix();
-  max_safe_time_returned_for_follower_ = result;
+  UpdateAtomicMax(&max_safe_time_returned_for_follower_, result);
   return result;
 }
 
 HybridTime MvccManager::SafeTime(HybridTime min_allowed,
                                  MonoTime deadline,
                                  HybridTime ht_lease) const {
-  std::unique_lock<std::mutex> lock(mutex_);
-  return DoGetSafeTime(min_allowed, deadline, ht_lease, &lock);
+  return DoGetSafeTime(min_allowed, deadline, ht_lease);
+}
+
+HybridTime MvccManager::QueueSafeTime() const {
+  HybridTime now = HybridTime::kInvalid;
+  for (;;) {
+    auto tail = tail_.load();
+    auto head = head_.load();
+    if (head == tail) {
+      if (has_overflow_.load()) {
+        auto front = OverflowSafeTime();
+        if (front.is_valid()) {
+          return front;
+        }
+        continue;
+      }
+      if (now.is_valid()) {
+        VLOG_WITH_PREFIX(2) << "DoGetSafeTime, Now: " << now;
+        return now;
+      }
+      // Clock should be read before tail_, so operation that is added concurrently either is
+      // seen in the queue, or receives greater time.
+      now = clock_->Now();
+      continue;
+    }
+    auto front = slot(head).ht.load(std::memory_order_acquire);
+    // Front operation could be popped and its slot reused while we were reading it, or it could
+    // be just reserved by AddPending that did not assign its time yet.
+    if (front.is_valid() && head_.load() == head) {
+      VLOG_WITH_PREFIX(2) << "DoGetSafeTime, Queue front (decremented): " << front.Decremented();
+      return front.Decremented();
+    }
+    std::this_thread::yield();
+  }
+}
+
+HybridTime MvccManager::OverflowSafeTime() const {
+  std::lock_guard<std::mutex> lock(overflow_mutex_);
+  // Operations are moved to the ring buffer under the lock, so if it is still empty, the front of
+  // the overflow queue is the first pending operation.
+  if (head_.load() != tail_.load() || overflow_.empty()) {
+    return HybridTime::kInvalid;
+  }
+  VLOG_WITH_PREFIX(2) << "DoGetSafeTime, Overflow front (decremented): "
+                      << overflow_.front().ht.Decremented();
+  return overflow_.front().ht.Decremented();
 }
 
 HybridTime MvccManager::DoGetSafeTime(const HybridTime min_allowed,
                                       const MonoTime deadline,
-                                      const HybridTime ht_lease,
-                                      std::unique_lock<std::mutex>* lock) const {
-  DCHECK_ONLY_NOTNULL(lock);
+                                      const HybridTime ht_lease) const {
   CHECK(ht_lease.is_valid());
   CHECK_LE(min_allowed, ht_lease) << LogPrefix();
 
   bool has_lease = false;
   if (ht_lease.GetPhysicalValueMicros() < kMaxHybridTimePhysicalMicros) {
-    max_ht_lease_seen_ = std::max(ht_lease, max_ht_lease_seen_);
+    UpdateAtomicMax(&max_ht_lease_seen_, ht_lease);
     has_lease = true;
   }
+  auto& max_safe_time_returned = has_lease ? max_safe_time_returned_with_lease_
+                                           : max_safe_time_returned_without_lease_;
 
   HybridTime result;
-  auto predicate = [this, &result, min_allowed, has_lease] {
-    if (queue_.empty()) {
-      result = clock_->Now();
-      CHECK_GE(result, min_allowed) << LogPrefix();
-      VLOG_WITH_PREFIX(2) << "DoGetSafeTime, Now: " << result;
-    } else {
-      result = queue_.front().Decremented();
-      VLOG_WITH_PREFIX(2) << "DoGetSafeTime, Queue front (decremented): " << result;
-    }
+  auto predicate = [this, &result, min_allowed, has_lease, &max_safe_time_returned] {
+    result = QueueSafeTime();
 
     if (has_lease) {
-      result = std::min(result, max_ht_lease_seen_);
+      result = std::min(result, max_ht_lease_seen_.load(std::memory_order_acquire));
     }
 
     // This function could be invoked at a follower, so it has a very old ht_lease. In this case it
     // is safe to read at least at last_replicated_.
-    result = std::max(result, last_replicated_);
+    result = std::max(result, last_replicated_.load(std::memory_order_acquire));
+
+    // Concurrent reader could already return greater time, that is still safe.
+    result = std::max(result, max_safe_time_returned.load(std::memory_order_acquire));
 
     return result >= min_allowed;
   };
 
   // In the case of an empty queue, the safe hybrid time to read at is only limited by hybrid time
   // ht_lease, which is by definition higher than min_allowed, so we would not get blocked.
-  if (deadline == MonoTime::kMax) {
-    cond_.wait(*lock, predicate);
-  } else if (!cond_.wait_until(*lock, deadline.ToSteadyTimePoint(), predicate)) {
+  if (!WaitFor(deadline, predicate)) {
     return HybridTime::kInvalid;
   }
   VLOG_WITH_PREFIX(1) << "DoGetSafeTime(" << min_allowed << ", "
                       << ht_lease << "), result = " << result;
 
-  CHECK_GE(result, has_lease ? max_safe_time_returned_with_lease_
-                             : max_safe_time_returned_without_lease_) << LogPrefix()
-      << "has_lease=" << has_lease
-      << ", ht_lease=" << ht_lease
-      << ", max_ht_lease_seen_=" << max_ht_lease_seen_
-      << ", last_replicated=" << last_replicated_
-      << ", clock_->Now()=" << clock_->Now();
-  if (has_lease) {
-    max_safe_time_returned_with_lease_ = result;
-  } else {
-    max_safe_time_returned_without_lease_ = result;
-  }
+  UpdateAtomicMax(&max_safe_time_returned, result);
   return result;
 }
 
 HybridTime MvccManager::LastReplicatedHybridTime() const {
-  std::lock_guard<std::mutex> lock(mutex_);
-  VLOG_WITH_PREFIX(1) << __func__ << "(), result = " << last_replicated_;
-  return last_replicated_;
+  auto result = last_replicated_.load(std::memory_order_acquire);
+  VLOG_WITH_PREFIX(1) << __func__ << "(), result = " << result;
+  return result;
 }
 
 }  // namespace tablet
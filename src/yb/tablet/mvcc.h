@@ -32,11 +32,11 @@
 #ifndef YB_TABLET_MVCC_H_
 #define YB_TABLET_MVCC_H_
 
+#include <atomic>
 #include <condition_variable>
-#include <mutex>
 #include <deque>
-#include <queue>
-#include <vector>
+#include <memory>
+#include <mutex>
 
 #include "yb/server/clock.h"
 #include "yb/util/debug-util.h"
@@ -50,6 +50,13 @@ namespace tablet {
 // methods.
 // Operations could be replicated only in the same order as they were added.
 // Time of newly added operation should be after time of all previously added operations.
+//
+// Operations are tracked in a ring buffer without locking. AddPending calls should not be
+// concurrent, the same is true for Replicated calls, while Aborted and safe time queries could be
+// invoked from any thread. Safe time is computed from the front of the ring buffer and published
+// atomically, so readers only take a mutex when they have to wait for safe time that was not
+// reached yet. When the ring buffer is full, new operations are kept in an overflow queue under a
+// mutex, until there is room for them.
 class MvccManager {
  public:
   // `prefix` is used for logging.
@@ -71,8 +78,9 @@ class MvccManager {
   // `ht` is in-out parameter.
   // In case of replica `ht` is already assigned, in case of leader we should assign ht by
   // by ourselves.
-  // We pass ht as pointer here, because clock should be accessed with locked mutex, otherwise
-  // SafeTime could return time greater than added.
+  // We pass ht as pointer here, because clock should be accessed after the operation is reserved
+  // in the queue, otherwise SafeTime could return time greater than added.
+  // Never blocks waiting for other operations, even when the queue is full.
   void AddPending(HybridTime* ht);
 
   // Notifies that operation with appropriate time was replicated.
@@ -114,41 +122,99 @@ class MvccManager {
   HybridTime LastReplicatedHybridTime() const;
 
  private:
+  struct Slot {
+    std::atomic<HybridTime> ht{HybridTime::kInvalid};
+    // Set when operation is replicated or aborted.
+    std::atomic<bool> done{false};
+  };
+
+  struct OverflowEntry {
+    HybridTime ht;
+    bool done;
+  };
+
+  // Assigns time to the operation if it is not assigned yet, and checks that it is after all times
+  // returned as safe.
+  void AssignTime(HybridTime* ht);
+
+  // Adds operation to the ring buffer slot with specified index, that should be free.
+  void AddToQueue(uint64_t index, HybridTime* ht);
+
+  // Moves operations from the front of the overflow queue to the ring buffer, while it has room.
+  void MoveOverflowToQueueUnlocked();
+
   HybridTime DoGetSafeTime(HybridTime min_allowed,
                            MonoTime deadline,
-                           HybridTime ht_lease,
-                           std::unique_lock<std::mutex>* lock) const;
+                           HybridTime ht_lease) const;
+
+  // Returns the front of the queue decremented, or the current time if the queue is empty.
+  HybridTime QueueSafeTime() const;
+
+  // Returns the front of the overflow queue decremented, or invalid time if the ring buffer is not
+  // empty or the overflow queue is empty.
+  HybridTime OverflowSafeTime() const;
+
+  // Marks operation with specified time as done and pops all done operations from the front of
+  // the queue. When `replicated` is true, all preceding operations should be already done.
+  void Done(HybridTime ht, bool replicated);
+
+  // Marks operation as done if it is in the ring buffer, returns false otherwise.
+  bool MarkDoneInQueue(HybridTime ht, bool replicated);
+
+  void MarkDoneInOverflowUnlocked(HybridTime ht, bool replicated);
+
+  // Waits until predicate returns true or deadline is reached, returns the last predicate result.
+  template <class Predicate>
+  bool WaitFor(MonoTime deadline, const Predicate& predicate) const;
+
+  // Wakes up threads blocked in WaitFor, if any.
+  void NotifyWaiters();
+
+  Slot& slot(uint64_t index) const { return slots_[index & mask_]; }
 
   const std::string& LogPrefix() const { return prefix_; }
-  void PopFront(std::lock_guard<std::mutex>* lock);
 
   std::string prefix_;
   server::ClockPtr clock_;
+
+  // Ring buffer of times of tracked operations, ordered by time. Operations in [head_, tail_)
+  // are not popped yet, some of them could be already done, when they were aborted from the middle
+  // of the queue.
+  const uint64_t mask_;
+  std::unique_ptr<Slot[]> slots_;
+  std::atomic<uint64_t> head_{0};
+  // Only updated by AddPending.
+  std::atomic<uint64_t> tail_{0};
+
+  // Operations added while the ring buffer was full, ordered by time and following all operations
+  // of the ring buffer. Done operations are popped from the front.
+  mutable std::mutex overflow_mutex_;
+  std::deque<OverflowEntry> overflow_;
+  // Whether overflow_ is not empty, so readers lock overflow_mutex_ only when they should.
+  std::atomic<bool> has_overflow_{false};
+
+  // Used only to park waiters, the ring buffer is never accessed under it.
   mutable std::mutex mutex_;
   mutable std::condition_variable cond_;
+  mutable std::atomic<size_t> num_waiters_{0};
 
-  // An ordered queue of times of tracked operations.
-  std::deque<HybridTime> queue_;
-
-  // Priority queue of aborted operations. Required because we could abort operations from the
-  // middle of the queue.
-  std::priority_queue<HybridTime, std::vector<HybridTime>, std::greater<>> aborted_;
-
-  HybridTime last_replicated_ = HybridTime::kMin;
+  std::atomic<HybridTime> last_replicated_{HybridTime::kMin};
 
   // If we are a follower, this is the latest safe time sent by the leader to us. If we are the
   // leader, this is a safe time that gets updated every time the majority-replicated watermarks
   // change
-  HybridTime propagated_safe_time_ = HybridTime::kMin;
+  std::atomic<HybridTime> propagated_safe_time_{HybridTime::kMin};
 
   // Because different calls that have current hybrid time leader lease as an argument can come to
   // us out of order, we might see an older value of hybrid time leader lease expiration after a
   // newer value. We mitigate this by always using the highest value we've seen.
-  mutable HybridTime max_ht_lease_seen_ = HybridTime::kMin;
+  mutable std::atomic<HybridTime> max_ht_lease_seen_{HybridTime::kMin};
 
-  mutable HybridTime max_safe_time_returned_with_lease_ = HybridTime::kMin;
-  mutable HybridTime max_safe_time_returned_without_lease_ = HybridTime::kMin;
-  mutable HybridTime max_safe_time_returned_for_follower_ = HybridTime::kMin;
+  // Once time was returned as safe, it stays safe, so concurrent readers never return a value less
+  // than returned before.
+  mutable std::atomic<HybridTime> max_safe_time_returned_with_lease_{HybridTime::kMin};
+  mutable std::atomic<HybridTime> max_safe_time_returned_without_lease_{HybridTime::kMin};
+  mutable std::atomic<HybridTime> max_safe_time_returned_for_follower_{HybridTime::kMin};
 };
 
 }  // namespace tablet
@@ -33,6 +33,7 @@
 #ifndef YB_TABLET_OPERATIONS_OPERATION_H
 #define YB_TABLET_OPERATIONS_OPERATION_H
 
+#include <functional>
 #include <mutex>
 #include <string>
 
@@ -55,7 +56,7 @@ class OperationCompletionCallback;
 class OperationState;
 
 YB_DEFINE_ENUM(OperationType,
-               (kWrite)(kAlterSchema)(kUpdateTransaction)(kSnapshot)(kTruncate)(kEmpty));
+               (kWrite)(kAlterSchema)(kUpdateTransaction)(kSnapshot)(kTruncate)(kSplit)(kEmpty));
 
 // Base class for transactions.  There are different implementations for different types (Write,
 // AlterSchema, etc.) OperationDriver implementations use Operations along with Consensus to execute
@@ -105,6 +106,15 @@ class Operation {
   // transaction type, but usually this is the method where data-structures are changed.
   virtual CHECKED_STATUS Apply() = 0;
 
+  // Same as Apply(), but on_applied is invoked when changes of this operation were actually
+  // applied. Implementations could defer it, for instance when the tablet batches follower applies.
+  // Default implementation applies the operation synchronously.
+  virtual CHECKED_STATUS ApplyBatched(std::function<void()> on_applied) {
+    RETURN_NOT_OK(Apply());
+    on_applied();
+    return Status::OK();
+  }
+
   // Executed after Apply() but before the commit is submitted to consensus.  Some transactions use
   // this to perform pre-commit actions (e.g. write transactions perform early lock release on this
   // hook).  Default implementation does nothing.
@@ -421,13 +421,12 @@ void OperationDriver::ApplyTask() {
   // and end up calling Finalize() while we're still in this code.
   scoped_refptr<OperationDriver> ref(this);
 
-  {
-    CHECK_OK(operation_->Apply());
-
+  // When the tablet batches applies, the operation is committed after the whole batch is written.
+  CHECK_OK(operation_->ApplyBatched([this, ref] {
     operation_->PreCommit();
 
     Finalize();
-  }
+  }));
 }
 
 void OperationDriver::Finalize() {
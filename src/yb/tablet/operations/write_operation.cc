@@ -84,6 +84,14 @@ consensus::ReplicateMsgPtr WriteOperation::NewReplicateMsg() {
 
 Status WriteOperation::Prepare() {//DHQ: 这个里面啥也没做，后么apply直接搞定了
   TRACE_EVENT0("txn", "WriteOperation::Prepare");
+  // Operations are prepared in the order they are replicated, so a write that is prepared after the
+  // split operation would be applied to the tablet after its data was passed to the new tablets.
+  Tablet* tablet = state()->tablet();
+  if (PREDICT_FALSE(tablet->IsSplitStarted())) {
+    auto status = STATUS_FORMAT(IllegalState, "Tablet $0 was split", tablet->tablet_id());
+    state()->completion_callback()->set_error(status, tserver::TabletServerErrorPB::TABLET_SPLIT);
+    return status;
+  }
   return Status::OK();
 }
 
@@ -112,6 +120,19 @@ Status WriteOperation::Apply() {
   return Status::OK();
 }
 
+Status WriteOperation::ApplyBatched(std::function<void()> on_applied) {
+  TRACE_EVENT0("txn", "WriteOperation::ApplyBatched");
+
+  if (PREDICT_FALSE(
+          ANNOTATE_UNPROTECTED_READ(FLAGS_tablet_inject_latency_on_apply_write_txn_ms) > 0)) {
+    return Operation::ApplyBatched(std::move(on_applied));
+  }
+
+  state()->tablet()->ApplyRowOperations(state(), std::move(on_applied));
+
+  return Status::OK();
+}
+
 void WriteOperation::PreCommit() { //DHQ: only on leader? 
   TRACE_EVENT0("txn", "WriteOperation::PreCommit");
   TRACE("PRECOMMIT: Releasing row and schema locks");
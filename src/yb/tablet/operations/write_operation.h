@@ -213,6 +213,9 @@ class WriteOperation : public Operation {
   // algorithm.
   CHECKED_STATUS Apply() override;
 
+  // Applies the operation as a part of the tablet apply batch, when it is active.
+  CHECKED_STATUS ApplyBatched(std::function<void()> on_applied) override;
+
   // Releases the row locks (Early Lock Release).
   void PreCommit() override;
 
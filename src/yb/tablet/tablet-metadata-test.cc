@@ -39,6 +39,7 @@
 #include "yb/gutil/ref_counted.h"
 #include "yb/tablet/local_tablet_writer.h"
 #include "yb/tablet/tablet-test-util.h"
+#include "yb/util/path_util.h"
 
 namespace yb {
 namespace tablet {
@@ -108,6 +109,18 @@ TEST_F(TestTabletMetadata, TestLoadFromSuperBlock) {
             << superblock_pb_1.DebugString();
 }
 
+// Test that SST files staged for ingestion are removed together with the tablet data.
+TEST_F(TestTabletMetadata, DeleteIngestDir) {
+  auto tablet = harness_->tablet();
+  ASSERT_OK(tablet->ReceiveSstFileChunk("000001.sst", 0, Slice("data")));
+  TabletMetadata* meta = tablet->metadata();
+  Env* env = meta->fs_manager()->env();
+  ASSERT_TRUE(env->FileExists(JoinPathSegments(meta->ingest_dir(), "000001.sst")));
+
+  tablet->Shutdown();
+  ASSERT_OK(meta->DeleteTabletData(TABLET_DATA_TOMBSTONED, yb::OpId()));
+  ASSERT_FALSE(env->FileExists(meta->ingest_dir()));
+}
 
 } // namespace tablet
 } // namespace yb
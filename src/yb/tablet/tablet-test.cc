@@ -41,6 +41,7 @@
 #include "yb/gutil/strings/join.h"
 #include "yb/tablet/local_tablet_writer.h"
 #include "yb/tablet/tablet.h"
+#include "yb/tablet/tablet_metrics.h"
 #include "yb/tablet/tablet-test-base.h"
 #include "yb/util/slice.h"
 #include "yb/util/test_macros.h"
@@ -172,6 +173,31 @@ TYPED_TEST(TestTablet, TestMultipleUpdates) {
   ASSERT_EQ(this->setup_.FormatDebugRow(1, 0, false), out_rows[1]);
 }
 
+// Test that write operations applied while the apply batch is active are written to RocksDB
+// together, when the batch is finished.
+TYPED_TEST(TestTablet, TestApplyBatch) {
+  constexpr int32_t kNumRows = 10;
+
+  LocalTabletWriter writer(this->tablet().get());
+  this->tablet()->StartApplyBatch();
+  for (int32_t i = 0; i < kNumRows; i++) {
+    ASSERT_OK(this->InsertTestRow(&writer, i, 0));
+  }
+
+  vector<string> out_rows;
+  ASSERT_OK(this->IterateToStringList(&out_rows));
+  ASSERT_EQ(0, out_rows.size());
+
+  this->tablet()->FinishApplyBatch();
+  ASSERT_OK(this->IterateToStringList(&out_rows));
+  ASSERT_EQ(kNumRows, out_rows.size());
+
+  auto* metrics = this->tablet()->metrics();
+  ASSERT_EQ(1, metrics->follower_apply_batch_size->TotalCount());
+  ASSERT_EQ(kNumRows, metrics->follower_apply_batch_size->MaxValueForTests());
+  ASSERT_EQ(kNumRows, metrics->follower_apply_batch_wait->TotalCount());
+}
+
 // Test that metrics behave properly during tablet initialization
 TYPED_TEST(TestTablet, TestMetricsInit) {
   // Create a tablet, but do not open it
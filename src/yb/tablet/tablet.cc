@@ -65,6 +65,7 @@
 #include "yb/docdb/docdb.pb.h"
 #include "yb/docdb/docdb_compaction_filter.h"
 #include "yb/docdb/docdb_rocksdb_util.h"
+#include "yb/docdb/docdb_util.h"
 #include "yb/docdb/intent.h"
 #include "yb/docdb/primitive_value.h"
 #include "yb/docdb/lock_batch.h"
@@ -84,19 +85,24 @@
 #include "yb/tablet/transaction_coordinator.h"
 #include "yb/tablet/transaction_participant.h"
 #include "yb/tablet/operations/alter_schema_operation.h"
+#include "yb/tablet/operations/split_operation.h"
 #include "yb/tablet/operations/truncate_operation.h"
 #include "yb/tablet/operations/write_operation.h"
 #include "yb/tablet/tablet_options.h"
+#include "yb/tablet/write_admission_controller.h"
 #include "yb/util/bloom_filter.h"
 #include "yb/util/debug/trace_event.h"
 #include "yb/util/enums.h"
 #include "yb/util/env.h"
+#include "yb/util/env_util.h"
 #include "yb/util/flag_tags.h"
 #include "yb/util/jsonwriter.h"
 #include "yb/util/locks.h"
 #include "yb/util/mem_tracker.h"
 #include "yb/util/metrics.h"
+#include "yb/util/path_util.h"
 #include "yb/util/slice.h"
+#include "yb/util/stol_utils.h"
 #include "yb/util/stopwatch.h"
 #include "yb/util/trace.h"
 #include "yb/util/url-coding.h"
@@ -117,6 +123,29 @@ DEFINE_double(tablet_bloom_target_fp_rate, 0.01f,
               "required for bloom filters.");
 TAG_FLAG(tablet_bloom_target_fp_rate, advanced);
 
+DEFINE_uint64(txn_max_apply_batch_records, 100000,
+              "Max number of transaction intents applied in one RocksDB write batch. Intents of "
+              "bigger transactions are applied in several batches in background. 0 - no limit.");
+
+DEFINE_int32(tablet_follower_apply_batch_max_ops, 64,
+             "Max number of consecutive committed write operations that a follower merges into a "
+             "single RocksDB write. 1 or less disables batching of follower applies.");
+TAG_FLAG(tablet_follower_apply_batch_max_ops, advanced);
+
+DEFINE_bool(enable_write_group_prepare, false,
+            "Lock keys of non-transactional writes to the same tablet, that arrive at the same "
+            "time, as a single group, and let them share a single read snapshot. Writes whose "
+            "keys are locked by other operations are not grouped. Doc operations of each write "
+            "are still performed by its own thread, their reads are not combined into a single "
+            "pass over the data.");
+TAG_FLAG(enable_write_group_prepare, advanced);
+TAG_FLAG(enable_write_group_prepare, runtime);
+
+DEFINE_test_flag(int32, write_group_delay_after_lock_ms_in_tests, 0,
+                 "Delay doc operations of grouped writes after their keys are locked.");
+
+DECLARE_int32(max_group_replicate_batch_size);
+
 METRIC_DEFINE_entity(tablet);
 
 using namespace std::placeholders;
@@ -269,6 +298,43 @@ struct WriteOperationData {
   }
 };
 
+struct Tablet::GroupedWrite {
+  const docdb::DocOperations* doc_ops;
+  const WriteOperationData* data;
+  KeyToIntentTypeMap keys_to_lock;
+  bool need_read_snapshot = false;
+
+  // Time when the write started to wait for its locks.
+  MonoTime start;
+
+  // Whether the thread of this write should lock the next group, protected by write_group_mutex_.
+  bool leader = false;
+
+  // Whether keys of this write were locked, protected by write_group_mutex_.
+  bool locked = false;
+
+  // Whether keys of this write could not be locked without waiting, so the thread of this write
+  // should lock them by itself, protected by write_group_mutex_.
+  bool lock_alone = false;
+
+  // Read snapshot shared by writes of the group, set when keys are locked.
+  std::shared_ptr<ScopedReadOperation> read_op;
+};
+
+struct Tablet::ApplyBatch {
+  struct Operation {
+    // Time when the operation was added to the batch.
+    MonoTime start;
+    std::function<void()> on_applied;
+  };
+
+  rocksdb::WriteBatch write_batch;
+  docdb::ConsensusFrontiers frontiers;
+  // Hybrid time of the first operation in the batch, that is the oldest write of the batch.
+  HybridTime first_hybrid_time;
+  std::vector<Operation> operations;
+};
+
 const char* Tablet::kDMSMemTrackerId = "DeltaMemStores";
 
 Tablet::Tablet(
@@ -334,6 +400,21 @@ Tablet::Tablet(
 
   flush_stats_ = make_shared<TabletFlushStats>();
   tablet_options_.listeners.emplace_back(flush_stats_);
+  key_access_stats_ = std::make_unique<KeyAccessStats>();
+
+  // Partition keys of hash partitioned tables are encoded hash values, so they could be converted
+  // to DocDB key bounds by prepending the hash value type.
+  const auto& partition = metadata_->partition();
+  const char hash_value_type = static_cast<char>(docdb::ValueType::kUInt16Hash);
+  if (!partition.partition_key_start().empty()) {
+    key_bounds_.lower = hash_value_type + partition.partition_key_start();
+  }
+  if (!partition.partition_key_end().empty()) {
+    key_bounds_.upper = hash_value_type + partition.partition_key_end();
+  }
+
+  split_applied_ = metadata_->split_state() != boost::none;
+  split_started_ = split_applied_.load();
 }
 
 Tablet::~Tablet() {
@@ -383,7 +464,7 @@ Status Tablet::OpenKeyValueTablet() {
   // Install the history cleanup handler. Note that TabletRetentionPolicy is going to hold a raw ptr
   // to this tablet. So, we ensure that rocksdb_ is reset before this tablet gets destroyed.
   rocksdb_options.compaction_filter_factory = make_shared<DocDBCompactionFilterFactory>(
-      make_shared<TabletRetentionPolicy>(this));
+      make_shared<TabletRetentionPolicy>(this), &key_bounds_);
 
   auto mem_table_flush_filter_factory = [this] {
     if (mem_table_flush_filter_factory_) {
@@ -412,7 +493,7 @@ Status Tablet::OpenKeyValueTablet() {
     return STATUS(IllegalState, rocksdb_open_status.ToString());
   }
   rocksdb_.reset(db);
-  ql_storage_.reset(new docdb::QLRocksDBStorage(rocksdb_.get()));
+  ql_storage_.reset(new docdb::QLRocksDBStorage(rocksdb_.get(), &key_bounds_));
   if (transaction_participant_) {
     transaction_participant_->SetDB(db);
   }
@@ -442,6 +523,10 @@ void Tablet::Shutdown() {
     transaction_coordinator_->Shutdown();
   }
 
+  if (transaction_participant_) {
+    transaction_participant_->Shutdown();
+  }
+
   std::lock_guard<rw_spinlock> lock(component_lock_);
   // Shutdown the RocksDB instance for this table, if present.
   rocksdb_.reset();
@@ -470,7 +555,7 @@ Result<std::unique_ptr<common::QLRowwiseIteratorIf>> Tablet::NewRowIterator(
   auto read_time = ReadHybridTime::SingleTime(HybridTime::kMax);
   auto result = std::make_unique<DocRowwiseIterator>(
       std::move(mapped_projection), *schema(), txn_op_ctx, rocksdb_.get(), read_time,
-      &pending_op_counter_);
+      &pending_op_counter_, &key_bounds_);
   RETURN_NOT_OK(result->Init());
   return std::move(result);
 }
@@ -486,7 +571,8 @@ void Tablet::StartOperation(WriteOperationState* operation_state) {
   }
 }
 
-void Tablet::ApplyRowOperations(WriteOperationState* operation_state) {
+void Tablet::ApplyRowOperations(WriteOperationState* operation_state,
+                                std::function<void()> on_applied) {
   last_committed_write_index_.store(operation_state->op_id().index(), std::memory_order_release);
   const KeyValueWriteBatchPB& put_batch =
       operation_state->consensus_round() && operation_state->consensus_round()->replicate_msg()
@@ -495,10 +581,101 @@ void Tablet::ApplyRowOperations(WriteOperationState* operation_state) {
           // Bootstrap case.
           : operation_state->request()->write_batch();
 
+  // Apply batch mutex is held till the operation is written, so operations applied from other
+  // threads could not overtake operations in the batch.
+  std::unique_lock<std::mutex> lock(apply_batch_mutex_);
+  if (apply_batch_) {
+    if (!put_batch.has_transaction()) {
+      AddToApplyBatchUnlocked(operation_state, put_batch, std::move(on_applied));
+      return;
+    }
+    // Transactional writes update transaction participant, so we don't batch them.
+    WriteApplyBatchUnlocked();
+  }
+
   docdb::ConsensusFrontiers frontiers;
   set_op_id({operation_state->op_id().term(), operation_state->op_id().index()}, &frontiers);
   set_hybrid_time(operation_state->hybrid_time(), &frontiers);
   ApplyKeyValueRowOperations(put_batch, &frontiers, operation_state->hybrid_time());//DHQ: 真正修改rocksdb的地方，里面调用batch
+  lock.unlock();
+
+  if (on_applied) {
+    on_applied();
+  }
+}
+
+void Tablet::StartApplyBatch() {
+  if (FLAGS_tablet_follower_apply_batch_max_ops <= 1) {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(apply_batch_mutex_);
+  if (!apply_batch_) {
+    apply_batch_ = std::make_unique<ApplyBatch>();
+  }
+}
+
+void Tablet::FinishApplyBatch() {
+  std::lock_guard<std::mutex> lock(apply_batch_mutex_);
+  if (apply_batch_) {
+    WriteApplyBatchUnlocked();
+    apply_batch_.reset();
+  }
+}
+
+void Tablet::AddToApplyBatchUnlocked(WriteOperationState* operation_state,
+                                     const KeyValueWriteBatchPB& put_batch,
+                                     std::function<void()> on_applied) {
+  auto& batch = *apply_batch_;
+  const yb::OpId op_id(operation_state->op_id().term(), operation_state->op_id().index());
+  const HybridTime hybrid_time = operation_state->hybrid_time();
+  // Operations are added in the order of their op ids and hybrid times, so the first one
+  // defines the smallest frontier of the batch and the last one defines the largest.
+  if (batch.operations.empty()) {
+    batch.frontiers.Smallest().set_op_id(op_id);
+    batch.frontiers.Smallest().set_hybrid_time(hybrid_time);
+    batch.first_hybrid_time = hybrid_time;
+  }
+  batch.frontiers.Largest().set_op_id(op_id);
+  batch.frontiers.Largest().set_hybrid_time(hybrid_time);
+
+  PrepareNonTransactionWriteBatch(put_batch, hybrid_time, &batch.write_batch);
+  batch.operations.push_back({MonoTime::Now(), std::move(on_applied)});
+
+  if (batch.operations.size() >=
+          implicit_cast<size_t>(FLAGS_tablet_follower_apply_batch_max_ops)) {
+    WriteApplyBatchUnlocked();
+  }
+}
+
+void Tablet::WriteApplyBatchUnlocked() {
+  auto& batch = *apply_batch_;
+  if (batch.operations.empty()) {
+    return;
+  }
+
+  if (batch.write_batch.Count() != 0) {
+    batch.write_batch.SetFrontiers(&batch.frontiers);
+    // Flush stats track the oldest write in the memtable, so the first operation is reported.
+    WriteToRocksDB(batch.first_hybrid_time, &batch.write_batch);
+  }
+
+  // Operations are committed in order while holding apply batch mutex, so operations applied
+  // from other threads are committed after them.
+  auto now = MonoTime::Now();
+  for (auto& operation : batch.operations) {
+    if (metrics_) {
+      metrics_->follower_apply_batch_wait->Increment(
+          now.GetDeltaSince(operation.start).ToMicroseconds());
+    }
+    if (operation.on_applied) {
+      operation.on_applied();
+    }
+  }
+  if (metrics_) {
+    metrics_->follower_apply_batch_size->Increment(batch.operations.size());
+  }
+
+  apply_batch_ = std::make_unique<ApplyBatch>();
 }
 
 Status Tablet::CreateCheckpoint(const std::string& dir,
@@ -582,6 +759,10 @@ void Tablet::ApplyKeyValueRowOperations(const KeyValueWriteBatchPB& put_batch,
     PrepareNonTransactionWriteBatch(put_batch, hybrid_time, rocksdb_write_batch);
   }
 
+  WriteToRocksDB(hybrid_time, rocksdb_write_batch);
+}
+
+void Tablet::WriteToRocksDB(HybridTime hybrid_time, rocksdb::WriteBatch* rocksdb_write_batch) {
   // We are using Raft replication index for the RocksDB sequence number for
   // all members of this write batch.
   rocksdb::WriteOptions write_options;
@@ -627,6 +808,7 @@ Status Tablet::KeyValueBatchFromRedisWriteBatch(const WriteOperationData& data)
   for (size_t i = 0; i < redis_write_batch->size(); i++) {
     doc_ops.emplace_back(new RedisWriteOperation(redis_write_batch->Mutable(i)));
   }
+  SampleWriteKeys(doc_ops);
   RETURN_NOT_OK(StartDocWriteOperation(doc_ops, data));
   if (data.restart_read_ht->is_valid()) {
     return Status::OK();
@@ -648,6 +830,14 @@ Status Tablet::HandleRedisReadRequest(const ReadHybridTime& read_time,
 
   ScopedTabletMetricsTracker metrics_tracker(metrics_->redis_read_latency);
 
+  if (key_access_stats_->ShouldSample(KeyAccessType::kRead) &&
+      redis_read_request.has_key_value()) {
+    const auto& key_value = redis_read_request.key_value();
+    key_access_stats_->Record(
+        KeyAccessType::kRead,
+        docdb::DocKey::FromRedisKey(key_value.hash_code(), key_value.key()).Encode().AsSlice());
+  }
+
   docdb::RedisReadOperation doc_op(redis_read_request, rocksdb_.get(), read_time);
   RETURN_NOT_OK(doc_op.Execute());
   *response = std::move(doc_op.response());
@@ -668,6 +858,10 @@ Status Tablet::HandleQLReadRequest(
     return Status::OK();
   }
 
+  if (key_access_stats_->ShouldSample(KeyAccessType::kRead)) {
+    SampleReadKey(ql_read_request);
+  }
+
   Result<TransactionOperationContextOpt> txn_op_ctx =
       CreateTransactionOperationContext(transaction_metadata);
   RETURN_NOT_OK(txn_op_ctx);
@@ -718,6 +912,39 @@ CHECKED_STATUS Tablet::CreatePagingStateForRead(const QLReadRequestPB& ql_read_r
   return Status::OK();
 }
 
+void Tablet::SampleReadKey(const QLReadRequestPB& ql_read_request) {
+  // Only reads of a single hash key are sampled, scans are just counted.
+  if (ql_read_request.hashed_column_values().empty()) {
+    return;
+  }
+  const auto& schema = metadata_->schema();
+  vector<PrimitiveValue> hashed_components;
+  auto status = docdb::QLKeyColumnValuesToPrimitiveValues(
+      ql_read_request.hashed_column_values(), schema, 0, schema.num_hash_key_columns(),
+      &hashed_components);
+  if (!status.ok()) {
+    VLOG(3) << "Failed to sample read key of " << tablet_id() << ": " << status;
+    return;
+  }
+  key_access_stats_->Record(
+      KeyAccessType::kRead,
+      docdb::DocKey(ql_read_request.hash_code(), hashed_components).Encode().AsSlice());
+}
+
+void Tablet::SampleWriteKeys(const docdb::DocOperations& doc_ops) {
+  for (const auto& doc_op : doc_ops) {
+    if (!key_access_stats_->ShouldSample(KeyAccessType::kWrite)) {
+      continue;
+    }
+    std::list<docdb::DocPath> paths;
+    IsolationLevel ignored_isolation_level;
+    doc_op->GetDocPathsToLock(&paths, &ignored_isolation_level);
+    if (!paths.empty()) {
+      key_access_stats_->Record(KeyAccessType::kWrite, paths.front().encoded_doc_key().AsSlice());
+    }
+  }
+}
+
 Status Tablet::KeyValueBatchFromQLWriteBatch(const WriteOperationData& data) {
   ScopedPendingOperation scoped_read_operation(&pending_op_counter_);
   RETURN_NOT_OK(scoped_read_operation);
@@ -744,7 +971,14 @@ Status Tablet::KeyValueBatchFromQLWriteBatch(const WriteOperationData& data) {
       doc_ops.emplace_back(std::move(write_op));
     }
   }
-  RETURN_NOT_OK(StartDocWriteOperation(doc_ops, data));
+  SampleWriteKeys(doc_ops);
+  const auto& write_batch = data.write_request()->write_batch();
+  if (FLAGS_enable_write_group_prepare && !doc_ops.empty() && !write_batch.has_transaction() &&
+      !data.write_request()->has_read_time()) {
+    RETURN_NOT_OK(PerformGroupedDocOperations(doc_ops, data));
+  } else {
+    RETURN_NOT_OK(StartDocWriteOperation(doc_ops, data));
+  }
   if (data.restart_read_ht->is_valid()) {
     return Status::OK();
   }
@@ -819,24 +1053,75 @@ Status Tablet::ImportData(const std::string& source_dir) {
   return rocksdb_->Import(source_dir);
 }
 
+Result<std::string> Tablet::IngestFilePath(const std::string& file_name) const {
+  if (file_name.empty() || file_name.find('/') != std::string::npos || file_name[0] == '.') {
+    return STATUS_FORMAT(InvalidArgument, "Invalid SST file name: $0", file_name);
+  }
+  return JoinPathSegments(metadata()->ingest_dir(), file_name);
+}
+
+Status Tablet::ReceiveSstFileChunk(
+    const std::string& file_name, uint64_t offset, const Slice& data) {
+  const auto path = VERIFY_RESULT(IngestFilePath(file_name));
+  Env* const env = metadata()->fs_manager()->env();
+  WritableFileOptions options;
+  if (offset == 0) {
+    RETURN_NOT_OK(env_util::CreateDirIfMissing(env, DirName(path)));
+  } else {
+    // Chunks are sent sequentially, so we could detect lost or duplicated ones by file size.
+    const auto file_size = VERIFY_RESULT(env->GetFileSize(path));
+    if (file_size != offset) {
+      return STATUS_FORMAT(IllegalState, "Unexpected chunk offset for $0: $1, file size: $2",
+                           file_name, offset, file_size);
+    }
+    options.mode = Env::OPEN_EXISTING;
+  }
+  gscoped_ptr<WritableFile> file;
+  RETURN_NOT_OK(env->NewWritableFile(options, path, &file));
+  RETURN_NOT_OK(file->Append(data));
+  return file->Close();
+}
+
+Status Tablet::IngestSstFile(const std::string& file_name) {
+  const auto path = VERIFY_RESULT(IngestFilePath(file_name));
+  LOG(INFO) << "Ingesting SST file into tablet " << tablet_id() << ": " << path;
+  return rocksdb_->AddFile(path, true /* move_file */);
+}
+
 // We apply intents using by iterating over whole transaction reverse index.
 // Using value of reverse index record we find original intent record and apply it.
 // After that we delete both intent record and reverse index record.
-// TODO(dtxn) use separate thread for applying intents.
-// TODO(dtxn) use multiple batches when applying really big transaction.
-Status Tablet::ApplyIntents(const TransactionApplyData& data) {
+// Transactions having more than FLAGS_txn_max_apply_batch_records intents are applied in several
+// batches. Only the first batch is written while applying APPLYING operation, the rest are written
+// by transaction participant in background.
+Result<docdb::ApplyTransactionStatePB> Tablet::ApplyIntents(const TransactionApplyData& data) {
+  // APPLYING operation is stored in the state, so batches written in background after restart
+  // have the same frontiers.
+  docdb::ApplyTransactionStatePB state = data.apply_state;
+  *state.mutable_op_id() = data.op_id;
+  state.set_log_ht(data.log_ht.ToUint64());
+
   WriteBatch rocksdb_write_batch;
-  RETURN_NOT_OK(docdb::PrepareApplyIntentsBatch(
-      data.transaction_id, data.commit_ht, rocksdb_.get(), &rocksdb_write_batch));
+  auto apply_state = VERIFY_RESULT(docdb::PrepareApplyIntentsBatch(
+      data.transaction_id, data.commit_ht, state, FLAGS_txn_max_apply_batch_records,
+      rocksdb_.get(), &rocksdb_write_batch));
 
   // data.hybrid_time contains transaction commit time.
   // We don't set transaction field of put_batch, otherwise we would write another bunch of intents.
+  // Batches written in background use frontiers of APPLYING operation as well.
   docdb::ConsensusFrontiers frontiers;
   set_op_id({data.op_id.term(), data.op_id.index()}, &frontiers);
   set_hybrid_time(data.log_ht, &frontiers);
   ApplyKeyValueRowOperations(
       KeyValueWriteBatchPB(), &frontiers, data.commit_ht, &rocksdb_write_batch);
-  return Status::OK();
+  return apply_state;
+}
+
+Status Tablet::ResumeApplyingIntents() {
+  if (!transaction_participant_) {
+    return Status::OK();
+  }
+  return transaction_participant_->ResumeApplying(this);
 }
 
 Status Tablet::CreatePreparedAlterSchema(AlterSchemaOperationState *operation_state,
@@ -967,6 +1252,112 @@ Status Tablet::Truncate(TruncateOperationState *state) {
   return Status::OK();
 }
 
+Status Tablet::StartSplit() {
+  bool expected = false;
+  if (!split_started_.compare_exchange_strong(expected, true, std::memory_order_acq_rel)) {
+    return STATUS_FORMAT(IllegalState, "Tablet $0 is already being split", tablet_id());
+  }
+  return Status::OK();
+}
+
+void Tablet::AbortSplit() {
+  if (!IsSplit()) {
+    split_started_.store(false, std::memory_order_release);
+  }
+}
+
+Status Tablet::ApplySplit(SplitOperationState* state) {
+  const auto& request = *state->request();
+  SplitTabletStatePB split_state;
+  split_state.set_new_tablet1_id(request.new_tablet1_id());
+  split_state.set_new_tablet2_id(request.new_tablet2_id());
+  split_state.set_split_partition_key(request.split_partition_key());
+
+  split_started_.store(true, std::memory_order_release);
+  split_applied_.store(true, std::memory_order_release);
+  metadata_->set_split_state(split_state);
+  RETURN_NOT_OK(metadata_->Flush());
+
+  LOG(INFO) << "Tablet " << tablet_id() << " was split: " << split_state.ShortDebugString();
+  if (split_callback_) {
+    split_callback_();
+  }
+  return Status::OK();
+}
+
+Status Tablet::CreateSplitCheckpoint(const std::string& dir) {
+  RETURN_NOT_OK(metadata_->fs_manager()->CreateDirIfMissingAndSync(DirName(dir)));
+  RETURN_NOT_OK(CreateCheckpoint(dir));
+
+  rocksdb::Options rocksdb_options;
+  docdb::InitRocksDBOptions(&rocksdb_options, tablet_id(), rocksdb_statistics_, tablet_options_);
+  rocksdb::DB* db = nullptr;
+  RETURN_NOT_OK(rocksdb::DB::Open(rocksdb_options, dir, &db));
+  std::unique_ptr<rocksdb::DB> db_holder(db);
+
+  // Keep the hybrid time, so the new tablet does not read data of the checkpoint in the past.
+  docdb::ConsensusFrontier frontier;
+  auto flushed_frontier = db->GetFlushedFrontier();
+  if (flushed_frontier) {
+    frontier.set_hybrid_time(
+        down_cast<docdb::ConsensusFrontier&>(*flushed_frontier).hybrid_time());
+  }
+  return db->ResetFlushedFrontier(frontier.Clone());
+}
+
+Status Tablet::CheckSplitSupported() const {
+  if (table_type_ != TableType::YQL_TABLE_TYPE && table_type_ != TableType::REDIS_TABLE_TYPE) {
+    return STATUS_FORMAT(NotSupported, "Split of $0 tablets is not supported", table_type_);
+  }
+  if (metadata_->schema().table_properties().is_transactional()) {
+    return STATUS_FORMAT(NotSupported,
+                         "Split of tablet $0 of a transactional table is not supported",
+                         tablet_id());
+  }
+  if (transaction_participant_ && transaction_participant_->HasTransactions()) {
+    return STATUS_FORMAT(IllegalState, "Tablet $0 has running or applying transactions",
+                         tablet_id());
+  }
+  return Status::OK();
+}
+
+Result<std::string> Tablet::GetEncodedMiddleSplitKey() const {
+  RETURN_NOT_OK(CheckSplitSupported());
+
+  ScopedPendingOperation scoped_read_operation(&pending_op_counter_);
+  RETURN_NOT_OK(scoped_read_operation);
+
+  const auto middle_key = VERIFY_RESULT(rocksdb_->GetMiddleKey());
+  // Encoded hash value that follows the value type is the partition key.
+  const size_t kEncodedHashSize = 2;
+  if (middle_key.size() < 1 + kEncodedHashSize ||
+      middle_key[0] != static_cast<char>(docdb::ValueType::kUInt16Hash)) {
+    return STATUS_FORMAT(IllegalState, "Middle key of tablet $0 is not hash partitioned: $1",
+                         tablet_id(), Slice(middle_key).ToDebugHexString());
+  }
+  std::string split_key = middle_key.substr(1, kEncodedHashSize);
+  const auto& partition = metadata_->partition();
+  if (split_key <= partition.partition_key_start() ||
+      (!partition.partition_key_end().empty() && split_key >= partition.partition_key_end())) {
+    return STATUS_FORMAT(IllegalState, "Tablet $0 could not be split at its partition bound",
+                         tablet_id());
+  }
+  return split_key;
+}
+
+Status Tablet::VerifyDataChecksums(const rocksdb::VerifyChecksumOptions& options,
+                                   uint64_t* bytes_verified) {
+  ScopedPendingOperation scoped_operation(&pending_op_counter_);
+  RETURN_NOT_OK(scoped_operation);
+
+  auto tablet_options = options;
+  // Shutdown waits for pending operations, so it should not wait for the whole verification.
+  tablet_options.should_abort = [this, &options] {
+    return IsShutdownRequested() || (options.should_abort && options.should_abort());
+  };
+  return rocksdb_->VerifyChecksum(tablet_options, bytes_verified);
+}
+
 void Tablet::UpdateMonotonicCounter(int64_t value) {
   int64_t counter = monotonic_counter_;
   while (true) {
@@ -1102,6 +1493,141 @@ Status Tablet::StartDocWriteOperation(const docdb::DocOperations &doc_ops,
   return Status::OK();
 }
 
+Status Tablet::PerformGroupedDocOperations(const docdb::DocOperations& doc_ops,
+                                           const WriteOperationData& data) {
+  GroupedWrite write = { &doc_ops, &data };
+  write.start = MonoTime::Now();
+  docdb::DetermineKeysToLock(doc_ops, IsolationLevel::NON_TRANSACTIONAL, &write.keys_to_lock,
+                             &write.need_read_snapshot);
+
+  std::vector<GroupedWrite*> group;
+  bool leader;
+  {
+    std::unique_lock<std::mutex> lock(write_group_mutex_);
+    write_group_queue_.push_back(&write);
+    if (!write_group_active_) {
+      write_group_active_ = true;
+      write.leader = true;
+    }
+    write_group_cond_.wait(
+        lock, [&write] { return write.locked || write.lock_alone || write.leader; });
+    leader = write.leader;
+    if (leader) {
+      FormWriteGroup(&group);
+    }
+  }
+
+  if (leader) {
+    StartWriteGroup(group);
+
+    {
+      std::lock_guard<std::mutex> lock(write_group_mutex_);
+      for (auto* grouped_write : group) {
+        grouped_write->locked = true;
+      }
+      if (write_group_queue_.empty()) {
+        write_group_active_ = false;
+      } else {
+        // Writes that arrived while this group was formed, or did not fit into it, are locked
+        // by the thread of the first of them.
+        write_group_queue_.front()->leader = true;
+      }
+    }
+    write_group_cond_.notify_all();
+  }
+
+  // Leadership was already passed on, so waiting for locks held by other operations does not
+  // delay other writes.
+  if (write.lock_alone) {
+    *data.keys_locked = LockBatch(&shared_lock_manager_, std::move(write.keys_to_lock));
+    WriteLocked(write, MonoTime::Now());
+    if (write.need_read_snapshot) {
+      write.read_op = std::make_shared<ScopedReadOperation>(
+          this, RequireLease::kTrue, ReadHybridTime());
+    }
+  }
+
+  if (PREDICT_FALSE(FLAGS_write_group_delay_after_lock_ms_in_tests > 0)) {
+    SleepFor(MonoDelta::FromMilliseconds(FLAGS_write_group_delay_after_lock_ms_in_tests));
+  }
+
+  // Only locking is done by the group leader, doc operations of each write are performed by its
+  // own thread, so writes of the group are performed in parallel.
+  auto read_time = write.need_read_snapshot ? write.read_op->read_time()
+                                            : ReadHybridTime::SingleTime(clock_->Now());
+  if (metadata_->schema().table_properties().is_transactional()) {
+    auto now = clock_->Now();
+    auto result = docdb::ResolveOperationConflicts(
+        doc_ops, now, rocksdb_.get(), transaction_participant_.get());
+    RETURN_NOT_OK(result);
+    if (now != *result) {
+      clock_->Update(*result);
+    }
+  }
+
+  return docdb::ExecuteDocWriteOperation(
+      doc_ops, read_time, rocksdb_.get(), data.write_request()->mutable_write_batch(),
+      InitMarkerBehavior::kOptional, &monotonic_counter_, data.restart_read_ht);
+}
+
+void Tablet::FormWriteGroup(std::vector<GroupedWrite*>* group) {
+  // Writes join the group when they don't conflict with writes in the group and with writes
+  // skipped before them, so conflicting writes are locked in the order they arrived. Keys are
+  // locked without waiting, so the leader is never blocked by a hot key, writes that would wait
+  // lock their keys by themselves.
+  std::deque<GroupedWrite*> skipped;
+  std::vector<GroupedWrite*> lock_alone;
+  const size_t max_group_size = std::max(FLAGS_max_group_replicate_batch_size, 1);
+  for (auto* write : write_group_queue_) {
+    auto conflicts = [write](const GroupedWrite* other) {
+      return docdb::SharedLockManager::Conflict(write->keys_to_lock, other->keys_to_lock);
+    };
+    if (group->size() >= max_group_size ||
+        std::any_of(group->begin(), group->end(), conflicts) ||
+        std::any_of(skipped.begin(), skipped.end(), conflicts) ||
+        std::any_of(lock_alone.begin(), lock_alone.end(), conflicts)) {
+      skipped.push_back(write);
+      continue;
+    }
+    auto locks = LockBatch::TryLock(&shared_lock_manager_, &write->keys_to_lock);
+    if (locks) {
+      *write->data->keys_locked = std::move(*locks);
+      group->push_back(write);
+    } else {
+      write->lock_alone = true;
+      lock_alone.push_back(write);
+    }
+  }
+  write_group_queue_.swap(skipped);
+  VLOG(2) << "Formed write group of " << group->size() << " writes, " << lock_alone.size()
+          << " writes lock alone, " << write_group_queue_.size() << " writes are waiting";
+}
+
+void Tablet::StartWriteGroup(const std::vector<GroupedWrite*>& group) {
+  bool need_read_snapshot = false;
+  for (auto* write : group) {
+    need_read_snapshot = need_read_snapshot || write->need_read_snapshot;
+  }
+
+  // Each write waited for its locks since it was queued, so latency is recorded per write.
+  const MonoTime now = MonoTime::Now();
+  auto read_op = need_read_snapshot
+      ? std::make_shared<ScopedReadOperation>(this, RequireLease::kTrue, ReadHybridTime())
+      : nullptr;
+  for (auto* write : group) {
+    if (write->need_read_snapshot) {
+      write->read_op = read_op;
+    }
+    WriteLocked(*write, now);
+  }
+}
+
+void Tablet::WriteLocked(const GroupedWrite& write, MonoTime now) {
+  if (metrics_->write_lock_latency != nullptr) {
+    metrics_->write_lock_latency->Increment(now.GetDeltaSince(write.start).ToMicroseconds());
+  }
+}
+
 HybridTime Tablet::DoGetSafeTime(
     tablet::RequireLease require_lease, HybridTime min_allowed, MonoTime deadline) const {
   HybridTime ht_lease;
@@ -1192,6 +1718,70 @@ uint64_t Tablet::GetTotalSSTFileSizes() const {
   return rocksdb_->GetTotalSSTFileSize();
 }
 
+void Tablet::GetWriteDebt(WriteDebt* debt) const {
+  ScopedPendingOperation scoped_operation(&pending_op_counter_);
+  std::lock_guard<rw_spinlock> lock(component_lock_);
+
+  if (!pending_op_counter_.IsReady() || !rocksdb_) {
+    return;
+  }
+
+  uint64_t value = 0;
+  if (rocksdb_->GetIntProperty(rocksdb::DB::Properties::kEstimatePendingCompactionBytes, &value)) {
+    debt->pending_compaction_bytes = value;
+  }
+  if (rocksdb_->GetIntProperty(rocksdb::DB::Properties::kCurSizeAllMemTables, &value)) {
+    debt->memtables_size = value;
+  }
+  if (rocksdb_->GetIntProperty(rocksdb::DB::Properties::kNumImmutableMemTable, &value)) {
+    debt->num_immutable_memtables = value;
+  }
+  // With universal compaction all SST files are at level 0, and RocksDB stops writes when their
+  // number reaches level0_stop_writes_trigger.
+  std::string num_files;
+  if (rocksdb_->GetProperty(rocksdb::DB::Properties::kNumFilesAtLevelPrefix + "0", &num_files)) {
+    auto parsed = util::CheckedStoll(num_files);
+    if (parsed.ok()) {
+      debt->num_sst_files = *parsed;
+    }
+  }
+  const auto& options = rocksdb_->GetOptions();
+  debt->sst_files_stop_limit = std::max(options.level0_stop_writes_trigger, 0);
+  // RocksDB stops writes when the number of memtables waiting for flush reaches
+  // max_write_buffer_number.
+  debt->immutable_memtables_stop_limit = std::max(options.max_write_buffer_number, 0);
+}
+
+bool Tablet::RocksDBCompactionPending() const {
+  ScopedPendingOperation scoped_operation(&pending_op_counter_);
+  std::lock_guard<rw_spinlock> lock(component_lock_);
+
+  if (!pending_op_counter_.IsReady() || !rocksdb_) {
+    return false;
+  }
+
+  uint64_t compaction_pending = 0, running_compactions = 0;
+  if (!rocksdb_->GetIntProperty(rocksdb::DB::Properties::kCompactionPending,
+                                &compaction_pending) ||
+      !rocksdb_->GetIntProperty(rocksdb::DB::Properties::kNumRunningCompactions,
+                                &running_compactions)) {
+    return false;
+  }
+  return compaction_pending != 0 && running_compactions == 0;
+}
+
+Status Tablet::ScheduleRocksDBCompaction() {
+  ScopedPendingOperation scoped_operation(&pending_op_counter_);
+  RETURN_NOT_OK(scoped_operation);
+
+  // Enabling automatic compactions that are already enabled only makes RocksDB run its compaction
+  // picker and schedule the compactions it picks. Disabled compactions are left disabled.
+  if (rocksdb_->GetOptions().disable_auto_compactions) {
+    return Status::OK();
+  }
+  return rocksdb_->EnableAutoCompaction({rocksdb_->DefaultColumnFamily()});
+}
+
 // ------------------------------------------------------------------------------------------------
 
 Result<TransactionOperationContextOpt> Tablet::CreateTransactionOperationContext(
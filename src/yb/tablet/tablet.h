@@ -32,6 +32,9 @@
 #ifndef YB_TABLET_TABLET_H_
 #define YB_TABLET_TABLET_H_
 
+#include <condition_variable>
+#include <deque>
+#include <functional>
 #include <iosfwd>
 #include <map>
 #include <memory>
@@ -63,6 +66,7 @@
 #include "yb/gutil/macros.h"
 
 #include "yb/tablet/abstract_tablet.h"
+#include "yb/tablet/key_access_stats.h"
 #include "yb/tablet/lock_manager.h"
 #include "yb/tablet/tablet_options.h"
 #include "yb/tablet/mvcc.h"
@@ -80,6 +84,7 @@
 
 namespace rocksdb {
 class DB;
+struct VerifyChecksumOptions;
 }
 
 namespace yb {
@@ -113,8 +118,10 @@ struct TransactionApplyData;
 class TransactionCoordinator;
 class TransactionCoordinatorContext;
 class TransactionParticipant;
+class SplitOperationState;
 class TruncateOperationState;
 class WriteOperationState;
+struct WriteDebt;
 
 using docdb::LockBatch;
 
@@ -201,7 +208,20 @@ class Tablet : public AbstractTablet, public TransactionIntentApplier {
 
   CHECKED_STATUS ImportData(const std::string& source_dir);
 
-  CHECKED_STATUS ApplyIntents(const TransactionApplyData& data) override;
+  // Appends chunk of externally generated SST file, that will be added to RocksDB by IngestSstFile.
+  // Received files are kept in a staging directory next to the RocksDB directory.
+  CHECKED_STATUS ReceiveSstFileChunk(
+      const std::string& file_name, uint64_t offset, const Slice& data);
+
+  // Moves previously received SST file into RocksDB. Key range of the file should not overlap
+  // with data already present in the tablet.
+  CHECKED_STATUS IngestSstFile(const std::string& file_name);
+
+  Result<docdb::ApplyTransactionStatePB> ApplyIntents(const TransactionApplyData& data) override;
+
+  // Resumes applying intents of transactions, whose apply was interrupted by restart. Should be
+  // invoked after the log is replayed.
+  CHECKED_STATUS ResumeApplyingIntents();
 
   // Finish the Prepare phase of a write transaction.
   //
@@ -232,7 +252,17 @@ class Tablet : public AbstractTablet, public TransactionIntentApplier {
   void StartOperation(WriteOperationState* operation_state);
 
   // Apply all of the row operations associated with this transaction.
-  void ApplyRowOperations(WriteOperationState* operation_state);
+  // on_applied is invoked after the operations were written to RocksDB. While apply batch is
+  // active, it is deferred till the batch is written.
+  void ApplyRowOperations(WriteOperationState* operation_state,
+                          std::function<void()> on_applied = std::function<void()>());
+
+  // Starts batching of applied write operations, used by followers to merge consecutive committed
+  // write operations into a single RocksDB write with combined frontiers.
+  void StartApplyBatch();
+
+  // Writes operations added to the apply batch and invokes their on_applied callbacks in order.
+  void FinishApplyBatch();
 
   // Apply a set of RocksDB row operations.
   // If rocksdb_write_batch is specified it could contain preencoded RocksDB operations.
@@ -297,6 +327,50 @@ class Tablet : public AbstractTablet, public TransactionIntentApplier {
   // Truncate this tablet by resetting the content of RocksDB.
   CHECKED_STATUS Truncate(TruncateOperationState* state);
 
+  // Marks the tablet as being split, so writes prepared after this call are rejected. Fails if the
+  // tablet is already being split.
+  CHECKED_STATUS StartSplit();
+
+  // Allows writes again after the split operation was aborted.
+  void AbortSplit();
+
+  // Whether the split of this tablet was started or already applied.
+  bool IsSplitStarted() const {
+    return split_started_.load(std::memory_order_acquire);
+  }
+
+  // Whether the split of this tablet was applied, after that the tablet does not serve requests.
+  bool IsSplit() const {
+    return split_applied_.load(std::memory_order_acquire);
+  }
+
+  // Records in the tablet metadata that the tablet was split, and invokes the split callback, so
+  // the new tablets are created from the data of this tablet.
+  CHECKED_STATUS ApplySplit(SplitOperationState* state);
+
+  // Creates a RocksDB checkpoint in dir, that is used as the initial data of a tablet created by
+  // splitting this tablet. The flushed op id of the checkpoint is reset, since the new tablet starts
+  // with an empty log.
+  CHECKED_STATUS CreateSplitCheckpoint(const std::string& dir);
+
+  // Returns OK if the tablet could be split. Tablets of transactional tables are not split, since
+  // provisional records are copied to both new tablets, while the transaction coordinator still
+  // sends the commit to the split tablet only.
+  CHECKED_STATUS CheckSplitSupported() const;
+
+  // Returns the encoded partition key that splits the tablet into two parts of about the same size.
+  Result<std::string> GetEncodedMiddleSplitKey() const;
+
+  // Verifies checksums of all SST files of the tablet. In addition to options, verification is
+  // aborted when the tablet is shutting down. bytes_verified is increased by the number of verified
+  // bytes.
+  CHECKED_STATUS VerifyDataChecksums(const rocksdb::VerifyChecksumOptions& options,
+                                     uint64_t* bytes_verified);
+
+  void SetSplitCallback(std::function<void()> callback) {
+    split_callback_ = std::move(callback);
+  }
+
   // Verbosely dump this entire tablet to the logs. This is only
   // really useful when debugging unit tests failures where the tablet
   // has a very small number of rows.
@@ -361,6 +435,9 @@ class Tablet : public AbstractTablet, public TransactionIntentApplier {
   // The HybridTime of the oldest write that is still not scheduled to be flushed in RocksDB.
   TabletFlushStats* flush_stats() const { return flush_stats_.get(); }
 
+  // Sampled statistics of reads and writes, used to find hot tablets and keys.
+  KeyAccessStats* key_access_stats() const { return key_access_stats_.get(); }
+
   const scoped_refptr<server::Clock> &clock() const {
     return clock_;
   }
@@ -401,6 +478,17 @@ class Tablet : public AbstractTablet, public TransactionIntentApplier {
 
   uint64_t GetTotalSSTFileSizes() const;
 
+  // Fills RocksDB part of the write debt used by write admission control.
+  void GetWriteDebt(WriteDebt* debt) const;
+
+  // Returns true when the RocksDB compaction picker has work for this tablet, but no compaction is
+  // running.
+  bool RocksDBCompactionPending() const;
+
+  // Asks RocksDB to pick and schedule compactions, the same way it does after a flush. Used by the
+  // maintenance manager.
+  CHECKED_STATUS ScheduleRocksDBCompaction();
+
   void SetHybridTimeLeaseProvider(HybridTimeLeaseProvider provider) {
     ht_lease_provider_ = std::move(provider);
   }
@@ -425,7 +513,36 @@ class Tablet : public AbstractTablet, public TransactionIntentApplier {
       const docdb::DocOperations &doc_ops,
       const WriteOperationData& data);
 
+  // Records the key of the sampled read, see KeyAccessStats.
+  void SampleReadKey(const QLReadRequestPB& ql_read_request);
+
+  // Counts writes of doc_ops and records keys of sampled ones, see KeyAccessStats.
+  void SampleWriteKeys(const docdb::DocOperations& doc_ops);
+
+  struct GroupedWrite;
+
+  // Performs doc operations of a non-transactional write. Keys of such writes to this tablet, that
+  // arrive at the same time, are locked at once by one of them, and their reads share a single
+  // read snapshot. A write whose keys are locked by another operation waits for them by itself.
+  // Doc operations are performed by the calling thread.
+  CHECKED_STATUS PerformGroupedDocOperations(
+      const docdb::DocOperations& doc_ops,
+      const WriteOperationData& data);
+
+  // Moves writes that could be performed in a single group from write_group_queue_ to group, and
+  // locks their keys without waiting. Writes whose keys could not be locked are removed from the
+  // queue and marked to be locked by their own threads. Should be called with write_group_mutex_
+  // held.
+  void FormWriteGroup(std::vector<GroupedWrite*>* group);
+
+  // Takes the read snapshot shared by writes of the group, whose keys are already locked.
+  void StartWriteGroup(const std::vector<GroupedWrite*>& group);
+
+  // Records time that the write waited for its keys to be locked.
+  void WriteLocked(const GroupedWrite& write, MonoTime now);
+
   CHECKED_STATUS OpenKeyValueTablet();
+  Result<std::string> IngestFilePath(const std::string& file_name) const;
   virtual CHECKED_STATUS CreateTabletDirectories(const string& db_dir, FsManager* fs);
 
   void DocDBDebugDump(std::vector<std::string> *lines);
@@ -435,6 +552,14 @@ class Tablet : public AbstractTablet, public TransactionIntentApplier {
   void RegisterReaderTimestamp(HybridTime read_point) override;
   void UnregisterReader(HybridTime read_point) override;
 
+  void AddToApplyBatchUnlocked(WriteOperationState* operation_state,
+                               const docdb::KeyValueWriteBatchPB& put_batch,
+                               std::function<void()> on_applied);
+
+  void WriteApplyBatchUnlocked();
+
+  void WriteToRocksDB(HybridTime hybrid_time, rocksdb::WriteBatch* rocksdb_write_batch);
+
   void PrepareTransactionWriteBatch(
       const docdb::KeyValueWriteBatchPB& put_batch,
       HybridTime hybrid_time,
@@ -549,6 +674,15 @@ class Tablet : public AbstractTablet, public TransactionIntentApplier {
   // This is for docdb fine-grained locking.
   docdb::SharedLockManager shared_lock_manager_;
 
+  std::mutex write_group_mutex_;
+  std::condition_variable write_group_cond_;
+
+  // Writes waiting for their doc operations to be performed, protected by write_group_mutex_.
+  std::deque<GroupedWrite*> write_group_queue_;
+
+  // Whether some thread locks keys of a write group, protected by write_group_mutex_.
+  bool write_group_active_ = false;
+
   // For the block cache and memory manager shared across tablets
   TabletOptions tablet_options_;
 
@@ -579,10 +713,34 @@ class Tablet : public AbstractTablet, public TransactionIntentApplier {
 
   std::atomic<int64_t> last_committed_write_index_{0};
 
+  // Set when the split operation is prepared, cleared if it is aborted.
+  std::atomic<bool> split_started_{false};
+
+  // Set when the split operation is applied.
+  std::atomic<bool> split_applied_{false};
+
+  // Invoked when the split operation is applied.
+  std::function<void()> split_callback_;
+
+  // Hash partition bounds of the tablet, documents outside of them are skipped by reads and removed
+  // by compactions.
+  docdb::KeyBounds key_bounds_;
+
+  struct ApplyBatch;
+
+  // Protects apply_batch_. Also held while applying operations, so they are written to RocksDB
+  // and committed in order.
+  std::mutex apply_batch_mutex_;
+
+  // Write operations applied by follower since StartApplyBatch, but not written yet.
+  std::unique_ptr<ApplyBatch> apply_batch_;
+
   // Remembers he HybridTime of the oldest write that is still not scheduled to
   // be flushed in RocksDB.
   std::shared_ptr<TabletFlushStats> flush_stats_;
 
+  std::unique_ptr<KeyAccessStats> key_access_stats_;
+
   HybridTimeLeaseProvider ht_lease_provider_;
 
  private:
@@ -43,9 +43,21 @@
 #include "yb/tablet/tablet_bootstrap_if.h"
 #include "yb/tablet/tablet-test-util.h"
 #include "yb/tablet/tablet_metadata.h"
+#include "yb/gutil/strings/util.h"
+#include "yb/util/path_util.h"
+#include "yb/util/size_literals.h"
+#include "yb/util/stopwatch.h"
 #include "yb/util/tostring.h"
 #include "yb/tablet/tablet_options.h"
 
+DEFINE_int32(bootstrap_benchmark_num_batches, 10000,
+             "Number of write batches in the log replayed by BootstrapTest.BenchmarkLargeLog");
+
+DECLARE_bool(tablet_bootstrap_reuse_log_segments);
+DECLARE_uint64(log_segment_size_bytes);
+
+using namespace yb::size_literals;
+
 using std::shared_ptr;
 using std::string;
 using std::vector;
@@ -70,6 +82,7 @@ using consensus::ReplicateMsg;
 using consensus::ReplicateMsgPtr;
 using log::Log;
 using log::LogAnchorRegistry;
+using log::LogOptions;
 using log::LogTestBase;
 using log::ReadableLogSegment;
 using server::Clock;
@@ -333,5 +346,108 @@ TEST_F(BootstrapTest, TestConsensusOnlyOperationOutOfOrderHybridTime) {
   ASSERT_EQ(1, results.size());
 }
 
+// Measures bootstrap of a log with many segments: replaying segments in place, rewriting them into
+// a new log, and replaying in place after all entries were flushed to RocksDB, so flushed segments
+// are skipped.
+TEST_F(BootstrapTest, BenchmarkLargeLog) {
+  // Logs opened by bootstrap use default options, so segment size is set via the flag.
+  FLAGS_log_segment_size_bytes = 256_KB;
+  options_ = LogOptions();
+  BuildLog();
+
+  const int num_batches = FLAGS_bootstrap_benchmark_num_batches;
+  LOG_TIMING(INFO, Format("writing $0 batches", num_batches)) {
+    for (int i = 1; i <= num_batches; ++i) {
+      const OpId op_id = MakeOpId(1, i);
+      AppendReplicateBatch(op_id, op_id, {TupleForAppend(i, i, "this is a test insert")},
+                           false /* sync */);
+    }
+    ASSERT_OK(log_->WaitUntilAllFlushed());
+  }
+  ASSERT_OK(log_->Close());
+
+  scoped_refptr<TabletMetadata> meta;
+  for (int run = 0; run != 3; ++run) {
+    FLAGS_tablet_bootstrap_reuse_log_segments = run != 1;
+    ConsensusBootstrapInfo boot_info;
+    shared_ptr<TabletClass> tablet;
+    LOG_TIMING(INFO, Format("bootstrap #$0, reuse log segments: $1",
+                            run, FLAGS_tablet_bootstrap_reuse_log_segments)) {
+      if (run == 0) {
+        ASSERT_OK(BootstrapTestTablet(-1, -1, &tablet, &boot_info));
+      } else {
+        ASSERT_OK(LoadTestTabletMetadata(-1, -1, &meta));
+        ASSERT_OK(RunBootstrapOnTestTablet(meta, &tablet, &boot_info));
+      }
+    }
+    ASSERT_EQ(0, boot_info.orphaned_replicates.size());
+    ASSERT_OPID_EQ(MakeOpId(1, num_batches), boot_info.last_committed_id);
+
+    vector<string> results;
+    IterateTabletRows(tablet.get(), &results);
+    ASSERT_EQ(num_batches, results.size());
+
+    if (run == 1) {
+      // Let the last bootstrap skip segments that contain only flushed entries.
+      ASSERT_OK(tablet->Flush(FlushMode::kSync));
+    }
+    tablet->Shutdown();
+    ASSERT_OK(log_->Close());
+  }
+}
+
+// Restarts the tablet after entries of the first log segments were flushed, so bootstrap skips
+// them, and checks that they still could be read to serve a lagging follower, even when the log
+// index chunks were lost.
+TEST_F(BootstrapTest, ReadSkippedSegmentsAfterRestart) {
+  FLAGS_log_segment_size_bytes = 16_KB;
+  FLAGS_tablet_bootstrap_reuse_log_segments = true;
+  options_ = LogOptions();
+  BuildLog();
+
+  constexpr int kNumBatches = 500;
+  for (int i = 1; i <= kNumBatches; ++i) {
+    const OpId op_id = MakeOpId(1, i);
+    AppendReplicateBatch(op_id, op_id, {TupleForAppend(i, i, "this is a test insert")},
+                         false /* sync */);
+  }
+  ASSERT_OK(log_->WaitUntilAllFlushed());
+  ASSERT_OK(log_->Close());
+
+  scoped_refptr<TabletMetadata> meta;
+  for (int run = 0; run != 2; ++run) {
+    ConsensusBootstrapInfo boot_info;
+    shared_ptr<TabletClass> tablet;
+    if (run == 0) {
+      ASSERT_OK(BootstrapTestTablet(-1, -1, &tablet, &boot_info));
+      ASSERT_OK(tablet->Flush(FlushMode::kSync));
+    } else {
+      // Index chunks are not durable, so they could be lost on crash.
+      std::vector<std::string> children;
+      ASSERT_OK(env_->GetChildren(meta->wal_dir(), ExcludeDots::kTrue, &children));
+      for (const auto& child : children) {
+        if (HasPrefixString(child, "index.")) {
+          gscoped_ptr<WritableFile> file;
+          ASSERT_OK(env_->NewWritableFile(JoinPathSegments(meta->wal_dir(), child), &file));
+          ASSERT_OK(file->Close());
+        }
+      }
+      ASSERT_OK(RunBootstrapOnTestTablet(meta, &tablet, &boot_info));
+      ASSERT_GT(log_->GetLogReader()->num_segments(), 2);
+
+      consensus::ReplicateMsgs replicates;
+      ASSERT_OK(log_->GetLogReader()->ReadReplicatesInRange(
+          1, kNumBatches, log::LogReader::kNoSizeLimit, &replicates));
+      ASSERT_EQ(kNumBatches, replicates.size());
+      for (int i = 0; i != kNumBatches; ++i) {
+        ASSERT_OPID_EQ(MakeOpId(1, i + 1), replicates[i]->id());
+      }
+    }
+    ASSERT_OK(LoadTestTabletMetadata(-1, -1, &meta));
+    tablet->Shutdown();
+    ASSERT_OK(log_->Close());
+  }
+}
+
 } // namespace tablet
 } // namespace yb
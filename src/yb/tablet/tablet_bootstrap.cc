@@ -33,24 +33,42 @@
 
 #include "yb/consensus/consensus.h"
 #include "yb/consensus/log_anchor_registry.h"
+#include "yb/consensus/log_index.h"
 #include "yb/consensus/log_reader.h"
 #include "yb/server/hybrid_clock.h"
 #include "yb/tablet/tablet.h"
 #include "yb/tablet/tablet_peer.h"
 #include "yb/tablet/operations/alter_schema_operation.h"
+#include "yb/tablet/operations/split_operation.h"
 #include "yb/tablet/operations/truncate_operation.h"
 #include "yb/tablet/operations/update_txn_operation.h"
 #include "yb/tablet/operations/write_operation.h"
+#include "yb/gutil/stl_util.h"
+#include "yb/util/blocking_queue.h"
 #include "yb/util/fault_injection.h"
 #include "yb/util/flag_tags.h"
 #include "yb/util/opid.h"
 #include "yb/util/logging.h"
+#include "yb/util/size_literals.h"
 #include "yb/util/stopwatch.h"
+#include "yb/util/thread.h"
+
+using namespace yb::size_literals;
 
 DEFINE_bool(skip_remove_old_recovery_dir, false,
             "Skip removing WAL recovery dir after startup. (useful for debugging)");
 TAG_FLAG(skip_remove_old_recovery_dir, hidden);
 
+DEFINE_bool(tablet_bootstrap_reuse_log_segments, true,
+            "Replay existing WAL segments in place and continue the log after them, instead of "
+            "moving them to the recovery dir and rewriting all entries into a new log. Also "
+            "allows skipping segments that contain only entries already flushed to RocksDB.");
+TAG_FLAG(tablet_bootstrap_reuse_log_segments, advanced);
+
+DEFINE_int64(tablet_bootstrap_prefetch_bytes, 64_MB,
+             "Maximum amount of log entry batches read ahead of replay during tablet bootstrap.");
+TAG_FLAG(tablet_bootstrap_prefetch_bytes, advanced);
+
 DEFINE_test_flag(double, fault_crash_during_log_replay, 0.0,
                  "Fraction of the time when the tablet will crash immediately "
                  "after processing a log entry during log replay.");
@@ -65,6 +83,7 @@ using namespace std::placeholders;
 using std::shared_ptr;
 
 using log::Log;
+using log::LogEntryBatchPB;
 using log::LogEntryPB;
 using log::LogOptions;
 using log::LogReader;
@@ -245,6 +264,134 @@ bool ReplayState::CanApply(LogEntryPB* entry) {
   return consensus::OpIdCompare(entry->replicate().id(), committed_op_id) <= 0;
 }
 
+// ============================================================================
+//  Class LogPrefetcher.
+// ============================================================================
+namespace {
+
+// Entry batch read from a log segment by LogPrefetcher.
+struct PrefetchedBatch {
+  // Index of the segment in the sequence passed to LogPrefetcher.
+  size_t segment_idx;
+
+  // Offset of the batch in the segment.
+  int64_t offset = 0;
+
+  LogEntryBatchPB batch;
+
+  // Set for the item following all batches of the segment, that does not contain a batch.
+  bool end_of_segment = false;
+
+  // Status of reading the segment, set only when end_of_segment is true.
+  Status read_status;
+
+  size_t size = 0;
+};
+
+struct PrefetchedBatchLogicalSize {
+  static size_t logical_size(const PrefetchedBatch* batch) {
+    return batch->size;
+  }
+};
+
+// Reads entry batches of log segments in a separate thread, so reading and decoding of the next
+// batches overlaps with replaying of already read ones. Segments are read batch by batch, and the
+// amount of read but not yet replayed data is limited by --tablet_bootstrap_prefetch_bytes.
+class LogPrefetcher {
+ public:
+  LogPrefetcher(const log::SegmentSequence& segments, size_t first_segment_idx)
+      : segments_(segments),
+        first_segment_idx_(first_segment_idx),
+        queue_(FLAGS_tablet_bootstrap_prefetch_bytes) {
+  }
+
+  ~LogPrefetcher() {
+    Stop();
+  }
+
+  CHECKED_STATUS Start() {
+    return Thread::Create("tablet", "bootstrap-prefetch", &LogPrefetcher::Run, this, &thread_);
+  }
+
+  // Appends batches read so far to 'batches', waiting for at least one batch to be available.
+  // Returns false when all segments were read and all batches were already returned.
+  // Caller takes ownership of returned batches.
+  bool Next(std::vector<PrefetchedBatch*>* batches) {
+    return queue_.BlockingDrainTo(batches);
+  }
+
+  void Stop() {
+    queue_.Shutdown();
+    if (thread_) {
+      CHECK_OK(ThreadJoiner(thread_.get()).Join());
+      thread_.reset();
+    }
+    std::vector<PrefetchedBatch*> left;
+    while (queue_.DrainTo(&left) && !left.empty()) {
+      STLDeleteElements(&left);
+    }
+  }
+
+ private:
+  void Run() {
+    for (size_t idx = first_segment_idx_; idx < segments_.size(); ++idx) {
+      auto read_status = segments_[idx]->ReadEntryBatches(
+          [this, idx](int64_t offset, LogEntryBatchPB* batch) -> Status {
+        auto item = std::make_unique<PrefetchedBatch>();
+        item->segment_idx = idx;
+        item->offset = offset;
+        item->batch.Swap(batch);
+        item->size = item->batch.ByteSize();
+        if (!queue_.BlockingPut(item.get())) {
+          return STATUS(Aborted, "Log prefetching was stopped");
+        }
+        item.release();
+        return Status::OK();
+      });
+
+      auto end_of_segment = std::make_unique<PrefetchedBatch>();
+      end_of_segment->segment_idx = idx;
+      end_of_segment->end_of_segment = true;
+      end_of_segment->read_status = read_status;
+      if (!queue_.BlockingPut(end_of_segment.get())) {
+        return;
+      }
+      end_of_segment.release();
+      if (!read_status.ok()) {
+        // Replay stops at the first segment that could not be read completely.
+        break;
+      }
+    }
+    queue_.Shutdown();
+  }
+
+  const log::SegmentSequence& segments_;
+  const size_t first_segment_idx_;
+  BlockingQueue<PrefetchedBatch*, PrefetchedBatchLogicalSize> queue_;
+  scoped_refptr<Thread> thread_;
+};
+
+// Returns number of leading segments, that contain only entries already flushed to RocksDB, i.e.
+// with index less than flushed_index. Such segments don't have to be read during replay, when they
+// are reused by the new log. The entry with flushed_index itself should still be replayed to get
+// its hybrid time, and only properly closed segments are skipped, since min/max indexes in a rebuilt
+// footer are based on the part of the segment that is readable.
+size_t NumSegmentsToSkip(const log::SegmentSequence& segments, int64_t flushed_index) {
+  size_t result = 0;
+  // The last segment is always replayed, so we know the last op id in the log.
+  while (result + 1 < segments.size()) {
+    const auto& segment = segments[result];
+    if (!segment->HasFooter() || segment->footer_was_rebuilt() ||
+        segment->footer().max_replicate_index() >= flushed_index) {
+      break;
+    }
+    ++result;
+  }
+  return result;
+}
+
+} // namespace
+
 // ============================================================================
 //  Class TabletBootstrap.
 // ============================================================================
@@ -292,7 +439,7 @@ Status TabletBootstrap::Bootstrap(shared_ptr<TabletClass>* rebuilt_tablet,
 
   bool needs_recovery;
   RETURN_NOT_OK(PrepareRecoveryDir(&needs_recovery));
-  if (needs_recovery) {
+  if (needs_recovery && !reuse_log_segments_) {
     RETURN_NOT_OK(OpenLogReaderInRecoveryDir());
   }
 
@@ -317,12 +464,18 @@ Status TabletBootstrap::Bootstrap(shared_ptr<TabletClass>* rebuilt_tablet,
                                            tablet_id));
   }
 
+  auto replay_start = MonoTime::Now();
   RETURN_NOT_OK_PREPEND(PlaySegments(consensus_info), "Failed log replay. Reason");
+  if (data_.times) {
+    data_.times->replay_log = MonoTime::Now().GetDeltaSince(replay_start);
+  }
 
   // Flush the consensus metadata once at the end to persist our changes, if any.
   RETURN_NOT_OK(cmeta_->Flush());
 
-  RETURN_NOT_OK(RemoveRecoveryDir());
+  if (!reuse_log_segments_) {
+    RETURN_NOT_OK(RemoveRecoveryDir());
+  }
   RETURN_NOT_OK(FinishBootstrap("Bootstrap complete.", rebuilt_log, rebuilt_tablet));
 
   return Status::OK();
@@ -331,6 +484,8 @@ Status TabletBootstrap::Bootstrap(shared_ptr<TabletClass>* rebuilt_tablet,
 Status TabletBootstrap::FinishBootstrap(const string& message,
                                         scoped_refptr<log::Log>* rebuilt_log,
                                         shared_ptr<TabletClass>* rebuilt_tablet) {
+  // Replayed APPLYING operations could have already restarted some of the interrupted applies.
+  RETURN_NOT_OK(tablet_->ResumeApplyingIntents());
   tablet_->MarkFinishedBootstrapping();
   listener_->StatusMessage(message);
   rebuilt_tablet->reset(tablet_.release());
@@ -343,9 +498,13 @@ Result<bool> TabletBootstrap::OpenTablet() {//DHQ: 返回值表示是否有数
       meta_, data_.clock, mem_tracker_, metric_registry_, log_anchor_registry_, tablet_options_,
       data_.transaction_participant_context, data_.transaction_coordinator_context);
   // Doing nothing for now except opening a tablet locally.
+  auto open_start = MonoTime::Now();
   LOG_TIMING_PREFIX(INFO, LogPrefix(), "opening tablet") {
     RETURN_NOT_OK(tablet->Open());
   }
+  if (data_.times) {
+    data_.times->open_rocksdb = MonoTime::Now().GetDeltaSince(open_start);
+  }
   Result<bool> has_ss_tables = tablet->HasSSTables();
 
   // In theory, an error can happen in case of tablet Shutdown or in RocksDB object replacement
@@ -414,6 +573,17 @@ Status TabletBootstrap::PrepareRecoveryDir(bool* needs_recovery) {
     *needs_recovery = true;
   }
 
+  if (*needs_recovery && FLAGS_tablet_bootstrap_reuse_log_segments) {
+    // Segments are replayed in place and the log is continued after them. If we crash during
+    // replay, the next bootstrap attempt just replays them again.
+    LOG_WITH_PREFIX(INFO) << "Will replay log segments in place in " << log_dir;
+    // The log index is rebuilt for all reused segments, so stale chunks are never read.
+    RETURN_NOT_OK_PREPEND(log::LogIndex::DeleteChunks(fs_manager->env(), log_dir),
+                          "Failed to delete log index of " + log_dir);
+    reuse_log_segments_ = true;
+    return Status::OK();
+  }
+
   if (*needs_recovery) {
     // Atomically rename the log directory to the recovery directory and then re-create the log
     // directory.
@@ -551,8 +721,10 @@ Status TabletBootstrap::HandleReplicateMessage(ReplayState* state,
     state->rocksdb_last_entry_hybrid_time = HybridTime(replicate.hybrid_time());
   }
 
-  // Append the replicate message to the log as is
-  RETURN_NOT_OK(log_->Append(replicate_entry_ptr->get()));
+  if (!reuse_log_segments_) {
+    // Append the replicate message to the log as is
+    RETURN_NOT_OK(log_->Append(replicate_entry_ptr->get()));
+  }
 
   if (op_id.index() <= state->last_stored_op_id.index()) {//DHQ: 小于已经 apply的 id 的 log
     // Do not update the bootstrap in-memory state for log records that have already been applied to
@@ -610,6 +782,9 @@ Status TabletBootstrap::HandleOperation(consensus::OperationType op_type,
     case consensus::TRUNCATE_OP:
       return PlayTruncateRequest(replicate);
 
+    case consensus::SPLIT_OP:
+      return PlaySplitRequest(replicate);
+
     case consensus::NO_OP:
       return PlayNoOpRequest(replicate);
 
@@ -682,51 +857,105 @@ Status TabletBootstrap::PlaySegments(ConsensusBootstrapInfo* consensus_info) {
                         << state.last_stored_op_id.ShortDebugString();
 
   log::SegmentSequence segments;
-  RETURN_NOT_OK(log_reader_->GetSegmentsSnapshot(&segments));//DHQ: 这个不是文件快照，只是记录开始结束点
-
-  // We defer opening the log until here, so that we properly reproduce the point-in-time schema
-  // from the log we're reading into the log we're writing.
-  RETURN_NOT_OK_PREPEND(OpenNewLog(), "Failed to open new log");
-
-  int segment_count = 0;
-  for (const scoped_refptr<ReadableLogSegment>& segment : segments) {
-    log::LogEntries entries;
-    // TODO: Optimize this to not read the whole thing into memory?
-    Status read_status = segment->ReadEntries(&entries);
-    for (int entry_idx = 0; entry_idx < entries.size(); ++entry_idx) {
-      Status s = HandleEntry(&state, &entries[entry_idx]);
-      if (!s.ok()) {
-        LOG(INFO) << "Dumping replay state to log";
-        DumpReplayStateToLog(state);
-        RETURN_NOT_OK_PREPEND(s, DebugInfo(tablet_->tablet_id(),
-                                           segment->header().sequence_number(),
-                                           entry_idx, segment->path(),
-                                           *entries[entry_idx]));
-      }
+  size_t first_segment_idx = 0;
+  if (reuse_log_segments_) {
+    // The log is opened on top of existing segments and continues in a new segment, so all
+    // segments except the last one should be replayed.
+    RETURN_NOT_OK_PREPEND(OpenNewLog(), "Failed to open log");
+    RETURN_NOT_OK(log_->GetLogReader()->GetSegmentsSnapshot(&segments));
+    CHECK(!segments.empty());
+    segments.pop_back();
+
+    first_segment_idx = NumSegmentsToSkip(segments, state.last_stored_op_id.index());
+    stats_.segments_skipped = first_segment_idx;
+    if (first_segment_idx != 0) {
+      LOG_WITH_PREFIX(INFO) << "Skipping " << first_segment_idx << " of " << segments.size()
+                            << " log segments, that contain only entries flushed to RocksDB";
     }
-
-    // If the LogReader failed to read for some reason, we'll still try to replay as many entries as
-    // possible, and then fail with Corruption.
-    // TODO: this is sort of scary -- why doesn't LogReader expose an entry-by-entry iterator-like
-    // API instead? Seems better to avoid exposing the idea of segments to callers.
-    if (PREDICT_FALSE(!read_status.ok())) {
-      return STATUS(Corruption, Substitute("Error reading Log Segment of tablet $0: $1 "
-                                           "(Read up to entry $2 of segment $3, in path $4)",
-                                           tablet_->tablet_id(),
-                                           read_status.ToString(),
-                                           entries.size(),
-                                           segment->header().sequence_number(),
-                                           segment->path()));
+    // Entries of skipped segments are not replayed, but they still should be in the log index, so
+    // they could be sent to lagging followers.
+    for (size_t idx = 0; idx != first_segment_idx; ++idx) {
+      const auto& segment = segments[idx];
+      const auto sequence_number = segment->header().sequence_number();
+      RETURN_NOT_OK_PREPEND(
+          segment->ReadReplicateIds(
+              [this, sequence_number](int64_t batch_offset, const OpIdPB& op_id) {
+                return log_->RegisterIndexEntry(sequence_number, batch_offset, op_id);
+              }),
+          "Failed to rebuild log index for " + segment->path());
     }
+  } else {
+    RETURN_NOT_OK(log_reader_->GetSegmentsSnapshot(&segments));
+
+    // We defer opening the log until here, so that we properly reproduce the point-in-time schema
+    // from the log we're reading into the log we're writing.
+    RETURN_NOT_OK_PREPEND(OpenNewLog(), "Failed to open new log");
+  }
+
+  LogPrefetcher prefetcher(segments, first_segment_idx);
+  RETURN_NOT_OK(prefetcher.Start());
+
+  int segment_count = first_segment_idx;
+  // Index of the next entry in the current segment.
+  int entry_idx = 0;
+  std::vector<PrefetchedBatch*> batches;
+  ElementDeleter deleter(&batches);
+  log::LogEntries entries;
+  while (prefetcher.Next(&batches)) {
+    for (auto* prefetched : batches) {
+      const auto& segment = segments[prefetched->segment_idx];
+      if (prefetched->end_of_segment) {
+        // If the LogReader failed to read for some reason, we'll still try to replay as many
+        // entries as possible, and then fail with Corruption.
+        if (PREDICT_FALSE(!prefetched->read_status.ok())) {
+          return STATUS(Corruption, Substitute("Error reading Log Segment of tablet $0: $1 "
+                                               "(Read up to entry $2 of segment $3, in path $4)",
+                                               tablet_->tablet_id(),
+                                               prefetched->read_status.ToString(),
+                                               entry_idx,
+                                               segment->header().sequence_number(),
+                                               segment->path()));
+        }
+
+        // TODO: could be more granular here and log during the segments as well, plus give info
+        // about number of MB processed, but this is better than nothing.
+        listener_->StatusMessage(Substitute("Bootstrap replayed $0/$1 log segments. "
+                                            "Stats: $2. Pending: $3 replicates",
+                                            segment_count + 1, segments.size(),
+                                            stats_.ToString(),
+                                            state.pending_replicates.size()));
+        segment_count++;
+        entry_idx = 0;
+        continue;
+      }
+
+      if (reuse_log_segments_) {
+        RETURN_NOT_OK(log_->RegisterReplayedBatch(
+            segment->header().sequence_number(), prefetched->offset, prefetched->batch));
+      }
 
-    // TODO: could be more granular here and log during the segments as well, plus give info about
-    // number of MB processed, but this is better than nothing.
-    listener_->StatusMessage(Substitute("Bootstrap replayed $0/$1 log segments. "
-                                        "Stats: $2. Pending: $3 replicates",
-                                        segment_count + 1, log_reader_->num_segments(),
-                                        stats_.ToString(),
-                                        state.pending_replicates.size()));
-    segment_count++;
+      auto* batch_entries = prefetched->batch.mutable_entry();
+      entries.clear();
+      entries.reserve(batch_entries->size());
+      for (int i = 0; i < batch_entries->size(); ++i) {
+        entries.emplace_back(batch_entries->Mutable(i));
+      }
+      batch_entries->ExtractSubrange(0, batch_entries->size(), nullptr);
+
+      for (auto& entry : entries) {
+        Status s = HandleEntry(&state, &entry);
+        if (!s.ok()) {
+          LOG(INFO) << "Dumping replay state to log";
+          DumpReplayStateToLog(state);
+          RETURN_NOT_OK_PREPEND(s, DebugInfo(tablet_->tablet_id(),
+                                             segment->header().sequence_number(),
+                                             entry_idx, segment->path(),
+                                             *entry));
+        }
+        ++entry_idx;
+      }
+    }
+    STLDeleteElements(&batches);
   }
 
   LOG(INFO) << "Dumping replay state to log at the end of " << __FUNCTION__;
@@ -838,6 +1067,16 @@ Status TabletBootstrap::PlayTruncateRequest(ReplicateMsg* replicate_msg) {
   return Status::OK();
 }
 
+Status TabletBootstrap::PlaySplitRequest(ReplicateMsg* replicate_msg) {
+  // New tablets are created by the tablet manager when the tablet is opened, here we only record
+  // that the tablet was split.
+  SplitOperationState operation_state(nullptr, replicate_msg->mutable_split_request());
+
+  RETURN_NOT_OK_PREPEND(tablet_->ApplySplit(&operation_state), "Failed to Split:");
+
+  return Status::OK();
+}
+
 Status TabletBootstrap::PlayUpdateTransactionRequest(ReplicateMsg* replicate_msg) {
   DCHECK(replicate_msg->has_hybrid_time());
 
@@ -874,10 +1113,12 @@ string TabletBootstrap::LogPrefix() const {
 string TabletBootstrap::Stats::ToString() const {
   return Substitute("ops{read=$0 overwritten=$1} "
                     "inserts{seen=$2 ignored=$3} "
-                    "mutations{seen=$4 ignored=$5}",
+                    "mutations{seen=$4 ignored=$5} "
+                    "segments{skipped=$6}",
                     ops_read, ops_overwritten,
                     inserts_seen, inserts_ignored,
-                    mutations_seen, mutations_ignored);
+                    mutations_seen, mutations_ignored,
+                    segments_skipped);
 }
 
 } // namespace tablet
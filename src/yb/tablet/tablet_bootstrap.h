@@ -78,9 +78,10 @@ class TabletBootstrap {
   // and sets 'needs_recovery' to true, meaning that the previous recovery attempt should be retried
   // from the recovery dir.
   //
-  // Otherwise, if there is a log directory with log files in it, renames that log dir to the log
-  // recovery dir and creates a new, empty log dir so that log replay can proceed. 'needs_recovery'
-  // is also returned as true in this case.
+  // Otherwise, if there is a log directory with log files in it, 'needs_recovery' is also returned
+  // as true. If --tablet_bootstrap_reuse_log_segments is set, log files are replayed in place and
+  // reuse_log_segments_ is set. Otherwise renames that log dir to the log recovery dir and creates a
+  // new, empty log dir so that log replay can proceed.
   //
   // If no log segments are found, 'needs_recovery' is set to false.
   CHECKED_STATUS PrepareRecoveryDir(bool* needs_recovery);
@@ -95,7 +96,8 @@ class TabletBootstrap {
   // "log-recovery" directory.
   CHECKED_STATUS OpenLogReaderInRecoveryDir();
 
-  // Opens a new log in the tablet's log directory.  The directory is expected to be clean.
+  // Opens a new log in the tablet's log directory. The directory is expected to be clean, unless
+  // existing segments are reused, in which case the log continues in a new segment after them.
   CHECKED_STATUS OpenNewLog();
 
   // Finishes bootstrap, setting 'rebuilt_log' and 'rebuilt_tablet'.
@@ -105,7 +107,8 @@ class TabletBootstrap {
 
   // Plays the log segments into the tablet being built.  The process of playing the segments
   // generates a new log that can be continued later on when then tablet is rebuilt and starts
-  // accepting writes from clients.
+  // accepting writes from clients. When existing segments are reused, they become the beginning of
+  // that log instead of being rewritten.
   CHECKED_STATUS PlaySegments(consensus::ConsensusBootstrapInfo* results);
 
   void PlayWriteRequest(consensus::ReplicateMsg* replicate_msg);
@@ -120,6 +123,8 @@ class TabletBootstrap {
 
   CHECKED_STATUS PlayTruncateRequest(consensus::ReplicateMsg* replicate_msg);
 
+  CHECKED_STATUS PlaySplitRequest(consensus::ReplicateMsg* replicate_msg);
+
   void DumpReplayStateToLog(const ReplayState& state);
 
   // Handlers for each type of message seen in the log during replay.
@@ -150,6 +155,10 @@ class TabletBootstrap {
   scoped_refptr<log::Log> log_;
   std::unique_ptr<log::LogReader> log_reader_;
 
+  // Whether existing log segments are replayed in place and reused by the new log, instead of being
+  // moved to the recovery dir and rewritten.
+  bool reuse_log_segments_ = false;
+
   std::unique_ptr<consensus::ConsensusMetadata> cmeta_;
   TabletOptions tablet_options_;
 
@@ -175,6 +184,9 @@ class TabletBootstrap {
     // Number inserts/mutations seen and ignored.
     int inserts_seen, inserts_ignored;
     int mutations_seen, mutations_ignored;
+
+    // Number of log segments that were not read, because all their entries were already flushed.
+    int segments_skipped = 0;
   } stats_;
 
   HybridTime rocksdb_last_entry_hybrid_time_ = HybridTime::kMin;
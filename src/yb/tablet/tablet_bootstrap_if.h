@@ -46,6 +46,7 @@
 #include "yb/gutil/gscoped_ptr.h"
 #include "yb/gutil/ref_counted.h"
 #include "yb/server/clock.h"
+#include "yb/util/monotime.h"
 #include "yb/util/status.h"
 #include "yb/tablet/tablet_options.h"
 #include "yb/tablet/tablet_fwd.h"
@@ -108,6 +109,12 @@ class TabletStatusListener {
   DISALLOW_COPY_AND_ASSIGN(TabletStatusListener);
 };
 
+// Time spent in phases of tablet bootstrap.
+struct BootstrapTimes {
+  MonoDelta open_rocksdb;
+  MonoDelta replay_log;
+};
+
 struct BootstrapTabletData {
   scoped_refptr<TabletMetadata> meta;
   scoped_refptr<server::Clock> clock;
@@ -118,6 +125,8 @@ struct BootstrapTabletData {
   TabletOptions tablet_options;
   TransactionParticipantContext* transaction_participant_context;
   TransactionCoordinatorContext* transaction_coordinator_context;
+  // When not null, receives time spent in phases of bootstrap.
+  BootstrapTimes* times = nullptr;
 };
 
 // Bootstraps a tablet, initializing it with the provided metadata. If the tablet
@@ -81,6 +81,12 @@ namespace tablet {
 
 const int64 kNoDurableMemStore = -1;
 
+namespace {
+
+const char* kIngestDirSuffix = ".ingest";
+
+} // namespace
+
 // ============================================================================
 //  Tablet Metadata
 // ============================================================================
@@ -214,6 +220,15 @@ Status TabletMetadata::DeleteTabletData(TabletDataState delete_type,
     LOG(INFO) << "Successfully destroyed RocksDB at: " << rocksdb_dir_;
   }
 
+  // SST files received for ingestion are not needed anymore.
+  const auto ingest_dir = this->ingest_dir();
+  auto* env = fs_manager_->env();
+  if (env->FileExists(ingest_dir)) {
+    LOG(INFO) << "Deleting ingestion directory: " << ingest_dir;
+    WARN_NOT_OK(env->DeleteRecursively(ingest_dir),
+                "Failed to delete ingestion directory " + ingest_dir);
+  }
+
   // Flushing will sync the new tablet_data_state_ to disk and will now also
   // delete all the data.
   RETURN_NOT_OK(Flush());
@@ -225,6 +240,10 @@ Status TabletMetadata::DeleteTabletData(TabletDataState delete_type,
   return Flush();
 }
 
+std::string TabletMetadata::ingest_dir() const {
+  return rocksdb_dir_ + kIngestDirSuffix;
+}
+
 Status TabletMetadata::DeleteSuperBlock() {
   std::lock_guard<LockType> l(data_lock_);
   if (!orphaned_blocks_.empty()) {
@@ -362,6 +381,9 @@ Status TabletMetadata::LoadFromSuperBlock(const TabletSuperBlockPB& superblock)
     } else {
       tombstone_last_logged_opid_ = OpId();
     }
+
+    has_split_state_ = superblock.has_split_state();
+    split_state_ = superblock.split_state();
   }
 
   // Now is a good time to clean up any orphaned blocks that may have been
@@ -542,6 +564,10 @@ Status TabletMetadata::ToSuperBlockUnlocked(TabletSuperBlockPB* super_block) con
     deleted_col.CopyToPB(pb.mutable_deleted_cols()->Add());
   }
 
+  if (has_split_state_) {
+    *pb.mutable_split_state() = split_state_;
+  }
+
   super_block->Swap(&pb);
   return Status::OK();
 }
@@ -632,6 +658,20 @@ void TabletMetadata::set_tablet_data_state(TabletDataState state) {
   tablet_data_state_ = state;
 }
 
+void TabletMetadata::set_split_state(const SplitTabletStatePB& state) {
+  std::lock_guard<LockType> l(data_lock_);
+  has_split_state_ = true;
+  split_state_ = state;
+}
+
+boost::optional<SplitTabletStatePB> TabletMetadata::split_state() const {
+  std::lock_guard<LockType> l(data_lock_);
+  if (!has_split_state_) {
+    return boost::none;
+  }
+  return split_state_;
+}
+
 string TabletMetadata::LogPrefix() const {
   return Substitute("T $0 P $1: ", tablet_id_, fs_manager_->uuid());
 }
@@ -135,6 +135,9 @@ class TabletMetadata : public RefCountedThreadSafe<TabletMetadata> {
 
   std::string rocksdb_dir() const { return rocksdb_dir_; }
 
+  // Directory next to the RocksDB directory, where SST files are received before ingestion.
+  std::string ingest_dir() const;
+
   std::string wal_dir() const { return wal_dir_; }
 
   // Given the data directory of a tablet, returns the data root dir for that tablet.
@@ -177,6 +180,11 @@ class TabletMetadata : public RefCountedThreadSafe<TabletMetadata> {
   void set_tablet_data_state(TabletDataState state);
   TabletDataState tablet_data_state() const;
 
+  // Set / get the split state, that is present only when the tablet was split. Should be flushed
+  // after setting.
+  void set_split_state(const SplitTabletStatePB& state);
+  boost::optional<SplitTabletStatePB> split_state() const;
+
   // Increments flush pin count by one: if flush pin count > 0,
   // metadata will _not_ be flushed to disk during Flush().
   void PinFlush();
@@ -376,6 +384,10 @@ class TabletMetadata : public RefCountedThreadSafe<TabletMetadata> {
   // to make sure this vector doesn't grow too large.
   std::vector<DeletedColumn> deleted_cols_;
 
+  // Ids of the new tablets and the split key, set when the tablet was split.
+  bool has_split_state_ = false;
+  SplitTabletStatePB split_state_;
+
   DISALLOW_COPY_AND_ASSIGN(TabletMetadata);
 };
 
@@ -74,6 +74,16 @@ METRIC_DEFINE_histogram(
     tablet, write_lock_latency, "Write lock latency", yb::MetricUnit::kMicroseconds,
     "Time taken to acquire key locks for a write operation", 60000000LU, 2);
 
+METRIC_DEFINE_histogram(
+    tablet, follower_apply_batch_wait, "Follower apply batch wait",
+    yb::MetricUnit::kMicroseconds,
+    "Time a write operation on a follower waits in an apply batch, from being added to the batch "
+    "until the batch is written to RocksDB", 60000000LU, 2);
+
+METRIC_DEFINE_histogram(
+    tablet, follower_apply_batch_size, "Follower apply batch size", yb::MetricUnit::kOperations,
+    "Number of write operations merged into a single RocksDB write on a follower", 10000LU, 2);
+
 METRIC_DEFINE_gauge_uint32(tablet, compact_rs_running,
   "RowSet Compactions Running",
   yb::MetricUnit::kMaintenanceOperations,
@@ -108,6 +118,16 @@ METRIC_DEFINE_counter(tablet, leader_memory_pressure_rejections,
   "Leader Memory Pressure Rejections",
   yb::MetricUnit::kRequests,
   "Number of RPC requests rejected due to memory pressure while LEADER.");
+METRIC_DEFINE_counter(tablet, write_admission_rejections,
+  "Write Admission Rejections",
+  yb::MetricUnit::kRequests,
+  "Number of write RPC requests rejected because flushes, compactions or replication of the "
+  "tablet fall behind writes.");
+METRIC_DEFINE_counter(tablet, quota_rejections,
+  "Quota Rejections",
+  yb::MetricUnit::kRequests,
+  "Number of read and write RPC requests rejected because the table or its namespace is over its "
+  "quota.");
 
 using strings::Substitute;
 
@@ -121,7 +141,11 @@ TabletMetrics::TabletMetrics(const scoped_refptr<MetricEntity>& entity)
     MINIT(ql_read_latency),
     MINIT(write_lock_latency),
     MINIT(write_op_duration_client_propagated_consistency),
-    MINIT(leader_memory_pressure_rejections) {
+    MINIT(follower_apply_batch_wait),
+    MINIT(follower_apply_batch_size),
+    MINIT(leader_memory_pressure_rejections),
+    MINIT(write_admission_rejections),
+    MINIT(quota_rejections) {
 }
 #undef MINIT
 
@@ -59,8 +59,12 @@ struct TabletMetrics {
   scoped_refptr<Histogram> write_lock_latency;
   scoped_refptr<Histogram> write_op_duration_client_propagated_consistency;
   scoped_refptr<Histogram> write_op_duration_commit_wait_consistency;
+  scoped_refptr<Histogram> follower_apply_batch_wait;
+  scoped_refptr<Histogram> follower_apply_batch_size;
 
   scoped_refptr<Counter> leader_memory_pressure_rejections;
+  scoped_refptr<Counter> write_admission_rejections;
+  scoped_refptr<Counter> quota_rejections;
 };
 
 class ScopedTabletMetricsTracker {
@@ -20,12 +20,19 @@ class MemoryMonitor;
 }
 
 namespace yb {
+
+class ThreadPool;
+
 namespace tablet {
 
 struct TabletOptions {
   std::shared_ptr<rocksdb::Cache> block_cache;
+  // Optional secondary block cache tier, that keeps blocks in compressed form.
+  std::shared_ptr<rocksdb::Cache> block_cache_compressed;
   std::shared_ptr<rocksdb::MemoryMonitor> memory_monitor;
   std::vector<std::shared_ptr<rocksdb::EventListener>> listeners;
+  // Optional pool used to insert large write batches into the memtable from several threads.
+  ThreadPool* memtable_insert_pool = nullptr;
 };
 
 } // namespace tablet
@@ -68,6 +68,7 @@
 
 #include "yb/tablet/operations/alter_schema_operation.h"
 #include "yb/tablet/operations/operation_driver.h"
+#include "yb/tablet/operations/split_operation.h"
 #include "yb/tablet/operations/truncate_operation.h"
 #include "yb/tablet/operations/write_operation.h"
 #include "yb/tablet/operations/update_txn_operation.h"
@@ -158,7 +159,9 @@ Status TabletPeer::InitTabletPeer(const shared_ptr<TabletClass> &tablet,
                                   const scoped_refptr<Log> &log,
                                   const scoped_refptr<MetricEntity> &metric_entity,
                                   ThreadPool* raft_pool,
-                                  ThreadPool* tablet_prepare_pool) {
+                                  ThreadPool* tablet_prepare_pool,
+                                  consensus::MultiRaftManager* multi_raft_manager,
+                                  consensus::LogCacheRegistry* log_cache_registry) {
 
   DCHECK(tablet) << "A TabletPeer must be provided with a Tablet";
   DCHECK(log) << "A TabletPeer must be provided with a Log";
@@ -214,7 +217,9 @@ Status TabletPeer::InitTabletPeer(const shared_ptr<TabletClass> &tablet,
         mark_dirty_clbk_,
         tablet_->table_type(),
         std::bind(&Tablet::LostLeadership, tablet.get()),//DHQ: 有个LostLeadership注册
-        raft_pool);
+        raft_pool,
+        multi_raft_manager,
+        log_cache_registry);
 
     auto ht_lease_provider = [this](MicrosTime min_allowed, MonoTime deadline) {
       MicrosTime lease_micros {
@@ -248,6 +253,9 @@ Status TabletPeer::InitTabletPeer(const shared_ptr<TabletClass> &tablet,
     });
 
     prepare_thread_ = std::make_unique<Preparer>(consensus_.get(), tablet_prepare_pool);//DHQ: 初始化prepare_thread_
+
+    write_admission_controller_ = std::make_unique<WriteAdmissionController>(
+        std::bind(&TabletPeer::CollectWriteDebt, this));
   }
 
   RETURN_NOT_OK(prepare_thread_->Start());
@@ -448,6 +456,33 @@ Status TabletPeer::SubmitWrite(std::unique_ptr<WriteOperationState> state) {
   return Status::OK();
 }
 
+Status TabletPeer::CheckWriteAdmission() {
+  return write_admission_controller_ ? write_admission_controller_->Admit() : Status::OK();
+}
+
+WriteDebt TabletPeer::CollectWriteDebt() {
+  std::shared_ptr<TabletClass> tablet;
+  scoped_refptr<RaftConsensus> consensus;
+  {
+    std::lock_guard<simple_spinlock> lock(lock_);
+    tablet = tablet_;
+    consensus = consensus_;
+  }
+
+  WriteDebt result;
+  if (tablet) {
+    tablet->GetWriteDebt(&result);
+  }
+  if (consensus) {
+    consensus::OpId received, committed;
+    if (consensus->GetLastOpId(consensus::RECEIVED_OPID, &received).ok() &&
+        consensus->GetLastOpId(consensus::COMMITTED_OPID, &committed).ok()) {
+      result.uncommitted_ops = std::max<int64_t>(received.index() - committed.index(), 0);
+    }
+  }
+  return result;
+}
+
 void TabletPeer::Submit(std::unique_ptr<Operation> operation) {
   auto status = CheckRunning();
 
@@ -543,6 +578,9 @@ consensus::OperationType MapOperationTypeToPB(OperationType operation_type) {
     case OperationType::kTruncate:
       return consensus::TRUNCATE_OP;
 
+    case OperationType::kSplit:
+      return consensus::SPLIT_OP;
+
     case OperationType::kEmpty:
       LOG(FATAL) << "OperationType::kEmpty cannot be converted to consensus::OperationType";
   }
@@ -685,6 +723,12 @@ std::unique_ptr<Operation> TabletPeer::CreateOperation(consensus::ReplicateMsg*
       return std::make_unique<TruncateOperation>(
           std::make_unique<TruncateOperationState>(tablet()), consensus::REPLICA);
 
+    case consensus::SPLIT_OP:
+      DCHECK(replicate_msg->has_split_request()) << "SPLIT_OP replica"
+          " operation must receive an SplitTabletRequestPB";
+      return std::make_unique<SplitOperation>(
+          std::make_unique<SplitOperationState>(tablet()), consensus::REPLICA);
+
     case consensus::SNAPSHOT_OP: FALLTHROUGH_INTENDED;
     case consensus::UNKNOWN_OP: FALLTHROUGH_INTENDED;
     case consensus::NO_OP: FALLTHROUGH_INTENDED;
@@ -742,6 +786,14 @@ void TabletPeer::SetPropagatedSafeTime(HybridTime ht) {
   (**driver).ExecuteAsync();
 }
 
+void TabletPeer::StartApplyBatch() {
+  tablet_->StartApplyBatch();
+}
+
+void TabletPeer::FinishApplyBatch() {
+  tablet_->FinishApplyBatch();
+}
+
 const std::string& TabletPeer::permanent_uuid() const {
   if (cached_permanent_uuid_initialized_.load(std::memory_order_acquire)) {
     return cached_permanent_uuid_;
@@ -802,6 +854,14 @@ void TabletPeer::RegisterMaintenanceOps(MaintenanceManager* maint_mgr) {
   gscoped_ptr<MaintenanceOp> log_gc(new LogGCOp(this));
   maint_mgr->RegisterOp(log_gc.get());
   maintenance_ops_.push_back(log_gc.release());
+
+  gscoped_ptr<MaintenanceOp> flush(new FlushOp(this));
+  maint_mgr->RegisterOp(flush.get());
+  maintenance_ops_.push_back(flush.release());
+
+  gscoped_ptr<MaintenanceOp> compaction(new CompactionOp(this));
+  maint_mgr->RegisterOp(compaction.get());
+  maintenance_ops_.push_back(compaction.release());
 }
 
 void TabletPeer::UnregisterMaintenanceOps() {
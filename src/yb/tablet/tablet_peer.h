@@ -54,6 +54,7 @@
 #include "yb/tablet/preparer.h"
 #include "yb/tablet/tablet_options.h"
 #include "yb/tablet/tablet_fwd.h"
+#include "yb/tablet/write_admission_controller.h"
 
 #include "yb/util/metrics.h"
 #include "yb/util/semaphore.h"
@@ -63,6 +64,8 @@ using yb::consensus::StateChangeContext;
 namespace yb {
 
 namespace consensus {
+class LogCacheRegistry;
+class MultiRaftManager;
 class RaftConsensus;
 }
 
@@ -106,7 +109,9 @@ class TabletPeer : public RefCountedThreadSafe<TabletPeer>,
                                 const scoped_refptr<log::Log> &log,
                                 const scoped_refptr<MetricEntity> &metric_entity,
                                 ThreadPool* raft_pool,
-                                ThreadPool* tablet_prepare_pool);
+                                ThreadPool* tablet_prepare_pool,
+                                consensus::MultiRaftManager* multi_raft_manager = nullptr,
+                                consensus::LogCacheRegistry* log_cache_registry = nullptr);
 
   // Starts the TabletPeer, making it available for Write()s. If this
   // TabletPeer is part of a consensus configuration this will connect it to other peers
@@ -134,6 +139,10 @@ class TabletPeer : public RefCountedThreadSafe<TabletPeer>,
   // The operation_state is deallocated after use by this function.
   CHECKED_STATUS SubmitWrite(std::unique_ptr<WriteOperationState> operation_state);
 
+  // Returns ServiceUnavailable when the write should be rejected, because flushes, compactions
+  // or replication of this tablet fall behind writes.
+  CHECKED_STATUS CheckWriteAdmission();
+
   void Submit(std::unique_ptr<Operation> operation);
 
   HybridTime Now() override;
@@ -156,6 +165,10 @@ class TabletPeer : public RefCountedThreadSafe<TabletPeer>,
   // UpdateReplica -> EnqueuePreparesUnlocked on Raft heartbeats.
   void SetPropagatedSafeTime(HybridTime ht) override;
 
+  void StartApplyBatch() override;
+
+  void FinishApplyBatch() override;
+
   consensus::Consensus* consensus() const;
 
   scoped_refptr<consensus::Consensus> shared_consensus() const;
@@ -341,6 +354,8 @@ class TabletPeer : public RefCountedThreadSafe<TabletPeer>,
 
   std::unique_ptr<Preparer> prepare_thread_;//DHQ: 单独的prepare_thread
 
+  std::unique_ptr<WriteAdmissionController> write_admission_controller_;
+
   // Pool that executes apply tasks for transactions. This is a multi-threaded
   // pool, constructor-injected by either the Master (for system tables) or
   // the Tablet server.
@@ -367,6 +382,8 @@ class TabletPeer : public RefCountedThreadSafe<TabletPeer>,
   mutable std::string cached_permanent_uuid_;
 
  private:
+  WriteDebt CollectWriteDebt();
+
   std::shared_future<client::YBClientPtr> client_future_;
 
   DISALLOW_COPY_AND_ASSIGN(TabletPeer);
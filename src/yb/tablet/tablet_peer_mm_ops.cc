@@ -54,6 +54,38 @@ METRIC_DEFINE_histogram(tablet, log_gc_duration,
                         yb::MetricUnit::kMilliseconds,
                         "Time spent garbage collecting the logs.", 60000LU, 1);
 
+METRIC_DEFINE_gauge_uint32(tablet, mm_flush_running,
+                           "Maintenance Flushes Running",
+                           yb::MetricUnit::kOperations,
+                           "Number of flushes started by the maintenance manager currently "
+                           "running.");
+METRIC_DEFINE_histogram(tablet, mm_flush_duration,
+                        "Maintenance Flush Duration",
+                        yb::MetricUnit::kMilliseconds,
+                        "Time spent on flushes started by the maintenance manager.", 60000LU, 1);
+METRIC_DEFINE_gauge_uint32(tablet, mm_compaction_running,
+                           "Maintenance Compactions Scheduling",
+                           yb::MetricUnit::kOperations,
+                           "Number of compaction scheduling requests from the maintenance manager "
+                           "currently running.");
+METRIC_DEFINE_histogram(tablet, mm_compaction_duration,
+                        "Maintenance Compaction Scheduling Duration",
+                        yb::MetricUnit::kMilliseconds,
+                        "Time spent on scheduling compactions by the maintenance manager.",
+                        60000LU, 1);
+
+DEFINE_int32(maintenance_flush_threshold_secs, 120,
+             "Age of the oldest unflushed write, after which the maintenance manager considers "
+             "flushing the memtables of a tablet. 0 to ignore the age.");
+TAG_FLAG(maintenance_flush_threshold_secs, advanced);
+TAG_FLAG(maintenance_flush_threshold_secs, runtime);
+
+DEFINE_int64(maintenance_flush_min_memtables_size_bytes, 32 * 1024 * 1024,
+             "Size of the memtables of a tablet, after which the maintenance manager considers "
+             "flushing them. 0 to ignore the size.");
+TAG_FLAG(maintenance_flush_min_memtables_size_bytes, advanced);
+TAG_FLAG(maintenance_flush_min_memtables_size_bytes, runtime);
+
 namespace yb {
 namespace tablet {
 
@@ -108,5 +140,124 @@ scoped_refptr<AtomicGauge<uint32_t> > LogGCOp::RunningGauge() const {
   return log_gc_running_;
 }
 
+//
+// FlushOp.
+//
+
+FlushOp::FlushOp(TabletPeer* tablet_peer)
+    : MaintenanceOp(StringPrintf("FlushOp(%s)", tablet_peer->tablet()->tablet_id().c_str()),
+                    MaintenanceOp::HIGH_IO_USAGE),
+      tablet_peer_(tablet_peer),
+      flush_duration_(METRIC_mm_flush_duration.Instantiate(
+                          tablet_peer->tablet()->GetMetricEntity())),
+      flush_running_(METRIC_mm_flush_running.Instantiate(
+                         tablet_peer->tablet()->GetMetricEntity(), 0)),
+      sem_(1) {}
+
+void FlushOp::UpdateStats(MaintenanceOpStats* stats) {
+  auto tablet = tablet_peer_->shared_tablet();
+  if (!tablet) {
+    return;
+  }
+  WriteDebt debt;
+  tablet->GetWriteDebt(&debt);
+  stats->set_ram_anchored(debt.memtables_size);
+  stats->set_io_cost_bytes(debt.memtables_size);
+
+  // Small and recent memtables are left to RocksDB, flushing them early would only produce small
+  // SST files, so they do not improve performance. Memory pressure is handled by ram_anchored.
+  bool worth_flushing = false;
+  const int64_t min_size = FLAGS_maintenance_flush_min_memtables_size_bytes;
+  if (min_size > 0 && implicit_cast<int64_t>(debt.memtables_size) >= min_size) {
+    worth_flushing = true;
+  }
+  const HybridTime oldest_write = tablet->flush_stats()->oldest_write_in_memstore();
+  if (debt.memtables_size != 0 && oldest_write != HybridTime::kMax &&
+      FLAGS_maintenance_flush_threshold_secs > 0) {
+    const int64_t age_micros = static_cast<int64_t>(
+        tablet->clock()->Now().GetPhysicalValueMicros() - oldest_write.GetPhysicalValueMicros());
+    if (age_micros >= FLAGS_maintenance_flush_threshold_secs * 1000000LL) {
+      worth_flushing = true;
+    }
+  }
+  stats->set_perf_improvement(worth_flushing ? 1.0 : 0.0);
+  stats->set_runnable(debt.memtables_size != 0 && sem_.GetValue() == 1);
+}
+
+bool FlushOp::Prepare() {
+  return sem_.try_lock();
+}
+
+void FlushOp::Perform() {
+  CHECK(!sem_.try_lock());
+
+  auto tablet = tablet_peer_->shared_tablet();
+  Status s = tablet ? tablet->Flush(FlushMode::kSync) : Status::OK();
+  if (!s.ok()) {
+    LOG(WARNING) << "Failed to flush tablet " << tablet_peer_->tablet_id() << ": " << s;
+  }
+
+  sem_.unlock();
+}
+
+scoped_refptr<Histogram> FlushOp::DurationHistogram() const {
+  return flush_duration_;
+}
+
+scoped_refptr<AtomicGauge<uint32_t> > FlushOp::RunningGauge() const {
+  return flush_running_;
+}
+
+//
+// CompactionOp.
+//
+
+CompactionOp::CompactionOp(TabletPeer* tablet_peer)
+    : MaintenanceOp(StringPrintf("CompactionOp(%s)", tablet_peer->tablet()->tablet_id().c_str()),
+                    MaintenanceOp::HIGH_IO_USAGE),
+      tablet_peer_(tablet_peer),
+      compaction_duration_(METRIC_mm_compaction_duration.Instantiate(
+                               tablet_peer->tablet()->GetMetricEntity())),
+      compaction_running_(METRIC_mm_compaction_running.Instantiate(
+                              tablet_peer->tablet()->GetMetricEntity(), 0)),
+      sem_(1) {}
+
+void CompactionOp::UpdateStats(MaintenanceOpStats* stats) {
+  auto tablet = tablet_peer_->shared_tablet();
+  if (!tablet || !tablet->RocksDBCompactionPending()) {
+    return;
+  }
+  WriteDebt debt;
+  tablet->GetWriteDebt(&debt);
+  stats->set_perf_improvement(debt.num_sst_files);
+  stats->set_io_cost_bytes(tablet->GetTotalSSTFileSizes());
+  stats->set_runnable(sem_.GetValue() == 1);
+}
+
+bool CompactionOp::Prepare() {
+  return sem_.try_lock();
+}
+
+void CompactionOp::Perform() {
+  CHECK(!sem_.try_lock());
+
+  auto tablet = tablet_peer_->shared_tablet();
+  Status s = tablet ? tablet->ScheduleRocksDBCompaction() : Status::OK();
+  if (!s.ok()) {
+    LOG(WARNING) << "Failed to schedule compaction of tablet " << tablet_peer_->tablet_id() << ": "
+                 << s;
+  }
+
+  sem_.unlock();
+}
+
+scoped_refptr<Histogram> CompactionOp::DurationHistogram() const {
+  return compaction_duration_;
+}
+
+scoped_refptr<AtomicGauge<uint32_t> > CompactionOp::RunningGauge() const {
+  return compaction_running_;
+}
+
 }  // namespace tablet
 }  // namespace yb
@@ -70,6 +70,62 @@ class LogGCOp : public MaintenanceOp {
   mutable Semaphore sem_;
 };
 
+// Maintenance task that flushes memtables of the tablet. Reports the memtables size as anchored
+// RAM. Performance improvement is reported only for memtables that are large, or hold writes older
+// than maintenance_flush_threshold_secs, so they are flushed before they retain too much log.
+//
+// Only one flush op can run at a time.
+class FlushOp : public MaintenanceOp {
+ public:
+  explicit FlushOp(TabletPeer* tablet_peer);
+
+  virtual void UpdateStats(MaintenanceOpStats* stats) override;
+
+  virtual bool Prepare() override;
+
+  virtual void Perform() override;
+
+  virtual scoped_refptr<Histogram> DurationHistogram() const override;
+
+  virtual scoped_refptr<AtomicGauge<uint32_t> > RunningGauge() const override;
+
+ private:
+  TabletPeer *const tablet_peer_;
+  scoped_refptr<Histogram> flush_duration_;
+  scoped_refptr<AtomicGauge<uint32_t> > flush_running_;
+  mutable Semaphore sem_;
+};
+
+// Maintenance task that asks RocksDB to schedule the compactions its universal compaction picker
+// wants for the tablet. Runnable when the picker has work but no compaction is running, for
+// example because compactions were postponed while the background threads were busy. Performance
+// improvement is the read amplification, that is the number of SST files, and the IO cost is the
+// size of all SST files, since a universal compaction can rewrite all of them. So the IO budget of
+// the maintenance manager limits how often compactions are started this way. Compactions that
+// RocksDB schedules itself after flushes are not affected.
+//
+// Only one compaction op can run at a time.
+class CompactionOp : public MaintenanceOp {
+ public:
+  explicit CompactionOp(TabletPeer* tablet_peer);
+
+  virtual void UpdateStats(MaintenanceOpStats* stats) override;
+
+  virtual bool Prepare() override;
+
+  virtual void Perform() override;
+
+  virtual scoped_refptr<Histogram> DurationHistogram() const override;
+
+  virtual scoped_refptr<AtomicGauge<uint32_t> > RunningGauge() const override;
+
+ private:
+  TabletPeer *const tablet_peer_;
+  scoped_refptr<Histogram> compaction_duration_;
+  scoped_refptr<AtomicGauge<uint32_t> > compaction_running_;
+  mutable Semaphore sem_;
+};
+
 } // namespace tablet
 } // namespace yb
 
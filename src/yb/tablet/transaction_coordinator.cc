@@ -838,6 +838,11 @@ class TransactionCoordinator::Impl : public TransactionStateContext {
     }
   }
 
+  // Poll stays on its own timer instead of being a maintenance op. Expired transactions should be
+  // aborted, and committed transactions should be applied, within transaction_check_interval_usec,
+  // since clients and participants wait for it, even while the maintenance manager is busy with
+  // flushes. Poll itself does no IO, status changes are replicated through Raft, and the log they
+  // retain is freed by LogGCOp.
   void SchedulePoll() {
     poll_task_id_ = context_.client_future().get()->messenger()->scheduler().Schedule(
         std::bind(&Impl::Poll, this, _1),
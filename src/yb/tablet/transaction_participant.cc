@@ -15,7 +15,11 @@
 
 #include "yb/tablet/transaction_participant.h"
 
+#include <condition_variable>
+#include <deque>
 #include <mutex>
+#include <thread>
+#include <unordered_set>
 
 #include <boost/multi_index_container.hpp>
 #include <boost/multi_index/hashed_index.hpp>
@@ -37,8 +41,11 @@
 
 #include "yb/tserver/tserver_service.pb.h"
 
+#include "yb/util/atomic.h"
+#include "yb/util/flag_tags.h"
 #include "yb/util/locks.h"
 #include "yb/util/monotime.h"
+#include "yb/util/thread.h"
 
 using namespace std::literals;
 using namespace std::placeholders;
@@ -46,6 +53,15 @@ using namespace std::placeholders;
 DEFINE_uint64(transaction_delay_status_reply_usec_in_tests, 0,
               "For tests only. Delay handling status reply by specified amount of usec.");
 
+DEFINE_int32(txn_apply_retry_delay_ms, 1000,
+             "Delay before retrying to apply batch of transaction intents in background, after "
+             "previous attempt failed.");
+TAG_FLAG(txn_apply_retry_delay_ms, advanced);
+TAG_FLAG(txn_apply_retry_delay_ms, runtime);
+
+DEFINE_bool(transaction_pause_background_apply_in_tests, false,
+            "For tests only. Do not apply intents of transactions in background.");
+
 namespace yb {
 namespace tablet {
 
@@ -390,10 +406,34 @@ class TransactionParticipant::Impl {
       : context_(*context), log_prefix_(context->tablet_id() + ": ") {}
 
   ~Impl() {
+    Shutdown();
     transactions_.clear();
     rpcs_.Shutdown();
   }
 
+  void Shutdown() {
+    {
+      std::lock_guard<std::mutex> lock(apply_mutex_);
+      apply_stopped_ = true;
+      apply_cond_.notify_one();
+    }
+    if (apply_thread_) {
+      WARN_NOT_OK(ThreadJoiner(apply_thread_.get()).Join(), "Failed to join apply thread");
+      apply_thread_ = nullptr;
+    }
+  }
+
+  bool HasTransactions() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (!transactions_.empty()) {
+        return true;
+      }
+    }
+    std::lock_guard<std::mutex> lock(apply_mutex_);
+    return !applying_.empty() || !apply_queue_.empty();
+  }
+
   // Adds new running transaction.
   void Add(const TransactionMetadataPB& data, rocksdb::WriteBatch *write_batch) {
     auto metadata = TransactionMetadata::FromPB(data);
@@ -471,11 +511,79 @@ class TransactionParticipant::Impl {
       std::lock_guard<std::mutex> lock(mutex_);
       // It is our last chance to load transaction metadata, if missing.
       // Because it will be deleted when intents are applied.
-      FindOrLoad(data.transaction_id);
+      auto it = FindOrLoad(data.transaction_id);
+      if (it != transactions_.end()) {
+        // Intents could be applied in several batches, so set local commit time before applying
+        // them, to let readers resolve not yet applied intents as committed.
+        transactions_.modify(it, [&data](RunningTransaction& transaction) {
+          transaction.SetLocalCommitTime(data.commit_ht);
+        });
+      }
+    }
+
+    {
+      std::lock_guard<std::mutex> lock(apply_mutex_);
+      if (applying_.count(data.transaction_id)) {
+        // Intents of this transaction are already being applied in background.
+        return Status::OK();
+      }
     }
 
-    CHECK_OK(data.applier->ApplyIntents(data));
+    auto apply_state = data.applier->ApplyIntents(data);
+    CHECK_OK(apply_state);
+    if (apply_state->has_key()) {
+      TransactionApplyData background_data = data;
+      background_data.apply_state = std::move(*apply_state);
+      ApplyInBackground(std::move(background_data));
+      return Status::OK();
+    }
 
+    return ApplyDone(data);
+  }
+
+  CHECKED_STATUS ResumeApplying(TransactionIntentApplier* applier) {
+    return docdb::EnumerateApplyTransactionStates(
+        db_,
+        [this, applier](const TransactionId& id, const docdb::ApplyTransactionStatePB& state) {
+      {
+        std::lock_guard<std::mutex> lock(apply_mutex_);
+        if (applying_.count(id)) {
+          // Apply was restarted by replayed APPLYING operation.
+          return;
+        }
+      }
+      TransactionApplyData data;
+      // Actual mode is picked when apply completes, see ExecuteApply.
+      data.mode = ProcessingMode::NON_LEADER;
+      data.applier = applier;
+      data.transaction_id = id;
+      data.op_id = state.op_id();
+      data.commit_ht = HybridTime(state.commit_ht());
+      data.log_ht = HybridTime(state.log_ht());
+      data.apply_state = state;
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = FindOrLoad(id);
+        if (it != transactions_.end()) {
+          data.status_tablet = it->metadata().status_tablet;
+          transactions_.modify(it, [&data](RunningTransaction& transaction) {
+            transaction.SetLocalCommitTime(data.commit_ht);
+          });
+        }
+      }
+      LOG_WITH_PREFIX(INFO) << "Resume applying intents of " << id << " from "
+                            << state.ShortDebugString();
+      ApplyInBackground(std::move(data));
+    });
+  }
+
+  void SetDB(rocksdb::DB* db) {
+    db_ = db;
+  }
+
+ private:
+  // Invoked when all intents of transaction have been applied.
+  CHECKED_STATUS ApplyDone(const TransactionApplyData& data) {
     {
       std::lock_guard<std::mutex> lock(mutex_);
       auto it = FindOrLoad(data.transaction_id);
@@ -518,11 +626,68 @@ class TransactionParticipant::Impl {
     return Status::OK();
   }
 
-  void SetDB(rocksdb::DB* db) {
-    db_ = db;
+  // Continues applying intents of transaction in background. Transactions are processed in
+  // round robin manner, one batch at a time.
+  void ApplyInBackground(TransactionApplyData data) {
+    std::lock_guard<std::mutex> lock(apply_mutex_);
+    if (apply_stopped_) {
+      return;
+    }
+    applying_.insert(data.transaction_id);
+    apply_queue_.push_back(std::move(data));
+    if (!apply_thread_) {
+      // Queued data is kept if thread could not be started, so next call will try again.
+      auto status = yb::Thread::Create(
+          "transaction", "apply_intents", &Impl::ExecuteApply, this, &apply_thread_);
+      LOG_IF_WITH_PREFIX(WARNING, !status.ok()) << "Failed to start apply thread: " << status;
+    }
+    apply_cond_.notify_one();
+  }
+
+  void ExecuteApply() {
+    std::unique_lock<std::mutex> lock(apply_mutex_);
+    while (!apply_stopped_) {
+      if (apply_queue_.empty()) {
+        apply_cond_.wait(lock);
+        continue;
+      }
+      if (GetAtomicFlag(&FLAGS_transaction_pause_background_apply_in_tests)) {
+        apply_cond_.wait_for(lock, 100ms);
+        continue;
+      }
+      auto data = std::move(apply_queue_.front());
+      apply_queue_.pop_front();
+      lock.unlock();
+      auto apply_state = data.applier->ApplyIntents(data);
+      bool done = false;
+      if (!apply_state.ok()) {
+        // Nothing was written, so the same batch is retried later. Apply state stored by the
+        // previous batch is kept, so apply is also resumed after restart.
+        LOG_WITH_PREFIX(WARNING) << "Failed to apply intents of " << data.transaction_id << ": "
+                                 << apply_state.status() << ", will retry";
+      } else if (apply_state->has_key()) {
+        data.apply_state = std::move(*apply_state);
+      } else {
+        // Leadership could change while intents were applied in background, or apply could be
+        // resumed after restart, so status tablet is notified only if we are leader now.
+        data.mode = context_.LeaderStatus() == consensus::Consensus::LeaderStatus::NOT_LEADER
+            ? ProcessingMode::NON_LEADER : ProcessingMode::LEADER;
+        WARN_NOT_OK(ApplyDone(data), "Failed to complete apply");
+        done = true;
+      }
+      lock.lock();
+      if (done) {
+        applying_.erase(data.transaction_id);
+      } else {
+        apply_queue_.push_back(std::move(data));
+      }
+      if (!apply_state.ok()) {
+        apply_cond_.wait_for(
+            lock, FLAGS_txn_apply_retry_delay_ms * 1ms, [this] { return apply_stopped_; });
+      }
+    }
   }
 
- private:
   typedef boost::multi_index_container<RunningTransaction,
       boost::multi_index::indexed_by <
           boost::multi_index::hashed_unique <
@@ -583,6 +748,14 @@ class TransactionParticipant::Impl {
 
   rocksdb::DB* db_ = nullptr;
   std::mutex mutex_;
+
+  // Transactions which intents are being applied in background.
+  std::mutex apply_mutex_;
+  std::condition_variable apply_cond_;
+  scoped_refptr<Thread> apply_thread_;
+  bool apply_stopped_ = false;
+  std::deque<TransactionApplyData> apply_queue_;
+  std::unordered_set<TransactionId, TransactionIdHash> applying_;
   rpc::Rpcs rpcs_;
   Transactions transactions_;
   std::atomic<int64_t> request_serial_{0};
@@ -629,5 +802,17 @@ void TransactionParticipant::SetDB(rocksdb::DB* db) {
   impl_->SetDB(db);
 }
 
+Status TransactionParticipant::ResumeApplying(TransactionIntentApplier* applier) {
+  return impl_->ResumeApplying(applier);
+}
+
+void TransactionParticipant::Shutdown() {
+  impl_->Shutdown();
+}
+
+bool TransactionParticipant::HasTransactions() const {
+  return impl_->HasTransactions();
+}
+
 } // namespace tablet
 } // namespace yb
@@ -27,8 +27,11 @@
 #include "yb/common/hybrid_time.h"
 #include "yb/common/transaction.h"
 
+#include "yb/consensus/consensus.h"
 #include "yb/consensus/opid_util.h"
 
+#include "yb/docdb/docdb.pb.h"
+
 #include "yb/util/opid.pb.h"
 #include "yb/util/result.h"
 
@@ -50,19 +53,25 @@ class TransactionIntentApplier;
 
 struct TransactionApplyData {
   ProcessingMode mode;
-  // Applier should be alive until ProcessApply returns.
+  // Applier should be alive until ProcessApply returns, or until Shutdown if intents are applied in
+  // background.
   TransactionIntentApplier* applier;
   TransactionId transaction_id;
   consensus::OpId op_id;
   HybridTime commit_ht;
   HybridTime log_ht;
   TabletId status_tablet;
+  // State to continue applying from, when intents are applied in several batches.
+  docdb::ApplyTransactionStatePB apply_state;
 };
 
 // Interface to object that should apply intents in RocksDB when transaction is applying.
 class TransactionIntentApplier {
  public:
-  virtual CHECKED_STATUS ApplyIntents(const TransactionApplyData& data) = 0;
+  // Applies next batch of transaction intents, continuing from data.apply_state if it has key.
+  // Returns state to continue from, that has no key when all intents have been applied.
+  virtual Result<docdb::ApplyTransactionStatePB> ApplyIntents(
+      const TransactionApplyData& data) = 0;
 
  protected:
   ~TransactionIntentApplier() {}
@@ -74,6 +83,7 @@ class TransactionParticipantContext {
   virtual const std::shared_future<client::YBClientPtr>& client_future() const = 0;
   virtual HybridTime Now() = 0;
   virtual void UpdateClock(HybridTime hybrid_time) = 0;
+  virtual consensus::Consensus::LeaderStatus LeaderStatus() const = 0;
 
  protected:
   ~TransactionParticipantContext() {}
@@ -100,10 +110,23 @@ class TransactionParticipant : public TransactionStatusManager {
 
   void Abort(const TransactionId& id, TransactionStatusCallback callback) override;
 
+  // Applies intents of the transaction. Transactions having too many intents to apply them in one
+  // batch are applied in background.
   CHECKED_STATUS ProcessApply(const TransactionApplyData& data);
 
   void SetDB(rocksdb::DB* db);
 
+  // Resumes applying intents of transactions, whose apply was interrupted by restart. Should be
+  // invoked after bootstrap, transactions already applying after log replay are skipped.
+  CHECKED_STATUS ResumeApplying(TransactionIntentApplier* applier);
+
+  // Stops applying intents in background, should be invoked before DB is closed.
+  void Shutdown();
+
+  // Returns true if there are running transactions, or transactions whose intents are being
+  // applied.
+  bool HasTransactions() const;
+
  private:
   class Impl;
   std::unique_ptr<Impl> impl_;
@@ -0,0 +1,79 @@
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+
+#include <gtest/gtest.h>
+
+#include "yb/tablet/write_admission_controller.h"
+
+#include "yb/util/test_util.h"
+
+DECLARE_double(write_admission_soft_limit_ratio);
+DECLARE_int32(write_admission_refresh_interval_ms);
+DECLARE_int32(write_admission_uncommitted_ops_limit);
+
+namespace yb {
+namespace tablet {
+
+class WriteAdmissionControllerTest : public YBTest {
+};
+
+TEST_F(WriteAdmissionControllerTest, Pressure) {
+  FLAGS_write_admission_soft_limit_ratio = 0.5;
+  FLAGS_write_admission_uncommitted_ops_limit = 1000;
+
+  WriteDebt debt;
+  const char* reason = nullptr;
+  ASSERT_EQ(0, WriteAdmissionController::Pressure(debt, &reason));
+
+  debt.num_sst_files = 12;
+  debt.sst_files_stop_limit = 48;
+  // Full memtable is being flushed as usual, writes are not rejected.
+  debt.memtables_size = 256;
+  debt.num_immutable_memtables = 1;
+  debt.immutable_memtables_stop_limit = 2;
+  debt.uncommitted_ops = 100;
+  ASSERT_DOUBLE_EQ(0.5, WriteAdmissionController::Pressure(debt, &reason));
+  ASSERT_STREQ("immutable memtables", reason);
+  ASSERT_EQ(0, WriteAdmissionController::RejectionProbability(0.5));
+
+  debt.num_sst_files = 36;
+  ASSERT_DOUBLE_EQ(0.75, WriteAdmissionController::Pressure(debt, &reason));
+  ASSERT_STREQ("SST files", reason);
+  ASSERT_DOUBLE_EQ(0.5, WriteAdmissionController::RejectionProbability(0.75));
+
+  debt.uncommitted_ops = 2000;
+  ASSERT_DOUBLE_EQ(2, WriteAdmissionController::Pressure(debt, &reason));
+  ASSERT_STREQ("uncommitted operations", reason);
+  ASSERT_EQ(1, WriteAdmissionController::RejectionProbability(2));
+}
+
+TEST_F(WriteAdmissionControllerTest, Admit) {
+  FLAGS_write_admission_soft_limit_ratio = 0.5;
+  FLAGS_write_admission_refresh_interval_ms = 0;
+
+  WriteDebt debt;
+  debt.sst_files_stop_limit = 48;
+  WriteAdmissionController controller([&debt] { return debt; });
+
+  ASSERT_OK(controller.Admit());
+
+  debt.num_sst_files = 48;
+  auto status = controller.Admit();
+  ASSERT_TRUE(status.IsServiceUnavailable()) << status;
+
+  debt.num_sst_files = 10;
+  ASSERT_OK(controller.Admit());
+}
+
+} // namespace tablet
+} // namespace yb
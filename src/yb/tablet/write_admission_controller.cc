@@ -0,0 +1,149 @@
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+
+#include "yb/tablet/write_admission_controller.h"
+
+#include <gflags/gflags.h>
+
+#include "yb/util/flag_tags.h"
+#include "yb/util/format.h"
+#include "yb/util/monotime.h"
+#include "yb/util/random_util.h"
+
+DEFINE_bool(enable_write_admission_control, true,
+            "Reject writes to tablets, whose flushes, compactions or replication fall behind, with "
+            "a retryable error before RocksDB stalls writes.");
+TAG_FLAG(enable_write_admission_control, advanced);
+TAG_FLAG(enable_write_admission_control, runtime);
+
+DEFINE_int32(write_admission_refresh_interval_ms, 100,
+             "How often the write debt of a tablet is collected for write admission control.");
+TAG_FLAG(write_admission_refresh_interval_ms, advanced);
+TAG_FLAG(write_admission_refresh_interval_ms, runtime);
+
+DEFINE_double(write_admission_soft_limit_ratio, 0.5,
+              "Ratio of the write debt to its limit, at which writes start to be rejected. "
+              "Rejection probability grows linearly from 0 at this ratio to 1 at the limit.");
+TAG_FLAG(write_admission_soft_limit_ratio, advanced);
+TAG_FLAG(write_admission_soft_limit_ratio, runtime);
+
+DEFINE_int64(write_admission_pending_compaction_bytes_limit, 64LL * 1024 * 1024 * 1024,
+             "Estimated pending compaction bytes of a tablet, at which all writes are rejected. "
+             "0 to ignore pending compaction bytes.");
+TAG_FLAG(write_admission_pending_compaction_bytes_limit, advanced);
+TAG_FLAG(write_admission_pending_compaction_bytes_limit, runtime);
+
+DEFINE_int32(write_admission_uncommitted_ops_limit, 5000,
+             "Number of operations, that were appended to the leader log but not committed yet, "
+             "at which all writes are rejected. 0 to ignore replication lag.");
+TAG_FLAG(write_admission_uncommitted_ops_limit, advanced);
+TAG_FLAG(write_admission_uncommitted_ops_limit, runtime);
+
+namespace yb {
+namespace tablet {
+
+namespace {
+
+void UpdatePressure(double value, double limit, const char* name, double* pressure,
+                    const char** reason) {
+  if (limit <= 0) {
+    return;
+  }
+  double current = value / limit;
+  if (current > *pressure) {
+    *pressure = current;
+    *reason = name;
+  }
+}
+
+} // namespace
+
+std::string WriteDebt::ToString() const {
+  return Format("{ pending_compaction_bytes: $0 num_sst_files: $1 sst_files_stop_limit: $2 "
+                "memtables_size: $3 num_immutable_memtables: $4 "
+                "immutable_memtables_stop_limit: $5 uncommitted_ops: $6 }",
+                pending_compaction_bytes, num_sst_files, sst_files_stop_limit, memtables_size,
+                num_immutable_memtables, immutable_memtables_stop_limit, uncommitted_ops);
+}
+
+WriteAdmissionController::WriteAdmissionController(DebtProvider debt_provider)
+    : debt_provider_(std::move(debt_provider)) {
+}
+
+double WriteAdmissionController::Pressure(const WriteDebt& debt, const char** reason) {
+  double result = 0;
+  *reason = "none";
+  UpdatePressure(debt.pending_compaction_bytes,
+                 FLAGS_write_admission_pending_compaction_bytes_limit,
+                 "pending compaction bytes", &result, reason);
+  UpdatePressure(debt.num_sst_files, debt.sst_files_stop_limit, "SST files", &result, reason);
+  UpdatePressure(debt.num_immutable_memtables, debt.immutable_memtables_stop_limit,
+                 "immutable memtables", &result, reason);
+  UpdatePressure(debt.uncommitted_ops, FLAGS_write_admission_uncommitted_ops_limit,
+                 "uncommitted operations", &result, reason);
+  return result;
+}
+
+double WriteAdmissionController::RejectionProbability(double pressure) {
+  const double soft_limit = FLAGS_write_admission_soft_limit_ratio;
+  if (pressure >= 1) {
+    return 1;
+  }
+  if (pressure <= soft_limit || soft_limit >= 1) {
+    return 0;
+  }
+  return (pressure - soft_limit) / (1 - soft_limit);
+}
+
+void WriteAdmissionController::Refresh(uint64_t now) {
+  std::unique_lock<std::mutex> lock(mutex_, std::try_to_lock);
+  if (!lock.owns_lock()) {
+    // Other thread is collecting the debt.
+    return;
+  }
+  next_refresh_.store(
+      now + MonoDelta::FromMilliseconds(FLAGS_write_admission_refresh_interval_ms).ToNanoseconds(),
+      std::memory_order_release);
+
+  auto debt = debt_provider_();
+  const char* reason;
+  double pressure = Pressure(debt, &reason);
+  auto probability = RejectionProbability(pressure);
+  if (probability > 0) {
+    description_ = Format("$0 at $1% of limit: $2", reason, static_cast<int>(pressure * 100),
+                          debt);
+  }
+  rejection_probability_.store(probability, std::memory_order_release);
+}
+
+Status WriteAdmissionController::Admit() {
+  if (!FLAGS_enable_write_admission_control) {
+    return Status::OK();
+  }
+
+  const auto now = MonoTime::Now().ToUint64();
+  if (now >= next_refresh_.load(std::memory_order_acquire)) {
+    Refresh(now);
+  }
+
+  if (!RandomActWithProbability(rejection_probability_.load(std::memory_order_acquire))) {
+    return Status::OK();
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  return STATUS_FORMAT(ServiceUnavailable, "Write rejected by admission control, $0",
+                       description_);
+}
+
+}  // namespace tablet
+}  // namespace yb
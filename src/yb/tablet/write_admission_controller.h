@@ -0,0 +1,96 @@
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+
+#ifndef YB_TABLET_WRITE_ADMISSION_CONTROLLER_H
+#define YB_TABLET_WRITE_ADMISSION_CONTROLLER_H
+
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <string>
+
+#include "yb/util/status.h"
+
+namespace yb {
+namespace tablet {
+
+// Background work debt of a tablet, that grows when flushes, compactions or replication fall
+// behind writes.
+struct WriteDebt {
+  // Estimated number of bytes that should be rewritten by compactions.
+  uint64_t pending_compaction_bytes = 0;
+
+  uint64_t num_sst_files = 0;
+
+  // Number of SST files at which RocksDB stops writes.
+  uint64_t sst_files_stop_limit = 0;
+
+  // Total size of active and immutable memtables.
+  uint64_t memtables_size = 0;
+
+  // Number of immutable memtables, that are not flushed yet.
+  uint64_t num_immutable_memtables = 0;
+
+  // Number of immutable memtables at which RocksDB stops writes. A memtable being flushed as usual
+  // is only a part of this limit, so writes are not rejected during every flush.
+  uint64_t immutable_memtables_stop_limit = 0;
+
+  // Number of operations appended to the leader log, but not committed yet.
+  int64_t uncommitted_ops = 0;
+
+  std::string ToString() const;
+};
+
+// Decides whether a write to the tablet should be admitted, so writes are rejected with a
+// retryable status before RocksDB stalls the apply thread.
+//
+// Each kind of debt is converted to a pressure, that is the ratio of the debt to its limit.
+// Writes are rejected with probability that grows linearly from 0, when the max pressure is
+// write_admission_soft_limit_ratio, to 1, when the max pressure reaches 1.
+class WriteAdmissionController {
+ public:
+  typedef std::function<WriteDebt()> DebtProvider;
+
+  explicit WriteAdmissionController(DebtProvider debt_provider);
+
+  // Returns ServiceUnavailable if the write should be rejected. The debt is collected at most
+  // once per write_admission_refresh_interval_ms.
+  CHECKED_STATUS Admit();
+
+  // Returns max pressure of the debt, and stores the name of the debt with max pressure to reason.
+  static double Pressure(const WriteDebt& debt, const char** reason);
+
+  // Returns probability of write rejection for specified pressure.
+  static double RejectionProbability(double pressure);
+
+ private:
+  void Refresh(uint64_t now);
+
+  const DebtProvider debt_provider_;
+
+  // MonoTime when the debt should be collected again.
+  std::atomic<uint64_t> next_refresh_{0};
+
+  std::atomic<double> rejection_probability_{0};
+
+  // Protects refresh and description_.
+  std::mutex mutex_;
+
+  // Description of the last collected debt, used in the status of rejected writes.
+  std::string description_;
+};
+
+}  // namespace tablet
+}  // namespace yb
+
+#endif  // YB_TABLET_WRITE_ADMISSION_CONTROLLER_H
@@ -0,0 +1,298 @@
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+
+#include "yb/tools/bulk_load_sst_writer.h"
+
+#include <algorithm>
+#include <queue>
+
+#include <glog/logging.h>
+
+#include "yb/rocksdb/comparator.h"
+#include "yb/rocksdb/env.h"
+#include "yb/rocksdb/immutable_options.h"
+
+#include "yb/gutil/casts.h"
+
+#include "yb/util/coding.h"
+#include "yb/util/env.h"
+#include "yb/util/faststring.h"
+#include "yb/util/format.h"
+#include "yb/util/path_util.h"
+
+namespace yb {
+namespace tools {
+
+namespace {
+
+constexpr size_t kRunIOBufferSize = 1024 * 1024;
+constexpr size_t kRunRecordHeaderSize = sizeof(uint32_t);
+
+// Reads key/value pairs from a run file written by BulkLoadSstWriter::Spill.
+class RunReader {
+ public:
+  explicit RunReader(std::string path) : path_(std::move(path)) {}
+
+  CHECKED_STATUS Open() {
+    return Env::Default()->NewSequentialFile(path_, &file_);
+  }
+
+  // Reads the next pair, returns false when the end of the run is reached.
+  Result<bool> Next() {
+    if (!VERIFY_RESULT(ReadLengthPrefixed(&key_, /* allow_eof */ true))) {
+      return false;
+    }
+    if (!VERIFY_RESULT(ReadLengthPrefixed(&value_, /* allow_eof */ false))) {
+      return STATUS_FORMAT(Corruption, "Unexpected end of run file: $0", path_);
+    }
+    return true;
+  }
+
+  const std::string& key() const { return key_; }
+  const std::string& value() const { return value_; }
+
+ private:
+  Result<bool> ReadLengthPrefixed(std::string* out, bool allow_eof) {
+    uint8_t header[kRunRecordHeaderSize];
+    size_t read = VERIFY_RESULT(ReadBytes(header, sizeof(header)));
+    if (read == 0 && allow_eof) {
+      return false;
+    }
+    if (read != sizeof(header)) {
+      return STATUS_FORMAT(Corruption, "Truncated record in run file: $0", path_);
+    }
+    out->resize(DecodeFixed32(header));
+    read = VERIFY_RESULT(ReadBytes(pointer_cast<uint8_t*>(&(*out)[0]), out->size()));
+    if (read != out->size()) {
+      return STATUS_FORMAT(Corruption, "Truncated record in run file: $0", path_);
+    }
+    return true;
+  }
+
+  // Reads up to size bytes into out, returns number of bytes read, that is less than size only
+  // at the end of file.
+  Result<size_t> ReadBytes(uint8_t* out, size_t size) {
+    size_t done = 0;
+    while (done < size) {
+      if (chunk_.empty()) {
+        scratch_.resize(kRunIOBufferSize);
+        RETURN_NOT_OK(file_->Read(scratch_.size(), &chunk_, scratch_.data()));
+        if (chunk_.empty()) {
+          break;
+        }
+      }
+      const size_t n = std::min(size - done, chunk_.size());
+      memcpy(out + done, chunk_.data(), n);
+      chunk_.remove_prefix(n);
+      done += n;
+    }
+    return done;
+  }
+
+  const std::string path_;
+  gscoped_ptr<SequentialFile> file_;
+  std::vector<uint8_t> scratch_;
+  Slice chunk_;
+  std::string key_;
+  std::string value_;
+};
+
+} // namespace
+
+// Writes sorted pairs into a sequence of SST files, starting a new file when the current one
+// reaches max_file_size.
+class BulkLoadSstWriter::Output {
+ public:
+  Output(const std::string& dir, const rocksdb::Options& options, size_t max_file_size)
+      : dir_(dir), options_(options), ioptions_(options), max_file_size_(max_file_size) {}
+
+  CHECKED_STATUS Add(const Slice& key, const Slice& value) {
+    if (has_last_key_ && options_.comparator->Compare(key, last_key_) == 0) {
+      // All rows are written with the same hybrid time, so the same key means the same row
+      // was present several times in the input.
+      return Status::OK();
+    }
+    if (!writer_ || current_size_ >= max_file_size_) {
+      RETURN_NOT_OK(FinishFile());
+      writer_ = std::make_unique<rocksdb::SstFileWriter>(
+          rocksdb::EnvOptions(), ioptions_, options_.comparator);
+      RETURN_NOT_OK(writer_->Open(JoinPathSegments(dir_, Format("$0.sst", files_.size() + 1))));
+      current_size_ = 0;
+    }
+    RETURN_NOT_OK(writer_->Add(key, value));
+    current_size_ += key.size() + value.size();
+    last_key_.assign(key.cdata(), key.size());
+    has_last_key_ = true;
+    return Status::OK();
+  }
+
+  CHECKED_STATUS FinishFile() {
+    if (!writer_) {
+      return Status::OK();
+    }
+    rocksdb::ExternalSstFileInfo file_info;
+    RETURN_NOT_OK(writer_->Finish(&file_info));
+    writer_.reset();
+    files_.push_back(std::move(file_info));
+    return Status::OK();
+  }
+
+  std::vector<rocksdb::ExternalSstFileInfo>& files() { return files_; }
+
+ private:
+  const std::string& dir_;
+  const rocksdb::Options& options_;
+  const rocksdb::ImmutableCFOptions ioptions_;
+  const size_t max_file_size_;
+
+  std::unique_ptr<rocksdb::SstFileWriter> writer_;
+  size_t current_size_ = 0;
+  std::string last_key_;
+  bool has_last_key_ = false;
+  std::vector<rocksdb::ExternalSstFileInfo> files_;
+};
+
+BulkLoadSstWriter::BulkLoadSstWriter(std::string dir, const rocksdb::Options& options,
+                                     size_t sort_buffer_size, size_t max_file_size)
+    : dir_(std::move(dir)),
+      options_(options),
+      sort_buffer_size_(sort_buffer_size),
+      max_file_size_(max_file_size) {
+}
+
+BulkLoadSstWriter::~BulkLoadSstWriter() {
+  for (const auto& run : runs_) {
+    WARN_NOT_OK(Env::Default()->DeleteFile(run), "Failed to delete run file");
+  }
+}
+
+Status BulkLoadSstWriter::Add(KeyValues* key_values) {
+  KeyValues to_spill;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto& key_value : *key_values) {
+      buffer_size_ += key_value.first.size() + key_value.second.size();
+      buffer_.push_back(std::move(key_value));
+    }
+    if (buffer_size_ >= sort_buffer_size_) {
+      // Sort and write the buffer outside of the lock, so other threads could continue adding
+      // pairs for this tablet.
+      to_spill.swap(buffer_);
+      buffer_size_ = 0;
+    }
+  }
+  key_values->clear();
+
+  if (!to_spill.empty()) {
+    return Spill(&to_spill);
+  }
+  return Status::OK();
+}
+
+void BulkLoadSstWriter::SortKeyValues(KeyValues* key_values) const {
+  const auto* comparator = options_.comparator;
+  std::sort(key_values->begin(), key_values->end(),
+            [comparator](const auto& lhs, const auto& rhs) {
+    return comparator->Compare(lhs.first, rhs.first) < 0;
+  });
+}
+
+Status BulkLoadSstWriter::Spill(KeyValues* key_values) {
+  SortKeyValues(key_values);
+
+  std::string path;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    path = JoinPathSegments(dir_, Format("run-$0.tmp", ++next_run_));
+  }
+  VLOG(1) << "Spilling " << key_values->size() << " pairs to " << path;
+
+  gscoped_ptr<WritableFile> file;
+  RETURN_NOT_OK(Env::Default()->NewWritableFile(path, &file));
+  faststring buffer;
+  for (const auto& key_value : *key_values) {
+    PutFixed32LengthPrefixedSlice(&buffer, key_value.first);
+    PutFixed32LengthPrefixedSlice(&buffer, key_value.second);
+    if (buffer.size() >= kRunIOBufferSize) {
+      RETURN_NOT_OK(file->Append(buffer));
+      buffer.clear();
+    }
+  }
+  if (buffer.size() != 0) {
+    RETURN_NOT_OK(file->Append(buffer));
+  }
+  RETURN_NOT_OK(file->Close());
+  key_values->clear();
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  runs_.push_back(std::move(path));
+  return Status::OK();
+}
+
+Status BulkLoadSstWriter::MergeRuns(Output* output) {
+  std::vector<std::unique_ptr<RunReader>> readers;
+  readers.reserve(runs_.size());
+  for (const auto& run : runs_) {
+    readers.push_back(std::make_unique<RunReader>(run));
+    RETURN_NOT_OK(readers.back()->Open());
+  }
+
+  const auto* comparator = options_.comparator;
+  auto greater = [comparator](RunReader* lhs, RunReader* rhs) {
+    return comparator->Compare(lhs->key(), rhs->key()) > 0;
+  };
+  std::priority_queue<RunReader*, std::vector<RunReader*>, decltype(greater)> queue(greater);
+  for (const auto& reader : readers) {
+    if (VERIFY_RESULT(reader->Next())) {
+      queue.push(reader.get());
+    }
+  }
+
+  while (!queue.empty()) {
+    auto* reader = queue.top();
+    queue.pop();
+    RETURN_NOT_OK(output->Add(reader->key(), reader->value()));
+    if (VERIFY_RESULT(reader->Next())) {
+      queue.push(reader);
+    }
+  }
+  return Status::OK();
+}
+
+Result<std::vector<rocksdb::ExternalSstFileInfo>> BulkLoadSstWriter::Finish() {
+  Output output(dir_, options_, max_file_size_);
+  if (runs_.empty()) {
+    // Everything fits into memory, so there is no need to merge anything.
+    SortKeyValues(&buffer_);
+    for (const auto& key_value : buffer_) {
+      RETURN_NOT_OK(output.Add(key_value.first, key_value.second));
+    }
+  } else {
+    if (!buffer_.empty()) {
+      RETURN_NOT_OK(Spill(&buffer_));
+    }
+    RETURN_NOT_OK(MergeRuns(&output));
+    for (const auto& run : runs_) {
+      RETURN_NOT_OK(Env::Default()->DeleteFile(run));
+    }
+    runs_.clear();
+  }
+  KeyValues().swap(buffer_);
+  buffer_size_ = 0;
+
+  RETURN_NOT_OK(output.FinishFile());
+  return std::move(output.files());
+}
+
+} // namespace tools
+} // namespace yb
@@ -0,0 +1,81 @@
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+
+#ifndef YB_TOOLS_BULK_LOAD_SST_WRITER_H
+#define YB_TOOLS_BULK_LOAD_SST_WRITER_H
+
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "yb/rocksdb/options.h"
+#include "yb/rocksdb/sst_file_writer.h"
+
+#include "yb/util/result.h"
+#include "yb/util/status.h"
+
+namespace yb {
+namespace tools {
+
+// Writes key/value pairs of a single tablet into final SST files, bypassing memtables and
+// compactions.
+//
+// Pairs are accumulated in memory until sort_buffer_size is reached, then sorted and spilled to a
+// run file in dir. Finish merges all runs into SST files of at most max_file_size bytes each, that
+// have non overlapping key ranges and could be ingested into the tablet as is.
+class BulkLoadSstWriter {
+ public:
+  typedef std::vector<std::pair<std::string, std::string>> KeyValues;
+
+  BulkLoadSstWriter(std::string dir, const rocksdb::Options& options, size_t sort_buffer_size,
+                    size_t max_file_size);
+
+  ~BulkLoadSstWriter();
+
+  // Adds pairs to the writer, key_values is cleared. Keys should be complete RocksDB keys, i.e.
+  // contain hybrid time. Could be invoked concurrently from multiple threads.
+  CHECKED_STATUS Add(KeyValues* key_values);
+
+  // Writes SST files with all added pairs and removes run files. Should be invoked after all Add
+  // calls completed. If the same key was added several times, only one of its values is written.
+  Result<std::vector<rocksdb::ExternalSstFileInfo>> Finish();
+
+  const std::string& dir() const { return dir_; }
+
+ private:
+  class Output;
+
+  // Sorts key_values and writes them to a new run file.
+  CHECKED_STATUS Spill(KeyValues* key_values);
+
+  CHECKED_STATUS MergeRuns(Output* output);
+
+  void SortKeyValues(KeyValues* key_values) const;
+
+  const std::string dir_;
+  const rocksdb::Options options_;
+  const size_t sort_buffer_size_;
+  const size_t max_file_size_;
+
+  std::mutex mutex_;
+  KeyValues buffer_;
+  size_t buffer_size_ = 0;
+  std::vector<std::string> runs_;
+  size_t next_run_ = 0;
+};
+
+} // namespace tools
+} // namespace yb
+
+#endif // YB_TOOLS_BULK_LOAD_SST_WRITER_H
@@ -601,5 +601,84 @@ TEST_F_EX(YBBulkLoadTest, TestCLITool, YBBulkLoadTestWithoutRebalancing) {
   }
 }
 
+TEST_F_EX(YBBulkLoadTest, TestDirectSstLoad, YBBulkLoadTestWithoutRebalancing) {
+  // Generate rows and compute their tablets ourselves, the tool partitions raw rows on its own.
+  std::map<string, vector<string>> tabletid_to_line;
+  vector<string> generated_rows;
+  for (int i = 0; i < kNumIterations; i++) {
+    string row = GenerateRow(i);
+    string tablet_id;
+    string partition_key;
+    ASSERT_OK(partition_generator_->LookupTabletId(row, &tablet_id, &partition_key));
+    tabletid_to_line[tablet_id].push_back(row);
+    generated_rows.push_back(std::move(row));
+  }
+
+  string test_dir;
+  Env* env = Env::Default();
+  ASSERT_OK(env->GetTestDirectory(&test_dir));
+  string bulk_load_data = JoinPathSegments(test_dir, "bulk_load_direct_data");
+  if (env->FileExists(bulk_load_data)) {
+    ASSERT_OK(env->DeleteRecursively(bulk_load_data));
+  }
+  ASSERT_OK(env->CreateDir(bulk_load_data));
+
+  // Small sort buffer, SST file size and chunk size make the tool spill runs, produce multiple SST
+  // files per tablet and stream each file in several chunks.
+  vector<string> bulk_load_argv = {
+      kBulkLoadToolName,
+      "-master_addresses", master_addresses_comma_separated_,
+      "-table_name", kTableName,
+      "-namespace_name", kNamespace,
+      "-base_dir", bulk_load_data,
+      "-row_batch_size", std::to_string(kNumIterations / kNumTablets / 10),
+      "-bulk_load_direct_sst",
+      "-bulk_load_sort_buffer_bytes", "65536",
+      "-bulk_load_max_sst_file_size", "262144",
+      "-bulk_load_ingest_chunk_size", "16384",
+      "-export_files"
+  };
+
+  FILE *out;
+  FILE *in;
+  std::unique_ptr<Subprocess> bulk_load_process;
+  ASSERT_OK(StartProcessAndGetStreams(GetToolPath(kBulkLoadToolName), bulk_load_argv, &out, &in,
+                                      &bulk_load_process));
+  for (const string& row : generated_rows) {
+    ASSERT_GT(fprintf(out, "%s\n", row.c_str()), 0);
+  }
+  ASSERT_EQ(0, fflush(out));
+  CloseStreamsAndWaitForProcess(out, in, bulk_load_process.get());
+
+  for (const auto& tablet_and_lines : tabletid_to_line) {
+    const string& tablet_id = tablet_and_lines.first;
+    // Ingested files are moved to the tablet servers.
+    ASSERT_FALSE(env->FileExists(JoinPathSegments(bulk_load_data, tablet_id)));
+
+    master::TabletLocationsPB tablet_location;
+    VerifyTabletId(tablet_id, &tablet_location);
+    Endpoint leader_tserver;
+    for (const master::TabletLocationsPB::ReplicaPB& replica : tablet_location.replicas()) {
+      if (replica.role() == consensus::RaftPeerPB_Role::RaftPeerPB_Role_LEADER) {
+        ASSERT_OK(EndpointFromHostPortPB(replica.ts_info().rpc_addresses(0), &leader_tserver));
+        break;
+      }
+    }
+    tserver::TabletServerServiceProxy tserver_proxy(client_messenger_, leader_tserver);
+
+    for (const string& row : tablet_and_lines.second) {
+      tserver::ReadRequestPB req;
+      req.set_tablet_id(tablet_id);
+      QLReadRequestPB* ql_req = req.mutable_ql_batch()->Add();
+      ASSERT_OK(CreateQLReadRequest(row, ql_req));
+
+      std::unique_ptr<QLRowBlock> rowblock;
+      PerformRead(req, &tserver_proxy, &rowblock);
+      ASSERT_EQ(1, rowblock->row_count());
+      ValidateRow(row, rowblock->row(0));
+    }
+  }
+}
+
 } // namespace tools
 } // namespace yb
@@ -13,6 +13,7 @@
 
 #include <sched.h>
 #include <iostream>
+#include <mutex>
 #include <thread>
 #include <boost/algorithm/string.hpp>
 
@@ -21,6 +22,7 @@
 
 #include "yb/rocksdb/db.h"
 #include "yb/rocksdb/options.h"
+#include "yb/rocksdb/db/filename.h"
 #include "yb/client/client.h"
 #include "yb/common/entity_ids.h"
 #include "yb/common/hybrid_time.h"
@@ -29,9 +31,12 @@
 #include "yb/common/ql_protocol.pb.h"
 #include "yb/docdb/docdb.h"
 #include "yb/docdb/doc_operation.h"
+#include "yb/docdb/docdb_rocksdb_util.h"
 #include "yb/rpc/messenger.h"
 #include "yb/rpc/rpc_controller.h"
+#include "yb/tablet/tablet_options.h"
 #include "yb/tools/bulk_load_docdb_util.h"
+#include "yb/tools/bulk_load_sst_writer.h"
 #include "yb/tools/bulk_load_utils.h"
 #include "yb/tools/yb-generate_partitions.h"
 #include "yb/tserver/tserver_service.proxy.h"
@@ -58,6 +63,7 @@ using yb::client::YBTableName;
 using yb::docdb::DocWriteBatch;
 using yb::docdb::InitMarkerBehavior;
 using yb::operator"" _GB;
+using yb::operator"" _MB;
 
 DEFINE_string(master_addresses, "", "Comma-separated list of YB Master server addresses");
 DEFINE_string(table_name, "", "Name of the table to generate partitions for");
@@ -82,32 +88,72 @@ DEFINE_int32(bulk_load_max_background_flushes, 2, "Number of flushes to perform
 DEFINE_uint64(bulk_load_num_files_per_tablet, 5,
               "Determines how to compact the data of a tablet to ensure we have only a certain "
               "number of sst files per tablet");
+DEFINE_bool(bulk_load_direct_sst, false,
+            "Partition input rows using the table's partition schema and write final SST files of "
+            "each tablet directly, without memtables and compactions. Input lines are plain CSV "
+            "rows in this mode. With --export_files the files are streamed to all replicas of the "
+            "tablet and ingested there.");
+DEFINE_int64(bulk_load_sort_buffer_bytes, 256_MB,
+             "Amount of key/value data per tablet sorted in memory before spilling it to disk in "
+             "--bulk_load_direct_sst mode");
+DEFINE_int64(bulk_load_max_sst_file_size, 2_GB,
+             "Approximate maximum size of SST files written in --bulk_load_direct_sst mode");
+DEFINE_int32(bulk_load_ingest_chunk_size, 1_MB,
+             "Size of chunks used to stream SST files to tablet servers");
 
 namespace yb {
 namespace tools {
 
 namespace {
 
+CHECKED_STATUS PopulateColumnValue(const string &column,
+                                   const DataType data_type,
+                                   QLExpressionPB *column_value);
+
+// Applies insert of the row to doc_write_batch and returns id of the tablet the row belongs to.
+CHECKED_STATUS InsertRow(const string &row,
+                         const Schema &schema,
+                         docdb::DocWriteBatch *const doc_write_batch,
+                         YBPartitionGenerator *const partition_generator,
+                         TabletId *tablet_id);
+
 class BulkLoadTask : public Runnable {
  public:
   BulkLoadTask(vector<pair<TabletId, string>> rows, BulkLoadDocDBUtil *db_fixture,
                const YBTable *table, YBPartitionGenerator *partition_generator);
   void Run();
  private:
-  CHECKED_STATUS PopulateColumnValue(const string &column,
-                                     const DataType data_type,
-                                     QLExpressionPB *column_value);
-  CHECKED_STATUS InsertRow(const string &row,
-                           const Schema &schema,
-                           BulkLoadDocDBUtil *const db_fixture,
-                           docdb::DocWriteBatch *const doc_write_batch,
-                           YBPartitionGenerator *const partition_generator);
   vector<pair<TabletId, string>> rows_;
   BulkLoadDocDBUtil *const db_fixture_;
   const YBTable *const table_;
   YBPartitionGenerator *const partition_generator_;
 };
 
+class BulkLoad;
+
+// Converts rows into DocDB key/value pairs and passes them to SST writers of their tablets.
+class DirectBulkLoadTask : public Runnable {
+ public:
+  DirectBulkLoadTask(vector<string> rows, BulkLoad* bulk_load)
+      : rows_(std::move(rows)), bulk_load_(bulk_load) {}
+  void Run();
+ private:
+  vector<string> rows_;
+  BulkLoad* const bulk_load_;
+};
+
+// Writes final SST files of a tablet and ingests them into its replicas if requested.
+class FinishTabletSstTask : public Runnable {
+ public:
+  FinishTabletSstTask(TabletId tablet_id, BulkLoadSstWriter* writer, BulkLoad* bulk_load)
+      : tablet_id_(std::move(tablet_id)), writer_(writer), bulk_load_(bulk_load) {}
+  void Run();
+ private:
+  const TabletId tablet_id_;
+  BulkLoadSstWriter* const writer_;
+  BulkLoad* const bulk_load_;
+};
+
 class CompactionTask: public Runnable {
  public:
   CompactionTask(const vector<string>& sst_filenames, BulkLoadDocDBUtil* db_fixture);
@@ -121,19 +167,40 @@ class BulkLoad {
  public:
   CHECKED_STATUS RunBulkLoad();
 
+  const YBTable& table() const { return *table_; }
+  YBPartitionGenerator* partition_generator() { return partition_generator_.get(); }
+
+  // Returns SST writer for the tablet, creating it if necessary.
+  Result<BulkLoadSstWriter*> GetSstWriter(const TabletId& tablet_id);
+
+  // Streams SST files to all replicas of the tablet and ingests them.
+  CHECKED_STATUS IngestSstFiles(const TabletId& tablet_id,
+                                const vector<rocksdb::ExternalSstFileInfo>& files);
+
  private:
   CHECKED_STATUS InitYBBulkLoad();
   CHECKED_STATUS InitDBUtil(const TabletId &tablet_id);
   CHECKED_STATUS FinishTabletProcessing(const TabletId &tablet_id,
                                         vector<pair<TabletId, string>> rows);
   CHECKED_STATUS RetryableSubmit(vector<pair<TabletId, string>> rows);
+  CHECKED_STATUS RetryableSubmit(const std::shared_ptr<Runnable>& runnable);
   CHECKED_STATUS CompactFiles();
 
+  CHECKED_STATUS RunDirectBulkLoad();
+  CHECKED_STATUS SendSstFile(tserver::TabletServerServiceProxy* proxy, const TabletId& tablet_id,
+                             const string& path);
+
   shared_ptr<YBClient> client_;
   shared_ptr<YBTable> table_;
   unique_ptr<YBPartitionGenerator> partition_generator_;
   gscoped_ptr<ThreadPool> thread_pool_;
   unique_ptr<BulkLoadDocDBUtil> db_fixture_;
+
+  // Used only in --bulk_load_direct_sst mode.
+  rocksdb::Options sst_options_;
+  shared_ptr<rpc::Messenger> messenger_;
+  std::mutex sst_writers_mutex_;
+  std::map<TabletId, unique_ptr<BulkLoadSstWriter>> sst_writers_;
 };
 
 CompactionTask::CompactionTask(const vector<string>& sst_filenames, BulkLoadDocDBUtil* db_fixture)
@@ -169,8 +236,9 @@ void BulkLoadTask::Run() {
     const string &row = entry.second;
 
     // Populate the row.
-    CHECK_OK(InsertRow(row, table_->InternalSchema(), db_fixture_, &doc_write_batch,
-                       partition_generator_));
+    TabletId tablet_id;
+    CHECK_OK(InsertRow(row, table_->InternalSchema(), &doc_write_batch, partition_generator_,
+                       &tablet_id));
   }
 
   // Flush the batch.
@@ -183,9 +251,9 @@ void BulkLoadTask::Run() {
   }
 }
 
-Status BulkLoadTask::PopulateColumnValue(const string &column,
-                                         const DataType data_type,
-                                         QLExpressionPB *column_value) {
+Status PopulateColumnValue(const string &column,
+                           const DataType data_type,
+                           QLExpressionPB *column_value) {
   auto ql_valuepb = column_value->mutable_value();
   switch (data_type) {
     YB_SET_INT_VALUE(ql_valuepb, column, 8);
@@ -224,11 +292,11 @@ Status BulkLoadTask::PopulateColumnValue(const string &column,
   return Status::OK();
 }
 
-Status BulkLoadTask::InsertRow(const string &row,
-                               const Schema &schema,
-                               BulkLoadDocDBUtil *const db_fixture,
-                               docdb::DocWriteBatch *const doc_write_batch,
-                               YBPartitionGenerator *const partition_generator) {
+Status InsertRow(const string &row,
+                 const Schema &schema,
+                 docdb::DocWriteBatch *const doc_write_batch,
+                 YBPartitionGenerator *const partition_generator,
+                 TabletId *tablet_id) {
   // Get individual columns.
   CsvTokenizer tokenizer = Tokenize(row);
   size_t ncolumns = std::distance(tokenizer.begin(), tokenizer.end());
@@ -273,9 +341,8 @@ Status BulkLoadTask::InsertRow(const string &row,
   }
 
   // Add the hash code to the operation.
-  string tablet_id;
   string partition_key;
-  RETURN_NOT_OK(partition_generator->LookupTabletIdWithTokenizer(tokenizer, &tablet_id,
+  RETURN_NOT_OK(partition_generator->LookupTabletIdWithTokenizer(tokenizer, tablet_id,
                                                                      &partition_key));
   req.set_hash_code(PartitionSchema::DecodeMultiColumnHashValue(partition_key));
 
@@ -293,10 +360,53 @@ Status BulkLoadTask::InsertRow(const string &row,
 }
 
 
+void DirectBulkLoadTask::Run() {
+  const Schema& schema = bulk_load_->table().InternalSchema();
+  const HybridTime hybrid_time = HybridTime::FromMicros(kYugaByteMicrosecondEpoch);
+  docdb::DocHybridTimeBuffer doc_ht_buffer;
+  std::map<TabletId, BulkLoadSstWriter::KeyValues> tablet_key_values;
+
+  for (const string& row : rows_) {
+    // Rows are converted without reading existing data: init markers are optional and only
+    // primitive column values are supported, so DocWriteBatch never needs RocksDB.
+    DocWriteBatch doc_write_batch(nullptr /* rocksdb */, InitMarkerBehavior::kOptional);
+    TabletId tablet_id;
+    CHECK_OK(InsertRow(row, schema, &doc_write_batch, bulk_load_->partition_generator(),
+                       &tablet_id));
+
+    // The same as writing the batch with BulkLoadDocDBUtil::WriteToRocksDB, without incrementing
+    // write id.
+    auto& key_values = tablet_key_values[tablet_id];
+    const Slice encoded_ht = doc_ht_buffer.EncodeWithValueType(hybrid_time, 0 /* write_id */);
+    for (const auto& entry : doc_write_batch.key_value_pairs()) {
+      key_values.emplace_back(entry.first + encoded_ht.ToBuffer(), entry.second);
+    }
+  }
+
+  for (auto& tablet_and_key_values : tablet_key_values) {
+    auto* writer = CHECK_RESULT(bulk_load_->GetSstWriter(tablet_and_key_values.first));
+    CHECK_OK(writer->Add(&tablet_and_key_values.second));
+  }
+}
+
+void FinishTabletSstTask::Run() {
+  auto files = CHECK_RESULT(writer_->Finish());
+  LOG(INFO) << "Wrote " << files.size() << " SST files for tablet " << tablet_id_ << " to "
+            << writer_->dir();
+  if (!FLAGS_export_files) {
+    return;
+  }
+  CHECK_OK(bulk_load_->IngestSstFiles(tablet_id_, files));
+  // Ingested files are moved by the tablet servers, so only the directory is left.
+  CHECK_OK(yb::Env::Default()->DeleteRecursively(writer_->dir()));
+}
+
 Status BulkLoad::RetryableSubmit(vector<pair<TabletId, string>> rows) {
-  auto runnable = std::make_shared<BulkLoadTask>(
-      std::move(rows), db_fixture_.get(), table_.get(), partition_generator_.get());
+  return RetryableSubmit(std::make_shared<BulkLoadTask>(
+      std::move(rows), db_fixture_.get(), table_.get(), partition_generator_.get()));
+}
 
+Status BulkLoad::RetryableSubmit(const std::shared_ptr<Runnable>& runnable) {
   Status s;
   do {
     s = thread_pool_->Submit(runnable);
@@ -468,6 +578,13 @@ Status BulkLoad::InitYBBulkLoad() {
   RETURN_NOT_OK(partition_generator_->Init());
 
   db_fixture_ = nullptr;
+  if (FLAGS_bulk_load_direct_sst) {
+    docdb::InitRocksDBOptions(&sst_options_, "bulk_load", nullptr /* statistics */,
+                              tablet::TabletOptions());
+    if (FLAGS_export_files) {
+      messenger_ = VERIFY_RESULT(rpc::MessengerBuilder("Client").Build());
+    }
+  }
   CHECK_OK(
       ThreadPoolBuilder("bulk_load_tasks")
           .set_min_threads(FLAGS_bulk_load_num_threads)
@@ -479,10 +596,118 @@ Status BulkLoad::InitYBBulkLoad() {
 }
 
 
+Result<BulkLoadSstWriter*> BulkLoad::GetSstWriter(const TabletId& tablet_id) {
+  std::lock_guard<std::mutex> lock(sst_writers_mutex_);
+  auto& writer = sst_writers_[tablet_id];
+  if (!writer) {
+    const string dir = JoinPathSegments(FLAGS_base_dir, tablet_id);
+    RETURN_NOT_OK(Env::Default()->DeleteRecursively(dir));
+    RETURN_NOT_OK(Env::Default()->CreateDir(dir));
+    writer = std::make_unique<BulkLoadSstWriter>(
+        dir, sst_options_, FLAGS_bulk_load_sort_buffer_bytes, FLAGS_bulk_load_max_sst_file_size);
+  }
+  return writer.get();
+}
+
+Status BulkLoad::SendSstFile(tserver::TabletServerServiceProxy* proxy, const TabletId& tablet_id,
+                             const string& path) {
+  gscoped_ptr<SequentialFile> file;
+  RETURN_NOT_OK(Env::Default()->NewSequentialFile(path, &file));
+  std::vector<uint8_t> scratch(FLAGS_bulk_load_ingest_chunk_size);
+  uint64_t offset = 0;
+  for (;;) {
+    Slice chunk;
+    RETURN_NOT_OK(file->Read(scratch.size(), &chunk, scratch.data()));
+    // Empty files are still sent once, so they are created on the tablet server.
+    if (chunk.empty() && offset != 0) {
+      return Status::OK();
+    }
+
+    tserver::IngestSstFileRequestPB req;
+    req.set_tablet_id(tablet_id);
+    req.set_file_name(BaseName(path));
+    req.set_offset(offset);
+    req.set_data(chunk.cdata(), chunk.size());
+    tserver::IngestSstFileResponsePB resp;
+    rpc::RpcController controller;
+    RETURN_NOT_OK(proxy->IngestSstFile(req, &resp, &controller));
+    if (resp.has_error()) {
+      return StatusFromPB(resp.error().status());
+    }
+    offset += chunk.size();
+    if (chunk.empty()) {
+      return Status::OK();
+    }
+  }
+}
+
+Status BulkLoad::IngestSstFiles(const TabletId& tablet_id,
+                                const vector<rocksdb::ExternalSstFileInfo>& files) {
+  master::TabletLocationsPB tablet_locations;
+  RETURN_NOT_OK(client_->GetTabletLocation(tablet_id, &tablet_locations));
+  for (const master::TabletLocationsPB_ReplicaPB &replica : tablet_locations.replicas()) {
+    const auto& host_port = replica.ts_info().rpc_addresses(0);
+    Endpoint endpoint(IpAddress::from_string(host_port.host()), host_port.port());
+    tserver::TabletServerServiceProxy proxy(messenger_, endpoint);
+    for (const auto& file : files) {
+      LOG(INFO) << "Ingesting " << file.file_path << " on " << host_port.host()
+                << " for tablet_id: " << tablet_id;
+      if (file.is_split_sst) {
+        RETURN_NOT_OK(SendSstFile(&proxy, tablet_id, rocksdb::TableBaseToDataFileName(
+            file.file_path)));
+      }
+      RETURN_NOT_OK(SendSstFile(&proxy, tablet_id, file.file_path));
+
+      tserver::IngestSstFileRequestPB req;
+      req.set_tablet_id(tablet_id);
+      req.set_file_name(BaseName(file.file_path));
+      req.set_ingest(true);
+      tserver::IngestSstFileResponsePB resp;
+      rpc::RpcController controller;
+      RETURN_NOT_OK(proxy.IngestSstFile(req, &resp, &controller));
+      if (resp.has_error()) {
+        return StatusFromPB(resp.error().status());
+      }
+    }
+  }
+  return Status::OK();
+}
+
+Status BulkLoad::RunDirectBulkLoad() {
+  vector<string> rows;
+  for (string line; std::getline(std::cin, line);) {
+    boost::algorithm::trim(line);
+    if (line.empty()) {
+      continue;
+    }
+    rows.push_back(std::move(line));
+    if (rows.size() >= FLAGS_row_batch_size) {
+      RETURN_NOT_OK(RetryableSubmit(std::make_shared<DirectBulkLoadTask>(std::move(rows), this)));
+      rows.clear();
+    }
+  }
+  if (!rows.empty()) {
+    RETURN_NOT_OK(RetryableSubmit(std::make_shared<DirectBulkLoadTask>(std::move(rows), this)));
+  }
+  thread_pool_->Wait();
+
+  // All rows are converted, now tablets could be finished independently.
+  for (const auto& tablet_and_writer : sst_writers_) {
+    RETURN_NOT_OK(RetryableSubmit(std::make_shared<FinishTabletSstTask>(
+        tablet_and_writer.first, tablet_and_writer.second.get(), this)));
+  }
+  thread_pool_->Wait();
+  return Status::OK();
+}
+
 Status BulkLoad::RunBulkLoad() {
 
   RETURN_NOT_OK(InitYBBulkLoad());
 
+  if (FLAGS_bulk_load_direct_sst) {
+    return RunDirectBulkLoad();
+  }
+
   TabletId current_tablet_id;
 
   vector<pair<TabletId, string>> rows;
@@ -532,7 +757,7 @@ int main(int argc, char** argv) {
         "--base_dir";
   }
 
-  if (FLAGS_export_files && FLAGS_ssh_key_file.empty()) {
+  if (FLAGS_export_files && !FLAGS_bulk_load_direct_sst && FLAGS_ssh_key_file.empty()) {
     LOG(FATAL) << "Need to specify --ssh_key_file with --export_files";
   }
 
@@ -0,0 +1,270 @@
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+
+#include "yb/tserver/data_scrubber.h"
+
+#include <algorithm>
+
+#include <gflags/gflags.h>
+#include <glog/logging.h>
+
+#include "yb/consensus/consensus.h"
+#include "yb/consensus/log.h"
+
+#include "yb/rocksdb/db.h"
+#include "yb/rocksdb/rate_limiter.h"
+
+#include "yb/tablet/tablet.h"
+#include "yb/tablet/tablet_peer.h"
+
+#include "yb/tserver/tablet_server.h"
+#include "yb/tserver/ts_tablet_manager.h"
+
+#include "yb/util/flag_tags.h"
+#include "yb/util/format.h"
+#include "yb/util/random_util.h"
+#include "yb/util/thread.h"
+
+DEFINE_bool(enable_data_scrubber, true,
+            "Periodically verify checksums of SST files and closed WAL segments of all tablets "
+            "in the background.");
+TAG_FLAG(enable_data_scrubber, advanced);
+TAG_FLAG(enable_data_scrubber, runtime);
+
+DEFINE_int64(data_scrubber_rate_limit_bytes_per_sec, 8 * 1024 * 1024,
+             "Maximum number of bytes per second read by the data scrubber.");
+TAG_FLAG(data_scrubber_rate_limit_bytes_per_sec, advanced);
+TAG_FLAG(data_scrubber_rate_limit_bytes_per_sec, runtime);
+
+DEFINE_int32(data_scrubber_pass_interval_secs, 24 * 60 * 60,
+             "Interval between the starts of data scrubber passes over all tablets. The first pass "
+             "starts after a random delay within this interval, so tablet servers started "
+             "together do not scrub at the same time.");
+TAG_FLAG(data_scrubber_pass_interval_secs, advanced);
+
+DEFINE_bool(data_scrubber_fail_corrupted_replicas, true,
+            "Shut down a replica, whose data was found corrupted by the data scrubber, and mark "
+            "it failed, so it does not serve requests. The leader evicts the failed replica "
+            "when the rest of the Raft config is healthy, and the load balancer replaces it.");
+TAG_FLAG(data_scrubber_fail_corrupted_replicas, advanced);
+TAG_FLAG(data_scrubber_fail_corrupted_replicas, runtime);
+
+METRIC_DEFINE_counter(server, data_scrubber_bytes_verified,
+                      "Data Scrubber Bytes Verified", yb::MetricUnit::kBytes,
+                      "Number of bytes of SST files and WAL segments verified by the data "
+                      "scrubber");
+METRIC_DEFINE_counter(server, data_scrubber_sst_corruptions,
+                      "Data Scrubber SST Corruptions", yb::MetricUnit::kUnits,
+                      "Number of tablets, whose SST files failed checksum verification");
+METRIC_DEFINE_counter(server, data_scrubber_wal_corruptions,
+                      "Data Scrubber WAL Corruptions", yb::MetricUnit::kUnits,
+                      "Number of tablets, whose closed WAL segments failed checksum verification");
+METRIC_DEFINE_counter(server, data_scrubber_replicas_failed,
+                      "Data Scrubber Replicas Failed", yb::MetricUnit::kUnits,
+                      "Number of replicas marked failed because of corruption found by the data "
+                      "scrubber");
+
+namespace yb {
+namespace tserver {
+
+namespace {
+
+std::string LogPrefix(const tablet::TabletPeer& tablet_peer) {
+  return Format("T $0 P $1: ", tablet_peer.tablet_id(), tablet_peer.permanent_uuid());
+}
+
+} // namespace
+
+DataScrubber::DataScrubber(TabletServer* server)
+    : server_(server),
+      rate_limiter_(rocksdb::NewGenericRateLimiter(FLAGS_data_scrubber_rate_limit_bytes_per_sec)),
+      rate_limit_bytes_per_sec_(FLAGS_data_scrubber_rate_limit_bytes_per_sec),
+      bytes_verified_(METRIC_data_scrubber_bytes_verified.Instantiate(server->metric_entity())),
+      sst_corruptions_(METRIC_data_scrubber_sst_corruptions.Instantiate(server->metric_entity())),
+      wal_corruptions_(METRIC_data_scrubber_wal_corruptions.Instantiate(server->metric_entity())),
+      replicas_failed_(
+          METRIC_data_scrubber_replicas_failed.Instantiate(server->metric_entity())) {
+}
+
+DataScrubber::~DataScrubber() {
+  WARN_NOT_OK(Stop(), "Failed to stop data scrubber");
+}
+
+Status DataScrubber::Start() {
+  CHECK(thread_ == nullptr);
+
+  stop_.store(false, std::memory_order_release);
+  return yb::Thread::Create("data_scrubber", "data_scrubber",
+                            &DataScrubber::RunThread, this, &thread_);
+}
+
+Status DataScrubber::Stop() {
+  if (!thread_) {
+    return Status::OK();
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_.store(true, std::memory_order_release);
+  }
+  cond_.notify_all();
+  RETURN_NOT_OK(ThreadJoiner(thread_.get()).Join());
+  thread_ = nullptr;
+  return Status::OK();
+}
+
+bool DataScrubber::Wait(MonoDelta delay) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  cond_.wait_for(lock, delay.ToSteadyDuration(), [this] { return stopped(); });
+  return !stopped();
+}
+
+void DataScrubber::RunThread() {
+  const auto interval = MonoDelta::FromSeconds(FLAGS_data_scrubber_pass_interval_secs);
+  auto delay = MonoDelta::FromSeconds(
+      RandomUniformInt(0, std::max(FLAGS_data_scrubber_pass_interval_secs, 1) - 1));
+  while (Wait(delay)) {
+    auto next_pass = MonoTime::Now() + interval;
+    if (FLAGS_enable_data_scrubber) {
+      RunPass();
+    }
+    delay = next_pass.GetDeltaSince(MonoTime::Now());
+  }
+}
+
+void DataScrubber::RunPass() {
+  LOG(INFO) << "Data scrubber pass started";
+  auto start = MonoTime::Now();
+  auto start_bytes = bytes_verified_->value();
+  size_t num_tablets = 0;
+  for (const auto& tablet_peer : server_->tablet_manager()->GetTabletPeers()) {
+    if (stopped()) {
+      return;
+    }
+    if (tablet_peer->state() != tablet::RUNNING) {
+      continue;
+    }
+    ScrubTablet(tablet_peer);
+    ++num_tablets;
+  }
+  LOG(INFO) << Format("Data scrubber pass verified $0 bytes of $1 tablets in $2",
+                      bytes_verified_->value() - start_bytes, num_tablets,
+                      MonoTime::Now() - start);
+}
+
+void DataScrubber::ScrubTablet(const scoped_refptr<tablet::TabletPeer>& tablet_peer) {
+  const auto rate_limit = FLAGS_data_scrubber_rate_limit_bytes_per_sec;
+  if (rate_limit != rate_limit_bytes_per_sec_ && rate_limit > 0) {
+    rate_limiter_->SetBytesPerSecond(rate_limit);
+    rate_limit_bytes_per_sec_ = rate_limit;
+  }
+
+  auto tablet = tablet_peer->shared_tablet();
+  if (!tablet) {
+    return;
+  }
+
+  rocksdb::VerifyChecksumOptions options;
+  options.rate_limiter = rate_limiter_.get();
+  options.should_abort = [this] { return stopped(); };
+  uint64_t bytes_verified = 0;
+  auto status = tablet->VerifyDataChecksums(options, &bytes_verified);
+  bytes_verified_->IncrementBy(bytes_verified);
+  if (status.IsCorruption()) {
+    sst_corruptions_->Increment();
+    HandleCorruption(tablet_peer.get(), status);
+    return;
+  }
+  if (!status.ok()) {
+    // Aborted when the tablet or the scrubber is being shut down.
+    LOG_IF(WARNING, !status.IsAborted()) << LogPrefix(*tablet_peer)
+                                         << "Failed to verify SST files: " << status;
+    return;
+  }
+
+  status = VerifyWal(*tablet_peer);
+  if (status.IsCorruption()) {
+    wal_corruptions_->Increment();
+    HandleCorruption(tablet_peer.get(), status);
+  } else if (!status.ok() && !status.IsAborted()) {
+    LOG(WARNING) << LogPrefix(*tablet_peer) << "Failed to verify WAL: " << status;
+  }
+}
+
+Status DataScrubber::VerifyWal(const tablet::TabletPeer& tablet_peer) {
+  auto* log = tablet_peer.log();
+  if (!log) {
+    return Status::OK();
+  }
+
+  log::SegmentSequence segments;
+  RETURN_NOT_OK(log->GetSegmentsSnapshot(&segments));
+  for (const auto& segment : segments) {
+    // The active segment is still being written, so only closed segments are verified.
+    if (!segment->HasFooter()) {
+      continue;
+    }
+    int64_t charged_offset = segment->first_entry_offset();
+    int64_t end_offset = charged_offset;
+    // Batch checksums are verified while reading, batches themselves are not used.
+    auto status = segment->ReadEntryBatches(
+        [this, &charged_offset](int64_t batch_offset, log::LogEntryBatchPB* batch) -> Status {
+          if (stopped()) {
+            return STATUS(Aborted, "Data scrubber stopped");
+          }
+          ChargeBytes(batch_offset - charged_offset);
+          charged_offset = batch_offset;
+          return Status::OK();
+        },
+        &end_offset);
+    ChargeBytes(end_offset - charged_offset);
+    RETURN_NOT_OK(status);
+  }
+  return Status::OK();
+}
+
+void DataScrubber::ChargeBytes(int64_t bytes) {
+  if (bytes <= 0) {
+    return;
+  }
+  bytes_verified_->IncrementBy(bytes);
+  const int64_t burst = std::max<int64_t>(rate_limiter_->GetSingleBurstBytes(), 1);
+  while (bytes > 0) {
+    auto chunk = std::min(bytes, burst);
+    rate_limiter_->Request(chunk, rocksdb::Env::IO_LOW);
+    bytes -= chunk;
+  }
+}
+
+void DataScrubber::HandleCorruption(tablet::TabletPeer* tablet_peer, const Status& status) {
+  LOG(ERROR) << LogPrefix(*tablet_peer) << "Data scrubber found corruption: " << status;
+  if (!FLAGS_data_scrubber_fail_corrupted_replicas) {
+    return;
+  }
+
+  // Data of the replica is kept, since the scrubber does not know whether other replicas are
+  // healthy. The replica stops serving and voting, and responds with TABLET_FAILED to the leader,
+  // which evicts it from the Raft config when the rest of the config is healthy. Then the load
+  // balancer adds a new replica via remote bootstrap.
+  LOG(WARNING) << LogPrefix(*tablet_peer) << "Marking corrupted replica failed";
+  tablet_peer->Shutdown();
+  tablet_peer->SetFailed(status);
+  server_->tablet_manager()->MarkTabletDirty(
+      tablet_peer->tablet_id(),
+      std::make_shared<consensus::StateChangeContext>(
+          consensus::StateChangeReason::TABLET_PEER_FAILED));
+  replicas_failed_->Increment();
+}
+
+} // namespace tserver
+} // namespace yb
@@ -0,0 +1,97 @@
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+
+#ifndef YB_TSERVER_DATA_SCRUBBER_H
+#define YB_TSERVER_DATA_SCRUBBER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+
+#include "yb/gutil/ref_counted.h"
+
+#include "yb/util/metrics.h"
+#include "yb/util/monotime.h"
+#include "yb/util/status.h"
+
+namespace rocksdb {
+class RateLimiter;
+}
+
+namespace yb {
+
+class Thread;
+
+namespace tablet {
+class TabletPeer;
+}
+
+namespace tserver {
+
+class TabletServer;
+
+// Background thread, that periodically reads SST files and closed WAL segments of all running
+// tablets of the tablet server and verifies their checksums, so silent disk corruption is found
+// before the data is needed. Reads are done under a rate limit with low IO priority.
+//
+// A replica with corrupted data is shut down and marked failed, its data is kept.
+class DataScrubber {
+ public:
+  explicit DataScrubber(TabletServer* server);
+  ~DataScrubber();
+
+  CHECKED_STATUS Start();
+  CHECKED_STATUS Stop();
+
+ private:
+  void RunThread();
+
+  // Waits for delay, returns false if the scrubber was stopped meanwhile.
+  bool Wait(MonoDelta delay);
+
+  void RunPass();
+
+  void ScrubTablet(const scoped_refptr<tablet::TabletPeer>& tablet_peer);
+
+  CHECKED_STATUS VerifyWal(const tablet::TabletPeer& tablet_peer);
+
+  void HandleCorruption(tablet::TabletPeer* tablet_peer, const Status& status);
+
+  // Charges verified bytes to the rate limiter, blocking until they are allowed to be read.
+  void ChargeBytes(int64_t bytes);
+
+  bool stopped() const {
+    return stop_.load(std::memory_order_acquire);
+  }
+
+  TabletServer* const server_;
+
+  std::unique_ptr<rocksdb::RateLimiter> rate_limiter_;
+  int64_t rate_limit_bytes_per_sec_;
+
+  std::atomic<bool> stop_{false};
+  std::mutex mutex_;
+  std::condition_variable cond_;
+  scoped_refptr<Thread> thread_;
+
+  scoped_refptr<Counter> bytes_verified_;
+  scoped_refptr<Counter> sst_corruptions_;
+  scoped_refptr<Counter> wal_corruptions_;
+  scoped_refptr<Counter> replicas_failed_;
+};
+
+} // namespace tserver
+} // namespace yb
+
+#endif // YB_TSERVER_DATA_SCRUBBER_H
@@ -35,6 +35,7 @@
 #include <memory>
 #include <vector>
 #include <mutex>
+#include <unordered_map>
 
 #include <gflags/gflags.h>
 #include <glog/logging.h>
@@ -48,6 +49,9 @@
 #include "yb/server/server_base.proxy.h"
 #include "yb/server/webserver.h"
 #include "yb/tablet/tablet.h"
+#include "yb/tablet/tablet_metrics.h"
+#include "yb/tablet/tablet_peer.h"
+#include "yb/tserver/quota_manager.h"
 #include "yb/tserver/tablet_server.h"
 #include "yb/tserver/tablet_server_options.h"
 #include "yb/tserver/ts_tablet_manager.h"
@@ -71,6 +75,22 @@ DEFINE_int32(heartbeat_max_failures_before_backoff, 3,
              "rather than retrying.");
 TAG_FLAG(heartbeat_max_failures_before_backoff, advanced);
 
+DEFINE_int64(tablet_split_size_threshold_bytes, 0,
+             "Leader tablets with total SST files size above this threshold are reported to the "
+             "master as split candidates. 0 to disable size based splitting.");
+TAG_FLAG(tablet_split_size_threshold_bytes, advanced);
+
+DEFINE_int32(tablet_split_ops_per_sec_threshold, 0,
+             "Leader tablets that serve more read and write operations per second than this "
+             "threshold during tablet_split_load_intervals consecutive metrics intervals are "
+             "reported to the master as split candidates. 0 to disable load based splitting.");
+TAG_FLAG(tablet_split_ops_per_sec_threshold, advanced);
+
+DEFINE_int32(tablet_split_load_intervals, 12,
+             "Number of consecutive metrics intervals, during which the tablet load should be "
+             "above tablet_split_ops_per_sec_threshold, to report it as a split candidate.");
+TAG_FLAG(tablet_split_load_intervals, advanced);
+
 using google::protobuf::RepeatedPtrField;
 using yb::HostPortPB;
 using yb::consensus::RaftPeerPB;
@@ -135,6 +155,10 @@ class Heartbeater::Thread {//DHQ: 内部的class
   CHECKED_STATUS TryHeartbeat();
   CHECKED_STATUS SetupRegistration(master::TSRegistrationPB* reg);
   void SetupCommonField(master::TSToMasterCommonPB* common);
+  // Adds leader tablets that exceed split thresholds to the heartbeat request.
+  void AddSplitCandidates(const vector<scoped_refptr<tablet::TabletPeer>>& tablet_peers,
+                          double interval_sec,
+                          master::TSHeartbeatRequestPB* req);
   bool IsCurrentThread() const;
 
   shared_ptr<const vector<HostPort>> get_master_addresses() {
@@ -197,6 +221,14 @@ class Heartbeater::Thread {//DHQ: 内部的class
   uint64_t prev_reads_;
   uint64_t prev_writes_;
 
+  struct TabletLoad {
+    uint64_t ops = 0;
+    int intervals_above_threshold = 0;
+  };
+
+  // Load of tablets for load based splitting, keyed by tablet id.
+  std::unordered_map<std::string, TabletLoad> tablet_loads_;
+
   DISALLOW_COPY_AND_ASSIGN(Thread);
 };
 
@@ -384,7 +416,7 @@ Status Heartbeater::Thread::TryHeartbeat() {
       req.mutable_tablet_report());
   }
   req.set_num_live_tablets(server_->tablet_manager()->GetNumLiveTablets());
-
+  req.set_has_quotas(server_->quota_manager()->has_quotas());
 
   if (prev_tserver_metrics_submission_ +
       MonoDelta::FromSeconds(tserver_metrics_interval_sec_) < MonoTime::Now()) {
@@ -437,6 +469,7 @@ Status Heartbeater::Thread::TryHeartbeat() {
     prev_writes_ = num_writes;
     req.mutable_metrics()->set_read_ops_per_sec(rops_per_sec);
     req.mutable_metrics()->set_write_ops_per_sec(wops_per_sec);
+    AddSplitCandidates(tablet_peers, div, &req);
     prev_tserver_metrics_submission_ = MonoTime::Now();
 
     VLOG(4) << "Read Ops per second: " << rops_per_sec;
@@ -489,6 +522,10 @@ Status Heartbeater::Thread::TryHeartbeat() {
     RETURN_NOT_OK(server_->UpdateMasterAddresses(resp.master_config()));
   }
 
+  if (last_hb_response_.has_table_quotas()) {
+    server_->quota_manager()->Update(last_hb_response_.table_quotas());
+  }
+
   // TODO: Handle TSHeartbeatResponsePB (e.g. deleted tablets and schema changes)
   server_->tablet_manager()->MarkTabletReportAcknowledged(req.tablet_report());
 
@@ -496,6 +533,69 @@ Status Heartbeater::Thread::TryHeartbeat() {
   return server_->PopulateLiveTServers(resp);
 }
 
+void Heartbeater::Thread::AddSplitCandidates(
+    const vector<scoped_refptr<tablet::TabletPeer>>& tablet_peers,
+    double interval_sec,
+    master::TSHeartbeatRequestPB* req) {
+  const auto size_threshold = FLAGS_tablet_split_size_threshold_bytes;
+  const auto ops_threshold = FLAGS_tablet_split_ops_per_sec_threshold;
+  if (size_threshold <= 0 && ops_threshold <= 0) {
+    tablet_loads_.clear();
+    return;
+  }
+
+  std::unordered_map<std::string, TabletLoad> new_loads;
+  for (const auto& tablet_peer : tablet_peers) {
+    if (!tablet_peer ||
+        tablet_peer->LeaderStatus() != consensus::Consensus::LeaderStatus::LEADER_AND_READY) {
+      continue;
+    }
+    auto tablet = tablet_peer->shared_tablet();
+    if (!tablet || tablet->IsSplitStarted() || !tablet->CheckSplitSupported().ok()) {
+      continue;
+    }
+
+    const auto sst_file_size = tablet->GetTotalSSTFileSizes();
+    bool is_candidate = size_threshold > 0 && sst_file_size > static_cast<uint64_t>(size_threshold);
+
+    double ops_per_sec = 0;
+    if (ops_threshold > 0) {
+      auto* metrics = tablet->metrics();
+      const uint64_t ops = metrics->ql_read_latency->TotalCount() +
+                           metrics->redis_read_latency->TotalCount() +
+                           metrics->write_lock_latency->TotalCount();
+      auto& load = new_loads[tablet_peer->tablet_id()];
+      load.ops = ops;
+      auto it = tablet_loads_.find(tablet_peer->tablet_id());
+      if (it != tablet_loads_.end() && interval_sec > 0 && ops >= it->second.ops) {
+        ops_per_sec = (ops - it->second.ops) / interval_sec;
+        if (ops_per_sec > ops_threshold) {
+          load.intervals_above_threshold = it->second.intervals_above_threshold + 1;
+        }
+      }
+      is_candidate = is_candidate ||
+                     load.intervals_above_threshold >= FLAGS_tablet_split_load_intervals;
+    }
+
+    if (!is_candidate) {
+      continue;
+    }
+    auto split_key = tablet->GetEncodedMiddleSplitKey();
+    if (!split_key.ok()) {
+      YB_LOG_EVERY_N(WARNING, 100) << "Unable to pick split key for tablet "
+                                   << tablet_peer->tablet_id() << ": " << split_key.status();
+      continue;
+    }
+    auto* candidate = req->add_split_candidates();
+    candidate->set_tablet_id(tablet_peer->tablet_id());
+    candidate->set_split_partition_key(*split_key);
+    candidate->set_sst_file_size(sst_file_size);
+    candidate->set_ops_per_sec(ops_per_sec);
+    VLOG(1) << "Reporting split candidate: " << candidate->ShortDebugString();
+  }
+  tablet_loads_.swap(new_loads);
+}
+
 Status Heartbeater::Thread::DoHeartbeat() {
   if (PREDICT_FALSE(server_->fail_heartbeats_for_tests())) {
     return STATUS(IOError, "failing all heartbeats for tests");
@@ -0,0 +1,104 @@
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+
+#include <gtest/gtest.h>
+
+#include "yb/master/master.pb.h"
+
+#include "yb/tserver/quota_manager.h"
+
+#include "yb/util/test_util.h"
+
+DECLARE_double(quota_burst_secs);
+
+namespace yb {
+namespace tserver {
+
+class QuotaManagerTest : public YBTest {
+};
+
+TEST_F(QuotaManagerTest, TokenBucket) {
+  auto now = MonoTime::Now();
+  TokenBucket bucket(10, 5, now);
+  ASSERT_EQ(MonoDelta::kZero, bucket.Refill(now));
+
+  // The request larger than the burst is admitted, but following ones wait for the debt.
+  bucket.Consume(15);
+  auto wait = bucket.Refill(now);
+  ASSERT_EQ(1000, wait.ToMilliseconds());
+
+  now += MonoDelta::FromMilliseconds(1100);
+  ASSERT_EQ(MonoDelta::kZero, bucket.Refill(now));
+  ASSERT_NEAR(1, bucket.tokens(), 1e-6);
+
+  // The bucket is not refilled above the burst.
+  now += MonoDelta::FromSeconds(10);
+  ASSERT_EQ(MonoDelta::kZero, bucket.Refill(now));
+  ASSERT_NEAR(5, bucket.tokens(), 1e-6);
+}
+
+TEST_F(QuotaManagerTest, Admit) {
+  FLAGS_quota_burst_secs = 1;
+  const std::string kTable = "table";
+  const std::string kOtherTable = "other_table";
+  const std::string kNamespace = "namespace";
+
+  QuotaManager manager;
+  MonoDelta retry_after;
+  auto now = MonoTime::Now();
+  ASSERT_OK(manager.Admit(kTable, 1000, &retry_after, now));
+
+  master::TableQuotasPB quotas;
+  auto* table_quota = quotas.add_quotas();
+  table_quota->set_table_id(kTable);
+  table_quota->set_ops_per_sec(2);
+  auto* namespace_quota = quotas.add_quotas();
+  namespace_quota->set_namespace_id(kNamespace);
+  namespace_quota->set_bytes_per_sec(100);
+  for (const auto& table_id : {kTable, kOtherTable}) {
+    auto* table_namespace = quotas.add_table_namespaces();
+    table_namespace->set_table_id(table_id);
+    table_namespace->set_namespace_id(kNamespace);
+  }
+  manager.Update(quotas);
+  ASSERT_TRUE(manager.has_quotas());
+
+  // Table is limited by the number of operations.
+  ASSERT_OK(manager.Admit(kTable, 10, &retry_after, now));
+  ASSERT_OK(manager.Admit(kTable, 10, &retry_after, now));
+  auto status = manager.Admit(kTable, 10, &retry_after, now);
+  ASSERT_TRUE(status.IsServiceUnavailable()) << status;
+  ASSERT_GT(retry_after, MonoDelta::kZero);
+
+  // Other table of the namespace is limited by bytes, that are shared with the first table.
+  ASSERT_OK(manager.Admit(kOtherTable, 80, &retry_after, now));
+  status = manager.Admit(kOtherTable, 10, &retry_after, now);
+  ASSERT_TRUE(status.IsServiceUnavailable()) << status;
+  ASSERT_EQ(1, retry_after.ToMilliseconds());
+
+  now += MonoDelta::FromSeconds(1);
+  ASSERT_OK(manager.Admit(kOtherTable, 10, &retry_after, now));
+  manager.Consume(kOtherTable, 200);
+  ASSERT_NOK(manager.Admit(kTable, 10, &retry_after, now));
+
+  // Update with the same limits keeps the debt.
+  manager.Update(quotas);
+  ASSERT_NOK(manager.Admit(kTable, 10, &retry_after, now));
+
+  manager.Update(master::TableQuotasPB());
+  ASSERT_FALSE(manager.has_quotas());
+  ASSERT_OK(manager.Admit(kTable, 10, &retry_after, now));
+}
+
+} // namespace tserver
+} // namespace yb
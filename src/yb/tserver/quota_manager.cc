@@ -0,0 +1,168 @@
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+
+#include "yb/tserver/quota_manager.h"
+
+#include <algorithm>
+
+#include <gflags/gflags.h>
+#include <glog/logging.h>
+
+#include "yb/master/master.pb.h"
+
+#include "yb/util/flag_tags.h"
+#include "yb/util/format.h"
+
+DEFINE_double(quota_burst_secs, 1.0,
+              "Number of seconds of the quota rate, that a table or namespace could use at once "
+              "after being idle.");
+TAG_FLAG(quota_burst_secs, advanced);
+
+namespace yb {
+namespace tserver {
+
+TokenBucket::TokenBucket(double rate, double burst, MonoTime now)
+    : rate_(rate), burst_(burst), tokens_(burst), last_refill_(now) {
+}
+
+void TokenBucket::SetLimits(double rate, double burst) {
+  // Bucket without limit was not consumed, so it starts full.
+  tokens_ = rate_ > 0 ? std::min(tokens_, burst) : burst;
+  rate_ = rate;
+  burst_ = burst;
+}
+
+MonoDelta TokenBucket::Refill(MonoTime now) {
+  if (now > last_refill_) {
+    tokens_ = std::min(burst_, tokens_ + rate_ * now.GetDeltaSince(last_refill_).ToSeconds());
+    last_refill_ = now;
+  }
+  if (tokens_ > 0) {
+    return MonoDelta::kZero;
+  }
+  return MonoDelta::FromSeconds(std::max(-tokens_ / rate_, 0.001));
+}
+
+struct QuotaManager::Quota {
+  std::string id;
+  // Buckets with zero rate are not enforced.
+  TokenBucket ops;
+  TokenBucket bytes;
+
+  Quota(const master::QuotaPB& pb, MonoTime now)
+      : id(pb.has_table_id() ? pb.table_id() : pb.namespace_id()),
+        ops(pb.ops_per_sec(), pb.ops_per_sec() * FLAGS_quota_burst_secs, now),
+        bytes(pb.bytes_per_sec(), pb.bytes_per_sec() * FLAGS_quota_burst_secs, now) {
+  }
+};
+
+QuotaManager::QuotaManager() {
+}
+
+QuotaManager::~QuotaManager() {
+}
+
+void QuotaManager::Update(const master::TableQuotasPB& quotas) {
+  const auto now = MonoTime::Now();
+  std::lock_guard<std::mutex> lock(mutex_);
+  decltype(quotas_) new_quotas;
+  for (const auto& pb : quotas.quotas()) {
+    const auto& id = pb.has_table_id() ? pb.table_id() : pb.namespace_id();
+    auto it = quotas_.find(id);
+    if (it == quotas_.end()) {
+      VLOG(1) << "Added quota: " << pb.ShortDebugString();
+      new_quotas.emplace(id, std::make_unique<Quota>(pb, now));
+      continue;
+    }
+    auto& quota = *it->second;
+    if (quota.ops.rate() != pb.ops_per_sec() || quota.bytes.rate() != pb.bytes_per_sec()) {
+      VLOG(1) << "Changed quota: " << pb.ShortDebugString();
+      quota.ops.SetLimits(pb.ops_per_sec(), pb.ops_per_sec() * FLAGS_quota_burst_secs);
+      quota.bytes.SetLimits(pb.bytes_per_sec(), pb.bytes_per_sec() * FLAGS_quota_burst_secs);
+    }
+    new_quotas.emplace(id, std::move(it->second));
+  }
+  quotas_.swap(new_quotas);
+
+  table_namespaces_.clear();
+  for (const auto& pb : quotas.table_namespaces()) {
+    table_namespaces_.emplace(pb.table_id(), pb.namespace_id());
+  }
+  has_quotas_.store(!quotas_.empty(), std::memory_order_release);
+}
+
+QuotaManager::Quotas QuotaManager::QuotasOf(const std::string& table_id) {
+  Quotas result;
+  auto it = quotas_.find(table_id);
+  if (it != quotas_.end()) {
+    result.push_back(it->second.get());
+  }
+  auto namespace_it = table_namespaces_.find(table_id);
+  if (namespace_it != table_namespaces_.end()) {
+    it = quotas_.find(namespace_it->second);
+    if (it != quotas_.end()) {
+      result.push_back(it->second.get());
+    }
+  }
+  return result;
+}
+
+Status QuotaManager::Admit(const std::string& table_id, size_t bytes, MonoDelta* retry_after,
+                           MonoTime now) {
+  if (!has_quotas()) {
+    return Status::OK();
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto quotas = QuotasOf(table_id);
+  MonoDelta wait = MonoDelta::kZero;
+  const Quota* exceeded = nullptr;
+  for (auto* quota : quotas) {
+    for (auto* bucket : {&quota->ops, &quota->bytes}) {
+      if (bucket->rate() <= 0) {
+        continue;
+      }
+      auto bucket_wait = bucket->Refill(now);
+      if (bucket_wait > wait) {
+        wait = bucket_wait;
+        exceeded = quota;
+      }
+    }
+  }
+
+  if (exceeded) {
+    *retry_after = wait;
+    return STATUS_FORMAT(ServiceUnavailable, "Quota of $0 $1 exceeded, retry after $2",
+                         exceeded->id == table_id ? "table" : "namespace", exceeded->id, wait);
+  }
+
+  for (auto* quota : quotas) {
+    quota->ops.Consume(1);
+    quota->bytes.Consume(bytes);
+  }
+  return Status::OK();
+}
+
+void QuotaManager::Consume(const std::string& table_id, size_t bytes) {
+  if (!has_quotas()) {
+    return;
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (auto* quota : QuotasOf(table_id)) {
+    quota->bytes.Consume(bytes);
+  }
+}
+
+} // namespace tserver
+} // namespace yb
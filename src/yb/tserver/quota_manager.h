@@ -0,0 +1,112 @@
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+
+#ifndef YB_TSERVER_QUOTA_MANAGER_H
+#define YB_TSERVER_QUOTA_MANAGER_H
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "yb/util/monotime.h"
+#include "yb/util/status.h"
+
+namespace yb {
+
+namespace master {
+class TableQuotasPB;
+}
+
+namespace tserver {
+
+// Token bucket, that is refilled with rate tokens per second up to its burst. The bucket could go
+// into debt, so a request larger than the burst is admitted when the bucket is full, and requests
+// after it wait until the debt is repaid.
+class TokenBucket {
+ public:
+  TokenBucket(double rate, double burst, MonoTime now);
+
+  // Changes limits keeping the current tokens, so the bucket is not refilled by every update.
+  void SetLimits(double rate, double burst);
+
+  // Refills the bucket and returns the time after which it has tokens again, zero if it has them
+  // now.
+  MonoDelta Refill(MonoTime now);
+
+  // Bucket with zero rate has no limit, so it is not consumed.
+  void Consume(double tokens) {
+    if (rate_ > 0) {
+      tokens_ -= tokens;
+    }
+  }
+
+  double rate() const { return rate_; }
+  double tokens() const { return tokens_; }
+
+ private:
+  double rate_;
+  double burst_;
+  double tokens_;
+  MonoTime last_refill_;
+};
+
+// Enforces rate limits of requests to tables and namespaces received from the master.
+//
+// Every table and namespace with a quota has buckets for operations and bytes. A request is
+// admitted only when all buckets of its table and its namespace have tokens, in this case it
+// consumes tokens from all of them.
+class QuotaManager {
+ public:
+  QuotaManager();
+  ~QuotaManager();
+
+  // Replaces quotas with the received ones. Buckets of quotas that are still present keep their
+  // tokens.
+  void Update(const master::TableQuotasPB& quotas);
+
+  bool has_quotas() const {
+    return has_quotas_.load(std::memory_order_acquire);
+  }
+
+  // Returns ServiceUnavailable and stores the time after which the request is expected to be
+  // admitted to retry_after, if the table or its namespace is over quota.
+  CHECKED_STATUS Admit(const std::string& table_id, size_t bytes, MonoDelta* retry_after,
+                       MonoTime now = MonoTime::Now());
+
+  // Consumes bytes, that were not known at admission time, e.g. read response bytes.
+  void Consume(const std::string& table_id, size_t bytes);
+
+ private:
+  struct Quota;
+  typedef std::vector<Quota*> Quotas;
+
+  // Returns quotas of the table and its namespace. Should be called under mutex_.
+  Quotas QuotasOf(const std::string& table_id);
+
+  std::atomic<bool> has_quotas_{false};
+
+  std::mutex mutex_;
+
+  // Quotas of tables and namespaces by their ids.
+  std::unordered_map<std::string, std::unique_ptr<Quota>> quotas_;
+
+  std::unordered_map<std::string, std::string> table_namespaces_;
+};
+
+} // namespace tserver
+} // namespace yb
+
+#endif // YB_TSERVER_QUOTA_MANAGER_H
@@ -94,14 +94,17 @@ StatusCallback BindHandleResponse(RespType* resp,
 // Lookup the given tablet, ensuring that it both exists and is RUNNING.
 // If it is not, respond to the RPC associated with 'context' after setting
 // resp->mutable_error() to indicate the failure reason.
+// 'failed_code' is the error code used when the tablet is FAILED.
 //
 // Returns true if successful.
 template<class RespClass>
-bool LookupTabletPeerOrRespond(TabletPeerLookupIf* tablet_manager,
-                               const string& tablet_id,
-                               RespClass* resp,
-                               rpc::RpcContext* context,
-                               scoped_refptr<tablet::TabletPeer>* peer) {
+bool LookupTabletPeerOrRespond(
+    TabletPeerLookupIf* tablet_manager,
+    const string& tablet_id,
+    RespClass* resp,
+    rpc::RpcContext* context,
+    scoped_refptr<tablet::TabletPeer>* peer,
+    TabletServerErrorPB::Code failed_code = TabletServerErrorPB::TABLET_NOT_RUNNING) {
   Status status = tablet_manager->GetTabletPeer(tablet_id, peer);
   if (PREDICT_FALSE(!status.ok())) {
     TabletServerErrorPB::Code code = status.IsServiceUnavailable() ?
@@ -116,11 +119,12 @@ bool LookupTabletPeerOrRespond(TabletPeerLookupIf* tablet_manager,
   if (PREDICT_FALSE(state != tablet::RUNNING)) {
     Status s = STATUS(IllegalState, "Tablet not RUNNING",
                       tablet::TabletStatePB_Name(state));
+    TabletServerErrorPB::Code code = TabletServerErrorPB::TABLET_NOT_RUNNING;
     if (state == tablet::FAILED) {
       s = s.CloneAndAppend((*peer)->error().ToString());
+      code = failed_code;
     }
-    SetupErrorAndRespond(resp->mutable_error(), s,
-                         TabletServerErrorPB::TABLET_NOT_RUNNING, context);
+    SetupErrorAndRespond(resp->mutable_error(), s, code, context);
     return false;
   }
   return true;
@@ -45,7 +45,9 @@
 #include "yb/server/rpc_server.h"
 #include "yb/server/webserver.h"
 #include "yb/tablet/maintenance_manager.h"
+#include "yb/tserver/data_scrubber.h"
 #include "yb/tserver/heartbeater.h"
+#include "yb/tserver/quota_manager.h"
 #include "yb/tserver/tablet_service.h"
 #include "yb/tserver/ts_tablet_manager.h"
 #include "yb/tserver/tserver-path-handlers.h"
@@ -108,6 +110,7 @@ TabletServer::TabletServer(const TabletServerOptions& opts)
       fail_heartbeats_for_tests_(false),
       opts_(opts),
       tablet_manager_(new TSTabletManager(fs_manager_.get(), this, metric_registry())),
+      quota_manager_(new QuotaManager()),
       path_handlers_(new TabletServerPathHandlers(this)),
       maintenance_manager_(new MaintenanceManager(MaintenanceManager::DEFAULT_OPTIONS)),
       master_config_index_(0),
@@ -168,6 +171,7 @@ Status TabletServer::Init() {
   RETURN_NOT_OK(path_handlers_->Register(web_server_.get()));
 
   heartbeater_.reset(new Heartbeater(opts_, this));
+  data_scrubber_.reset(new DataScrubber(this));
 
   RETURN_NOT_OK_PREPEND(tablet_manager_->Init(),
                         "Could not init Tablet Manager");
@@ -212,8 +216,8 @@ Status TabletServer::RegisterServices() {
   RETURN_NOT_OK(RpcAndWebServerBase::RegisterService(FLAGS_ts_admin_svc_queue_length,
                                                      std::move(admin_service)));
 
-  std::unique_ptr<ServiceIf> consensus_service(new ConsensusServiceImpl(metric_entity(),
-                                                                        tablet_manager_.get()));
+  std::unique_ptr<ServiceIf> consensus_service(new ConsensusServiceImpl(
+      metric_entity(), tablet_manager_.get(), tablet_manager_->raft_pool()));
   RETURN_NOT_OK(RpcAndWebServerBase::RegisterService(FLAGS_ts_consensus_svc_queue_length,
                                                      std::move(consensus_service),
                                                      ServicePriority::kHigh));
@@ -240,6 +244,7 @@ Status TabletServer::Start() {
   }
 
   RETURN_NOT_OK(heartbeater_->Start());
+  RETURN_NOT_OK(data_scrubber_->Start());
   RETURN_NOT_OK(maintenance_manager_->Init());
 
   google::FlushLogFiles(google::INFO); // Flush the startup messages.
@@ -253,6 +258,7 @@ void TabletServer::Shutdown() {
   if (initted_) {
     maintenance_manager_->Shutdown();
     WARN_NOT_OK(heartbeater_->Stop(), "Failed to stop TS Heartbeat thread");
+    WARN_NOT_OK(data_scrubber_->Stop(), "Failed to stop data scrubber thread");
     {
       std::lock_guard<simple_spinlock> l(lock_);
       tablet_server_service_ = nullptr;
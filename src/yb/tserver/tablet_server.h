@@ -60,6 +60,7 @@ namespace tserver {
 
 constexpr const char* const kTcMallocMaxThreadCacheBytes = "tcmalloc.max_total_thread_cache_bytes";
 
+class DataScrubber;
 class Heartbeater;
 class TabletServerPathHandlers;
 class TSTabletManager;
@@ -94,6 +95,8 @@ class TabletServer : public server::RpcAndWebServerBase, public TabletServerIf {
 
   TSTabletManager* tablet_manager() override { return tablet_manager_.get(); }
 
+  QuotaManager* quota_manager() override { return quota_manager_.get(); }
+
   Heartbeater* heartbeater() { return heartbeater_.get(); }
 
   void set_fail_heartbeats_for_tests(bool fail_heartbeats_for_tests) {
@@ -167,9 +170,15 @@ class TabletServer : public server::RpcAndWebServerBase, public TabletServerIf {
   // Manager for tablets which are available on this server.
   gscoped_ptr<TSTabletManager> tablet_manager_;
 
+  // Quotas of tables and namespaces received from the master.
+  std::unique_ptr<QuotaManager> quota_manager_;
+
   // Thread responsible for heartbeating to the master.
   gscoped_ptr<Heartbeater> heartbeater_;
 
+  // Thread verifying checksums of tablet data in the background.
+  std::unique_ptr<DataScrubber> data_scrubber_;
+
   // Webserver path handlers
   gscoped_ptr<TabletServerPathHandlers> path_handlers_;
 
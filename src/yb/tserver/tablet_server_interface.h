@@ -21,6 +21,8 @@
 namespace yb {
 namespace tserver {
 
+class QuotaManager;
+
 class TabletServerIf {
  public:
 
@@ -28,6 +30,9 @@ class TabletServerIf {
 
   virtual TSTabletManager* tablet_manager() = 0;
 
+  // Returns quotas of tables, or nullptr if the server does not enforce them.
+  virtual QuotaManager* quota_manager() = 0;
+
   virtual server::Clock* Clock() = 0;
   virtual const scoped_refptr<MetricEntity>& MetricEnt() const = 0;
 };
@@ -33,6 +33,7 @@
 #include "yb/tserver/tablet_service.h"
 
 #include <algorithm>
+#include <atomic>
 #include <memory>
 #include <string>
 #include <vector>
@@ -62,10 +63,12 @@
 #include "yb/tablet/tablet_metrics.h"
 
 #include "yb/tablet/operations/alter_schema_operation.h"
+#include "yb/tablet/operations/split_operation.h"
 #include "yb/tablet/operations/truncate_operation.h"
 #include "yb/tablet/operations/update_txn_operation.h"
 #include "yb/tablet/operations/write_operation.h"
 
+#include "yb/tserver/quota_manager.h"
 #include "yb/tserver/tablet_server.h"
 #include "yb/tserver/ts_tablet_manager.h"
 #include "yb/tserver/tserver.pb.h"
@@ -119,6 +122,17 @@ DEFINE_int32(max_wait_for_safe_time_ms, 5000,
              "Maximum time in milliseconds to wait for the safe time to advance when trying to "
              "scan at the given hybrid_time.");
 
+DEFINE_int32(max_stale_read_bound_time_ms, 0,
+             "Max time in milliseconds that data read from a follower or an observer replica "
+             "could lag behind the leader. 0 - no limit.");
+TAG_FLAG(max_stale_read_bound_time_ms, runtime);
+
+DEFINE_int32(multi_raft_heartbeat_process_chunk_size, 100,
+             "Heartbeats of a MultiRaftHeartbeat RPC are processed in parallel, in chunks of this "
+             "size, on the Raft thread pool.");
+TAG_FLAG(multi_raft_heartbeat_process_chunk_size, advanced);
+TAG_FLAG(multi_raft_heartbeat_process_chunk_size, runtime);
+
 DEFINE_bool(tserver_noop_read_write, false, "Respond NOOP to read/write.");
 TAG_FLAG(tserver_noop_read_write, unsafe);
 TAG_FLAG(tserver_noop_read_write, hidden);
@@ -142,6 +156,8 @@ using consensus::GetNodeInstanceResponsePB;
 using consensus::LeaderStepDownRequestPB;
 using consensus::LeaderStepDownResponsePB;
 using consensus::LeaderLeaseStatus;
+using consensus::MultiRaftHeartbeatRequestPB;
+using consensus::MultiRaftHeartbeatResponsePB;
 using consensus::RunLeaderElectionRequestPB;
 using consensus::RunLeaderElectionResponsePB;
 using consensus::StartRemoteBootstrapRequestPB;
@@ -161,6 +177,7 @@ using tablet::AlterSchemaOperationState;
 using tablet::Tablet;
 using tablet::TabletPeer;
 using tablet::TabletStatusPB;
+using tablet::SplitOperationState;
 using tablet::TruncateOperationState;
 using tablet::OperationCompletionCallback;
 using tablet::WriteOperationState;
@@ -182,6 +199,82 @@ bool GetConsensusOrRespond(const scoped_refptr<TabletPeer>& tablet_peer,
   return true;
 }
 
+// Processes a single heartbeat from MultiRaftHeartbeatRequestPB, filling resp the same way as
+// UpdateConsensus would do for the equivalent status-only request.
+void ProcessHeartbeat(TabletPeerLookupIf* tablet_manager,
+                      const MultiRaftHeartbeatRequestPB& req,
+                      const MultiRaftHeartbeatRequestPB::Heartbeat& heartbeat,
+                      ConsensusResponsePB* resp) {
+  auto set_error = [resp](const Status& s, TabletServerErrorPB::Code code) {
+    resp->Clear();
+    StatusToPB(s, resp->mutable_error()->mutable_status());
+    resp->mutable_error()->set_code(code);
+  };
+
+  scoped_refptr<TabletPeer> tablet_peer;
+  Status s = tablet_manager->GetTabletPeer(heartbeat.tablet_id(), &tablet_peer);
+  if (PREDICT_FALSE(!s.ok())) {
+    set_error(s, s.IsServiceUnavailable() ? TabletServerErrorPB::UNKNOWN_ERROR
+                                          : TabletServerErrorPB::TABLET_NOT_FOUND);
+    return;
+  }
+  tablet::TabletStatePB state = tablet_peer->state();
+  if (PREDICT_FALSE(state == tablet::FAILED)) {
+    set_error(tablet_peer->error(), TabletServerErrorPB::TABLET_FAILED);
+    return;
+  }
+  if (PREDICT_FALSE(state != tablet::RUNNING)) {
+    set_error(STATUS(IllegalState, "Tablet not RUNNING", tablet::TabletStatePB_Name(state)),
+              TabletServerErrorPB::TABLET_NOT_RUNNING);
+    return;
+  }
+  scoped_refptr<Consensus> consensus = tablet_peer->shared_consensus();
+  if (PREDICT_FALSE(!consensus)) {
+    set_error(STATUS(ServiceUnavailable, "Consensus unavailable. Tablet not running"),
+              TabletServerErrorPB::TABLET_NOT_RUNNING);
+    return;
+  }
+
+  ConsensusRequestPB update;
+  update.set_dest_uuid(req.dest_uuid());
+  update.set_tablet_id(heartbeat.tablet_id());
+  update.set_caller_uuid(req.caller_uuid());
+  update.set_caller_term(heartbeat.caller_term());
+  if (heartbeat.has_preceding_id()) {
+    *update.mutable_preceding_id() = heartbeat.preceding_id();
+  }
+  *update.mutable_committed_index() = heartbeat.committed_index();
+  if (heartbeat.has_leader_lease_duration_ms()) {
+    update.set_leader_lease_duration_ms(heartbeat.leader_lease_duration_ms());
+  }
+  if (heartbeat.has_ht_lease_expiration()) {
+    update.set_ht_lease_expiration(heartbeat.ht_lease_expiration());
+  }
+  if (heartbeat.has_propagated_safe_time()) {
+    update.set_propagated_safe_time(heartbeat.propagated_safe_time());
+  }
+  if (req.has_propagated_hybrid_time()) {
+    update.set_propagated_hybrid_time(req.propagated_hybrid_time());
+  }
+
+  s = consensus->Update(&update, resp);
+  if (PREDICT_FALSE(!s.ok())) {
+    set_error(s, TabletServerErrorPB::UNKNOWN_ERROR);
+  }
+}
+
+// Processes heartbeats with indexes in [begin, end), resp should already have a response entry
+// for each of them.
+void ProcessHeartbeats(TabletPeerLookupIf* tablet_manager,
+                       const MultiRaftHeartbeatRequestPB& req,
+                       int begin,
+                       int end,
+                       MultiRaftHeartbeatResponsePB* resp) {
+  for (int i = begin; i != end; ++i) {
+    ProcessHeartbeat(tablet_manager, req, req.heartbeats(i), resp->mutable_responses(i));
+  }
+}
+
 Status GetTabletRef(const scoped_refptr<TabletPeer>& tablet_peer,
                     shared_ptr<Tablet>* tablet,
                     TabletServerErrorPB::Code* error_code) {
@@ -190,6 +283,11 @@ Status GetTabletRef(const scoped_refptr<TabletPeer>& tablet_peer,
     *error_code = TabletServerErrorPB::TABLET_NOT_RUNNING;
     return STATUS(IllegalState, "Tablet is not running");
   }
+  // Data of the split tablet is served by the new tablets.
+  if (PREDICT_FALSE((*tablet)->IsSplit())) {
+    *error_code = TabletServerErrorPB::TABLET_SPLIT;
+    return STATUS_FORMAT(IllegalState, "Tablet $0 was split", tablet_peer->tablet_id());
+  }
   return Status::OK();
 }
 
@@ -642,6 +740,71 @@ void TabletServiceAdminImpl::CopartitionTable(const CopartitionTableRequestPB* r
   LOG(INFO) << "tserver doesn't support co-partitioning yet";
 }
 
+void TabletServiceAdminImpl::SplitTablet(const SplitTabletRequestPB* req,
+                                         SplitTabletResponsePB* resp,
+                                         rpc::RpcContext context) {
+  if (!CheckUuidMatchOrRespond(server_->tablet_manager(), "SplitTablet", req, resp, &context)) {
+    return;
+  }
+  TRACE_EVENT1("tserver", "SplitTablet",
+               "tablet_id", req->tablet_id());
+  LOG(INFO) << "Processing SplitTablet for tablet " << req->tablet_id() << " at "
+            << Slice(req->split_partition_key()).ToDebugHexString()
+            << " from " << context.requestor_string();
+
+  server::UpdateClock(*req, server_->Clock());
+
+  scoped_refptr<TabletPeer> tablet_peer;
+  if (!LookupTabletPeerOrRespond(server_->tablet_manager(), req->tablet_id(), resp, &context,
+                                 &tablet_peer)) {
+    return;
+  }
+
+  auto split_state = tablet_peer->tablet_metadata()->split_state();
+  if (split_state) {
+    // The master retries the request until it gets a response, so the split could be already
+    // applied. It also resends the request when the new tablets were not created in time, so
+    // create those that are still missing.
+    if (split_state->new_tablet1_id() == req->new_tablet1_id() &&
+        split_state->new_tablet2_id() == req->new_tablet2_id()) {
+      Status s = server_->tablet_manager()->CreateSplitChildren(req->tablet_id());
+      if (!s.ok()) {
+        SetupErrorAndRespond(resp->mutable_error(), s, TabletServerErrorPB::UNKNOWN_ERROR,
+                             &context);
+        return;
+      }
+      context.RespondSuccess();
+    } else {
+      SetupErrorAndRespond(resp->mutable_error(),
+                           STATUS_FORMAT(AlreadyPresent, "Tablet $0 was already split: $1",
+                                         req->tablet_id(), split_state->ShortDebugString()),
+                           TabletServerErrorPB::TABLET_SPLIT, &context);
+    }
+    return;
+  }
+
+  const auto& partition = tablet_peer->tablet_metadata()->partition();
+  const auto& split_key = req->split_partition_key();
+  if (split_key <= partition.partition_key_start() ||
+      (!partition.partition_key_end().empty() && split_key >= partition.partition_key_end())) {
+    SetupErrorAndRespond(resp->mutable_error(),
+                         STATUS_FORMAT(InvalidArgument,
+                                       "Split key $0 is outside of partition of tablet $1",
+                                       Slice(split_key).ToDebugHexString(), req->tablet_id()),
+                         TabletServerErrorPB::UNKNOWN_ERROR, &context);
+    return;
+  }
+
+  auto operation_state = std::make_unique<SplitOperationState>(tablet_peer->tablet(), req);
+
+  operation_state->set_completion_callback(
+      MakeRpcOperationCompletionCallback(std::move(context), resp, server_->Clock()));
+
+  // Submit the split tablet op. The RPC will be responded to asynchronously.
+  tablet_peer->Submit(
+      std::make_unique<tablet::SplitOperation>(std::move(operation_state), consensus::LEADER));
+}
+
 void TabletServiceImpl::Write(const WriteRequestPB* req,
                               WriteResponsePB* resp,
                               rpc::RpcContext context) {
@@ -687,6 +850,23 @@ void TabletServiceImpl::Write(const WriteRequestPB* req,
     return;
   }
 
+  if (!CheckQuotaOrRespond(tablet.get(), req->ByteSize(), resp, &context)) {
+    return;
+  }
+
+  // Reject the write before it reaches RocksDB, when flushes, compactions or replication of this
+  // tablet fall behind. The client retries it with backoff.
+  Status admission_status = tablet_peer->CheckWriteAdmission();
+  if (PREDICT_FALSE(!admission_status.ok())) {
+    tablet->metrics()->write_admission_rejections->Increment();
+    YB_LOG_EVERY_N_SECS(INFO, 1) << "Rejecting Write request: " << admission_status
+                                 << THROTTLE_MSG;
+    SetupErrorAndRespond(resp->mutable_error(), admission_status,
+                         TabletServerErrorPB::UNKNOWN_ERROR,
+                         &context);
+    return;
+  }
+
   auto operation_state = std::make_unique<WriteOperationState>(tablet_peer->tablet(), req, resp);
 
   auto context_ptr = std::make_shared<RpcContext>(std::move(context));
@@ -700,6 +880,28 @@ void TabletServiceImpl::Write(const WriteRequestPB* req,
   RETURN_UNKNOWN_ERROR_IF_NOT_OK(status, resp, context_ptr.get());
 }
 
+template <class Resp>
+bool TabletServiceImpl::CheckQuotaOrRespond(tablet::Tablet* tablet, size_t bytes, Resp* resp,
+                                            rpc::RpcContext* context) {
+  auto* quota_manager = server_->quota_manager();
+  if (!quota_manager || !quota_manager->has_quotas()) {
+    return true;
+  }
+
+  MonoDelta retry_after;
+  Status s = quota_manager->Admit(tablet->metadata()->table_id(), bytes, &retry_after);
+  if (PREDICT_TRUE(s.ok())) {
+    return true;
+  }
+  tablet->metrics()->quota_rejections->Increment();
+  YB_LOG_EVERY_N_SECS(INFO, 1) << "Rejecting request to tablet " << tablet->tablet_id() << ": "
+                               << s << THROTTLE_MSG;
+  resp->mutable_error()->set_retry_after_ms(retry_after.ToMilliseconds());
+  SetupErrorAndRespond(resp->mutable_error(), s, TabletServerErrorPB::OPERATION_THROTTLED,
+                       context);
+  return false;
+}
+
 Status TabletServiceImpl::CheckPeerIsReady(const TabletPeer& tablet_peer,
                                            TabletServerErrorPB::Code* error_code) {
   scoped_refptr<consensus::Consensus> consensus = tablet_peer.shared_consensus();
@@ -787,10 +989,48 @@ bool TabletServiceImpl::DoGetTabletOrRespond(const Req* req, Resp* resp, rpc::Rp
     SetupErrorAndRespond(resp->mutable_error(), s, error_code, context);
     return false;
   }
+
+  // Followers and observers serve reads only while they are close enough to the leader.
+  if (req->consistency_level() != YBConsistencyLevel::STRONG) {
+    s = CheckPeerIsNotStale(*tablet_peer.get(), *ptr, &error_code);
+    if (PREDICT_FALSE(!s.ok())) {
+      SetupErrorAndRespond(resp->mutable_error(), s, error_code, context);
+      return false;
+    }
+  }
+
   *tablet = ptr;
   return true;
 }
 
+Status TabletServiceImpl::CheckPeerIsNotStale(const TabletPeer& tablet_peer,
+                                              const tablet::Tablet& tablet,
+                                              TabletServerErrorPB::Code* error_code) {
+  const auto max_staleness_ms = FLAGS_max_stale_read_bound_time_ms;
+  if (max_staleness_ms <= 0) {
+    return Status::OK();
+  }
+  auto consensus = tablet_peer.shared_consensus();
+  if (!consensus || consensus->role() == consensus::RaftPeerPB::LEADER) {
+    return Status::OK();
+  }
+
+  // Safe time of follower is propagated from the leader, so it shows how far behind the leader
+  // data of this replica is.
+  const auto safe_time = tablet.SafeTime(tablet::RequireLease::kFalse);
+  const auto now = server_->Clock()->Now();
+  const auto staleness_us =
+      static_cast<int64_t>(now.GetPhysicalValueMicros()) -
+      static_cast<int64_t>(safe_time.GetPhysicalValueMicros());
+  if (staleness_us > max_staleness_ms * 1000LL) {
+    *error_code = TabletServerErrorPB::STALE_FOLLOWER;
+    return STATUS_FORMAT(
+        IllegalState, "Replica of tablet $0 is $1ms behind the leader, while $2ms is allowed",
+        tablet_peer.tablet_id(), staleness_us / 1000, max_staleness_ms);
+  }
+  return Status::OK();
+}
+
 void TabletServiceImpl::Read(const ReadRequestPB* req,
                              ReadResponsePB* resp,
                              rpc::RpcContext context) {
@@ -808,6 +1048,16 @@ void TabletServiceImpl::Read(const ReadRequestPB* req,
     return;
   }
 
+  // Only the tablet server enforces quotas, and all its tablets are regular tablets. Response
+  // bytes are consumed from the quota after the read.
+  tablet::Tablet* quota_tablet = nullptr;
+  if (server_->quota_manager() && server_->quota_manager()->has_quotas()) {
+    quota_tablet = down_cast<tablet::Tablet*>(tablet.get());
+    if (!CheckQuotaOrRespond(quota_tablet, req->ByteSize(), resp, &context)) {
+      return;
+    }
+  }
+
   // safe_ht_to_read is used only for read restart, so if read_time is valid, then we would respond
   // with "restart required".
   HybridTime safe_ht_to_read;
@@ -850,11 +1100,13 @@ void TabletServiceImpl::Read(const ReadRequestPB* req,
   host_port_pb.set_host(remote_address.address().to_string());
   host_port_pb.set_port(remote_address.port());
 
+  size_t rows_data_size = 0;
   for (;;) {
     resp->Clear();
     context.ResetRpcSidecars();
+    rows_data_size = 0;
     auto result = DoRead(tablet.get(), req, read_time, safe_ht_to_read, require_lease,
-                         &host_port_pb, resp, &context);
+                         &host_port_pb, resp, &context, &rows_data_size);
     if (!result.ok()) {
       SetupErrorAndRespond(
           resp->mutable_error(), result.status(), TabletServerErrorPB::UNKNOWN_ERROR, &context);
@@ -876,6 +1128,10 @@ void TabletServiceImpl::Read(const ReadRequestPB* req,
       break;
     }
   }
+  if (quota_tablet) {
+    server_->quota_manager()->Consume(
+        quota_tablet->metadata()->table_id(), resp->ByteSize() + rows_data_size);
+  }
   if (req->include_trace() && Trace::CurrentTrace() != nullptr) {
     resp->set_trace_buffer(Trace::CurrentTrace()->DumpToString(true));
   }
@@ -902,7 +1158,8 @@ Result<ReadHybridTime> TabletServiceImpl::DoRead(tablet::AbstractTablet* tablet,
                                                  tablet::RequireLease require_lease,
                                                  HostPortPB* host_port_pb,
                                                  ReadResponsePB* resp,
-                                                 rpc::RpcContext* context) {
+                                                 rpc::RpcContext* context,
+                                                 size_t* rows_data_size) {
   tablet::ScopedReadOperation read_tx(tablet, require_lease, read_time);
   switch (tablet->table_type()) {
     case TableType::REDIS_TABLE_TYPE: {
@@ -970,6 +1227,7 @@ Result<ReadHybridTime> TabletServiceImpl::DoRead(tablet::AbstractTablet* tablet,
           read_time.local_limit = safe_ht_to_read;
           return read_time;
         }
+        *rows_data_size += result.rows_data.size();
         int rows_data_sidecar_idx = 0;
         RETURN_NOT_OK(context->AddRpcSidecar(
             RefCntBuffer(result.rows_data), &rows_data_sidecar_idx));
@@ -983,9 +1241,11 @@ Result<ReadHybridTime> TabletServiceImpl::DoRead(tablet::AbstractTablet* tablet,
 }
 
 ConsensusServiceImpl::ConsensusServiceImpl(const scoped_refptr<MetricEntity>& metric_entity,
-                                           TabletPeerLookupIf* tablet_manager)
+                                           TabletPeerLookupIf* tablet_manager,
+                                           ThreadPool* raft_pool)
     : ConsensusServiceIf(metric_entity),
-      tablet_manager_(tablet_manager) {
+      tablet_manager_(tablet_manager),
+      raft_pool_(raft_pool) {
 }
 
 ConsensusServiceImpl::~ConsensusServiceImpl() {
@@ -999,7 +1259,9 @@ void ConsensusServiceImpl::UpdateConsensus(const ConsensusRequestPB* req,
     return;
   }
   scoped_refptr<TabletPeer> tablet_peer;
-  if (!LookupTabletPeerOrRespond(tablet_manager_, req->tablet_id(), resp, &context, &tablet_peer)) {
+  // Let the leader know that this replica failed, so it could be replaced.
+  if (!LookupTabletPeerOrRespond(tablet_manager_, req->tablet_id(), resp, &context, &tablet_peer,
+                                 TabletServerErrorPB::TABLET_FAILED)) {
     return;
   }
 
@@ -1025,6 +1287,51 @@ void ConsensusServiceImpl::UpdateConsensus(const ConsensusRequestPB* req,
   context.RespondSuccess();
 }
 
+void ConsensusServiceImpl::MultiRaftHeartbeat(const MultiRaftHeartbeatRequestPB* req,
+                                              MultiRaftHeartbeatResponsePB* resp,
+                                              rpc::RpcContext context) {
+  DVLOG(3) << "Received Multi Raft Heartbeat RPC with " << req->heartbeats_size()
+           << " heartbeats from " << req->caller_uuid();
+  if (!CheckUuidMatchOrRespond(tablet_manager_, "MultiRaftHeartbeat", req, resp, &context)) {
+    return;
+  }
+  const int num_heartbeats = req->heartbeats_size();
+  resp->mutable_responses()->Reserve(num_heartbeats);
+  for (int i = 0; i != num_heartbeats; ++i) {
+    resp->add_responses();
+  }
+
+  const int chunk_size = std::max(FLAGS_multi_raft_heartbeat_process_chunk_size, 1);
+  if (!raft_pool_ || num_heartbeats <= chunk_size) {
+    ProcessHeartbeats(tablet_manager_, *req, 0, num_heartbeats, resp);
+    context.RespondSuccess();
+    return;
+  }
+
+  // Heartbeats are split into chunks, that are processed in parallel on the Raft thread pool,
+  // except the first one, that is processed by this thread. The response is sent when the last
+  // chunk is done.
+  const int num_chunks = (num_heartbeats + chunk_size - 1) / chunk_size;
+  auto context_ptr = std::make_shared<RpcContext>(std::move(context));
+  auto chunks_left = std::make_shared<std::atomic<int>>(num_chunks);
+  auto process_chunk = [tablet_manager = tablet_manager_, req, resp, context_ptr, chunks_left](
+      int begin, int end) {
+    ProcessHeartbeats(tablet_manager, *req, begin, end, resp);
+    if (chunks_left->fetch_sub(1, std::memory_order_acq_rel) == 1) {
+      context_ptr->RespondSuccess();
+    }
+  };
+  for (int begin = chunk_size; begin < num_heartbeats; begin += chunk_size) {
+    const int end = std::min(begin + chunk_size, num_heartbeats);
+    auto s = raft_pool_->SubmitFunc(std::bind(process_chunk, begin, end));
+    if (!s.ok()) {
+      VLOG(1) << "Failed to submit heartbeats processing, processing inline: " << s;
+      process_chunk(begin, end);
+    }
+  }
+  process_chunk(0, chunk_size);
+}
+
 void ConsensusServiceImpl::RequestConsensusVote(const VoteRequestPB* req,
                                                 VoteResponsePB* resp,
                                                 rpc::RpcContext context) {
@@ -1364,6 +1671,27 @@ void TabletServiceImpl::ImportData(const ImportDataRequestPB* req,
   context.RespondSuccess();
 }
 
+void TabletServiceImpl::IngestSstFile(const IngestSstFileRequestPB* req,
+                                      IngestSstFileResponsePB* resp,
+                                      rpc::RpcContext context) {
+  tablet::TabletPeerPtr peer;
+  if (!LookupTabletPeerOrRespond(server_->tablet_manager(), req->tablet_id(), resp, &context,
+                                 &peer)) {
+    return;
+  }
+  auto status = req->ingest()
+      ? peer->tablet()->IngestSstFile(req->file_name())
+      : peer->tablet()->ReceiveSstFileChunk(req->file_name(), req->offset(), req->data());
+  if (!status.ok()) {
+    SetupErrorAndRespond(resp->mutable_error(),
+                         status,
+                         TabletServerErrorPB::UNKNOWN_ERROR,
+                         &context);
+    return;
+  }
+  context.RespondSuccess();
+}
+
 void TabletServiceImpl::GetTabletStatus(const GetTabletStatusRequestPB* req,
                                         GetTabletStatusResponsePB* resp,
                                         rpc::RpcContext context) {
@@ -1379,6 +1707,35 @@ void TabletServiceImpl::GetTabletStatus(const GetTabletStatusRequestPB* req,
   context.RespondSuccess();
 }
 
+void TabletServiceImpl::GetKeyAccessStats(const GetKeyAccessStatsRequestPB* req,
+                                          GetKeyAccessStatsResponsePB* resp,
+                                          rpc::RpcContext context) {
+  std::vector<scoped_refptr<TabletPeer>> peers;
+  if (req->has_tablet_id()) {
+    tablet::TabletPeerPtr peer;
+    if (!server_->tablet_manager()->LookupTablet(req->tablet_id(), &peer)) {
+      auto status = STATUS(NotFound, "Tablet not found", req->tablet_id());
+      SetupErrorAndRespond(
+          resp->mutable_error(), status, TabletServerErrorPB::TABLET_NOT_FOUND, &context);
+      return;
+    }
+    peers.push_back(peer);
+  } else {
+    server_->tablet_manager()->GetTabletPeers(&peers);
+  }
+  for (const auto& peer : peers) {
+    auto tablet = peer->shared_tablet();
+    if (!tablet) {
+      continue;
+    }
+    auto* entry = resp->add_tablets();
+    entry->set_tablet_id(peer->tablet_id());
+    entry->set_table_name(peer->tablet_metadata()->table_name());
+    tablet->key_access_stats()->ToPB(req->max_keys(), entry->mutable_stats());
+  }
+  context.RespondSuccess();
+}
+
 void TabletServiceImpl::Shutdown() {
 }
 
@@ -51,6 +51,7 @@ namespace yb {
 class Schema;
 class Status;
 class HybridTime;
+class ThreadPool;
 
 namespace tserver {
 
@@ -88,6 +89,10 @@ class TabletServiceImpl : public TabletServerServiceIf {
                   ImportDataResponsePB* resp,
                   rpc::RpcContext context) override;
 
+  void IngestSstFile(const IngestSstFileRequestPB* req,
+                     IngestSstFileResponsePB* resp,
+                     rpc::RpcContext context) override;
+
   void UpdateTransaction(const UpdateTransactionRequestPB* req,
                          UpdateTransactionResponsePB* resp,
                          rpc::RpcContext context) override;
@@ -108,6 +113,10 @@ class TabletServiceImpl : public TabletServerServiceIf {
                        GetTabletStatusResponsePB* resp,
                        rpc::RpcContext context) override;
 
+  void GetKeyAccessStats(const GetKeyAccessStatsRequestPB* req,
+                         GetKeyAccessStatsResponsePB* resp,
+                         rpc::RpcContext context) override;
+
   void Shutdown() override;
 
  private:
@@ -121,6 +130,12 @@ class TabletServiceImpl : public TabletServerServiceIf {
   CHECKED_STATUS CheckPeerIsReady(const tablet::TabletPeer& tablet_peer,
                                   TabletServerErrorPB::Code* error_code);
 
+  // Check that the non leader peer lags behind the leader no more than allowed by
+  // max_stale_read_bound_time_ms, so it could serve reads with bounded staleness.
+  CHECKED_STATUS CheckPeerIsNotStale(const tablet::TabletPeer& tablet_peer,
+                                     const tablet::Tablet& tablet,
+                                     TabletServerErrorPB::Code* error_code);
+
   template <class Req, class Resp>
   bool DoGetTabletOrRespond(const Req* req, Resp* resp, rpc::RpcContext* context,
                             std::shared_ptr<tablet::AbstractTablet>* tablet);
@@ -130,6 +145,12 @@ class TabletServiceImpl : public TabletServerServiceIf {
                                   rpc::RpcContext* context,
                                   std::shared_ptr<tablet::AbstractTablet>* tablet);
 
+  // Admits the request to the tablet, when its table and the table namespace are within their
+  // quotas. Otherwise responds with OPERATION_THROTTLED and returns false.
+  template <class Resp>
+  bool CheckQuotaOrRespond(tablet::Tablet* tablet, size_t bytes, Resp* resp,
+                           rpc::RpcContext* context);
+
   template<class Req, class Resp>
   bool PrepareModify(const Req& req,
                      Resp* resp,
@@ -146,7 +167,8 @@ class TabletServiceImpl : public TabletServerServiceIf {
                                 tablet::RequireLease require_lease,
                                 HostPortPB* hostPortPB,
                                 ReadResponsePB* resp,
-                                rpc::RpcContext* context);
+                                rpc::RpcContext* context,
+                                size_t* rows_data_size);
 
   TabletServerIf *const server_;
 };
@@ -170,14 +192,21 @@ class TabletServiceAdminImpl : public TabletServerAdminServiceIf {
                                 CopartitionTableResponsePB* resp,
                                 rpc::RpcContext context) override;
 
+  virtual void SplitTablet(const SplitTabletRequestPB* req,
+                           SplitTabletResponsePB* resp,
+                           rpc::RpcContext context) override;
+
  private:
   TabletServer* server_;
 };
 
 class ConsensusServiceImpl : public consensus::ConsensusServiceIf {
  public:
+  // Heartbeats of large MultiRaftHeartbeat batches are processed in parallel on raft_pool, when it
+  // is specified.
   ConsensusServiceImpl(const scoped_refptr<MetricEntity>& metric_entity,
-                       TabletPeerLookupIf* tablet_manager_);
+                       TabletPeerLookupIf* tablet_manager_,
+                       ThreadPool* raft_pool = nullptr);
 
   virtual ~ConsensusServiceImpl();
 
@@ -185,6 +214,10 @@ class ConsensusServiceImpl : public consensus::ConsensusServiceIf {
                                consensus::ConsensusResponsePB *resp,
                                rpc::RpcContext context) override;
 
+  virtual void MultiRaftHeartbeat(const consensus::MultiRaftHeartbeatRequestPB* req,
+                                  consensus::MultiRaftHeartbeatResponsePB* resp,
+                                  rpc::RpcContext context) override;
+
   virtual void RequestConsensusVote(const consensus::VoteRequestPB* req,
                                     consensus::VoteResponsePB* resp,
                                     rpc::RpcContext context) override;
@@ -223,6 +256,7 @@ class ConsensusServiceImpl : public consensus::ConsensusServiceIf {
 
  private:
   TabletPeerLookupIf* tablet_manager_;
+  ThreadPool* raft_pool_;
 };
 
 }  // namespace tserver
@@ -148,6 +148,13 @@ TEST_F(TsTabletManagerTest, TestCreateTablet) {
   // Ensure that the tablet got re-loaded and re-opened off disk.
   ASSERT_TRUE(tablet_manager_->LookupTablet(kTabletId, &peer));
   ASSERT_EQ(kTabletId, peer->tablet()->tablet_id());
+
+  auto startup_times = tablet_manager_->startup_times();
+  LOG(INFO) << "Startup times: " << startup_times.ToString();
+  ASSERT_EQ(1, startup_times.num_tablets);
+  ASSERT_EQ(1, startup_times.num_opened);
+  ASSERT_TRUE(startup_times.total.Initialized());
+  ASSERT_GT(startup_times.open_rocksdb.ToNanoseconds(), 0);
 }
 
 TEST_F(TsTabletManagerTest, TestProperBackgroundFlushOnStartup) {
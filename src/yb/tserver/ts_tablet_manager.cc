@@ -48,7 +48,9 @@
 #include "yb/consensus/consensus_meta.h"
 #include "yb/consensus/log.h"
 #include "yb/consensus/log_anchor_registry.h"
+#include "yb/consensus/log_cache.h"
 #include "yb/consensus/metadata.pb.h"
+#include "yb/consensus/multi_raft_batcher.h"
 #include "yb/consensus/opid_util.h"
 #include "yb/consensus/quorum_util.h"
 
@@ -82,8 +84,10 @@
 #include "yb/util/env_util.h"
 #include "yb/util/fault_injection.h"
 #include "yb/util/flag_tags.h"
+#include "yb/util/format.h"
 #include "yb/util/mem_tracker.h"
 #include "yb/util/metrics.h"
+#include "yb/util/path_util.h"
 #include "yb/util/pb_util.h"
 #include "yb/util/stopwatch.h"
 #include "yb/util/trace.h"
@@ -128,11 +132,32 @@ DEFINE_test_flag(double, fault_crash_after_rb_files_fetched, 0.0,
 DEFINE_test_flag(bool, pretend_memory_exceeded_enforce_flush, false,
                  "Always pretend memory has been exceeded to enforce background flush.");
 
+DECLARE_int64(db_block_size_bytes);
+
 namespace {
 
 constexpr int kDbCacheSizeUsePercentage = -1;
 constexpr int kDbCacheSizeCacheDisabled = -2;
 
+// Returns total size of files in the WAL directory of a tablet.
+uint64_t WalDirSize(yb::Env* env, const std::string& wal_dir) {
+  std::vector<std::string> children;
+  if (!env->GetChildren(wal_dir, &children).ok()) {
+    return 0;
+  }
+  uint64_t result = 0;
+  for (const auto& child : children) {
+    if (child == "." || child == "..") {
+      continue;
+    }
+    auto size = env->GetFileSize(yb::JoinPathSegments(wal_dir, child));
+    if (size.ok()) {
+      result += *size;
+    }
+  }
+  return result;
+}
+
 } // namespace
 
 DEFINE_int32(flush_background_task_interval_msec, 0,
@@ -159,6 +184,19 @@ DEFINE_int32(db_block_cache_size_percentage, 50,
              "Default percentage of total available memory to use as block cache size, if not "
              "asking for a raw number, through FLAGS_db_block_cache_size_bytes.");
 
+DEFINE_int32(db_block_cache_compressed_percentage, 0,
+             "Percentage of the block cache size to give to the compressed secondary block cache "
+             "tier. This tier keeps blocks in compressed form, so blocks that fall out of the "
+             "uncompressed block cache could still be served without disk reads. Blocks are "
+             "inserted into both tiers when they are read from disk, not when they are evicted, "
+             "so recently read blocks are cached twice. Its metrics have the "
+             "block_cache_compressed_ prefix. 0 disables the compressed tier.");
+
+DEFINE_string(db_block_cache_type, "lru",
+              "Eviction policy of the shared block cache. Possible values: lru, clock. The clock "
+              "cache does not take locks on lookups, so it scales better on machines with many "
+              "cores serving read heavy workloads.");
+
 DEFINE_int32(read_pool_max_threads, 128,
              "The maximum number of threads allowed for read_pool_. This pool is used "
              "to run multiple read operations, that are part of the same tablet rpc, "
@@ -168,6 +206,13 @@ DEFINE_int32(read_pool_max_queue_size, 128,
              "is used to run multiple read operations, that are part of the same tablet rpc, "
              "in parallel.");
 
+DEFINE_int32(db_memtable_insert_threads, 0,
+             "Number of threads shared by all tablets that help to insert a large write batch "
+             "into the memtable, so that applying a big Raft batch is not limited by a single "
+             "core. When the batches written together have at least twice "
+             "db_memtable_insert_chunk_size entries, they are split into chunks inserted "
+             "concurrently. 0 disables concurrent memtable inserts.");
+
 DEFINE_test_flag(int32, sleep_after_tombstoning_tablet_secs, 0,
                  "Whether we sleep in LogAndTombstone after calling DeleteTabletData.");
 
@@ -288,6 +333,7 @@ TSTabletManager::TSTabletManager(FsManager* fs_manager,
                                  MetricRegistry* metric_registry)
   : fs_manager_(fs_manager),
     server_(server),
+    log_cache_registry_(std::make_unique<consensus::LogCacheRegistry>()),
     next_report_seq_(0),
     metric_registry_(metric_registry),
     state_(MANAGER_INITIALIZING),
@@ -328,6 +374,12 @@ TSTabletManager::TSTabletManager(FsManager* fs_manager,
                .set_max_queue_size(FLAGS_read_pool_max_queue_size)
                .set_metrics(std::move(read_metrics))
                .Build(&read_pool_));
+  if (FLAGS_db_memtable_insert_threads > 0) {
+    CHECK_OK(ThreadPoolBuilder("memtable-insert")
+                 .set_max_threads(FLAGS_db_memtable_insert_threads)
+                 .Build(&memtable_insert_pool_));
+    tablet_options_.memtable_insert_pool = memtable_insert_pool_.get();
+  }
 
   int64_t block_cache_size_bytes = FLAGS_db_block_cache_size_bytes;
   int64_t total_ram_avail = MemTracker::GetRootTracker()->limit();
@@ -343,9 +395,34 @@ TSTabletManager::TSTabletManager(FsManager* fs_manager,
     block_cache_size_bytes = total_ram_avail * FLAGS_db_block_cache_size_percentage / 100;
   }
   if (FLAGS_db_block_cache_size_bytes != kDbCacheSizeCacheDisabled) {
-    tablet_options_.block_cache = rocksdb::NewLRUCache(block_cache_size_bytes,
-                                                       FLAGS_db_block_cache_num_shard_bits);
-    tablet_options_.block_cache->SetMetrics(server_->metric_entity());
+    CHECK(FLAGS_db_block_cache_compressed_percentage >= 0 &&
+          FLAGS_db_block_cache_compressed_percentage < 100)
+        << Substitute(
+               "Flag db_block_cache_compressed_percentage must be between 0 and 99. Current value: "
+               "$0",
+               FLAGS_db_block_cache_compressed_percentage);
+    // The compressed tier is carved from the block cache budget.
+    const int64_t compressed_block_cache_size_bytes =
+        block_cache_size_bytes * FLAGS_db_block_cache_compressed_percentage / 100;
+    block_cache_size_bytes -= compressed_block_cache_size_bytes;
+    if (FLAGS_db_block_cache_type == "clock") {
+      tablet_options_.block_cache = rocksdb::NewClockCache(
+          block_cache_size_bytes, FLAGS_db_block_cache_num_shard_bits,
+          false /* strict_capacity_limit */, FLAGS_db_block_size_bytes);
+    } else {
+      CHECK_EQ(FLAGS_db_block_cache_type, "lru")
+          << "Flag db_block_cache_type must be either lru or clock";
+      tablet_options_.block_cache = rocksdb::NewLRUCache(block_cache_size_bytes,
+                                                         FLAGS_db_block_cache_num_shard_bits);
+    }
+    tablet_options_.block_cache->SetMetrics(
+        server_->metric_entity(), yb::CacheTier::kUncompressed);
+    if (compressed_block_cache_size_bytes > 0) {
+      tablet_options_.block_cache_compressed = rocksdb::NewLRUCache(
+          compressed_block_cache_size_bytes, FLAGS_db_block_cache_num_shard_bits);
+      tablet_options_.block_cache_compressed->SetMetrics(
+          server_->metric_entity(), yb::CacheTier::kCompressed);
+    }
   }
 
   // Calculate memstore_size_bytes
@@ -394,12 +471,20 @@ Status TSTabletManager::Init() {
                 .set_max_threads(max_bootstrap_threads)
                 .Build(&open_tablet_pool_));
 
+  {
+    std::lock_guard<std::mutex> lock(startup_times_mutex_);
+    startup_start_time_ = MonoTime::Now();
+  }
+
   // Search for tablets in the metadata dir.
   vector<string> tablet_ids;
   RETURN_NOT_OK(fs_manager_->ListTabletIds(&tablet_ids));
 
   InitLocalRaftPeerPB();
 
+  multi_raft_manager_ = std::make_unique<consensus::MultiRaftManager>(
+      server_->messenger(), local_peer_pb_.permanent_uuid());
+
   vector<scoped_refptr<TabletMetadata> > metas;
 
   // First, load all of the tablet metadata. We do this before we start
@@ -424,8 +509,29 @@ Status TSTabletManager::Init() {
     metas.push_back(meta);
   }
 
+  // Open tablets with less log to replay first, so the majority of tablets becomes available
+  // sooner, instead of waiting behind a few tablets with long logs.
+  std::vector<std::pair<uint64_t, scoped_refptr<TabletMetadata>>> metas_by_wal_size;
+  metas_by_wal_size.reserve(metas.size());
+  for (const auto& meta : metas) {
+    metas_by_wal_size.emplace_back(WalDirSize(fs_manager_->env(), meta->wal_dir()), meta);
+  }
+  std::stable_sort(metas_by_wal_size.begin(), metas_by_wal_size.end(),
+                   [](const auto& lhs, const auto& rhs) { return lhs.first < rhs.first; });
+
+  {
+    std::lock_guard<std::mutex> lock(startup_times_mutex_);
+    auto now = MonoTime::Now();
+    startup_times_.num_tablets = metas.size();
+    startup_times_.load_metadata = now.GetDeltaSince(startup_start_time_);
+    if (metas.empty()) {
+      startup_times_.total = startup_times_.load_metadata;
+    }
+  }
+
   // Now submit the "Open" task for each.
-  for (const scoped_refptr<TabletMetadata>& meta : metas) {
+  for (const auto& meta_and_wal_size : metas_by_wal_size) {
+    const auto& meta = meta_and_wal_size.second;
     scoped_refptr<TransitionInProgressDeleter> deleter; //DHQ： 在 destuctor里面，从in_progress里面，清除对应tablet
     {
       std::lock_guard<rw_spinlock> lock(lock_);
@@ -434,7 +540,7 @@ Status TSTabletManager::Init() {
 
     scoped_refptr<TabletPeer> tablet_peer = CreateAndRegisterTabletPeer(meta, NEW_PEER);
     RETURN_NOT_OK(open_tablet_pool_->SubmitFunc(
-        std::bind(&TSTabletManager::OpenTablet, this, meta, deleter)));
+        std::bind(&TSTabletManager::OpenTabletAtStartup, this, meta, deleter, MonoTime::Now())));
   }
 
   {
@@ -479,6 +585,22 @@ Status TSTabletManager::CreateNewTablet(
     RaftConfigPB config, //DHQ: config就是Raft的
     scoped_refptr<TabletPeer> *tablet_peer) {
   CHECK_EQ(state(), MANAGER_RUNNING);
+  return DoCreateNewTablet(
+      table_id, tablet_id, partition, table_name, table_type, schema, partition_schema,
+      std::move(config), InitTabletDataFunctor(), tablet_peer);
+}
+
+Status TSTabletManager::DoCreateNewTablet(
+    const string &table_id,
+    const string &tablet_id,
+    const Partition &partition,
+    const string &table_name,
+    TableType table_type,
+    const Schema &schema,
+    const PartitionSchema &partition_schema,
+    RaftConfigPB config,
+    const InitTabletDataFunctor& init_data,
+    scoped_refptr<TabletPeer> *tablet_peer) {
   CHECK(IsRaftConfigMember(server_->instance_pb().permanent_uuid(), config));
 
   for (int i = 0; i < config.peers_size(); ++i) {
@@ -531,6 +653,10 @@ Status TSTabletManager::CreateNewTablet(
   RETURN_NOT_OK_PREPEND(create_status, "Couldn't create tablet metadata")
   LOG(INFO) << "Created tablet metadata for table: " << table_id << ", tablet: " << tablet_id;
 
+  if (init_data) {
+    RETURN_NOT_OK_PREPEND(init_data(meta), "Couldn't initialize tablet data");
+  }
+
   // We must persist the consensus metadata to disk before starting a new
   // tablet's TabletPeer and Consensus implementation.
   std::unique_ptr<ConsensusMetadata> cmeta;//DHQ: 这个不是PB
@@ -541,7 +667,9 @@ Status TSTabletManager::CreateNewTablet(
 
   // We can run this synchronously since there is nothing to bootstrap.
   RETURN_NOT_OK(
-      open_tablet_pool_->SubmitFunc(std::bind(&TSTabletManager::OpenTablet, this, meta, deleter)));
+      open_tablet_pool_->SubmitFunc(std::bind(
+          &TSTabletManager::OpenTablet, this, meta, deleter, nullptr /* bootstrap_times */,
+          nullptr /* start_peer_time */)));
 
   if (tablet_peer) {
     *tablet_peer = new_peer;
@@ -553,6 +681,65 @@ string LogPrefix(const string& tablet_id, const string& uuid) {
   return "T " + tablet_id + " P " + uuid + ": ";
 }
 
+Status TSTabletManager::CreateSplitChildren(const string& parent_id) {
+  scoped_refptr<TabletPeer> parent_peer;
+  if (!LookupTablet(parent_id, &parent_peer)) {
+    return STATUS(NotFound, "Tablet not found", parent_id);
+  }
+  const auto& meta = parent_peer->tablet_metadata();
+  const auto split_state = meta->split_state();
+  if (!split_state) {
+    return STATUS(IllegalState, "Tablet was not split", parent_id);
+  }
+  auto parent_tablet = parent_peer->shared_tablet();
+  auto consensus = parent_peer->shared_consensus();
+  if (!parent_tablet || !consensus) {
+    return STATUS(IllegalState, "Tablet is not running", parent_id);
+  }
+
+  // New tablets are replicated to the same servers as the split tablet.
+  auto config = consensus->CommittedConfig();
+  if (!IsRaftConfigMember(server_->instance_pb().permanent_uuid(), config)) {
+    LOG(INFO) << LogPrefix(parent_id, fs_manager_->uuid())
+              << "Not a member of the committed config, skip creation of split tablets";
+    return Status::OK();
+  }
+
+  PartitionPB parent_partition;
+  meta->partition().ToPB(&parent_partition);
+  const std::string* child_ids[] = {
+      &split_state->new_tablet1_id(), &split_state->new_tablet2_id() };
+  for (int i = 0; i != 2; ++i) {
+    const auto& child_id = *child_ids[i];
+    scoped_refptr<TabletPeer> junk;
+    if (LookupTablet(child_id, &junk)) {
+      continue;
+    }
+
+    PartitionPB child_partition_pb = parent_partition;
+    if (i == 0) {
+      child_partition_pb.set_partition_key_end(split_state->split_partition_key());
+    } else {
+      child_partition_pb.set_partition_key_start(split_state->split_partition_key());
+    }
+    Partition child_partition;
+    Partition::FromPB(child_partition_pb, &child_partition);
+
+    LOG(INFO) << LogPrefix(parent_id, fs_manager_->uuid()) << "Creating split tablet "
+              << child_id << ", partition: " << child_partition_pb.ShortDebugString();
+    auto init_data = [parent_tablet](const scoped_refptr<TabletMetadata>& child_meta) {
+      return parent_tablet->CreateSplitCheckpoint(child_meta->rocksdb_dir());
+    };
+    Status s = DoCreateNewTablet(
+        meta->table_id(), child_id, child_partition, meta->table_name(), meta->table_type(),
+        meta->schema(), meta->partition_schema(), config, init_data, nullptr);
+    if (!s.ok() && !s.IsAlreadyPresent()) {
+      return s.CloneAndPrepend(Format("Failed to create split tablet $0", child_id));
+    }
+  }
+  return Status::OK();
+}
+
 Status CheckLeaderTermNotLower(//DHQ: 这个用于读么？
     const string& tablet_id,
     const string& uuid,
@@ -699,7 +886,7 @@ Status TSTabletManager::StartRemoteBootstrap(const StartRemoteBootstrapRequestPB
                    this);
 
   LOG(INFO) << kLogPrefix << "Remote bootstrap: Opening tablet";
-  OpenTablet(meta, nullptr);
+  OpenTablet(meta, nullptr, nullptr /* bootstrap_times */, nullptr /* start_peer_time */);
 
   // If OpenTablet fails, tablet_peer->error() will be set.
   SHUTDOWN_AND_TOMBSTONE_TABLET_PEER_NOT_OK(tablet_peer->error(),
@@ -878,8 +1065,48 @@ Status TSTabletManager::OpenTabletMeta(const string& tablet_id,
   return Status::OK();
 }
 //DHQ: 加载/CreateNewTablet时调用
+std::string TabletStartupTimes::ToString() const {
+  return Format("{ tablets: $0 opened: $1 load_metadata: $2 wait_in_queue: $3 open_rocksdb: $4 "
+                "replay_log: $5 start_peer: $6 total: $7 }",
+                num_tablets, num_opened, load_metadata, wait_in_queue, open_rocksdb, replay_log,
+                start_peer, total);
+}
+
+TabletStartupTimes TSTabletManager::startup_times() const {
+  std::lock_guard<std::mutex> lock(startup_times_mutex_);
+  return startup_times_;
+}
+
+void TSTabletManager::OpenTabletAtStartup(
+    const scoped_refptr<TabletMetadata>& meta,
+    const scoped_refptr<TransitionInProgressDeleter>& deleter,
+    MonoTime submit_time) {
+  auto wait_in_queue = MonoTime::Now().GetDeltaSince(submit_time);
+  tablet::BootstrapTimes bootstrap_times;
+  MonoDelta start_peer_time;
+  OpenTablet(meta, deleter, &bootstrap_times, &start_peer_time);
+
+  std::lock_guard<std::mutex> lock(startup_times_mutex_);
+  startup_times_.wait_in_queue += wait_in_queue;
+  if (bootstrap_times.open_rocksdb) {
+    startup_times_.open_rocksdb += bootstrap_times.open_rocksdb;
+  }
+  if (bootstrap_times.replay_log) {
+    startup_times_.replay_log += bootstrap_times.replay_log;
+  }
+  if (start_peer_time) {
+    startup_times_.start_peer += start_peer_time;
+  }
+  if (++startup_times_.num_opened == startup_times_.num_tablets) {
+    startup_times_.total = MonoTime::Now().GetDeltaSince(startup_start_time_);
+    LOG(INFO) << "Opened all tablets found at startup: " << startup_times_.ToString();
+  }
+}
+
 void TSTabletManager::OpenTablet(const scoped_refptr<TabletMetadata>& meta,
-                                 const scoped_refptr<TransitionInProgressDeleter>& deleter) {
+                                 const scoped_refptr<TransitionInProgressDeleter>& deleter,
+                                 tablet::BootstrapTimes* bootstrap_times,
+                                 MonoDelta* start_peer_time) {
   string tablet_id = meta->tablet_id();
   TRACE_EVENT1("tserver", "TSTabletManager::OpenTablet",
                "tablet_id", tablet_id);
@@ -910,7 +1137,8 @@ void TSTabletManager::OpenTablet(const scoped_refptr<TabletMetadata>& meta,
         tablet_peer->log_anchor_registry(),
         tablet_options_,
         tablet_peer.get(),
-        tablet_peer.get()};
+        tablet_peer.get(),
+        bootstrap_times};
     s = BootstrapTablet(data, &tablet, &log, &bootstrap_info);//DHQ: Tablet 的 bootstrap
     if (!s.ok()) {
       LOG(ERROR) << kLogPrefix << "Tablet failed to bootstrap: "
@@ -920,6 +1148,15 @@ void TSTabletManager::OpenTablet(const scoped_refptr<TabletMetadata>& meta,
     }
   }
 
+  // Creation of the split tablets takes a RocksDB checkpoint, so it is done outside of the apply
+  // path.
+  tablet->SetSplitCallback([this, tablet_id] {
+    WARN_NOT_OK(open_tablet_pool_->SubmitFunc([this, tablet_id] {
+                  WARN_NOT_OK(CreateSplitChildren(tablet_id), "Failed to create split tablets");
+                }),
+                "Failed to submit creation of split tablets");
+  });
+
   MonoTime start(MonoTime::Now());
   LOG_TIMING_PREFIX(INFO, kLogPrefix, "starting tablet") {
     TRACE("Initializing tablet peer");
@@ -930,7 +1167,9 @@ void TSTabletManager::OpenTablet(const scoped_refptr<TabletMetadata>& meta,
                                     log,
                                     tablet->GetMetricEntity(),
                                     raft_pool(),
-                                    tablet_prepare_pool());
+                                    tablet_prepare_pool(),
+                                    multi_raft_manager_.get(),
+                                    log_cache_registry_.get());
 
     if (!s.ok()) {
       LOG(ERROR) << kLogPrefix << "Tablet failed to init: "
@@ -951,6 +1190,14 @@ void TSTabletManager::OpenTablet(const scoped_refptr<TabletMetadata>& meta,
     tablet_peer->RegisterMaintenanceOps(server_->maintenance_manager());
   }
 
+  // The split could be applied before restart, while its tablets were not created yet.
+  if (meta->split_state()) {
+    WARN_NOT_OK(CreateSplitChildren(tablet_id), kLogPrefix + "Failed to create split tablets");
+  }
+
+  if (start_peer_time) {
+    *start_peer_time = MonoTime::Now().GetDeltaSince(start);
+  }
   int elapsed_ms = MonoTime::Now().GetDeltaSince(start).ToMilliseconds();
   if (elapsed_ms > FLAGS_tablet_start_warn_threshold_ms) {
     LOG(WARNING) << kLogPrefix << "Tablet startup took " << elapsed_ms << "ms";
@@ -1013,6 +1260,9 @@ void TSTabletManager::Shutdown() {
   if (tablet_prepare_pool_) {
     tablet_prepare_pool_->Shutdown();
   }
+  if (memtable_insert_pool_) {
+    memtable_insert_pool_->Shutdown();
+  }
 
   {
     std::lock_guard<rw_spinlock> l(lock_);
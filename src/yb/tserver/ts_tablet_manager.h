@@ -33,6 +33,7 @@
 #define YB_TSERVER_TS_TABLET_MANAGER_H
 
 #include <memory>
+#include <mutex>
 #include <string>
 #include <unordered_map>
 #include <unordered_set>
@@ -50,12 +51,14 @@
 #include "yb/consensus/metadata.pb.h"
 #include "yb/gutil/macros.h"
 #include "yb/gutil/ref_counted.h"
+#include "yb/tablet/tablet_bootstrap_if.h"
 #include "yb/tablet/tablet_fwd.h"
 #include "yb/tserver/tablet_peer_lookup.h"
 #include "yb/tserver/tserver.pb.h"
 #include "yb/tserver/tserver_admin.pb.h"
 #include "yb/util/locks.h"
 #include "yb/util/metrics.h"
+#include "yb/util/monotime.h"
 #include "yb/util/status.h"
 #include "yb/util/threadpool.h"
 #include "yb/tablet/tablet_options.h"
@@ -70,6 +73,8 @@ class Schema;
 class BackgroundTask;
 
 namespace consensus {
+class LogCacheRegistry;
+class MultiRaftManager;
 class RaftConfigPB;
 } // namespace consensus
 
@@ -113,6 +118,26 @@ class TransitionInProgressDeleter;
     } \
   } while (0)
 
+// Breakdown of the time spent opening tablets at tablet server startup. Phases of individual
+// tablets are summed over all tablets, so their sum could exceed the wall time, because tablets
+// are opened in parallel.
+struct TabletStartupTimes {
+  size_t num_tablets = 0;
+  size_t num_opened = 0;
+  // Loading metadata of all tablets, before any tablet is opened.
+  MonoDelta load_metadata = MonoDelta::kZero;
+  // Waiting for a free tablet opening thread.
+  MonoDelta wait_in_queue = MonoDelta::kZero;
+  MonoDelta open_rocksdb = MonoDelta::kZero;
+  MonoDelta replay_log = MonoDelta::kZero;
+  // Initializing and starting tablet peers, including consensus.
+  MonoDelta start_peer = MonoDelta::kZero;
+  // Wall time from the start of TSTabletManager::Init till all tablets were opened.
+  MonoDelta total;
+
+  std::string ToString() const;
+};
+
 // Keeps track of the tablets hosted on the tablet server side.
 //
 // TODO: will also be responsible for keeping the local metadata about
@@ -141,6 +166,9 @@ class TSTabletManager : public tserver::TabletPeerLookupIf {
   // the first tablet whose bootstrap failed.
   CHECKED_STATUS WaitForAllBootstrapsToFinish();
 
+  // Returns time spent opening tablets at startup so far.
+  TabletStartupTimes startup_times() const;
+
   // Shut down all of the tablets, gracefully flushing before shutdown.
   void Shutdown();
 
@@ -166,6 +194,11 @@ class TSTabletManager : public tserver::TabletPeerLookupIf {
     consensus::RaftConfigPB config,
     scoped_refptr<tablet::TabletPeer> *tablet_peer);
 
+  // Creates the tablets, that the specified tablet was split into, from the data of this tablet.
+  // Does nothing for tablets that are already registered, so could be invoked several times, e.g.
+  // when the split operation is replayed during bootstrap.
+  CHECKED_STATUS CreateSplitChildren(const std::string& parent_id);
+
   // Delete the specified tablet.
   // 'delete_type' must be one of TABLET_DATA_DELETED or TABLET_DATA_TOMBSTONED
   // or else returns Status::IllegalArgument.
@@ -310,6 +343,24 @@ class TSTabletManager : public tserver::TabletPeerLookupIf {
                                             const std::string& reason,
                                             scoped_refptr<TransitionInProgressDeleter>* deleter);
 
+  typedef std::function<Status(const scoped_refptr<tablet::TabletMetadata>&)>
+      InitTabletDataFunctor;
+
+  // Same as CreateNewTablet, but does not require the manager to be running. If init_data is
+  // specified, it is invoked after the metadata is created and before the tablet is opened, to
+  // populate the data directory of the tablet.
+  CHECKED_STATUS DoCreateNewTablet(
+    const string &table_id,
+    const string &tablet_id,
+    const Partition &partition,
+    const string &table_name,
+    TableType table_type,
+    const Schema &schema,
+    const PartitionSchema &partition_schema,
+    consensus::RaftConfigPB config,
+    const InitTabletDataFunctor& init_data,
+    scoped_refptr<tablet::TabletPeer> *tablet_peer);
+
   // Open a tablet meta from the local file system by loading its superblock.
   CHECKED_STATUS OpenTabletMeta(const std::string& tablet_id,
                         scoped_refptr<tablet::TabletMetadata>* metadata);
@@ -325,8 +376,17 @@ class TSTabletManager : public tserver::TabletPeerLookupIf {
   // method. A TransitionInProgressDeleter must be passed as 'deleter' into
   // this method in order to remove that transition-in-progress entry when
   // opening the tablet is complete (in either a success or a failure case).
+  //
+  // When not null, bootstrap_times and start_peer_time receive time spent in phases of opening.
   void OpenTablet(const scoped_refptr<tablet::TabletMetadata>& meta,
-                  const scoped_refptr<TransitionInProgressDeleter>& deleter);
+                  const scoped_refptr<TransitionInProgressDeleter>& deleter,
+                  tablet::BootstrapTimes* bootstrap_times,
+                  MonoDelta* start_peer_time);
+
+  // Opens the tablet found at startup, and accounts time spent on it in startup_times_.
+  void OpenTabletAtStartup(const scoped_refptr<tablet::TabletMetadata>& meta,
+                           const scoped_refptr<TransitionInProgressDeleter>& deleter,
+                           MonoTime submit_time);
 
   // Open a tablet whose metadata has already been loaded.
   void BootstrapAndInitTablet(const scoped_refptr<tablet::TabletMetadata>& meta,
@@ -398,6 +458,10 @@ class TSTabletManager : public tserver::TabletPeerLookupIf {
   // transition_in_progress_.
   mutable rw_spinlock lock_;
 
+  // Log caches of all tablets, used to enforce the server wide log cache limit. Declared before
+  // tablet_map_, so it outlives the tablet peers owning the caches.
+  std::unique_ptr<consensus::LogCacheRegistry> log_cache_registry_;
+
   // Map from tablet ID to tablet
   TabletMap tablet_map_;
 
@@ -425,6 +489,12 @@ class TSTabletManager : public tserver::TabletPeerLookupIf {
   // Thread pool used to open the tablets async, whether bootstrap is required or not.
   std::unique_ptr<ThreadPool> open_tablet_pool_;
 
+  mutable std::mutex startup_times_mutex_;
+
+  // Time spent opening tablets found at startup, protected by startup_times_mutex_.
+  TabletStartupTimes startup_times_;
+  MonoTime startup_start_time_;
+
   // Thread pool for preparing transactions, shared between all tablets.
   std::unique_ptr<ThreadPool> tablet_prepare_pool_;
 
@@ -434,9 +504,16 @@ class TSTabletManager : public tserver::TabletPeerLookupIf {
   // Thread pool for Raft-related operations, shared between all tablets.
   std::unique_ptr<ThreadPool> raft_pool_;
 
+  // Batches heartbeats of idle tablets to the same server, shared between all tablets.
+  std::unique_ptr<consensus::MultiRaftManager> multi_raft_manager_;
+
   // Thread pool for read ops, that are run in parallel, shared between all tablets.
   std::unique_ptr<ThreadPool> read_pool_;
 
+  // Thread pool for inserting large write batches into memtables concurrently, shared between all
+  // tablets. Not created when db_memtable_insert_threads is 0.
+  std::unique_ptr<ThreadPool> memtable_insert_pool_;
+
   // Used for scheduling flushes
   std::unique_ptr<BackgroundTask> background_task_;
 
@@ -41,6 +41,7 @@
 
 #include "yb/consensus/log_anchor_registry.h"
 #include "yb/consensus/quorum_util.h"
+#include "yb/docdb/doc_key.h"
 #include "yb/gutil/map-util.h"
 #include "yb/gutil/strings/human_readable.h"
 #include "yb/gutil/strings/join.h"
@@ -55,6 +56,7 @@
 #include "yb/tablet/tablet_peer.h"
 #include "yb/tserver/tablet_server.h"
 #include "yb/tserver/ts_tablet_manager.h"
+#include "yb/util/bytes_formatter.h"
 #include "yb/util/url-coding.h"
 
 namespace yb {
@@ -112,6 +114,9 @@ Status TabletServerPathHandlers::Register(Webserver* server) {
       "/maintenance-manager", "",
       std::bind(&TabletServerPathHandlers::HandleMaintenanceManagerPage, this, _1, _2),
       true /* styled */, false /* is_on_nav_bar */);
+  server->RegisterPathHandler(
+      "/hot-keys", "", std::bind(&TabletServerPathHandlers::HandleHotKeysPage, this, _1, _2),
+      true /* styled */, false /* is_on_nav_bar */);
 
   return Status::OK();
 }
@@ -178,6 +183,19 @@ void TabletServerPathHandlers::HandleTransactionsPage(const Webserver::WebReques
 }
 
 namespace {
+
+string KeyAccessesToHtml(
+    const google::protobuf::RepeatedPtrField<tablet::KeyAccessStatsPB::KeyPB>& keys) {
+  std::stringstream output;
+  for (const auto& key_pb : keys) {
+    docdb::DocKey doc_key;
+    string key_str = doc_key.FullyDecodeFrom(key_pb.key()).ok()
+        ? doc_key.ToString() : util::FormatBytesAsStr(key_pb.key());
+    output << Substitute("$0: $1<br>", EscapeForHtmlToString(key_str), key_pb.count());
+  }
+  return output.str();
+}
+
 string TabletLink(const string& id) {
   return Substitute("<a href=\"/tablet?id=$0\">$1</a>",
                     UrlEncodeToString(id),
@@ -198,6 +216,9 @@ void TabletServerPathHandlers::HandleTabletsPage(const Webserver::WebRequest& re
   std::sort(peers.begin(), peers.end(), &CompareByTabletId);
 
   *output << "<h1>Tablets</h1>\n";
+  *output << "<p>Startup: "
+          << EscapeForHtmlToString(tserver_->tablet_manager()->startup_times().ToString())
+          << "</p>\n";
   *output << "<table class='table table-striped'>\n";
   *output << "  <tr><th>Table name</th><th>Tablet ID</th>"
       "<th>Partition</th>"
@@ -405,6 +426,59 @@ void TabletServerPathHandlers::HandleDashboardsPage(const Webserver::WebRequest&
   *output << GetDashboardLine("maintenance-manager", "Maintenance Manager",
                               "List of operations that are currently running and those "
                               "that are registered.");
+  *output << GetDashboardLine("hot-keys", "Hot Keys",
+                              "Tablets with the most reads and writes, and their hottest keys.");
+}
+
+void TabletServerPathHandlers::HandleHotKeysPage(const Webserver::WebRequest& req,
+                                                 std::stringstream* output) {
+  const size_t max_keys = atoi(FindWithDefault(req.parsed_args, "keys", "5").c_str());
+  const size_t max_tablets = atoi(FindWithDefault(req.parsed_args, "tablets", "20").c_str());
+
+  vector<scoped_refptr<TabletPeer>> peers;
+  tserver_->tablet_manager()->GetTabletPeers(&peers);
+  vector<std::pair<scoped_refptr<TabletPeer>, tablet::KeyAccessStatsPB>> tablets;
+  for (const auto& peer : peers) {
+    auto tablet = peer->shared_tablet();
+    if (!tablet) {
+      continue;
+    }
+    tablets.emplace_back(peer, tablet::KeyAccessStatsPB());
+    tablet->key_access_stats()->ToPB(max_keys, &tablets.back().second);
+  }
+  auto num_accesses = [](const tablet::KeyAccessStatsPB& stats) {
+    return stats.num_reads() + stats.num_writes();
+  };
+  std::sort(tablets.begin(), tablets.end(), [&num_accesses](const auto& lhs, const auto& rhs) {
+    return num_accesses(lhs.second) > num_accesses(rhs.second);
+  });
+  if (tablets.size() > max_tablets) {
+    tablets.resize(max_tablets);
+  }
+
+  *output << "<h1>Hot Keys</h1>\n";
+  *output << "<p>Reads and writes are counted since the tablet was opened. Key counts are "
+          << "estimated from sampled accesses.</p>\n";
+  *output << "<table class='table table-striped'>\n";
+  *output << "  <tr><th>Table name</th><th>Tablet ID</th><th>Partition</th><th>Reads</th>"
+          << "<th>Writes</th><th>Top read keys</th><th>Top write keys</th></tr>\n";
+  for (const auto& entry : tablets) {
+    const auto& peer = entry.first;
+    const auto& stats = entry.second;
+    string partition = peer->tablet_metadata()->partition_schema()
+                            .PartitionDebugString(peer->status_listener()->partition(),
+                                                  peer->tablet_metadata()->schema());
+    *output << Substitute(
+        "<tr><td>$0</td><td>$1</td><td>$2</td><td>$3</td><td>$4</td><td>$5</td><td>$6</td></tr>\n",
+        EscapeForHtmlToString(peer->tablet_metadata()->table_name()),
+        TabletLink(peer->tablet_id()),
+        EscapeForHtmlToString(partition),
+        stats.num_reads(),
+        stats.num_writes(),
+        KeyAccessesToHtml(stats.top_read_keys()),
+        KeyAccessesToHtml(stats.top_write_keys()));
+  }
+  *output << "</table>\n";
 }
 
 string TabletServerPathHandlers::GetDashboardLine(const std::string& link,
@@ -429,6 +503,10 @@ void TabletServerPathHandlers::HandleMaintenanceManagerPage(const Webserver::Web
   int ops_count = pb.registered_operations_size();
 
   *output << "<h1>Maintenance Manager state</h1>\n";
+  *output << Substitute("<p>Threads: $0 running of $1. IO budget: $2. Last decision: $3</p>\n",
+                        pb.running_ops(), pb.num_threads(),
+                        HumanReadableNumBytes::ToString(pb.io_budget_bytes()),
+                        EscapeForHtmlToString(pb.last_decision()));
   *output << "<h3>Running operations</h3>\n";
   *output << "<table class='table table-striped'>\n";
   *output << "  <tr><th>Name</th><th>Instances running</th></tr>\n";
@@ -459,16 +537,19 @@ void TabletServerPathHandlers::HandleMaintenanceManagerPage(const Webserver::Web
   *output << "<h3>Non-running operations</h3>\n";
   *output << "<table class='table table-striped'>\n";
   *output << "  <tr><th>Name</th><th>Runnable</th><th>RAM anchored</th>\n"
-          << "       <th>Logs retained</th><th>Perf</th></tr>\n";
+          << "       <th>Logs retained</th><th>Perf</th><th>IO cost</th><th>Score</th></tr>\n";
   for (int i = 0; i < ops_count; i++) {
     MaintenanceManagerStatusPB_MaintenanceOpPB op_pb = pb.registered_operations(i);
     if (op_pb.running() == 0) {
-      *output << Substitute("<tr><td>$0</td><td>$1</td><td>$2</td><td>$3</td><td>$4</td></tr>\n",
+      *output << Substitute("<tr><td>$0</td><td>$1</td><td>$2</td><td>$3</td><td>$4</td>"
+                            "<td>$5</td><td>$6</td></tr>\n",
                             EscapeForHtmlToString(op_pb.name()),
                             op_pb.runnable(),
                             HumanReadableNumBytes::ToString(op_pb.ram_anchored_bytes()),
                             HumanReadableNumBytes::ToString(op_pb.logs_retained_bytes()),
-                            op_pb.perf_improvement());
+                            op_pb.perf_improvement(),
+                            HumanReadableNumBytes::ToString(op_pb.io_cost_bytes()),
+                            op_pb.score());
     }
   }
   *output << "</table>\n";
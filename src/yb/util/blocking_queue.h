@@ -143,6 +143,23 @@ class BlockingQueue {
     }
   }
 
+  // Get all elements currently present in the queue and append them to a vector, without
+  // waiting. Returns false if the queue is empty and was shut down.
+  bool DrainTo(std::vector<T>* out) {
+    MutexLock l(lock_);
+    if (list_.empty()) {
+      return !shutdown_;
+    }
+    out->reserve(out->size() + list_.size());
+    for (const T& elt : list_) {
+      out->push_back(elt);
+      decrement_size_unlocked(elt);
+    }
+    list_.clear();
+    not_full_.Signal();
+    return true;
+  }
+
   // Attempts to put the given value in the queue.
   // Returns:
   //   QUEUE_SUCCESS: if successfully inserted
@@ -463,7 +463,7 @@ class ShardedLRUCache : public Cache {
   }
 
   void SetMetrics(const scoped_refptr<MetricEntity>& entity) override {
-    metrics_.reset(new CacheMetrics(entity));
+    metrics_.reset(new CacheMetrics(entity, CacheTier::kUncompressed));
     for (LRUCache* cache : shards_) {
       cache->SetMetrics(metrics_.get());
     }
@@ -71,23 +71,64 @@ METRIC_DEFINE_gauge_uint64(server, block_cache_multi_touch_usage,
                            "Multi Cache Block Cache Memory Usage",
                            yb::MetricUnit::kBytes,
                            "Memory consumed by the multi cache block cache");
+
+METRIC_DEFINE_counter(server, block_cache_compressed_inserts,
+                      "Compressed Block Cache Inserts", yb::MetricUnit::kBlocks,
+                      "Number of blocks inserted in the compressed block cache");
+METRIC_DEFINE_counter(server, block_cache_compressed_lookups,
+                      "Compressed Block Cache Lookups", yb::MetricUnit::kBlocks,
+                      "Number of blocks looked up from the compressed block cache");
+METRIC_DEFINE_counter(server, block_cache_compressed_evictions,
+                      "Compressed Block Cache Evictions", yb::MetricUnit::kBlocks,
+                      "Number of blocks evicted from the compressed block cache");
+METRIC_DEFINE_counter(server, block_cache_compressed_misses,
+                      "Compressed Block Cache Misses", yb::MetricUnit::kBlocks,
+                      "Number of lookups in the compressed block cache that didn't yield a block");
+METRIC_DEFINE_counter(server, block_cache_compressed_misses_caching,
+                      "Compressed Block Cache Misses (Caching)", yb::MetricUnit::kBlocks,
+                      "Number of lookups in the compressed block cache that were expecting a "
+                      "block that didn't yield one.");
+METRIC_DEFINE_counter(server, block_cache_compressed_hits,
+                      "Compressed Block Cache Hits", yb::MetricUnit::kBlocks,
+                      "Number of lookups in the compressed block cache that found a block");
+METRIC_DEFINE_counter(server, block_cache_compressed_hits_caching,
+                      "Compressed Block Cache Hits (Caching)", yb::MetricUnit::kBlocks,
+                      "Number of lookups in the compressed block cache that were expecting a "
+                      "block that found one.");
+
+METRIC_DEFINE_gauge_uint64(server, block_cache_compressed_usage,
+                           "Compressed Block Cache Memory Usage",
+                           yb::MetricUnit::kBytes,
+                           "Memory consumed by the compressed block cache");
+METRIC_DEFINE_gauge_uint64(server, block_cache_compressed_single_touch_usage,
+                           "Single Touch Compressed Block Cache Memory Usage",
+                           yb::MetricUnit::kBytes,
+                           "Memory consumed by the single touch compressed block cache");
+METRIC_DEFINE_gauge_uint64(server, block_cache_compressed_multi_touch_usage,
+                           "Multi Cache Compressed Block Cache Memory Usage",
+                           yb::MetricUnit::kBytes,
+                           "Memory consumed by the multi cache compressed block cache");
+
 namespace yb {
 
-#define MINIT(member, x) member(METRIC_##x.Instantiate(entity))
-#define GINIT(member, x) member(METRIC_##x.Instantiate(entity, 0))
-CacheMetrics::CacheMetrics(const scoped_refptr<MetricEntity>& entity)
-  : MINIT(inserts, block_cache_inserts),
-    MINIT(lookups, block_cache_lookups),
-    MINIT(evictions, block_cache_evictions),
-    MINIT(cache_hits, block_cache_hits),
-    MINIT(cache_hits_caching, block_cache_hits_caching),
-    MINIT(cache_misses, block_cache_misses),
-    MINIT(cache_misses_caching, block_cache_misses_caching),
-    GINIT(cache_usage, block_cache_usage),
-    GINIT(single_touch_cache_usage, block_cache_single_touch_usage),
-    GINIT(multi_touch_cache_usage, block_cache_multi_touch_usage) {
+#define METRIC_FOR_TIER(x) \
+    (tier == CacheTier::kCompressed ? METRIC_block_cache_compressed_##x : METRIC_block_cache_##x)
+#define MINIT(member, x) member(METRIC_FOR_TIER(x).Instantiate(entity))
+#define GINIT(member, x) member(METRIC_FOR_TIER(x).Instantiate(entity, 0))
+CacheMetrics::CacheMetrics(const scoped_refptr<MetricEntity>& entity, CacheTier tier)
+  : MINIT(inserts, inserts),
+    MINIT(lookups, lookups),
+    MINIT(evictions, evictions),
+    MINIT(cache_hits, hits),
+    MINIT(cache_hits_caching, hits_caching),
+    MINIT(cache_misses, misses),
+    MINIT(cache_misses_caching, misses_caching),
+    GINIT(cache_usage, usage),
+    GINIT(single_touch_cache_usage, single_touch_usage),
+    GINIT(multi_touch_cache_usage, multi_touch_usage) {
 }
 #undef MINIT
 #undef GINIT
+#undef METRIC_FOR_TIER
 
 } // namespace yb
@@ -44,8 +44,14 @@ class AtomicGauge;
 class Counter;
 class MetricEntity;
 
+// Tier of the block cache, that selects the prefix of its metrics.
+enum class CacheTier {
+  kUncompressed, // block_cache_*
+  kCompressed, // block_cache_compressed_*
+};
+
 struct CacheMetrics {
-  explicit CacheMetrics(const scoped_refptr<MetricEntity>& metric_entity);
+  CacheMetrics(const scoped_refptr<MetricEntity>& metric_entity, CacheTier tier);
 
   scoped_refptr<Counter> inserts;
   scoped_refptr<Counter> lookups;
@@ -559,7 +559,7 @@ class ShardedLRUCache : public Cache {
     return ++(last_id_);
   }
   void SetMetrics(const scoped_refptr<MetricEntity>& entity) override {
-    metrics_.reset(new CacheMetrics(entity));
+    metrics_.reset(new CacheMetrics(entity, CacheTier::kUncompressed));
     for (NvmLRUCache* cache : shards_) {
       cache->SetMetrics(metrics_.get());
     }